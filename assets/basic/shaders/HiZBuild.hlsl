@@ -0,0 +1,47 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Builds one level of a hierarchical Z pyramid. Each Dst texel is the
+// farthest (max) depth of the Src texels it covers. Src is either the
+// depth buffer, copied 1:1 into level 0, or the previous level. When a Src
+// dimension is odd, edge texels also cover the extra row or column so that
+// no depth is lost.
+
+Texture2D<float>   Src : register(t0);
+RWTexture2D<float> Dst : register(u1);
+
+[numthreads(8, 8, 1)]
+void csmain(uint3 tid : SV_DispatchThreadID)
+{
+    uint2 srcSize;
+    uint2 dstSize;
+    Src.GetDimensions(srcSize.x, srcSize.y);
+    Dst.GetDimensions(dstSize.x, dstSize.y);
+    if (any(tid.xy >= dstSize)) {
+        return;
+    }
+
+    uint2 begin = (tid.xy * srcSize) / dstSize;
+    uint2 end   = min(((tid.xy + 1) * srcSize + dstSize - 1) / dstSize, srcSize);
+
+    float depth = 0;
+    for (uint y = begin.y; y < end.y; ++y) {
+        for (uint x = begin.x; x < end.x; ++x) {
+            depth = max(depth, Src.Load(int3(x, y, 0)));
+        }
+    }
+
+    Dst[tid.xy] = depth;
+}
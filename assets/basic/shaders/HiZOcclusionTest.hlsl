@@ -0,0 +1,94 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Tests world space bounding boxes against a hierarchical Z pyramid built
+// by HiZBuild.hlsl. Writes 1 to Visibility for boxes that may be visible
+// and 0 for boxes that are behind the depth buffer.
+
+struct ParamsData
+{
+    float4x4 viewProjection;
+    float2   hizSize;
+    uint     mipLevelCount;
+    uint     objectCount;
+};
+
+struct Bounds
+{
+    float4 minPos;
+    float4 maxPos;
+};
+
+ConstantBuffer<ParamsData> Param : register(b0);
+StructuredBuffer<Bounds>   BoundsBuffer : register(t1);
+Texture2D<float>           HiZ : register(t2);
+RWStructuredBuffer<uint>   Visibility : register(u3);
+
+[numthreads(64, 1, 1)]
+void csmain(uint3 tid : SV_DispatchThreadID)
+{
+    if (tid.x >= Param.objectCount) {
+        return;
+    }
+
+    Bounds bounds = BoundsBuffer[tid.x];
+
+    // Screen rectangle in texture coordinates and nearest depth of the box
+    float2 rectMin = float2(1, 1);
+    float2 rectMax = float2(0, 0);
+    float  minZ    = 1;
+    for (uint i = 0; i < 8; ++i) {
+        float3 corner = float3((i & 1) ? bounds.maxPos.x : bounds.minPos.x,
+                               (i & 2) ? bounds.maxPos.y : bounds.minPos.y,
+                               (i & 4) ? bounds.maxPos.z : bounds.minPos.z);
+        float4 clip   = mul(Param.viewProjection, float4(corner, 1));
+
+        // Boxes that cross the camera plane can't be projected
+        if (clip.w <= 0) {
+            Visibility[tid.x] = 1;
+            return;
+        }
+
+        float3 ndc = clip.xyz / clip.w;
+        float2 uv  = float2(0.5 + 0.5 * ndc.x, 0.5 - 0.5 * ndc.y);
+        rectMin    = min(rectMin, uv);
+        rectMax    = max(rectMax, uv);
+        minZ       = min(minZ, ndc.z);
+    }
+    rectMin = saturate(rectMin);
+    rectMax = saturate(rectMax);
+
+    // Level where the rectangle covers at most 2x2 texels
+    float2 size  = (rectMax - rectMin) * Param.hizSize;
+    uint   level = (uint)clamp(ceil(log2(max(max(size.x, size.y), 1))), 0, Param.mipLevelCount - 1);
+
+    uint2 levelSize;
+    uint  levelCount;
+    HiZ.GetDimensions(level, levelSize.x, levelSize.y, levelCount);
+
+    int2 texMin = min(int2(rectMin * levelSize), int2(levelSize) - 1);
+    int2 texMax = min(int2(rectMax * levelSize), int2(levelSize) - 1);
+
+    // The last level may still be too coarse, keep the box if so
+    if (any(texMax - texMin > 1)) {
+        Visibility[tid.x] = 1;
+        return;
+    }
+
+    float maxDepth = max(max(HiZ.Load(int3(texMin.x, texMin.y, level)), HiZ.Load(int3(texMax.x, texMin.y, level))),
+                         max(HiZ.Load(int3(texMin.x, texMax.y, level)), HiZ.Load(int3(texMax.x, texMax.y, level))));
+
+    Visibility[tid.x] = (minZ <= maxDepth) ? 1 : 0;
+}
@@ -12,23 +12,43 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// Must match projects/28_gltf/main.cpp.
+#define MAX_MATERIAL_COUNT         256
+#define MAX_MATERIAL_TEXTURE_COUNT 64
+
 struct SceneData
 {
     float4x4 ModelMatrix;                // Transforms object space to world space.
-    float4x4 ITModelMatrix;                // Inverse transpose of the ModelMatrix.
+    float4x4 ITModelMatrix;              // Inverse transpose of the ModelMatrix.
     float4   Ambient;                    // Object's ambient intensity.
     float4x4 CameraViewProjectionMatrix; // Camera's view projection matrix.
     float4   LightPosition;              // Light's position.
     float4   EyePosition;                // Eye (camera) position.
+    uint     MaterialIndex;              // Index in MaterialTable.
+};
+
+// Entry of the material table. Transforms are per-texture UV transforms
+// (xy: scale, zw: offset), used to sample textures packed into an atlas.
+// Identity is (1, 1, 0, 0).
+struct MaterialData
+{
+    uint4  TextureIndices; // Albedo, normal map and metal/roughness index in Textures.
+    float4 AlbedoTransform;
+    float4 NormalMapTransform;
+    float4 MetalRoughnessTransform;
+};
+
+struct MaterialTableData
+{
+    MaterialData Materials[MAX_MATERIAL_COUNT];
 };
 
-ConstantBuffer<SceneData> Scene : register(b0);
-Texture2D                 AlbedoTexture         : register(t1);
-SamplerState              AlbedoSampler         : register(s2);
-Texture2D                 NormalMap             : register(t3);
-SamplerState              NormalMapSampler      : register(s4);
-Texture2D                 MetalRoughness        : register(t5);
-SamplerState              MetalRoughnessSampler : register(s6);
+// Set 0 changes with every draw through a dynamic offset, set 1 is shared by
+// all draws.
+ConstantBuffer<SceneData>         Scene                                : register(b0, space0);
+Texture2D                         Textures[MAX_MATERIAL_TEXTURE_COUNT] : register(t0, space1);
+SamplerState                      Sampler                              : register(s1, space1);
+ConstantBuffer<MaterialTableData> MaterialTable                        : register(b2, space1);
 
 struct VSOutput {
   float4 world_position : POSITION;
@@ -105,16 +125,26 @@ float4 psmain(VSOutput input) : SV_TARGET
                             tTS.y, bTS.y, nTS.y,
                             tTS.z, bTS.z, nTS.z);
 
+    const MaterialData Material = MaterialTable.Materials[Scene.MaterialIndex];
+
+    Texture2D AlbedoTexture  = Textures[Material.TextureIndices.x];
+    Texture2D NormalMap      = Textures[Material.TextureIndices.y];
+    Texture2D MetalRoughness = Textures[Material.TextureIndices.z];
+
     const float3 V = normalize(Scene.EyePosition.xyz - input.world_position.xyz);
-    const float3 normal = NormalMap.Sample(NormalMapSampler, input.uv).rgb;
+    const float2 albedoUV         = input.uv * Material.AlbedoTransform.xy + Material.AlbedoTransform.zw;
+    const float2 normalMapUV      = input.uv * Material.NormalMapTransform.xy + Material.NormalMapTransform.zw;
+    const float2 metalRoughnessUV = input.uv * Material.MetalRoughnessTransform.xy + Material.MetalRoughnessTransform.zw;
+
+    const float3 normal = NormalMap.Sample(Sampler, normalMapUV).rgb;
     const float3 N = normalize(mul(TBN, normal * 2.0 - 1.0));
 
-    const float4 albedo = AlbedoTexture.Sample(AlbedoSampler, input.uv).rgba;
+    const float4 albedo = AlbedoTexture.Sample(Sampler, albedoUV).rgba;
     if (albedo.a < 0.8f) {
       discard;
     }
-    const float roughness = MetalRoughness.Sample(MetalRoughnessSampler, input.uv).g;
-    const float metalness = MetalRoughness.Sample(MetalRoughnessSampler, input.uv).b;
+    const float roughness = MetalRoughness.Sample(Sampler, metalRoughnessUV).g;
+    const float metalness = MetalRoughness.Sample(Sampler, metalRoughnessUV).b;
     const float3 F0 = lerp(0.04f, albedo.rgb, metalness);
     const float Lrad = 4.f;
 
@@ -37,7 +37,6 @@
 #define EPSILON 0.0001f
 
 #define DEPTH_PEELING_LAYERS_COUNT          8
-#define DEPTH_PEELING_DEPTH_TEXTURES_COUNT  2
 
 #define BUFFER_BUCKET_SIZE_PER_PIXEL        8
 
@@ -20,6 +20,7 @@
 #include "ppx/log.h"
 #include "ppx/ppx.h"
 #include "ppx/csv_file_log.h"
+#include "ppx/timer.h"
 
 using namespace ppx;
 
@@ -29,6 +30,9 @@ const grfx::Api kApi = grfx::API_DX_12_0;
 const grfx::Api kApi = grfx::API_VK_1_1;
 #endif
 
+// Each draw's constants get a full constant buffer aligned slot
+const uint64_t kDrawParamsSize = PPX_UNIFORM_BUFFER_ALIGNMENT;
+
 class ProjApp
     : public ppx::Application
 {
@@ -48,22 +52,31 @@ private:
         ppx::grfx::SemaphorePtr     renderCompleteSemaphore;
         ppx::grfx::FencePtr         renderCompleteFence;
         ppx::grfx::QueryPtr         timestampQuery;
+        ppx::grfx::BufferArenaPtr   drawParamsArena;
     };
 
-    std::vector<PerFrame>           mPerFrame;
-    ppx::grfx::ShaderModulePtr      mVS;
-    ppx::grfx::ShaderModulePtr      mPS;
-    ppx::grfx::PipelineInterfacePtr mPipelineInterface;
-    ppx::grfx::GraphicsPipelinePtr  mPipeline;
-    ppx::grfx::BufferPtr            mVertexBuffer;
-    grfx::Viewport                  mViewport;
-    grfx::Rect                      mScissorRect;
-    grfx::VertexBinding             mVertexBinding;
-    uint2                           mRenderTargetSize;
+    void WriteDrawParams(PerFrame& frame);
+
+    std::vector<PerFrame>                    mPerFrame;
+    ppx::grfx::ShaderModulePtr               mVS;
+    ppx::grfx::ShaderModulePtr               mPS;
+    ppx::grfx::DescriptorPoolPtr             mDescriptorPool;
+    ppx::grfx::DescriptorSetLayoutPtr        mDescriptorSetLayout;
+    std::vector<ppx::grfx::DescriptorSetPtr> mDescriptorSets;
+    ppx::grfx::PipelineInterfacePtr          mPipelineInterface;
+    ppx::grfx::GraphicsPipelinePtr           mPipeline;
+    ppx::grfx::BufferPtr                     mVertexBuffer;
+    grfx::Viewport                           mViewport;
+    grfx::Rect                               mScissorRect;
+    grfx::VertexBinding                      mVertexBinding;
+    uint2                                    mRenderTargetSize;
+    std::vector<uint32_t>                    mDrawParamsOffsets;
+    Timer                                    mTimer;
 
     // Options
-    uint32_t mNumTriangles;
-    bool     mUseInstancedDraw;
+    uint32_t    mNumTriangles;
+    bool        mUseInstancedDraw;
+    std::string mPerDrawUniforms;
 
     // Stats
     uint64_t                 mGpuWorkDuration    = 0;
@@ -74,6 +87,7 @@ private:
         uint64_t frameNumber;
         float    gpuWorkDuration;
         float    cpuFrameTime;
+        float    cpuRecordTime;
     };
     std::deque<PerFrameRegister> mFrameRegisters;
 };
@@ -94,7 +108,8 @@ void ProjApp::SaveResultsToFile()
     for (const auto& row : mFrameRegisters) {
         fileLogger.LogField(row.frameNumber);
         fileLogger.LogField(row.gpuWorkDuration);
-        fileLogger.LastField(row.cpuFrameTime);
+        fileLogger.LogField(row.cpuFrameTime);
+        fileLogger.LastField(row.cpuRecordTime);
     }
 }
 
@@ -112,6 +127,19 @@ void ProjApp::Setup()
     // Whether to make an instanced call for all triangles or use separate draw calls.
     mUseInstancedDraw = cl_options.GetExtraOptionValueOrDefault<bool>("instanced-draw", false);
 
+    // How each draw gets its constants: not at all, through its own descriptor
+    // set, or through one shared set and a dynamic offset per draw.
+    mPerDrawUniforms = cl_options.GetExtraOptionValueOrDefault<std::string>("per-draw-uniforms", "none");
+    if (mPerDrawUniforms != "none" && mPerDrawUniforms != "descriptor-sets" && mPerDrawUniforms != "dynamic-offsets") {
+        mPerDrawUniforms = "none";
+        PPX_LOG_WARN("Invalid per-draw uniforms mode (must be `none`, `descriptor-sets` or `dynamic-offsets`), defaulting to: " + mPerDrawUniforms);
+    }
+    if (mUseInstancedDraw && (mPerDrawUniforms != "none")) {
+        mPerDrawUniforms = "none";
+        PPX_LOG_WARN("Per-draw uniforms are ignored for instanced draws");
+    }
+    const bool usePerDrawUniforms = (mPerDrawUniforms != "none");
+
     // Name of the CSV output file
     mCSVFileName = cl_options.GetExtraOptionValueOrDefault<std::string>("stats-file", "stats.csv");
     if (mCSVFileName.empty()) {
@@ -141,9 +169,62 @@ void ProjApp::Setup()
         queryCreateInfo.count                 = 2;
         PPX_CHECKED_CALL(GetDevice()->CreateQuery(&queryCreateInfo, &frame.timestampQuery));
 
+        // Per-frame linear allocator for draw constants. A single block keeps
+        // the buffer the descriptors point at fixed.
+        if (usePerDrawUniforms) {
+            grfx::BufferArenaCreateInfo arenaCreateInfo   = {};
+            arenaCreateInfo.strategy                      = grfx::BUFFER_ARENA_STRATEGY_LINEAR;
+            arenaCreateInfo.blockSize                     = mNumTriangles * kDrawParamsSize;
+            arenaCreateInfo.maxBlockCount                 = 1;
+            arenaCreateInfo.alignment                     = kDrawParamsSize;
+            arenaCreateInfo.usageFlags.bits.uniformBuffer = true;
+            arenaCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+            PPX_CHECKED_CALL(GetDevice()->CreateBufferArena(&arenaCreateInfo, &frame.drawParamsArena));
+        }
+
         mPerFrame.push_back(frame);
     }
 
+    // Descriptors
+    if (usePerDrawUniforms) {
+        const bool                 useDynamicOffsets = (mPerDrawUniforms == "dynamic-offsets");
+        const grfx::DescriptorType descriptorType    = useDynamicOffsets ? grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        const uint32_t             setCount          = useDynamicOffsets ? 1 : mNumTriangles;
+
+        grfx::DescriptorPoolCreateInfo poolCreateInfo = {};
+        if (useDynamicOffsets) {
+            poolCreateInfo.uniformBufferDynamic = setCount;
+        }
+        else {
+            poolCreateInfo.uniformBuffer = setCount;
+        }
+        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorPool(&poolCreateInfo, &mDescriptorPool));
+
+        grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+        layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(0, descriptorType, 1, grfx::SHADER_STAGE_VS));
+        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mDescriptorSetLayout));
+
+        // The linear arena hands out the same offsets every frame, so set i
+        // can point at draw i's slot directly.
+        grfx::BufferPtr drawParamsBuffer = mPerFrame[0].drawParamsArena->GetBlockBuffer(0);
+        for (uint32_t i = 0; i < setCount; ++i) {
+            grfx::DescriptorSetPtr set;
+            PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mDescriptorSetLayout, &set));
+
+            grfx::WriteDescriptor write = {};
+            write.binding               = 0;
+            write.type                  = descriptorType;
+            write.bufferOffset          = i * kDrawParamsSize;
+            write.bufferRange           = kDrawParamsSize;
+            write.pBuffer               = drawParamsBuffer;
+            PPX_CHECKED_CALL(set->UpdateDescriptors(1, &write));
+
+            mDescriptorSets.push_back(set);
+        }
+
+        mDrawParamsOffsets.resize(mNumTriangles);
+    }
+
     mRenderTargetSize = ppx::uint2(GetWindowWidth(), GetWindowHeight());
 
     mViewport    = {0, 0, float(mRenderTargetSize.x), float(mRenderTargetSize.y), 0, 1};
@@ -180,7 +261,7 @@ void ProjApp::Setup()
 
     // Pipeline
     {
-        std::string shaderName = "PassThroughPos";
+        std::string shaderName = (mPerDrawUniforms != "none") ? "PassThroughPosOffset" : "PassThroughPos";
 
         std::vector<char> bytecode = LoadShader("benchmarks/shaders", shaderName + ".vs");
         PPX_ASSERT_MSG(!bytecode.empty(), "VS shader bytecode load failed");
@@ -194,6 +275,11 @@ void ProjApp::Setup()
 
         grfx::PipelineInterfaceCreateInfo piCreateInfo = {};
         piCreateInfo.setCount                          = 0;
+        if (mDescriptorSetLayout) {
+            piCreateInfo.setCount        = 1;
+            piCreateInfo.sets[0].set     = 0;
+            piCreateInfo.sets[0].pLayout = mDescriptorSetLayout;
+        }
         PPX_CHECKED_CALL(GetDevice()->CreatePipelineInterface(&piCreateInfo, &mPipelineInterface));
 
         mVertexBinding.AppendAttribute({"POSITION", 0, grfx::FORMAT_R32G32B32A32_FLOAT, 0, PPX_APPEND_OFFSET_ALIGNED, grfx::VERTEX_INPUT_RATE_VERTEX});
@@ -216,6 +302,26 @@ void ProjApp::Setup()
         gpCreateInfo.pPipelineInterface                 = mPipelineInterface;
         PPX_CHECKED_CALL(GetDevice()->CreateGraphicsPipeline(&gpCreateInfo, &mPipeline));
     }
+
+    ppx::TimerResult tmres = mTimer.Start();
+    PPX_ASSERT_MSG(tmres == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
+}
+
+void ProjApp::WriteDrawParams(PerFrame& frame)
+{
+    // The GPU is done with this frame's constants once its fence signaled
+    frame.drawParamsArena->Reset();
+
+    for (uint32_t i = 0; i < mNumTriangles; ++i) {
+        grfx::BufferRange range = {};
+        PPX_CHECKED_CALL(frame.drawParamsArena->Allocate(kDrawParamsSize, &range));
+
+        // Spread the triangles over a grid so every draw reads different data
+        float4 offset = float4(static_cast<float>(i % 100) * 0.02f - 1.0f, static_cast<float>((i / 100) % 100) * 0.02f - 1.0f, 0.0f, 0.0f);
+        PPX_CHECKED_CALL(range.CopyFromSource(sizeof(offset), &offset));
+
+        mDrawParamsOffsets[i] = static_cast<uint32_t>(range.offset);
+    }
 }
 
 void ProjApp::Render()
@@ -242,6 +348,11 @@ void ProjApp::Render()
     // Reset queries
     frame.timestampQuery->Reset(0, 2);
 
+    double recordStartTimeMs = mTimer.MillisSinceStart();
+    if (frame.drawParamsArena) {
+        WriteDrawParams(frame);
+    }
+
     // Build command buffer
     PPX_CHECKED_CALL(frame.cmd->Begin());
     {
@@ -262,6 +373,19 @@ void ProjApp::Render()
             if (mUseInstancedDraw) {
                 frame.cmd->Draw(3, mNumTriangles, 0, 0);
             }
+            else if (mPerDrawUniforms == "dynamic-offsets") {
+                // One descriptor set, only the offset changes per draw
+                for (uint32_t i = 0; i < mNumTriangles; ++i) {
+                    frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 1, &mDescriptorSets[0], 1, &mDrawParamsOffsets[i]);
+                    frame.cmd->Draw(3, 1, 0, 0);
+                }
+            }
+            else if (mPerDrawUniforms == "descriptor-sets") {
+                for (uint32_t i = 0; i < mNumTriangles; ++i) {
+                    frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 1, &mDescriptorSets[i]);
+                    frame.cmd->Draw(3, 1, 0, 0);
+                }
+            }
             else {
                 for (uint32_t i = 0; i < mNumTriangles; ++i) {
                     frame.cmd->Draw(3, 1, 0, 0);
@@ -274,6 +398,7 @@ void ProjApp::Render()
         frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
     }
     PPX_CHECKED_CALL(frame.cmd->End());
+    double recordEndTimeMs = mTimer.MillisSinceStart();
 
     grfx::SubmitInfo submitInfo     = {};
     submitInfo.commandBufferCount   = 1;
@@ -295,6 +420,7 @@ void ProjApp::Render()
         stats.frameNumber                = GetFrameCount();
         stats.gpuWorkDuration            = gpuWorkDuration;
         stats.cpuFrameTime               = GetPrevFrameTime();
+        stats.cpuRecordTime              = static_cast<float>(recordEndTimeMs - recordStartTimeMs);
         mFrameRegisters.push_back(stats);
     }
 }
@@ -17,6 +17,7 @@
 #include <queue>
 #include <unordered_set>
 #include <array>
+#include <future>
 
 #include "ppx/ppx.h"
 #include "ppx/timer.h"
@@ -77,10 +78,11 @@ private:
 
     struct Material
     {
-        grfx::PipelineInterfacePtr                                      pInterface;
-        std::array<grfx::GraphicsPipelinePtr, kAvailableShaders.size()> mPipelines;
-        grfx::DescriptorSetPtr                                          pDescriptorSet;
-        std::vector<Texture>                                            textures;
+        grfx::PipelineInterfacePtr                                                   pInterface;
+        std::array<grfx::GraphicsPipelinePtr, kAvailableShaders.size()>              mPipelines;
+        std::array<std::future<grfx::GraphicsPipelinePtr>, kAvailableShaders.size()> mPipelineFutures;
+        grfx::DescriptorSetPtr                                                       pDescriptorSet;
+        std::vector<Texture>                                                         textures;
     };
 
     struct Primitive
@@ -298,7 +300,8 @@ void ProjApp::LoadMaterial(
         gpCreateInfo.outputState.depthStencilFormat     = pSwapchain->GetDepthFormat();
         gpCreateInfo.pPipelineInterface                 = pOutput->pInterface;
 
-        PPX_CHECKED_CALL(pDevice->CreateGraphicsPipeline(&gpCreateInfo, &pOutput->mPipelines[i]));
+        // Compiles while the textures below load, see LoadScene()
+        pOutput->mPipelineFutures[i] = pDevice->CreateGraphicsPipelineAsync(&gpCreateInfo);
     }
 
     pOutput->textures.resize(3);
@@ -531,6 +534,12 @@ void ProjApp::LoadScene(
     for (size_t i = 0; i < data->materials_count; i++) {
         LoadMaterial(gltfFolder, data->materials[i], pSwapchain, pQueue, pDescriptorPool, pTextureCache, &(*pMaterials)[i]);
     }
+    for (Material& material : *pMaterials) {
+        for (size_t i = 0; i < kAvailableShaders.size(); i++) {
+            material.mPipelines[i] = material.mPipelineFutures[i].get();
+            PPX_ASSERT_MSG(!material.mPipelines[i].IsNull(), "graphics pipeline creation failed");
+        }
+    }
     const double timerMaterialLoadingElapsed = timerMaterialLoading.SecondsSinceStart();
 
     Timer timerNodeLoading;
@@ -0,0 +1,207 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <deque>
+
+#include "ppx/ppx.h"
+#include "ppx/csv_file_log.h"
+#include "ppx/timer.h"
+
+using namespace ppx;
+
+#if defined(USE_DX12)
+const grfx::Api kApi = grfx::API_DX_12_0;
+#elif defined(USE_VK)
+const grfx::Api kApi = grfx::API_VK_1_1;
+#endif
+
+// Measures the frame rate of a headless swapchain: every frame acquires an
+// image, clears it and presents it, so the frame time is dominated by the
+// swapchain's own submits.
+//
+// Options:
+//   --readback <bool>        Read back presented images (default false)
+//   --stats-file <path>      CSV output
+class ProjApp
+    : public ppx::Application
+{
+public:
+    virtual void Config(ppx::ApplicationSettings& settings) override;
+    virtual void Setup() override;
+    virtual void Render() override;
+
+    void SaveResultsToFile();
+
+private:
+    struct PerFrame
+    {
+        grfx::CommandBufferPtr cmd;
+        grfx::SemaphorePtr     imageAcquiredSemaphore;
+        grfx::FencePtr         imageAcquiredFence;
+        grfx::SemaphorePtr     renderCompleteSemaphore;
+        grfx::FencePtr         renderCompleteFence;
+    };
+
+    std::vector<PerFrame> mPerFrame;
+    Timer                 mTimer;
+    uint64_t              mReadbackCount = 0;
+
+    // Stats
+    std::string mCSVFileName;
+    struct PerFrameRegister
+    {
+        uint64_t frameNumber;
+        float    cpuFrameTime;
+        float    cpuSwapchainTime;
+        uint64_t readbackCount;
+        uint64_t droppedReadbackCount;
+    };
+    std::deque<PerFrameRegister> mFrameRegisters;
+};
+
+void ProjApp::Config(ppx::ApplicationSettings& settings)
+{
+    settings.appName                        = "headless_present";
+    settings.headless                       = true;
+    settings.enableImGui                    = false;
+    settings.grfx.api                       = kApi;
+    settings.grfx.enableDebug               = false;
+    settings.grfx.device.graphicsQueueCount = 1;
+    settings.grfx.numFramesInFlight         = 1;
+    settings.grfx.pacedFrameRate            = 0; // Go as fast as possible
+}
+
+void ProjApp::SaveResultsToFile()
+{
+    CSVFileLog fileLogger = {mCSVFileName};
+    for (const auto& row : mFrameRegisters) {
+        fileLogger.LogField(row.frameNumber);
+        fileLogger.LogField(row.cpuFrameTime);
+        fileLogger.LogField(row.cpuSwapchainTime);
+        fileLogger.LogField(row.readbackCount);
+        fileLogger.LastField(row.droppedReadbackCount);
+    }
+}
+
+void ProjApp::Setup()
+{
+    auto cl_options = GetExtraOptions();
+
+    // Name of the CSV output file
+    mCSVFileName = cl_options.GetExtraOptionValueOrDefault<std::string>("stats-file", "stats.csv");
+    if (mCSVFileName.empty()) {
+        mCSVFileName = "stats.csv";
+        PPX_LOG_WARN("Invalid name for CSV log file, defaulting to: " + mCSVFileName);
+    }
+
+    if (cl_options.GetExtraOptionValueOrDefault<bool>("readback", false)) {
+        Result ppxres = GetSwapchain()->SetHeadlessReadbackCallback([this](const grfx::HeadlessReadback&) { ++mReadbackCount; });
+        if (Failed(ppxres)) {
+            PPX_LOG_WARN("Headless readback unavailable: " << ToString(ppxres));
+        }
+    }
+
+    ppx::TimerResult tmres = mTimer.Start();
+    PPX_ASSERT_MSG(tmres == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
+
+    // Per frame data
+    {
+        PerFrame frame = {};
+
+        PPX_CHECKED_CALL(GetGraphicsQueue()->CreateCommandBuffer(&frame.cmd));
+
+        grfx::SemaphoreCreateInfo semaCreateInfo = {};
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.imageAcquiredSemaphore));
+
+        grfx::FenceCreateInfo fenceCreateInfo = {};
+        PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.imageAcquiredFence));
+
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.renderCompleteSemaphore));
+
+        fenceCreateInfo = {true}; // Create signaled
+        PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.renderCompleteFence));
+
+        mPerFrame.push_back(frame);
+    }
+}
+
+void ProjApp::Render()
+{
+    PerFrame& frame = mPerFrame[0];
+
+    grfx::SwapchainPtr swapchain = GetSwapchain();
+
+    double acquireStartTimeMs = mTimer.MillisSinceStart();
+
+    uint32_t imageIndex = UINT32_MAX;
+    PPX_CHECKED_CALL(swapchain->AcquireNextImage(UINT64_MAX, frame.imageAcquiredSemaphore, frame.imageAcquiredFence, &imageIndex));
+
+    double acquireEndTimeMs = mTimer.MillisSinceStart();
+
+    PPX_CHECKED_CALL(frame.imageAcquiredFence->WaitAndReset());
+    PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
+
+    PPX_CHECKED_CALL(frame.cmd->Begin());
+    {
+        grfx::ImagePtr image = swapchain->GetColorImage(imageIndex);
+
+        grfx::RenderingInfo renderingInfo   = {};
+        renderingInfo.renderArea            = {0, 0, swapchain->GetWidth(), swapchain->GetHeight()};
+        renderingInfo.renderTargetCount     = 1;
+        renderingInfo.pRenderTargetViews[0] = swapchain->GetRenderTargetView(imageIndex, grfx::ATTACHMENT_LOAD_OP_CLEAR);
+        renderingInfo.RTVClearValues[0]     = {{0, 0, 1, 1}};
+
+        frame.cmd->TransitionImageLayout(image, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_RENDER_TARGET);
+        frame.cmd->BeginRendering(&renderingInfo);
+        frame.cmd->EndRendering();
+        frame.cmd->TransitionImageLayout(image, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+    }
+    PPX_CHECKED_CALL(frame.cmd->End());
+
+    grfx::SubmitInfo submitInfo     = {};
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.ppCommandBuffers     = &frame.cmd;
+    submitInfo.waitSemaphoreCount   = 1;
+    submitInfo.ppWaitSemaphores     = &frame.imageAcquiredSemaphore;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.ppSignalSemaphores   = &frame.renderCompleteSemaphore;
+    submitInfo.pFence               = frame.renderCompleteFence;
+
+    PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+
+    double presentStartTimeMs = mTimer.MillisSinceStart();
+    PPX_CHECKED_CALL(swapchain->Present(imageIndex, 1, &frame.renderCompleteSemaphore));
+    double presentEndTimeMs = mTimer.MillisSinceStart();
+
+    if (GetFrameCount() > 0) {
+        const double     swapchainTimeMs = (acquireEndTimeMs - acquireStartTimeMs) + (presentEndTimeMs - presentStartTimeMs);
+        PerFrameRegister stats           = {};
+        stats.frameNumber                = GetFrameCount();
+        stats.cpuFrameTime               = GetPrevFrameTime();
+        stats.cpuSwapchainTime           = static_cast<float>(swapchainTimeMs);
+        stats.readbackCount              = mReadbackCount;
+        stats.droppedReadbackCount       = swapchain->GetHeadlessDroppedReadbackCount();
+        mFrameRegisters.push_back(stats);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ProjApp app;
+
+    int res = app.Run(argc, argv);
+    app.SaveResultsToFile();
+
+    return res;
+}
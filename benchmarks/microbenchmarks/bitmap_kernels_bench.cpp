@@ -0,0 +1,178 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/bitmap.h"
+#include "ppx/bitmap_kernels.h"
+
+using namespace ppx;
+
+namespace {
+
+const uint32_t kImageSize = 1024;
+const uint32_t kFaceSize  = 512;
+
+// Runs the body under the given instruction set, skipping if the host doesn't support it.
+void RunWith(InstructionSet instructionSet, microbenchmark::State& state, const std::function<void(microbenchmark::State&)>& body)
+{
+    if (!bitmap_kernels::SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    body(state);
+    bitmap_kernels::SetInstructionSet(GetBestInstructionSet());
+}
+
+Bitmap CreateNoise(uint32_t width, uint32_t height, Bitmap::Format format)
+{
+    Bitmap   bitmap = Bitmap::Create(width, height, format);
+    uint32_t seed   = 0x9E3779B9;
+    for (uint64_t i = 0; i < bitmap.GetFootprintSize(); ++i) {
+        seed                = seed * 1664525 + 1013904223;
+        bitmap.GetData()[i] = static_cast<char>(seed >> 24);
+    }
+    return bitmap;
+}
+
+void FillRGBA8(microbenchmark::State& state)
+{
+    Bitmap bitmap = Bitmap::Create(kImageSize, kImageSize, Bitmap::FORMAT_RGBA_UINT8);
+    while (state.KeepRunning()) {
+        bitmap.Fill<uint8_t>(1, 2, 3, 4);
+        microbenchmark::DoNotOptimize(bitmap.GetData()[0]);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+void FillRGBFloat(microbenchmark::State& state)
+{
+    Bitmap bitmap = Bitmap::Create(kImageSize, kImageSize, Bitmap::FORMAT_RGB_FLOAT);
+    while (state.KeepRunning()) {
+        bitmap.Fill<float>(0.1f, 0.2f, 0.3f, 1.0f);
+        microbenchmark::DoNotOptimize(bitmap.GetData()[0]);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+void Convert(microbenchmark::State& state, Bitmap::Format srcFormat, Bitmap::Format dstFormat)
+{
+    Bitmap src = CreateNoise(kImageSize, kImageSize, srcFormat);
+    Bitmap dst = Bitmap::Create(kImageSize, kImageSize, dstFormat);
+    while (state.KeepRunning()) {
+        src.ConvertTo(&dst);
+        microbenchmark::DoNotOptimize(dst.GetData()[0]);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(src.GetFootprintSize() + dst.GetFootprintSize());
+}
+
+void PremultiplyRGBA8(microbenchmark::State& state)
+{
+    Bitmap bitmap = CreateNoise(kImageSize, kImageSize, Bitmap::FORMAT_RGBA_UINT8);
+    while (state.KeepRunning()) {
+        bitmap.PremultiplyAlpha();
+        microbenchmark::DoNotOptimize(bitmap.GetData()[0]);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+void SRGBToLinearRGBA8(microbenchmark::State& state)
+{
+    Bitmap bitmap = CreateNoise(kImageSize, kImageSize, Bitmap::FORMAT_RGBA_UINT8);
+    while (state.KeepRunning()) {
+        bitmap.ConvertSRGBToLinear();
+        microbenchmark::DoNotOptimize(bitmap.GetData()[0]);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+void FlipHorizontalRGBA8(microbenchmark::State& state)
+{
+    Bitmap bitmap = CreateNoise(kFaceSize, kFaceSize, Bitmap::FORMAT_RGBA_UINT8);
+    while (state.KeepRunning()) {
+        bitmap.FlipHorizontal();
+        microbenchmark::DoNotOptimize(bitmap.GetData()[0]);
+    }
+    state.SetItemsProcessed(kFaceSize * kFaceSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+void Rotate90(microbenchmark::State& state, Bitmap::Format format)
+{
+    Bitmap src = CreateNoise(kFaceSize, kFaceSize, format);
+    Bitmap dst = Bitmap::Create(kFaceSize, kFaceSize, format);
+    while (state.KeepRunning()) {
+        src.Rotate90(true, &dst);
+        microbenchmark::DoNotOptimize(dst.GetData()[0]);
+    }
+    state.SetItemsProcessed(kFaceSize * kFaceSize);
+    state.SetBytesProcessed(2 * src.GetFootprintSize());
+}
+
+void PixelIteratorRGBAFloat(microbenchmark::State& state)
+{
+    Bitmap bitmap = CreateNoise(kImageSize, kImageSize, Bitmap::FORMAT_RGBA_FLOAT);
+    while (state.KeepRunning()) {
+        float sum = 0;
+        for (Bitmap::PixelIterator it = bitmap.GetPixelIterator(); !it.Done(); it.Next()) {
+            sum += it.GetPixelAddress<float>()[0];
+        }
+        microbenchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(kImageSize * kImageSize);
+    state.SetBytesProcessed(bitmap.GetFootprintSize());
+}
+
+bool RegisterBitmapBenchmarks()
+{
+    const InstructionSet instructionSets[] = {
+        INSTRUCTION_SET_SCALAR,
+        INSTRUCTION_SET_SSE2,
+        INSTRUCTION_SET_AVX2,
+        INSTRUCTION_SET_NEON,
+    };
+
+    for (InstructionSet is : instructionSets) {
+        const std::string suffix = std::string("/") + ToString(is);
+
+        // clang-format off
+        microbenchmark::Register("Bitmap_Fill_RGBA8" + suffix,                 [is](microbenchmark::State& s) { RunWith(is, s, FillRGBA8); });
+        microbenchmark::Register("Bitmap_Fill_RGBFloat" + suffix,              [is](microbenchmark::State& s) { RunWith(is, s, FillRGBFloat); });
+        microbenchmark::Register("Bitmap_Convert_RGBA8_to_RGBAFloat" + suffix, [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Convert(st, Bitmap::FORMAT_RGBA_UINT8, Bitmap::FORMAT_RGBA_FLOAT); }); });
+        microbenchmark::Register("Bitmap_Convert_RGBAFloat_to_RGBA8" + suffix, [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Convert(st, Bitmap::FORMAT_RGBA_FLOAT, Bitmap::FORMAT_RGBA_UINT8); }); });
+        microbenchmark::Register("Bitmap_Convert_RGBAFloat_to_RGBA16" + suffix, [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Convert(st, Bitmap::FORMAT_RGBA_FLOAT, Bitmap::FORMAT_RGBA_UINT16); }); });
+        microbenchmark::Register("Bitmap_Convert_RGB8_to_RGBA8" + suffix,      [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Convert(st, Bitmap::FORMAT_RGB_UINT8, Bitmap::FORMAT_RGBA_UINT8); }); });
+        microbenchmark::Register("Bitmap_Convert_RGB8_to_RGBAFloat" + suffix,  [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Convert(st, Bitmap::FORMAT_RGB_UINT8, Bitmap::FORMAT_RGBA_FLOAT); }); });
+        microbenchmark::Register("Bitmap_PremultiplyAlpha_RGBA8" + suffix,     [is](microbenchmark::State& s) { RunWith(is, s, PremultiplyRGBA8); });
+        microbenchmark::Register("Bitmap_SRGBToLinear_RGBA8" + suffix,         [is](microbenchmark::State& s) { RunWith(is, s, SRGBToLinearRGBA8); });
+        microbenchmark::Register("Bitmap_FlipHorizontal_RGBA8" + suffix,       [is](microbenchmark::State& s) { RunWith(is, s, FlipHorizontalRGBA8); });
+        microbenchmark::Register("Bitmap_Rotate90_RGBA8" + suffix,             [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Rotate90(st, Bitmap::FORMAT_RGBA_UINT8); }); });
+        microbenchmark::Register("Bitmap_Rotate90_RGBAFloat" + suffix,         [is](microbenchmark::State& s) { RunWith(is, s, [](microbenchmark::State& st) { Rotate90(st, Bitmap::FORMAT_RGBA_FLOAT); }); });
+        // clang-format on
+    }
+
+    // Not instruction set dependent
+    microbenchmark::Register("Bitmap_PixelIterator_RGBAFloat", PixelIteratorRGBAFloat);
+
+    return true;
+}
+
+const bool sBitmapBenchmarksRegistered = RegisterBitmapBenchmarks();
+
+} // namespace
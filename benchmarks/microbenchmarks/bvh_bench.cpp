@@ -0,0 +1,123 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/bvh.h"
+#include "ppx/tri_mesh.h"
+
+using namespace ppx;
+
+namespace {
+
+// About 500k triangles
+const uint32_t kSphereSegments = 512;
+const uint32_t kRayCount       = 65536;
+
+const TriMesh& GetSphere()
+{
+    static const TriMesh sSphere = TriMesh::CreateSphere(1.0f, kSphereSegments, kSphereSegments / 2, TriMeshOptions().Indices());
+    return sSphere;
+}
+
+// Rays from a shell around the sphere toward random points inside its
+// bounds, so most of them hit and some graze past.
+std::vector<Ray> CreateRays()
+{
+    uint32_t seed   = 0x9E3779B9;
+    auto     random = [&seed]() {
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<float>(seed >> 8) / static_cast<float>(1 << 24) * 2.0f - 1.0f;
+    };
+    std::vector<Ray> rays(kRayCount);
+    for (Ray& ray : rays) {
+        float3 origin = glm::normalize(float3(random(), random(), random())) * 3.0f;
+        float3 target = float3(random(), random(), random());
+        ray           = Ray(origin, target - origin);
+    }
+    return rays;
+}
+
+void Build(microbenchmark::State& state, uint32_t threadCount)
+{
+    const TriMesh& sphere = GetSphere();
+    Bvh            bvh;
+    bvh.SetThreadCount(threadCount);
+    while (state.KeepRunning()) {
+        bvh.Build(sphere);
+        microbenchmark::DoNotOptimize(bvh.GetStats().nodeCount);
+    }
+    state.SetItemsProcessed(sphere.GetCountTriangles());
+}
+
+void Refit(microbenchmark::State& state)
+{
+    const TriMesh& sphere = GetSphere();
+    Bvh            bvh;
+    bvh.Build(sphere);
+    while (state.KeepRunning()) {
+        bvh.Refit(sphere.GetCountPositions(), sphere.GetDataPositions());
+        microbenchmark::DoNotOptimize(bvh.GetBounds());
+    }
+    state.SetItemsProcessed(sphere.GetCountTriangles());
+}
+
+void Intersect(microbenchmark::State& state, InstructionSet instructionSet, bool anyHit)
+{
+    Bvh bvh;
+    if (!bvh.SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    bvh.Build(GetSphere());
+
+    std::vector<Ray> rays = CreateRays();
+    while (state.KeepRunning()) {
+        uint32_t hitCount = 0;
+        for (const Ray& ray : rays) {
+            RayHit hit;
+            hitCount += anyHit ? bvh.IntersectAny(ray) : bvh.Intersect(ray, &hit);
+        }
+        microbenchmark::DoNotOptimize(hitCount);
+    }
+    state.SetItemsProcessed(kRayCount);
+}
+
+bool RegisterBvhBenchmarks()
+{
+    microbenchmark::Register("Bvh_Build_Sphere", [](microbenchmark::State& s) { Build(s, 1); });
+    microbenchmark::Register("Bvh_Build_Sphere_AllThreads", [](microbenchmark::State& s) { Build(s, 0); });
+    microbenchmark::Register("Bvh_Refit_Sphere", Refit);
+
+    const InstructionSet instructionSets[] = {
+        INSTRUCTION_SET_SCALAR,
+        INSTRUCTION_SET_SSE2,
+        INSTRUCTION_SET_NEON,
+    };
+
+    for (InstructionSet is : instructionSets) {
+        const std::string suffix = std::string("/") + ToString(is);
+
+        // clang-format off
+        microbenchmark::Register("Bvh_Intersect_Sphere" + suffix,    [is](microbenchmark::State& s) { Intersect(s, is, false); });
+        microbenchmark::Register("Bvh_IntersectAny_Sphere" + suffix, [is](microbenchmark::State& s) { Intersect(s, is, true); });
+        // clang-format on
+    }
+
+    return true;
+}
+
+const bool sBvhBenchmarksRegistered = RegisterBvhBenchmarks();
+
+} // namespace
@@ -0,0 +1,93 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/culling.h"
+
+using namespace ppx;
+
+namespace {
+
+const uint32_t kObjectCount = 1000000;
+
+// Boxes and spheres scattered around a camera at the origin looking down -Z,
+// roughly a quarter of them end up in the frustum.
+void AddRandomVolumes(uint32_t count, FrustumCuller* pCuller)
+{
+    uint32_t seed   = 0x9E3779B9;
+    auto     random = [&seed](float range) {
+        seed = seed * 1664525 + 1013904223;
+        return (static_cast<float>(seed >> 8) / static_cast<float>(1 << 24) - 0.5f) * range;
+    };
+    pCuller->Reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        float3 center = float3(random(1000.0f), random(1000.0f), random(1000.0f));
+        if (i % 2 == 0) {
+            float3 size = float3(random(4.0f) + 2.0f, random(4.0f) + 2.0f, random(4.0f) + 2.0f);
+            pCuller->AddAABB(AABB(center - size / 2.0f, center + size / 2.0f));
+        }
+        else {
+            pCuller->AddSphere(center, random(4.0f) + 2.0f);
+        }
+    }
+}
+
+void Cull(microbenchmark::State& state, InstructionSet instructionSet, uint32_t threadCount)
+{
+    FrustumCuller culler;
+    if (!culler.SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    culler.SetThreadCount(threadCount);
+    AddRandomVolumes(kObjectCount, &culler);
+
+    float4x4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 500.0f);
+    float4x4 view       = glm::lookAt(float3(0, 0, 0), float3(0, 0, -1), float3(0, 1, 0));
+    Frustum  frustum(projection * view);
+
+    std::vector<uint32_t> visible;
+    while (state.KeepRunning()) {
+        culler.Cull(frustum, &visible);
+        microbenchmark::DoNotOptimize(visible.data());
+    }
+    state.SetItemsProcessed(kObjectCount);
+    state.SetBytesProcessed(kObjectCount * 7 * sizeof(float));
+}
+
+bool RegisterCullingBenchmarks()
+{
+    const InstructionSet instructionSets[] = {
+        INSTRUCTION_SET_SCALAR,
+        INSTRUCTION_SET_SSE2,
+        INSTRUCTION_SET_AVX2,
+        INSTRUCTION_SET_NEON,
+    };
+
+    for (InstructionSet is : instructionSets) {
+        const std::string suffix = std::string("/") + ToString(is);
+
+        // clang-format off
+        microbenchmark::Register("FrustumCuller_Cull_1M" + suffix,            [is](microbenchmark::State& s) { Cull(s, is, 1); });
+        microbenchmark::Register("FrustumCuller_Cull_1M_AllThreads" + suffix, [is](microbenchmark::State& s) { Cull(s, is, 0); });
+        // clang-format on
+    }
+
+    return true;
+}
+
+const bool sCullingBenchmarksRegistered = RegisterCullingBenchmarks();
+
+} // namespace
@@ -0,0 +1,93 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/csv_file_log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// Usage: microbenchmarks [--filter <substring>] [--min-time <seconds>] [--stats-file <path>]
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string statsFile;
+    double      minSeconds = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        if ((std::strcmp(argv[i], "--filter") == 0) && ((i + 1) < argc)) {
+            filter = argv[++i];
+        }
+        else if ((std::strcmp(argv[i], "--min-time") == 0) && ((i + 1) < argc)) {
+            minSeconds = std::atof(argv[++i]);
+        }
+        else if ((std::strcmp(argv[i], "--stats-file") == 0) && ((i + 1) < argc)) {
+            statsFile = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--filter <substring>] [--min-time <seconds>] [--stats-file <path>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (ppx::Timer::InitializeStaticData() != ppx::TIMER_RESULT_SUCCESS) {
+        std::fprintf(stderr, "timer initialization failed\n");
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<ppx::CSVFileLog> csv;
+    if (!statsFile.empty()) {
+        csv = std::make_unique<ppx::CSVFileLog>(statsFile);
+        csv->LogField("name");
+        csv->LogField("iterations");
+        csv->LogField("ns_per_iteration");
+        csv->LogField("items_per_second");
+        csv->LastField("mb_per_second");
+    }
+
+    std::printf("%-56s %12s %16s %16s %12s\n", "Benchmark", "Iterations", "ns/iteration", "items/s", "MB/s");
+    for (const microbenchmark::Benchmark& benchmark : microbenchmark::GetRegistry()) {
+        if (!filter.empty() && (benchmark.name.find(filter) == std::string::npos)) {
+            continue;
+        }
+
+        microbenchmark::State state(minSeconds);
+        benchmark.function(state);
+
+        if (!state.GetSkipMessage().empty()) {
+            std::printf("%-56s skipped: %s\n", benchmark.name.c_str(), state.GetSkipMessage().c_str());
+            continue;
+        }
+
+        const double iterations     = static_cast<double>(std::max<uint64_t>(state.GetIterations(), 1));
+        const double seconds        = state.GetElapsedSeconds();
+        const double nsPerIteration = seconds * 1e9 / iterations;
+        const double itemsPerSecond = (seconds > 0) ? (state.GetItemsPerIteration() * iterations / seconds) : 0;
+        const double mbPerSecond    = (seconds > 0) ? (state.GetBytesPerIteration() * iterations / seconds / (1024.0 * 1024.0)) : 0;
+
+        std::printf("%-56s %12llu %16.1f %16.4g %12.1f\n", benchmark.name.c_str(), static_cast<unsigned long long>(state.GetIterations()), nsPerIteration, itemsPerSecond, mbPerSecond);
+
+        if (csv) {
+            csv->LogField(benchmark.name);
+            csv->LogField(state.GetIterations());
+            csv->LogField(nsPerIteration);
+            csv->LogField(itemsPerSecond);
+            csv->LastField(mbPerSecond);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/math_kernels.h"
+
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+// Small enough for the working set to stay in L2
+const size_t kCount = 4096;
+
+// Runs the body under the given instruction set, skipping if the host doesn't support it.
+void RunWith(InstructionSet instructionSet, microbenchmark::State& state, const std::function<void(microbenchmark::State&)>& body)
+{
+    if (!math_kernels::SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    body(state);
+    math_kernels::SetInstructionSet(GetBestInstructionSet());
+}
+
+float3 RandomFloat3(uint32_t* pSeed)
+{
+    float values[3];
+    for (float& value : values) {
+        *pSeed = *pSeed * 1664525 + 1013904223;
+        value  = static_cast<float>(*pSeed >> 8) / static_cast<float>(1 << 24) * 2.0f - 1.0f;
+    }
+    return float3(values[0], values[1], values[2]);
+}
+
+float4x4 RandomMatrix(uint32_t* pSeed)
+{
+    const float3 translation = RandomFloat3(pSeed) * 100.0f;
+    const quat   rotation    = glm::angleAxis(RandomFloat3(pSeed).x * 3.0f, glm::normalize(RandomFloat3(pSeed) + float3(0, 2, 0)));
+    return glm::translate(translation) * glm::mat4_cast(rotation);
+}
+
+void TransformPoints(microbenchmark::State& state)
+{
+    uint32_t            seed   = 0x9E3779B9;
+    const float4x4      matrix = RandomMatrix(&seed);
+    std::vector<float3> src(kCount);
+    std::vector<float3> dst(kCount);
+    for (float3& point : src) {
+        point = RandomFloat3(&seed);
+    }
+    while (state.KeepRunning()) {
+        math_kernels::TransformPoints(matrix, src.data(), dst.data(), kCount);
+        microbenchmark::DoNotOptimize(dst[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+void MultiplyMatrices(microbenchmark::State& state)
+{
+    uint32_t              seed = 0x9E3779B9;
+    std::vector<float4x4> a(kCount);
+    std::vector<float4x4> b(kCount);
+    std::vector<float4x4> dst(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        a[i] = RandomMatrix(&seed);
+        b[i] = RandomMatrix(&seed);
+    }
+    while (state.KeepRunning()) {
+        math_kernels::MultiplyMatrices(a.data(), b.data(), dst.data(), kCount);
+        microbenchmark::DoNotOptimize(dst[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+void ComposeTRS(microbenchmark::State& state)
+{
+    uint32_t              seed = 0x9E3779B9;
+    std::vector<float3>   translations(kCount);
+    std::vector<quat>     rotations(kCount);
+    std::vector<float3>   scales(kCount, float3(1.0f));
+    std::vector<float4x4> dst(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        translations[i] = RandomFloat3(&seed) * 100.0f;
+        rotations[i]    = glm::angleAxis(RandomFloat3(&seed).x * 3.0f, float3(0, 1, 0));
+    }
+    while (state.KeepRunning()) {
+        math_kernels::ComposeTRS(translations.data(), rotations.data(), scales.data(), dst.data(), kCount);
+        microbenchmark::DoNotOptimize(dst[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+void TransformAABBs(microbenchmark::State& state)
+{
+    uint32_t              seed = 0x9E3779B9;
+    std::vector<float4x4> matrices(kCount);
+    std::vector<AABB>     src(kCount);
+    std::vector<AABB>     dst(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        matrices[i] = RandomMatrix(&seed);
+        src[i]      = AABB(RandomFloat3(&seed), RandomFloat3(&seed));
+    }
+    while (state.KeepRunning()) {
+        math_kernels::TransformAABBs(matrices.data(), src.data(), dst.data(), kCount);
+        microbenchmark::DoNotOptimize(dst[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+bool RegisterMathKernelsBenchmarks()
+{
+    const InstructionSet instructionSets[] = {
+        INSTRUCTION_SET_SCALAR,
+        INSTRUCTION_SET_SSE2,
+        INSTRUCTION_SET_AVX2,
+        INSTRUCTION_SET_NEON,
+    };
+
+    for (InstructionSet is : instructionSets) {
+        const std::string suffix = std::string("/") + ToString(is);
+
+        // clang-format off
+        microbenchmark::Register("MathKernels_TransformPoints" + suffix,  [is](microbenchmark::State& s) { RunWith(is, s, TransformPoints); });
+        microbenchmark::Register("MathKernels_MultiplyMatrices" + suffix, [is](microbenchmark::State& s) { RunWith(is, s, MultiplyMatrices); });
+        microbenchmark::Register("MathKernels_ComposeTRS" + suffix,       [is](microbenchmark::State& s) { RunWith(is, s, ComposeTRS); });
+        microbenchmark::Register("MathKernels_TransformAABBs" + suffix,   [is](microbenchmark::State& s) { RunWith(is, s, TransformAABBs); });
+        // clang-format on
+    }
+
+    return true;
+}
+
+const bool sMathKernelsBenchmarksRegistered = RegisterMathKernelsBenchmarks();
+
+} // namespace
@@ -0,0 +1,125 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef microbenchmark_h
+#define microbenchmark_h
+
+#include "ppx/timer.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//
+// Minimal Google Benchmark-style harness for CPU microbenchmarks:
+//
+//   static void BM_Something(microbenchmark::State& state)
+//   {
+//       // setup
+//       while (state.KeepRunning()) {
+//           // measured work
+//       }
+//       state.SetItemsProcessed(itemsPerIteration);
+//   }
+//   PPX_MICROBENCHMARK(BM_Something);
+//
+// Benchmarks with parameters can call microbenchmark::Register() with a
+// lambda from a static initializer instead.
+//
+namespace microbenchmark {
+
+class State
+{
+public:
+    State(double minSeconds)
+        : mMinSeconds(minSeconds) {}
+
+    //! Returns true while the benchmark body should run another iteration.
+    bool KeepRunning()
+    {
+        if (!mStarted) {
+            mStarted = true;
+            mTimer.Start();
+            return true;
+        }
+
+        ++mIterations;
+        double elapsed = mTimer.SecondsSinceStart();
+        if (elapsed < mMinSeconds) {
+            return true;
+        }
+
+        mElapsedSeconds = elapsed;
+        return false;
+    }
+
+    //! Sets the number of items (pixels, points, submits, ...) processed per iteration.
+    void SetItemsProcessed(uint64_t count) { mItemsPerIteration = count; }
+    //! Sets the number of bytes processed per iteration.
+    void SetBytesProcessed(uint64_t count) { mBytesPerIteration = count; }
+    //! Marks the benchmark as skipped, e.g. when the host lacks an instruction set.
+    void SkipWithMessage(const std::string& message) { mSkipMessage = message; }
+
+    uint64_t           GetIterations() const { return mIterations; }
+    double             GetElapsedSeconds() const { return mElapsedSeconds; }
+    uint64_t           GetItemsPerIteration() const { return mItemsPerIteration; }
+    uint64_t           GetBytesPerIteration() const { return mBytesPerIteration; }
+    const std::string& GetSkipMessage() const { return mSkipMessage; }
+
+private:
+    double      mMinSeconds        = 0;
+    bool        mStarted           = false;
+    ppx::Timer  mTimer             = {};
+    uint64_t    mIterations        = 0;
+    double      mElapsedSeconds    = 0;
+    uint64_t    mItemsPerIteration = 0;
+    uint64_t    mBytesPerIteration = 0;
+    std::string mSkipMessage;
+};
+
+using Function = std::function<void(State&)>;
+
+struct Benchmark
+{
+    std::string name;
+    Function    function;
+};
+
+inline std::vector<Benchmark>& GetRegistry()
+{
+    static std::vector<Benchmark> sRegistry;
+    return sRegistry;
+}
+
+inline bool Register(const std::string& name, Function function)
+{
+    GetRegistry().push_back(Benchmark{name, function});
+    return true;
+}
+
+//! Keeps the compiler from optimizing away the computation of \b value.
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+    static volatile const void* sSink = nullptr;
+    sSink                             = &value;
+}
+
+} // namespace microbenchmark
+
+#define PPX_MICROBENCHMARK(FUNCTION) \
+    static const bool FUNCTION##_registered = microbenchmark::Register(#FUNCTION, FUNCTION)
+
+#endif // microbenchmark_h
@@ -0,0 +1,97 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/random.h"
+
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+// Enough to fill a 64x64 float4 texture, small enough to stay in L2
+const size_t kCount = 4096;
+
+// pcg32 one value at a time, the baseline.
+void RandomFloat3(microbenchmark::State& state)
+{
+    Random              random;
+    std::vector<float3> values(kCount);
+    while (state.KeepRunning()) {
+        for (float3& value : values) {
+            value = random.Float3();
+        }
+        microbenchmark::DoNotOptimize(values[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+void FillUInt32(microbenchmark::State& state, InstructionSet instructionSet)
+{
+    RandomStream stream(0x9E3779B9);
+    if (!stream.SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    std::vector<uint32_t> values(kCount);
+    while (state.KeepRunning()) {
+        stream.FillUInt32(values.data(), kCount);
+        microbenchmark::DoNotOptimize(values[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+void FillFloat3(microbenchmark::State& state, InstructionSet instructionSet)
+{
+    RandomStream stream(0x9E3779B9);
+    if (!stream.SetInstructionSet(instructionSet)) {
+        state.SkipWithMessage("instruction set not supported");
+        return;
+    }
+    std::vector<float3> values(kCount);
+    while (state.KeepRunning()) {
+        stream.FillFloat3(values.data(), kCount, float3(-1.0f), float3(1.0f));
+        microbenchmark::DoNotOptimize(values[kCount - 1]);
+    }
+    state.SetItemsProcessed(kCount);
+}
+
+bool RegisterRandomBenchmarks()
+{
+    const InstructionSet instructionSets[] = {
+        INSTRUCTION_SET_SCALAR,
+        INSTRUCTION_SET_SSE2,
+        INSTRUCTION_SET_AVX2,
+        INSTRUCTION_SET_NEON,
+    };
+
+    microbenchmark::Register("Random_Float3", RandomFloat3);
+
+    for (InstructionSet is : instructionSets) {
+        const std::string suffix = std::string("/") + ToString(is);
+
+        // clang-format off
+        microbenchmark::Register("RandomStream_FillUInt32" + suffix, [is](microbenchmark::State& s) { FillUInt32(s, is); });
+        microbenchmark::Register("RandomStream_FillFloat3" + suffix, [is](microbenchmark::State& s) { FillFloat3(s, is); });
+        // clang-format on
+    }
+
+    return true;
+}
+
+const bool sRandomBenchmarksRegistered = RegisterRandomBenchmarks();
+
+} // namespace
@@ -0,0 +1,89 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "microbenchmark.h"
+
+#include "ppx/transform_hierarchy.h"
+
+using namespace ppx;
+
+namespace {
+
+const uint32_t kNodeCount = 1024 * 1024;
+const uint32_t kBranching = 8;
+
+// A single root, 8 children per node, 8 levels
+void CreateHierarchy(TransformHierarchy* pHierarchy)
+{
+    pHierarchy->Reserve(kNodeCount);
+    for (uint32_t i = 0; i < kNodeCount; ++i) {
+        const uint32_t parent = (i == 0) ? TransformHierarchy::kInvalidNode : (i - 1) / kBranching;
+        const uint32_t node   = pHierarchy->AddNode(parent);
+        const float    f      = static_cast<float>(i % 1000);
+        pHierarchy->SetTRS(node, float3(f, 0, -f), glm::angleAxis(0.001f * f, float3(0, 1, 0)), float3(1.0f));
+    }
+    pHierarchy->Update();
+}
+
+// Moving the root makes every node dirty
+void UpdateAll(microbenchmark::State& state, uint32_t threadCount)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.SetThreadCount(threadCount);
+    CreateHierarchy(&hierarchy);
+
+    float x = 0;
+    while (state.KeepRunning()) {
+        hierarchy.SetTranslation(0, float3(x, 0, 0));
+        hierarchy.Update();
+        microbenchmark::DoNotOptimize(hierarchy.GetWorldMatrix(kNodeCount - 1));
+        x += 1.0f;
+    }
+    state.SetItemsProcessed(kNodeCount);
+}
+
+// One leaf in 64 moves, as with a few animated objects in a large scene
+void UpdateSparse(microbenchmark::State& state, uint32_t threadCount)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.SetThreadCount(threadCount);
+    CreateHierarchy(&hierarchy);
+
+    float x = 0;
+    while (state.KeepRunning()) {
+        for (uint32_t node = kNodeCount - 1; node > kNodeCount / 2; node -= 64) {
+            hierarchy.SetTranslation(node, float3(x, 0, 0));
+        }
+        hierarchy.Update();
+        microbenchmark::DoNotOptimize(hierarchy.GetWorldMatrix(kNodeCount - 1));
+        x += 1.0f;
+    }
+    state.SetItemsProcessed(kNodeCount);
+}
+
+bool RegisterTransformHierarchyBenchmarks()
+{
+    // clang-format off
+    microbenchmark::Register("TransformHierarchy_UpdateAll_1M",               [](microbenchmark::State& s) { UpdateAll(s, 1); });
+    microbenchmark::Register("TransformHierarchy_UpdateAll_1M_AllThreads",    [](microbenchmark::State& s) { UpdateAll(s, 0); });
+    microbenchmark::Register("TransformHierarchy_UpdateSparse_1M",            [](microbenchmark::State& s) { UpdateSparse(s, 1); });
+    microbenchmark::Register("TransformHierarchy_UpdateSparse_1M_AllThreads", [](microbenchmark::State& s) { UpdateSparse(s, 0); });
+    // clang-format on
+
+    return true;
+}
+
+const bool sTransformHierarchyBenchmarksRegistered = RegisterTransformHierarchyBenchmarks();
+
+} // namespace
@@ -0,0 +1,173 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <deque>
+
+#include "ppx/ppx.h"
+#include "ppx/csv_file_log.h"
+#include "ppx/timer.h"
+
+using namespace ppx;
+
+#if defined(USE_DX12)
+const grfx::Api kApi = grfx::API_DX_12_0;
+#elif defined(USE_VK)
+const grfx::Api kApi = grfx::API_VK_1_1;
+#endif
+
+// Measures the CPU cost of Queue::Submit() by submitting many small,
+// pre-recorded command buffers every frame, either one call per command
+// buffer or as a single batch.
+//
+// Options:
+//   --submits-per-frame <n>  Submits per frame (default 256)
+//   --batched <bool>         Use one batched Submit() call (default false)
+//   --stats-file <path>      CSV output
+class ProjApp
+    : public ppx::Application
+{
+public:
+    virtual void Config(ppx::ApplicationSettings& settings) override;
+    virtual void Setup() override;
+    virtual void Render() override;
+
+    void SaveResultsToFile();
+
+private:
+    std::vector<grfx::CommandBufferPtr> mCommandBuffers;
+    std::vector<grfx::CommandBuffer*>   mCommandBufferPtrs;
+    std::vector<grfx::SubmitInfo>       mSubmitInfos;
+    grfx::FencePtr                      mSubmitCompleteFence;
+    Timer                               mTimer;
+
+    // Options
+    uint32_t mSubmitsPerFrame;
+    bool     mBatched;
+
+    // Stats
+    std::string mCSVFileName;
+    struct PerFrameRegister
+    {
+        uint64_t frameNumber;
+        float    cpuFrameTime;
+        float    cpuSubmitTime;
+        double   submitsPerSecond;
+    };
+    std::deque<PerFrameRegister> mFrameRegisters;
+};
+
+void ProjApp::Config(ppx::ApplicationSettings& settings)
+{
+    settings.appName                        = "queue_submit";
+    settings.headless                       = true;
+    settings.enableImGui                    = false;
+    settings.grfx.api                       = kApi;
+    settings.grfx.enableDebug               = false;
+    settings.grfx.device.graphicsQueueCount = 1;
+    settings.grfx.numFramesInFlight         = 1;
+    settings.grfx.pacedFrameRate            = 0; // Go as fast as possible
+}
+
+void ProjApp::SaveResultsToFile()
+{
+    CSVFileLog fileLogger = {mCSVFileName};
+    for (const auto& row : mFrameRegisters) {
+        fileLogger.LogField(row.frameNumber);
+        fileLogger.LogField(row.cpuFrameTime);
+        fileLogger.LogField(row.cpuSubmitTime);
+        fileLogger.LastField(row.submitsPerSecond);
+    }
+}
+
+void ProjApp::Setup()
+{
+    auto cl_options = GetExtraOptions();
+
+    mSubmitsPerFrame = cl_options.GetExtraOptionValueOrDefault<uint32_t>("submits-per-frame", 256);
+    if (mSubmitsPerFrame == 0) {
+        mSubmitsPerFrame = 256;
+        PPX_LOG_WARN("Number of submits per frame must be greater than zero, defaulting to: " + std::to_string(mSubmitsPerFrame));
+    }
+
+    mBatched = cl_options.GetExtraOptionValueOrDefault<bool>("batched", false);
+
+    // Name of the CSV output file
+    mCSVFileName = cl_options.GetExtraOptionValueOrDefault<std::string>("stats-file", "stats.csv");
+    if (mCSVFileName.empty()) {
+        mCSVFileName = "stats.csv";
+        PPX_LOG_WARN("Invalid name for CSV log file, defaulting to: " + mCSVFileName);
+    }
+
+    ppx::TimerResult tmres = mTimer.Start();
+    PPX_ASSERT_MSG(tmres == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
+
+    grfx::FenceCreateInfo fenceCreateInfo = {true}; // Create signaled
+    PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &mSubmitCompleteFence));
+
+    // Empty command buffers, recorded once and resubmitted every frame so
+    // only the cost of submission is measured
+    mCommandBuffers.resize(mSubmitsPerFrame);
+    mCommandBufferPtrs.resize(mSubmitsPerFrame);
+    mSubmitInfos.resize(mSubmitsPerFrame);
+    for (uint32_t i = 0; i < mSubmitsPerFrame; ++i) {
+        PPX_CHECKED_CALL(GetGraphicsQueue()->CreateCommandBuffer(&mCommandBuffers[i]));
+        PPX_CHECKED_CALL(mCommandBuffers[i]->Begin());
+        PPX_CHECKED_CALL(mCommandBuffers[i]->End());
+
+        mCommandBufferPtrs[i] = mCommandBuffers[i];
+
+        grfx::SubmitInfo& submitInfo  = mSubmitInfos[i];
+        submitInfo.commandBufferCount = 1;
+        submitInfo.ppCommandBuffers   = &mCommandBufferPtrs[i];
+    }
+    mSubmitInfos.back().pFence = mSubmitCompleteFence;
+}
+
+void ProjApp::Render()
+{
+    // Command buffers are reused, wait for the previous frame's submits
+    PPX_CHECKED_CALL(mSubmitCompleteFence->WaitAndReset());
+
+    double submitStartTimeMs = mTimer.MillisSinceStart();
+    if (mBatched) {
+        PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(mSubmitsPerFrame, mSubmitInfos.data()));
+    }
+    else {
+        for (const grfx::SubmitInfo& submitInfo : mSubmitInfos) {
+            PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+        }
+    }
+    double submitEndTimeMs = mTimer.MillisSinceStart();
+
+    // Skip the first frame, it includes growing the queue's submit storage
+    if (GetFrameCount() > 0) {
+        const double     submitTimeMs = submitEndTimeMs - submitStartTimeMs;
+        PerFrameRegister stats        = {};
+        stats.frameNumber             = GetFrameCount();
+        stats.cpuFrameTime            = GetPrevFrameTime();
+        stats.cpuSubmitTime           = static_cast<float>(submitTimeMs);
+        stats.submitsPerSecond        = (submitTimeMs > 0) ? (mSubmitsPerFrame * 1000.0 / submitTimeMs) : 0;
+        mFrameRegisters.push_back(stats);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    ProjApp app;
+
+    int res = app.Run(argc, argv);
+    app.SaveResultsToFile();
+
+    return res;
+}
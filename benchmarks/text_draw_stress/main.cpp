@@ -0,0 +1,323 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <deque>
+
+#include "ppx/ppx.h"
+#include "ppx/camera.h"
+#include "ppx/csv_file_log.h"
+#include "ppx/timer.h"
+
+using namespace ppx;
+
+#if defined(USE_DX12)
+const grfx::Api kApi = grfx::API_DX_12_0;
+#elif defined(USE_VK)
+const grfx::Api kApi = grfx::API_VK_1_1;
+#endif
+
+// Rebuilds a large amount of text every frame to measure the cost of
+// TextDraw::AddString() and UploadToGpu(), with or without streaming.
+//
+// Options:
+//   --num-glyphs <n>     Glyphs drawn per frame (default 100000)
+//   --streaming <bool>   Use TextDraw streaming mode (default true)
+//   --stats-file <path>  CSV output
+class ProjApp
+    : public ppx::Application
+{
+public:
+    virtual void Config(ppx::ApplicationSettings& settings) override;
+    virtual void Setup() override;
+    virtual void Render() override;
+
+    void SaveResultsToFile();
+
+private:
+    struct PerFrame
+    {
+        grfx::CommandBufferPtr cmd;
+        grfx::SemaphorePtr     imageAcquiredSemaphore;
+        grfx::FencePtr         imageAcquiredFence;
+        grfx::SemaphorePtr     renderCompleteSemaphore;
+        grfx::FencePtr         renderCompleteFence;
+        grfx::QueryPtr         timestampQuery;
+        uint64_t               gpuWorkDuration = 0;
+    };
+    std::vector<PerFrame>    mPerFrame;
+    grfx::TextureFontPtr     mFont;
+    grfx::TextDrawPtr        mText;
+    PerspCamera              mCamera;
+    std::vector<std::string> mLines;
+    Timer                    mTimer;
+
+    // Options
+    uint32_t mNumGlyphs;
+    bool     mStreaming;
+
+    // Stats
+    std::string mCSVFileName;
+    struct PerFrameRegister
+    {
+        uint64_t frameNumber;
+        float    gpuWorkDuration;
+        float    cpuFrameTime;
+        float    cpuTextTime;
+    };
+    std::deque<PerFrameRegister> mFrameRegisters;
+};
+
+void ProjApp::Config(ppx::ApplicationSettings& settings)
+{
+    settings.appName                = "text_draw_stress";
+    settings.enableImGui            = false;
+    settings.grfx.api               = kApi;
+    settings.grfx.enableDebug       = false;
+    settings.grfx.numFramesInFlight = 2;
+}
+
+void ProjApp::SaveResultsToFile()
+{
+    CSVFileLog fileLogger = {mCSVFileName};
+    for (const auto& row : mFrameRegisters) {
+        fileLogger.LogField(row.frameNumber);
+        fileLogger.LogField(row.gpuWorkDuration);
+        fileLogger.LogField(row.cpuFrameTime);
+        fileLogger.LastField(row.cpuTextTime);
+    }
+}
+
+void ProjApp::Setup()
+{
+    auto cl_options = GetExtraOptions();
+
+    mNumGlyphs = cl_options.GetExtraOptionValueOrDefault<uint32_t>("num-glyphs", 100000);
+    if (mNumGlyphs == 0) {
+        mNumGlyphs = 100000;
+        PPX_LOG_WARN("Number of glyphs must be greater than zero, defaulting to: " + std::to_string(mNumGlyphs));
+    }
+
+    mStreaming = cl_options.GetExtraOptionValueOrDefault<bool>("streaming", true);
+
+    // Name of the CSV output file
+    mCSVFileName = cl_options.GetExtraOptionValueOrDefault<std::string>("stats-file", "stats.csv");
+    if (mCSVFileName.empty()) {
+        mCSVFileName = "stats.csv";
+        PPX_LOG_WARN("Invalid name for CSV log file, defaulting to: " + mCSVFileName);
+    }
+
+    mCamera = PerspCamera(GetWindowWidth(), GetWindowHeight());
+
+    ppx::TimerResult tmres = mTimer.Start();
+    PPX_ASSERT_MSG(tmres == ppx::TIMER_RESULT_SUCCESS, "timer start failed");
+
+    // Per frame data
+    for (uint32_t i = 0; i < GetNumFramesInFlight(); ++i) {
+        PerFrame frame = {};
+
+        PPX_CHECKED_CALL(GetGraphicsQueue()->CreateCommandBuffer(&frame.cmd));
+
+        grfx::SemaphoreCreateInfo semaCreateInfo = {};
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.imageAcquiredSemaphore));
+
+        grfx::FenceCreateInfo fenceCreateInfo = {};
+        PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.imageAcquiredFence));
+
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.renderCompleteSemaphore));
+
+        fenceCreateInfo = {true}; // Create signaled
+        PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.renderCompleteFence));
+
+        grfx::QueryCreateInfo queryCreateInfo = {};
+        queryCreateInfo.type                  = grfx::QUERY_TYPE_TIMESTAMP;
+        queryCreateInfo.count                 = 2;
+        PPX_CHECKED_CALL(GetDevice()->CreateQuery(&queryCreateInfo, &frame.timestampQuery));
+
+        mPerFrame.push_back(frame);
+    }
+
+    // Texture font
+    {
+        ppx::Font font;
+        PPX_CHECKED_CALL(ppx::Font::CreateFromFile(GetAssetPath("basic/fonts/Roboto/Roboto-Regular.ttf"), &font));
+
+        grfx::TextureFontCreateInfo createInfo = {};
+        createInfo.font                        = font;
+        createInfo.size                        = 10.0f;
+        createInfo.characters                  = grfx::TextureFont::GetDefaultCharacters();
+
+        PPX_CHECKED_CALL(GetDevice()->CreateTextureFont(&createInfo, &mFont));
+    }
+
+    // Text draw
+    {
+        grfx::ShaderModulePtr VS;
+        grfx::ShaderModulePtr PS;
+
+        std::vector<char> bytecode = LoadShader("basic/shaders", "TextDraw.vs");
+        PPX_ASSERT_MSG(!bytecode.empty(), "VS shader bytecode load failed");
+        grfx::ShaderModuleCreateInfo shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &VS));
+
+        bytecode = LoadShader("basic/shaders", "TextDraw.ps");
+        PPX_ASSERT_MSG(!bytecode.empty(), "PS shader bytecode load failed");
+        shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &PS));
+
+        // In streaming mode start small so capacity growth is exercised too
+        grfx::TextDrawCreateInfo createInfo = {};
+        createInfo.pFont                    = mFont;
+        createInfo.maxTextLength            = mStreaming ? 4096 : mNumGlyphs;
+        createInfo.VS                       = {VS.Get(), "vsmain"};
+        createInfo.PS                       = {PS.Get(), "psmain"};
+        createInfo.renderTargetFormat       = GetSwapchain()->GetColorFormat();
+        createInfo.streaming                = mStreaming;
+        createInfo.streamingFrameCount      = GetNumFramesInFlight();
+
+        PPX_CHECKED_CALL(GetDevice()->CreateTextDraw(&createInfo, &mText));
+
+        GetDevice()->DestroyShaderModule(VS);
+        GetDevice()->DestroyShaderModule(PS);
+    }
+
+    // Lines of printable characters without spaces, every glyph is a visible quad
+    {
+        const uint32_t kLineLength = 200;
+
+        std::string characters;
+        for (char c = 33; c < 127; ++c) {
+            characters.push_back(c);
+        }
+
+        uint32_t remaining = mNumGlyphs;
+        for (uint32_t i = 0; remaining > 0; ++i) {
+            const uint32_t length = std::min(remaining, kLineLength);
+
+            std::string line;
+            for (uint32_t j = 0; j < length; ++j) {
+                line.push_back(characters[(i + j) % characters.size()]);
+            }
+            mLines.push_back(line);
+
+            remaining -= length;
+        }
+    }
+}
+
+void ProjApp::Render()
+{
+    PerFrame& frame = mPerFrame[GetInFlightFrameIndex()];
+
+    grfx::SwapchainPtr swapchain = GetSwapchain();
+
+    uint32_t imageIndex = UINT32_MAX;
+    PPX_CHECKED_CALL(swapchain->AcquireNextImage(UINT64_MAX, frame.imageAcquiredSemaphore, frame.imageAcquiredFence, &imageIndex));
+
+    // Wait for and reset image acquired fence
+    PPX_CHECKED_CALL(frame.imageAcquiredFence->WaitAndReset());
+
+    // Wait for and reset render complete fence
+    PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
+
+    // Read query results
+    if (GetFrameCount() >= GetNumFramesInFlight()) {
+        uint64_t data[2] = {0};
+        PPX_CHECKED_CALL(frame.timestampQuery->GetData(data, 2 * sizeof(uint64_t)));
+        frame.gpuWorkDuration = data[1] - data[0];
+    }
+    // Reset queries
+    frame.timestampQuery->Reset(0, 2);
+
+    // Build command buffer
+    PPX_CHECKED_CALL(frame.cmd->Begin());
+    {
+        // Rebuild all text, the scroll offset makes every vertex change each frame
+        double textStartTimeMs = mTimer.MillisSinceStart();
+        {
+            const float lineHeight = mFont->GetAscent() - mFont->GetDescent();
+            const float scroll     = static_cast<float>(GetFrameCount() % 100);
+            const float height     = static_cast<float>(GetWindowHeight());
+
+            mText->Clear();
+            for (size_t i = 0; i < mLines.size(); ++i) {
+                const float y = std::fmod(static_cast<float>(i) * lineHeight + scroll, height);
+                mText->AddString(float2(-scroll, y), mLines[i], float3(0.8f, 0.8f, 0.9f));
+            }
+            mText->UploadToGpu(frame.cmd);
+        }
+        double textEndTimeMs = mTimer.MillisSinceStart();
+
+        mText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
+
+        grfx::RenderPassPtr renderPass = swapchain->GetRenderPass(imageIndex);
+        PPX_ASSERT_MSG(!renderPass.IsNull(), "render pass object is null");
+
+        grfx::RenderPassBeginInfo beginInfo = {};
+        beginInfo.pRenderPass               = renderPass;
+        beginInfo.renderArea                = renderPass->GetRenderArea();
+        beginInfo.RTVClearCount             = 1;
+        beginInfo.RTVClearValues[0]         = {{0.1f, 0.1f, 0.12f, 1}};
+
+        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_RENDER_TARGET);
+        frame.cmd->BeginRenderPass(&beginInfo);
+        {
+            grfx::Rect     scissorRect = renderPass->GetScissor();
+            grfx::Viewport viewport    = renderPass->GetViewport();
+            frame.cmd->SetScissors(1, &scissorRect);
+            frame.cmd->SetViewports(1, &viewport);
+
+            frame.cmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+            mText->Draw(frame.cmd);
+            frame.cmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
+        }
+        frame.cmd->EndRenderPass();
+        frame.cmd->ResolveQueryData(frame.timestampQuery, 0, 2);
+        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+
+        if (GetFrameCount() >= GetNumFramesInFlight()) {
+            uint64_t frequency = 0;
+            GetGraphicsQueue()->GetTimestampFrequency(&frequency);
+            PerFrameRegister stats = {};
+            stats.frameNumber      = GetFrameCount();
+            stats.gpuWorkDuration  = static_cast<float>(frame.gpuWorkDuration / static_cast<double>(frequency)) * 1000.0f;
+            stats.cpuFrameTime     = GetPrevFrameTime();
+            stats.cpuTextTime      = static_cast<float>(textEndTimeMs - textStartTimeMs);
+            mFrameRegisters.push_back(stats);
+        }
+    }
+    PPX_CHECKED_CALL(frame.cmd->End());
+
+    grfx::SubmitInfo submitInfo     = {};
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.ppCommandBuffers     = &frame.cmd;
+    submitInfo.waitSemaphoreCount   = 1;
+    submitInfo.ppWaitSemaphores     = &frame.imageAcquiredSemaphore;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.ppSignalSemaphores   = &frame.renderCompleteSemaphore;
+    submitInfo.pFence               = frame.renderCompleteFence;
+
+    PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+
+    PPX_CHECKED_CALL(swapchain->Present(imageIndex, 1, &frame.renderCompleteSemaphore));
+}
+
+int main(int argc, char** argv)
+{
+    ProjApp app;
+
+    int res = app.Run(argc, argv);
+    app.SaveResultsToFile();
+
+    return res;
+}
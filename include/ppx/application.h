@@ -17,6 +17,9 @@
 
 #include "ppx/base_application.h"
 #include "ppx/command_line_parser.h"
+#include "ppx/csv_file_log.h"
+#include "ppx/culling.h"
+#include "ppx/frame_pacer.h"
 #include "ppx/math_config.h"
 #include "ppx/imgui_impl.h"
 #include "ppx/timer.h"
@@ -270,10 +273,12 @@ struct ApplicationSettings
 
     struct
     {
-        grfx::Api api               = grfx::API_UNDEFINED;
-        bool      enableDebug       = false;
-        uint32_t  numFramesInFlight = 1;
-        uint32_t  pacedFrameRate    = 60;
+        grfx::Api            api               = grfx::API_UNDEFINED;
+        bool                 enableDebug       = false;
+        uint32_t             numFramesInFlight = 1;
+        ppx::FramePacingMode pacingMode        = ppx::FRAME_PACING_MODE_FIXED_RATE; // Overridden by --frame-pacing
+        uint32_t             pacedFrameRate    = 60;                                // FRAME_PACING_MODE_FIXED_RATE only, 0 disables pacing
+        bool                 enableGpuProfiler = false;                             // Also enabled by --gpu-stats-file
 
         struct
         {
@@ -345,6 +350,20 @@ protected:
     void DrawDebugInfo(std::function<void(void)> drawAdditionalFn = []() {});
     void DrawProfilerGrfxApiFunctions();
 
+    //! Draws per heap usage and budget, and per category totals, into the
+    //! current ImGui window. Also shown under "Memory" in DrawDebugInfo().
+    void DrawMemoryStats();
+
+    //! Draws object, culled and visible counts and the CPU culling time
+    //! into the current ImGui window, e.g. from DrawDebugInfo()'s
+    //! \b drawAdditionalFn.
+    void DrawCullingStats(const ppx::CullingStats& stats);
+
+    //! Draws the GPU time of each scope of the last frame read back by the
+    //! GPU profiler into the current ImGui window, nested scopes indented.
+    //! Also shown under "GPU Scopes" in DrawDebugInfo().
+    void DrawGpuProfilerStats();
+
 public:
     int  Run(int argc, char** argv);
     void Quit();
@@ -387,6 +406,11 @@ public:
     grfx::QueuePtr    GetComputeQueue(uint32_t index = 0) const { return GetDevice()->GetComputeQueue(index); }
     grfx::QueuePtr    GetTransferQueue(uint32_t index = 0) const { return GetDevice()->GetTransferQueue(index); }
 
+    //! Null unless ApplicationSettings::grfx.enableGpuProfiler is set. The
+    //! application calls BeginFrame() before each Render(), Render() pushes
+    //! and pops scopes and calls EndFrame() in its last command buffer.
+    grfx::GpuProfilerPtr GetGpuProfiler() const { return mGpuProfiler; }
+
     // "index" here is for XR applications to fetch the swapchain of different views.
     // For non-XR applications, "index" should be always 0.
     grfx::SwapchainPtr GetSwapchain(uint32_t index = 0) const
@@ -400,10 +424,16 @@ public:
     uint64_t GetFrameCount() const { return mFrameCount; }
     float    GetAverageFPS() const { return mAverageFPS; }
     float    GetAverageFrameTime() const { return mAverageFrameTime; }
+    float    GetTimeToFirstFrame() const { return mTimeToFirstFrame; } // Milliseconds from Run() to the end of the first frame
     uint32_t GetNumFramesInFlight() const { return mSettings.grfx.numFramesInFlight; }
     uint32_t GetInFlightFrameIndex() const { return static_cast<uint32_t>(mFrameCount % mSettings.grfx.numFramesInFlight); }
     uint32_t GetPreviousInFlightFrameIndex() const { return static_cast<uint32_t>((mFrameCount - 1) % mSettings.grfx.numFramesInFlight); }
 
+    //! Returns the timings of the last frame the GPU has finished, see FramePacer.
+    //! GPU completion latency is only measured in low latency mode or with
+    //! --frame-stats-file.
+    ppx::FrameTiming GetLastFrameTiming() const { return mFramePacer.GetLastCompletedFrame(); }
+
     const KeyState& GetKeyState(KeyCode code) const;
     float2          GetNormalizedDeviceCoordinates(int32_t x, int32_t y) const;
 
@@ -459,6 +489,15 @@ private:
     void MouseUpCallback(int32_t x, int32_t y, uint32_t buttons);
     void ScrollCallback(float dx, float dy);
 
+    void WriteMemoryStats();
+    void WriteFrameStats();
+    void WriteGpuStats();
+
+private:
+    // Requires --pipeline-cache-file
+    void LoadPipelineCache();
+    void SavePipelineCache();
+
 private:
     CommandLineParser               mCommandLineParser;
     StandardOptions                 mStandardOptions;
@@ -466,6 +505,7 @@ private:
     ApplicationSettings             mSettings = {};
     std::string                     mDecoratedApiName;
     Timer                           mTimer;
+    Timer                           mStartupTimer;
     void*                           mWindow                     = nullptr; // Requires enableDisplay
     bool                            mWindowSurfaceInvalid       = false;
     KeyState                        mKeyStates[TOTAL_KEY_COUNT] = {false, 0.0f};
@@ -485,9 +525,20 @@ private:
     float             mFrameEndTime      = 0;
     float             mPreviousFrameTime = 0;
     float             mAverageFrameTime  = 0;
-    double            mFirstFrameTime    = 0;
+    float             mTimeToFirstFrame  = 0;
     std::deque<float> mFrameTimesMs;
 
+    FramePacer                    mFramePacer;
+    std::vector<ppx::FrameTiming> mFrameTimings;
+    std::unique_ptr<CSVFileLog>   mMemoryStatsLog; // Requires --memory-stats-file
+    grfx::MemoryStats             mMemoryStats;    // Last detailed query drawn by DrawMemoryStats()
+    float                         mMemoryStatsTime  = 0;
+    bool                          mMemoryStatsValid = false;
+    std::unique_ptr<CSVFileLog>   mFrameStatsLog;  // Requires --frame-stats-file
+    grfx::GpuProfilerPtr          mGpuProfiler;    // Requires enableGpuProfiler
+    std::unique_ptr<CSVFileLog>   mGpuStatsLog;    // Requires --gpu-stats-file
+    uint64_t                      mGpuStatsFrame = UINT64_MAX;
+
 #if defined(PPX_BUILD_XR)
     XrComponent mXrComponent;
     uint32_t    mDebugCaptureSwapchainIndex = 0;
@@ -94,6 +94,25 @@ public:
     Result Resize(uint32_t width, uint32_t height);
     Result ScaleTo(Bitmap* pTargetBitmap) const;
 
+    //! Converts pixels into the format of \b pTargetBitmap, which must have the same dimensions.
+    //! Integer channels are treated as normalized. Added color channels are set to 0 and an
+    //! added alpha channel to 1.
+    Result ConvertTo(Bitmap* pTargetBitmap) const;
+
+    //! Multiplies RGB by A. Format must have 4 channels.
+    Result PremultiplyAlpha();
+
+    // Applies the sRGB transfer function to color channels, alpha is left untouched.
+    Result ConvertSRGBToLinear();
+    Result ConvertLinearToSRGB();
+
+    Result FlipVertical();
+    Result FlipHorizontal();
+    Result Rotate180();
+    //! Writes this bitmap rotated by 90 degrees into \b pTargetBitmap, which must have the
+    //! same format and swapped dimensions.
+    Result Rotate90(bool clockwise, Bitmap* pTargetBitmap) const;
+
     template <typename PixelDataType>
     void Fill(PixelDataType r, PixelDataType g, PixelDataType b, PixelDataType a);
 
@@ -133,7 +152,11 @@ public:
         friend class ppx::Bitmap;
 
         PixelIterator(Bitmap* pBitmap)
-            : mBitmap(pBitmap)
+            : mBitmap(pBitmap),
+              mWidth(pBitmap->GetWidth()),
+              mHeight(pBitmap->GetHeight()),
+              mPixelStride(pBitmap->GetPixelStride()),
+              mRowStride(pBitmap->GetRowStride())
         {
             Reset();
         }
@@ -143,15 +166,18 @@ public:
         {
             mX            = 0;
             mY            = 0;
-            mPixelAddress = mBitmap->GetPixelAddress(mX, mY);
+            mRowAddress   = mBitmap->GetData();
+            mPixelAddress = mRowAddress;
         }
 
         bool Done() const
         {
-            bool done = (mY >= mBitmap->GetHeight());
+            bool done = (mY >= mHeight);
             return done;
         }
 
+        // Dimensions and strides are cached at construction so that stepping
+        // is pointer arithmetic only, without GetPixelAddress() bounds checks.
         bool Next()
         {
             if (Done()) {
@@ -159,11 +185,12 @@ public:
             }
 
             mX += 1;
-            mPixelAddress += mBitmap->GetPixelStride();
-            if (mX == mBitmap->GetWidth()) {
+            mPixelAddress += mPixelStride;
+            if (mX == mWidth) {
                 mY += 1;
-                mX            = 0;
-                mPixelAddress = mBitmap->GetPixelAddress(mX, mY);
+                mX = 0;
+                mRowAddress += mRowStride;
+                mPixelAddress = mRowAddress;
             }
 
             return Done() ? false : true;
@@ -179,8 +206,13 @@ public:
 
     private:
         Bitmap*  mBitmap       = nullptr;
+        uint32_t mWidth        = 0;
+        uint32_t mHeight       = 0;
+        uint32_t mPixelStride  = 0;
+        uint32_t mRowStride    = 0;
         uint32_t mX            = 0;
         uint32_t mY            = 0;
+        char*    mRowAddress   = nullptr;
         char*    mPixelAddress = nullptr;
     };
 
@@ -190,6 +222,7 @@ public:
 
 private:
     void   InternalCtor();
+    void   InternalFill(const void* pPixel);
     Result InternalInitialize(uint32_t width, uint32_t height, Bitmap::Format format, uint32_t rowStride, char* pExternalStorage);
     Result InternalCopy(const Bitmap& obj);
 
@@ -210,20 +243,11 @@ void Bitmap::Fill(PixelDataType r, PixelDataType g, PixelDataType b, PixelDataTy
     PPX_ASSERT_MSG(mData != nullptr, "data is null");
     PPX_ASSERT_MSG(mFormat != Bitmap::FORMAT_UNDEFINED, "format is undefined");
 
-    PixelDataType rgba[4] = {r, g, b, a};
+    PPX_ASSERT_MSG(sizeof(PixelDataType) == Bitmap::ChannelSize(mFormat), "pixel data type does not match format channel size");
 
-    const uint32_t channelCount = Bitmap::ChannelCount(mFormat);
-
-    char* pData = mData;
-    for (uint32_t y = 0; y < mHeight; ++y) {
-        for (uint32_t x = 0; x < mWidth; ++x) {
-            PixelDataType* pPixelData = reinterpret_cast<PixelDataType*>(pData);
-            for (uint32_t c = 0; c < channelCount; ++c) {
-                pPixelData[c] = rgba[c];
-            }
-            pData += mPixelStride;
-        }
-    }
+    // Only the first ChannelCount(mFormat) values are used
+    PixelDataType rgba[4] = {r, g, b, a};
+    InternalFill(rgba);
 }
 
 } // namespace ppx
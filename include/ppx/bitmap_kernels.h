@@ -0,0 +1,95 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_bitmap_kernels_h
+#define ppx_bitmap_kernels_h
+
+#include "ppx/instruction_set.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Row-level pixel kernels used by ppx::Bitmap.
+//
+// Each kernel has a scalar reference implementation and, where it pays off,
+// SSE2/AVX2 (x86) or NEON (ARM) variants. The variant is picked once at
+// runtime from the CPU features reported by ppx::Platform (cpu_features).
+// All variants of a kernel produce bit identical results.
+//
+// Integer channels are treated as normalized values when converting
+// to and from float: 0 maps to 0.0 and the type's max value maps to 1.0.
+//
+namespace ppx {
+namespace bitmap_kernels {
+
+//! Size in bytes of the pattern consumed by FillRow(). Every
+//! Bitmap::Format pixel size (1, 2, 3, 4, 6, 8, 12, 16) divides it.
+const uint32_t kFillPatternSize = 96;
+
+//! Returns the instruction set currently used for dispatch, initially
+//! ppx::GetBestInstructionSet().
+InstructionSet GetInstructionSet();
+
+//! Overrides kernel dispatch, mostly useful for tests and benchmarks.
+//! Returns false and leaves dispatch unchanged if \b value is not supported.
+//! Not thread safe with respect to kernels running concurrently.
+bool SetInstructionSet(InstructionSet value);
+
+//! Replicates \b pixelSize bytes at \b pPixel into a kFillPatternSize byte pattern.
+void BuildFillPattern(const void* pPixel, uint32_t pixelSize, uint8_t* pPattern);
+
+//! Writes \b byteCount bytes of the repeating pattern built by BuildFillPattern() to \b pDst.
+void FillRow(void* pDst, size_t byteCount, const uint8_t* pPattern);
+
+// Element-wise type conversions, \b count is the number of channel values.
+void ConvertU8ToF32(const uint8_t* pSrc, float* pDst, size_t count);
+void ConvertF32ToU8(const float* pSrc, uint8_t* pDst, size_t count);
+void ConvertU16ToF32(const uint16_t* pSrc, float* pDst, size_t count);
+void ConvertF32ToU16(const float* pSrc, uint16_t* pDst, size_t count);
+void ConvertU32ToF32(const uint32_t* pSrc, float* pDst, size_t count);
+void ConvertF32ToU32(const float* pSrc, uint32_t* pDst, size_t count);
+
+//! Expands 8-bit RGB pixels to RGBA using \b alpha for the fourth channel.
+void ExpandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha);
+
+//! Changes the number of channels per pixel. Dropped channels are discarded,
+//! added color channels are set to 0 and an added alpha channel to 1.
+void SwizzleChannelsF32(const float* pSrc, uint32_t srcChannelCount, float* pDst, uint32_t dstChannelCount, size_t pixelCount);
+
+// Multiplies RGB by A in place.
+void PremultiplyAlphaRGBA8(uint8_t* pPixels, size_t pixelCount);
+void PremultiplyAlphaRGBA16(uint16_t* pPixels, size_t pixelCount);
+void PremultiplyAlphaRGBAF32(float* pPixels, size_t pixelCount);
+
+// sRGB transfer function, applied to the first \b colorChannelCount
+// channels of each pixel (alpha is left untouched).
+void SRGBToLinearU8(uint8_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+void LinearToSRGBU8(uint8_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+void SRGBToLinearU16(uint16_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+void LinearToSRGBU16(uint16_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+void SRGBToLinearF32(float* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+void LinearToSRGBF32(float* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount);
+
+//! Reverses the order of \b pixelCount pixels of \b pixelSize bytes in place.
+void ReverseRow(void* pPixels, size_t pixelCount, uint32_t pixelSize);
+
+//! Copies a \b width x \b height block of pixels, rotating by 90 degrees.
+//! Clockwise rotation writes a \b height x \b width block to \b pDst.
+void Rotate90(const void* pSrc, uint32_t srcRowStride, void* pDst, uint32_t dstRowStride, uint32_t width, uint32_t height, uint32_t pixelSize, bool clockwise);
+
+} // namespace bitmap_kernels
+} // namespace ppx
+
+#endif // ppx_bitmap_kernels_h
@@ -0,0 +1,215 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_bvh_h
+#define ppx_bvh_h
+
+#include "ppx/config.h"
+#include "ppx/bounding_volume.h"
+#include "ppx/instruction_set.h"
+#include "ppx/math_config.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+namespace ppx {
+
+class TriMesh;
+
+//! @struct Ray
+//!
+//! \b direction doesn't need to be normalized, hit distances are in units
+//! of its length.
+//!
+struct Ray
+{
+    float3 origin    = float3(0);
+    float3 direction = float3(0, 0, -1);
+    float  tMin      = 0;
+    float  tMax      = FLT_MAX;
+
+    Ray() {}
+
+    Ray(const float3& origin_, const float3& direction_, float tMin_ = 0, float tMax_ = FLT_MAX)
+        : origin(origin_), direction(direction_), tMin(tMin_), tMax(tMax_) {}
+
+    float3 GetPoint(float t) const { return origin + t * direction; }
+};
+
+//! @struct RayHit
+//!
+//! \b barycentrics are the weights of the second and third vertex of the
+//! triangle that was hit, they are left at zero for boxes.
+//!
+struct RayHit
+{
+    float    t              = FLT_MAX;
+    uint32_t primitiveIndex = UINT32_MAX;
+    float2   barycentrics   = float2(0);
+
+    bool IsHit() const { return primitiveIndex != UINT32_MAX; }
+};
+
+//! @struct BvhStats
+//!
+//!
+struct BvhStats
+{
+    uint32_t primitiveCount = 0;
+    uint32_t nodeCount      = 0;
+    uint32_t leafCount      = 0;
+    uint32_t maxDepth       = 0;
+    uint32_t threadCount    = 0;
+    double   buildTimeMs    = 0;
+    double   refitTimeMs    = 0;
+};
+
+//! @class Bvh
+//!
+//! Bounding volume hierarchy over the triangles of a mesh or over a list of
+//! boxes, for ray casts and box queries on the CPU.
+//!
+//! The tree is built top down with a binned surface area heuristic (SAH).
+//! The top levels are split on the calling thread, the subtrees below them
+//! are built on multiple threads. The binary tree is then collapsed into a
+//! 4-wide tree whose child boxes are stored as structure of arrays, so a ray
+//! is tested against the 4 children of a node at once with SSE2 or NEON.
+//!
+//! Refit() updates the boxes of an existing tree for primitives that moved,
+//! e.g. an animated mesh, without changing its topology. It's much cheaper
+//! than a rebuild, but the tree gets less efficient if primitives move far
+//! from where they were at build time.
+//!
+class Bvh
+{
+public:
+    //! Default largest number of primitives in a leaf.
+    static const uint32_t kDefaultMaxLeafSize = 4;
+
+    Bvh();
+    ~Bvh() {}
+
+    //! Returns false and leaves the BVH unchanged if \b value is not supported.
+    //! Nodes have 4 children, so there is no AVX2 traversal and
+    //! INSTRUCTION_SET_AVX2 is never supported.
+    bool           SetInstructionSet(InstructionSet value);
+    InstructionSet GetInstructionSet() const { return mInstructionSet; }
+
+    //! A \b threadCount of 0 uses all hardware threads, 1 builds on the
+    //! calling thread only.
+    void     SetThreadCount(uint32_t threadCount) { mThreadCount = threadCount; }
+    uint32_t GetThreadCount() const { return mThreadCount; }
+
+    //! Leaves can still get larger than \b maxLeafSize if their primitives
+    //! can't be split, e.g. if they all have the same center.
+    void     SetMaxLeafSize(uint32_t maxLeafSize) { mMaxLeafSize = std::max<uint32_t>(maxLeafSize, 1); }
+    uint32_t GetMaxLeafSize() const { return mMaxLeafSize; }
+
+    //! Builds over the triangles of \b mesh. The mesh positions and indices
+    //! are copied, \b mesh doesn't need to outlive the BVH.
+    Result Build(const TriMesh& mesh);
+
+    //! Builds over \b triangleCount triangles. \b pIndices holds 3 indices
+    //! per triangle, or is null if the positions are a plain triangle list.
+    Result Build(uint32_t vertexCount, const float3* pPositions, uint32_t triangleCount, const uint32_t* pIndices);
+
+    //! Builds over \b count boxes, e.g. the world bounds of scene objects.
+    Result Build(uint32_t count, const AABB* pBoxes);
+
+    //! Updates the tree for new positions of the same \b vertexCount vertices
+    //! used to build it.
+    Result Refit(uint32_t vertexCount, const float3* pPositions);
+
+    //! Updates the tree for new boxes, \b count must match the build.
+    Result Refit(uint32_t count, const AABB* pBoxes);
+
+    void Clear();
+
+    //! Finds the closest triangle or box that \b ray hits between its
+    //! \b tMin and \b tMax. Boxes are hit where the ray enters them, or at
+    //! \b tMin if the ray starts inside. Returns false if nothing was hit.
+    bool Intersect(const Ray& ray, RayHit* pHit) const;
+
+    //! Returns true as soon as any hit is found, for shadow or visibility
+    //! rays. Cheaper than Intersect() since it doesn't look for the closest.
+    bool IntersectAny(const Ray& ray) const;
+
+    //! Appends the index of every primitive whose bounds overlap \b box to
+    //! \b pResults. Returns how many were appended.
+    uint32_t Query(const AABB& box, std::vector<uint32_t>* pResults) const;
+
+    bool            IsEmpty() const { return mNodes.empty(); }
+    uint32_t        GetPrimitiveCount() const { return CountU32(mPrimitiveBounds); }
+    AABB            GetBounds() const { return mBounds; }
+    const BvhStats& GetStats() const { return mStats; }
+
+private:
+    //! 4 children stored as structure of arrays. An inner child has a count
+    //! of 0 and \b child is the index of its node. A leaf child has a count
+    //! of at least 1 and \b child is its first entry in mPrimitiveIndices.
+    //! Unused children have a count of 0, an invalid index and empty bounds.
+    struct alignas(16) Node
+    {
+        float    minX[4];
+        float    minY[4];
+        float    minZ[4];
+        float    maxX[4];
+        float    maxY[4];
+        float    maxZ[4];
+        uint32_t child[4];
+        uint32_t count[4];
+    };
+
+    struct BuildNode;
+    struct BuildTask;
+
+    enum PrimitiveType
+    {
+        PRIMITIVE_TYPE_TRIANGLE = 0,
+        PRIMITIVE_TYPE_BOX      = 1,
+    };
+
+    Result   BuildTree();
+    void     ComputeTriangleBounds();
+    void     UpdateLeafVertices();
+    void     RefitNodes();
+    void     BuildRange(std::vector<BuildNode>& nodes, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth, uint32_t taskThreshold, std::vector<BuildTask>* pTasks);
+    uint32_t Collapse(const std::vector<BuildNode>& nodes, uint32_t nodeIndex, uint32_t depth);
+
+    bool IntersectLeafEntry(uint32_t entry, const Ray& ray, float tMax, RayHit* pHit) const;
+
+    template <InstructionSet IS, bool ANY_HIT>
+    bool Traverse(const Ray& ray, RayHit* pHit) const;
+
+private:
+    InstructionSet        mInstructionSet = INSTRUCTION_SET_SCALAR;
+    uint32_t              mThreadCount    = 1;
+    uint32_t              mMaxLeafSize    = kDefaultMaxLeafSize;
+    PrimitiveType         mPrimitiveType  = PRIMITIVE_TYPE_TRIANGLE;
+    std::vector<float3>   mPositions;
+    std::vector<uint32_t> mIndices;          // 3 per triangle
+    std::vector<AABB>     mPrimitiveBounds;  // Triangle or box bounds
+    std::vector<float3>   mCentroids;        // Only used while building
+    std::vector<uint32_t> mPrimitiveIndices; // Leaf entries, in tree order
+    std::vector<float3>   mLeafVertices;     // 3 per leaf entry, so rays don't go through the indices
+    std::vector<Node>     mNodes;            // Root first, children after their parent
+    AABB                  mBounds;
+    BvhStats              mStats;
+};
+
+} // namespace ppx
+
+#endif // ppx_bvh_h
@@ -44,6 +44,11 @@ struct StandardOptions
 
     int         screenshot_frame_number                  = -1;
     std::string screenshot_path                          = "";
+    std::string memory_stats_file                        = "";
+    std::string pipeline_cache_file                      = "";
+    std::string frame_pacing                             = "";
+    std::string frame_stats_file                         = "";
+    std::string gpu_stats_file                           = "";
     bool        operator==(const StandardOptions&) const = default;
 };
 
@@ -169,9 +174,17 @@ private:
 
 --deterministic               Disable non-deterministic behaviors, like clocks.
 --frame-count <N>             Shutdown the application after successfully rendering N frames.
+--frame-pacing <mode>         Override the application's frame pacing: unlocked, vsync, fixed-rate or low-latency.
+--frame-stats-file <path>     Write CPU frame time, pacing wait, present latency and queue idle time to this CSV file
+                              for every frame, in milliseconds.
+--gpu-stats-file <path>       Enable the GPU profiler and write the GPU time, and pipeline statistics if available, of
+                              every profiler scope to this CSV file.
 --gpu <index>                 Select the gpu with the given index. To determine the set of valid indices use --list-gpus.
 --headless                    Run the sample without creating windows.
 --list-gpus                   Prints a list of the available GPUs on the current system with their index and exits (see --gpu).
+--memory-stats-file <path>    Write GPU memory usage, budget and per category totals to this CSV file every frame.
+--pipeline-cache-file <path>  Load compiled pipelines from this file before setup, and save them to it on exit,
+                              so pipelines compile faster on the next run. Vulkan only.
 --resolution <Width>x<Height> Specify the main window resolution in pixels. Width and Height must be two positive integers greater or equal to 1.
 --screenshot-frame-number <N> Take a screenshot of frame number N and save it in PPM format.
                               See also `--screenshot-path`.
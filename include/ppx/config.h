@@ -142,6 +142,7 @@ enum Result
     ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION       = -1020,
     ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_COUNT       = -1021,
     ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_STRIDE      = -1022,
+    ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE       = -1023,
 
     ERROR_IMAGE_FILE_LOAD_FAILED               = -2000,
     ERROR_IMAGE_FILE_SAVE_FAILED               = -2001,
@@ -221,6 +222,7 @@ inline const char* ToString(ppx::Result value)
         case Result::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION        : return "ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION ";
         case Result::ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_COUNT        : return "ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_COUNT ";
         case Result::ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_STRIDE       : return "ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_STRIDE";
+        case Result::ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE        : return "ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE";
 
         case Result::ERROR_IMAGE_FILE_LOAD_FAILED                     : return "ERROR_IMAGE_FILE_LOAD_FAILED";
         case Result::ERROR_IMAGE_FILE_SAVE_FAILED                     : return "ERROR_IMAGE_FILE_SAVE_FAILED";
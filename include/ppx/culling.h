@@ -0,0 +1,176 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_culling_h
+#define ppx_culling_h
+
+#include "ppx/bounding_volume.h"
+#include "ppx/instruction_set.h"
+#include "ppx/math_config.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ppx {
+
+class Camera;
+
+//! @class Frustum
+//!
+//! Six planes extracted from a view projection matrix with a zero to one
+//! depth range. Plane normals point inwards and are normalized, a point p is
+//! inside a plane if dot(plane.xyz, p) + plane.w >= 0.
+//!
+class Frustum
+{
+public:
+    enum Plane
+    {
+        PLANE_LEFT   = 0,
+        PLANE_RIGHT  = 1,
+        PLANE_BOTTOM = 2,
+        PLANE_TOP    = 3,
+        PLANE_NEAR   = 4,
+        PLANE_FAR    = 5,
+        PLANE_COUNT  = 6,
+    };
+
+    Frustum() {}
+
+    Frustum(const float4x4& viewProjection)
+    {
+        Set(viewProjection);
+    }
+
+    Frustum(const Camera& camera)
+    {
+        Set(camera);
+    }
+
+    ~Frustum() {}
+
+    void Set(const float4x4& viewProjection);
+    void Set(const Camera& camera);
+
+    const float4& GetPlane(uint32_t index) const { return mPlanes[index]; }
+
+    bool Contains(const float3& point) const;
+
+    //! These tests are conservative: they never reject an object that is
+    //! inside the frustum, but may accept one that is just outside a corner.
+    bool Intersects(const AABB& aabb) const;
+    bool Intersects(const OBB& obb) const;
+    bool IntersectsSphere(const float3& center, float radius) const;
+
+private:
+    float4 mPlanes[PLANE_COUNT] = {};
+};
+
+//! @struct CullingStats
+//!
+//! Filled by FrustumCuller::Cull(). \b occlusionCulledCount is left to the
+//! caller, e.g. from grfx::OcclusionCuller results, since the GPU pass runs
+//! after the CPU one.
+//!
+struct CullingStats
+{
+    uint32_t    objectCount          = 0;
+    uint32_t    frustumCulledCount   = 0;
+    uint32_t    occlusionCulledCount = 0;
+    uint32_t    visibleCount         = 0;
+    uint32_t    threadCount          = 0;
+    double      cpuTimeMs            = 0;
+    const char* pInstructionSet      = "";
+};
+
+//! @class FrustumCuller
+//!
+//! Tests large arrays of bounding volumes against a frustum. Volumes are
+//! stored as structure of arrays, each one as a center, world space half
+//! extents and a radius, so boxes and spheres go through the same test:
+//!
+//!   visible = dot(n, center) + w + dot(abs(n), extents) + radius >= 0
+//!
+//! for every plane. An OBB is tested as the world space box that bounds it.
+//! The test runs 4 (SSE2, NEON) or 8 (AVX2) volumes at a time, the variant
+//! is picked at runtime from the CPU features reported by ppx::Platform.
+//! Large arrays are split into chunks that are culled on multiple threads.
+//!
+class FrustumCuller
+{
+public:
+    //! Default number of volumes per chunk, a multiple of 8.
+    static const uint32_t kDefaultChunkSize = 4096;
+
+    FrustumCuller();
+    ~FrustumCuller() {}
+
+    //! Returns false and leaves the culler unchanged if \b value is not supported.
+    bool           SetInstructionSet(InstructionSet value);
+    InstructionSet GetInstructionSet() const { return mInstructionSet; }
+
+    //! A \b threadCount of 0 uses all hardware threads, 1 culls on the
+    //! calling thread only. Threads are started for each Cull() call, so
+    //! small arrays are best culled on one thread.
+    void     SetThreadCount(uint32_t threadCount) { mThreadCount = threadCount; }
+    uint32_t GetThreadCount() const { return mThreadCount; }
+
+    //! \b chunkSize is rounded up to a multiple of 8.
+    void     SetChunkSize(uint32_t chunkSize);
+    uint32_t GetChunkSize() const { return mChunkSize; }
+
+    //! Add functions return the index of the volume, which is what Cull() reports.
+    uint32_t AddAABB(const AABB& aabb);
+    uint32_t AddOBB(const OBB& obb);
+    uint32_t AddSphere(const float3& center, float radius);
+
+    void SetAABB(uint32_t index, const AABB& aabb);
+    void SetOBB(uint32_t index, const OBB& obb);
+    void SetSphere(uint32_t index, const float3& center, float radius);
+
+    void     Reserve(uint32_t count);
+    void     Clear();
+    uint32_t GetCount() const { return mCount; }
+
+    //! Writes the indices of the volumes that intersect \b frustum to
+    //! \b pVisible in increasing order, and returns how many there are.
+    uint32_t Cull(const Frustum& frustum, std::vector<uint32_t>* pVisible);
+
+    //! Stats of the last Cull() call.
+    const CullingStats& GetStats() const { return mStats; }
+
+private:
+    uint32_t Add(const float3& center, const float3& extents, float radius);
+    void     Set(uint32_t index, const float3& center, const float3& extents, float radius);
+
+private:
+    InstructionSet        mInstructionSet = INSTRUCTION_SET_SCALAR;
+    uint32_t              mThreadCount    = 1;
+    uint32_t              mChunkSize      = kDefaultChunkSize;
+    uint32_t              mCount          = 0;
+    std::vector<float>    mCenterX;
+    std::vector<float>    mCenterY;
+    std::vector<float>    mCenterZ;
+    std::vector<float>    mExtentX;
+    std::vector<float>    mExtentY;
+    std::vector<float>    mExtentZ;
+    std::vector<float>    mRadius;
+    std::vector<uint32_t> mChunkVisible;
+    std::vector<uint32_t> mChunkVisibleCounts;
+    CullingStats          mStats;
+};
+
+} // namespace ppx
+
+#endif // ppx_culling_h
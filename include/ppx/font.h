@@ -75,6 +75,20 @@ public:
         uint32_t       rowStride,
         unsigned char* pOutput) const;
 
+    //! Renders a signed distance field of the glyph. The field covers the
+    //! glyph's box at no subpixel shift grown by \b padding pixels on every
+    //! side. Values are 128 on the outline and change by 128 / \b padding per
+    //! pixel, increasing towards the inside. Output beyond the field is left
+    //! untouched.
+    void RenderGlyphSDF(
+        float          fontSizeInPixels,
+        uint32_t       codepoint,
+        uint32_t       padding,
+        uint32_t       glyphWidth,
+        uint32_t       glyphHeight,
+        uint32_t       rowStride,
+        unsigned char* pOutput) const;
+
 private:
     void AcquireFontMetrics();
 
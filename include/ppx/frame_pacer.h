@@ -0,0 +1,152 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_frame_pacer_h
+#define ppx_frame_pacer_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/timer.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ppx {
+
+//! @enum FramePacingMode
+//!
+//!
+enum FramePacingMode
+{
+    FRAME_PACING_MODE_UNLOCKED    = 0, // Frames start as soon as the previous one is submitted
+    FRAME_PACING_MODE_VSYNC       = 1, // FIFO presentation, acquiring images blocks on the display
+    FRAME_PACING_MODE_FIXED_RATE  = 2, // Frames start at ApplicationSettings::grfx.pacedFrameRate
+    FRAME_PACING_MODE_LOW_LATENCY = 3, // Frames start once the GPU has finished the previous ones
+};
+
+//! Parses "unlocked", "vsync", "fixed-rate" and "low-latency". Returns
+//! false and leaves \b pMode unchanged for anything else.
+bool ParseFramePacingMode(const std::string& name, ppx::FramePacingMode* pMode);
+
+const char* ToString(ppx::FramePacingMode mode);
+
+//! @struct FrameTiming
+//!
+//! Timings of a frame, in milliseconds.
+//!
+struct FrameTiming
+{
+    uint64_t frameNumber          = 0;
+    double   cpuFrameTime         = 0; // From BeginRender() to EndRender()
+    double   pacingWaitTime       = 0; // Spent in WaitForFrameStart() before the frame
+    double   gpuCompletionLatency = 0; // From EndRender(), when the frame has been submitted and presented, to the GPU finishing it
+    double   queueIdleTime        = 0; // From the GPU finishing the previous frames to BeginRender(), 0 if it was still busy
+};
+
+//! @class FramePacer
+//!
+//! Decides when frames start and measures how long their GPU work takes.
+//! Every frame, the application calls WaitForFrameStart() before sampling
+//! input, then BeginRender() and EndRender() around its rendering.
+//!
+//! In FRAME_PACING_MODE_LOW_LATENCY, or if GPU completion is measured,
+//! EndRender() submits a timeline semaphore signal to the queue, which a
+//! thread waits on to timestamp the completion of each frame. Otherwise
+//! there's no extra submit or thread, and frames are reported as soon as
+//! EndRender() is called, with no GPU completion latency or queue idle
+//! time. Without timeline semaphores, FRAME_PACING_MODE_LOW_LATENCY waits
+//! for the queue to be idle instead.
+//!
+class FramePacer
+{
+public:
+    //! FIXED_RATE sleeps until this long before a frame is due, then spins,
+    //! since sleeps can overshoot by about a scheduler tick.
+    static constexpr double kSpinThresholdMs = 2.0;
+
+    FramePacer() {}
+    ~FramePacer();
+
+    FramePacer(const FramePacer&)            = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    //! \b frameRate is only used by FRAME_PACING_MODE_FIXED_RATE, 0 disables
+    //! pacing. \b measureGpuCompletion fills in the GPU completion latency
+    //! and queue idle time of frames in all modes. \b pQueue can be null to
+    //! pace without measuring GPU timings.
+    Result Initialize(ppx::FramePacingMode mode, uint32_t frameRate, bool measureGpuCompletion, grfx::Queue* pQueue);
+
+    //! Waits for the frames in flight to complete, then stops the thread.
+    //! The queue must not be destroyed before this is called.
+    void Shutdown();
+
+    ppx::FramePacingMode GetMode() const { return mMode; }
+
+    //! True if completed frames have GPU completion latencies and queue
+    //! idle times.
+    bool MeasuresGpuCompletion() const { return !mSemaphore.IsNull(); }
+
+    void WaitForFrameStart();
+    void BeginRender();
+    void EndRender();
+
+    //! Appends the timings of frames completed since the last call to
+    //! \b pTimings, in frame order.
+    void GetCompletedFrames(std::vector<ppx::FrameTiming>* pTimings);
+
+    //! Returns the timing of the last completed frame.
+    ppx::FrameTiming GetLastCompletedFrame() const;
+
+private:
+    void WaitForFixedRate();
+    void WaitForGpu();
+    void WatcherMain();
+
+    struct InFlightFrame
+    {
+        ppx::FrameTiming timing       = {};
+        double           submitTimeMs = 0;
+    };
+
+private:
+    ppx::FramePacingMode mMode            = ppx::FRAME_PACING_MODE_UNLOCKED;
+    double               mPeriodMs        = 0;
+    double               mNextFrameTimeMs = -1; // Negative until the first paced frame
+    double               mPacingWaitMs    = 0;
+    double               mRenderStartMs   = 0;
+    ppx::FrameTiming     mCurrentFrame    = {};
+    grfx::Queue*         mQueue           = nullptr;
+    grfx::SemaphorePtr   mSemaphore; // Timeline, signaled with the frame number
+    ppx::Timer           mTimer;
+
+    // Shared with the watcher thread
+    mutable std::mutex            mMutex;
+    std::condition_variable       mFrameSubmitted;
+    std::condition_variable       mFrameCompleted;
+    std::thread                   mWatcher;
+    bool                          mStopping         = false;
+    uint64_t                      mSubmittedValue   = 0;
+    uint64_t                      mCompletedValue   = 0;
+    double                        mLastCompletionMs = 0;
+    std::deque<InFlightFrame>     mInFlightFrames;
+    std::vector<ppx::FrameTiming> mCompletedFrames;
+    ppx::FrameTiming              mLastCompletedFrame = {};
+};
+
+} // namespace ppx
+
+#endif // ppx_frame_pacer_h
@@ -21,6 +21,7 @@
 #include "ppx/bitmap.h"
 #include "ppx/geometry.h"
 #include "ppx/mipmap.h"
+#include "ppx/texture_atlas.h"
 #include "gli/gli.hpp"
 
 #include <array>
@@ -69,6 +70,12 @@ private:
         const Bitmap*       pBitmap,
         grfx::Image**       ppImage,
         const ImageOptions& options);
+
+    friend Result CreateImageFromTextureAtlas(
+        grfx::Queue*        pQueue,
+        const TextureAtlas* pAtlas,
+        grfx::Image**       ppImage,
+        const ImageOptions& options);
 };
 
 //! @fn CopyBitmapToImage
@@ -111,6 +118,18 @@ Result CreateImageFromBitmapGpu(
     grfx::Image**       ppImage,
     const ImageOptions& options = ImageOptions());
 
+//! @fn CreateImageFromTextureAtlas
+//!
+//! Creates a 2D image with one array layer per layer of \b pAtlas, which must
+//! be built. Mip levels beyond what the atlas padding was sized for will bleed
+//! between entries, see TextureAtlas::CalculateMipPadding().
+//!
+Result CreateImageFromTextureAtlas(
+    grfx::Queue*        pQueue,
+    const TextureAtlas* pAtlas,
+    grfx::Image**       ppImage,
+    const ImageOptions& options = ImageOptions());
+
 // -------------------------------------------------------------------------------------------------
 
 class TextureOptions
@@ -37,9 +37,19 @@ public:
 private:
     virtual void BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo) override;
     virtual void EndRenderPassImpl() override;
-
-public:
-    virtual void TransitionImageLayout(
+    virtual void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo) override;
+    virtual void EndRenderingImpl() override;
+
+    // Binds the views and clears the ones with ATTACHMENT_LOAD_OP_CLEAR
+    void SetRenderTargets(
+        uint32_t                             renderTargetCount,
+        const grfx::RenderTargetView* const* ppRenderTargetViews,
+        const grfx::DepthStencilView*        pDepthStencilView,
+        uint32_t                             clearValueCount,
+        const grfx::RenderTargetClearValue*  pRTVClearValues,
+        const grfx::DepthStencilClearValue&  DSVClearValue);
+
+    virtual void TransitionImageLayoutImpl(
         const grfx::Image*  pImage,
         uint32_t            mipLevel,
         uint32_t            mipLevelCount,
@@ -50,12 +60,15 @@ public:
         const grfx::Queue*  pSrcQueue,
         const grfx::Queue*  pDstQueue) override;
 
-    virtual void BufferResourceBarrier(
+    virtual void BufferResourceBarrierImpl(
         const grfx::Buffer* pBuffer,
         grfx::ResourceState beforeState,
         grfx::ResourceState afterState,
-        const grfx::Queue*  pSrcQueue = nullptr,
-        const grfx::Queue*  pDstQueue = nullptr) override;
+        const grfx::Queue*  pSrcQueue,
+        const grfx::Queue*  pDstQueue) override;
+
+public:
+    virtual void FlushBarriers() override;
 
     virtual void SetViewports(
         uint32_t              viewportCount,
@@ -68,14 +81,18 @@ public:
     virtual void BindGraphicsDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) override;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) override;
 
     virtual void BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline) override;
 
     virtual void BindComputeDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) override;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) override;
 
     virtual void BindComputePipeline(const grfx::ComputePipeline* pPipeline) override;
 
@@ -98,6 +115,12 @@ public:
         int32_t  vertexOffset,
         uint32_t firstInstance) override;
 
+    virtual void DrawIndexedIndirect(
+        const grfx::Buffer* pArgBuffer,
+        uint64_t            offset,
+        uint32_t            drawCount,
+        uint32_t            stride) override;
+
     virtual void Dispatch(
         uint32_t groupCountX,
         uint32_t groupCountY,
@@ -155,8 +178,11 @@ private:
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
         const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount,
+        const uint32_t*                   pDynamicOffsets,
         size_t&                           rdtCountCBVSRVUAV,
-        size_t&                           rdtCountSampler);
+        size_t&                           rdtCountSampler,
+        size_t&                           rdCount);
 
 private:
     D3D12GraphicsCommandListPtr mCommandList;
@@ -174,8 +200,19 @@ private:
         D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor = {~0ULL};
     };
 
+    struct RootDescriptor
+    {
+        UINT                      parameterIndex = PPX_VALUE_IGNORED;
+        bool                      isConstant     = true;
+        D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = 0;
+    };
+
     std::vector<RootDescriptorTable> mRootDescriptorTablesCBVSRVUAV;
     std::vector<RootDescriptorTable> mRootDescriptorTablesSampler;
+    std::vector<RootDescriptor>      mRootDescriptors;
+
+    // Barriers waiting for the next FlushBarriers()
+    std::vector<D3D12_RESOURCE_BARRIER> mPendingBarriers;
 };
 
 // -------------------------------------------------------------------------------------------------
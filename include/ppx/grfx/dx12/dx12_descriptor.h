@@ -77,6 +77,13 @@ public:
         D3D12_CPU_DESCRIPTOR_HANDLE descriptorHandle = {};
     };
 
+    struct RootDescriptor
+    {
+        UINT                      binding        = UINT32_MAX;
+        grfx::DescriptorType      type           = grfx::DESCRIPTOR_TYPE_UNDEFINED;
+        D3D12_GPU_VIRTUAL_ADDRESS bufferLocation = 0;
+    };
+
     DescriptorSet() {}
     virtual ~DescriptorSet() {}
 
@@ -88,6 +95,9 @@ public:
     typename D3D12DescriptorHeapPtr::InterfaceType* GetHeapCBVSRVUAV() const { return mHeapCBVSRVUAV.Get(); }
     typename D3D12DescriptorHeapPtr::InterfaceType* GetHeapSampler() const { return mHeapSampler.Get(); }
 
+    //! Dynamic uniform/storage buffers, sorted by binding number.
+    const std::vector<RootDescriptor>& GetRootDescriptors() const { return mRootDescriptors; }
+
     virtual Result UpdateDescriptors(uint32_t writeCount, const grfx::WriteDescriptor* pWrites) override;
 
 protected:
@@ -95,11 +105,12 @@ protected:
     virtual void   DestroyApiObjects() override;
 
 private:
-    UINT                    mNumDescriptorsCBVSRVUAV = 0;
-    UINT                    mNumDescriptorsSampler   = 0;
-    D3D12DescriptorHeapPtr  mHeapCBVSRVUAV;
-    D3D12DescriptorHeapPtr  mHeapSampler;
-    std::vector<HeapOffset> mHeapOffsets;
+    UINT                        mNumDescriptorsCBVSRVUAV = 0;
+    UINT                        mNumDescriptorsSampler   = 0;
+    D3D12DescriptorHeapPtr      mHeapCBVSRVUAV;
+    D3D12DescriptorHeapPtr      mHeapSampler;
+    std::vector<HeapOffset>     mHeapOffsets;
+    std::vector<RootDescriptor> mRootDescriptors;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -123,15 +134,19 @@ public:
     const std::vector<DescriptorRange>& GetRangesCBVSRVUAV() const { return mRangesCBVSRVUAV; }
     const std::vector<DescriptorRange>& GetRangesSampler() const { return mRangesSampler; }
 
+    //! Dynamic uniform/storage buffer bindings, sorted by binding number.
+    const std::vector<grfx::DescriptorBinding>& GetDynamicBindings() const { return mDynamicBindings; }
+
 protected:
     virtual Result CreateApiObjects(const grfx::DescriptorSetLayoutCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
 private:
-    uint32_t                     mCountCBVSRVUAV = 0;
-    uint32_t                     mCountSampler   = 0;
-    std::vector<DescriptorRange> mRangesCBVSRVUAV;
-    std::vector<DescriptorRange> mRangesSampler;
+    uint32_t                             mCountCBVSRVUAV = 0;
+    uint32_t                             mCountSampler   = 0;
+    std::vector<DescriptorRange>         mRangesCBVSRVUAV;
+    std::vector<DescriptorRange>         mRangesSampler;
+    std::vector<grfx::DescriptorBinding> mDynamicBindings;
 };
 
 } // namespace dx12
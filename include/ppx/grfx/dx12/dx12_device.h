@@ -36,6 +36,10 @@ public:
     UINT GetHandleIncrementSizeCBVSRVUAV() const { return mHandleIncrementSizeCBVSRVUAV; }
     UINT GetHandleIncrementSizeSampler() const { return mHandleIncrementSizeSampler; }
 
+    //! Command signature for ExecuteIndirect with tightly packed
+    //! grfx::DrawIndexedIndirectCommand arguments.
+    ID3D12CommandSignature* GetDrawIndexedIndirectSignature() const { return mDrawIndexedIndirectSignature.Get(); }
+
     Result AllocateRTVHandle(dx12::DescriptorHandle* pHandle);
     void   FreeRTVHandle(const dx12::DescriptorHandle* pHandle);
 
@@ -63,8 +67,15 @@ public:
 
     virtual bool PipelineStatsAvailable() const override;
     virtual bool DynamicRenderingSupported() const override;
+    virtual bool TimelineSemaphoreSupported() const override;
     virtual bool IndependentBlendingSupported() const override;
     virtual bool FragmentStoresAndAtomicsSupported() const override;
+    virtual bool SampledImageArrayDynamicIndexingSupported() const override;
+
+    // Not implemented, D3D12 pipeline libraries are keyed by name and would
+    // need an API to name pipelines
+    virtual Result GetPipelineCacheData(std::vector<char>* pData) const override;
+    virtual Result LoadPipelineCacheData(const void* pData, size_t size) override;
 
 protected:
     virtual Result AllocateObject(grfx::Buffer** ppObject) override;
@@ -95,6 +106,8 @@ protected:
     virtual Result CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+    virtual Result QueryMemoryStats(bool detailed, grfx::MemoryStats* pStats) const override;
+
 private:
     void   LoadRootSignatureFunctions();
     Result CreateQueues(const grfx::DeviceCreateInfo* pCreateInfo);
@@ -107,6 +120,7 @@ private:
     UINT                          mHandleIncrementSizeSampler   = 0;
     dx12::DescriptorHandleManager mRTVHandleManager;
     dx12::DescriptorHandleManager mDSVHandleManager;
+    D3D12CommandSignaturePtr      mDrawIndexedIndirectSignature;
 
     PFN_D3D12_CREATE_ROOT_SIGNATURE_DESERIALIZER           mFnD3D12CreateRootSignatureDeserializer          = nullptr;
     PFN_D3D12_SERIALIZE_VERSIONED_ROOT_SIGNATURE           mFnD3D12SerializeVersionedRootSignature          = nullptr;
@@ -34,6 +34,7 @@ public:
     virtual Result WaitIdle() override;
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) override;
+    virtual Result Submit(uint32_t submitCount, const grfx::SubmitInfo* pSubmitInfos) override;
 
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const override;
 
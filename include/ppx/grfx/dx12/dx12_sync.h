@@ -58,6 +58,7 @@ public:
 
     typename D3D12FencePtr::InterfaceType* GetDxFence() const { return mFence.Get(); }
 
+    // Binary semaphores only - timeline semaphores use the submitted values
     UINT64 GetNextSignalValue();
     UINT64 GetWaitForValue() const;
 
@@ -65,9 +66,14 @@ protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+    virtual Result   TimelineWait(uint64_t value, uint64_t timeout) const override;
+    virtual Result   TimelineSignal(uint64_t value) const override;
+    virtual uint64_t TimelineCounterValue() const override;
+
 private:
     D3D12FencePtr mFence;
-    UINT64        mValue = 0;
+    HANDLE        mFenceEventHandle = nullptr;
+    UINT64        mValue            = 0;
 };
 
 } // namespace dx12
@@ -31,6 +31,7 @@ struct BufferCreateInfo
     grfx::MemoryUsage      memoryUsage             = grfx::MEMORY_USAGE_GPU_ONLY;
     grfx::ResourceState    initialState            = grfx::RESOURCE_STATE_GENERAL;
     grfx::Ownership        ownership               = grfx::OWNERSHIP_REFERENCE;
+    grfx::MemoryCategory   memoryCategory          = grfx::MEMORY_CATEGORY_UNDEFINED; // Deduced from usage if undefined
 };
 
 //! @class Buffer
@@ -46,6 +47,13 @@ public:
     uint64_t                      GetSize() const { return mCreateInfo.size; }
     uint32_t                      GetStructuredElementStride() const { return mCreateInfo.structuredElementStride; }
     const grfx::BufferUsageFlags& GetUsageFlags() const { return mCreateInfo.usageFlags; }
+    grfx::MemoryCategory          GetMemoryCategory() const { return mCreateInfo.memoryCategory; }
+    uint64_t                      GetMemorySize() const { return mMemorySize; }
+
+    //! State after the last barrier recorded into any command buffer, so it
+    //! only matches the GPU if command buffers are submitted in the order
+    //! they're recorded.
+    grfx::ResourceState GetCurrentState() const { return mCurrentState; }
 
     virtual Result MapMemory(uint64_t offset, void** ppMappedAddress) = 0;
     virtual void   UnmapMemory()                                      = 0;
@@ -53,9 +61,17 @@ public:
     Result CopyFromSource(uint32_t dataSize, const void* pData);
     Result CopyToDest(uint32_t dataSize, void* pData);
 
+protected:
+    // Size of the memory allocated for the buffer, set by the API object
+    uint64_t mMemorySize = 0;
+
 private:
     virtual Result Create(const grfx::BufferCreateInfo* pCreateInfo) override;
     friend class grfx::Device;
+
+    // Updated by command buffers, which only get const pointers
+    friend class grfx::CommandBuffer;
+    mutable grfx::ResourceState mCurrentState = grfx::RESOURCE_STATE_UNDEFINED;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_buffer_arena_h
+#define ppx_grfx_buffer_arena_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/tlsf_allocator.h"
+
+namespace ppx {
+namespace grfx {
+
+enum BufferArenaStrategy
+{
+    // Bump allocation, all ranges are released together by Reset().
+    // Meant for per-frame data, one arena per frame in flight.
+    BUFFER_ARENA_STRATEGY_LINEAR = 0,
+
+    // Two-level segregated fit, ranges are released individually by Free().
+    BUFFER_ARENA_STRATEGY_TLSF = 1,
+};
+
+//! @struct BufferArenaCreateInfo
+//!
+//! \b alignment is the minimum alignment of every range. It is raised to
+//! PPX_UNIFORM_BUFFER_ALIGNMENT if \b usageFlags has uniformBuffer or
+//! storageBuffer set, so ranges can be bound as descriptors.
+//!
+//! Blocks of \b blockSize bytes are created on demand, up to
+//! \b maxBlockCount blocks (0 means unlimited). Allocations larger than
+//! a block fail.
+//!
+struct BufferArenaCreateInfo
+{
+    grfx::BufferArenaStrategy strategy       = grfx::BUFFER_ARENA_STRATEGY_TLSF;
+    uint64_t                  blockSize      = 4 * 1024 * 1024;
+    uint32_t                  maxBlockCount  = 0;
+    uint64_t                  alignment      = 16;
+    grfx::BufferUsageFlags    usageFlags     = 0;
+    grfx::MemoryUsage         memoryUsage    = grfx::MEMORY_USAGE_CPU_TO_GPU;
+    grfx::MemoryCategory      memoryCategory = grfx::MEMORY_CATEGORY_UNDEFINED;
+};
+
+//! @struct BufferRange
+//!
+//! A sub-range of one of an arena's blocks. \b pMappedAddress points at
+//! \b offset if the arena's memory is host visible, otherwise it's null.
+//!
+struct BufferRange
+{
+    grfx::Buffer* pBuffer        = nullptr;
+    uint64_t      offset         = 0;
+    uint64_t      size           = 0;
+    void*         pMappedAddress = nullptr;
+    uint32_t      blockIndex     = UINT32_MAX;
+    uint32_t      handle         = UINT32_MAX; // TLSF only
+
+    grfx::IndexBufferView  GetIndexBufferView(grfx::IndexType indexType) const { return grfx::IndexBufferView(pBuffer, indexType, offset); }
+    grfx::VertexBufferView GetVertexBufferView(uint32_t stride) const { return grfx::VertexBufferView(pBuffer, stride, offset); }
+
+    //! Copies \b dataSize bytes to the start of the range. Host visible
+    //! arenas only.
+    Result CopyFromSource(uint64_t dataSize, const void* pData) const;
+};
+
+//! @class BufferArena
+//!
+//! Sub-allocates aligned ranges out of a few large buffers instead of
+//! creating one buffer, and one memory allocation, per small uniform,
+//! vertex or index buffer. Ranges are bound with their offset: through
+//! WriteDescriptor::bufferOffset or a dynamic offset for uniform buffers,
+//! and through the vertex/index buffer views for geometry.
+//!
+//! Host visible blocks stay mapped for the lifetime of the arena.
+//!
+class BufferArena
+    : public grfx::DeviceObject<grfx::BufferArenaCreateInfo>
+{
+public:
+    BufferArena() {}
+    virtual ~BufferArena() {}
+
+    grfx::BufferArenaStrategy GetStrategy() const { return mCreateInfo.strategy; }
+    uint64_t                  GetBlockSize() const { return mCreateInfo.blockSize; }
+    uint64_t                  GetAlignment() const { return mCreateInfo.alignment; }
+    uint32_t                  GetBlockCount() const { return CountU32(mBlocks); }
+    grfx::BufferPtr           GetBlockBuffer(uint32_t index) const { return mBlocks[index].buffer; }
+
+    //! Returns the bytes handed out, including alignment padding.
+    uint64_t GetUsedSize() const;
+    uint32_t GetAllocationCount() const { return mAllocationCount; }
+
+    //! Returns ERROR_OUT_OF_MEMORY if \b size is larger than a block or
+    //! maxBlockCount blocks are full.
+    Result Allocate(uint64_t size, grfx::BufferRange* pRange);
+
+    //! Releases a range. TLSF arenas only.
+    void Free(const grfx::BufferRange& range);
+
+    //! Releases all ranges, blocks are kept. The caller must make sure the
+    //! GPU is done with them.
+    void Reset();
+
+protected:
+    virtual Result Create(const grfx::BufferArenaCreateInfo* pCreateInfo) override;
+    friend class grfx::Device;
+
+    virtual Result CreateApiObjects(const grfx::BufferArenaCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    struct Block
+    {
+        grfx::BufferPtr buffer;
+        char*           pMappedAddress = nullptr;
+        uint64_t        linearOffset   = 0;
+        TLSFAllocator   tlsf;
+    };
+
+    Result AddBlock();
+    Result AllocateFromBlock(uint32_t blockIndex, uint64_t size, grfx::BufferRange* pRange);
+
+private:
+    std::vector<Block> mBlocks;
+    uint32_t           mCurrentBlock    = 0; // Linear only
+    uint32_t           mAllocationCount = 0;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_buffer_arena_h
@@ -162,6 +162,20 @@ struct ImageToImageCopyInfo
     } extent;
 };
 
+//! @struct DrawIndexedIndirectCommand
+//!
+//! One draw in an indirect argument buffer. The layout matches
+//! VkDrawIndexedIndirectCommand and D3D12_DRAW_INDEXED_ARGUMENTS.
+//!
+struct DrawIndexedIndirectCommand
+{
+    uint32_t indexCount    = 0;
+    uint32_t instanceCount = 0;
+    uint32_t firstIndex    = 0;
+    int32_t  vertexOffset  = 0;
+    uint32_t firstInstance = 0;
+};
+
 // -------------------------------------------------------------------------------------------------
 
 struct RenderPassBeginInfo
@@ -177,6 +191,23 @@ struct RenderPassBeginInfo
     grfx::DepthStencilClearValue DSVClearValue                          = {1.0f, 0xFF};
 };
 
+//! @struct RenderingInfo
+//!
+//! Attachments for CommandBuffer::BeginRendering(). Load and store ops
+//! come from the views, like for render passes. \b depthStencilState is
+//! the state the depth stencil image is in while rendering.
+//!
+struct RenderingInfo
+{
+    grfx::Rect                   renderArea                                 = {};
+    uint32_t                     renderTargetCount                          = 0;
+    grfx::RenderTargetView*      pRenderTargetViews[PPX_MAX_RENDER_TARGETS] = {};
+    grfx::DepthStencilView*      pDepthStencilView                          = nullptr;
+    grfx::ResourceState          depthStencilState                          = grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE;
+    grfx::RenderTargetClearValue RTVClearValues[PPX_MAX_RENDER_TARGETS]     = {0.0f, 0.0f, 0.0f, 0.0f};
+    grfx::DepthStencilClearValue DSVClearValue                              = {1.0f, 0xFF};
+};
+
 // -------------------------------------------------------------------------------------------------
 
 //! @struct CommandPoolCreateInfo
@@ -251,6 +282,13 @@ public:
     void BeginRenderPass(const grfx::RenderPassBeginInfo* pBeginInfo);
     void EndRenderPass();
 
+    //! Renders to the views of \b pRenderingInfo without a grfx::RenderPass.
+    //! Vulkan uses VK_KHR_dynamic_rendering if the device supports it, and
+    //! otherwise render passes and framebuffers cached by the device. Only
+    //! pipelines created with OutputState::dynamicRendering can be bound.
+    void BeginRendering(const grfx::RenderingInfo* pRenderingInfo);
+    void EndRendering();
+
     grfx::CommandType GetCommandType() { return mCreateInfo.pPool->GetCommandType(); }
 
     //! @fn TransitionImageLayout
@@ -265,7 +303,11 @@ public:
     //! D3D12 ignores both \b pSrcQueue and \b pDstQueue since they're not
     //! relevant.
     //!
-    virtual void TransitionImageLayout(
+    //! Transitions aren't recorded right away: they're batched and flushed
+    //! together by the next draw, dispatch, copy, query or render pass, or by
+    //! FlushBarriers().
+    //!
+    void TransitionImageLayout(
         const grfx::Image*  pImage,
         uint32_t            mipLevel,
         uint32_t            mipLevelCount,
@@ -274,18 +316,27 @@ public:
         grfx::ResourceState beforeState,
         grfx::ResourceState afterState,
         const grfx::Queue*  pSrcQueue = nullptr,
-        const grfx::Queue*  pDstQueue = nullptr) = 0;
+        const grfx::Queue*  pDstQueue = nullptr);
 
     //
     // See comment at function \b TransitionImageLayout for details
     // on queue ownership transfer.
     //
-    virtual void BufferResourceBarrier(
+    void BufferResourceBarrier(
         const grfx::Buffer* pBuffer,
         grfx::ResourceState beforeState,
         grfx::ResourceState afterState,
         const grfx::Queue*  pSrcQueue = nullptr,
-        const grfx::Queue*  pDstQueue = nullptr) = 0;
+        const grfx::Queue*  pDstQueue = nullptr);
+
+    //! Transitions the whole image, or buffer, from its tracked state, see
+    //! Image::GetCurrentState(). Does nothing if it's already in \b afterState.
+    void TransitionImage(const grfx::Image* pImage, grfx::ResourceState afterState);
+    void TransitionBuffer(const grfx::Buffer* pBuffer, grfx::ResourceState afterState);
+
+    //! Records the pending barriers. Only needed before recording into the
+    //! API command buffer directly.
+    virtual void FlushBarriers() = 0;
 
     virtual void SetViewports(
         uint32_t              viewportCount,
@@ -295,17 +346,26 @@ public:
         uint32_t          scissorCount,
         const grfx::Rect* pScissors) = 0;
 
+    //! \b pDynamicOffsets holds one offset for each dynamic uniform or
+    //! storage buffer binding in \b ppSets, ordered by set and then by
+    //! binding number. Offsets are added to the WriteDescriptor::bufferOffset
+    //! the binding was written with and must be multiples of
+    //! PPX_UNIFORM_BUFFER_ALIGNMENT.
     virtual void BindGraphicsDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) = 0;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) = 0;
 
     virtual void BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline) = 0;
 
     virtual void BindComputeDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) = 0;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) = 0;
 
     virtual void BindComputePipeline(const grfx::ComputePipeline* pPipeline) = 0;
 
@@ -328,6 +388,16 @@ public:
         int32_t  vertexOffset  = 0,
         uint32_t firstInstance = 0) = 0;
 
+    //! Draws \b drawCount grfx::DrawIndexedIndirectCommand read from
+    //! \b pArgBuffer at \b offset. The buffer needs indirectBuffer usage and
+    //! must be in RESOURCE_STATE_INDIRECT_ARGUMENT. D3D12 requires \b stride
+    //! to be sizeof(grfx::DrawIndexedIndirectCommand).
+    virtual void DrawIndexedIndirect(
+        const grfx::Buffer* pArgBuffer,
+        uint64_t            offset,
+        uint32_t            drawCount,
+        uint32_t            stride = sizeof(grfx::DrawIndexedIndirectCommand)) = 0;
+
     virtual void Dispatch(
         uint32_t groupCountX,
         uint32_t groupCountY,
@@ -450,8 +520,33 @@ public:
 private:
     virtual void BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo) = 0;
     virtual void EndRenderPassImpl()                                              = 0;
+    virtual void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo)   = 0;
+    virtual void EndRenderingImpl()                                               = 0;
+
+    virtual void TransitionImageLayoutImpl(
+        const grfx::Image*  pImage,
+        uint32_t            mipLevel,
+        uint32_t            mipLevelCount,
+        uint32_t            arrayLayer,
+        uint32_t            arrayLayerCount,
+        grfx::ResourceState beforeState,
+        grfx::ResourceState afterState,
+        const grfx::Queue*  pSrcQueue,
+        const grfx::Queue*  pDstQueue) = 0;
+
+    virtual void BufferResourceBarrierImpl(
+        const grfx::Buffer* pBuffer,
+        grfx::ResourceState beforeState,
+        grfx::ResourceState afterState,
+        const grfx::Queue*  pSrcQueue,
+        const grfx::Queue*  pDstQueue) = 0;
+
+    // Warns about transitions that don't match the tracked state or don't
+    // change it, if barrier validation is enabled on the device.
+    void ValidateTransition(const char* pResourceType, grfx::ResourceState trackedState, grfx::ResourceState beforeState, grfx::ResourceState afterState) const;
 
     const grfx::RenderPass* mCurrentRenderPass = nullptr;
+    bool                    mRenderingActive   = false;
 };
 
 } // namespace grfx
@@ -26,6 +26,7 @@ namespace ppx {
 namespace grfx {
 
 class Buffer;
+class BufferArena;
 class CommandBuffer;
 class CommandPool;
 class ComputePipeline;
@@ -38,14 +39,18 @@ class DrawPass;
 class Fence;
 class FullscreenQuad;
 class Gpu;
+class GpuProfiler;
 class GraphicsPipeline;
 class Image;
 class ImageView;
 class Instance;
 class Mesh;
+class MeshPool;
+class OcclusionCuller;
 class PipelineInterface;
 class Queue;
 class Query;
+class RenderGraph;
 class RenderPass;
 class Sampler;
 class Semaphore;
@@ -74,6 +79,7 @@ class ImageResourceView;
 // -------------------------------------------------------------------------------------------------
 
 using BufferPtr              = ObjPtr<Buffer>;
+using BufferArenaPtr         = ObjPtr<BufferArena>;
 using CommandBufferPtr       = ObjPtr<CommandBuffer>;
 using CommandPoolPtr         = ObjPtr<CommandPool>;
 using ComputePipelinePtr     = ObjPtr<ComputePipeline>;
@@ -86,12 +92,16 @@ using FencePtr               = ObjPtr<Fence>;
 using FullscreenQuadPtr      = ObjPtr<FullscreenQuad>;
 using GraphicsPipelinePtr    = ObjPtr<GraphicsPipeline>;
 using GpuPtr                 = ObjPtr<Gpu>;
+using GpuProfilerPtr         = ObjPtr<GpuProfiler>;
 using ImagePtr               = ObjPtr<Image>;
 using InstancePtr            = ObjPtr<Instance>;
 using MeshPtr                = ObjPtr<Mesh>;
+using MeshPoolPtr            = ObjPtr<MeshPool>;
+using OcclusionCullerPtr     = ObjPtr<OcclusionCuller>;
 using PipelineInterfacePtr   = ObjPtr<PipelineInterface>;
 using QueuePtr               = ObjPtr<Queue>;
 using QueryPtr               = ObjPtr<Query>;
+using RenderGraphPtr         = ObjPtr<RenderGraph>;
 using RenderPassPtr          = ObjPtr<RenderPass>;
 using SamplerPtr             = ObjPtr<Sampler>;
 using SemaphorePtr           = ObjPtr<Semaphore>;
@@ -169,11 +169,16 @@ public:
 
     const std::vector<grfx::DescriptorBinding>& GetBindings() const { return mCreateInfo.bindings; }
 
+    //! Returns the number of dynamic offsets a set with this layout consumes
+    //! when it's bound.
+    uint32_t GetDynamicOffsetCount() const { return mDynamicOffsetCount; }
+
 protected:
     virtual Result Create(const grfx::DescriptorSetLayoutCreateInfo* pCreateInfo) override;
     friend class grfx::Device;
 
 private:
+    uint32_t mDynamicOffsetCount = 0;
 };
 
 } // namespace grfx
@@ -17,25 +17,100 @@
 
 #include "ppx/grfx/grfx_config.h"
 #include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_buffer_arena.h"
 #include "ppx/grfx/grfx_command.h"
 #include "ppx/grfx/grfx_descriptor.h"
 #include "ppx/grfx/grfx_draw_pass.h"
 #include "ppx/grfx/grfx_fullscreen_quad.h"
+#include "ppx/grfx/grfx_gpu_profiler.h"
 #include "ppx/grfx/grfx_image.h"
 #include "ppx/grfx/grfx_mesh.h"
+#include "ppx/grfx/grfx_mesh_pool.h"
+#include "ppx/grfx/grfx_occlusion_culler.h"
 #include "ppx/grfx/grfx_pipeline.h"
 #include "ppx/grfx/grfx_queue.h"
 #include "ppx/grfx/grfx_query.h"
+#include "ppx/grfx/grfx_render_graph.h"
 #include "ppx/grfx/grfx_render_pass.h"
 #include "ppx/grfx/grfx_shader.h"
 #include "ppx/grfx/grfx_swapchain.h"
 #include "ppx/grfx/grfx_sync.h"
 #include "ppx/grfx/grfx_text_draw.h"
 #include "ppx/grfx/grfx_texture.h"
+#include "ppx/parallel.h"
+
+#include <future>
+#include <mutex>
+#include <unordered_map>
 
 namespace ppx {
 namespace grfx {
 
+//! @struct MemoryHeapStats
+//!
+//! \b usage and \b budget are the bytes used and available on the heap as
+//! reported by the OS, including allocations made outside of this device.
+//! Block and allocation counters only cover memory allocated by this device.
+//! Without budget support (VK_EXT_memory_budget) \b usage is the block bytes
+//! and \b budget is an estimate based on the heap size.
+//!
+struct MemoryHeapStats
+{
+    bool     deviceLocal     = false;
+    uint64_t usage           = 0;
+    uint64_t budget          = 0;
+    uint64_t blockBytes      = 0;
+    uint64_t allocationBytes = 0;
+    uint32_t blockCount      = 0;
+    uint32_t allocationCount = 0;
+};
+
+//! @struct MemoryStats
+//!
+//! Totals are summed over all heaps. \b unusedRangeCount and
+//! \b largestUnusedRange are only filled for detailed queries, which walk
+//! every allocation and are too slow to run every frame on large scenes.
+//! \b categoryBytes holds the allocation bytes of live buffers and images
+//! per grfx::MemoryCategory.
+//!
+struct MemoryStats
+{
+    std::vector<grfx::MemoryHeapStats> heaps;
+    uint64_t                           usage              = 0;
+    uint64_t                           budget             = 0;
+    uint64_t                           blockBytes         = 0;
+    uint64_t                           allocationBytes    = 0;
+    uint32_t                           blockCount         = 0;
+    uint32_t                           allocationCount    = 0;
+    uint32_t                           unusedRangeCount   = 0;
+    uint64_t                           largestUnusedRange = 0;
+
+    uint64_t categoryBytes[grfx::MEMORY_CATEGORY_COUNT] = {};
+
+    //! Returns the fraction of block bytes not used by allocations.
+    float GetFragmentation() const;
+
+    //! Returns the device local usage divided by the device local budget.
+    float GetDeviceLocalUsageRatio() const;
+};
+
+//! @struct GraphicsPipelineCacheStats
+//!
+//! Counters of the shared graphics pipelines returned by
+//! Device::AcquireGraphicsPipeline().
+//!
+struct GraphicsPipelineCacheStats
+{
+    uint64_t hitCount      = 0; // Acquires that returned an existing pipeline
+    uint64_t missCount     = 0; // Acquires that created a pipeline
+    uint32_t pipelineCount = 0; // Shared pipelines currently alive
+};
+
+//! Called when device local usage goes over the threshold passed to
+//! Device::SetMemoryBudgetCallback(). The callback is expected to release
+//! resources, e.g. evict streamed textures or mesh LODs.
+using MemoryBudgetCallback = std::function<void(grfx::Device*, const grfx::MemoryStats&)>;
+
 //! @struct DeviceCreateInfo
 //!
 //!
@@ -74,12 +149,21 @@ public:
     Result CreateBuffer(const grfx::BufferCreateInfo* pCreateInfo, grfx::Buffer** ppBuffer);
     void   DestroyBuffer(const grfx::Buffer* pBuffer);
 
+    Result CreateBufferArena(const grfx::BufferArenaCreateInfo* pCreateInfo, grfx::BufferArena** ppBufferArena);
+    void   DestroyBufferArena(const grfx::BufferArena* pBufferArena);
+
     Result CreateCommandPool(const grfx::CommandPoolCreateInfo* pCreateInfo, grfx::CommandPool** ppCommandPool);
     void   DestroyCommandPool(const grfx::CommandPool* pCommandPool);
 
     Result CreateComputePipeline(const grfx::ComputePipelineCreateInfo* pCreateInfo, grfx::ComputePipeline** ppComputePipeline);
     void   DestroyComputePipeline(const grfx::ComputePipeline* pComputePipeline);
 
+    //! Compiles the pipeline on one of the device's pipeline worker threads.
+    //! The shader modules and pipeline interface of \b pCreateInfo must stay
+    //! alive until the future is ready. The future holds a null pipeline if
+    //! creation failed.
+    std::future<grfx::ComputePipelinePtr> CreateComputePipelineAsync(const grfx::ComputePipelineCreateInfo* pCreateInfo);
+
     Result CreateDepthStencilView(const grfx::DepthStencilViewCreateInfo* pCreateInfo, grfx::DepthStencilView** ppDepthStencilView);
     void   DestroyDepthStencilView(const grfx::DepthStencilView* pDepthStencilView);
 
@@ -104,18 +188,52 @@ public:
     Result CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline);
     void   DestroyGraphicsPipeline(const grfx::GraphicsPipeline* pGraphicsPipeline);
 
+    //! Same as CreateComputePipelineAsync() for graphics pipelines.
+    std::future<grfx::GraphicsPipelinePtr> CreateGraphicsPipelineAsync(const grfx::GraphicsPipelineCreateInfo* pCreateInfo);
+    std::future<grfx::GraphicsPipelinePtr> CreateGraphicsPipelineAsync(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo);
+
+    //! Waits for all pipelines submitted with the Create*PipelineAsync()
+    //! functions to be compiled.
+    void WaitForPipelineCompiles();
+
+    //! Returns a shared pipeline for \b pCreateInfo, creating it only if no
+    //! live shared pipeline was acquired with equivalent state (see
+    //! internal::GetGraphicsPipelineKey()). Each successful acquire must be
+    //! matched by a ReleaseGraphicsPipeline(). Shared pipelines must not be
+    //! passed to DestroyGraphicsPipeline().
+    Result AcquireGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline);
+    Result AcquireGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline);
+
+    //! Drops a reference acquired with AcquireGraphicsPipeline(), the pipeline
+    //! is destroyed with its last reference.
+    void ReleaseGraphicsPipeline(const grfx::GraphicsPipeline* pGraphicsPipeline);
+
+    grfx::GraphicsPipelineCacheStats GetGraphicsPipelineCacheStats() const;
+
+    Result CreateGpuProfiler(const grfx::GpuProfilerCreateInfo* pCreateInfo, grfx::GpuProfiler** ppGpuProfiler);
+    void   DestroyGpuProfiler(const grfx::GpuProfiler* pGpuProfiler);
+
     Result CreateImage(const grfx::ImageCreateInfo* pCreateInfo, grfx::Image** ppImage);
     void   DestroyImage(const grfx::Image* pImage);
 
     Result CreateMesh(const grfx::MeshCreateInfo* pCreateInfo, grfx::Mesh** ppMesh);
     void   DestroyMesh(const grfx::Mesh* pMesh);
 
+    Result CreateMeshPool(const grfx::MeshPoolCreateInfo* pCreateInfo, grfx::MeshPool** ppMeshPool);
+    void   DestroyMeshPool(const grfx::MeshPool* pMeshPool);
+
+    Result CreateOcclusionCuller(const grfx::OcclusionCullerCreateInfo* pCreateInfo, grfx::OcclusionCuller** ppOcclusionCuller);
+    void   DestroyOcclusionCuller(const grfx::OcclusionCuller* pOcclusionCuller);
+
     Result CreatePipelineInterface(const grfx::PipelineInterfaceCreateInfo* pCreateInfo, grfx::PipelineInterface** ppPipelineInterface);
     void   DestroyPipelineInterface(const grfx::PipelineInterface* pPipelineInterface);
 
     Result CreateQuery(const grfx::QueryCreateInfo* pCreateInfo, grfx::Query** ppQuery);
     void   DestroyQuery(const grfx::Query* pQuery);
 
+    Result CreateRenderGraph(const grfx::RenderGraphCreateInfo* pCreateInfo, grfx::RenderGraph** ppRenderGraph);
+    void   DestroyRenderGraph(const grfx::RenderGraph* pRenderGraph);
+
     Result CreateRenderPass(const grfx::RenderPassCreateInfo* pCreateInfo, grfx::RenderPass** ppRenderPass);
     Result CreateRenderPass(const grfx::RenderPassCreateInfo2* pCreateInfo, grfx::RenderPass** ppRenderPass);
     Result CreateRenderPass(const grfx::RenderPassCreateInfo3* pCreateInfo, grfx::RenderPass** ppRenderPass);
@@ -184,6 +302,39 @@ public:
     virtual bool DynamicRenderingSupported() const = 0;
     virtual bool IndependentBlendingSupported() const = 0;
     virtual bool FragmentStoresAndAtomicsSupported() const = 0;
+    virtual bool TimelineSemaphoreSupported() const = 0;
+    virtual bool SampledImageArrayDynamicIndexingSupported() const = 0;
+
+    //! Returns the contents of the device's pipeline cache: compiled
+    //! pipelines that can be passed to LoadPipelineCacheData() on a later run
+    //! so the same pipelines compile faster. Returns
+    //! ERROR_REQUIRED_FEATURE_UNAVAILABLE if the API has no pipeline cache.
+    virtual Result GetPipelineCacheData(std::vector<char>* pData) const = 0;
+
+    //! Adds data from GetPipelineCacheData() to the device's pipeline cache.
+    //! Data from another driver or GPU is ignored. Waits for pending
+    //! asynchronous pipeline compiles.
+    virtual Result LoadPipelineCacheData(const void* pData, size_t size) = 0;
+
+    //! Fills \b pStats with heap usage and budgets from the memory allocator.
+    //! If \b detailed is true, fragmentation and per category totals are
+    //! also calculated.
+    Result GetMemoryStats(grfx::MemoryStats* pStats, bool detailed = true) const;
+
+    //! Sets a callback that runs after a buffer or image is created if device
+    //! local usage exceeds \b usageThreshold of the budget. Pass an empty
+    //! callback to disable.
+    void SetMemoryBudgetCallback(float usageThreshold, grfx::MemoryBudgetCallback callback);
+
+    //! Queries the budget and runs the budget callback if it is exceeded.
+    //! Returns true if the callback ran.
+    bool CheckMemoryBudget();
+
+    //! Makes command buffers warn about transitions whose before state doesn't
+    //! match the tracked state, and transitions to the state a resource is
+    //! already in. Enabled by default if the debug layers are.
+    void SetBarrierValidationEnabled(bool enabled) { mBarrierValidationEnabled = enabled; }
+    bool IsBarrierValidationEnabled() const { return mBarrierValidationEnabled; }
 
 protected:
     virtual Result Create(const grfx::DeviceCreateInfo* pCreateInfo) override;
@@ -214,9 +365,14 @@ protected:
     virtual Result AllocateObject(grfx::StorageImageView** ppObject)    = 0;
     virtual Result AllocateObject(grfx::Swapchain** ppObject)           = 0;
 
+    virtual Result AllocateObject(grfx::BufferArena** ppObject);
     virtual Result AllocateObject(grfx::DrawPass** ppObject);
     virtual Result AllocateObject(grfx::FullscreenQuad** ppObject);
+    virtual Result AllocateObject(grfx::GpuProfiler** ppObject);
     virtual Result AllocateObject(grfx::Mesh** ppObject);
+    virtual Result AllocateObject(grfx::MeshPool** ppObject);
+    virtual Result AllocateObject(grfx::OcclusionCuller** ppObject);
+    virtual Result AllocateObject(grfx::RenderGraph** ppObject);
     virtual Result AllocateObject(grfx::TextDraw** ppObject);
     virtual Result AllocateObject(grfx::Texture** ppObject);
     virtual Result AllocateObject(grfx::TextureFont** ppObject);
@@ -235,13 +391,25 @@ protected:
     template <typename ObjectT>
     void DestroyAllObjects(std::vector<ObjPtr<ObjectT>>& container);
 
+    // Same as CreateObject() but the object is created without holding
+    // mPipelineMutex, so several threads can compile pipelines at once.
+    template <typename ObjectT, typename CreateInfoT>
+    Result CreatePipelineObject(const CreateInfoT* pCreateInfo, std::vector<ObjPtr<ObjectT>>& container, ObjectT** ppObject);
+
+    ppx::TaskQueue* GetPipelineCompileQueue();
+
     Result CreateGraphicsQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
     Result CreateComputeQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
     Result CreateTransferQueue(const grfx::internal::QueueCreateInfo* pCreateInfo, grfx::Queue** ppQueue);
 
+    // Fills the heap entries and totals of pStats. Unused ranges are only
+    // expected when detailed is true.
+    virtual Result QueryMemoryStats(bool detailed, grfx::MemoryStats* pStats) const = 0;
+
 protected:
     grfx::InstancePtr                         mInstance;
     std::vector<grfx::BufferPtr>              mBuffers;
+    std::vector<grfx::BufferArenaPtr>         mBufferArenas;
     std::vector<grfx::CommandBufferPtr>       mCommandBuffers;
     std::vector<grfx::CommandPoolPtr>         mCommandPools;
     std::vector<grfx::ComputePipelinePtr>     mComputePipelines;
@@ -252,11 +420,15 @@ protected:
     std::vector<grfx::DrawPassPtr>            mDrawPasses;
     std::vector<grfx::FencePtr>               mFences;
     std::vector<grfx::FullscreenQuadPtr>      mFullscreenQuads;
+    std::vector<grfx::GpuProfilerPtr>         mGpuProfilers;
     std::vector<grfx::GraphicsPipelinePtr>    mGraphicsPipelines;
     std::vector<grfx::ImagePtr>               mImages;
     std::vector<grfx::MeshPtr>                mMeshes;
+    std::vector<grfx::MeshPoolPtr>            mMeshPools;
+    std::vector<grfx::OcclusionCullerPtr>     mOcclusionCullers;
     std::vector<grfx::PipelineInterfacePtr>   mPipelineInterfaces;
     std::vector<grfx::QueryPtr>               mQuerys;
+    std::vector<grfx::RenderGraphPtr>         mRenderGraphs;
     std::vector<grfx::RenderPassPtr>          mRenderPasses;
     std::vector<grfx::RenderTargetViewPtr>    mRenderTargetViews;
     std::vector<grfx::SampledImageViewPtr>    mSampledImageViews;
@@ -272,6 +444,31 @@ protected:
     std::vector<grfx::QueuePtr>               mGraphicsQueues;
     std::vector<grfx::QueuePtr>               mComputeQueues;
     std::vector<grfx::QueuePtr>               mTransferQueues;
+    grfx::MemoryBudgetCallback                mMemoryBudgetCallback;
+    float                                     mMemoryBudgetThreshold    = 0.9f;
+    bool                                      mInMemoryBudgetCallback   = false;
+    bool                                      mBarrierValidationEnabled = false;
+    std::mutex                                mPipelineMutex; // Guards mComputePipelines and mGraphicsPipelines
+    std::unique_ptr<ppx::TaskQueue>           mPipelineCompileQueue;
+
+private:
+    struct SharedGraphicsPipeline
+    {
+        grfx::GraphicsPipelinePtr pipeline;
+        uint32_t                  refCount = 0;
+    };
+
+    struct PipelineKeyHasher
+    {
+        size_t operator()(const std::string& key) const;
+    };
+
+    using SharedGraphicsPipelineMap = std::unordered_map<std::string, SharedGraphicsPipeline, PipelineKeyHasher>;
+
+    mutable std::mutex                                              mSharedPipelineMutex; // Held while shared pipelines are created
+    SharedGraphicsPipelineMap                                       mSharedGraphicsPipelines;
+    std::unordered_map<const grfx::GraphicsPipeline*, std::string> mSharedGraphicsPipelineKeys;
+    grfx::GraphicsPipelineCacheStats                                mGraphicsPipelineCacheStats;
 };
 
 } // namespace grfx
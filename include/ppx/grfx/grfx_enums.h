@@ -233,8 +233,8 @@ enum DescriptorType
     DESCRIPTOR_TYPE_RAW_STORAGE_BUFFER     = 8,  // RW raw buffer object
     DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER   = 9,  // RO structured buffer object
     DESCRIPTOR_TYPE_RW_STRUCTURED_BUFFER   = 10, // RW structured buffer object
-    DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC = 11, // (Vulkan only)
-    DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC = 12, // (Vulkan only)
+    DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC = 11, // constant/uniform buffer object, offset at bind time
+    DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC = 12, // RW raw buffer object, offset at bind time
     DESCRIPTOR_TYPE_INPUT_ATTACHMENT       = 13, // (Vulkan only)
 };
 
@@ -320,6 +320,20 @@ enum LogicOp
     LOGIC_OP_SET           = 15,
 };
 
+//! Used to total memory usage by kind of resource. Buffers and images left
+//! at MEMORY_CATEGORY_UNDEFINED are assigned a category from their usage
+//! flags when they're created.
+enum MemoryCategory
+{
+    MEMORY_CATEGORY_UNDEFINED     = 0,
+    MEMORY_CATEGORY_OTHER         = 1,
+    MEMORY_CATEGORY_TEXTURE       = 2,
+    MEMORY_CATEGORY_MESH          = 3,
+    MEMORY_CATEGORY_STAGING       = 4,
+    MEMORY_CATEGORY_RENDER_TARGET = 5,
+    MEMORY_CATEGORY_COUNT         = 6,
+};
+
 enum MemoryUsage
 {
     MEMORY_USAGE_UNKNOWN    = 0,
@@ -425,6 +439,12 @@ enum SampleCount
     SAMPLE_COUNT_64 = 64,
 };
 
+enum SemaphoreType
+{
+    SEMAPHORE_TYPE_BINARY   = 0,
+    SEMAPHORE_TYPE_TIMELINE = 1,
+};
+
 enum ShaderStageBits
 {
     SHADER_STAGE_UNDEFINED    = 0x00000000,
@@ -0,0 +1,168 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_gpu_profiler_h
+#define ppx_grfx_gpu_profiler_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_query.h"
+
+#include <string>
+#include <vector>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct GpuProfilerCreateInfo
+//!
+//! Usage Notes:
+//!   - \b pQueue is the queue the profiled command buffers are submitted
+//!     to, its timestamp frequency converts the results to milliseconds
+//!   - \b frameCount is the number of frames recorded before a frame's
+//!     results are read back, it must be larger than the number of frames
+//!     the GPU can lag behind the CPU
+//!   - \b maxScopeCount is the number of scopes per frame, scopes past it
+//!     are dropped
+//!   - \b enablePipelineStatistics is ignored if the device doesn't have
+//!     pipeline statistics queries
+//!
+struct GpuProfilerCreateInfo
+{
+    grfx::Queue* pQueue                   = nullptr;
+    uint32_t     frameCount               = 3;
+    uint32_t     maxScopeCount            = 64;
+    bool         enablePipelineStatistics = false;
+};
+
+//! @struct GpuProfilerScope
+//!
+//!
+struct GpuProfilerScope
+{
+    std::string              name                  = "";
+    uint32_t                 depth                 = 0;
+    int32_t                  parentIndex           = -1; // Index in GpuProfilerFrame::scopes, -1 for top level scopes
+    double                   gpuTimeMs             = 0;
+    bool                     hasPipelineStatistics = false;
+    grfx::PipelineStatistics pipelineStatistics    = {};
+};
+
+//! @struct GpuProfilerFrame
+//!
+//!
+struct GpuProfilerFrame
+{
+    uint64_t                            frameNumber = 0;
+    double                              gpuTimeMs   = 0; // From the start of the first top level scope to the end of the last one
+    std::vector<grfx::GpuProfilerScope> scopes;          // In push order, parents come before their children
+};
+
+namespace internal {
+
+struct GpuProfilerScopeRecord
+{
+    std::string name               = "";
+    uint32_t    depth              = 0;
+    int32_t     parentIndex        = -1;
+    uint32_t    pipelineStatsIndex = UINT32_MAX; // UINT32_MAX if the scope has no pipeline statistics query
+};
+
+//! Converts the timestamps of \b records, written at 2 * i and 2 * i + 1 for
+//! the start and end of scope i, into milliseconds. \b pPipelineStatistics is
+//! indexed by GpuProfilerScopeRecord::pipelineStatsIndex and can be null if
+//! no scope has pipeline statistics.
+void ResolveGpuProfilerFrame(
+    const std::vector<grfx::internal::GpuProfilerScopeRecord>& records,
+    const uint64_t*                                            pTimestamps,
+    const grfx::PipelineStatistics*                            pPipelineStatistics,
+    uint64_t                                                   timestampFrequency,
+    grfx::GpuProfilerFrame*                                    pFrame);
+
+} // namespace internal
+
+//! @class GpuProfiler
+//!
+//! Measures the GPU time of named, nested scopes with timestamp queries.
+//! Each frame calls BeginFrame() before recording, PushScope() and
+//! PopScope() around the work to measure, and EndFrame() in the last
+//! command buffer of the frame to copy the queries to a readback buffer.
+//!
+//! Frames use a ring of \b frameCount query pools. BeginFrame() reads back
+//! the frame that last used the pool it's about to reuse, so results are
+//! available \b frameCount frames after they're recorded without waiting
+//! on the GPU.
+//!
+//! Pipeline statistics queries of a type can't nest, so they're only
+//! collected for the outermost scopes. These scopes must begin and end in
+//! the same command buffer, and either both outside of a render pass or
+//! both inside the same render pass instance. A scope can't begin in one
+//! BeginRenderPass() or BeginRendering() and end in the next one, even if
+//! it's for the same render pass.
+//!
+class GpuProfiler
+    : public grfx::DeviceObject<grfx::GpuProfilerCreateInfo>
+{
+public:
+    GpuProfiler() {}
+    virtual ~GpuProfiler() {}
+
+    bool PipelineStatisticsEnabled() const { return !mFrames.empty() && mFrames[0].pipelineStatsQuery; }
+
+    void BeginFrame();
+    void PushScope(grfx::CommandBuffer* pCommandBuffer, const std::string& name);
+    void PopScope(grfx::CommandBuffer* pCommandBuffer);
+    void EndFrame(grfx::CommandBuffer* pCommandBuffer);
+
+    //! Results of the last frame read back, a default GpuProfilerFrame until
+    //! the first one is.
+    const grfx::GpuProfilerFrame& GetLastFrame() const { return mLastFrame; }
+
+    //! Number of scopes dropped because a frame had more than
+    //! \b maxScopeCount of them.
+    uint64_t GetDroppedScopeCount() const { return mDroppedScopeCount; }
+
+protected:
+    virtual Result CreateApiObjects(const grfx::GpuProfilerCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    void ReadFrame(uint32_t frameIndex);
+
+    struct Frame
+    {
+        grfx::QueryPtr                                      timestampQuery;
+        grfx::QueryPtr                                      pipelineStatsQuery;
+        std::vector<grfx::internal::GpuProfilerScopeRecord> records;
+        uint32_t                                            pipelineStatsCount = 0;
+        uint64_t                                            frameNumber        = 0;
+        bool                                                resolved           = false; // EndFrame() was called
+    };
+
+private:
+    std::vector<Frame>                    mFrames;
+    uint32_t                              mFrameIndex         = 0;
+    uint64_t                              mFrameNumber        = 0; // Frames begun so far
+    uint64_t                              mTimestampFrequency = 0;
+    std::vector<uint32_t>                 mScopeStack;
+    uint32_t                              mPipelineStatsScope = UINT32_MAX; // Scope with an active pipeline statistics query
+    uint64_t                              mDroppedScopeCount  = 0;
+    std::vector<uint64_t>                 mTimestamps;
+    std::vector<grfx::PipelineStatistics> mPipelineStatistics;
+    grfx::GpuProfilerFrame                mLastFrame;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_gpu_profiler_h
@@ -41,6 +41,7 @@ struct ImageCreateInfo
     void*                        pApiObject                = nullptr;                      // [OPTIONAL] For external images such as swapchain images
     grfx::Ownership              ownership                 = grfx::OWNERSHIP_REFERENCE;
     bool                         concurrentMultiQueueUsage = false;
+    grfx::MemoryCategory         memoryCategory            = grfx::MEMORY_CATEGORY_UNDEFINED; // Deduced from usage if undefined
 
     // Returns a create info for sampled image
     static ImageCreateInfo SampledImage2D(
@@ -89,6 +90,15 @@ public:
     const grfx::RenderTargetClearValue& GetRTVClearValue() const { return mCreateInfo.RTVClearValue; }
     const grfx::DepthStencilClearValue& GetDSVClearValue() const { return mCreateInfo.DSVClearValue; }
     bool                                GetConcurrentMultiQueueUsageEnabled() const { return mCreateInfo.concurrentMultiQueueUsage; }
+    grfx::MemoryCategory                GetMemoryCategory() const { return mCreateInfo.memoryCategory; }
+    uint64_t                            GetMemorySize() const { return mMemorySize; }
+
+    //! State after the last whole image transition recorded into any command
+    //! buffer, so it only matches the GPU if command buffers are submitted in
+    //! the order they're recorded. Transitioning some mip levels or array
+    //! layers makes it unknown until the next whole image transition.
+    grfx::ResourceState GetCurrentState() const { return mCurrentState; }
+    bool                IsCurrentStateKnown() const { return mCurrentStateKnown; }
 
     // Convenience functions
     grfx::ImageViewType GuessImageViewType(bool isCube = false) const;
@@ -99,6 +109,15 @@ public:
 protected:
     virtual Result Create(const grfx::ImageCreateInfo* pCreateInfo) override;
     friend class grfx::Device;
+
+    // Size of the memory allocated for the image, zero for external images
+    uint64_t mMemorySize = 0;
+
+private:
+    // Updated by command buffers, which only get const pointers
+    friend class grfx::CommandBuffer;
+    mutable grfx::ResourceState mCurrentState      = grfx::RESOURCE_STATE_UNDEFINED;
+    mutable bool                mCurrentStateKnown = true;
 };
 
 // -------------------------------------------------------------------------------------------------
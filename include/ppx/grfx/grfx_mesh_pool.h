@@ -0,0 +1,143 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_mesh_pool_h
+#define ppx_grfx_mesh_pool_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_mesh.h"
+#include "ppx/grfx/grfx_mesh_pool_allocator.h"
+#include "ppx/geometry.h"
+
+namespace ppx {
+namespace grfx {
+
+//! @struct MeshPoolCreateInfo
+//!
+//! Usage Notes:
+//!   - \b vertexBuffers describes the vertex streams the same way as
+//!     grfx::MeshCreateInfo, every mesh added to the pool must match them
+//!   - \b indexType must be grfx::INDEX_TYPE_UINT16 or grfx::INDEX_TYPE_UINT32
+//!     if \b maxIndexCount is not 0
+//!   - \b defragmentThreshold is the fragmentation above which
+//!     NeedsDefragment() returns true, the pool is never defragmented
+//!     automatically
+//!
+struct MeshPoolCreateInfo
+{
+    grfx::IndexType                   indexType                              = grfx::INDEX_TYPE_UINT32;
+    uint32_t                          maxIndexCount                          = 0;
+    uint32_t                          maxVertexCount                         = 0;
+    uint32_t                          vertexBufferCount                      = 0;
+    grfx::MeshVertexBufferDescription vertexBuffers[PPX_MAX_VERTEX_BINDINGS] = {};
+    float                             defragmentThreshold                    = 0.5f;
+
+    MeshPoolCreateInfo() {}
+
+    //! Takes the index type and vertex streams of \b geometry, so geometries
+    //! created with the same create info can be added to the pool.
+    MeshPoolCreateInfo(const ppx::Geometry& geometry, uint32_t maxVertexCount, uint32_t maxIndexCount);
+};
+
+//! @class MeshPool
+//!
+//! Places many meshes in one set of shared vertex buffers, one per stream,
+//! and one shared index buffer. Each mesh is identified by a handle that
+//! maps to a base vertex and a first index, so a whole scene can be drawn
+//! after a single BindBuffers() with one DrawIndexed per mesh, or with one
+//! DrawIndexedIndirect using commands from GetDrawIndexedIndirectCommand().
+//!
+//! Defragment() packs the meshes into new buffers and destroys the old
+//! ones, which needs twice the pool's memory while it runs. It waits for
+//! the device to go idle, so call it where a stall is acceptable, such as
+//! a loading screen. Handles stay valid but their ranges move, so indirect
+//! commands must be rewritten and buffers rebound afterwards.
+//!
+class MeshPool
+    : public grfx::DeviceObject<grfx::MeshPoolCreateInfo>
+{
+public:
+    MeshPool() {}
+    virtual ~MeshPool() {}
+
+    grfx::IndexType GetIndexType() const { return mCreateInfo.indexType; }
+    grfx::BufferPtr GetIndexBuffer() const { return mIndexBuffer; }
+
+    uint32_t                                 GetVertexBufferCount() const { return CountU32(mVertexBuffers); }
+    grfx::BufferPtr                          GetVertexBuffer(uint32_t index) const;
+    const grfx::MeshVertexBufferDescription* GetVertexBufferDescription(uint32_t index) const;
+
+    //! Returns derived vertex bindings based on the vertex buffer description
+    const std::vector<grfx::VertexBinding>& GetDerivedVertexBindings() const { return mDerivedVertexBindings; }
+
+    uint32_t GetMeshCount() const { return mAllocator.GetMeshCount(); }
+    uint32_t GetUsedVertexCount() const { return mAllocator.GetUsedVertexCount(); }
+    uint32_t GetUsedIndexCount() const { return mAllocator.GetUsedIndexCount(); }
+    float    GetFragmentation() const { return mAllocator.GetFragmentation(); }
+    bool     NeedsDefragment() const { return GetFragmentation() > mCreateInfo.defragmentThreshold; }
+
+    //! Uploads \b geometry into the pool, waiting for the copy to finish.
+    //! Returns ERROR_OUT_OF_MEMORY if the pool can't fit the geometry,
+    //! Defragment() may make room for it.
+    Result AddMesh(grfx::Queue* pQueue, const ppx::Geometry& geometry, uint32_t* pHandle);
+
+    //! Uploads \b geometryCount geometries with one staging buffer and one
+    //! submit, and writes their handles to \b pHandles. Either all of them
+    //! are added or none are.
+    Result AddMeshes(grfx::Queue* pQueue, uint32_t geometryCount, const ppx::Geometry* const* ppGeometries, uint32_t* pHandles);
+
+    //! Releases a mesh's ranges. The caller must make sure the GPU is done
+    //! with the mesh.
+    Result RemoveMesh(uint32_t handle);
+
+    //! Packs all meshes to the start of the pool. Waits for the device to go
+    //! idle before copying, and command buffers recorded before the call
+    //! must not be submitted afterwards since they bind the old buffers.
+    Result Defragment(grfx::Queue* pQueue);
+
+    bool                       IsValid(uint32_t handle) const { return mAllocator.IsValid(handle); }
+    const grfx::MeshPoolRange& GetRange(uint32_t handle) const { return mAllocator.GetRange(handle); }
+
+    grfx::DrawIndexedIndirectCommand GetDrawIndexedIndirectCommand(uint32_t handle, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+
+    //! Binds the index buffer and all vertex buffers, once for all meshes.
+    void BindBuffers(grfx::CommandBuffer* pCommandBuffer) const;
+
+    //! Draws one mesh, BindBuffers() must have been called.
+    void Draw(grfx::CommandBuffer* pCommandBuffer, uint32_t handle, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::MeshPoolCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    Result      CheckGeometry(const ppx::Geometry& geometry) const;
+    static bool HasIndices(const ppx::Geometry& geometry);
+    Result      CreateBuffers(grfx::BufferPtr& indexBuffer, std::vector<grfx::BufferPtr>& vertexBuffers);
+    void        DestroyBuffers(grfx::BufferPtr& indexBuffer, std::vector<grfx::BufferPtr>& vertexBuffers);
+
+private:
+    grfx::MeshPoolAllocator                        mAllocator;
+    grfx::BufferPtr                                mIndexBuffer;
+    std::vector<grfx::BufferPtr>                   mVertexBuffers;
+    std::vector<grfx::MeshVertexBufferDescription> mVertexBufferDescriptions;
+    std::vector<grfx::VertexBinding>               mDerivedVertexBindings;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_mesh_pool_h
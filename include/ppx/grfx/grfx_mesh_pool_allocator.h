@@ -0,0 +1,117 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_mesh_pool_allocator_h
+#define ppx_grfx_mesh_pool_allocator_h
+
+#include "ppx/config.h"
+#include "ppx/tlsf_allocator.h"
+
+#include <vector>
+
+namespace ppx {
+namespace grfx {
+
+//! @struct MeshPoolRange
+//!
+//! Where a mesh lives in a pool's buffers, in vertices and indices. Meshes
+//! without indices have an \b indexCount of 0.
+//!
+struct MeshPoolRange
+{
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount  = 0;
+    uint32_t firstIndex   = 0;
+    uint32_t indexCount   = 0;
+};
+
+//! @struct MeshPoolCopy
+//!
+//! Elements to copy from the old buffers to the new ones after
+//! defragmentation, in vertices or indices.
+//!
+struct MeshPoolCopy
+{
+    uint32_t srcOffset = 0;
+    uint32_t dstOffset = 0;
+    uint32_t count     = 0;
+};
+
+//! @class MeshPoolAllocator
+//!
+//! Hands out vertex and index ranges for grfx::MeshPool. It only tracks
+//! offsets, it never touches GPU memory. Handles stay valid across
+//! Defragment() so callers can keep them while ranges move.
+//!
+class MeshPoolAllocator
+{
+public:
+    static constexpr uint32_t kInvalidHandle = UINT32_MAX;
+
+    MeshPoolAllocator() {}
+    ~MeshPoolAllocator() {}
+
+    static Result Create(uint32_t maxVertexCount, uint32_t maxIndexCount, MeshPoolAllocator* pAllocator);
+
+    //! Returns ERROR_OUT_OF_MEMORY if either range doesn't fit. The pool
+    //! may still have enough free space in total, see Defragment().
+    Result Allocate(uint32_t vertexCount, uint32_t indexCount, uint32_t* pHandle);
+    void   Free(uint32_t handle);
+
+    bool                       IsValid(uint32_t handle) const;
+    const grfx::MeshPoolRange& GetRange(uint32_t handle) const { return mSlots[handle].range; }
+    uint32_t                   GetMeshCount() const { return mMeshCount; }
+
+    uint32_t GetMaxVertexCount() const { return static_cast<uint32_t>(mVertexAllocator.GetSize()); }
+    uint32_t GetMaxIndexCount() const { return mMaxIndexCount; }
+    uint32_t GetUsedVertexCount() const { return static_cast<uint32_t>(mVertexAllocator.GetUsedSize()); }
+    uint32_t GetUsedIndexCount() const;
+
+    //! Returns the free space, as a fraction of 1, that's not part of the
+    //! largest free range, for vertices or indices, whichever is worse.
+    //! 0 means all free space is contiguous.
+    float GetFragmentation() const;
+
+    //! Packs all ranges to the start of the pool, in the order of their
+    //! current offsets. \b pVertexCopies and \b pIndexCopies receive the
+    //! copies that move the live data from the old layout into new buffers,
+    //! adjacent ranges are merged into one copy.
+    void Defragment(std::vector<grfx::MeshPoolCopy>* pVertexCopies, std::vector<grfx::MeshPoolCopy>* pIndexCopies);
+
+private:
+    struct Slot
+    {
+        grfx::MeshPoolRange range;
+        uint32_t            vertexHandle = TLSFAllocator::kInvalidHandle;
+        uint32_t            indexHandle  = TLSFAllocator::kInvalidHandle;
+        bool                used         = false;
+    };
+
+    // Repacks one allocator and records the copies, \b indices selects the
+    // index or the vertex ranges of the slots.
+    void Repack(bool indices, std::vector<grfx::MeshPoolCopy>* pCopies);
+
+private:
+    TLSFAllocator         mVertexAllocator;
+    TLSFAllocator         mIndexAllocator; // Unused if mMaxIndexCount is 0
+    uint32_t              mMaxIndexCount = 0;
+    std::vector<Slot>     mSlots;
+    std::vector<uint32_t> mFreeSlots;
+    uint32_t              mMeshCount = 0;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_mesh_pool_allocator_h
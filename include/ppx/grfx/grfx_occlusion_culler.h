@@ -0,0 +1,132 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_occlusion_culler_h
+#define ppx_grfx_occlusion_culler_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_descriptor.h"
+#include "ppx/grfx/grfx_image.h"
+#include "ppx/grfx/grfx_pipeline.h"
+#include "ppx/bounding_volume.h"
+
+namespace ppx {
+namespace grfx {
+
+//! @struct OcclusionCullerCreateInfo
+//!
+//! Usage Notes:
+//!   - \b width and \b height are the size of the depth buffer the
+//!     hierarchical Z (HiZ) pyramid is built from
+//!   - \b maxObjectCount is the number of bounding boxes SetBounds() accepts
+//!
+struct OcclusionCullerCreateInfo
+{
+    uint32_t              width          = 0;
+    uint32_t              height         = 0;
+    uint32_t              maxObjectCount = 0;
+    grfx::ShaderStageInfo buildCS        = {}; // Use basic/shaders/HiZBuild.hlsl (csmain) for now
+    grfx::ShaderStageInfo testCS         = {}; // Use basic/shaders/HiZOcclusionTest.hlsl (csmain) for now
+};
+
+//! @class OcclusionCuller
+//!
+//! GPU occlusion culling against a hierarchical Z pyramid. Each HiZ texel
+//! holds the farthest depth of the texels it covers in the level below,
+//! level 0 being a copy of the depth buffer. An object is occluded if the
+//! nearest depth of its bounding box is behind the farthest depth of the
+//! HiZ texels its screen rectangle covers, at the level where the rectangle
+//! spans at most 2x2 texels.
+//!
+//! A frame typically renders occluders (or last frame's visible objects)
+//! to depth, calls RecordBuildHiZ() and RecordOcclusionTest(), then reads
+//! GetVisibility() once the command buffer has completed, usually on the
+//! next frame that reuses the same fence. Objects that cross the camera
+//! plane are always visible.
+//!
+//! Depth must use the zero to one range with 0 at the near plane, reversed
+//! Z isn't supported. The culler holds one set of bounds, parameters and
+//! results: the caller must make sure the GPU is done with the previous
+//! test before calling SetBounds(), RecordBuildHiZ() or RecordOcclusionTest()
+//! again.
+//!
+class OcclusionCuller
+    : public grfx::DeviceObject<grfx::OcclusionCullerCreateInfo>
+{
+public:
+    OcclusionCuller() {}
+    virtual ~OcclusionCuller() {}
+
+    grfx::ImagePtr GetHiZImage() const { return mHiZImage; }
+    uint32_t       GetMipLevelCount() const { return CountU32(mHiZStorageViews); }
+    uint32_t       GetMaxObjectCount() const { return mCreateInfo.maxObjectCount; }
+
+    //! Copies world space bounding boxes for the next RecordOcclusionTest().
+    Result SetBounds(uint32_t count, const ppx::AABB* pBounds);
+
+    //! Builds the HiZ pyramid from \b pDepthView, which must be in
+    //! grfx::RESOURCE_STATE_SHADER_RESOURCE and have one R32 mip level of
+    //! the create info size.
+    void RecordBuildHiZ(grfx::CommandBuffer* pCommandBuffer, const grfx::SampledImageView* pDepthView);
+
+    //! Tests the bounds set by SetBounds() against the HiZ pyramid and copies
+    //! the results to a buffer readable from the CPU.
+    void RecordOcclusionTest(grfx::CommandBuffer* pCommandBuffer, const float4x4& viewProjection);
+
+    //! Results of the last test, one value per object, 0 if it's occluded.
+    //! Only valid once the command buffer that recorded the test completed.
+    const uint32_t* GetVisibility() const { return mVisibility; }
+    uint32_t        GetTestedCount() const { return mTestedCount; }
+    uint32_t        GetOccludedCount() const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+
+private:
+    Result CreateBuildObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo);
+    Result CreateTestObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo);
+
+private:
+    grfx::ImagePtr                         mHiZImage;
+    std::vector<grfx::StorageImageViewPtr> mHiZStorageViews;
+    std::vector<grfx::SampledImageViewPtr> mHiZSampledViews; // One per level, read by the next level
+    grfx::SampledImageViewPtr              mHiZView;         // All levels, read by the occlusion test
+    grfx::DescriptorPoolPtr                mDescriptorPool;
+    grfx::DescriptorSetLayoutPtr           mBuildSetLayout;
+    std::vector<grfx::DescriptorSetPtr>    mBuildSets;
+    grfx::PipelineInterfacePtr             mBuildPipelineInterface;
+    grfx::ComputePipelinePtr               mBuildPipeline;
+    const grfx::SampledImageView*          mDepthView = nullptr;
+    grfx::BufferPtr                        mBoundsBuffer;
+    grfx::BufferPtr                        mParamsBuffer;
+    grfx::BufferPtr                        mVisibilityBuffer;
+    grfx::BufferPtr                        mReadbackBuffer;
+    grfx::DescriptorSetLayoutPtr           mTestSetLayout;
+    grfx::DescriptorSetPtr                 mTestSet;
+    grfx::PipelineInterfacePtr             mTestPipelineInterface;
+    grfx::ComputePipelinePtr               mTestPipeline;
+    float*                                 mBounds      = nullptr;
+    void*                                  mParams      = nullptr;
+    const uint32_t*                        mVisibility  = nullptr;
+    uint32_t                               mBoundsCount = 0;
+    uint32_t                               mTestedCount = 0;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_occlusion_culler_h
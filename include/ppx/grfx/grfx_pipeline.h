@@ -149,11 +149,15 @@ struct ColorBlendState
     float                      blendConstants[4]                        = {1.0f, 1.0f, 1.0f, 1.0f};
 };
 
+//! Set \b dynamicRendering for pipelines used between
+//! CommandBuffer::BeginRendering() and EndRendering() instead of in a
+//! render pass. D3D12 ignores it.
 struct OutputState
 {
     uint32_t     renderTargetCount                           = 0;
     grfx::Format renderTargetFormats[PPX_MAX_RENDER_TARGETS] = {grfx::FORMAT_UNDEFINED};
     grfx::Format depthStencilFormat                          = grfx::FORMAT_UNDEFINED;
+    bool         dynamicRendering                            = false;
 };
 
 //! @struct GraphicsPipelineCreateInfo
@@ -200,6 +204,17 @@ void FillOutGraphicsPipelineCreateInfo(
     const grfx::GraphicsPipelineCreateInfo2* pSrcCreateInfo,
     grfx::GraphicsPipelineCreateInfo*        pDstCreateInfo);
 
+//! Writes the state of \b createInfo that affects the compiled pipeline to
+//! \b pKey. Create infos with the same key create identical pipelines:
+//! state the API ignores, e.g. the blend factors of attachments without
+//! blending, is left out, and shader modules are identified by the hash of
+//! their code. Pipeline interfaces are compared by their set layouts if
+//! \b compareInterfaceLayouts is true, otherwise by identity.
+void GetGraphicsPipelineKey(
+    const grfx::GraphicsPipelineCreateInfo& createInfo,
+    bool                                    compareInterfaceLayouts,
+    std::string*                            pKey);
+
 } // namespace internal
 
 //! @class GraphicsPipeline
@@ -260,6 +275,10 @@ public:
     bool                         HasConsecutiveSetNumbers() const { return mHasConsecutiveSetNumbers; }
     const std::vector<uint32_t>& GetSetNumbers() const { return mSetNumbers; }
 
+    //! Returns the layout of set number \b set, nullptr if the interface
+    //! doesn't have that set.
+    const grfx::DescriptorSetLayout* GetSetLayout(uint32_t set) const;
+
 protected:
     virtual Result Create(const grfx::PipelineInterfaceCreateInfo* pCreateInfo) override;
     friend class grfx::Device;
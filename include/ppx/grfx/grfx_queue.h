@@ -21,14 +21,23 @@
 namespace ppx {
 namespace grfx {
 
+//! @struct SubmitInfo
+//!
+//! \b pWaitValues and \b pSignalValues hold one value per wait/signal
+//! semaphore and are required if any of them is a timeline semaphore. Values
+//! for binary semaphores are ignored. \b commandBufferCount can be 0 to only
+//! wait on and signal semaphores.
+//!
 struct SubmitInfo
 {
     uint32_t                          commandBufferCount   = 0;
     const grfx::CommandBuffer* const* ppCommandBuffers     = nullptr;
     uint32_t                          waitSemaphoreCount   = 0;
     const grfx::Semaphore* const*     ppWaitSemaphores     = nullptr;
+    const uint64_t*                   pWaitValues          = nullptr;
     uint32_t                          signalSemaphoreCount = 0;
     grfx::Semaphore**                 ppSignalSemaphores   = nullptr;
+    const uint64_t*                   pSignalValues        = nullptr;
     grfx::Fence*                      pFence               = nullptr;
 };
 
@@ -63,6 +72,11 @@ public:
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) = 0;
 
+    //! Submits \b submitCount batches with a single API call, in order. Only
+    //! the last batch may set \b pFence, which is signaled once all batches
+    //! have completed.
+    virtual Result Submit(uint32_t submitCount, const grfx::SubmitInfo* pSubmitInfos) = 0;
+
     // GPU timestamp frequency counter in ticks per second
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const = 0;
 
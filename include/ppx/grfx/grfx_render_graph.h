@@ -0,0 +1,166 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_render_graph_h
+#define ppx_grfx_render_graph_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_draw_pass.h"
+#include "ppx/grfx/grfx_render_graph_plan.h"
+#include "ppx/grfx/grfx_texture.h"
+
+namespace ppx {
+namespace grfx {
+
+//! @struct RenderGraphCreateInfo
+//!
+//! \b enableAliasing lets transient images with disjoint lifetimes share
+//! a texture. Turning it off is meant for measuring what aliasing saves.
+//!
+struct RenderGraphCreateInfo
+{
+    bool enableAliasing = true;
+};
+
+//! @struct RenderGraphPassContext
+//!
+//! \b pDrawPass is the pass' render targets and depth stencil, already begun
+//! on \b pCommandBuffer. It's null for passes without attachments.
+//!
+struct RenderGraphPassContext
+{
+    grfx::CommandBuffer*     pCommandBuffer = nullptr;
+    grfx::DrawPass*          pDrawPass      = nullptr;
+    const grfx::RenderGraph* pGraph         = nullptr;
+};
+
+using RenderGraphExecuteFn = std::function<void(const grfx::RenderGraphPassContext&)>;
+
+//! @class RenderGraph
+//!
+//! Declares a frame as passes and the images they access, then creates the
+//! transient images, DrawPasses and state transitions from that. Passes are
+//! recorded in the order they're added. See grfx::RenderGraphPlan for the
+//! culling, aliasing and transition rules.
+//!
+//! Typical usage:
+//!   - create transient images and import external ones, e.g. the
+//!     swapchain image, once
+//!   - add passes and their accesses, then Compile()
+//!   - every frame, SetImportedImage() for images that change and
+//!     Execute() inside the frame's command buffer
+//!
+//! Images are referenced by the index returned at creation. Shaders read
+//! transient images through GetTexture(), the views are stable until the
+//! next Compile().
+//!
+class RenderGraph
+    : public grfx::DeviceObject<grfx::RenderGraphCreateInfo>
+{
+public:
+    static constexpr uint32_t kInvalidIndex = grfx::RenderGraphPlan::kInvalidIndex;
+
+    RenderGraph() {}
+    virtual ~RenderGraph() {}
+
+    uint32_t CreateImage(const grfx::RenderGraphImageInfo& info);
+
+    //! \b finalState can be RESOURCE_STATE_UNDEFINED to leave the image in
+    //! the state of its last access.
+    uint32_t ImportImage(grfx::Image* pImage, grfx::ResourceState initialState, grfx::ResourceState finalState);
+
+    //! Replaces an imported image, e.g. with the current swapchain image. The
+    //! new image must match the size and format of the one it replaces.
+    Result SetImportedImage(uint32_t image, grfx::Image* pImage);
+
+    //! Passes with side effects, e.g. writes to buffers, are never culled.
+    uint32_t AddPass(const std::string& name, grfx::RenderGraphExecuteFn executeFn, bool hasSideEffects = false);
+
+    //! Render targets are bound in the order they're added. The pass clears
+    //! its render targets if any of them has a clear value, the ones without
+    //! are cleared to zero.
+    Result AddRenderTarget(uint32_t pass, uint32_t image, const grfx::RenderTargetClearValue* pClearValue = nullptr);
+
+    //! Read-only depth stencil attachments can't be cleared.
+    Result SetDepthStencil(uint32_t pass, uint32_t image, bool write, const grfx::DepthStencilClearValue* pClearValue = nullptr);
+
+    //! Accesses that aren't attachments: shader reads, storage and copies.
+    Result AddAccess(uint32_t pass, uint32_t image, grfx::RenderGraphAccess access);
+
+    //! Removes all passes and images.
+    void Clear();
+
+    //! Creates the transient textures. Invalidates textures returned by
+    //! GetTexture() before the call.
+    Result Compile();
+
+    //! Records transitions and live passes into \b pCommandBuffer.
+    Result Execute(grfx::CommandBuffer* pCommandBuffer);
+
+    const grfx::RenderGraphPlan& GetPlan() const { return mPlan; }
+    const std::string&           GetPassName(uint32_t pass) const { return mPasses[pass].name; }
+    uint32_t                     GetCulledPassCount() const;
+
+    grfx::Image* GetImage(uint32_t image) const;
+
+    //! Returns null for imported images and images no live pass accesses.
+    grfx::Texture* GetTexture(uint32_t image) const;
+
+    //! Bytes allocated for transient images.
+    uint64_t GetTransientMemorySize() const;
+
+    //! Bytes transient images would take with one texture each.
+    uint64_t GetUnaliasedMemorySize() const;
+
+protected:
+    virtual Result CreateApiObjects(const grfx::RenderGraphCreateInfo* pCreateInfo) override;
+    virtual void   DestroyApiObjects() override;
+    friend class grfx::Device;
+
+private:
+    struct CachedDrawPass
+    {
+        grfx::Image*      pAttachments[PPX_MAX_RENDER_TARGETS + 1] = {};
+        grfx::DrawPassPtr drawPass;
+    };
+
+    struct Pass
+    {
+        std::string                  name;
+        grfx::RenderGraphExecuteFn   executeFn;
+        uint32_t                     renderTargetCount                               = 0;
+        uint32_t                     renderTargets[PPX_MAX_RENDER_TARGETS]           = {};
+        grfx::RenderTargetClearValue renderTargetClearValues[PPX_MAX_RENDER_TARGETS] = {};
+        uint32_t                     depthStencil                                    = kInvalidIndex;
+        bool                         depthStencilWrite                               = false;
+        grfx::DepthStencilClearValue depthStencilClearValue                          = {};
+        grfx::DrawPassClearFlags     clearFlags                                      = 0;
+        std::vector<CachedDrawPass>  drawPasses;
+    };
+
+    void   DestroyTransientObjects();
+    Result GetDrawPass(Pass& pass, grfx::DrawPass** ppDrawPass);
+
+private:
+    grfx::RenderGraphPlan         mPlan;
+    std::vector<Pass>             mPasses;
+    std::vector<grfx::Image*>     mImportedImages; // Indexed by image, null for transient images
+    std::vector<grfx::TexturePtr> mTextures;       // Indexed by physical image
+    bool                          mCompiled = false;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_render_graph_h
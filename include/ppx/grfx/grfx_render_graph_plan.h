@@ -0,0 +1,184 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_render_graph_plan_h
+#define ppx_grfx_render_graph_plan_h
+
+#include "ppx/config.h"
+#include "ppx/grfx/grfx_enums.h"
+#include "ppx/grfx/grfx_format.h"
+
+namespace ppx {
+namespace grfx {
+
+enum RenderGraphAccess
+{
+    RENDER_GRAPH_ACCESS_RENDER_TARGET       = 0, // Write
+    RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE = 1, // Write
+    RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ  = 2, // Read
+    RENDER_GRAPH_ACCESS_SHADER_RESOURCE     = 3, // Read
+    RENDER_GRAPH_ACCESS_STORAGE             = 4, // Read and write
+    RENDER_GRAPH_ACCESS_COPY_SRC            = 5, // Read
+    RENDER_GRAPH_ACCESS_COPY_DST            = 6, // Write
+    RENDER_GRAPH_ACCESS_COUNT               = 7,
+};
+
+//! @struct RenderGraphImageInfo
+//!
+//! Transient images with equal infos can share a physical image.
+//!
+struct RenderGraphImageInfo
+{
+    uint32_t          width       = 0;
+    uint32_t          height      = 0;
+    grfx::Format      format      = grfx::FORMAT_UNDEFINED;
+    grfx::SampleCount sampleCount = grfx::SAMPLE_COUNT_1;
+
+    bool operator==(const RenderGraphImageInfo& rhs) const
+    {
+        return (width == rhs.width) && (height == rhs.height) && (format == rhs.format) && (sampleCount == rhs.sampleCount);
+    }
+};
+
+//! @class RenderGraphPlan
+//!
+//! The device independent half of grfx::RenderGraph. Passes and the images
+//! they access are declared in submission order, Compile() then:
+//!   - culls passes whose writes are never read, unless they have side
+//!     effects or write an imported image
+//!   - computes the first and last live pass of each transient image and
+//!     assigns transient images with disjoint lifetimes and equal infos to
+//!     the same physical image
+//!   - computes the state transitions each live pass needs before it runs
+//!
+//! Physical images rest, between frames, in the state of their last access
+//! so the first access of the next frame transitions from there. Imported
+//! images start in their initial state and are transitioned to their final
+//! state after the last pass.
+//!
+class RenderGraphPlan
+{
+public:
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    struct Barrier
+    {
+        uint32_t            image       = kInvalidIndex;
+        grfx::ResourceState beforeState = grfx::RESOURCE_STATE_UNDEFINED;
+        grfx::ResourceState afterState  = grfx::RESOURCE_STATE_UNDEFINED;
+    };
+
+    RenderGraphPlan() {}
+    ~RenderGraphPlan() {}
+
+    static grfx::ResourceState ToResourceState(grfx::RenderGraphAccess access);
+    static bool                IsRead(grfx::RenderGraphAccess access);
+    static bool                IsWrite(grfx::RenderGraphAccess access);
+
+    //! Returns the index of the new image.
+    uint32_t AddImage(const grfx::RenderGraphImageInfo& info);
+
+    //! Returns the index of the new image. The graph doesn't own imported
+    //! images. \b finalState can be RESOURCE_STATE_UNDEFINED to leave the
+    //! image in the state of its last access.
+    uint32_t ImportImage(const grfx::RenderGraphImageInfo& info, grfx::ResourceState initialState, grfx::ResourceState finalState);
+
+    //! Returns the index of the new pass. Passes with side effects, e.g.
+    //! writes to buffers or presentation, are never culled.
+    uint32_t AddPass(bool hasSideEffects = false);
+
+    //! A pass can access each image once. Returns ERROR_OUT_OF_RANGE for
+    //! invalid indices and ERROR_DUPLICATE_ELEMENT for repeated accesses.
+    Result AddAccess(uint32_t pass, uint32_t image, grfx::RenderGraphAccess access);
+
+    //! Removes all passes and images.
+    void Clear();
+
+    //! Returns ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE if a live pass reads
+    //! a transient image that no earlier live pass wrote. Aliasing can be
+    //! disabled to measure what it saves.
+    Result Compile(bool enableAliasing = true);
+
+    uint32_t GetImageCount() const { return CountU32(mImages); }
+    uint32_t GetPassCount() const { return CountU32(mPasses); }
+    bool     IsImageImported(uint32_t image) const { return mImages[image].imported; }
+
+    // Valid after Compile()
+    bool                         IsPassCulled(uint32_t pass) const { return mPasses[pass].culled; }
+    const std::vector<uint32_t>& GetExecutionOrder() const { return mExecutionOrder; }
+    const std::vector<Barrier>&  GetPassBarriers(uint32_t pass) const { return mPasses[pass].barriers; }
+    const std::vector<Barrier>&  GetFinalBarriers() const { return mFinalBarriers; }
+
+    //! Returns kInvalidIndex for imported images and transient images that
+    //! no live pass accesses.
+    uint32_t GetPhysicalImageIndex(uint32_t image) const { return mImages[image].physicalIndex; }
+
+    uint32_t                          GetPhysicalImageCount() const { return CountU32(mPhysicalImages); }
+    const grfx::RenderGraphImageInfo& GetPhysicalImageInfo(uint32_t physical) const { return mPhysicalImages[physical].info; }
+    grfx::ResourceState               GetPhysicalImageInitialState(uint32_t physical) const { return mPhysicalImages[physical].initialState; }
+
+    //! Returns one bit per RenderGraphAccess the physical image is used with.
+    uint32_t GetPhysicalImageAccessMask(uint32_t physical) const { return mPhysicalImages[physical].accessMask; }
+
+private:
+    struct Access
+    {
+        uint32_t                image  = kInvalidIndex;
+        grfx::RenderGraphAccess access = grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE;
+    };
+
+    struct Pass
+    {
+        bool                 hasSideEffects = false;
+        bool                 culled         = false;
+        std::vector<Access>  accesses;
+        std::vector<Barrier> barriers;
+    };
+
+    struct Image
+    {
+        grfx::RenderGraphImageInfo info          = {};
+        bool                       imported      = false;
+        grfx::ResourceState        initialState  = grfx::RESOURCE_STATE_UNDEFINED;
+        grfx::ResourceState        finalState    = grfx::RESOURCE_STATE_UNDEFINED;
+        uint32_t                   firstUse      = kInvalidIndex;
+        uint32_t                   lastUse       = kInvalidIndex;
+        uint32_t                   physicalIndex = kInvalidIndex;
+    };
+
+    struct PhysicalImage
+    {
+        grfx::RenderGraphImageInfo info         = {};
+        uint32_t                   lastUse      = kInvalidIndex;
+        uint32_t                   accessMask   = 0;
+        grfx::ResourceState        initialState = grfx::RESOURCE_STATE_UNDEFINED;
+    };
+
+    void   CullPasses();
+    Result ComputeLifetimes();
+    void   AssignPhysicalImages(bool enableAliasing);
+    void   ComputeBarriers();
+
+private:
+    std::vector<Pass>          mPasses;
+    std::vector<Image>         mImages;
+    std::vector<PhysicalImage> mPhysicalImages;
+    std::vector<uint32_t>      mExecutionOrder;
+    std::vector<Barrier>       mFinalBarriers;
+};
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_render_graph_plan_h
@@ -16,6 +16,7 @@
 #define ppx_grfx_shader_h
 
 #include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_shader_reflection.h"
 
 namespace ppx {
 namespace grfx {
@@ -25,8 +26,9 @@ namespace grfx {
 //!
 struct ShaderModuleCreateInfo
 {
-    uint32_t    size  = 0;
-    const char* pCode = nullptr;
+    uint32_t    size    = 0;
+    const char* pCode   = nullptr;
+    bool        reflect = false; // SPIR-V only, see ShaderModule::GetReflection()
 };
 
 //! @class ShaderModule
@@ -38,8 +40,31 @@ class ShaderModule
 public:
     ShaderModule() {}
     virtual ~ShaderModule() {}
+
+    //! Interface of the module if it was created from SPIR-V with
+    //! ShaderModuleCreateInfo::reflect set, nullptr otherwise.
+    const grfx::ShaderReflection* GetReflection() const { return mReflection.get(); }
+
+    //! XXH64 of the bytecode, equal for modules created from the same code.
+    uint64_t GetCodeHash() const { return mCodeHash; }
+
+protected:
+    virtual Result Create(const grfx::ShaderModuleCreateInfo* pCreateInfo) override;
+    friend class grfx::Device;
+
+private:
+    std::shared_ptr<const grfx::ShaderReflection> mReflection;
+    uint64_t                                      mCodeHash = 0;
 };
 
+//! Creates the minimal descriptor set layouts for the reflected stages
+//! \b ppModules of a pipeline, see BuildShaderInterfaceLayout(), and a
+//! pipeline interface using them. The layouts are returned in set number
+//! order. Returns ERROR_REQUIRED_FEATURE_UNAVAILABLE if a module wasn't
+//! reflected or uses push constants, which pipeline interfaces don't
+//! support yet.
+Result CreateReflectedPipelineInterface(grfx::Device* pDevice, uint32_t moduleCount, const grfx::ShaderModule* const* ppModules, std::vector<grfx::DescriptorSetLayoutPtr>* pSetLayouts, grfx::PipelineInterface** ppPipelineInterface);
+
 } // namespace grfx
 } // namespace ppx
 
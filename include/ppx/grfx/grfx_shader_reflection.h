@@ -0,0 +1,105 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_grfx_shader_reflection_h
+#define ppx_grfx_shader_reflection_h
+
+#include "ppx/grfx/grfx_config.h"
+#include "ppx/grfx/grfx_descriptor.h"
+
+#include <memory>
+
+//
+// Reflection of SPIR-V modules, to build descriptor set layouts and
+// pipeline interfaces from the shaders instead of writing them by hand.
+//
+// Resource types are mapped the way DXC compiles HLSL resources for the
+// Vulkan backend (see ShaderCompile.cmake):
+//   - ConstantBuffer, cbuffer    -> UNIFORM_BUFFER
+//   - StructuredBuffer           -> RO_STRUCTURED_BUFFER
+//   - RWStructuredBuffer         -> RW_STRUCTURED_BUFFER
+//   - (RW)ByteAddressBuffer      -> RAW_STORAGE_BUFFER
+//   - Texture*, Buffer           -> SAMPLED_IMAGE, UNIFORM_TEXEL_BUFFER
+//   - RWTexture*, RWBuffer       -> STORAGE_IMAGE, STORAGE_TEXEL_BUFFER
+//   - SamplerState, SubpassInput -> SAMPLER, INPUT_ATTACHMENT
+//
+// DXIL modules can't be reflected, D3D12 applications still describe their
+// layouts by hand.
+//
+namespace ppx {
+namespace grfx {
+
+//! @struct ReflectedBinding
+//!
+//! A resource variable of a shader module.
+//!
+struct ReflectedBinding
+{
+    std::string           name       = "";
+    uint32_t              set        = 0;
+    uint32_t              binding    = 0;
+    grfx::DescriptorType  type       = grfx::DESCRIPTOR_TYPE_UNDEFINED;
+    uint32_t              arrayCount = 1;
+    grfx::ShaderStageBits stage      = grfx::SHADER_STAGE_UNDEFINED;
+};
+
+//! @struct ShaderReflection
+//!
+//! Interface of the first entry point of a SPIR-V module.
+//!
+struct ShaderReflection
+{
+    grfx::ShaderStageBits               stage            = grfx::SHADER_STAGE_UNDEFINED;
+    std::string                         entryPoint       = "";
+    std::vector<grfx::ReflectedBinding> bindings         = {};        // Sorted by set then binding
+    uint32_t                            pushConstantSize = 0;         // Bytes, 0 if there's no push constant block
+    std::vector<grfx::VertexAttribute>  vertexInputs     = {};        // VS only, sorted by location, all in binding 0
+    uint32_t                            workgroupSize[3] = {0, 0, 0}; // CS only
+};
+
+//! @struct ShaderInterfaceLayout
+//!
+//! Minimal descriptor set layouts for the stages of a pipeline: only the
+//! bindings the stages use, visible to the one stage using them or to all
+//! stages if several do.
+//!
+struct ShaderInterfaceLayout
+{
+    std::vector<uint32_t>                            setNumbers       = {}; // Sorted
+    std::vector<grfx::DescriptorSetLayoutCreateInfo> setLayouts       = {}; // One per entry of setNumbers
+    uint32_t                                         pushConstantSize = 0;
+};
+
+//! Parses \b pCode, which must be a SPIR-V module of \b size bytes.
+//! Returns ERROR_GRFX_INVALID_SHADER_BYTE_CODE if it isn't SPIR-V and
+//! ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE for resources that have no
+//! grfx::DescriptorType equivalent, e.g. acceleration structures.
+Result ReflectSpirv(const void* pCode, size_t size, grfx::ShaderReflection* pReflection);
+
+//! Same as ReflectSpirv(), but modules are only parsed the first time a
+//! module with the same contents (same hash) is seen. Thread safe.
+Result GetCachedShaderReflection(const void* pCode, size_t size, std::shared_ptr<const grfx::ShaderReflection>* pReflection);
+
+//! Returns true if \b pCode starts with the SPIR-V magic number.
+bool IsSpirv(const void* pCode, size_t size);
+
+//! Merges the bindings of the stages of a pipeline into one layout per set.
+//! Returns ERROR_GRFX_INVALID_DESCRIPTOR_TYPE if two stages declare the same
+//! set and binding with different types or array sizes.
+Result BuildShaderInterfaceLayout(uint32_t reflectionCount, const grfx::ShaderReflection* const* ppReflections, grfx::ShaderInterfaceLayout* pLayout);
+
+} // namespace grfx
+} // namespace ppx
+
+#endif // ppx_grfx_shader_reflection_h
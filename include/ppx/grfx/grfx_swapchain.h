@@ -16,6 +16,9 @@
 #define ppx_grfx_swapchain_h
 
 #include "ppx/grfx/grfx_config.h"
+
+#include <functional>
+
 #if defined(PPX_BUILD_XR)
 #include "ppx/xr_component.h"
 #endif
@@ -103,8 +106,33 @@ struct SwapchainCreateInfo
 #endif
 };
 
+//! @struct HeadlessReadback
+//!
+//! Contents of an image presented to a headless swapchain. \b pData is
+//! only valid during the readback callback.
+//!
+struct HeadlessReadback
+{
+    uint32_t     imageIndex = 0;
+    uint64_t     presentId  = 0; // Number of the Present() call, starting at 1
+    grfx::Format format     = grfx::FORMAT_UNDEFINED;
+    uint32_t     width      = 0;
+    uint32_t     height     = 0;
+    uint32_t     rowPitch   = 0;
+    const void*  pData      = nullptr;
+};
+
+//! Called by Swapchain::Present() with the newest presented image whose copy
+//! to host memory has completed.
+using HeadlessReadbackCallback = std::function<void(const grfx::HeadlessReadback&)>;
+
 //! @class Swapchain
 //!
+//! Headless swapchains have no presentation engine. AcquireNextImage() hands
+//! out the images in turn and signals the semaphore and fence with a submit
+//! that has no command buffers; Present() waits on the semaphores the same
+//! way. No images are ever held back, so rendering never blocks on the
+//! swapchain.
 //!
 class Swapchain
     : public grfx::DeviceObject<grfx::SwapchainCreateInfo>
@@ -124,10 +152,18 @@ public:
     Result GetDepthImage(uint32_t imageIndex, grfx::Image** ppImage) const;
     Result GetRenderPass(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp, grfx::RenderPass** ppRenderPass) const;
 
+    //! Views of the swapchain images for CommandBuffer::BeginRendering(),
+    //! which doesn't need render pass objects. The depth stencil view clears
+    //! depth and stencil.
+    Result GetRenderTargetView(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp, grfx::RenderTargetView** ppView) const;
+    Result GetDepthStencilView(uint32_t imageIndex, grfx::DepthStencilView** ppView) const;
+
     // Convenience functions - returns empty object if index is invalid
-    grfx::ImagePtr      GetColorImage(uint32_t imageIndex) const;
-    grfx::ImagePtr      GetDepthImage(uint32_t imageIndex) const;
-    grfx::RenderPassPtr GetRenderPass(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp = grfx::ATTACHMENT_LOAD_OP_CLEAR) const;
+    grfx::ImagePtr            GetColorImage(uint32_t imageIndex) const;
+    grfx::ImagePtr            GetDepthImage(uint32_t imageIndex) const;
+    grfx::RenderPassPtr       GetRenderPass(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp = grfx::ATTACHMENT_LOAD_OP_CLEAR) const;
+    grfx::RenderTargetViewPtr GetRenderTargetView(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp = grfx::ATTACHMENT_LOAD_OP_CLEAR) const;
+    grfx::DepthStencilViewPtr GetDepthStencilView(uint32_t imageIndex) const;
 
     Result AcquireNextImage(
         uint64_t         timeout,    // Nanoseconds
@@ -142,6 +178,16 @@ public:
 
     uint32_t GetCurrentImageIndex() const { return currentImageIndex; }
 
+    //! Headless swapchains only. Copies each presented image to host memory
+    //! without stalling and runs \b callback from a later Present() call
+    //! once copies complete. If several copies complete between two calls,
+    //! only the newest is delivered and the older ones are dropped. Pass an
+    //! empty callback to stop reading back. Requires timeline semaphores.
+    Result SetHeadlessReadbackCallback(grfx::HeadlessReadbackCallback callback);
+
+    //! Number of readbacks dropped because a newer one completed first.
+    uint64_t GetHeadlessDroppedReadbackCount() const { return mHeadlessDroppedReadbackCount; }
+
 #if defined(PPX_BUILD_XR)
     bool ShouldSkipExternalSynchronization() const
     {
@@ -185,14 +231,36 @@ private:
         uint32_t                      waitSemaphoreCount,
         const grfx::Semaphore* const* ppWaitSemaphores);
 
-    std::vector<grfx::CommandBufferPtr> mHeadlessCommandBuffers;
+    Result CreateHeadlessReadbackObjects();
+    void   DestroyHeadlessReadbackObjects();
+    void   DeliverHeadlessReadbacks();
+
+    struct HeadlessReadbackSlot
+    {
+        grfx::BufferPtr        buffer;
+        grfx::CommandBufferPtr commandBuffer;
+        uint64_t               presentId = 0; // 0 if there's no copy to deliver
+        uint32_t               rowPitch  = 0;
+    };
+
+    uint64_t                          mHeadlessPresentCount         = 0;
+    uint64_t                          mHeadlessDroppedReadbackCount = 0;
+    grfx::HeadlessReadbackCallback    mHeadlessReadbackCallback;
+    grfx::SemaphorePtr                mHeadlessReadbackSemaphore; // Timeline, signaled with the present id of each copy
+    std::vector<HeadlessReadbackSlot> mHeadlessReadbackSlots;     // One per image
 
 protected:
-    grfx::QueuePtr                   mQueue;
-    std::vector<grfx::ImagePtr>      mDepthImages;
-    std::vector<grfx::ImagePtr>      mColorImages;
-    std::vector<grfx::RenderPassPtr> mClearRenderPasses;
-    std::vector<grfx::RenderPassPtr> mLoadRenderPasses;
+    grfx::QueuePtr                         mQueue;
+    std::vector<grfx::ImagePtr>            mDepthImages;
+    std::vector<grfx::ImagePtr>            mColorImages;
+
+    // Created on first use by GetRenderTargetView(), GetDepthStencilView()
+    // and GetRenderPass()
+    mutable std::vector<grfx::RenderTargetViewPtr> mClearRenderTargetViews;
+    mutable std::vector<grfx::RenderTargetViewPtr> mLoadRenderTargetViews;
+    mutable std::vector<grfx::DepthStencilViewPtr> mDepthStencilViews;
+    mutable std::vector<grfx::RenderPassPtr>       mClearRenderPasses;
+    mutable std::vector<grfx::RenderPassPtr>       mLoadRenderPasses;
 
 #if defined(PPX_BUILD_XR)
     XrSwapchain mXrColorSwapchain = XR_NULL_HANDLE;
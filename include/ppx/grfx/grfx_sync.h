@@ -53,13 +53,23 @@ protected:
 
 //! @struct SemaphoreCreateInfo
 //!
+//! \b initialValue is only used by timeline semaphores.
 //!
 struct SemaphoreCreateInfo
 {
+    grfx::SemaphoreType semaphoreType = grfx::SEMAPHORE_TYPE_BINARY;
+    uint64_t            initialValue  = 0;
 };
 
 //! @class Semaphore
 //!
+//! A timeline semaphore holds a monotonically increasing 64-bit counter.
+//! Queue submits signal and wait on values of the counter through
+//! SubmitInfo::pSignalValues and SubmitInfo::pWaitValues, and the host can
+//! wait on, signal and query it directly. On D3D12 both semaphore types are
+//! backed by an ID3D12Fence.
+//!
+//! Timeline semaphores cannot be used with swapchain acquire or present.
 //!
 class Semaphore
     : public grfx::DeviceObject<grfx::SemaphoreCreateInfo>
@@ -68,10 +78,25 @@ public:
     Semaphore() {}
     virtual ~Semaphore() {}
 
+    grfx::SemaphoreType GetSemaphoreType() const { return mCreateInfo.semaphoreType; }
+    bool                IsBinary() const { return mCreateInfo.semaphoreType == grfx::SEMAPHORE_TYPE_BINARY; }
+    bool                IsTimeline() const { return mCreateInfo.semaphoreType == grfx::SEMAPHORE_TYPE_TIMELINE; }
+
+    //! Blocks until the counter reaches \b value. Timeline semaphores only.
+    Result Wait(uint64_t value, uint64_t timeout = UINT64_MAX) const;
+    //! Sets the counter to \b value from the host. Timeline semaphores only.
+    Result Signal(uint64_t value) const;
+    //! Returns the current counter value, or 0 for a binary semaphore.
+    uint64_t GetCounterValue() const;
+
 protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) = 0;
     virtual void   DestroyApiObjects()                                            = 0;
     friend class grfx::Device;
+
+    virtual Result   TimelineWait(uint64_t value, uint64_t timeout) const = 0;
+    virtual Result   TimelineSignal(uint64_t value) const                 = 0;
+    virtual uint64_t TimelineCounterValue() const                         = 0;
 };
 
 } // namespace grfx
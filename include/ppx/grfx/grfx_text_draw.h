@@ -16,11 +16,16 @@
 #define ppx_grfx_text_draw_h
 
 #include "ppx/grfx/grfx_buffer.h"
+#include "ppx/grfx/grfx_command.h"
 #include "ppx/grfx/grfx_pipeline.h"
 #include "ppx/math_config.h"
 #include "ppx/font.h"
 #include "xxhash.h"
 
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace ppx {
 namespace grfx {
 
@@ -45,6 +50,28 @@ struct TextureFontCreateInfo
     ppx::Font   font;
     float       size       = 16.0f;
     std::string characters = ""; // Default characters if empty
+
+    // When enabled, codepoints that aren't in \b characters are rasterized on
+    // demand into a fixed size atlas, and the least recently used ones are
+    // evicted when it's full. Glyphs for \b characters stay resident. Cells
+    // fit the line height and the widest of \b characters, other glyphs that
+    // don't fit aren't drawn. A glyph is only evicted once the
+    // \b glyphCacheFramesInFlight frames that may still copy or sample it
+    // have completed.
+    bool     enableGlyphCache         = false;
+    uint32_t glyphCacheWidth          = 1024;
+    uint32_t glyphCacheHeight         = 1024;
+    uint32_t glyphCacheFramesInFlight = 2;
+
+    // Stores signed distance fields instead of coverage, so the same atlas can
+    // be drawn sharply at any size with basic/shaders/TextDrawSDF.hlsl. \b size
+    // is the size the fields are rendered at and \b sdfPadding the distance, in
+    // pixels at that size, they extend past the outline.
+    bool     signedDistanceField = false;
+    uint32_t sdfPadding          = 4;
+
+    // Threads used to rasterize the initial glyphs, 0 = one per hardware thread.
+    uint32_t rasterThreadCount = 0;
 };
 
 class TextureFont
@@ -66,14 +93,65 @@ public:
     float                                GetLineGap() const { return mFontMetrics.lineGap; }
     const grfx::TextureFontGlyphMetrics* GetGlyphMetrics(uint32_t codepoint) const;
 
+    //! Same as GetGlyphMetrics() but, if the glyph cache is enabled, rasterizes
+    //! a missing codepoint and marks the glyph as used by the current frame.
+    //! Returns null if the glyph can't be made resident. Text that's kept
+    //! across frames without being added again should stick to \b characters,
+    //! since any other glyph can be evicted.
+    const grfx::TextureFontGlyphMetrics* AcquireGlyph(uint32_t codepoint);
+
+    //! Starts a new glyph cache frame. Glyphs that aren't acquired again
+    //! become candidates for eviction. Call once per frame before adding text.
+    void AdvanceGlyphCacheFrame() { ++mGlyphCacheFrame; }
+
+    //! Copies glyphs rasterized since the last upload to the texture.
+    ppx::Result UploadGlyphs(grfx::Queue* pQueue);
+    void        UploadGlyphs(grfx::CommandBuffer* pCommandBuffer);
+
+    bool     IsSignedDistanceField() const { return mCreateInfo.signedDistanceField; }
+    bool     IsGlyphCacheEnabled() const { return mCreateInfo.enableGlyphCache; }
+    uint64_t GetGlyphCacheMissCount() const { return mGlyphCacheMissCount; }
+    uint64_t GetGlyphCacheEvictionCount() const { return mGlyphCacheEvictionCount; }
+
 protected:
     virtual Result CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+private:
+    Result CreateGlyphCache(const std::vector<uint32_t>& codepoints);
+    void   GetAtlasGlyphMetrics(uint32_t codepoint, GlyphMetrics* pMetrics) const;
+    void   RenderAtlasGlyph(uint32_t codepoint, uint32_t width, uint32_t height, uint32_t rowStride, char* pOutput) const;
+    bool   GlyphFitsCacheCell(const GlyphMetrics& metrics) const;
+    void   RasterizeGlyph(uint32_t slot, uint32_t codepoint, const GlyphMetrics& metrics);
+    void   GetPendingGlyphCopies(std::vector<grfx::BufferToImageCopyInfo>* pCopyInfos);
+
 private:
     FontMetrics                                mFontMetrics;
     std::vector<grfx::TextureFontGlyphMetrics> mGlyphMetrics;
+    std::unordered_map<uint32_t, uint32_t>     mGlyphLookup; // codepoint -> index in mGlyphMetrics
     grfx::TexturePtr                           mTexture;
+
+    // Glyph cache: mGlyphMetrics[i] describes slot i of a grid of fixed size cells
+    struct GlyphCacheSlot
+    {
+        uint64_t                      lastUsedFrame = 0;
+        bool                          pinned        = false;
+        std::list<uint32_t>::iterator lruIt;
+    };
+    std::vector<GlyphCacheSlot>  mGlyphCacheSlots;
+    std::vector<uint32_t>        mGlyphCacheFreeSlots;
+    std::list<uint32_t>          mGlyphCacheLru; // Unpinned resident slots, most recently used first
+    std::vector<bool>            mGlyphCacheDirtyRows;
+    std::unordered_set<uint32_t> mGlyphCacheOversized; // Codepoints whose glyph is larger than a cell
+    grfx::BufferPtr              mGlyphCacheBuffer;    // Persistently mapped CPU copy of the atlas
+    char*                        mGlyphCacheData          = nullptr;
+    uint32_t                     mGlyphCacheRowPitch      = 0;
+    uint32_t                     mGlyphCacheCellWidth     = 0;
+    uint32_t                     mGlyphCacheCellHeight    = 0;
+    uint32_t                     mGlyphCacheColumnCount   = 0;
+    uint64_t                     mGlyphCacheFrame         = 1;
+    uint64_t                     mGlyphCacheMissCount     = 0;
+    uint64_t                     mGlyphCacheEvictionCount = 0;
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -87,6 +165,15 @@ struct TextDrawCreateInfo
     grfx::BlendMode       blendMode          = grfx::BLEND_MODE_PREMULT_ALPHA;
     grfx::Format          renderTargetFormat = grfx::FORMAT_UNDEFINED;
     grfx::Format          depthStencilFormat = grfx::FORMAT_UNDEFINED;
+
+    // Streaming mode keeps one set of persistently mapped vertex/index buffers
+    // per frame in flight. AddString() writes into them and Draw() reads from
+    // them directly, so UploadToGpu() doesn't copy any geometry. maxTextLength
+    // is the initial capacity and is doubled when a frame runs out of space.
+    // Clear() moves on to the next frame's buffers: call it once per frame,
+    // after waiting for the frame that used them last.
+    bool     streaming           = false;
+    uint32_t streamingFrameCount = 2;
 };
 
 class TextDraw
@@ -96,6 +183,7 @@ public:
     TextDraw() {}
     virtual ~TextDraw() {}
 
+    //! Removes all text. In streaming mode also advances to the next frame's buffers.
     void Clear();
 
     void AddString(
@@ -112,12 +200,27 @@ public:
         const float3&      color   = float3(1, 1, 1),
         float              opacity = 1.0f);
 
+    // Draws the string at \b fontSize pixels instead of the font's size by
+    // scaling the glyph quads. Stays sharp only with signed distance field fonts.
+    void AddString(
+        const float2&      position,
+        const std::string& string,
+        float              fontSize,
+        float              tabSpacing,
+        float              lineSpacing,
+        const float3&      color,
+        float              opacity);
+
     // Use this if text is static
     ppx::Result UploadToGpu(grfx::Queue* pQueue);
 
-    // Use this if text is dynamic
+    // Use this if text is dynamic. In streaming mode only new glyphs of the
+    // font's glyph cache are copied.
     void UploadToGpu(grfx::CommandBuffer* pCommandBuffer);
 
+    bool     IsStreaming() const { return mCreateInfo.streaming; }
+    uint32_t GetTextLength() const { return mTextLength; }
+
     void PrepareDraw(const float4x4& MVP, grfx::CommandBuffer* pCommandBuffer);
     void Draw(grfx::CommandBuffer* pCommandBuffer);
 
@@ -125,6 +228,20 @@ protected:
     virtual Result CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+private:
+    struct StreamingFrame
+    {
+        grfx::BufferPtr indexBuffer;
+        grfx::BufferPtr vertexBuffer;
+        uint32_t*       pIndices  = nullptr;
+        void*           pVertices = nullptr;
+        uint32_t        capacity  = 0; // In glyphs
+    };
+
+    Result CreateStreamingBuffers(uint32_t capacity, StreamingFrame* pFrame);
+    void   DestroyStreamingBuffers(StreamingFrame* pFrame);
+    Result GrowStreamingBuffers(uint32_t minCapacity);
+
 private:
     uint32_t                     mTextLength = 0;
     grfx::BufferPtr              mCpuIndexBuffer;
@@ -140,6 +257,8 @@ private:
     grfx::DescriptorSetPtr       mDescriptorSet;
     grfx::PipelineInterfacePtr   mPipelineInterface;
     grfx::GraphicsPipelinePtr    mPipeline;
+    std::vector<StreamingFrame>  mStreamingFrames;
+    uint32_t                     mStreamingFrameIndex = 0;
 };
 
 } // namespace grfx
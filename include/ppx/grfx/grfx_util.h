@@ -25,6 +25,7 @@ namespace grfx {
 
 const char* ToString(grfx::Api value);
 const char* ToString(grfx::DescriptorType value);
+const char* ToString(grfx::MemoryCategory value);
 const char* ToString(grfx::VertexSemantic value);
 
 uint32_t     IndexTypeSize(grfx::IndexType value);
@@ -37,9 +37,10 @@ public:
 private:
     virtual void BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo) override;
     virtual void EndRenderPassImpl() override;
+    virtual void BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo) override;
+    virtual void EndRenderingImpl() override;
 
-public:
-    virtual void TransitionImageLayout(
+    virtual void TransitionImageLayoutImpl(
         const grfx::Image*  pImage,
         uint32_t            mipLevel,
         uint32_t            mipLevelCount,
@@ -50,12 +51,15 @@ public:
         const grfx::Queue*  pSrcQueue,
         const grfx::Queue*  pDstQueue) override;
 
-    virtual void BufferResourceBarrier(
+    virtual void BufferResourceBarrierImpl(
         const grfx::Buffer* pBuffer,
         grfx::ResourceState beforeState,
         grfx::ResourceState afterState,
-        const grfx::Queue*  pSrcQueue = nullptr,
-        const grfx::Queue*  pDstQueue = nullptr) override;
+        const grfx::Queue*  pSrcQueue,
+        const grfx::Queue*  pDstQueue) override;
+
+public:
+    virtual void FlushBarriers() override;
 
     virtual void SetViewports(
         uint32_t              viewportCount,
@@ -68,14 +72,18 @@ public:
     virtual void BindGraphicsDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) override;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) override;
 
     virtual void BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline) override;
 
     virtual void BindComputeDescriptorSets(
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets) override;
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount = 0,
+        const uint32_t*                   pDynamicOffsets    = nullptr) override;
 
     virtual void BindComputePipeline(const grfx::ComputePipeline* pPipeline) override;
 
@@ -98,6 +106,12 @@ public:
         int32_t  vertexOffset,
         uint32_t firstInstance) override;
 
+    virtual void DrawIndexedIndirect(
+        const grfx::Buffer* pArgBuffer,
+        uint64_t            offset,
+        uint32_t            drawCount,
+        uint32_t            stride) override;
+
     virtual void Dispatch(
         uint32_t groupCountX,
         uint32_t groupCountY,
@@ -155,10 +169,40 @@ private:
         VkPipelineBindPoint               bindPoint,
         const grfx::PipelineInterface*    pInterface,
         uint32_t                          setCount,
-        const grfx::DescriptorSet* const* ppSets);
+        const grfx::DescriptorSet* const* ppSets,
+        uint32_t                          dynamicOffsetCount,
+        const uint32_t*                   pDynamicOffsets);
+
+    // Barriers waiting for the next FlushBarriers(). Stage masks are kept per
+    // barrier for vkCmdPipelineBarrier2KHR.
+    struct PendingImageBarrier
+    {
+        VkPipelineStageFlags srcStageMask = 0;
+        VkPipelineStageFlags dstStageMask = 0;
+        VkImageMemoryBarrier barrier      = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    };
+
+    struct PendingBufferBarrier
+    {
+        VkPipelineStageFlags  srcStageMask = 0;
+        VkPipelineStageFlags  dstStageMask = 0;
+        VkBufferMemoryBarrier barrier      = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+    };
+
+    void AddImageBarrier(const PendingImageBarrier& pending);
+    void AddBufferBarrier(const PendingBufferBarrier& pending);
 
 private:
-    VkCommandBufferPtr mCommandBuffer;
+    VkCommandBufferPtr                 mCommandBuffer;
+    bool                               mDynamicRenderingActive = false; // BeginRendering() used vkCmdBeginRenderingKHR
+    std::vector<PendingImageBarrier>   mPendingImageBarriers;
+    std::vector<PendingBufferBarrier>  mPendingBufferBarriers;
+    std::vector<VkImageMemoryBarrier>  mImageBarriers;  // Scratch for FlushBarriers()
+    std::vector<VkBufferMemoryBarrier> mBufferBarriers; // Scratch for FlushBarriers()
+#if defined(VK_KHR_synchronization2)
+    std::vector<VkImageMemoryBarrier2KHR>  mImageBarriers2;
+    std::vector<VkBufferMemoryBarrier2KHR> mBufferBarriers2;
+#endif
 };
 
 // -------------------------------------------------------------------------------------------------
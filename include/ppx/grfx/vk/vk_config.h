@@ -120,6 +120,7 @@ using VkImageViewPtr           = VkHandlePtr<VkImageView>;
 using VkInstancePtr            = VkHandlePtr<VkInstance>;
 using VkPhysicalDevicePtr      = VkHandlePtr<VkPhysicalDevice>;
 using VkPipelinePtr            = VkHandlePtr<VkPipeline>;
+using VkPipelineCachePtr       = VkHandlePtr<VkPipelineCache>;
 using VkPipelineLayoutPtr      = VkHandlePtr<VkPipelineLayout>;
 using VkQueryPoolPtr           = VkHandlePtr<VkQueryPool>;
 using VkQueuePtr               = VkHandlePtr<VkQueue>;
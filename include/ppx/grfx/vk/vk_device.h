@@ -18,6 +18,9 @@
 #include "ppx/grfx/vk/vk_config.h"
 #include "ppx/grfx/grfx_device.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace ppx {
 namespace grfx {
 namespace vk {
@@ -32,11 +35,16 @@ public:
     VkDevicePtr     GetVkDevice() const { return mDevice; }
     VmaAllocatorPtr GetVmaAllocator() const { return mVmaAllocator; }
 
+    // Shared by all pipeline creation calls, internally synchronized
+    VkPipelineCachePtr GetVkPipelineCache() const { return mPipelineCache; }
+
     const VkPhysicalDeviceFeatures& GetDeviceFeatures() const { return mDeviceFeatures; }
 
     bool HasTimelineSemaphore() const { return mHasTimelineSemaphore; }
     bool HasExtendedDynamicState() const { return mHasExtendedDynamicState; }
     bool HasUnreistrictedDepthRange() const { return mHasUnrestrictedDepthRange; }
+    bool HasMemoryBudget() const { return mHasMemoryBudget; }
+    bool HasSynchronization2() const { return mHasSynchronization2; }
 
     virtual Result WaitIdle() override;
 
@@ -44,12 +52,66 @@ public:
     virtual bool DynamicRenderingSupported() const override;
     virtual bool IndependentBlendingSupported() const override;
     virtual bool FragmentStoresAndAtomicsSupported() const override;
+    virtual bool TimelineSemaphoreSupported() const override;
+    virtual bool SampledImageArrayDynamicIndexingSupported() const override;
+
+    virtual Result GetPipelineCacheData(std::vector<char>* pData) const override;
+    virtual Result LoadPipelineCacheData(const void* pData, size_t size) override;
 
     void ResetQueryPoolEXT(
         VkQueryPool queryPool,
         uint32_t    firstQuery,
         uint32_t    queryCount) const;
 
+    // Timeline semaphore host functions, core or KHR depending on API version
+    VkResult WaitSemaphores(
+        const VkSemaphoreWaitInfoKHR* pWaitInfo,
+        uint64_t                      timeout) const;
+    VkResult SignalSemaphore(const VkSemaphoreSignalInfoKHR* pSignalInfo) const;
+    VkResult GetSemaphoreCounterValue(
+        VkSemaphore semaphore,
+        uint64_t*   pValue) const;
+
+#if defined(VK_KHR_synchronization2)
+    // Only valid if HasSynchronization2() is true. Both go through the
+    // profiler wrappers like vk::CmdPipelineBarrier() and vk::QueueSubmit().
+    void CmdPipelineBarrier2(
+        VkCommandBuffer            commandBuffer,
+        const VkDependencyInfoKHR* pDependencyInfo) const;
+    VkResult QueueSubmit2(
+        VkQueue                 queue,
+        uint32_t                submitCount,
+        const VkSubmitInfo2KHR* pSubmits,
+        VkFence                 fence) const;
+#endif
+
+#if defined(VK_KHR_dynamic_rendering)
+    // Only valid if DynamicRenderingSupported() is true
+    void CmdBeginRendering(
+        VkCommandBuffer           commandBuffer,
+        const VkRenderingInfoKHR* pRenderingInfo) const;
+    void CmdEndRendering(VkCommandBuffer commandBuffer) const;
+#endif
+
+    // Render pass and framebuffer for CommandBuffer::BeginRendering() on
+    // devices without dynamic rendering. Render passes are cached by the
+    // formats and load/store ops of the views, framebuffers by the views and
+    // the render area. Internally synchronized.
+    Result GetCachedRenderPass(
+        const grfx::RenderingInfo* pRenderingInfo,
+        VkRenderPass*              pRenderPass,
+        VkFramebuffer*             pFramebuffer);
+
+    // Removes the cached framebuffers that use imageView from the cache,
+    // called when a render target or depth stencil view is destroyed. The
+    // framebuffers can still be used by frames in flight, so they're
+    // destroyed by RetireFramebuffers() or WaitIdle().
+    void EvictCachedFramebuffers(VkImageView imageView);
+
+    // Called after each present, destroys the evicted framebuffers that have
+    // been evicted for at least frameLatency presents.
+    void RetireFramebuffers(uint32_t frameLatency);
+
     uint32_t                GetGraphicsQueueFamilyIndex() const { return mGraphicsQueueFamilyIndex; }
     uint32_t                GetComputeQueueFamilyIndex() const { return mComputeQueueFamilyIndex; }
     uint32_t                GetTransferQueueFamilyIndex() const { return mTransferQueueFamilyIndex; }
@@ -87,6 +149,8 @@ protected:
     virtual Result CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+    virtual Result QueryMemoryStats(bool detailed, grfx::MemoryStats* pStats) const override;
+
 private:
     Result ConfigureQueueInfo(const grfx::DeviceCreateInfo* pCreateInfo, std::vector<float>& queuePriorities, std::vector<VkDeviceQueueCreateInfo>& queueCreateInfos);
     Result ConfigureExtensions(const grfx::DeviceCreateInfo* pCreateInfo);
@@ -94,19 +158,51 @@ private:
     Result CreateQueues(const grfx::DeviceCreateInfo* pCreateInfo);
 
 private:
-    std::vector<std::string> mFoundExtensions;
-    std::vector<std::string> mExtensions;
-    VkDevicePtr              mDevice;
-    VkPhysicalDeviceFeatures mDeviceFeatures = {};
-    VmaAllocatorPtr          mVmaAllocator;
-    bool                     mHasTimelineSemaphore      = false;
-    bool                     mHasExtendedDynamicState   = false;
-    bool                     mHasUnrestrictedDepthRange = false;
-    bool                     mHasDynamicRendering       = false;
-    PFN_vkResetQueryPoolEXT  mFnResetQueryPoolEXT       = nullptr;
-    uint32_t                 mGraphicsQueueFamilyIndex  = 0;
-    uint32_t                 mComputeQueueFamilyIndex   = 0;
-    uint32_t                 mTransferQueueFamilyIndex  = 0;
+    struct CachedFramebuffer
+    {
+        VkFramebuffer            framebuffer = VK_NULL_HANDLE;
+        std::vector<VkImageView> imageViews;
+    };
+
+    struct EvictedFramebuffer
+    {
+        VkFramebuffer framebuffer  = VK_NULL_HANDLE;
+        uint64_t      presentCount = 0; // Value of mPresentCount when evicted
+    };
+
+    std::vector<std::string>          mFoundExtensions;
+    std::vector<std::string>          mExtensions;
+    VkDevicePtr                       mDevice;
+    VkPhysicalDeviceFeatures          mDeviceFeatures = {};
+    VmaAllocatorPtr                   mVmaAllocator;
+    VkPipelineCachePtr                mPipelineCache;
+    bool                              mHasTimelineSemaphore       = false;
+    bool                              mHasExtendedDynamicState    = false;
+    bool                              mHasUnrestrictedDepthRange  = false;
+    bool                              mHasDynamicRendering        = false;
+    bool                              mHasMemoryBudget            = false;
+    bool                              mHasSynchronization2        = false;
+    PFN_vkResetQueryPoolEXT           mFnResetQueryPoolEXT        = nullptr;
+    PFN_vkWaitSemaphoresKHR           mFnWaitSemaphores           = nullptr;
+    PFN_vkSignalSemaphoreKHR          mFnSignalSemaphore          = nullptr;
+    PFN_vkGetSemaphoreCounterValueKHR mFnGetSemaphoreCounterValue = nullptr;
+#if defined(VK_KHR_synchronization2)
+    PFN_vkCmdPipelineBarrier2KHR mFnCmdPipelineBarrier2 = nullptr;
+    PFN_vkQueueSubmit2KHR        mFnQueueSubmit2        = nullptr;
+#endif
+#if defined(VK_KHR_dynamic_rendering)
+    PFN_vkCmdBeginRenderingKHR mFnCmdBeginRendering = nullptr;
+    PFN_vkCmdEndRenderingKHR   mFnCmdEndRendering   = nullptr;
+#endif
+    uint32_t                          mGraphicsQueueFamilyIndex   = 0;
+    uint32_t                          mComputeQueueFamilyIndex    = 0;
+    uint32_t                          mTransferQueueFamilyIndex   = 0;
+
+    std::mutex                                         mRenderPassCacheMutex;
+    std::unordered_map<std::string, VkRenderPass>      mRenderPassCache;
+    std::unordered_map<std::string, CachedFramebuffer> mFramebufferCache;
+    std::vector<EvictedFramebuffer>                    mEvictedFramebuffers;
+    uint64_t                                           mPresentCount = 0;
 };
 
 } // namespace vk
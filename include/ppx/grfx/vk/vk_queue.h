@@ -36,6 +36,7 @@ public:
     virtual Result WaitIdle() override;
 
     virtual Result Submit(const grfx::SubmitInfo* pSubmitInfo) override;
+    virtual Result Submit(uint32_t submitCount, const grfx::SubmitInfo* pSubmitInfos) override;
 
     virtual Result GetTimestampFrequency(uint64_t* pFrequency) const override;
 
@@ -54,9 +55,36 @@ protected:
     virtual Result CreateApiObjects(const grfx::internal::QueueCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+private:
+#if defined(VK_KHR_synchronization2)
+    // Submits with vkQueueSubmit2KHR, the counts are the totals of all
+    // submit infos.
+    Result Submit2(
+        uint32_t                submitCount,
+        const grfx::SubmitInfo* pSubmitInfos,
+        uint32_t                commandBufferCount,
+        uint32_t                waitSemaphoreCount,
+        uint32_t                signalSemaphoreCount);
+#endif
+
 private:
     VkQueuePtr       mQueue;
     VkCommandPoolPtr mTransientPool;
+
+    // Scratch storage for Submit(). It only grows, so once it has reached the
+    // largest submission size submitting no longer allocates.
+    std::vector<VkSubmitInfo>                     mSubmitInfos;
+    std::vector<VkTimelineSemaphoreSubmitInfoKHR> mTimelineInfos;
+    std::vector<VkCommandBuffer>                  mCommandBuffers;
+    std::vector<VkSemaphore>                      mWaitSemaphores;
+    std::vector<VkPipelineStageFlags>             mWaitDstStageMasks;
+    std::vector<VkSemaphore>                      mSignalSemaphores;
+#if defined(VK_KHR_synchronization2)
+    std::vector<VkSubmitInfo2KHR>             mSubmitInfos2;
+    std::vector<VkCommandBufferSubmitInfoKHR> mCommandBufferInfos;
+    std::vector<VkSemaphoreSubmitInfoKHR>     mWaitSemaphoreInfos;
+    std::vector<VkSemaphoreSubmitInfoKHR>     mSignalSemaphoreInfos;
+#endif
 };
 
 } // namespace vk
@@ -47,6 +47,26 @@ private:
 
 // -------------------------------------------------------------------------------------------------
 
+// Creates a render pass with one subpass that writes the views, with the
+// formats, sample counts and load/store ops of the views.
+Result CreateRenderPassForViews(
+    VkDevice                             device,
+    uint32_t                             renderTargetCount,
+    const grfx::RenderTargetView* const* ppRenderTargetViews,
+    const grfx::DepthStencilView*        pDepthStencilView,
+    grfx::ResourceState                  depthStencilState,
+    VkRenderPass*                        pRenderPass);
+
+Result CreateFramebufferForViews(
+    VkDevice                             device,
+    VkRenderPass                         renderPass,
+    uint32_t                             width,
+    uint32_t                             height,
+    uint32_t                             renderTargetCount,
+    const grfx::RenderTargetView* const* ppRenderTargetViews,
+    const grfx::DepthStencilView*        pDepthStencilView,
+    VkFramebuffer*                       pFramebuffer);
+
 VkResult CreateTransientRenderPass(
     VkDevice              device,
     uint32_t              renderTargetCount,
@@ -63,6 +63,10 @@ protected:
     virtual Result CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo) override;
     virtual void   DestroyApiObjects() override;
 
+    virtual Result   TimelineWait(uint64_t value, uint64_t timeout) const override;
+    virtual Result   TimelineSignal(uint64_t value) const override;
+    virtual uint64_t TimelineCounterValue() const override;
+
 private:
     VkSemaphorePtr mSemaphore;
 };
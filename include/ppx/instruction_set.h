@@ -0,0 +1,44 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_instruction_set_h
+#define ppx_instruction_set_h
+
+//
+// Instruction sets of the library's SIMD code paths. Each module with SIMD
+// kernels starts with GetBestInstructionSet() and can be overridden for
+// tests and benchmarks.
+//
+namespace ppx {
+
+enum InstructionSet
+{
+    INSTRUCTION_SET_SCALAR = 0,
+    INSTRUCTION_SET_SSE2   = 1,
+    INSTRUCTION_SET_AVX2   = 2,
+    INSTRUCTION_SET_NEON   = 3,
+};
+
+const char* ToString(InstructionSet value);
+
+//! Returns true if the build targets \b value's architecture and the host
+//! CPU can run it.
+bool IsSupported(InstructionSet value);
+
+//! Returns the widest instruction set supported by the host CPU.
+InstructionSet GetBestInstructionSet();
+
+} // namespace ppx
+
+#endif // ppx_instruction_set_h
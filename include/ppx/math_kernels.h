@@ -0,0 +1,76 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_math_kernels_h
+#define ppx_math_kernels_h
+
+#include "ppx/bounding_volume.h"
+#include "ppx/instruction_set.h"
+#include "ppx/math_config.h"
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Batch versions of common float3 and float4x4 operations, for work that
+// would otherwise go through glm one element at a time: building instance
+// matrices, transforming vertices or bounding boxes.
+//
+// Each kernel has a scalar reference implementation and SSE2/AVX2 (x86) or
+// NEON (ARM) variants. The variant is picked once at runtime from the CPU
+// features reported by ppx::Platform (cpu_features). Variants compute the
+// same operations in the same order, but may differ from the scalar code
+// in the last bit when the compiler contracts the scalar code to FMA.
+//
+// Points are transformed as float4(p, 1) and the w component of the result
+// is dropped, there is no perspective divide. Destination arrays may be the
+// same as a source array, but must not partially overlap one.
+//
+namespace ppx {
+namespace math_kernels {
+
+//! Returns the instruction set currently used for dispatch, initially
+//! ppx::GetBestInstructionSet().
+InstructionSet GetInstructionSet();
+
+//! Overrides kernel dispatch, mostly useful for tests and benchmarks.
+//! Returns false and leaves dispatch unchanged if \b value is not supported.
+//! Not thread safe with respect to kernels running concurrently.
+bool SetInstructionSet(InstructionSet value);
+
+//! pDst[i] = matrix * pSrc[i]
+void TransformPoints(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count);
+
+//! pDst[i] = a * pB[i], e.g. view projection * model matrices.
+void MultiplyMatrices(const float4x4& a, const float4x4* pB, float4x4* pDst, size_t count);
+
+//! pDst[i] = pA[i] * pB[i]
+void MultiplyMatrices(const float4x4* pA, const float4x4* pB, float4x4* pDst, size_t count);
+
+//! pDst[i] = translate(pTranslations[i]) * mat4_cast(pRotations[i]) * scale(pScales[i])
+//!
+//! Rotations are expected to be unit quaternions.
+void ComposeTRS(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count);
+
+//! Writes the axis aligned bounds of each box of \b pSrc transformed by
+//! \b matrix, which are the bounds of the 8 transformed corners.
+void TransformAABBs(const float4x4& matrix, const AABB* pSrc, AABB* pDst, size_t count);
+
+//! Same as above, with box \b i transformed by pMatrices[i].
+void TransformAABBs(const float4x4* pMatrices, const AABB* pSrc, AABB* pDst, size_t count);
+
+} // namespace math_kernels
+} // namespace ppx
+
+#endif // ppx_math_kernels_h
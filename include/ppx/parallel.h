@@ -0,0 +1,121 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_parallel_h
+#define ppx_parallel_h
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ppx {
+
+//! Returns the number of threads ParallelFor() uses for a \b threadCount of 0.
+inline uint32_t GetHardwareThreadCount()
+{
+    return std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+}
+
+//! Calls fn(i) for every i in [0, count) on up to \b threadCount threads,
+//! including the calling one. A \b threadCount of 0 uses all hardware
+//! threads. Indices are handed out in increasing order but may complete in
+//! any order; the call returns once all of them are done.
+template <typename Fn>
+void ParallelFor(uint32_t count, uint32_t threadCount, const Fn& fn)
+{
+    if (threadCount == 0) {
+        threadCount = GetHardwareThreadCount();
+    }
+    threadCount = std::min(threadCount, count);
+
+    std::atomic<uint32_t> next(0);
+
+    auto worker = [&]() {
+        for (uint32_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+//! @class TaskQueue
+//!
+//! Runs tasks on a fixed set of worker threads, in submission order. Unlike
+//! ParallelFor(), the threads are kept between calls and the caller doesn't
+//! wait, which suits work that is submitted over time and collected later,
+//! e.g. pipeline compilation.
+//!
+class TaskQueue
+{
+public:
+    //! A \b threadCount of 0 uses all hardware threads.
+    explicit TaskQueue(uint32_t threadCount = 0);
+
+    //! Runs the tasks still queued, then joins the threads.
+    ~TaskQueue();
+
+    TaskQueue(const TaskQueue&)            = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(mThreads.size()); }
+
+    //! Queues fn() and returns a future for its result. Exceptions thrown by
+    //! fn() are stored in the future.
+    template <typename Fn>
+    auto Submit(Fn&& fn) -> std::future<decltype(fn())>
+    {
+        using ResultT = decltype(fn());
+
+        auto                 pTask  = std::make_shared<std::packaged_task<ResultT()>>(std::forward<Fn>(fn));
+        std::future<ResultT> future = pTask->get_future();
+        Push([pTask]() { (*pTask)(); });
+        return future;
+    }
+
+    //! Waits until every task submitted so far has finished.
+    void WaitIdle();
+
+private:
+    void Push(std::function<void()>&& task);
+    void WorkerMain();
+
+private:
+    std::vector<std::thread>          mThreads;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex                        mMutex;
+    std::condition_variable           mTaskAvailable;
+    std::condition_variable           mIdle;
+    uint32_t                          mRunningCount = 0;
+    bool                              mStopping     = false;
+};
+
+} // namespace ppx
+
+#endif // ppx_parallel_h
@@ -15,9 +15,13 @@
 #ifndef ppx_random_h
 #define ppx_random_h
 
+#include "ppx/instruction_set.h"
 #include "ppx/math_config.h"
 #include "pcg32.h"
 
+#include <cstddef>
+#include <cstdint>
+
 namespace ppx {
 
 class Random
@@ -30,14 +34,14 @@ public:
 
     Random(uint64_t initialState, uint64_t initialSequence)
     {
-        Seed(initialSequence, initialSequence);
+        Seed(initialState, initialSequence);
     }
 
     ~Random() {}
 
     void Seed(uint64_t initialState, uint64_t initialSequence)
     {
-        mRng.seed(initialSequence, initialSequence);
+        mRng.seed(initialState, initialSequence);
     }
 
     uint32_t UInt32()
@@ -116,6 +120,85 @@ private:
     pcg32 mRng;
 };
 
+//! @class RandomStream
+//!
+//! Counter based generator (Philox4x32-10) for filling large arrays and for
+//! generating from several threads. Value \b i of a stream is a function of
+//! the seed, the stream id and \b i only, so:
+//!   - Fill*() functions generate 4 or 8 blocks of values at once with
+//!     SSE2, AVX2 or NEON, and return the same values as repeated single
+//!     value calls.
+//!   - Discard() skips ahead in constant time.
+//!   - Split() returns an independent stream with the same seed. Giving
+//!     each job its own stream id, e.g. its index, makes the results
+//!     independent of which thread runs it.
+//!
+//! Floats are uniform in [0, 1) with 24 bits of precision. FloatN values
+//! use N consecutive values of the stream, x first.
+//!
+class RandomStream
+{
+public:
+    RandomStream() {}
+    RandomStream(uint64_t seed, uint64_t stream = 0);
+    ~RandomStream() {}
+
+    //! Restarts the sequence of \b stream for \b seed.
+    void Seed(uint64_t seed, uint64_t stream = 0);
+
+    //! Returns stream \b stream of the same seed, at its start.
+    RandomStream Split(uint64_t stream) const;
+
+    //! Skips \b count values.
+    void Discard(uint64_t count);
+
+    uint64_t GetSeed() const { return mSeed; }
+    uint64_t GetStream() const { return mStream; }
+
+    //! Number of values generated or discarded since Seed().
+    uint64_t GetPosition() const { return mPosition; }
+
+    //! Overrides the instruction set used by Fill*(), mostly useful for
+    //! tests and benchmarks. Returns false and leaves it unchanged if
+    //! \b value is not supported.
+    bool           SetInstructionSet(InstructionSet value);
+    InstructionSet GetInstructionSet() const { return mInstructionSet; }
+
+    uint32_t UInt32();
+    float    Float();
+    float    Float(float a, float b);
+    float2   Float2();
+    float3   Float3();
+    float4   Float4();
+
+    void FillUInt32(uint32_t* pValues, size_t count);
+    void FillFloat(float* pValues, size_t count);
+    void FillFloat(float* pValues, size_t count, float a, float b);
+    void FillFloat2(float2* pValues, size_t count);
+    void FillFloat2(float2* pValues, size_t count, const float2& a, const float2& b);
+    void FillFloat3(float3* pValues, size_t count);
+    void FillFloat3(float3* pValues, size_t count, const float3& a, const float3& b);
+    void FillFloat4(float4* pValues, size_t count);
+    void FillFloat4(float4* pValues, size_t count, const float4& a, const float4& b);
+
+private:
+    // Floats are a + (b - a) * u, with a and b repeating every
+    // kRangePeriod values: that's a whole number of float2, float3 and
+    // float4, and of 4 and 8 wide registers.
+    static const uint32_t kRangePeriod = 24;
+
+    void GenerateBlocks(uint64_t firstBlock, size_t blockCount, uint32_t* pValues) const;
+    void FillFloats(float* pValues, size_t count, uint32_t componentCount, const float* pA, const float* pB);
+
+private:
+    uint64_t       mSeed           = 0;
+    uint64_t       mStream         = 0;
+    uint64_t       mPosition       = 0;
+    InstructionSet mInstructionSet = GetBestInstructionSet();
+    uint64_t       mBufferBlock    = UINT64_MAX; // Block held in mBuffer
+    uint32_t       mBuffer[4]      = {};
+};
+
 } // namespace ppx
 
 #endif // ppx_random_h
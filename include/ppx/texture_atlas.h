@@ -0,0 +1,117 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_texture_atlas_h
+#define ppx_texture_atlas_h
+
+#include "ppx/bitmap.h"
+#include "ppx/math_config.h"
+
+#include <vector>
+
+namespace ppx {
+
+//! @struct TextureAtlasCreateInfo
+//!
+//! \b padding is the number of gutter pixels around each entry, filled by
+//! replicating the entry's edge pixels so that bilinear filtering never picks up
+//! a neighbour. \b alignment rounds every cell (entry plus gutter) to a multiple
+//! of that many pixels. To keep entries apart across \b N mip levels, set both
+//! to TextureAtlas::CalculateMipPadding(N).
+//!
+//! If an entry doesn't fit into the existing layers a new layer is started, up
+//! to \b maxLayerCount layers. Layers are meant to be uploaded as the array
+//! layers of a single image.
+//!
+struct TextureAtlasCreateInfo
+{
+    uint32_t       width         = 1024;
+    uint32_t       height        = 1024;
+    Bitmap::Format format        = Bitmap::FORMAT_RGBA_UINT8;
+    uint32_t       padding       = 1;
+    uint32_t       alignment     = 1;
+    uint32_t       maxLayerCount = 1;
+};
+
+//! @class TextureAtlas
+//!
+//! Packs many small bitmaps into one bitmap, or a few bitmaps that share a
+//! texture array, with a skyline bottom-left packer. Usage:
+//!
+//!   TextureAtlas atlas;
+//!   TextureAtlas::Create(createInfo, &atlas);
+//!   atlas.AddBitmap(&bitmap, &index);  // for each bitmap
+//!   atlas.Build();
+//!   atlas.GetEntry(index).uvTransform; // uv' = uv * xy + zw
+//!
+//! Bitmaps are copied and converted to the atlas format when added.
+//! Entries are placed in decreasing height order, but indices returned by
+//! AddBitmap() stay valid.
+//!
+class TextureAtlas
+{
+public:
+    struct Entry
+    {
+        uint32_t layer       = 0;
+        uint32_t x           = 0; // Position of the first pixel, excluding padding.
+        uint32_t y           = 0;
+        uint32_t width       = 0;
+        uint32_t height      = 0;
+        float4   uvTransform = float4(1, 1, 0, 0); // xy: scale, zw: offset
+    };
+
+    TextureAtlas() {}
+    ~TextureAtlas() {}
+
+    static Result Create(const TextureAtlasCreateInfo& createInfo, TextureAtlas* pAtlas);
+
+    //! Queues a copy of \b pBitmap for packing. Must be called before Build().
+    //! Returns ERROR_BITMAP_BAD_COPY_SOURCE for an empty bitmap and
+    //! ERROR_LIMIT_EXCEEDED if the padded bitmap is larger than a layer.
+    Result AddBitmap(const Bitmap* pBitmap, uint32_t* pIndex);
+
+    //! Packs all queued bitmaps and fills the layers. Returns ERROR_LIMIT_EXCEEDED
+    //! if they don't fit into maxLayerCount layers.
+    Result Build();
+
+    bool          IsBuilt() const { return mBuilt; }
+    uint32_t      GetEntryCount() const { return CountU32(mEntries); }
+    const Entry&  GetEntry(uint32_t index) const { return mEntries[index]; }
+    uint32_t      GetLayerCount() const { return CountU32(mLayers); }
+    const Bitmap* GetLayer(uint32_t layer) const { return &mLayers[layer]; }
+
+    //! Returns the fraction of layer pixels covered by entries, padding excluded.
+    float GetOccupancy() const;
+
+    const TextureAtlasCreateInfo& GetCreateInfo() const { return mCreateInfo; }
+
+    //! Returns the padding/alignment that keeps entries from bleeding into
+    //! each other down to the last of \b mipLevelCount levels.
+    static uint32_t CalculateMipPadding(uint32_t mipLevelCount);
+
+private:
+    void CopyEntry(const Bitmap& src, const Entry& entry);
+
+private:
+    TextureAtlasCreateInfo mCreateInfo = {};
+    std::vector<Bitmap>    mSources;
+    std::vector<Entry>     mEntries;
+    std::vector<Bitmap>    mLayers;
+    bool                   mBuilt = false;
+};
+
+} // namespace ppx
+
+#endif // ppx_texture_atlas_h
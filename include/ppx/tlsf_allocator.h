@@ -0,0 +1,109 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_tlsf_allocator_h
+#define ppx_tlsf_allocator_h
+
+#include "ppx/config.h"
+
+namespace ppx {
+
+//! @class TLSFAllocator
+//!
+//! Two-level segregated fit allocator for ranges of an external resource,
+//! e.g. a GPU buffer. It only hands out offsets, it never touches the memory
+//! it manages. Allocation and free are O(1): free ranges are binned by size
+//! into power of two classes (first level), each split into linear
+//! subclasses (second level), and a bitmap per level finds the smallest
+//! non-empty bin without searching. Adjacent free ranges are merged on free.
+//!
+//! Allocate() rounds the size up to the next subclass so any range in the
+//! bin it finds is large enough. If that fails it falls back to searching
+//! the list of the unrounded size's bin, so a request never fails while a
+//! large enough range is free.
+//!
+//! Every offset and size is a multiple of the \b granularity passed to
+//! Create(), which must be a power of two.
+//!
+class TLSFAllocator
+{
+public:
+    static constexpr uint32_t kInvalidHandle = UINT32_MAX;
+
+    struct Allocation
+    {
+        uint64_t offset = 0;
+        uint64_t size   = 0;
+        uint32_t handle = kInvalidHandle;
+    };
+
+    TLSFAllocator() {}
+    ~TLSFAllocator() {}
+
+    static Result Create(uint64_t size, uint64_t granularity, TLSFAllocator* pAllocator);
+
+    //! Returns ERROR_OUT_OF_MEMORY if no free range is large enough.
+    Result Allocate(uint64_t size, Allocation* pAllocation);
+    void   Free(uint32_t handle);
+
+    uint64_t GetSize() const { return mSize; }
+    uint64_t GetUsedSize() const { return mUsedSize; }
+    uint64_t GetGranularity() const { return mGranularity; }
+    uint32_t GetAllocationCount() const { return mAllocationCount; }
+    bool     IsEmpty() const { return mAllocationCount == 0; }
+
+    //! Returns the size of the largest free range.
+    uint64_t GetLargestFreeRange() const;
+
+private:
+    static constexpr uint32_t kSLLog2  = 4;
+    static constexpr uint32_t kSLCount = 1u << kSLLog2;
+    static constexpr uint32_t kFLCount = 64 - kSLLog2 + 1;
+
+    struct Node
+    {
+        uint64_t offset   = 0;
+        uint64_t size     = 0;
+        uint32_t prevPhys = kInvalidHandle;
+        uint32_t nextPhys = kInvalidHandle;
+        uint32_t prevFree = kInvalidHandle;
+        uint32_t nextFree = kInvalidHandle;
+        bool     free     = false;
+    };
+
+    static void Mapping(uint64_t size, uint32_t* pFL, uint32_t* pSL);
+
+    uint32_t NewNode();
+    void     ReleaseNode(uint32_t handle);
+    void     InsertFree(uint32_t handle);
+    void     RemoveFree(uint32_t handle);
+    uint32_t FindFree(uint64_t size) const;
+
+private:
+    uint64_t              mSize            = 0;
+    uint64_t              mGranularity     = 1;
+    uint64_t              mUsedSize        = 0;
+    uint32_t              mAllocationCount = 0;
+    std::vector<Node>     mNodes;
+    std::vector<uint32_t> mUnusedNodes;
+
+    // Head of the free list of each bin, and one bit per non-empty bin
+    uint64_t mFLBitmap                      = 0;
+    uint32_t mSLBitmaps[kFLCount]           = {};
+    uint32_t mFreeHeads[kFLCount][kSLCount] = {};
+};
+
+} // namespace ppx
+
+#endif // ppx_tlsf_allocator_h
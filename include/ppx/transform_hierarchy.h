@@ -0,0 +1,134 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ppx_transform_hierarchy_h
+#define ppx_transform_hierarchy_h
+
+#include "ppx/config.h"
+#include "ppx/math_config.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ppx {
+
+//! @struct TransformHierarchyStats
+//!
+//! Filled by TransformHierarchy::Update().
+//!
+struct TransformHierarchyStats
+{
+    uint32_t nodeCount    = 0;
+    uint32_t levelCount   = 0;
+    uint32_t updatedCount = 0;
+    uint32_t threadCount  = 0;
+    double   cpuTimeMs    = 0;
+};
+
+//! @class TransformHierarchy
+//!
+//! Scene graph transforms for many nodes. Unlike ppx::Transform, which is
+//! a standalone object, nodes have a parent and their world matrix is
+//! parent world * local, with local = translation * rotation * scale.
+//!
+//! Local translation, rotation (a quaternion) and scale are stored as
+//! structure of arrays. Nodes are kept sorted by depth in the hierarchy,
+//! so each level is a contiguous range whose parents are all in the levels
+//! before it. Update() walks the levels in order: local matrices are
+//! composed 4 nodes at a time with SSE2 or NEON, multiplied by their
+//! parent's world matrix, and large levels are split across threads.
+//!
+//! Setters mark a node dirty, and Update() only recomputes dirty nodes and
+//! their descendants. Nodes are identified by the id AddNode() returns,
+//! which doesn't change when nodes are reordered.
+//!
+class TransformHierarchy
+{
+public:
+    static constexpr uint32_t kInvalidNode = UINT32_MAX;
+
+    TransformHierarchy() {}
+    ~TransformHierarchy() {}
+
+    //! A \b threadCount of 0 uses all hardware threads, 1 updates on the
+    //! calling thread only. Threads are started for each level that is
+    //! large enough to be split.
+    void     SetThreadCount(uint32_t threadCount) { mThreadCount = threadCount; }
+    uint32_t GetThreadCount() const { return mThreadCount; }
+
+    //! Adds a node with an identity local transform, under \b parent or as
+    //! a root. Returns kInvalidNode if \b parent doesn't exist.
+    uint32_t AddNode(uint32_t parent = kInvalidNode);
+
+    //! Moves \b node under \b parent, or makes it a root for kInvalidNode.
+    //! Fails with ppx::ERROR_FAILED if \b parent is \b node or one of its
+    //! descendants.
+    Result   SetParent(uint32_t node, uint32_t parent);
+    uint32_t GetParent(uint32_t node) const { return mParents[node]; }
+
+    void     Reserve(uint32_t count);
+    void     Clear();
+    uint32_t GetNodeCount() const { return CountU32(mParents); }
+
+    void SetTranslation(uint32_t node, const float3& translation);
+    void SetRotation(uint32_t node, const quat& rotation);
+    void SetScale(uint32_t node, const float3& scale);
+    void SetTRS(uint32_t node, const float3& translation, const quat& rotation, const float3& scale);
+
+    float3 GetTranslation(uint32_t node) const;
+    quat   GetRotation(uint32_t node) const;
+    float3 GetScale(uint32_t node) const;
+
+    //! Matrices are only valid after Update().
+    const float4x4& GetLocalMatrix(uint32_t node) const { return mLocalMatrices[mSlots[node]]; }
+    const float4x4& GetWorldMatrix(uint32_t node) const { return mWorldMatrices[mSlots[node]]; }
+
+    //! Recomputes the local and world matrices of dirty nodes and their
+    //! descendants.
+    void Update();
+
+    //! Stats of the last Update() call.
+    const TransformHierarchyStats& GetStats() const { return mStats; }
+
+private:
+    void SortByLevel();
+    void UpdateRange(uint32_t begin, uint32_t end);
+
+private:
+    uint32_t                mThreadCount   = 1;
+    bool                    mOrderDirty    = false;
+    std::vector<uint32_t>   mParents;       // By node id
+    std::vector<uint32_t>   mSlots;         // Node id to slot
+    std::vector<uint32_t>   mNodes;         // Slot to node id
+    std::vector<uint32_t>   mParentSlots;   // By slot, kInvalidNode for roots
+    std::vector<uint32_t>   mLevelOffsets;  // First slot of each level, then the slot count
+    std::vector<float>      mTranslationX;  // Everything below is by slot
+    std::vector<float>      mTranslationY;
+    std::vector<float>      mTranslationZ;
+    std::vector<float>      mRotationX;
+    std::vector<float>      mRotationY;
+    std::vector<float>      mRotationZ;
+    std::vector<float>      mRotationW;
+    std::vector<float>      mScaleX;
+    std::vector<float>      mScaleY;
+    std::vector<float>      mScaleZ;
+    std::vector<uint8_t>    mDirty;
+    std::vector<float4x4>   mLocalMatrices;
+    std::vector<float4x4>   mWorldMatrices;
+    TransformHierarchyStats mStats;
+};
+
+} // namespace ppx
+
+#endif // ppx_transform_hierarchy_h
@@ -52,10 +52,11 @@ private:
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
 {
-    settings.appName          = "01_triangle";
-    settings.enableImGui      = true;
-    settings.grfx.api         = kApi;
-    settings.grfx.enableDebug = false;
+    settings.appName                = "01_triangle";
+    settings.enableImGui            = true;
+    settings.grfx.api               = kApi;
+    settings.grfx.enableDebug       = false;
+    settings.grfx.enableGpuProfiler = true;
 }
 
 void ProjApp::Setup()
@@ -92,6 +93,7 @@ void ProjApp::Setup()
         gpCreateInfo.blendModes[0]                      = grfx::BLEND_MODE_NONE;
         gpCreateInfo.outputState.renderTargetCount      = 1;
         gpCreateInfo.outputState.renderTargetFormats[0] = GetSwapchain()->GetColorFormat();
+        gpCreateInfo.outputState.dynamicRendering       = true;
         gpCreateInfo.pPipelineInterface                 = mPipelineInterface;
         PPX_CHECKED_CALL(GetDevice()->CreateGraphicsPipeline(&gpCreateInfo, &mPipeline));
     }
@@ -150,7 +152,8 @@ void ProjApp::Render()
 {
     PerFrame& frame = mPerFrame[0];
 
-    grfx::SwapchainPtr swapchain = GetSwapchain();
+    grfx::SwapchainPtr   swapchain = GetSwapchain();
+    grfx::GpuProfilerPtr profiler  = GetGpuProfiler();
 
     uint32_t imageIndex = UINT32_MAX;
     PPX_CHECKED_CALL(swapchain->AcquireNextImage(UINT64_MAX, frame.imageAcquiredSemaphore, frame.imageAcquiredFence, &imageIndex));
@@ -164,24 +167,53 @@ void ProjApp::Render()
     // Build command buffer
     PPX_CHECKED_CALL(frame.cmd->Begin());
     {
-        grfx::RenderPassPtr renderPass = swapchain->GetRenderPass(imageIndex);
+        grfx::RenderTargetViewPtr renderTargetView = swapchain->GetRenderTargetView(imageIndex);
+        PPX_ASSERT_MSG(!renderTargetView.IsNull(), "render target view object is null");
+
+        // The triangle is drawn without a render pass object
+        grfx::RenderingInfo renderingInfo   = {};
+        renderingInfo.renderArea            = mScissorRect;
+        renderingInfo.renderTargetCount     = 1;
+        renderingInfo.pRenderTargetViews[0] = renderTargetView;
+        renderingInfo.RTVClearValues[0]     = {{1, 0, 0, 1}};
+
+        frame.cmd->TransitionImageLayout(swapchain->GetColorImage(imageIndex), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_RENDER_TARGET);
+        frame.cmd->BeginRendering(&renderingInfo);
+        {
+            // Scopes with pipeline statistics begin and end inside the same
+            // render pass instance.
+            if (profiler) {
+                profiler->PushScope(frame.cmd, "Triangle");
+            }
+
+            frame.cmd->SetScissors(1, &mScissorRect);
+            frame.cmd->SetViewports(1, &mViewport);
+            frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 0, nullptr);
+            frame.cmd->BindGraphicsPipeline(mPipeline);
+            frame.cmd->BindVertexBuffers(1, &mVertexBuffer, &mVertexBinding.GetStride());
+            frame.cmd->Draw(3, 1, 0, 0);
+
+            if (profiler) {
+                profiler->PopScope(frame.cmd);
+            }
+        }
+        frame.cmd->EndRendering();
+
+        // ImGui's pipeline is created for the swapchain render passes, so it's
+        // drawn over the triangle in a render pass that loads the image.
+        grfx::RenderPassPtr renderPass = swapchain->GetRenderPass(imageIndex, grfx::ATTACHMENT_LOAD_OP_LOAD);
         PPX_ASSERT_MSG(!renderPass.IsNull(), "render pass object is null");
 
         grfx::RenderPassBeginInfo beginInfo = {};
         beginInfo.pRenderPass               = renderPass;
         beginInfo.renderArea                = renderPass->GetRenderArea();
         beginInfo.RTVClearCount             = 1;
-        beginInfo.RTVClearValues[0]         = {{1, 0, 0, 1}};
 
-        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_RENDER_TARGET);
         frame.cmd->BeginRenderPass(&beginInfo);
         {
-            frame.cmd->SetScissors(1, &mScissorRect);
-            frame.cmd->SetViewports(1, &mViewport);
-            frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 0, nullptr);
-            frame.cmd->BindGraphicsPipeline(mPipeline);
-            frame.cmd->BindVertexBuffers(1, &mVertexBuffer, &mVertexBinding.GetStride());
-            frame.cmd->Draw(3, 1, 0, 0);
+            if (profiler) {
+                profiler->PushScope(frame.cmd, "ImGui");
+            }
 
             // Draw ImGui
             DrawDebugInfo();
@@ -189,9 +221,18 @@ void ProjApp::Render()
             DrawProfilerGrfxApiFunctions();
 #endif // defined(PPX_ENABLE_PROFILE_GRFX_API_FUNCTIONS)
             DrawImGui(frame.cmd);
+
+            if (profiler) {
+                profiler->PopScope(frame.cmd);
+            }
         }
         frame.cmd->EndRenderPass();
-        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+        frame.cmd->TransitionImageLayout(swapchain->GetColorImage(imageIndex), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+
+        // Copies the frame's queries for readback, outside of any render pass
+        if (profiler) {
+            profiler->EndFrame(frame.cmd);
+        }
     }
     PPX_CHECKED_CALL(frame.cmd->End());
 
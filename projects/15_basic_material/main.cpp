@@ -106,18 +106,18 @@ private:
     std::vector<grfx::MeshPtr> mMeshes;
     grfx::MeshPtr              mEnvDrawMesh;
 
+    // Per-frame constants are bump allocated and released together once
+    // the frame's work is done
+    grfx::BufferArenaPtr mConstantsArena;
+
     // Descriptor Set 0 - Scene Data
     grfx::DescriptorSetLayoutPtr mSceneDataLayout;
     grfx::DescriptorSetPtr       mSceneDataSet;
-    grfx::BufferPtr              mCpuSceneConstants;
-    grfx::BufferPtr              mGpuSceneConstants;
     grfx::BufferPtr              mCpuLightConstants;
     grfx::BufferPtr              mGpuLightConstants;
 
     // Descriptor Set 1 - MaterialData Resources
     grfx::DescriptorSetLayoutPtr mMaterialResourcesLayout;
-    grfx::BufferPtr              mCpuEnvDrawConstants;
-    grfx::BufferPtr              mGpuEnvDrawConstants;
 
     struct MaterialResources
     {
@@ -150,14 +150,10 @@ private:
     // Descriptor Set 2 - MaterialData Data
     grfx::DescriptorSetLayoutPtr mMaterialDataLayout;
     grfx::DescriptorSetPtr       mMaterialDataSet;
-    grfx::BufferPtr              mCpuMaterialConstants;
-    grfx::BufferPtr              mGpuMaterialConstants;
 
     // Descriptor Set 3 - Model Data
     grfx::DescriptorSetLayoutPtr mModelDataLayout;
     grfx::DescriptorSetPtr       mModelDataSet;
-    grfx::BufferPtr              mCpuModelConstants;
-    grfx::BufferPtr              mGpuModelConstants;
 
     // Descriptor Set 4 - Env Draw Data
     grfx::DescriptorSetLayoutPtr mEnvDrawLayout;
@@ -294,7 +290,10 @@ private:
         MaterialResources&           materialResources);
     void SetupMaterials();
     void SetupIBL();
-    void DrawGui();
+    // Allocates this frame's constants for a uniform buffer binding, points
+    // the binding at them and returns their mapped address
+    void* AllocateConstants(uint64_t size, grfx::DescriptorSet* pSet, uint32_t binding);
+    void  DrawGui();
 };
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
@@ -607,6 +606,23 @@ void ProjApp::SetupIBL()
     }
 }
 
+void* ProjApp::AllocateConstants(uint64_t size, grfx::DescriptorSet* pSet, uint32_t binding)
+{
+    grfx::BufferRange range = {};
+    PPX_CHECKED_CALL(mConstantsArena->Allocate(size, &range));
+
+    grfx::WriteDescriptor write = {};
+    write.binding               = binding;
+    write.arrayIndex            = 0;
+    write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.bufferOffset          = range.offset;
+    write.bufferRange           = range.size;
+    write.pBuffer               = range.pBuffer;
+    PPX_CHECKED_CALL(pSet->UpdateDescriptors(1, &write));
+
+    return range.pMappedAddress;
+}
+
 void ProjApp::Setup()
 {
     PPX_CHECKED_CALL(grfx_util::CreateTexture1x1<uint8_t>(GetDevice()->GetGraphicsQueue(), {0, 0, 0, 0}, &m1x1BlackTexture));
@@ -728,6 +744,16 @@ void ProjApp::Setup()
     mShaderIndex = cl_options.GetExtraOptionValueOrDefault<uint32_t>("shader-index", mShaderIndex);
     PPX_ASSERT_MSG(mShaderIndex < mShaderNames.size(), "Shader index out-of-range.");
 
+    // Constants arena, one block holds a frame's worth of constants
+    {
+        grfx::BufferArenaCreateInfo createInfo   = {};
+        createInfo.strategy                      = grfx::BUFFER_ARENA_STRATEGY_LINEAR;
+        createInfo.blockSize                     = 16 * PPX_MINIMUM_CONSTANT_BUFFER_SIZE;
+        createInfo.usageFlags.bits.uniformBuffer = true;
+        createInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+        PPX_CHECKED_CALL(GetDevice()->CreateBufferArena(&createInfo, &mConstantsArena));
+    }
+
     // Scene data
     {
         grfx::DescriptorSetLayoutCreateInfo createInfo = {};
@@ -737,20 +763,8 @@ void ProjApp::Setup()
 
         PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mSceneDataLayout, &mSceneDataSet));
 
-        // Scene constants
-        grfx::BufferCreateInfo bufferCreateInfo      = {};
-        bufferCreateInfo.size                        = PPX_MINIMUM_CONSTANT_BUFFER_SIZE;
-        bufferCreateInfo.usageFlags.bits.transferSrc = true;
-        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mCpuSceneConstants));
-
-        bufferCreateInfo.usageFlags.bits.transferDst   = true;
-        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
-        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_GPU_ONLY;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mGpuSceneConstants));
-
         // HlslLight constants
-        bufferCreateInfo                             = {};
+        grfx::BufferCreateInfo bufferCreateInfo      = {};
         bufferCreateInfo.size                        = PPX_MINIMUM_STRUCTURED_BUFFER_SIZE;
         bufferCreateInfo.usageFlags.bits.transferSrc = true;
         bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
@@ -762,16 +776,7 @@ void ProjApp::Setup()
         bufferCreateInfo.memoryUsage                        = grfx::MEMORY_USAGE_GPU_ONLY;
         PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mGpuLightConstants));
 
-        grfx::WriteDescriptor write = {};
-        write.binding               = SCENE_CONSTANTS_REGISTER;
-        write.arrayIndex            = 0;
-        write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write.bufferOffset          = 0;
-        write.bufferRange           = PPX_WHOLE_SIZE;
-        write.pBuffer               = mGpuSceneConstants;
-        PPX_CHECKED_CALL(mSceneDataSet->UpdateDescriptors(1, &write));
-
-        write                        = {};
+        grfx::WriteDescriptor write  = {};
         write.binding                = LIGHT_DATA_REGISTER;
         write.arrayIndex             = 0;
         write.type                   = grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER;
@@ -795,38 +800,20 @@ void ProjApp::Setup()
 
         PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mEnvDrawLayout, &mEnvDrawSet));
 
-        // Scene constants
-        grfx::BufferCreateInfo bufferCreateInfo      = {};
-        bufferCreateInfo.size                        = PPX_MINIMUM_CONSTANT_BUFFER_SIZE;
-        bufferCreateInfo.usageFlags.bits.transferSrc = true;
-        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mCpuEnvDrawConstants));
-
-        bufferCreateInfo.usageFlags.bits.transferDst   = true;
-        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
-        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_GPU_ONLY;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mGpuEnvDrawConstants));
-
-        grfx::WriteDescriptor writes[3] = {};
-        // Constants
-        writes[0].binding      = 0;
-        writes[0].arrayIndex   = 0;
-        writes[0].type         = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writes[0].bufferOffset = 0;
-        writes[0].bufferRange  = PPX_WHOLE_SIZE;
-        writes[0].pBuffer      = mGpuEnvDrawConstants;
+        // Constants are written every frame, see AllocateConstants()
+        grfx::WriteDescriptor writes[2] = {};
         // IBL texture
-        writes[1].binding    = 1;
-        writes[1].arrayIndex = 0;
-        writes[1].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[1].pImageView = mIBLResources[mCurrentIBLIndex].environmentTexture->GetSampledImageView();
+        writes[0].binding    = 1;
+        writes[0].arrayIndex = 0;
+        writes[0].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        writes[0].pImageView = mIBLResources[mCurrentIBLIndex].environmentTexture->GetSampledImageView();
         // Sampler
-        writes[2].binding    = 2;
-        writes[2].arrayIndex = 0;
-        writes[2].type       = grfx::DESCRIPTOR_TYPE_SAMPLER;
-        writes[2].pSampler   = mSampler;
+        writes[1].binding    = 2;
+        writes[1].arrayIndex = 0;
+        writes[1].type       = grfx::DESCRIPTOR_TYPE_SAMPLER;
+        writes[1].pSampler   = mSampler;
 
-        PPX_CHECKED_CALL(mEnvDrawSet->UpdateDescriptors(3, writes));
+        PPX_CHECKED_CALL(mEnvDrawSet->UpdateDescriptors(2, writes));
     }
 
     // Material data resources
@@ -839,27 +826,6 @@ void ProjApp::Setup()
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&createInfo, &mMaterialDataLayout));
 
         PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mMaterialDataLayout, &mMaterialDataSet));
-
-        // MaterialData constants
-        grfx::BufferCreateInfo bufferCreateInfo      = {};
-        bufferCreateInfo.size                        = PPX_MINIMUM_CONSTANT_BUFFER_SIZE;
-        bufferCreateInfo.usageFlags.bits.transferSrc = true;
-        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mCpuMaterialConstants));
-
-        bufferCreateInfo.usageFlags.bits.transferDst   = true;
-        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
-        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_GPU_ONLY;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mGpuMaterialConstants));
-
-        grfx::WriteDescriptor write = {};
-        write.binding               = MATERIAL_CONSTANTS_REGISTER;
-        write.arrayIndex            = 0;
-        write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write.bufferOffset          = 0;
-        write.bufferRange           = PPX_WHOLE_SIZE;
-        write.pBuffer               = mGpuMaterialConstants;
-        PPX_CHECKED_CALL(mMaterialDataSet->UpdateDescriptors(1, &write));
     }
 
     // Model data
@@ -869,27 +835,6 @@ void ProjApp::Setup()
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&createInfo, &mModelDataLayout));
 
         PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mModelDataLayout, &mModelDataSet));
-
-        // Model constants
-        grfx::BufferCreateInfo bufferCreateInfo      = {};
-        bufferCreateInfo.size                        = PPX_MINIMUM_CONSTANT_BUFFER_SIZE;
-        bufferCreateInfo.usageFlags.bits.transferSrc = true;
-        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mCpuModelConstants));
-
-        bufferCreateInfo.usageFlags.bits.transferDst   = true;
-        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
-        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_GPU_ONLY;
-        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mGpuModelConstants));
-
-        grfx::WriteDescriptor write = {};
-        write.binding               = MODEL_CONSTANTS_REGISTER;
-        write.arrayIndex            = 0;
-        write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write.bufferOffset          = 0;
-        write.bufferRange           = PPX_WHOLE_SIZE;
-        write.pBuffer               = mGpuModelConstants;
-        PPX_CHECKED_CALL(mModelDataSet->UpdateDescriptors(1, &write));
     }
 
     // Pipeline Interfaces
@@ -1112,6 +1057,9 @@ void ProjApp::Render()
     // Wait for and reset render complete fence
     PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
 
+    // The GPU is done with last frame's constants
+    mConstantsArena->Reset();
+
     // ---------------------------------------------------------------------------------------------
 
     // Smooth out the rotation on Y
@@ -1142,8 +1090,7 @@ void ProjApp::Render()
         };
         PPX_HLSL_PACK_END();
 
-        void* pMappedAddress = nullptr;
-        PPX_CHECKED_CALL(mCpuSceneConstants->MapMemory(0, &pMappedAddress));
+        void* pMappedAddress = AllocateConstants(sizeof(HlslSceneData), mSceneDataSet, SCENE_CONSTANTS_REGISTER);
 
         HlslSceneData* pSceneData        = static_cast<HlslSceneData*>(pMappedAddress);
         pSceneData->viewProjectionMatrix = mCamera.GetViewProjectionMatrix();
@@ -1152,11 +1099,6 @@ void ProjApp::Render()
         pSceneData->ambient              = mAmbient;
         pSceneData->envLevelCount        = static_cast<float>(mIBLResources[mCurrentIBLIndex].environmentTexture->GetMipLevelCount());
         pSceneData->useBRDFLUT           = mUseBRDFLUT;
-
-        mCpuSceneConstants->UnmapMemory();
-
-        grfx::BufferToBufferCopyInfo copyInfo = {mCpuSceneConstants->GetSize()};
-        GetGraphicsQueue()->CopyBufferToBuffer(&copyInfo, mCpuSceneConstants, mGpuSceneConstants, grfx::RESOURCE_STATE_CONSTANT_BUFFER, grfx::RESOURCE_STATE_CONSTANT_BUFFER);
     }
 
     // Lights
@@ -1217,8 +1159,7 @@ void ProjApp::Render()
         };
         PPX_HLSL_PACK_END();
 
-        void* pMappedAddress = nullptr;
-        PPX_CHECKED_CALL(mCpuMaterialConstants->MapMemory(0, &pMappedAddress));
+        void* pMappedAddress = AllocateConstants(sizeof(HlslMaterial), mMaterialDataSet, MATERIAL_CONSTANTS_REGISTER);
 
         HlslMaterial* pMaterial    = static_cast<HlslMaterial*>(pMappedAddress);
         pMaterial->F0              = mF0[mF0Index];
@@ -1233,11 +1174,6 @@ void ProjApp::Render()
         pMaterial->normalSelect    = mMaterialData.normalSelect;
         pMaterial->iblSelect       = mMaterialData.iblSelect;
         pMaterial->envSelect       = mMaterialData.envSelect;
-
-        mCpuMaterialConstants->UnmapMemory();
-
-        grfx::BufferToBufferCopyInfo copyInfo = {mCpuMaterialConstants->GetSize()};
-        GetGraphicsQueue()->CopyBufferToBuffer(&copyInfo, mCpuMaterialConstants, mGpuMaterialConstants, grfx::RESOURCE_STATE_CONSTANT_BUFFER, grfx::RESOURCE_STATE_CONSTANT_BUFFER);
     }
 
     // Update model constants
@@ -1255,32 +1191,20 @@ void ProjApp::Render()
         };
         PPX_HLSL_PACK_END();
 
-        void* pMappedAddress = nullptr;
-        PPX_CHECKED_CALL(mCpuModelConstants->MapMemory(0, &pMappedAddress));
+        void* pMappedAddress = AllocateConstants(sizeof(HlslModelData), mModelDataSet, MODEL_CONSTANTS_REGISTER);
 
         HlslModelData* pModelData = static_cast<HlslModelData*>(pMappedAddress);
         pModelData->modelMatrix   = M;
         pModelData->normalMatrix  = glm::inverseTranspose(M);
-
-        mCpuModelConstants->UnmapMemory();
-
-        grfx::BufferToBufferCopyInfo copyInfo = {mCpuModelConstants->GetSize()};
-        GetGraphicsQueue()->CopyBufferToBuffer(&copyInfo, mCpuModelConstants, mGpuModelConstants, grfx::RESOURCE_STATE_CONSTANT_BUFFER, grfx::RESOURCE_STATE_CONSTANT_BUFFER);
     }
 
     // Update env draw constants
     {
         float4x4 MVP = mCamera.GetViewProjectionMatrix();
 
-        void* pMappedAddress = nullptr;
-        PPX_CHECKED_CALL(mCpuEnvDrawConstants->MapMemory(0, &pMappedAddress));
+        void* pMappedAddress = AllocateConstants(sizeof(float4x4), mEnvDrawSet, 0);
 
         std::memcpy(pMappedAddress, &MVP, sizeof(float4x4));
-
-        mCpuEnvDrawConstants->UnmapMemory();
-
-        grfx::BufferToBufferCopyInfo copyInfo = {mCpuEnvDrawConstants->GetSize()};
-        GetGraphicsQueue()->CopyBufferToBuffer(&copyInfo, mCpuEnvDrawConstants, mGpuEnvDrawConstants, grfx::RESOURCE_STATE_CONSTANT_BUFFER, grfx::RESOURCE_STATE_CONSTANT_BUFFER);
     }
 
     // Update descriptors if IBL selection changed
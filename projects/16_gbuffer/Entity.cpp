@@ -75,7 +75,7 @@ void Entity::Destroy()
 {
 }
 
-ppx::Result Entity::CreatePipelines(ppx::grfx::DescriptorSetLayout* pSceneDataLayout, ppx::grfx::DrawPass* pDrawPass)
+ppx::Result Entity::CreatePipelines(ppx::grfx::DescriptorSetLayout* pSceneDataLayout, const ppx::grfx::OutputState& outputState)
 {
     PPX_ASSERT_NULL_ARG(pSceneDataLayout);
 
@@ -143,12 +143,10 @@ ppx::Result Entity::CreatePipelines(ppx::grfx::DescriptorSetLayout* pSceneDataLa
         gpCreateInfo.depthReadEnable                   = true;
         gpCreateInfo.depthWriteEnable                  = true;
         gpCreateInfo.pPipelineInterface                = sPipelineInterface;
-        gpCreateInfo.outputState.depthStencilFormat    = pDrawPass->GetDepthStencilTexture()->GetImage()->GetFormat();
+        gpCreateInfo.outputState                       = outputState;
         // Render target
-        gpCreateInfo.outputState.renderTargetCount = pDrawPass->GetRenderTargetCount();
         for (uint32_t i = 0; i < gpCreateInfo.outputState.renderTargetCount; ++i) {
-            gpCreateInfo.blendModes[i]                      = grfx::BLEND_MODE_NONE;
-            gpCreateInfo.outputState.renderTargetFormats[i] = pDrawPass->GetRenderTargetTexture(i)->GetImage()->GetFormat();
+            gpCreateInfo.blendModes[i] = grfx::BLEND_MODE_NONE;
         }
         // Vertex description
         gpCreateInfo.vertexInputState.bindingCount = vertexDescription.GetBindingCount();
@@ -36,7 +36,7 @@ public:
     ppx::Result Create(ppx::grfx::Queue* pQueue, ppx::grfx::DescriptorPool* pPool, const EntityCreateInfo* pCreateInfo);
     void        Destroy();
 
-    static ppx::Result CreatePipelines(ppx::grfx::DescriptorSetLayout* pSceneDataLayout, ppx::grfx::DrawPass* pDrawPass);
+    static ppx::Result CreatePipelines(ppx::grfx::DescriptorSetLayout* pSceneDataLayout, const ppx::grfx::OutputState& outputState);
     static void        DestroyPipelines();
 
     ppx::Transform&       GetTransform() { return mTransform; }
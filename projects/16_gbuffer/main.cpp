@@ -29,6 +29,11 @@ const grfx::Api kApi = grfx::API_DX_12_0;
 const grfx::Api kApi = grfx::API_VK_1_1;
 #endif
 
+const uint32_t     kGBufferRenderTargetCount = 4;
+const grfx::Format kGBufferFormat            = grfx::FORMAT_R16G16B16A16_FLOAT;
+const grfx::Format kGBufferDepthFormat       = grfx::FORMAT_D32_FLOAT;
+const grfx::Format kGBufferLightFormat       = grfx::FORMAT_R8G8B8A8_UNORM;
+
 bool gUpdateOnce = false;
 
 class ProjApp
@@ -70,9 +75,12 @@ private:
 
     grfx::SamplerPtr mSampler;
 
-    grfx::DrawPassPtr            mGBufferRenderPass;
-    grfx::TexturePtr             mGBufferLightRenderTarget;
-    grfx::DrawPassPtr            mGBufferLightPass;
+    // The gbuffer, its depth and the light output are transient images of
+    // the render graph, the swapchain image is imported.
+    grfx::RenderGraphPtr         mRenderGraph;
+    uint32_t                     mGBufferImages[kGBufferRenderTargetCount] = {};
+    uint32_t                     mGBufferLightImage                        = 0;
+    uint32_t                     mSwapchainImage                           = 0;
     grfx::DescriptorSetLayoutPtr mGBufferReadLayout;
     grfx::DescriptorSetPtr       mGBufferReadSet;
     grfx::BufferPtr              mGBufferDrawAttrConstants;
@@ -111,11 +119,14 @@ private:
 private:
     void SetupPerFrame();
     void SetupEntities();
-    void SetupGBufferPasses();
+    void SetupRenderGraph();
     void SetupGBufferLightQuad();
     void SetupDebugDraw();
     void SetupDrawToSwapchain();
     void UpdateConstants();
+    void RecordGBuffer(const grfx::RenderGraphPassContext& context);
+    void RecordGBufferLight(const grfx::RenderGraphPassContext& context);
+    void RecordDrawToSwapchain(const grfx::RenderGraphPassContext& context);
     void DrawGui();
 };
 
@@ -212,79 +223,67 @@ void ProjApp::SetupEntities()
     }
 }
 
-void ProjApp::SetupGBufferPasses()
+void ProjApp::SetupRenderGraph()
 {
-    // GBuffer render draw pass
+    grfx::RenderGraphCreateInfo graphCreateInfo = {};
+    PPX_CHECKED_CALL(GetDevice()->CreateRenderGraph(&graphCreateInfo, &mRenderGraph));
+
+    // Images
+    uint32_t depthImage = 0;
     {
-        // Usage flags for render target and depth stencil will automatically
-        // be added during create. So we only need to specify the additional
-        // usage flags here.
-        //
-        grfx::ImageUsageFlags        additionalUsageFlags = grfx::IMAGE_USAGE_SAMPLED;
-        grfx::RenderTargetClearValue rtvClearValue        = {0, 0, 0, 0};
-        grfx::DepthStencilClearValue dsvClearValue        = {1.0f, 0xFF};
-
-        grfx::DrawPassCreateInfo createInfo     = {};
-        createInfo.width                        = GetWindowWidth();
-        createInfo.height                       = GetWindowHeight();
-        createInfo.renderTargetCount            = 4;
-        createInfo.renderTargetFormats[0]       = grfx::FORMAT_R16G16B16A16_FLOAT;
-        createInfo.renderTargetFormats[1]       = grfx::FORMAT_R16G16B16A16_FLOAT;
-        createInfo.renderTargetFormats[2]       = grfx::FORMAT_R16G16B16A16_FLOAT;
-        createInfo.renderTargetFormats[3]       = grfx::FORMAT_R16G16B16A16_FLOAT;
-        createInfo.depthStencilFormat           = grfx::FORMAT_D32_FLOAT;
-        createInfo.renderTargetUsageFlags[0]    = additionalUsageFlags;
-        createInfo.renderTargetUsageFlags[1]    = additionalUsageFlags;
-        createInfo.renderTargetUsageFlags[2]    = additionalUsageFlags;
-        createInfo.renderTargetUsageFlags[3]    = additionalUsageFlags;
-        createInfo.depthStencilUsageFlags       = additionalUsageFlags;
-        createInfo.renderTargetInitialStates[0] = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.renderTargetInitialStates[1] = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.renderTargetInitialStates[2] = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.renderTargetInitialStates[3] = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.depthStencilInitialState     = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.renderTargetClearValues[0]   = rtvClearValue;
-        createInfo.renderTargetClearValues[1]   = rtvClearValue;
-        createInfo.renderTargetClearValues[2]   = rtvClearValue;
-        createInfo.renderTargetClearValues[3]   = rtvClearValue;
-        createInfo.depthStencilClearValue       = dsvClearValue;
-
-        PPX_CHECKED_CALL(GetDevice()->CreateDrawPass(&createInfo, &mGBufferRenderPass));
+        grfx::RenderGraphImageInfo imageInfo = {};
+        imageInfo.width                      = GetWindowWidth();
+        imageInfo.height                     = GetWindowHeight();
+        imageInfo.format                     = kGBufferFormat;
+        for (uint32_t i = 0; i < kGBufferRenderTargetCount; ++i) {
+            mGBufferImages[i] = mRenderGraph->CreateImage(imageInfo);
+        }
+
+        imageInfo.format = kGBufferDepthFormat;
+        depthImage       = mRenderGraph->CreateImage(imageInfo);
+
+        imageInfo.format   = kGBufferLightFormat;
+        mGBufferLightImage = mRenderGraph->CreateImage(imageInfo);
+
+        // Replaced by the acquired image every frame
+        mSwapchainImage = mRenderGraph->ImportImage(GetSwapchain()->GetColorImage(0), grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_PRESENT);
     }
 
-    // GBuffer light render target
+    grfx::RenderTargetClearValue rtvClearValue = {0, 0, 0, 0};
+    grfx::DepthStencilClearValue dsvClearValue = {1.0f, 0xFF};
+
+    // GBuffer render
     {
-        grfx::TextureCreateInfo createInfo         = {};
-        createInfo.imageType                       = grfx::IMAGE_TYPE_2D;
-        createInfo.width                           = mGBufferRenderPass->GetWidth();
-        createInfo.height                          = mGBufferRenderPass->GetHeight();
-        createInfo.depth                           = 1;
-        createInfo.imageFormat                     = grfx::FORMAT_R8G8B8A8_UNORM;
-        createInfo.sampleCount                     = grfx::SAMPLE_COUNT_1;
-        createInfo.mipLevelCount                   = 1;
-        createInfo.arrayLayerCount                 = 1;
-        createInfo.usageFlags.bits.colorAttachment = true;
-        createInfo.usageFlags.bits.sampled         = true;
-        createInfo.memoryUsage                     = grfx::MEMORY_USAGE_GPU_ONLY;
-        createInfo.initialState                    = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-        createInfo.RTVClearValue                   = {0, 0, 0, 0};
-        createInfo.DSVClearValue                   = {1.0f, 0xFF}; // Not used - we won't write to depth
-
-        PPX_CHECKED_CALL(GetDevice()->CreateTexture(&createInfo, &mGBufferLightRenderTarget));
+        uint32_t pass = mRenderGraph->AddPass("GBuffer", [this](const grfx::RenderGraphPassContext& context) { RecordGBuffer(context); });
+        for (uint32_t i = 0; i < kGBufferRenderTargetCount; ++i) {
+            PPX_CHECKED_CALL(mRenderGraph->AddRenderTarget(pass, mGBufferImages[i], &rtvClearValue));
+        }
+        PPX_CHECKED_CALL(mRenderGraph->SetDepthStencil(pass, depthImage, true, &dsvClearValue));
     }
 
-    // GBuffer light draw pass
+    // GBuffer light
     {
-        grfx::DrawPassCreateInfo3 createInfo = {};
-        createInfo.width                     = mGBufferRenderPass->GetWidth();
-        createInfo.height                    = mGBufferRenderPass->GetHeight();
-        createInfo.renderTargetCount         = 1;
-        createInfo.pRenderTargetTextures[0]  = mGBufferLightRenderTarget;
-        createInfo.pDepthStencilTexture      = mGBufferRenderPass->GetDepthStencilTexture();
-        createInfo.depthStencilState         = grfx::RESOURCE_STATE_DEPTH_STENCIL_READ;
-
-        PPX_CHECKED_CALL(GetDevice()->CreateDrawPass(&createInfo, &mGBufferLightPass));
+        uint32_t pass = mRenderGraph->AddPass("GBuffer Light", [this](const grfx::RenderGraphPassContext& context) { RecordGBufferLight(context); });
+        PPX_CHECKED_CALL(mRenderGraph->AddRenderTarget(pass, mGBufferLightImage, &rtvClearValue));
+        PPX_CHECKED_CALL(mRenderGraph->SetDepthStencil(pass, depthImage, false));
+        for (uint32_t i = 0; i < kGBufferRenderTargetCount; ++i) {
+            PPX_CHECKED_CALL(mRenderGraph->AddAccess(pass, mGBufferImages[i], grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+        }
     }
+
+    // Blit to swapchain, the blit covers the whole image so it isn't cleared
+    {
+        uint32_t pass = mRenderGraph->AddPass("Draw To Swapchain", [this](const grfx::RenderGraphPassContext& context) { RecordDrawToSwapchain(context); });
+        PPX_CHECKED_CALL(mRenderGraph->AddRenderTarget(pass, mSwapchainImage));
+        PPX_CHECKED_CALL(mRenderGraph->AddAccess(pass, mGBufferLightImage, grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+    }
+
+    PPX_CHECKED_CALL(mRenderGraph->Compile());
+
+    // Every transient image is live during the light pass, so nothing can
+    // share a texture in this graph and both sizes match.
+    const uint64_t kMiB = 1024 * 1024;
+    PPX_LOG_INFO("Render graph transient memory: " << mRenderGraph->GetTransientMemorySize() / kMiB << " MiB with aliasing, " << mRenderGraph->GetUnaliasedMemorySize() / kMiB << " MiB without");
 }
 
 void ProjApp::SetupGBufferLightQuad()
@@ -312,8 +311,8 @@ void ProjApp::SetupGBufferLightQuad()
     createInfo.sets[1].set                    = 1;
     createInfo.sets[1].pLayout                = mGBufferReadLayout;
     createInfo.renderTargetCount              = 1;
-    createInfo.renderTargetFormats[0]         = mGBufferLightPass->GetRenderTargetTexture(0)->GetImageFormat();
-    createInfo.depthStencilFormat             = mGBufferLightPass->GetDepthStencilTexture()->GetImageFormat();
+    createInfo.renderTargetFormats[0]         = kGBufferLightFormat;
+    createInfo.depthStencilFormat             = kGBufferDepthFormat;
 
     PPX_CHECKED_CALL(GetDevice()->CreateFullscreenQuad(&createInfo, &mGBufferLightQuad));
 }
@@ -343,8 +342,8 @@ void ProjApp::SetupDebugDraw()
     createInfo.sets[1].set                    = 1;
     createInfo.sets[1].pLayout                = mGBufferReadLayout;
     createInfo.renderTargetCount              = 1;
-    createInfo.renderTargetFormats[0]         = mGBufferLightPass->GetRenderTargetTexture(0)->GetImageFormat();
-    createInfo.depthStencilFormat             = mGBufferLightPass->GetDepthStencilTexture()->GetImageFormat();
+    createInfo.renderTargetFormats[0]         = kGBufferLightFormat;
+    createInfo.depthStencilFormat             = kGBufferDepthFormat;
 
     PPX_CHECKED_CALL(GetDevice()->CreateFullscreenQuad(&createInfo, &mDebugDrawQuad));
 }
@@ -398,7 +397,7 @@ void ProjApp::SetupDrawToSwapchain()
         writes[0].binding               = 0;
         writes[0].arrayIndex            = 0;
         writes[0].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[0].pImageView            = mGBufferLightPass->GetRenderTargetTexture(0)->GetSampledImageView();
+        writes[0].pImageView            = mRenderGraph->GetTexture(mGBufferLightImage)->GetSampledImageView();
 
         writes[1].binding  = 1;
         writes[1].type     = grfx::DESCRIPTOR_TYPE_SAMPLER;
@@ -438,7 +437,7 @@ void ProjApp::Setup()
     }
 
     // GBuffer passes
-    SetupGBufferPasses();
+    SetupRenderGraph();
 
     // GBuffer attribute selection buffer
     {
@@ -474,19 +473,19 @@ void ProjApp::Setup()
         writes[0].binding               = GBUFFER_RT0_REGISTER;
         writes[0].arrayIndex            = 0;
         writes[0].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[0].pImageView            = mGBufferRenderPass->GetRenderTargetTexture(0)->GetSampledImageView();
+        writes[0].pImageView            = mRenderGraph->GetTexture(mGBufferImages[0])->GetSampledImageView();
         writes[1].binding               = GBUFFER_RT1_REGISTER;
         writes[1].arrayIndex            = 0;
         writes[1].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[1].pImageView            = mGBufferRenderPass->GetRenderTargetTexture(1)->GetSampledImageView();
+        writes[1].pImageView            = mRenderGraph->GetTexture(mGBufferImages[1])->GetSampledImageView();
         writes[2].binding               = GBUFFER_RT2_REGISTER;
         writes[2].arrayIndex            = 0;
         writes[2].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[2].pImageView            = mGBufferRenderPass->GetRenderTargetTexture(2)->GetSampledImageView();
+        writes[2].pImageView            = mRenderGraph->GetTexture(mGBufferImages[2])->GetSampledImageView();
         writes[3].binding               = GBUFFER_RT3_REGISTER;
         writes[3].arrayIndex            = 0;
         writes[3].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        writes[3].pImageView            = mGBufferRenderPass->GetRenderTargetTexture(3)->GetSampledImageView();
+        writes[3].pImageView            = mRenderGraph->GetTexture(mGBufferImages[3])->GetSampledImageView();
         // Environment map and IBL are not currently used.
         // Create a 1x1 image for unused textures.
         PPX_CHECKED_CALL(grfx_util::CreateTexture1x1<uint8_t>(GetDevice()->GetGraphicsQueue(), {255, 255, 255, 255}, &m1x1WhiteTexture));
@@ -573,7 +572,15 @@ void ProjApp::Setup()
     PPX_CHECKED_CALL(Material::CreateMaterials(GetGraphicsQueue(), mDescriptorPool));
 
     // Create pipelines
-    PPX_CHECKED_CALL(Entity::CreatePipelines(mSceneDataLayout, mGBufferRenderPass));
+    {
+        grfx::OutputState outputState = {};
+        outputState.renderTargetCount  = kGBufferRenderTargetCount;
+        for (uint32_t i = 0; i < kGBufferRenderTargetCount; ++i) {
+            outputState.renderTargetFormats[i] = kGBufferFormat;
+        }
+        outputState.depthStencilFormat = kGBufferDepthFormat;
+        PPX_CHECKED_CALL(Entity::CreatePipelines(mSceneDataLayout, outputState));
+    }
 
     // Entities
     SetupEntities();
@@ -749,102 +756,8 @@ void ProjApp::Render()
     // Build command buffer
     PPX_CHECKED_CALL(frame.cmd->Begin());
     {
-        frame.cmd->SetScissors(mGBufferRenderPass->GetScissor());
-        frame.cmd->SetViewports(mGBufferRenderPass->GetViewport());
-
-        // =====================================================================
-        //  GBuffer render
-        // =====================================================================
-        frame.cmd->TransitionImageLayout(
-            mGBufferRenderPass,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE);
-        frame.cmd->BeginRenderPass(mGBufferRenderPass, grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_RENDER_TARGETS | grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_DEPTH);
-        {
-#ifdef ENABLE_GPU_QUERIES
-            frame.cmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
-#endif
-
-#ifdef ENABLE_GPU_QUERIES
-            if (GetDevice()->PipelineStatsAvailable()) {
-                frame.cmd->BeginQuery(frame.pipelineStatsQuery, 0);
-            }
-#endif
-            for (size_t i = 0; i < mEntities.size(); ++i) {
-                mEntities[i].Draw(mSceneDataSet, frame.cmd);
-            }
-#ifdef ENABLE_GPU_QUERIES
-            if (GetDevice()->PipelineStatsAvailable()) {
-                frame.cmd->EndQuery(frame.pipelineStatsQuery, 0);
-            }
-#endif
-        }
-        frame.cmd->EndRenderPass();
-        frame.cmd->TransitionImageLayout(
-            mGBufferRenderPass,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE);
-
-        // =====================================================================
-        //  GBuffer light
-        // =====================================================================
-        frame.cmd->TransitionImageLayout(
-            mGBufferLightPass,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_READ);
-        frame.cmd->BeginRenderPass(mGBufferLightPass, grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_RENDER_TARGETS);
-        {
-            // Light scene using gbuffer data
-            //
-            grfx::DescriptorSet* sets[2] = {nullptr};
-            sets[0]                      = mSceneDataSet;
-            sets[1]                      = mGBufferReadSet;
-
-            grfx::FullscreenQuad* pDrawQuad = mGBufferLightQuad;
-            if (mDrawGBufferAttr) {
-                pDrawQuad = mDebugDrawQuad;
-            }
-            frame.cmd->Draw(pDrawQuad, 2, sets);
-        }
-        frame.cmd->EndRenderPass();
-#ifdef ENABLE_GPU_QUERIES
-        frame.cmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
-#endif
-
-        frame.cmd->TransitionImageLayout(
-            mGBufferLightPass,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_READ,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE);
-
-        // =====================================================================
-        //  Blit to swapchain
-        // =====================================================================
-        grfx::RenderPassPtr renderPass = swapchain->GetRenderPass(imageIndex);
-        PPX_ASSERT_MSG(!renderPass.IsNull(), "swapchain render pass object is null");
-
-        frame.cmd->SetScissors(renderPass->GetScissor());
-        frame.cmd->SetViewports(renderPass->GetViewport());
-
-        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_RENDER_TARGET);
-        frame.cmd->BeginRenderPass(renderPass);
-        {
-            // Draw gbuffer light output to swapchain
-            frame.cmd->Draw(mDrawToSwapchain, 1, &mDrawToSwapchainSet);
-
-            // Draw ImGui
-            DrawDebugInfo([this]() { this->DrawGui(); });
-            DrawImGui(frame.cmd);
-        }
-        frame.cmd->EndRenderPass();
-        frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+        PPX_CHECKED_CALL(mRenderGraph->SetImportedImage(mSwapchainImage, swapchain->GetColorImage(imageIndex)));
+        PPX_CHECKED_CALL(mRenderGraph->Execute(frame.cmd));
     }
 #ifdef ENABLE_GPU_QUERIES
     // Resolve queries
@@ -869,6 +782,64 @@ void ProjApp::Render()
     PPX_CHECKED_CALL(swapchain->Present(imageIndex, 1, &frame.renderCompleteSemaphore));
 }
 
+void ProjApp::RecordGBuffer(const grfx::RenderGraphPassContext& context)
+{
+    grfx::CommandBuffer* pCmd = context.pCommandBuffer;
+    pCmd->SetScissors(context.pDrawPass->GetScissor());
+    pCmd->SetViewports(context.pDrawPass->GetViewport());
+
+#ifdef ENABLE_GPU_QUERIES
+    PerFrame& frame = mPerFrame[0];
+    pCmd->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0);
+    if (GetDevice()->PipelineStatsAvailable()) {
+        pCmd->BeginQuery(frame.pipelineStatsQuery, 0);
+    }
+#endif
+    for (size_t i = 0; i < mEntities.size(); ++i) {
+        mEntities[i].Draw(mSceneDataSet, pCmd);
+    }
+#ifdef ENABLE_GPU_QUERIES
+    if (GetDevice()->PipelineStatsAvailable()) {
+        pCmd->EndQuery(frame.pipelineStatsQuery, 0);
+    }
+#endif
+}
+
+void ProjApp::RecordGBufferLight(const grfx::RenderGraphPassContext& context)
+{
+    grfx::CommandBuffer* pCmd = context.pCommandBuffer;
+
+    // Light scene using gbuffer data
+    //
+    grfx::DescriptorSet* sets[2] = {nullptr};
+    sets[0]                      = mSceneDataSet;
+    sets[1]                      = mGBufferReadSet;
+
+    grfx::FullscreenQuad* pDrawQuad = mGBufferLightQuad;
+    if (mDrawGBufferAttr) {
+        pDrawQuad = mDebugDrawQuad;
+    }
+    pCmd->Draw(pDrawQuad, 2, sets);
+
+#ifdef ENABLE_GPU_QUERIES
+    pCmd->WriteTimestamp(mPerFrame[0].timestampQuery, grfx::PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 1);
+#endif
+}
+
+void ProjApp::RecordDrawToSwapchain(const grfx::RenderGraphPassContext& context)
+{
+    grfx::CommandBuffer* pCmd = context.pCommandBuffer;
+    pCmd->SetScissors(context.pDrawPass->GetScissor());
+    pCmd->SetViewports(context.pDrawPass->GetViewport());
+
+    // Draw gbuffer light output to swapchain
+    pCmd->Draw(mDrawToSwapchain, 1, &mDrawToSwapchainSet);
+
+    // Draw ImGui
+    DrawDebugInfo([this]() { this->DrawGui(); });
+    DrawImGui(pCmd);
+}
+
 void ProjApp::DrawGui()
 {
     ImGui::Separator();
@@ -901,6 +872,12 @@ void ProjApp::DrawGui()
     ImGui::Text("%f ms ", static_cast<float>(mTotalGpuFrameTime / static_cast<double>(frequency)) * 1000.0f);
     ImGui::NextColumn();
 
+    const float kMiB = 1.0f / (1024.0f * 1024.0f);
+    ImGui::Text("Transient Memory");
+    ImGui::NextColumn();
+    ImGui::Text("%.1f MiB (%.1f MiB unaliased)", mRenderGraph->GetTransientMemorySize() * kMiB, mRenderGraph->GetUnaliasedMemorySize() * kMiB);
+    ImGui::NextColumn();
+
     ImGui::Separator();
 
     ImGui::Text("IAVertices");
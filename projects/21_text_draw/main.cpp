@@ -41,8 +41,10 @@ private:
     };
     std::vector<PerFrame> mPerFrame;
     grfx::TextureFontPtr  mRoboto;
+    grfx::TextureFontPtr  mRobotoSDF;
     grfx::TextDrawPtr     mStaticText;
     grfx::TextDrawPtr     mDynamicText;
+    grfx::TextDrawPtr     mScaledText;
     PerspCamera           mCamera;
 };
 
@@ -87,8 +89,16 @@ void ProjApp::Setup()
         createInfo.font                        = font;
         createInfo.size                        = 48.0f;
         createInfo.characters                  = grfx::TextureFont::GetDefaultCharacters();
+        createInfo.enableGlyphCache            = true;
 
         PPX_CHECKED_CALL(GetDevice()->CreateTextureFont(&createInfo, &mRoboto));
+
+        // One distance field atlas for text of any size
+        createInfo.size                = 32.0f;
+        createInfo.enableGlyphCache    = false;
+        createInfo.signedDistanceField = true;
+
+        PPX_CHECKED_CALL(GetDevice()->CreateTextureFont(&createInfo, &mRobotoSDF));
     }
 
     // Text draw
@@ -118,6 +128,25 @@ void ProjApp::Setup()
 
         GetDevice()->DestroyShaderModule(VS);
         GetDevice()->DestroyShaderModule(PS);
+
+        bytecode = LoadShader("basic/shaders", "TextDrawSDF.vs");
+        PPX_ASSERT_MSG(!bytecode.empty(), "VS shader bytecode load failed");
+        shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &VS));
+
+        bytecode = LoadShader("basic/shaders", "TextDrawSDF.ps");
+        PPX_ASSERT_MSG(!bytecode.empty(), "PS shader bytecode load failed");
+        shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &PS));
+
+        createInfo.pFont = mRobotoSDF;
+        createInfo.VS    = {VS.Get(), "vsmain"};
+        createInfo.PS    = {PS.Get(), "psmain"};
+
+        PPX_CHECKED_CALL(GetDevice()->CreateTextDraw(&createInfo, &mScaledText));
+
+        GetDevice()->DestroyShaderModule(VS);
+        GetDevice()->DestroyShaderModule(PS);
     }
 
     mStaticText->AddString(float2(50, 100), "Diego brazenly plots pixels for\nmaking, very quirky, images with just code!", float3(0.7f, 0.7f, 0.8f));
@@ -128,6 +157,11 @@ void ProjApp::Setup()
     mStaticText->AddString(float2(50, 370), "This string has 70%\nline\nspacing!", 3.0f, 0.7f, float3(1), 1);
 
     PPX_CHECKED_CALL(mStaticText->UploadToGpu(GetGraphicsQueue()));
+
+    mScaledText->AddString(float2(700, 580), "SDF text at 12px", 12.0f, 3.0f, 1.0f, float3(1), 1);
+    mScaledText->AddString(float2(700, 610), "SDF text at 24px", 24.0f, 3.0f, 1.0f, float3(1), 1);
+    mScaledText->AddString(float2(700, 680), "SDF text at 64px", 64.0f, 3.0f, 1.0f, float3(1), 1);
+    PPX_CHECKED_CALL(mScaledText->UploadToGpu(GetGraphicsQueue()));
 }
 
 void ProjApp::Render()
@@ -152,10 +186,22 @@ void ProjApp::Render()
         {
             std::stringstream ss;
             ss << "Frame: " << GetFrameCount() << "\n";
-            ss << "FPS: " << std::setw(6) << std::setprecision(6) << GetAverageFPS();
-
+            ss << "FPS: " << std::setw(6) << std::setprecision(6) << GetAverageFPS() << "\n";
+            ss << "Glyph cache misses: " << mRoboto->GetGlyphCacheMissCount() << "\n";
+            ss << "Glyph cache evictions: " << mRoboto->GetGlyphCacheEvictionCount();
+
+            // Glyphs outside of the font's characters are rasterized on first use
+            static const char* sGreetings[] = {
+                "Grüße, Ελληνικά",
+                "Привет, мир!",
+                "Ça va? ¿Qué tal?",
+            };
+            const char* pGreeting = sGreetings[(GetFrameCount() / 120) % (sizeof(sGreetings) / sizeof(sGreetings[0]))];
+
+            mRoboto->AdvanceGlyphCacheFrame();
             mDynamicText->Clear();
             mDynamicText->AddString(float2(50, 500), ss.str());
+            mDynamicText->AddString(float2(700, 500), pGreeting);
 
             mDynamicText->UploadToGpu(frame.cmd);
         }
@@ -163,6 +209,7 @@ void ProjApp::Render()
         // Update constnat buffer
         mStaticText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
         mDynamicText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
+        mScaledText->PrepareDraw(mCamera.GetViewProjectionMatrix(), frame.cmd);
 
         grfx::RenderPassPtr renderPass = swapchain->GetRenderPass(imageIndex);
         PPX_ASSERT_MSG(!renderPass.IsNull(), "render pass object is null");
@@ -183,6 +230,7 @@ void ProjApp::Render()
 
             mStaticText->Draw(frame.cmd);
             mDynamicText->Draw(frame.cmd);
+            mScaledText->Draw(frame.cmd);
 
             // Draw ImGui
             //DrawDebugInfo();
@@ -43,7 +43,8 @@ private:
         grfx::SemaphorePtr imageAcquiredSemaphore;
         grfx::FencePtr     imageAcquiredFence;
         grfx::SemaphorePtr renderCompleteSemaphore;
-        grfx::FencePtr     renderCompleteFence;
+        grfx::FencePtr     renderCompleteFence;     // Without timeline semaphores
+        uint64_t           renderCompleteValue = 0; // On the graphics timeline
 
         // Graphics pipeline objects.
         struct RenderData
@@ -52,7 +53,8 @@ private:
             grfx::DescriptorSetPtr descriptorSet;
             grfx::BufferPtr        constants;
             grfx::DrawPassPtr      drawPass;
-            grfx::SemaphorePtr     completeSemaphore;
+            grfx::SemaphorePtr     completeSemaphore; // Without timeline semaphores
+            uint64_t               completeValue = 0;
         };
 
         std::array<RenderData, 4> renderData;
@@ -66,7 +68,8 @@ private:
             grfx::ImagePtr            outputImage;
             grfx::SampledImageViewPtr outputImageSampledView;
             grfx::StorageImageViewPtr outputImageStorageView;
-            grfx::SemaphorePtr        completeSemaphore;
+            grfx::SemaphorePtr        completeSemaphore; // Without timeline semaphores
+            uint64_t                  completeValue = 0;
         };
         std::array<ComputeData, 4> computeData;
 
@@ -76,7 +79,8 @@ private:
             grfx::CommandBufferPtr cmd;
             grfx::DescriptorSetPtr descriptorSet;
             grfx::BufferPtr        quadVertexBuffer;
-            grfx::SemaphorePtr     completeSemaphore;
+            grfx::SemaphorePtr     completeSemaphore; // Without timeline semaphores
+            uint64_t               completeValue = 0;
         };
         std::array<ComposeData, 4> composeData;
         grfx::DrawPassPtr          composeDrawPass;
@@ -100,6 +104,18 @@ private:
     void     Compose(PerFrame& frame, size_t quadIndex);
     void     DrawScene(PerFrame& frame, size_t quadIndex);
 
+    // Each queue signals increasing values on its own timeline semaphore, so
+    // one counter per queue replaces the per-pass semaphores and fences.
+    // Devices without timeline semaphores fall back to the latter.
+    struct Timeline
+    {
+        grfx::SemaphorePtr semaphore;
+        uint64_t           value = 0;
+    };
+    Timeline  mGraphicsTimeline;
+    Timeline  mComputeTimeline;
+    Timeline& GetComputeTimeline() { return mAsyncComputeEnabled ? mComputeTimeline : mGraphicsTimeline; }
+
     PerspCamera mCamera;
 
     grfx::MeshPtr    mModelMesh;
@@ -138,6 +154,7 @@ private:
 
     bool mAsyncComputeEnabled     = true;
     bool mUseQueueFamilyTransfers = true;
+    bool mUseTimelines            = false;
 };
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
@@ -168,6 +185,15 @@ void ProjApp::Setup()
     mGraphicsQueue = GetGraphicsQueue();
     mComputeQueue  = mAsyncComputeEnabled ? GetComputeQueue() : mGraphicsQueue;
 
+    // Timelines
+    mUseTimelines = GetDevice()->TimelineSemaphoreSupported();
+    if (mUseTimelines) {
+        grfx::SemaphoreCreateInfo semaCreateInfo = {};
+        semaCreateInfo.semaphoreType             = grfx::SEMAPHORE_TYPE_TIMELINE;
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &mGraphicsTimeline.semaphore));
+        PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &mComputeTimeline.semaphore));
+    }
+
     // Per frame data
     for (uint32_t i = 0; i < mNumFramesInFlight; ++i) {
         PerFrame                  frame          = {};
@@ -178,9 +204,11 @@ void ProjApp::Setup()
             PPX_CHECKED_CALL(mGraphicsQueue->CreateCommandBuffer(&frame.composeData[d].cmd));
             PPX_CHECKED_CALL(mComputeQueue->CreateCommandBuffer(&frame.computeData[d].cmd));
 
-            PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.renderData[d].completeSemaphore));
-            PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.computeData[d].completeSemaphore));
-            PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.composeData[d].completeSemaphore));
+            if (!mUseTimelines) {
+                PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.renderData[d].completeSemaphore));
+                PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.computeData[d].completeSemaphore));
+                PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.composeData[d].completeSemaphore));
+            }
         }
 
         // Use the graphics queue for drawing to the swapchain.
@@ -188,8 +216,10 @@ void ProjApp::Setup()
 
         grfx::FenceCreateInfo fenceCreateInfo = {};
         PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.imageAcquiredFence));
-        fenceCreateInfo = {true}; // Create signaled
-        PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.renderCompleteFence));
+        if (!mUseTimelines) {
+            fenceCreateInfo = {true}; // Create signaled
+            PPX_CHECKED_CALL(GetDevice()->CreateFence(&fenceCreateInfo, &frame.renderCompleteFence));
+        }
 
         PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.imageAcquiredSemaphore));
         PPX_CHECKED_CALL(GetDevice()->CreateSemaphore(&semaCreateInfo, &frame.renderCompleteSemaphore));
@@ -754,8 +784,13 @@ uint32_t ProjApp::AcquireFrame(PerFrame& frame)
     // Wait for and reset image acquired fence
     PPX_CHECKED_CALL(frame.imageAcquiredFence->WaitAndReset());
 
-    // Wait for and reset render complete fence
-    PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
+    // Wait for the GPU to finish the last submission of this frame
+    if (mUseTimelines) {
+        PPX_CHECKED_CALL(mGraphicsTimeline.semaphore->Wait(frame.renderCompleteValue));
+    }
+    else {
+        PPX_CHECKED_CALL(frame.renderCompleteFence->WaitAndReset());
+    }
 
     return imageIndex;
 }
@@ -796,7 +831,14 @@ void ProjApp::DrawScene(PerFrame& frame, size_t quadIndex)
     submitInfo.commandBufferCount   = 1;
     submitInfo.ppCommandBuffers     = &renderData.cmd;
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.ppSignalSemaphores   = &renderData.completeSemaphore;
+    if (mUseTimelines) {
+        renderData.completeValue      = ++mGraphicsTimeline.value;
+        submitInfo.ppSignalSemaphores = &mGraphicsTimeline.semaphore;
+        submitInfo.pSignalValues      = &renderData.completeValue;
+    }
+    else {
+        submitInfo.ppSignalSemaphores = &renderData.completeSemaphore;
+    }
 
     PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
 }
@@ -837,9 +879,19 @@ void ProjApp::RunCompute(PerFrame& frame, size_t quadIndex)
     submitInfo.commandBufferCount   = 1;
     submitInfo.ppCommandBuffers     = &computeData.cmd;
     submitInfo.waitSemaphoreCount   = 1;
-    submitInfo.ppWaitSemaphores     = &renderData.completeSemaphore;
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.ppSignalSemaphores   = &computeData.completeSemaphore;
+    if (mUseTimelines) {
+        Timeline& computeTimeline     = GetComputeTimeline();
+        computeData.completeValue     = ++computeTimeline.value;
+        submitInfo.ppWaitSemaphores   = &mGraphicsTimeline.semaphore;
+        submitInfo.pWaitValues        = &renderData.completeValue;
+        submitInfo.ppSignalSemaphores = &computeTimeline.semaphore;
+        submitInfo.pSignalValues      = &computeData.completeValue;
+    }
+    else {
+        submitInfo.ppWaitSemaphores   = &renderData.completeSemaphore;
+        submitInfo.ppSignalSemaphores = &computeData.completeSemaphore;
+    }
 
     if (mAsyncComputeEnabled) {
         PPX_CHECKED_CALL(GetComputeQueue()->Submit(&submitInfo));
@@ -885,9 +937,18 @@ void ProjApp::Compose(PerFrame& frame, size_t quadIndex)
     submitInfo.commandBufferCount   = 1;
     submitInfo.ppCommandBuffers     = &composeData.cmd;
     submitInfo.waitSemaphoreCount   = 1;
-    submitInfo.ppWaitSemaphores     = &computeData.completeSemaphore;
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.ppSignalSemaphores   = &composeData.completeSemaphore;
+    if (mUseTimelines) {
+        composeData.completeValue     = ++mGraphicsTimeline.value;
+        submitInfo.ppWaitSemaphores   = &GetComputeTimeline().semaphore;
+        submitInfo.pWaitValues        = &computeData.completeValue;
+        submitInfo.ppSignalSemaphores = &mGraphicsTimeline.semaphore;
+        submitInfo.pSignalValues      = &composeData.completeValue;
+    }
+    else {
+        submitInfo.ppWaitSemaphores   = &computeData.completeSemaphore;
+        submitInfo.ppSignalSemaphores = &composeData.completeSemaphore;
+    }
 
     PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
 }
@@ -920,23 +981,55 @@ void ProjApp::BlitAndPresent(PerFrame& frame, uint32_t swapchainImageIndex)
     }
     PPX_CHECKED_CALL(cmd->End());
 
-    const grfx::Semaphore* ppWaitSemaphores[] = {
-        frame.composeData[0].completeSemaphore,
-        frame.composeData[1].completeSemaphore,
-        frame.composeData[2].completeSemaphore,
-        frame.composeData[3].completeSemaphore,
-        frame.imageAcquiredSemaphore};
+    if (mUseTimelines) {
+        // Compositions are submitted in order on the graphics queue, so waiting
+        // for the last one covers all four.
+        frame.renderCompleteValue = ++mGraphicsTimeline.value;
+
+        const grfx::Semaphore* ppWaitSemaphores[] = {
+            mGraphicsTimeline.semaphore,
+            frame.imageAcquiredSemaphore};
+        const uint64_t waitValues[] = {
+            frame.composeData[3].completeValue,
+            0};
+        grfx::Semaphore* ppSignalSemaphores[] = {
+            mGraphicsTimeline.semaphore,
+            frame.renderCompleteSemaphore};
+        const uint64_t signalValues[] = {
+            frame.renderCompleteValue,
+            0};
+
+        grfx::SubmitInfo submitInfo     = {};
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.ppCommandBuffers     = &cmd;
+        submitInfo.waitSemaphoreCount   = sizeof(ppWaitSemaphores) / sizeof(ppWaitSemaphores[0]);
+        submitInfo.ppWaitSemaphores     = ppWaitSemaphores;
+        submitInfo.pWaitValues          = waitValues;
+        submitInfo.signalSemaphoreCount = sizeof(ppSignalSemaphores) / sizeof(ppSignalSemaphores[0]);
+        submitInfo.ppSignalSemaphores   = ppSignalSemaphores;
+        submitInfo.pSignalValues        = signalValues;
 
-    grfx::SubmitInfo submitInfo     = {};
-    submitInfo.commandBufferCount   = 1;
-    submitInfo.ppCommandBuffers     = &cmd;
-    submitInfo.waitSemaphoreCount   = sizeof(ppWaitSemaphores) / sizeof(ppWaitSemaphores[0]);
-    submitInfo.ppWaitSemaphores     = ppWaitSemaphores;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.ppSignalSemaphores   = &frame.renderCompleteSemaphore;
-    submitInfo.pFence               = frame.renderCompleteFence;
+        PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+    }
+    else {
+        const grfx::Semaphore* ppWaitSemaphores[] = {
+            frame.composeData[0].completeSemaphore,
+            frame.composeData[1].completeSemaphore,
+            frame.composeData[2].completeSemaphore,
+            frame.composeData[3].completeSemaphore,
+            frame.imageAcquiredSemaphore};
+
+        grfx::SubmitInfo submitInfo     = {};
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.ppCommandBuffers     = &cmd;
+        submitInfo.waitSemaphoreCount   = sizeof(ppWaitSemaphores) / sizeof(ppWaitSemaphores[0]);
+        submitInfo.ppWaitSemaphores     = ppWaitSemaphores;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.ppSignalSemaphores   = &frame.renderCompleteSemaphore;
+        submitInfo.pFence               = frame.renderCompleteFence;
 
-    PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+        PPX_CHECKED_CALL(GetGraphicsQueue()->Submit(&submitInfo));
+    }
 
     PPX_CHECKED_CALL(GetSwapchain()->Present(swapchainImageIndex, 1, &frame.renderCompleteSemaphore));
 }
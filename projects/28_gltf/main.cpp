@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <functional>
 #include <utility>
 #include <queue>
@@ -20,7 +21,10 @@
 #include "ppx/ppx.h"
 #include "ppx/timer.h"
 #include "ppx/camera.h"
+#include "ppx/culling.h"
 #include "ppx/graphics_util.h"
+#include "ppx/texture_atlas.h"
+#include "ppx/transform_hierarchy.h"
 #include "ppx/grfx/grfx_scope.h"
 #define CGLTF_IMPLEMENTATION
 #include "cgltf.h"
@@ -34,6 +38,11 @@ const grfx::Api kApi = grfx::API_DX_12_0;
 const grfx::Api kApi = grfx::API_VK_1_1;
 #endif
 
+// Must match PbrMetallicRoughness.hlsl.
+constexpr uint32_t kMaxMaterialCount        = 256;
+constexpr uint32_t kMaxMaterialTextureCount = 64;
+constexpr uint32_t kDrawParamsSize          = 256;
+
 class ProjApp
     : public ppx::Application
 {
@@ -56,75 +65,109 @@ private:
     {
         grfx::ImagePtr            pImage;
         grfx::SampledImageViewPtr pTexture;
-        grfx::SamplerPtr          pSampler;
     };
 
     struct Material
     {
-        grfx::PipelineInterfacePtr pInterface;
-        grfx::GraphicsPipelinePtr  pPipeline;
-        grfx::DescriptorSetPtr     pDescriptorSet;
-        std::vector<Texture>       textures;
+        std::vector<Texture>  textures;
+        std::vector<float4>   uvTransforms; // UV transform of each texture
+        // Entry in the constant-color atlas for each texture, UINT32_MAX if loaded from file.
+        std::vector<uint32_t> atlasEntries;
+    };
+
+    // Entry of the material table, see PbrMetallicRoughness.hlsl.
+    struct MaterialParams
+    {
+        uint4  textureIndices; // Index in the texture table of each texture
+        float4 uvTransforms[3];
+    };
+
+    // Per-draw constants, read through a dynamic offset into mDrawParamsBuffer.
+    struct DrawParams
+    {
+        float4x4 modelMatrix;                // Transforms object space to world space
+        float4x4 ITModelMatrix;              // Inverse-transpose of the model matrix.
+        float4   ambient;                    // Object's ambient intensity
+        float4x4 cameraViewProjectionMatrix; // Camera's view projection matrix
+        float4   lightPosition;              // Light's position
+        float4   eyePosition;
+        uint32_t materialIndex; // Index in the material table
     };
 
     struct Primitive
     {
         grfx::Mesh* mesh;
+        AABB        bounds; // Object space, from the POSITION accessor min/max
     };
 
     struct Renderable
     {
-        Material*            pMaterial;
-        Primitive*           pPrimitive;
-        grfx::DescriptorSet* pDescriptorSet;
+        uint32_t   materialIndex;
+        Primitive* pPrimitive;
+        uint32_t   drawIndex; // Slot in mDrawParamsBuffer
 
-        Renderable(Material* m, Primitive* p, grfx::DescriptorSet* set)
-            : pMaterial(m), pPrimitive(p), pDescriptorSet(set) {}
+        Renderable(uint32_t m, Primitive* p, uint32_t d)
+            : materialIndex(m), pPrimitive(p), drawIndex(d) {}
     };
 
     struct Object
     {
         float4x4                modelMatrix;
         float4x4                ITModelMatrix;
-        grfx::BufferPtr         pUniformBuffer;
+        AABB                    bounds; // World space, all renderables
         std::vector<Renderable> renderables;
     };
 
-    using RenderList   = std::unordered_map<Material*, std::vector<Object*>>;
-    using TextureCache = std::unordered_map<std::string, grfx::ImagePtr>;
+    // Keyed by image URI. Materials sharing an image share the view too, so
+    // SetupMaterialTable() gives them one table slot.
+    using TextureCache = std::unordered_map<std::string, Texture>;
 
     std::vector<PerFrame>        mPerFrame;
     grfx::DescriptorPoolPtr      mDescriptorPool;
-    grfx::DescriptorSetLayoutPtr mSetLayout;
+    grfx::DescriptorSetLayoutPtr mDrawSetLayout;
+    grfx::DescriptorSetLayoutPtr mMaterialSetLayout;
+    grfx::DescriptorSetPtr       mDrawSet;
+    grfx::DescriptorSetPtr       mMaterialSet;
+    grfx::PipelineInterfacePtr   mPipelineInterface;
+    grfx::GraphicsPipelinePtr    mPipeline;
+    grfx::SamplerPtr             mSampler;
+    grfx::BufferPtr              mDrawParamsBuffer;
+    grfx::BufferPtr              mMaterialTableBuffer;
     grfx::ShaderModulePtr        mVertexShader;
     grfx::ShaderModulePtr        mPixelShader;
+    grfx::OcclusionCullerPtr     mOcclusionCuller;
     PerspCamera                  mCamera;
     float3                       mLightPosition = float3(10, 100, 10);
+    uint32_t                     mDrawCount     = 0;
 
     std::vector<Material>  mMaterials;
     std::vector<Primitive> mPrimitives;
     std::vector<Object>    mObjects;
     TextureCache           mTextureCache;
+    FrustumCuller          mCuller;
+    CullingStats           mCullingStats;
+    std::vector<uint32_t>  mVisibleObjects;
+
+    // Sampled views of the swapchain depth images, read by the HiZ build.
+    std::vector<grfx::SampledImageViewPtr> mDepthViews;
 
 private:
     void LoadScene(
         const std::filesystem::path& filename,
         grfx::Device*                pDevice,
-        grfx::Swapchain*             pSwapchain,
         grfx::Queue*                 pQueue,
-        grfx::DescriptorPool*        pDescriptorPool,
         TextureCache*                pTextureCache,
         std::vector<Object>*         pObjects,
         std::vector<Primitive>*      pPrimitives,
-        std::vector<Material>*       pMaterials) const;
+        std::vector<Material>*       pMaterials,
+        uint32_t*                    pDrawCount) const;
 
     void LoadMaterial(
         const std::filesystem::path& gltfFolder,
         const cgltf_material&        material,
-        grfx::Swapchain*             pSwapchain,
         grfx::Queue*                 pQueue,
-        grfx::DescriptorPool*        pDescriptorPool,
         TextureCache*                pTextureCache,
+        TextureAtlas*                pConstantAtlas,
         Material*                    pOutput) const;
 
     void LoadTexture(
@@ -135,9 +178,9 @@ private:
         Texture*                     pOutput) const;
 
     void LoadTexture(
-        const Bitmap& bitmap,
-        grfx::Queue*  pQueue,
-        Texture*      pOutput) const;
+        const TextureAtlas& atlas,
+        grfx::Queue*        pQueue,
+        Texture*            pOutput) const;
 
     // Load the given primitive to the GPU.
     // `pStagingBuffer` must already contain all data referenced by `primitive`.
@@ -149,12 +192,14 @@ private:
 
     void LoadNodes(
         const cgltf_data*                                         data,
-        grfx::Queue*                                              pQueue,
-        grfx::DescriptorPool*                                     pDescriptorPool,
         std::vector<Object>*                                      objects,
         const std::unordered_map<const cgltf_primitive*, size_t>& primitiveToIndex,
         std::vector<Primitive>*                                   pPrimitives,
-        std::vector<Material>*                                    pMaterials) const;
+        std::vector<Material>*                                    pMaterials,
+        uint32_t*                                                 pDrawCount) const;
+
+    void SetupMaterialTable();
+    void SetupPipeline();
 };
 
 void ProjApp::Config(ppx::ApplicationSettings& settings)
@@ -182,44 +227,27 @@ void ProjApp::LoadTexture(
     PPX_ASSERT_MSG(texture.image->uri != nullptr, "image uri is null.");
 
     auto it = pTextureCache->find(texture.image->uri);
-    if (it == pTextureCache->end()) {
-        grfx_util::ImageOptions options = grfx_util::ImageOptions().MipLevelCount(PPX_REMAINING_MIP_LEVELS);
-        PPX_CHECKED_CALL(grfx_util::CreateImageFromFile(pQueue, GetAssetPath(gltfFolder / texture.image->uri), &pOutput->pImage, options, false));
-        pTextureCache->emplace(texture.image->uri, pOutput->pImage);
-    }
-    else {
-        pOutput->pImage = it->second;
+    if (it != pTextureCache->end()) {
+        *pOutput = it->second;
+        return;
     }
 
+    grfx_util::ImageOptions options = grfx_util::ImageOptions().MipLevelCount(PPX_REMAINING_MIP_LEVELS);
+    PPX_CHECKED_CALL(grfx_util::CreateImageFromFile(pQueue, GetAssetPath(gltfFolder / texture.image->uri), &pOutput->pImage, options, false));
+
     grfx::SampledImageViewCreateInfo sivCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(pOutput->pImage);
     PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&sivCreateInfo, &pOutput->pTexture));
 
-    // FIXME: read sampler info from GLTF.
-    grfx::SamplerCreateInfo samplerCreateInfo = {};
-    samplerCreateInfo.magFilter               = grfx::FILTER_LINEAR;
-    samplerCreateInfo.minFilter               = grfx::FILTER_LINEAR;
-    samplerCreateInfo.anisotropyEnable        = true;
-    samplerCreateInfo.maxAnisotropy           = 16;
-    samplerCreateInfo.mipmapMode              = grfx::SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerCreateInfo.minLod                  = 0.f;
-    samplerCreateInfo.maxLod                  = FLT_MAX;
-    PPX_CHECKED_CALL(GetDevice()->CreateSampler(&samplerCreateInfo, &pOutput->pSampler));
+    pTextureCache->emplace(texture.image->uri, *pOutput);
 }
 
-void ProjApp::LoadTexture(const Bitmap& bitmap, grfx::Queue* pQueue, Texture* pOutput) const
+void ProjApp::LoadTexture(const TextureAtlas& atlas, grfx::Queue* pQueue, Texture* pOutput) const
 {
     grfx_util::ImageOptions options = grfx_util::ImageOptions().MipLevelCount(1);
-    PPX_CHECKED_CALL(grfx_util::CreateImageFromBitmap(pQueue, &bitmap, &pOutput->pImage, options));
+    PPX_CHECKED_CALL(grfx_util::CreateImageFromTextureAtlas(pQueue, &atlas, &pOutput->pImage, options));
 
     grfx::SampledImageViewCreateInfo sivCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(pOutput->pImage);
     PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&sivCreateInfo, &pOutput->pTexture));
-    grfx::SamplerCreateInfo samplerCreateInfo = {};
-    samplerCreateInfo.magFilter               = grfx::FILTER_LINEAR;
-    samplerCreateInfo.minFilter               = grfx::FILTER_LINEAR;
-    samplerCreateInfo.anisotropyEnable        = true;
-    samplerCreateInfo.maxAnisotropy           = 1.f;
-    samplerCreateInfo.mipmapMode              = grfx::SAMPLER_MIPMAP_MODE_LINEAR;
-    PPX_CHECKED_CALL(GetDevice()->CreateSampler(&samplerCreateInfo, &pOutput->pSampler));
 }
 
 Bitmap ColorToBitmap(const float3& color)
@@ -234,16 +262,22 @@ Bitmap ColorToBitmap(const float3& color)
     return bitmap;
 }
 
+uint32_t AddColorToAtlas(const float3& color, TextureAtlas* pAtlas)
+{
+    Bitmap   bitmap = ColorToBitmap(color);
+    uint32_t index  = UINT32_MAX;
+    PPX_CHECKED_CALL(pAtlas->AddBitmap(&bitmap, &index));
+    return index;
+}
+
 void ProjApp::LoadMaterial(
     const std::filesystem::path& gltfFolder,
     const cgltf_material&        material,
-    grfx::Swapchain*             pSwapchain,
     grfx::Queue*                 pQueue,
-    grfx::DescriptorPool*        pDescriptorPool,
     TextureCache*                pTextureCache,
+    TextureAtlas*                pConstantAtlas,
     Material*                    pOutput) const
 {
-    grfx::Device* pDevice = pQueue->GetDevice();
     if (material.extensions_count != 0) {
         printf("Material %s has extensions, but they are ignored. Rendered result may vary.\n", material.name);
     }
@@ -251,39 +285,14 @@ void ProjApp::LoadMaterial(
     // This is to simplify the pipeline creation for now. Need to revisit later.
     PPX_ASSERT_MSG(material.has_pbr_metallic_roughness, "Only PBR metallic roughness supported for now.");
 
-    grfx::PipelineInterfaceCreateInfo piCreateInfo = {};
-    piCreateInfo.setCount                          = 1;
-    piCreateInfo.sets[0].set                       = 0;
-    piCreateInfo.sets[0].pLayout                   = mSetLayout;
-    PPX_CHECKED_CALL(pDevice->CreatePipelineInterface(&piCreateInfo, &pOutput->pInterface));
-
-    grfx::GraphicsPipelineCreateInfo2 gpCreateInfo = {};
-    gpCreateInfo.VS                                = {mVertexShader.Get(), "vsmain"};
-    gpCreateInfo.PS                                = {mPixelShader.Get(), "psmain"};
-    // FIXME: assuming all primitives provides POSITION, UV, NORMAL and TANGENT. Might not be the case.
-    gpCreateInfo.vertexInputState.bindingCount      = 4;
-    gpCreateInfo.vertexInputState.bindings[0]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[0];
-    gpCreateInfo.vertexInputState.bindings[1]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[1];
-    gpCreateInfo.vertexInputState.bindings[2]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[2];
-    gpCreateInfo.vertexInputState.bindings[3]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[3];
-    gpCreateInfo.topology                           = grfx::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    gpCreateInfo.polygonMode                        = grfx::POLYGON_MODE_FILL;
-    gpCreateInfo.cullMode                           = grfx::CULL_MODE_BACK;
-    gpCreateInfo.frontFace                          = grfx::FRONT_FACE_CCW;
-    gpCreateInfo.depthReadEnable                    = true;
-    gpCreateInfo.depthWriteEnable                   = true;
-    gpCreateInfo.blendModes[0]                      = grfx::BLEND_MODE_NONE;
-    gpCreateInfo.outputState.renderTargetCount      = 1;
-    gpCreateInfo.outputState.renderTargetFormats[0] = pSwapchain->GetColorFormat();
-    gpCreateInfo.outputState.depthStencilFormat     = pSwapchain->GetDepthFormat();
-    gpCreateInfo.pPipelineInterface                 = pOutput->pInterface;
-
-    PPX_CHECKED_CALL(pDevice->CreateGraphicsPipeline(&gpCreateInfo, &pOutput->pPipeline));
-
+    // Constant colors are packed into a shared atlas, the atlas image is
+    // assigned to these textures by LoadScene() once all materials are loaded.
     pOutput->textures.resize(3);
+    pOutput->uvTransforms.resize(3, float4(1, 1, 0, 0));
+    pOutput->atlasEntries.resize(3, UINT32_MAX);
     if (material.pbr_metallic_roughness.base_color_texture.texture == nullptr) {
-        float3 color = glm::make_vec3(material.pbr_metallic_roughness.base_color_factor);
-        LoadTexture(ColorToBitmap(color), pQueue, &pOutput->textures[0]);
+        float3 color             = glm::make_vec3(material.pbr_metallic_roughness.base_color_factor);
+        pOutput->atlasEntries[0] = AddColorToAtlas(color, pConstantAtlas);
     }
     else {
         const auto& texture_path = material.pbr_metallic_roughness.base_color_texture;
@@ -291,16 +300,16 @@ void ProjApp::LoadMaterial(
     }
 
     if (material.normal_texture.texture == nullptr) {
-        LoadTexture(ColorToBitmap(float3(0.f, 0.f, 1.f)), pQueue, &pOutput->textures[1]);
+        pOutput->atlasEntries[1] = AddColorToAtlas(float3(0.f, 0.f, 1.f), pConstantAtlas);
     }
     else {
         LoadTexture(gltfFolder, material.normal_texture, pQueue, pTextureCache, &pOutput->textures[1]);
     }
 
     if (material.pbr_metallic_roughness.metallic_roughness_texture.texture == nullptr) {
-        const auto& mtl   = material.pbr_metallic_roughness;
-        float3      color = float3(mtl.metallic_factor, mtl.roughness_factor, 0.f);
-        LoadTexture(ColorToBitmap(color), pQueue, &pOutput->textures[2]);
+        const auto& mtl          = material.pbr_metallic_roughness;
+        float3      color        = float3(mtl.metallic_factor, mtl.roughness_factor, 0.f);
+        pOutput->atlasEntries[2] = AddColorToAtlas(color, pConstantAtlas);
     }
     else {
         const auto& texture_path = material.pbr_metallic_roughness.metallic_roughness_texture;
@@ -432,6 +441,13 @@ void ProjApp::LoadPrimitive(const cgltf_primitive& primitive, grfx::BufferPtr pS
         }
     }
 
+    // Bounds.
+    {
+        const cgltf_accessor& positions = *accessors[POSITION_INDEX];
+        PPX_ASSERT_MSG(positions.has_min && positions.has_max, "POSITION accessor must have min and max.");
+        pOutput->bounds = AABB(glm::make_vec3(positions.min), glm::make_vec3(positions.max));
+    }
+
     targetMesh->SetOwnership(grfx::OWNERSHIP_REFERENCE);
     pOutput->mesh = targetMesh;
 }
@@ -439,13 +455,12 @@ void ProjApp::LoadPrimitive(const cgltf_primitive& primitive, grfx::BufferPtr pS
 void ProjApp::LoadScene(
     const std::filesystem::path& filename,
     grfx::Device*                pDevice,
-    grfx::Swapchain*             pSwapchain,
     grfx::Queue*                 pQueue,
-    grfx::DescriptorPool*        pDescriptorPool,
     TextureCache*                pTextureCache,
     std::vector<Object>*         pObjects,
     std::vector<Primitive>*      pPrimitives,
-    std::vector<Material>*       pMaterials) const
+    std::vector<Material>*       pMaterials,
+    uint32_t*                    pDrawCount) const
 {
     Timer timerGlobal;
     timerGlobal.Start();
@@ -506,15 +521,47 @@ void ProjApp::LoadScene(
 
     Timer timerMaterialLoading;
     timerMaterialLoading.Start();
+    // Each material adds at most 3 constant colors, each taking a 3x3 cell with padding.
+    TextureAtlas constantAtlas;
+    {
+        const uint32_t cellsPerRow = static_cast<uint32_t>(std::ceil(std::sqrt(3.0 * std::max<size_t>(data->materials_count, 1))));
+
+        TextureAtlasCreateInfo atlasCreateInfo = {};
+        atlasCreateInfo.width                  = 3 * cellsPerRow;
+        atlasCreateInfo.height                 = 3 * cellsPerRow;
+        atlasCreateInfo.format                 = Bitmap::FORMAT_RGBA_FLOAT;
+        atlasCreateInfo.padding                = 1;
+        PPX_CHECKED_CALL(TextureAtlas::Create(atlasCreateInfo, &constantAtlas));
+    }
+
+    PPX_ASSERT_MSG(data->materials_count <= kMaxMaterialCount, "Too many materials for the material table.");
     pMaterials->resize(data->materials_count);
     for (size_t i = 0; i < data->materials_count; i++) {
-        LoadMaterial(gltfFolder, data->materials[i], pSwapchain, pQueue, pDescriptorPool, pTextureCache, &(*pMaterials)[i]);
+        LoadMaterial(gltfFolder, data->materials[i], pQueue, pTextureCache, &constantAtlas, &(*pMaterials)[i]);
+    }
+
+    // One image for all constant colors instead of a 1x1 image per texture.
+    PPX_CHECKED_CALL(constantAtlas.Build());
+    Texture constantAtlasTexture;
+    if (constantAtlas.GetLayerCount() > 0) {
+        LoadTexture(constantAtlas, pQueue, &constantAtlasTexture);
+    }
+    for (auto& material : *pMaterials) {
+        for (size_t j = 0; j < material.textures.size(); j++) {
+            if (material.atlasEntries[j] == UINT32_MAX) {
+                continue;
+            }
+            // Collapse each 1x1 entry to its texel center so any UV, wrapped ones included, samples the constant.
+            const float4& t          = constantAtlas.GetEntry(material.atlasEntries[j]).uvTransform;
+            material.uvTransforms[j] = float4(0, 0, t.z + 0.5f * t.x, t.w + 0.5f * t.y);
+            material.textures[j]     = constantAtlasTexture;
+        }
     }
     const double timerMaterialLoadingElapsed = timerMaterialLoading.SecondsSinceStart();
 
     Timer timerNodeLoading;
     timerNodeLoading.Start();
-    LoadNodes(data, pQueue, pDescriptorPool, pObjects, primitiveToIndex, pPrimitives, pMaterials);
+    LoadNodes(data, pObjects, primitiveToIndex, pPrimitives, pMaterials, pDrawCount);
     const double timerNodeLoadingElapsed = timerNodeLoading.SecondsSinceStart();
 
     printf("Scene loading time breakdown for '%s':\n", filename.c_str());
@@ -524,38 +571,59 @@ void ProjApp::LoadScene(
     printf("\tprimitives loading: %lfs\n", timerPrimitiveLoadingElapsed);
     printf("\t materials loading: %lfs\n", timerMaterialLoadingElapsed);
     printf("\t     nodes loading: %lfs\n", timerNodeLoadingElapsed);
+    printf("\t    constant atlas: %u entries, %ux%u\n", constantAtlas.GetEntryCount(), constantAtlas.GetCreateInfo().width, constantAtlas.GetCreateInfo().height);
 }
 
-float4x4 ComputeObjectMatrix(const cgltf_node* node)
+// Node ids in the hierarchy are the glTF node indices.
+void LoadNodeTransforms(const cgltf_data* data, TransformHierarchy* pHierarchy)
 {
-    float4x4 output(1.f);
-    while (node != nullptr) {
-        if (node->has_matrix) {
-            output = glm::make_mat4(node->matrix) * output;
+    const uint32_t nodeCount = static_cast<uint32_t>(data->nodes_count);
+    pHierarchy->Reserve(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        pHierarchy->AddNode();
+    }
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const cgltf_node& node = data->nodes[i];
+        if (node.parent != nullptr) {
+            PPX_CHECKED_CALL(pHierarchy->SetParent(i, static_cast<uint32_t>(std::distance(data->nodes, node.parent))));
+        }
+
+        if (node.has_matrix) {
+            float3 translation;
+            quat   rotation;
+            float3 scale;
+            float3 skew;
+            float4 perspective;
+            glm::decompose(glm::make_mat4(node.matrix), scale, rotation, translation, skew, perspective);
+            pHierarchy->SetTRS(i, translation, rotation, scale);
+            continue;
         }
-        else {
-            const float4x4 T = node->has_translation ? glm::translate(glm::make_vec3(node->translation)) : glm::mat4(1.f);
-            const float4x4 R = node->has_rotation
-                                   ? glm::mat4_cast(glm::quat(node->rotation[3], node->rotation[0], node->rotation[1], node->rotation[2]))
-                                   : glm::mat4(1.f);
-            const float4x4 S = node->has_scale ? glm::scale(glm::make_vec3(node->scale)) : glm::mat4(1.f);
-            const float4x4 M = T * R * S;
-            output           = M * output;
+        if (node.has_translation) {
+            pHierarchy->SetTranslation(i, glm::make_vec3(node.translation));
+        }
+        if (node.has_rotation) {
+            pHierarchy->SetRotation(i, quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]));
+        }
+        if (node.has_scale) {
+            pHierarchy->SetScale(i, glm::make_vec3(node.scale));
         }
-        node = node->parent;
     }
-    return output;
+
+    pHierarchy->Update();
 }
 
 void ProjApp::LoadNodes(
     const cgltf_data*                                         data,
-    grfx::Queue*                                              pQueue,
-    grfx::DescriptorPool*                                     pDescriptorPool,
     std::vector<Object>*                                      objects,
     const std::unordered_map<const cgltf_primitive*, size_t>& primitiveToIndex,
     std::vector<Primitive>*                                   pPrimitives,
-    std::vector<Material>*                                    pMaterials) const
+    std::vector<Material>*                                    pMaterials,
+    uint32_t*                                                 pDrawCount) const
 {
+    TransformHierarchy hierarchy;
+    LoadNodeTransforms(data, &hierarchy);
+
     const size_t nodeCount = data->nodes_count;
     for (size_t i = 0; i < nodeCount; i++) {
         const auto& node = data->nodes[i];
@@ -564,7 +632,7 @@ void ProjApp::LoadNodes(
         }
 
         Object item;
-        item.modelMatrix   = ComputeObjectMatrix(&node);
+        item.modelMatrix   = hierarchy.GetWorldMatrix(static_cast<uint32_t>(i));
         item.ITModelMatrix = glm::inverse(glm::transpose(item.modelMatrix));
 
         for (size_t j = 0; j < node.mesh->primitives_count; j++) {
@@ -578,26 +646,134 @@ void ProjApp::LoadNodes(
             PPX_ASSERT_MSG(primitive_index < pPrimitives->size(), "Invalid GLB file. Primitive index out of range.");
             PPX_ASSERT_MSG(material_index < pMaterials->size(), "Invalid GLB file. Material index out of range.");
             Primitive* pPrimitive = &(*pPrimitives)[primitive_index];
-            Material*  pMaterial  = &(*pMaterials)[material_index];
 
-            grfx::DescriptorSet* pDescriptorSet = nullptr;
-            PPX_CHECKED_CALL(pQueue->GetDevice()->AllocateDescriptorSet(pDescriptorPool, mSetLayout, &pDescriptorSet));
-            item.renderables.emplace_back(pMaterial, pPrimitive, pDescriptorSet);
-        }
+            // Every renderable gets its own slot of draw parameters, materials are looked up in the shared table.
+            item.renderables.emplace_back(static_cast<uint32_t>(material_index), pPrimitive, *pDrawCount);
+            *pDrawCount = *pDrawCount + 1;
 
-        // Create uniform buffer.
-        grfx::BufferCreateInfo bufferCreateInfo        = {};
-        bufferCreateInfo.size                          = RoundUp(512, PPX_CONSTANT_BUFFER_ALIGNMENT);
-        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
-        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        PPX_CHECKED_CALL(pQueue->GetDevice()->CreateBuffer(&bufferCreateInfo, &item.pUniformBuffer));
+            float3 corners[8];
+            pPrimitive->bounds.Transform(item.modelMatrix, corners);
+            if (j == 0) {
+                item.bounds.Set(corners[0]);
+            }
+            for (const float3& corner : corners) {
+                item.bounds.Expand(corner);
+            }
+        }
 
         objects->emplace_back(std::move(item));
     }
 }
 
+void ProjApp::SetupMaterialTable()
+{
+    // Textures of all materials go in one array, materials refer to them by index.
+    std::vector<const grfx::SampledImageView*> textureTable;
+    std::vector<MaterialParams>                materialTable(mMaterials.size());
+    for (size_t i = 0; i < mMaterials.size(); i++) {
+        const Material& material = mMaterials[i];
+        for (size_t j = 0; j < material.textures.size(); j++) {
+            const grfx::SampledImageView* pTexture = material.textures[j].pTexture;
+
+            auto it = std::find(textureTable.begin(), textureTable.end(), pTexture);
+            if (it == textureTable.end()) {
+                it = textureTable.insert(it, pTexture);
+            }
+            materialTable[i].textureIndices[static_cast<int>(j)] = static_cast<uint32_t>(std::distance(textureTable.begin(), it));
+            materialTable[i].uvTransforms[j]                     = material.uvTransforms[j];
+        }
+    }
+    PPX_ASSERT_MSG(textureTable.size() <= kMaxMaterialTextureCount, "Too many textures for the material table.");
+
+    grfx::BufferCreateInfo bufferCreateInfo        = {};
+    bufferCreateInfo.size                          = kMaxMaterialCount * sizeof(MaterialParams);
+    bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
+    bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+    PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mMaterialTableBuffer));
+    PPX_CHECKED_CALL(mMaterialTableBuffer->CopyFromSource(SizeInBytesU32(materialTable), materialTable.data()));
+
+    // FIXME: read sampler info from GLTF.
+    grfx::SamplerCreateInfo samplerCreateInfo = {};
+    samplerCreateInfo.magFilter               = grfx::FILTER_LINEAR;
+    samplerCreateInfo.minFilter               = grfx::FILTER_LINEAR;
+    samplerCreateInfo.anisotropyEnable        = true;
+    samplerCreateInfo.maxAnisotropy           = 16;
+    samplerCreateInfo.mipmapMode              = grfx::SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerCreateInfo.minLod                  = 0.f;
+    samplerCreateInfo.maxLod                  = FLT_MAX;
+    PPX_CHECKED_CALL(GetDevice()->CreateSampler(&samplerCreateInfo, &mSampler));
+
+    PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mMaterialSetLayout, &mMaterialSet));
+
+    // The shader indexes the whole array, so unused entries repeat the first texture.
+    std::vector<grfx::WriteDescriptor> writes(kMaxMaterialTextureCount + 2);
+    for (uint32_t i = 0; i < kMaxMaterialTextureCount; i++) {
+        writes[i].binding    = 0;
+        writes[i].arrayIndex = i;
+        writes[i].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        writes[i].pImageView = (i < textureTable.size()) ? textureTable[i] : textureTable[0];
+    }
+
+    grfx::WriteDescriptor& samplerWrite = writes[kMaxMaterialTextureCount];
+    samplerWrite.binding                = 1;
+    samplerWrite.type                   = grfx::DESCRIPTOR_TYPE_SAMPLER;
+    samplerWrite.pSampler               = mSampler;
+
+    grfx::WriteDescriptor& tableWrite = writes[kMaxMaterialTextureCount + 1];
+    tableWrite.binding                = 2;
+    tableWrite.type                   = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    tableWrite.bufferOffset           = 0;
+    tableWrite.bufferRange            = PPX_WHOLE_SIZE;
+    tableWrite.pBuffer                = mMaterialTableBuffer;
+    PPX_CHECKED_CALL(mMaterialSet->UpdateDescriptors(CountU32(writes), writes.data()));
+
+    printf("Material table: %zu materials, %zu textures\n", mMaterials.size(), textureTable.size());
+}
+
+void ProjApp::SetupPipeline()
+{
+    grfx::PipelineInterfaceCreateInfo piCreateInfo = {};
+    piCreateInfo.setCount                          = 2;
+    piCreateInfo.sets[0].set                       = 0;
+    piCreateInfo.sets[0].pLayout                   = mDrawSetLayout;
+    piCreateInfo.sets[1].set                       = 1;
+    piCreateInfo.sets[1].pLayout                   = mMaterialSetLayout;
+    PPX_CHECKED_CALL(GetDevice()->CreatePipelineInterface(&piCreateInfo, &mPipelineInterface));
+
+    // All materials are PBR metallic roughness and only differ by their
+    // entry in the material table, so they share one pipeline.
+    grfx::GraphicsPipelineCreateInfo2 gpCreateInfo = {};
+    gpCreateInfo.VS                                = {mVertexShader.Get(), "vsmain"};
+    gpCreateInfo.PS                                = {mPixelShader.Get(), "psmain"};
+    // FIXME: assuming all primitives provides POSITION, UV, NORMAL and TANGENT. Might not be the case.
+    gpCreateInfo.vertexInputState.bindingCount      = 4;
+    gpCreateInfo.vertexInputState.bindings[0]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[0];
+    gpCreateInfo.vertexInputState.bindings[1]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[1];
+    gpCreateInfo.vertexInputState.bindings[2]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[2];
+    gpCreateInfo.vertexInputState.bindings[3]       = mPrimitives[0].mesh->GetDerivedVertexBindings()[3];
+    gpCreateInfo.topology                           = grfx::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    gpCreateInfo.polygonMode                        = grfx::POLYGON_MODE_FILL;
+    gpCreateInfo.cullMode                           = grfx::CULL_MODE_BACK;
+    gpCreateInfo.frontFace                          = grfx::FRONT_FACE_CCW;
+    gpCreateInfo.depthReadEnable                    = true;
+    gpCreateInfo.depthWriteEnable                   = true;
+    gpCreateInfo.blendModes[0]                      = grfx::BLEND_MODE_NONE;
+    gpCreateInfo.outputState.renderTargetCount      = 1;
+    gpCreateInfo.outputState.renderTargetFormats[0] = GetSwapchain()->GetColorFormat();
+    gpCreateInfo.outputState.depthStencilFormat     = GetSwapchain()->GetDepthFormat();
+    gpCreateInfo.pPipelineInterface                 = mPipelineInterface;
+    PPX_CHECKED_CALL(GetDevice()->CreateGraphicsPipeline(&gpCreateInfo, &mPipeline));
+}
+
 void ProjApp::Setup()
 {
+    // Materials index Textures[] with a per-draw value
+    if (!GetDevice()->SampledImageArrayDynamicIndexingSupported()) {
+        PPX_LOG_ERROR("28_gltf requires dynamic indexing of sampled image arrays, which this device does not support");
+        Quit();
+        return;
+    }
+
     // Cameras
     {
         mCamera = PerspCamera(60.0f, GetWindowAspect());
@@ -606,9 +782,10 @@ void ProjApp::Setup()
     // Create descriptor pool large enough for this project
     {
         grfx::DescriptorPoolCreateInfo poolCreateInfo = {};
-        poolCreateInfo.uniformBuffer                  = 1024;
-        poolCreateInfo.sampledImage                   = 1024;
-        poolCreateInfo.sampler                        = 1024;
+        poolCreateInfo.uniformBuffer                  = 1;
+        poolCreateInfo.uniformBufferDynamic           = 1;
+        poolCreateInfo.sampledImage                   = kMaxMaterialTextureCount;
+        poolCreateInfo.sampler                        = 1;
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorPool(&poolCreateInfo, &mDescriptorPool));
     }
 
@@ -622,63 +799,69 @@ void ProjApp::Setup()
     shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
     PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &mPixelShader));
 
+    // Set 0: per-draw parameters, selected with a dynamic offset.
     {
         grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
             /* binding= */ 0,
-            /* type= */ grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            /* type= */ grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             /* array_count= */ 1,
             /* shader_visibility= */ grfx::SHADER_STAGE_ALL_GRAPHICS});
+        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mDrawSetLayout));
+    }
 
-        // Albedo
-        layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 1,
-            /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-            /* array_count= */ 1,
-            /* shader_visibility= */ grfx::SHADER_STAGE_PS});
-        layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 2,
-            /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLER,
-            /* array_count= */ 1,
-            /* shader_visibility= */ grfx::SHADER_STAGE_PS});
-
-        // Normal
+    // Set 1: material table shared by all draws.
+    {
+        grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 3,
+            /* binding= */ 0,
             /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-            /* array_count= */ 1,
+            /* array_count= */ kMaxMaterialTextureCount,
             /* shader_visibility= */ grfx::SHADER_STAGE_PS});
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 4,
+            /* binding= */ 1,
             /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLER,
             /* array_count= */ 1,
             /* shader_visibility= */ grfx::SHADER_STAGE_PS});
-
-        // Metallic/Roughness
-        layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 5,
-            /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE,
-            /* array_count= */ 1,
-            /* shader_visibility= */ grfx::SHADER_STAGE_PS});
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{
-            /* binding= */ 6,
-            /* type= */ grfx::DESCRIPTOR_TYPE_SAMPLER,
+            /* binding= */ 2,
+            /* type= */ grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER,
             /* array_count= */ 1,
             /* shader_visibility= */ grfx::SHADER_STAGE_PS});
-
-        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mSetLayout));
+        PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mMaterialSetLayout));
     }
 
     LoadScene(
         "basic/models/altimeter/altimeter.gltf",
         GetDevice(),
-        GetSwapchain(),
         GetGraphicsQueue(),
-        mDescriptorPool,
         &mTextureCache,
         &mObjects,
         &mPrimitives,
-        &mMaterials);
+        &mMaterials,
+        &mDrawCount);
+
+    SetupMaterialTable();
+    SetupPipeline();
+
+    // One slot of draw parameters per renderable, written every frame for the visible ones.
+    {
+        grfx::BufferCreateInfo bufferCreateInfo        = {};
+        bufferCreateInfo.size                          = std::max<uint32_t>(mDrawCount, 1) * kDrawParamsSize;
+        bufferCreateInfo.usageFlags.bits.uniformBuffer = true;
+        bufferCreateInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+        PPX_CHECKED_CALL(GetDevice()->CreateBuffer(&bufferCreateInfo, &mDrawParamsBuffer));
+
+        PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mDrawSetLayout, &mDrawSet));
+
+        grfx::WriteDescriptor write = {};
+        write.binding               = 0;
+        write.type                  = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        write.bufferOffset          = 0;
+        write.bufferRange           = kDrawParamsSize;
+        write.pBuffer               = mDrawParamsBuffer;
+        PPX_CHECKED_CALL(mDrawSet->UpdateDescriptors(1, &write));
+    }
 
     // Per frame data
     {
@@ -700,6 +883,55 @@ void ProjApp::Setup()
         mPerFrame.push_back(frame);
     }
 
+    // Objects don't move, their bounds only need to be added once.
+    {
+        mCuller.SetInstructionSet(GetBestInstructionSet());
+        mCuller.Reserve(CountU32(mObjects));
+        for (const Object& object : mObjects) {
+            mCuller.AddAABB(object.bounds);
+        }
+    }
+
+    // Occlusion culling: each frame builds a HiZ pyramid from its depth and
+    // tests every object against it, the next frame skips the occluded ones.
+    {
+        grfx::ShaderModulePtr buildCS;
+        bytecode = LoadShader("basic/shaders", "HiZBuild.cs");
+        PPX_ASSERT_MSG(!bytecode.empty(), "CS shader bytecode load failed");
+        shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &buildCS));
+
+        grfx::ShaderModulePtr testCS;
+        bytecode = LoadShader("basic/shaders", "HiZOcclusionTest.cs");
+        PPX_ASSERT_MSG(!bytecode.empty(), "CS shader bytecode load failed");
+        shaderCreateInfo = {static_cast<uint32_t>(bytecode.size()), bytecode.data()};
+        PPX_CHECKED_CALL(GetDevice()->CreateShaderModule(&shaderCreateInfo, &testCS));
+
+        grfx::OcclusionCullerCreateInfo cullerCreateInfo = {};
+        cullerCreateInfo.width                           = GetSwapchain()->GetWidth();
+        cullerCreateInfo.height                          = GetSwapchain()->GetHeight();
+        cullerCreateInfo.maxObjectCount                  = CountU32(mObjects);
+        cullerCreateInfo.buildCS                         = {buildCS.Get(), "csmain"};
+        cullerCreateInfo.testCS                          = {testCS.Get(), "csmain"};
+        PPX_CHECKED_CALL(GetDevice()->CreateOcclusionCuller(&cullerCreateInfo, &mOcclusionCuller));
+
+        GetDevice()->DestroyShaderModule(buildCS);
+        GetDevice()->DestroyShaderModule(testCS);
+
+        std::vector<AABB> bounds;
+        for (const Object& object : mObjects) {
+            bounds.push_back(object.bounds);
+        }
+        PPX_CHECKED_CALL(mOcclusionCuller->SetBounds(CountU32(bounds), bounds.data()));
+
+        for (uint32_t i = 0; i < GetSwapchain()->GetImageCount(); ++i) {
+            grfx::SampledImageViewCreateInfo viewCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(GetSwapchain()->GetDepthImage(i));
+            grfx::SampledImageViewPtr        depthView;
+            PPX_CHECKED_CALL(GetDevice()->CreateSampledImageView(&viewCreateInfo, &depthView));
+            mDepthViews.push_back(depthView);
+        }
+    }
+
     GetDevice()->DestroyShaderModule(mVertexShader);
     GetDevice()->DestroyShaderModule(mPixelShader);
 }
@@ -718,57 +950,43 @@ void ProjApp::Render()
     // Update camera(s)
     mCamera.LookAt(float3(2, 2, 2), float3(0, 0, 0));
 
-    // Update uniform buffers
-    for (auto& object : mObjects) {
-        struct Scene
-        {
-            float4x4 modelMatrix;                // Transforms object space to world space
-            float4x4 ITModelMatrix;              // Inverse-transpose of the model matrix.
-            float4   ambient;                    // Object's ambient intensity
-            float4x4 cameraViewProjectionMatrix; // Camera's view projection matrix
-            float4   lightPosition;              // Light's position
-            float4   eyePosition;
-        };
+    // Cull objects outside the camera frustum
+    mCuller.Cull(Frustum(mCamera), &mVisibleObjects);
+    mCullingStats = mCuller.GetStats();
 
-        Scene scene                      = {};
-        scene.modelMatrix                = object.modelMatrix;
-        scene.ITModelMatrix              = object.ITModelMatrix;
-        scene.ambient                    = float4(0.3f);
-        scene.cameraViewProjectionMatrix = mCamera.GetViewProjectionMatrix();
-        scene.lightPosition              = float4(mLightPosition, 0);
-        scene.eyePosition                = float4(mCamera.GetEyePosition(), 0.f);
+    // Then the ones the previous frame's occlusion test found hidden. That
+    // frame is complete since its fence was waited on above. Nothing is
+    // skipped until the first test has run.
+    if (mOcclusionCuller->GetTestedCount() == CountU32(mObjects)) {
+        const uint32_t* pVisibility = mOcclusionCuller->GetVisibility();
+        auto            isOccluded  = [pVisibility](uint32_t objectIndex) { return pVisibility[objectIndex] == 0; };
+        mVisibleObjects.erase(std::remove_if(mVisibleObjects.begin(), mVisibleObjects.end(), isOccluded), mVisibleObjects.end());
 
-        object.pUniformBuffer->CopyFromSource(sizeof(scene), &scene);
+        mCullingStats.occlusionCulledCount = mCullingStats.visibleCount - CountU32(mVisibleObjects);
+        mCullingStats.visibleCount         = CountU32(mVisibleObjects);
     }
 
+    // Update draw parameters
+    static_assert(sizeof(DrawParams) <= kDrawParamsSize, "DrawParams doesn't fit in its slot");
     {
-        // FIXME: this assumes we have only PBR, and with 3 textures per materials. Needs to be revisited.
-        constexpr size_t                                    TEXTURE_COUNT    = 3;
-        constexpr size_t                                    DESCRIPTOR_COUNT = 1 + TEXTURE_COUNT * 2 /* uniform + 3 * (sampler + texture) */;
-        std::array<grfx::WriteDescriptor, DESCRIPTOR_COUNT> write;
-        for (auto& object : mObjects) {
-            for (auto& renderable : object.renderables) {
-                auto* pPrimitive     = renderable.pPrimitive;
-                auto* pMaterial      = renderable.pMaterial;
-                auto* pDescriptorSet = renderable.pDescriptorSet;
-
-                write[0].binding      = 0;
-                write[0].type         = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                write[0].bufferOffset = 0;
-                write[0].bufferRange  = PPX_WHOLE_SIZE;
-                write[0].pBuffer      = object.pUniformBuffer;
-
-                for (size_t i = 0; i < TEXTURE_COUNT; i++) {
-                    write[1 + i * 2 + 0].binding    = 1 + i * 2 + 0;
-                    write[1 + i * 2 + 0].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-                    write[1 + i * 2 + 0].pImageView = pMaterial->textures[i].pTexture;
-                    write[1 + i * 2 + 1].binding    = 1 + i * 2 + 1;
-                    write[1 + i * 2 + 1].type       = grfx::DESCRIPTOR_TYPE_SAMPLER;
-                    write[1 + i * 2 + 1].pSampler   = pMaterial->textures[i].pSampler;
-                }
-                PPX_CHECKED_CALL(pDescriptorSet->UpdateDescriptors(write.size(), write.data()));
+        char* pDrawParams = nullptr;
+        PPX_CHECKED_CALL(mDrawParamsBuffer->MapMemory(0, reinterpret_cast<void**>(&pDrawParams)));
+        for (uint32_t objectIndex : mVisibleObjects) {
+            const Object& object = mObjects[objectIndex];
+            for (const Renderable& renderable : object.renderables) {
+                DrawParams params                 = {};
+                params.modelMatrix                = object.modelMatrix;
+                params.ITModelMatrix              = object.ITModelMatrix;
+                params.ambient                    = float4(0.3f);
+                params.cameraViewProjectionMatrix = mCamera.GetViewProjectionMatrix();
+                params.lightPosition              = float4(mLightPosition, 0);
+                params.eyePosition                = float4(mCamera.GetEyePosition(), 0.f);
+                params.materialIndex              = renderable.materialIndex;
+
+                memcpy(pDrawParams + renderable.drawIndex * kDrawParamsSize, &params, sizeof(params));
             }
         }
+        mDrawParamsBuffer->UnmapMemory();
     }
 
     // Build command buffer
@@ -786,11 +1004,19 @@ void ProjApp::Render()
             frame.cmd->SetScissors(GetScissor());
             frame.cmd->SetViewports(GetViewport());
 
+            // The material table is bound once. Draws only rebind set 0 with
+            // the offset of their parameters, set 1 stays bound since the
+            // pipeline interface doesn't change.
+            const grfx::DescriptorSet* sets[2]     = {mDrawSet, mMaterialSet};
+            const uint32_t             firstOffset = 0;
+            frame.cmd->BindGraphicsPipeline(mPipeline);
+            frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 2, sets, 1, &firstOffset);
+
             // Draw entities
-            for (auto& object : mObjects) {
-                for (auto& renderable : object.renderables) {
-                    frame.cmd->BindGraphicsPipeline(renderable.pMaterial->pPipeline);
-                    frame.cmd->BindGraphicsDescriptorSets(renderable.pMaterial->pInterface, 1, &renderable.pDescriptorSet);
+            for (uint32_t objectIndex : mVisibleObjects) {
+                for (auto& renderable : mObjects[objectIndex].renderables) {
+                    const uint32_t drawParamsOffset = renderable.drawIndex * kDrawParamsSize;
+                    frame.cmd->BindGraphicsDescriptorSets(mPipelineInterface, 1, sets, 1, &drawParamsOffset);
 
                     frame.cmd->BindIndexBuffer(renderable.pPrimitive->mesh);
                     frame.cmd->BindVertexBuffers(renderable.pPrimitive->mesh);
@@ -798,10 +1024,21 @@ void ProjApp::Render()
                 }
             }
 
+            // Draw ImGui
+            DrawDebugInfo([this]() { DrawCullingStats(mCullingStats); });
             DrawImGui(frame.cmd);
         }
         frame.cmd->EndRenderPass();
         frame.cmd->TransitionImageLayout(renderPass->GetRenderTargetImage(0), PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_RENDER_TARGET, grfx::RESOURCE_STATE_PRESENT);
+
+        // =====================================================================
+        //  Occlusion test, read back by the next frame
+        // =====================================================================
+        grfx::ImagePtr depthImage = swapchain->GetDepthImage(imageIndex);
+        frame.cmd->TransitionImageLayout(depthImage, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+        mOcclusionCuller->RecordBuildHiZ(frame.cmd, mDepthViews[imageIndex]);
+        mOcclusionCuller->RecordOcclusionTest(frame.cmd, mCamera.GetViewProjectionMatrix());
+        frame.cmd->TransitionImageLayout(depthImage, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_SHADER_RESOURCE, grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE);
     }
     PPX_CHECKED_CALL(frame.cmd->End());
 
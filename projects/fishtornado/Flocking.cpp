@@ -48,15 +48,11 @@ Flocking::~Flocking()
 
 static void FillInitialPositionData(Bitmap* pVelocity, Bitmap* pPosition)
 {
-    ppx::Random rand;
-
-    for (Bitmap::PixelIterator iter = pPosition->GetPixelIterator(); !iter.Done(); iter.Next()) {
-        float4* pPixel = iter.GetPixelAddress<float4>();
-        float3  pos    = float3(rand.Float(-200.0f, 200.0f), rand.Float(50.0f, 450.0f), rand.Float(-200.0f, 200.0f));
-        pPixel->r      = pos.x;
-        pPixel->g      = pos.y;
-        pPixel->b      = pos.z;
-        pPixel->a      = rand.Float(0.5f, 1.0f);
+    // Position in rgb, scale in a
+    ppx::RandomStream rand(0xDEAD);
+    for (uint32_t y = 0; y < pPosition->GetHeight(); ++y) {
+        float4* pRow = reinterpret_cast<float4*>(pPosition->GetPixelAddress(0, y));
+        rand.FillFloat4(pRow, pPosition->GetWidth(), float4(-200.0f, 50.0f, -200.0f, 0.5f), float4(200.0f, 450.0f, 200.0f, 1.0f));
     }
 
     Bitmap::PixelIterator posIter = pPosition->GetPixelIterator();
@@ -12,6 +12,7 @@
 #include "ppx/application.h"
 #include "ppx/config.h"
 #include "ppx/grfx/grfx_format.h"
+#include "ppx/grfx/grfx_render_graph_plan.h"
 #include "ppx/timer.h"
 
 #include <algorithm>
@@ -223,6 +224,7 @@ void FluidSimulation::InitTextures()
 
     InitBloomTextures();
     InitSunraysTextures();
+    ReportTransientMemory();
 }
 
 void FluidSimulation::InitBloomTextures()
@@ -246,6 +248,94 @@ void FluidSimulation::InitSunraysTextures()
     mSunraysTempTexture = std::make_unique<Texture>(this, "sunrays temp", res.x, res.y, kR);
 }
 
+void FluidSimulation::ReportTransientMemory()
+{
+    // Mirror the dataflow of Render() in a render graph plan to see what
+    // aliasing the per-frame textures would save. Dye and velocity carry
+    // state across frames so they're imported, as are the bloom and sunrays
+    // textures when their effect is off. All compute dispatches run before
+    // the draws, see ProjApp::Render().
+    ppx::grfx::RenderGraphPlan     plan;
+    std::map<Texture*, uint32_t>   images;
+    const ppx::grfx::ResourceState kRestState = ppx::grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+    auto addImage = [&](Texture* texture, bool imported) {
+        ppx::grfx::RenderGraphImageInfo info = {};
+        info.width                           = texture->GetWidth();
+        info.height                          = texture->GetHeight();
+        info.format                          = texture->GetImagePtr()->GetFormat();
+        images[texture]                      = imported ? plan.ImportImage(info, kRestState, kRestState) : plan.AddImage(info);
+    };
+    auto addDispatch = [&](Texture* output, std::initializer_list<Texture*> inputs) {
+        uint32_t pass = plan.AddPass();
+        PPX_CHECKED_CALL(plan.AddAccess(pass, images[output], ppx::grfx::RENDER_GRAPH_ACCESS_STORAGE));
+        for (Texture* input : inputs) {
+            PPX_CHECKED_CALL(plan.AddAccess(pass, images[input], ppx::grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+        }
+    };
+    auto addDraw = [&](Texture* texture) {
+        uint32_t pass = plan.AddPass(true);
+        PPX_CHECKED_CALL(plan.AddAccess(pass, images[texture], ppx::grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+    };
+
+    addImage(mDyeTexture[0].get(), true);
+    addImage(mDyeTexture[1].get(), true);
+    addImage(mDitheringTexture.get(), true);
+    addImage(mBloomTexture.get(), !mConfig.bloom);
+    addImage(mSunraysTexture.get(), !mConfig.sunrays);
+    addImage(mSunraysTempTexture.get(), false);
+    addImage(mDrawColorTexture.get(), false);
+    addImage(mCheckerboardTexture.get(), false);
+    addImage(mDisplayTexture.get(), false);
+    for (auto& texture : mBloomTextures) {
+        addImage(texture.get(), false);
+    }
+
+    if (mConfig.bloom && (mBloomTextures.size() >= 2)) {
+        Texture* last = mBloomTexture.get();
+        addDispatch(last, {mDyeTexture[0].get()});
+        for (auto& dest : mBloomTextures) {
+            addDispatch(dest.get(), {last});
+            last = dest.get();
+        }
+        for (int i = mBloomTextures.size() - 2; i >= 0; i--) {
+            addDispatch(mBloomTextures[i].get(), {last});
+            last = mBloomTextures[i].get();
+        }
+        addDispatch(mBloomTexture.get(), {last});
+    }
+
+    if (mConfig.sunrays) {
+        addDispatch(mDyeTexture[1].get(), {mDyeTexture[0].get()});
+        addDispatch(mSunraysTexture.get(), {mDyeTexture[1].get()});
+        addDispatch(mSunraysTempTexture.get(), {mSunraysTexture.get()});
+        addDispatch(mSunraysTexture.get(), {mSunraysTempTexture.get()});
+    }
+
+    Texture* background = mConfig.transparent ? mCheckerboardTexture.get() : mDrawColorTexture.get();
+    addDispatch(background, {});
+    addDispatch(mDisplayTexture.get(), {mDyeTexture[0].get(), mBloomTexture.get(), mSunraysTexture.get(), mDitheringTexture.get()});
+    addDraw(background);
+    addDraw(mDisplayTexture.get());
+
+    auto getPhysicalSize = [&plan](bool enableAliasing) -> uint64_t {
+        PPX_CHECKED_CALL(plan.Compile(enableAliasing));
+        uint64_t size = 0;
+        for (uint32_t i = 0; i < plan.GetPhysicalImageCount(); ++i) {
+            const ppx::grfx::RenderGraphImageInfo& info = plan.GetPhysicalImageInfo(i);
+            size += static_cast<uint64_t>(info.width) * info.height * ppx::grfx::GetFormatDescription(info.format)->bytesPerTexel;
+        }
+        return size;
+    };
+
+    // Textures in the plan that a frame never touches aren't counted, the
+    // simulation still allocates them.
+    const uint64_t kKiB          = 1024;
+    uint64_t       unaliasedSize = getPhysicalSize(false);
+    uint64_t       transientSize = getPhysicalSize(true);
+    PPX_LOG_INFO("Fluid simulation transient memory: " << transientSize / kKiB << " KiB with aliasing, " << unaliasedSize / kKiB << " KiB without");
+}
+
 void FluidSimulation::AddTextureToInitialize(Texture* texture)
 {
     mTexturesToInitialize.push_back(texture);
@@ -191,6 +191,7 @@ private:
     void         MultipleSplats(uint32_t amount);
     ppx::float4  NormalizeColor(ppx::float4 input);
     void         Render();
+    void         ReportTransientMemory();
     ppx::Random& Random() { return mRandom; }
     void         Splat(ppx::float2 point, ppx::float2 delta, ppx::float3 color);
 
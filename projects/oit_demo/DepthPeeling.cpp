@@ -16,64 +16,56 @@
 
 void OITDemoApp::SetupDepthPeeling()
 {
-    // Layer texture
+    // Render graph
     {
-        grfx::TextureCreateInfo createInfo         = {};
-        createInfo.imageType                       = grfx::IMAGE_TYPE_2D;
-        createInfo.width                           = mTransparencyTexture->GetWidth();
-        createInfo.height                          = mTransparencyTexture->GetHeight();
-        createInfo.depth                           = 1;
-        createInfo.imageFormat                     = grfx::FORMAT_B8G8R8A8_UNORM;
-        createInfo.sampleCount                     = grfx::SAMPLE_COUNT_1;
-        createInfo.mipLevelCount                   = 1;
-        createInfo.arrayLayerCount                 = 1;
-        createInfo.usageFlags.bits.colorAttachment = true;
-        createInfo.usageFlags.bits.sampled         = true;
-        createInfo.memoryUsage                     = grfx::MEMORY_USAGE_GPU_ONLY;
-        createInfo.initialState                    = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+        grfx::RenderGraphCreateInfo graphCreateInfo = {};
+        PPX_CHECKED_CALL(GetDevice()->CreateRenderGraph(&graphCreateInfo, &mDepthPeeling.renderGraph));
+        grfx::RenderGraph* pGraph = mDepthPeeling.renderGraph;
 
+        grfx::Texture* pOpaqueDepthTexture = mOpaquePass->GetDepthStencilTexture();
+        uint32_t       opaqueDepthImage    = pGraph->ImportImage(pOpaqueDepthTexture->GetImage(), grfx::RESOURCE_STATE_SHADER_RESOURCE, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+        uint32_t       transparencyImage   = pGraph->ImportImage(mTransparencyTexture->GetImage(), grfx::RESOURCE_STATE_SHADER_RESOURCE, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+
+        grfx::RenderGraphImageInfo imageInfo = {};
+        imageInfo.width                      = mTransparencyTexture->GetWidth();
+        imageInfo.height                     = mTransparencyTexture->GetHeight();
         for (uint32_t i = 0; i < DEPTH_PEELING_LAYERS_COUNT; ++i) {
-            PPX_CHECKED_CALL(GetDevice()->CreateTexture(&createInfo, &mDepthPeeling.layerTextures[i]));
+            imageInfo.format             = grfx::FORMAT_B8G8R8A8_UNORM;
+            mDepthPeeling.layerImages[i] = pGraph->CreateImage(imageInfo);
+            imageInfo.format             = pOpaqueDepthTexture->GetDepthStencilViewFormat();
+            mDepthPeeling.depthImages[i] = pGraph->CreateImage(imageInfo);
         }
-    }
 
-    // Depth texture
-    {
-        grfx::TextureCreateInfo createInfo                = {};
-        createInfo.imageType                              = grfx::IMAGE_TYPE_2D;
-        createInfo.width                                  = mDepthPeeling.layerTextures[0]->GetWidth();
-        createInfo.height                                 = mDepthPeeling.layerTextures[0]->GetHeight();
-        createInfo.depth                                  = 1;
-        createInfo.imageFormat                            = mOpaquePass->GetDepthStencilTexture()->GetDepthStencilViewFormat();
-        createInfo.sampleCount                            = grfx::SAMPLE_COUNT_1;
-        createInfo.mipLevelCount                          = 1;
-        createInfo.arrayLayerCount                        = 1;
-        createInfo.usageFlags.bits.transferDst            = true;
-        createInfo.usageFlags.bits.depthStencilAttachment = true;
-        createInfo.usageFlags.bits.sampled                = true;
-        createInfo.memoryUsage                            = grfx::MEMORY_USAGE_GPU_ONLY;
-        createInfo.initialState                           = grfx::RESOURCE_STATE_SHADER_RESOURCE;
-
-        for (uint32_t i = 0; i < DEPTH_PEELING_DEPTH_TEXTURES_COUNT; ++i) {
-            PPX_CHECKED_CALL(GetDevice()->CreateTexture(&createInfo, &mDepthPeeling.depthTextures[i]));
-        }
-    }
-
-    // Pass
-    {
-        grfx::DrawPassCreateInfo2 createInfo  = {};
-        createInfo.width                      = mDepthPeeling.layerTextures[0]->GetWidth();
-        createInfo.height                     = mDepthPeeling.layerTextures[0]->GetHeight();
-        createInfo.renderTargetCount          = 1;
-        createInfo.depthStencilState          = grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE;
-        createInfo.renderTargetClearValues[0] = {0, 0, 0, 0};
-        createInfo.depthStencilClearValue     = {1.0f, 0xFF};
+        grfx::RenderTargetClearValue rtvClearValue = {0, 0, 0, 0};
+        grfx::DepthStencilClearValue dsvClearValue = {1.0f, 0xFF};
 
+        // Layer passes: extract all layers
         for (uint32_t i = 0; i < DEPTH_PEELING_LAYERS_COUNT; ++i) {
-            createInfo.pRenderTargetImages[0] = mDepthPeeling.layerTextures[i]->GetImage();
-            createInfo.pDepthStencilImage     = mDepthPeeling.depthTextures[i % DEPTH_PEELING_DEPTH_TEXTURES_COUNT]->GetImage();
-            PPX_CHECKED_CALL(GetDevice()->CreateDrawPass(&createInfo, &mDepthPeeling.layerPasses[i]));
+            uint32_t pass = pGraph->AddPass("Depth Peeling Layer " + std::to_string(i), [this, i](const grfx::RenderGraphPassContext& context) { RecordDepthPeelingLayer(context, i); });
+            PPX_CHECKED_CALL(pGraph->AddRenderTarget(pass, mDepthPeeling.layerImages[i], &rtvClearValue));
+            PPX_CHECKED_CALL(pGraph->SetDepthStencil(pass, mDepthPeeling.depthImages[i], true, &dsvClearValue));
+            PPX_CHECKED_CALL(pGraph->AddAccess(pass, opaqueDepthImage, grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+            if (i > 0) {
+                PPX_CHECKED_CALL(pGraph->AddAccess(pass, mDepthPeeling.depthImages[i - 1], grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+            }
+        }
+
+        // Transparency pass: combine the results for each pixels
+        {
+            uint32_t pass = pGraph->AddPass("Depth Peeling Combine", [this](const grfx::RenderGraphPassContext& context) { RecordDepthPeelingCombine(context); });
+            PPX_CHECKED_CALL(pGraph->AddRenderTarget(pass, transparencyImage, &rtvClearValue));
+            PPX_CHECKED_CALL(pGraph->SetDepthStencil(pass, opaqueDepthImage, true));
+            for (uint32_t i = 0; i < DEPTH_PEELING_LAYERS_COUNT; ++i) {
+                PPX_CHECKED_CALL(pGraph->AddAccess(pass, mDepthPeeling.layerImages[i], grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+            }
         }
+
+        PPX_CHECKED_CALL(pGraph->Compile());
+
+        // The layers are all read by the combine pass, but each depth image
+        // is dead once the next layer has read it
+        const uint64_t kMiB = 1024 * 1024;
+        PPX_LOG_INFO("Depth peeling transient memory: " << pGraph->GetTransientMemorySize() / kMiB << " MiB with aliasing, " << pGraph->GetUnaliasedMemorySize() / kMiB << " MiB without");
     }
 
     ////////////////////////////////////////
@@ -89,7 +81,7 @@ void OITDemoApp::SetupDepthPeeling()
         layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding{CUSTOM_TEXTURE_1_REGISTER, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, grfx::SHADER_STAGE_ALL_GRAPHICS});
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mDepthPeeling.layerDescriptorSetLayout));
 
-        for (uint32_t i = 0; i < DEPTH_PEELING_DEPTH_TEXTURES_COUNT; ++i) {
+        for (uint32_t i = 0; i < DEPTH_PEELING_LAYERS_COUNT; ++i) {
             PPX_CHECKED_CALL(GetDevice()->AllocateDescriptorSet(mDescriptorPool, mDepthPeeling.layerDescriptorSetLayout, &mDepthPeeling.layerDescriptorSets[i]));
 
             std::array<grfx::WriteDescriptor, 4> writes = {};
@@ -112,7 +104,9 @@ void OITDemoApp::SetupDepthPeeling()
             writes[3].binding    = CUSTOM_TEXTURE_1_REGISTER;
             writes[3].arrayIndex = 0;
             writes[3].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-            writes[3].pImageView = mDepthPeeling.depthTextures[(i + 1) % DEPTH_PEELING_DEPTH_TEXTURES_COUNT]->GetSampledImageView();
+            // The first layer doesn't read a previous layer
+            grfx::Texture* pPreviousDepthTexture = (i > 0) ? mDepthPeeling.renderGraph->GetTexture(mDepthPeeling.depthImages[i - 1]) : mOpaquePass->GetDepthStencilTexture();
+            writes[3].pImageView                 = pPreviousDepthTexture->GetSampledImageView();
 
             PPX_CHECKED_CALL(mDepthPeeling.layerDescriptorSets[i]->UpdateDescriptors(static_cast<uint32_t>(writes.size()), writes.data()));
         }
@@ -137,8 +131,8 @@ void OITDemoApp::SetupDepthPeeling()
         gpCreateInfo.depthWriteEnable                   = true;
         gpCreateInfo.blendModes[0]                      = grfx::BLEND_MODE_NONE;
         gpCreateInfo.outputState.renderTargetCount      = 1;
-        gpCreateInfo.outputState.renderTargetFormats[0] = mDepthPeeling.layerTextures[0]->GetImageFormat();
-        gpCreateInfo.outputState.depthStencilFormat     = mDepthPeeling.depthTextures[0]->GetImageFormat();
+        gpCreateInfo.outputState.renderTargetFormats[0] = mDepthPeeling.renderGraph->GetTexture(mDepthPeeling.layerImages[0])->GetImageFormat();
+        gpCreateInfo.outputState.depthStencilFormat     = mDepthPeeling.renderGraph->GetTexture(mDepthPeeling.depthImages[0])->GetImageFormat();
         gpCreateInfo.pPipelineInterface                 = mDepthPeeling.layerPipelineInterface;
 
         grfx::ShaderModulePtr VS, PS;
@@ -190,7 +184,7 @@ void OITDemoApp::SetupDepthPeeling()
             writes[2 + i].binding    = CUSTOM_TEXTURE_0_REGISTER;
             writes[2 + i].arrayIndex = i;
             writes[2 + i].type       = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-            writes[2 + i].pImageView = mDepthPeeling.layerTextures[i]->GetSampledImageView();
+            writes[2 + i].pImageView = mDepthPeeling.renderGraph->GetTexture(mDepthPeeling.layerImages[i])->GetSampledImageView();
         }
 
         PPX_CHECKED_CALL(mDepthPeeling.combineDescriptorSet->UpdateDescriptors(static_cast<uint32_t>(writes.size()), writes.data()));
@@ -232,58 +226,29 @@ void OITDemoApp::SetupDepthPeeling()
 
 void OITDemoApp::RecordDepthPeeling()
 {
-    // Layer passes: extract all layers
-    for (uint32_t i = 0; i < DEPTH_PEELING_LAYERS_COUNT; ++i) {
-        grfx::DrawPassPtr layerPass = mDepthPeeling.layerPasses[i];
-        mCommandBuffer->TransitionImageLayout(
-            layerPass,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE);
-        mCommandBuffer->BeginRenderPass(layerPass, grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_ALL);
-
-        mCommandBuffer->SetScissors(layerPass->GetScissor());
-        mCommandBuffer->SetViewports(layerPass->GetViewport());
-
-        mCommandBuffer->BindGraphicsDescriptorSets(mDepthPeeling.layerPipelineInterface, 1, &mDepthPeeling.layerDescriptorSets[i % DEPTH_PEELING_DEPTH_TEXTURES_COUNT]);
-        mCommandBuffer->BindGraphicsPipeline(i == 0 ? mDepthPeeling.layerPipeline_FirstLayer : mDepthPeeling.layerPipeline_OtherLayers);
-        mCommandBuffer->BindIndexBuffer(GetTransparentMesh());
-        mCommandBuffer->BindVertexBuffers(GetTransparentMesh());
-        mCommandBuffer->DrawIndexed(GetTransparentMesh()->GetIndexCount());
-
-        mCommandBuffer->EndRenderPass();
-        mCommandBuffer->TransitionImageLayout(
-            layerPass,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE);
-    }
+    PPX_CHECKED_CALL(mDepthPeeling.renderGraph->Execute(mCommandBuffer));
+}
 
-    // Transparency pass: combine the results for each pixels
-    {
-        mCommandBuffer->TransitionImageLayout(
-            mTransparencyPass,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE);
-        mCommandBuffer->BeginRenderPass(mTransparencyPass, grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_RENDER_TARGETS);
-
-        mCommandBuffer->SetScissors(mTransparencyPass->GetScissor());
-        mCommandBuffer->SetViewports(mTransparencyPass->GetViewport());
-
-        mCommandBuffer->BindGraphicsDescriptorSets(mDepthPeeling.combinePipelineInterface, 1, &mDepthPeeling.combineDescriptorSet);
-        mCommandBuffer->BindGraphicsPipeline(mDepthPeeling.combinePipeline);
-        mCommandBuffer->Draw(3);
-
-        mCommandBuffer->EndRenderPass();
-        mCommandBuffer->TransitionImageLayout(
-            mTransparencyPass,
-            grfx::RESOURCE_STATE_RENDER_TARGET,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE,
-            grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE,
-            grfx::RESOURCE_STATE_SHADER_RESOURCE);
-    }
+void OITDemoApp::RecordDepthPeelingLayer(const grfx::RenderGraphPassContext& context, uint32_t layer)
+{
+    grfx::CommandBuffer* pCmd = context.pCommandBuffer;
+    pCmd->SetScissors(context.pDrawPass->GetScissor());
+    pCmd->SetViewports(context.pDrawPass->GetViewport());
+
+    pCmd->BindGraphicsDescriptorSets(mDepthPeeling.layerPipelineInterface, 1, &mDepthPeeling.layerDescriptorSets[layer]);
+    pCmd->BindGraphicsPipeline(layer == 0 ? mDepthPeeling.layerPipeline_FirstLayer : mDepthPeeling.layerPipeline_OtherLayers);
+    pCmd->BindIndexBuffer(GetTransparentMesh());
+    pCmd->BindVertexBuffers(GetTransparentMesh());
+    pCmd->DrawIndexed(GetTransparentMesh()->GetIndexCount());
+}
+
+void OITDemoApp::RecordDepthPeelingCombine(const grfx::RenderGraphPassContext& context)
+{
+    grfx::CommandBuffer* pCmd = context.pCommandBuffer;
+    pCmd->SetScissors(context.pDrawPass->GetScissor());
+    pCmd->SetViewports(context.pDrawPass->GetViewport());
+
+    pCmd->BindGraphicsDescriptorSets(mDepthPeeling.combinePipelineInterface, 1, &mDepthPeeling.combineDescriptorSet);
+    pCmd->BindGraphicsPipeline(mDepthPeeling.combinePipeline);
+    pCmd->Draw(3);
 }
@@ -76,9 +76,9 @@ void OITDemoApp::SetupCommon()
     // Descriptor pool
     {
         grfx::DescriptorPoolCreateInfo createInfo = {};
-        createInfo.sampler                        = 16;
-        createInfo.sampledImage                   = 16;
-        createInfo.uniformBuffer                  = 16;
+        createInfo.sampler                        = 32;
+        createInfo.sampledImage                   = 64;
+        createInfo.uniformBuffer                  = 32;
         createInfo.structuredBuffer               = 16;
         createInfo.storageTexelBuffer             = 16;
         PPX_CHECKED_CALL(GetDevice()->CreateDescriptorPool(&createInfo, &mDescriptorPool));
@@ -482,6 +482,9 @@ void OITDemoApp::UpdateGUI()
                 ImGui::Text("%s", mSupportedAlgorithmNames[mGuiParameters.algorithmDataIndex]);
                 ImGui::SliderInt("DP first layer", &mGuiParameters.depthPeeling.startLayer, 0, DEPTH_PEELING_LAYERS_COUNT - 1);
                 ImGui::SliderInt("DP layers count", &mGuiParameters.depthPeeling.layersCount, 1, DEPTH_PEELING_LAYERS_COUNT);
+
+                const float kMiB = 1.0f / (1024.0f * 1024.0f);
+                ImGui::Text("DP transient memory: %.1f MiB (%.1f MiB unaliased)", mDepthPeeling.renderGraph->GetTransientMemorySize() * kMiB, mDepthPeeling.renderGraph->GetUnaliasedMemorySize() * kMiB);
                 break;
             }
             case ALGORITHM_BUFFER: {
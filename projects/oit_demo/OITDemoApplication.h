@@ -127,6 +127,8 @@ private:
     void RecordWeightedSum();
     void RecordWeightedAverage();
     void RecordDepthPeeling();
+    void RecordDepthPeelingLayer(const grfx::RenderGraphPassContext& context, uint32_t layer);
+    void RecordDepthPeelingCombine(const grfx::RenderGraphPassContext& context);
     void RecordBuffer();
     void RecordTransparency();
     void RecordComposite(grfx::RenderPassPtr renderPass);
@@ -218,12 +220,14 @@ private:
 
     struct
     {
-        grfx::TexturePtr  layerTextures[DEPTH_PEELING_LAYERS_COUNT];
-        grfx::TexturePtr  depthTextures[DEPTH_PEELING_DEPTH_TEXTURES_COUNT];
-        grfx::DrawPassPtr layerPasses[DEPTH_PEELING_LAYERS_COUNT];
+        // Each layer writes its own depth image and only the next layer
+        // reads it, so the graph aliases the depth images
+        grfx::RenderGraphPtr renderGraph;
+        uint32_t             layerImages[DEPTH_PEELING_LAYERS_COUNT];
+        uint32_t             depthImages[DEPTH_PEELING_LAYERS_COUNT];
 
         grfx::DescriptorSetLayoutPtr layerDescriptorSetLayout;
-        grfx::DescriptorSetPtr       layerDescriptorSets[DEPTH_PEELING_DEPTH_TEXTURES_COUNT];
+        grfx::DescriptorSetPtr       layerDescriptorSets[DEPTH_PEELING_LAYERS_COUNT];
         grfx::PipelineInterfacePtr   layerPipelineInterface;
         grfx::GraphicsPipelinePtr    layerPipeline_OtherLayers;
         grfx::GraphicsPipelinePtr    layerPipeline_FirstLayer;
@@ -23,6 +23,7 @@
 #include <unordered_map>
 #include <optional>
 #include <filesystem>
+#include <fstream>
 
 #if defined(PPX_LINUX_XCB)
 #include <X11/Xlib-xcb.h>
@@ -48,9 +49,25 @@ const uint32_t kDefaultWindowWidth  = 1280;
 const uint32_t kDefaultWindowHeight = 720;
 const uint32_t kImGuiMinWidth       = 400;
 const uint32_t kImGuiMinHeight      = 300;
+const float    kMemoryStatsInterval = 0.25f; // Seconds between detailed memory queries for the HUD
 
 static Application* sApplicationInstance = nullptr;
 
+// Same order as grfx::PipelineStatistics
+static const char* sPipelineStatisticNames[PPX_GRFX_PIPELINE_STATISTIC_NUM_ENTRIES] = {
+    "IAVertices",
+    "IAPrimitives",
+    "VSInvocations",
+    "GSInvocations",
+    "GSPrimitives",
+    "CInvocations",
+    "CPrimitives",
+    "PSInvocations",
+    "HSInvocations",
+    "DSInvocations",
+    "CSInvocations",
+};
+
 // -------------------------------------------------------------------------------------------------
 // Key code character map
 // -------------------------------------------------------------------------------------------------
@@ -856,7 +873,7 @@ Result Application::InitializeGrfxSwapchain()
         ci.colorFormat               = mSettings.grfx.swapchain.colorFormat;
         ci.depthFormat               = mSettings.grfx.swapchain.depthFormat;
         ci.imageCount                = mSettings.grfx.swapchain.imageCount;
-        ci.presentMode               = grfx::PRESENT_MODE_IMMEDIATE;
+        ci.presentMode               = (mSettings.grfx.pacingMode == ppx::FRAME_PACING_MODE_VSYNC) ? grfx::PRESENT_MODE_FIFO : grfx::PRESENT_MODE_IMMEDIATE;
 
         grfx::SwapchainPtr swapchain;
         Result             ppxres = mDevice->CreateSwapchain(&ci, &swapchain);
@@ -935,6 +952,11 @@ void Application::StopGrfx()
 void Application::ShutdownGrfx()
 {
     if (mInstance) {
+        if (mGpuProfiler) {
+            mDevice->DestroyGpuProfiler(mGpuProfiler);
+            mGpuProfiler.Reset();
+        }
+
         for (auto& sc : mSwapchain) {
             mDevice->DestroySwapchain(sc);
             sc.Reset();
@@ -1039,6 +1061,7 @@ void Application::DispatchShutdown()
     PPX_LOG_INFO("Number of frames drawn: " << GetFrameCount());
     PPX_LOG_INFO("Average frame time:     " << GetAverageFrameTime() << " ms");
     PPX_LOG_INFO("Average FPS:            " << GetAverageFPS());
+    PPX_LOG_INFO("Time to first frame:    " << GetTimeToFirstFrame() << " ms");
 }
 
 void Application::DispatchMove(int32_t x, int32_t y)
@@ -1266,6 +1289,9 @@ int Application::Run(int argc, char** argv)
         return false;
     }
 
+    // Time to first frame includes device creation and setup
+    mStartupTimer.Start();
+
     // Parse args.
     if (auto error = mCommandLineParser.Parse(argc, const_cast<const char**>(argv))) {
         PPX_LOG_ERROR(error->errorMsg);
@@ -1288,6 +1314,16 @@ int Application::Run(int argc, char** argv)
         mSettings.headless = true;
     }
 
+    if (!mStandardOptions.gpu_stats_file.empty()) {
+        mSettings.grfx.enableGpuProfiler = true;
+    }
+
+    if (!mStandardOptions.frame_pacing.empty()) {
+        if (!ParseFramePacingMode(mStandardOptions.frame_pacing, &mSettings.grfx.pacingMode)) {
+            PPX_LOG_WARN("unknown frame pacing mode '" << mStandardOptions.frame_pacing << "', using " << ToString(mSettings.grfx.pacingMode));
+        }
+    }
+
 #if defined(PPX_LINUX_HEADLESS)
     // Force headless if BigWheels was built without surface support.
     mSettings.headless = true;
@@ -1411,9 +1447,83 @@ int Application::Run(int argc, char** argv)
         }
     }
 
+    // Create the GPU profiler before setup so Setup() can get it
+    if (mSettings.grfx.enableGpuProfiler) {
+        grfx::GpuProfilerCreateInfo createInfo = {};
+        createInfo.pQueue                      = mDevice->GetGraphicsQueue();
+        createInfo.frameCount                  = mSettings.grfx.numFramesInFlight + 2; // Render() waits for its fences after BeginFrame()
+        createInfo.enablePipelineStatistics    = true;
+
+        ppxres = mDevice->CreateGpuProfiler(&createInfo, &mGpuProfiler);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("GPU profiler creation failed: " << ToString(ppxres));
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Load pipelines compiled by a previous run before setup creates them
+    if (!mStandardOptions.pipeline_cache_file.empty()) {
+        LoadPipelineCache();
+    }
+
     // Call setup
     DispatchSetup();
 
+    // Memory stats are written every frame, setup allocations show up on the
+    // first row. They skip the detailed query, so there's no unused range
+    // column.
+    if (!mStandardOptions.memory_stats_file.empty()) {
+        mMemoryStatsLog = std::make_unique<CSVFileLog>(mStandardOptions.memory_stats_file);
+        mMemoryStatsLog->LogField("frame");
+        mMemoryStatsLog->LogField("usage");
+        mMemoryStatsLog->LogField("budget");
+        mMemoryStatsLog->LogField("allocationBytes");
+        mMemoryStatsLog->LogField("blockBytes");
+        for (uint32_t i = grfx::MEMORY_CATEGORY_OTHER; (i + 1) < grfx::MEMORY_CATEGORY_COUNT; ++i) {
+            mMemoryStatsLog->LogField(ToString(static_cast<grfx::MemoryCategory>(i)));
+        }
+        mMemoryStatsLog->LastField(ToString(static_cast<grfx::MemoryCategory>(grfx::MEMORY_CATEGORY_COUNT - 1)));
+    }
+
+    // Pace frames against the queue the swapchain presents on. GPU
+    // completion is only measured when it's written to the frame stats.
+    const bool measureGpuCompletion = !mStandardOptions.frame_stats_file.empty();
+
+    ppxres = mFramePacer.Initialize(mSettings.grfx.pacingMode, mSettings.grfx.pacedFrameRate, measureGpuCompletion, mDevice->GetGraphicsQueue());
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("frame pacer initialization failed: " << ToString(ppxres));
+        return EXIT_FAILURE;
+    }
+
+    // Frames are written once the GPU has finished them, a few frames behind
+    // the main loop.
+    if (!mStandardOptions.frame_stats_file.empty()) {
+        mFrameStatsLog = std::make_unique<CSVFileLog>(mStandardOptions.frame_stats_file);
+        mFrameStatsLog->LogField("frame");
+        mFrameStatsLog->LogField("cpuFrameTime");
+        mFrameStatsLog->LogField("pacingWaitTime");
+        mFrameStatsLog->LogField("gpuCompletionLatency");
+        mFrameStatsLog->LastField("queueIdleTime");
+    }
+
+    // One row per scope, written when the profiler reads a frame back
+    if (mGpuProfiler && !mStandardOptions.gpu_stats_file.empty()) {
+        mGpuStatsLog = std::make_unique<CSVFileLog>(mStandardOptions.gpu_stats_file);
+        mGpuStatsLog->LogField("frame");
+        mGpuStatsLog->LogField("scope");
+        mGpuStatsLog->LogField("depth");
+        if (mGpuProfiler->PipelineStatisticsEnabled()) {
+            mGpuStatsLog->LogField("gpuTime");
+            for (uint32_t i = 0; i < (PPX_GRFX_PIPELINE_STATISTIC_NUM_ENTRIES - 1); ++i) {
+                mGpuStatsLog->LogField(sPipelineStatisticNames[i]);
+            }
+            mGpuStatsLog->LastField(sPipelineStatisticNames[PPX_GRFX_PIPELINE_STATISTIC_NUM_ENTRIES - 1]);
+        }
+        else {
+            mGpuStatsLog->LastField("gpuTime");
+        }
+    }
+
     // ---------------------------------------------------------------------------------------------
     // Main loop [BEGIN]
     // ---------------------------------------------------------------------------------------------
@@ -1427,8 +1537,15 @@ int Application::Run(int argc, char** argv)
 
     mRunningHeadless = mSettings.headless;
     while (IsRunning()) {
+        // Wait before polling input so it's as recent as possible
+        mFramePacer.WaitForFrameStart();
+
         // Frame start
         mFrameStartTime = static_cast<float>(mTimer.MillisSinceStart());
+        mFramePacer.BeginRender();
+        if (mGpuProfiler) {
+            mGpuProfiler->BeginFrame();
+        }
 
 #if defined(PPX_BUILD_XR)
         if (mSettings.xr.enable) {
@@ -1488,6 +1605,8 @@ int Application::Run(int argc, char** argv)
             DispatchRender();
         }
 
+        mFramePacer.EndRender();
+
         // Take screenshot if this is the requested frame.
         if (mFrameCount == static_cast<uint64_t>(mStandardOptions.screenshot_frame_number)) {
             TakeScreenshot();
@@ -1497,6 +1616,19 @@ int Application::Run(int argc, char** argv)
         mFrameCount        = mFrameCount + 1;
         mFrameEndTime      = static_cast<float>(mTimer.MillisSinceStart());
         mPreviousFrameTime = mFrameEndTime - mFrameStartTime;
+        if (mFrameCount == 1) {
+            mTimeToFirstFrame = static_cast<float>(mStartupTimer.MillisSinceStart());
+        }
+
+        if (mMemoryStatsLog) {
+            WriteMemoryStats();
+        }
+
+        WriteFrameStats();
+
+        if (mGpuStatsLog) {
+            WriteGpuStats();
+        }
 
         // Keep a rolling window of frame times to calculate stats,
         // if requested.
@@ -1514,21 +1646,6 @@ int Application::Run(int argc, char** argv)
             mAverageFrameTime = static_cast<float>(mTimer.MillisSinceStart() / mFrameCount);
         }
 
-        // Pace frames - if needed
-        if (mSettings.grfx.pacedFrameRate > 0) {
-            if (mFrameCount > 0) {
-                double currentTime  = mTimer.SecondsSinceStart();
-                double pacedFPS     = 1.0 / static_cast<double>(mSettings.grfx.pacedFrameRate);
-                double expectedTime = mFirstFrameTime + (mFrameCount * pacedFPS);
-                double diff         = expectedTime - currentTime;
-                if (diff > 0) {
-                    Timer::SleepSeconds(diff);
-                }
-            }
-            else {
-                mFirstFrameTime = mTimer.SecondsSinceStart();
-            }
-        }
         // If we reach the maximum number of frames allowed
         if (mFrameCount >= mMaxFrame) {
             Quit();
@@ -1543,9 +1660,23 @@ int Application::Run(int argc, char** argv)
     //
     StopGrfx();
 
+    // The queue is idle, so this only collects the last frames' timings
+    mFramePacer.Shutdown();
+    WriteFrameStats();
+
+    // Save after setup and rendering so pipelines created late are included
+    if (!mStandardOptions.pipeline_cache_file.empty()) {
+        SavePipelineCache();
+    }
+
     // Call shutdown
     DispatchShutdown();
 
+    // Flush memory, frame and GPU stats
+    mMemoryStatsLog.reset();
+    mFrameStatsLog.reset();
+    mGpuStatsLog.reset();
+
     // Shutdown Imgui
     ShutdownImGui();
 
@@ -1783,6 +1914,32 @@ void Application::DrawDebugInfo(std::function<void(void)> drawAdditionalFn)
             ImGui::NextColumn();
         }
 
+        // GPU completion latency
+        if (mFramePacer.MeasuresGpuCompletion()) {
+            ppx::FrameTiming timing = mFramePacer.GetLastCompletedFrame();
+            ImGui::Text("GPU Completion Latency");
+            ImGui::NextColumn();
+            ImGui::Text("%f ms (%f ms queue idle)", timing.gpuCompletionLatency, timing.queueIdleTime);
+            ImGui::NextColumn();
+        }
+
+        // Time to first frame
+        {
+            ImGui::Text("Time To First Frame");
+            ImGui::NextColumn();
+            ImGui::Text("%f ms", mTimeToFirstFrame);
+            ImGui::NextColumn();
+        }
+
+        // Shared graphics pipelines
+        {
+            grfx::GraphicsPipelineCacheStats stats = GetDevice()->GetGraphicsPipelineCacheStats();
+            ImGui::Text("Shared Pipelines");
+            ImGui::NextColumn();
+            ImGui::Text("%u (%llu hits, %llu misses)", stats.pipelineCount, static_cast<unsigned long long>(stats.hitCount), static_cast<unsigned long long>(stats.missCount));
+            ImGui::NextColumn();
+        }
+
         ImGui::Separator();
 
         // Num Frame In Flight
@@ -1810,6 +1967,16 @@ void Application::DrawDebugInfo(std::function<void(void)> drawAdditionalFn)
 
         ImGui::Columns(1);
 
+        // Memory
+        if (ImGui::CollapsingHeader("Memory")) {
+            DrawMemoryStats();
+        }
+
+        // GPU profiler scopes
+        if (mGpuProfiler && ImGui::CollapsingHeader("GPU Scopes")) {
+            DrawGpuProfilerStats();
+        }
+
         // Draw additional elements
         if (drawAdditionalFn) {
             drawAdditionalFn();
@@ -1819,6 +1986,262 @@ void Application::DrawDebugInfo(std::function<void(void)> drawAdditionalFn)
     ImGui::PopStyleVar();
 }
 
+void Application::DrawMemoryStats()
+{
+    if (!mImGui) {
+        return;
+    }
+
+    // The detailed query walks every allocation, so it's refreshed a few
+    // times per second instead of every frame.
+    const float elapsedSeconds = GetElapsedSeconds();
+    if (!mMemoryStatsValid || ((elapsedSeconds - mMemoryStatsTime) >= kMemoryStatsInterval)) {
+        Result ppxres     = GetDevice()->GetMemoryStats(&mMemoryStats);
+        mMemoryStatsValid = Success(ppxres);
+        mMemoryStatsTime  = elapsedSeconds;
+    }
+    if (!mMemoryStatsValid) {
+        ImGui::Text("Memory stats unavailable");
+        return;
+    }
+    const grfx::MemoryStats& stats = mMemoryStats;
+
+    const float kMiB = 1.0f / (1024.0f * 1024.0f);
+
+    // Heaps
+    ImGui::Columns(4);
+    ImGui::Text("Heap");
+    ImGui::NextColumn();
+    ImGui::Text("Usage");
+    ImGui::NextColumn();
+    ImGui::Text("Budget");
+    ImGui::NextColumn();
+    ImGui::Text("Allocated");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (size_t i = 0; i < stats.heaps.size(); ++i) {
+        const grfx::MemoryHeapStats& heap = stats.heaps[i];
+        ImGui::Text("%d%s", static_cast<int>(i), heap.deviceLocal ? " (local)" : "");
+        ImGui::NextColumn();
+        ImGui::Text("%.1f MiB", heap.usage * kMiB);
+        ImGui::NextColumn();
+        ImGui::Text("%.1f MiB", heap.budget * kMiB);
+        ImGui::NextColumn();
+        ImGui::Text("%.1f MiB (%u)", heap.allocationBytes * kMiB, heap.allocationCount);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+
+    // Totals and categories
+    ImGui::Columns(2);
+    {
+        ImGui::Text("Local Usage");
+        ImGui::NextColumn();
+        ImGui::Text("%.1f%%", 100.0f * stats.GetDeviceLocalUsageRatio());
+        ImGui::NextColumn();
+
+        ImGui::Text("Fragmentation");
+        ImGui::NextColumn();
+        ImGui::Text("%.1f%% (%u unused ranges)", 100.0f * stats.GetFragmentation(), stats.unusedRangeCount);
+        ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    for (uint32_t i = grfx::MEMORY_CATEGORY_OTHER; i < grfx::MEMORY_CATEGORY_COUNT; ++i) {
+        ImGui::Text("%s", ToString(static_cast<grfx::MemoryCategory>(i)));
+        ImGui::NextColumn();
+        ImGui::Text("%.1f MiB", stats.categoryBytes[i] * kMiB);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
+void Application::DrawCullingStats(const ppx::CullingStats& stats)
+{
+    if (!mImGui) {
+        return;
+    }
+
+    ImGui::Columns(2);
+    {
+        ImGui::Text("Objects");
+        ImGui::NextColumn();
+        ImGui::Text("%u", stats.objectCount);
+        ImGui::NextColumn();
+
+        ImGui::Text("Frustum Culled");
+        ImGui::NextColumn();
+        ImGui::Text("%u", stats.frustumCulledCount);
+        ImGui::NextColumn();
+
+        ImGui::Text("Occlusion Culled");
+        ImGui::NextColumn();
+        ImGui::Text("%u", stats.occlusionCulledCount);
+        ImGui::NextColumn();
+
+        ImGui::Text("Visible");
+        ImGui::NextColumn();
+        ImGui::Text("%u", stats.visibleCount);
+        ImGui::NextColumn();
+
+        ImGui::Text("CPU Time");
+        ImGui::NextColumn();
+        ImGui::Text("%.3f ms (%u threads, %s)", stats.cpuTimeMs, stats.threadCount, stats.pInstructionSet);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
+
+void Application::DrawGpuProfilerStats()
+{
+    if (!mImGui || !mGpuProfiler) {
+        return;
+    }
+
+    const grfx::GpuProfilerFrame& frame     = mGpuProfiler->GetLastFrame();
+    const bool                    showStats = mGpuProfiler->PipelineStatisticsEnabled();
+
+    ImGui::Columns(showStats ? 3 : 2);
+    ImGui::Text("Frame %llu", static_cast<unsigned long long>(frame.frameNumber));
+    ImGui::NextColumn();
+    ImGui::Text("%.3f ms", frame.gpuTimeMs);
+    ImGui::NextColumn();
+    if (showStats) {
+        ImGui::Text("VS / PS / CS Invocations");
+        ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    for (const grfx::GpuProfilerScope& scope : frame.scopes) {
+        ImGui::Text("%*s%s", static_cast<int>(2 * scope.depth), "", scope.name.c_str());
+        ImGui::NextColumn();
+        ImGui::Text("%.3f ms", scope.gpuTimeMs);
+        ImGui::NextColumn();
+        if (showStats) {
+            if (scope.hasPipelineStatistics) {
+                const grfx::PipelineStatistics& stats = scope.pipelineStatistics;
+                ImGui::Text("%llu / %llu / %llu", static_cast<unsigned long long>(stats.VSInvocations), static_cast<unsigned long long>(stats.PSInvocations), static_cast<unsigned long long>(stats.CSInvocations));
+            }
+            ImGui::NextColumn();
+        }
+    }
+    ImGui::Columns(1);
+
+    if (mGpuProfiler->GetDroppedScopeCount() > 0) {
+        ImGui::Text("%llu scopes dropped", static_cast<unsigned long long>(mGpuProfiler->GetDroppedScopeCount()));
+    }
+}
+
+void Application::LoadPipelineCache()
+{
+    const std::string& path = mStandardOptions.pipeline_cache_file;
+    if (!fs::path_exists(path)) {
+        PPX_LOG_INFO("Pipeline cache file " << path << " not found, it will be created on exit");
+        return;
+    }
+
+    std::optional<std::vector<char>> data = fs::load_file(path);
+    if (!data.has_value() || data->empty()) {
+        PPX_LOG_WARN("Failed to read pipeline cache file " << path);
+        return;
+    }
+
+    Result ppxres = GetDevice()->LoadPipelineCacheData(data->data(), data->size());
+    if (Failed(ppxres)) {
+        PPX_LOG_WARN("Pipeline cache file " << path << " not loaded: " << ToString(ppxres));
+        return;
+    }
+    PPX_LOG_INFO("Loaded pipeline cache file " << path << " (" << data->size() << " bytes)");
+}
+
+void Application::SavePipelineCache()
+{
+    const std::string& path = mStandardOptions.pipeline_cache_file;
+
+    GetDevice()->WaitForPipelineCompiles();
+
+    std::vector<char> data;
+    Result            ppxres = GetDevice()->GetPipelineCacheData(&data);
+    if (Failed(ppxres)) {
+        PPX_LOG_WARN("Pipeline cache not saved: " << ToString(ppxres));
+        return;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        PPX_LOG_WARN("Failed to write pipeline cache file " << path);
+        return;
+    }
+    PPX_LOG_INFO("Saved pipeline cache file " << path << " (" << data.size() << " bytes)");
+}
+
+void Application::WriteMemoryStats()
+{
+    grfx::MemoryStats stats  = {};
+    Result            ppxres = GetDevice()->GetMemoryStats(&stats, false);
+    if (Failed(ppxres)) {
+        return;
+    }
+
+    mMemoryStatsLog->LogField(mFrameCount);
+    mMemoryStatsLog->LogField(stats.usage);
+    mMemoryStatsLog->LogField(stats.budget);
+    mMemoryStatsLog->LogField(stats.allocationBytes);
+    mMemoryStatsLog->LogField(stats.blockBytes);
+    for (uint32_t i = grfx::MEMORY_CATEGORY_OTHER; (i + 1) < grfx::MEMORY_CATEGORY_COUNT; ++i) {
+        mMemoryStatsLog->LogField(stats.categoryBytes[i]);
+    }
+    mMemoryStatsLog->LastField(stats.categoryBytes[grfx::MEMORY_CATEGORY_COUNT - 1]);
+}
+
+void Application::WriteFrameStats()
+{
+    mFrameTimings.clear();
+    mFramePacer.GetCompletedFrames(&mFrameTimings);
+    if (!mFrameStatsLog) {
+        return;
+    }
+
+    for (const ppx::FrameTiming& timing : mFrameTimings) {
+        mFrameStatsLog->LogField(timing.frameNumber);
+        mFrameStatsLog->LogField(timing.cpuFrameTime);
+        mFrameStatsLog->LogField(timing.pacingWaitTime);
+        mFrameStatsLog->LogField(timing.gpuCompletionLatency);
+        mFrameStatsLog->LastField(timing.queueIdleTime);
+    }
+}
+
+void Application::WriteGpuStats()
+{
+    const grfx::GpuProfilerFrame& frame = mGpuProfiler->GetLastFrame();
+    if (frame.scopes.empty() || (frame.frameNumber == mGpuStatsFrame)) {
+        return;
+    }
+    mGpuStatsFrame = frame.frameNumber;
+
+    // Scopes are named by their path so nested scopes with the same name
+    // can be told apart.
+    std::vector<std::string> paths(frame.scopes.size());
+    for (size_t i = 0; i < frame.scopes.size(); ++i) {
+        const grfx::GpuProfilerScope& scope = frame.scopes[i];
+        paths[i]                            = (scope.parentIndex < 0) ? scope.name : (paths[scope.parentIndex] + "/" + scope.name);
+
+        mGpuStatsLog->LogField(frame.frameNumber);
+        mGpuStatsLog->LogField(paths[i]);
+        mGpuStatsLog->LogField(scope.depth);
+        if (mGpuProfiler->PipelineStatisticsEnabled()) {
+            mGpuStatsLog->LogField(scope.gpuTimeMs);
+            for (uint32_t j = 0; j < (PPX_GRFX_PIPELINE_STATISTIC_NUM_ENTRIES - 1); ++j) {
+                mGpuStatsLog->LogField(scope.pipelineStatistics.Statistics[j]);
+            }
+            mGpuStatsLog->LastField(scope.pipelineStatistics.Statistics[PPX_GRFX_PIPELINE_STATISTIC_NUM_ENTRIES - 1]);
+        }
+        else {
+            mGpuStatsLog->LastField(scope.gpuTimeMs);
+        }
+    }
+}
+
 void Application::DrawProfilerGrfxApiFunctions()
 {
     if (!mImGui) {
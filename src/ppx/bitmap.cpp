@@ -23,6 +23,7 @@
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "stb_image_resize.h"
 
+#include "ppx/bitmap_kernels.h"
 #include "ppx/fs.h"
 
 namespace ppx {
@@ -280,6 +281,245 @@ Result Bitmap::ScaleTo(Bitmap* pTargetBitmap) const
     return ppx::SUCCESS;
 }
 
+void Bitmap::InternalFill(const void* pPixel)
+{
+    uint8_t pattern[bitmap_kernels::kFillPatternSize];
+    bitmap_kernels::BuildFillPattern(pPixel, mPixelStride, pattern);
+
+    const size_t rowSize = static_cast<size_t>(mWidth) * mPixelStride;
+    char*        pRow    = mData;
+    for (uint32_t y = 0; y < mHeight; ++y) {
+        bitmap_kernels::FillRow(pRow, rowSize, pattern);
+        pRow += mRowStride;
+    }
+}
+
+// Decodes one row of channel values to float
+static void DecodeRowF32(Bitmap::DataType dataType, const char* pSrc, float* pDst, size_t count)
+{
+    // clang-format off
+    switch (dataType) {
+        default: break;
+        case Bitmap::DATA_TYPE_UINT8  : bitmap_kernels::ConvertU8ToF32(reinterpret_cast<const uint8_t*>(pSrc), pDst, count); break;
+        case Bitmap::DATA_TYPE_UINT16 : bitmap_kernels::ConvertU16ToF32(reinterpret_cast<const uint16_t*>(pSrc), pDst, count); break;
+        case Bitmap::DATA_TYPE_UINT32 : bitmap_kernels::ConvertU32ToF32(reinterpret_cast<const uint32_t*>(pSrc), pDst, count); break;
+        case Bitmap::DATA_TYPE_FLOAT  : std::memcpy(pDst, pSrc, count * sizeof(float)); break;
+    }
+    // clang-format on
+}
+
+// Encodes one row of float channel values
+static void EncodeRowF32(Bitmap::DataType dataType, const float* pSrc, char* pDst, size_t count)
+{
+    // clang-format off
+    switch (dataType) {
+        default: break;
+        case Bitmap::DATA_TYPE_UINT8  : bitmap_kernels::ConvertF32ToU8(pSrc, reinterpret_cast<uint8_t*>(pDst), count); break;
+        case Bitmap::DATA_TYPE_UINT16 : bitmap_kernels::ConvertF32ToU16(pSrc, reinterpret_cast<uint16_t*>(pDst), count); break;
+        case Bitmap::DATA_TYPE_UINT32 : bitmap_kernels::ConvertF32ToU32(pSrc, reinterpret_cast<uint32_t*>(pDst), count); break;
+        case Bitmap::DATA_TYPE_FLOAT  : std::memcpy(pDst, pSrc, count * sizeof(float)); break;
+    }
+    // clang-format on
+}
+
+Result Bitmap::ConvertTo(Bitmap* pTargetBitmap) const
+{
+    if (IsNull(pTargetBitmap)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (!IsOk() || !pTargetBitmap->IsOk()) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+    if ((pTargetBitmap->GetWidth() != mWidth) || (pTargetBitmap->GetHeight() != mHeight)) {
+        return ppx::ERROR_BITMAP_FOOTPRINT_MISMATCH;
+    }
+
+    const Bitmap::Format   dstFormat       = pTargetBitmap->GetFormat();
+    const Bitmap::DataType srcDataType     = Bitmap::ChannelDataType(mFormat);
+    const Bitmap::DataType dstDataType     = Bitmap::ChannelDataType(dstFormat);
+    const uint32_t         srcChannelCount = Bitmap::ChannelCount(mFormat);
+    const uint32_t         dstChannelCount = Bitmap::ChannelCount(dstFormat);
+    const uint32_t         dstRowStride    = pTargetBitmap->GetRowStride();
+
+    // Same format: plain row copy
+    if (dstFormat == mFormat) {
+        const size_t rowSize = static_cast<size_t>(mWidth) * mPixelStride;
+        for (uint32_t y = 0; y < mHeight; ++y) {
+            std::memcpy(pTargetBitmap->GetData() + y * dstRowStride, mData + y * mRowStride, rowSize);
+        }
+        return ppx::SUCCESS;
+    }
+
+    // RGB8 -> RGBA8 is common enough (loaders, PPM) to get its own kernel
+    if ((mFormat == Bitmap::FORMAT_RGB_UINT8) && (dstFormat == Bitmap::FORMAT_RGBA_UINT8)) {
+        for (uint32_t y = 0; y < mHeight; ++y) {
+            const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(mData + y * mRowStride);
+            uint8_t*       pDst = reinterpret_cast<uint8_t*>(pTargetBitmap->GetData() + y * dstRowStride);
+            bitmap_kernels::ExpandRGB8ToRGBA8(pSrc, pDst, mWidth, UINT8_MAX);
+        }
+        return ppx::SUCCESS;
+    }
+
+    // Everything else goes through a float row: decode, swizzle channels, encode.
+    std::vector<float> srcRow(static_cast<size_t>(mWidth) * srcChannelCount);
+    std::vector<float> dstRow(static_cast<size_t>(mWidth) * dstChannelCount);
+    for (uint32_t y = 0; y < mHeight; ++y) {
+        DecodeRowF32(srcDataType, mData + y * mRowStride, srcRow.data(), srcRow.size());
+
+        const float* pEncodeSrc = srcRow.data();
+        if (srcChannelCount != dstChannelCount) {
+            bitmap_kernels::SwizzleChannelsF32(srcRow.data(), srcChannelCount, dstRow.data(), dstChannelCount, mWidth);
+            pEncodeSrc = dstRow.data();
+        }
+
+        EncodeRowF32(dstDataType, pEncodeSrc, pTargetBitmap->GetData() + y * dstRowStride, dstRow.size());
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Bitmap::PremultiplyAlpha()
+{
+    if (!IsOk()) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+    if (mChannelCount != 4) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+
+    for (uint32_t y = 0; y < mHeight; ++y) {
+        char* pRow = mData + y * mRowStride;
+        // clang-format off
+        switch (Bitmap::ChannelDataType(mFormat)) {
+            default: return ppx::ERROR_IMAGE_INVALID_FORMAT;
+            case Bitmap::DATA_TYPE_UINT8  : bitmap_kernels::PremultiplyAlphaRGBA8(reinterpret_cast<uint8_t*>(pRow), mWidth); break;
+            case Bitmap::DATA_TYPE_UINT16 : bitmap_kernels::PremultiplyAlphaRGBA16(reinterpret_cast<uint16_t*>(pRow), mWidth); break;
+            case Bitmap::DATA_TYPE_FLOAT  : bitmap_kernels::PremultiplyAlphaRGBAF32(reinterpret_cast<float*>(pRow), mWidth); break;
+        }
+        // clang-format on
+    }
+
+    return ppx::SUCCESS;
+}
+
+static Result ApplyTransferFunction(Bitmap* pBitmap, bool toLinear)
+{
+    if (!pBitmap->IsOk()) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+
+    const uint32_t channelCount      = pBitmap->GetChannelCount();
+    const uint32_t colorChannelCount = (channelCount == 4) ? 3 : channelCount;
+    const uint32_t width             = pBitmap->GetWidth();
+
+    for (uint32_t y = 0; y < pBitmap->GetHeight(); ++y) {
+        char* pRow = pBitmap->GetData() + y * pBitmap->GetRowStride();
+        switch (Bitmap::ChannelDataType(pBitmap->GetFormat())) {
+            default: return ppx::ERROR_IMAGE_INVALID_FORMAT;
+            case Bitmap::DATA_TYPE_UINT8: {
+                uint8_t* pPixels = reinterpret_cast<uint8_t*>(pRow);
+                if (toLinear) {
+                    bitmap_kernels::SRGBToLinearU8(pPixels, width, channelCount, colorChannelCount);
+                }
+                else {
+                    bitmap_kernels::LinearToSRGBU8(pPixels, width, channelCount, colorChannelCount);
+                }
+            } break;
+            case Bitmap::DATA_TYPE_UINT16: {
+                uint16_t* pPixels = reinterpret_cast<uint16_t*>(pRow);
+                if (toLinear) {
+                    bitmap_kernels::SRGBToLinearU16(pPixels, width, channelCount, colorChannelCount);
+                }
+                else {
+                    bitmap_kernels::LinearToSRGBU16(pPixels, width, channelCount, colorChannelCount);
+                }
+            } break;
+            case Bitmap::DATA_TYPE_FLOAT: {
+                float* pPixels = reinterpret_cast<float*>(pRow);
+                if (toLinear) {
+                    bitmap_kernels::SRGBToLinearF32(pPixels, width, channelCount, colorChannelCount);
+                }
+                else {
+                    bitmap_kernels::LinearToSRGBF32(pPixels, width, channelCount, colorChannelCount);
+                }
+            } break;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Bitmap::ConvertSRGBToLinear()
+{
+    return ApplyTransferFunction(this, true);
+}
+
+Result Bitmap::ConvertLinearToSRGB()
+{
+    return ApplyTransferFunction(this, false);
+}
+
+Result Bitmap::FlipVertical()
+{
+    if (!IsOk()) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+
+    const size_t      rowSize = static_cast<size_t>(mWidth) * mPixelStride;
+    std::vector<char> tmp(rowSize);
+    for (uint32_t y = 0; y < (mHeight / 2); ++y) {
+        char* pTop    = mData + y * mRowStride;
+        char* pBottom = mData + (mHeight - 1 - y) * mRowStride;
+        std::memcpy(tmp.data(), pTop, rowSize);
+        std::memcpy(pTop, pBottom, rowSize);
+        std::memcpy(pBottom, tmp.data(), rowSize);
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Bitmap::FlipHorizontal()
+{
+    if (!IsOk()) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+
+    for (uint32_t y = 0; y < mHeight; ++y) {
+        bitmap_kernels::ReverseRow(mData + y * mRowStride, mWidth, mPixelStride);
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Bitmap::Rotate180()
+{
+    Result ppxres = FlipVertical();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    return FlipHorizontal();
+}
+
+Result Bitmap::Rotate90(bool clockwise, Bitmap* pTargetBitmap) const
+{
+    if (IsNull(pTargetBitmap)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (!IsOk() || !pTargetBitmap->IsOk() || (pTargetBitmap->GetData() == mData)) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+    if (pTargetBitmap->GetFormat() != mFormat) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if ((pTargetBitmap->GetWidth() != mHeight) || (pTargetBitmap->GetHeight() != mWidth)) {
+        return ppx::ERROR_BITMAP_FOOTPRINT_MISMATCH;
+    }
+
+    bitmap_kernels::Rotate90(mData, mRowStride, pTargetBitmap->GetData(), pTargetBitmap->GetRowStride(), mWidth, mHeight, mPixelStride, clockwise);
+
+    return ppx::SUCCESS;
+}
+
 char* Bitmap::GetPixelAddress(uint32_t x, uint32_t y)
 {
     char* pPixel = nullptr;
@@ -0,0 +1,913 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/bitmap_kernels.h"
+#include "ppx/config.h"
+
+#include <cmath>
+#include <limits>
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_BITMAP_KERNELS_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define PPX_TARGET_AVX2
+#   else
+#       define PPX_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_BITMAP_KERNELS_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+namespace bitmap_kernels {
+
+// -------------------------------------------------------------------------------------------------
+// Scalar
+// -------------------------------------------------------------------------------------------------
+
+static const float kInv255   = 1.0f / 255.0f;
+static const float kInv65535 = 1.0f / 65535.0f;
+
+static inline float Saturate(float value)
+{
+    // Written so that NaN saturates to 0, matching the max/min ordering of the SIMD variants.
+    value = (value > 0.0f) ? value : 0.0f;
+    value = (value < 1.0f) ? value : 1.0f;
+    return value;
+}
+
+static void FillRowScalar(void* pDst, size_t byteCount, const uint8_t* pPattern)
+{
+    uint8_t* pBytes = static_cast<uint8_t*>(pDst);
+    while (byteCount >= kFillPatternSize) {
+        std::memcpy(pBytes, pPattern, kFillPatternSize);
+        pBytes += kFillPatternSize;
+        byteCount -= kFillPatternSize;
+    }
+    std::memcpy(pBytes, pPattern, byteCount);
+}
+
+static void ConvertU8ToF32Scalar(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<float>(pSrc[i]) * kInv255;
+    }
+}
+
+static void ConvertF32ToU8Scalar(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<uint8_t>(static_cast<int32_t>(Saturate(pSrc[i]) * 255.0f + 0.5f));
+    }
+}
+
+static void ConvertU16ToF32Scalar(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<float>(pSrc[i]) * kInv65535;
+    }
+}
+
+static void ConvertF32ToU16Scalar(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<uint16_t>(static_cast<int32_t>(Saturate(pSrc[i]) * 65535.0f + 0.5f));
+    }
+}
+
+static void ExpandRGB8ToRGBA8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+        pDst[3] = alpha;
+        pSrc += 3;
+        pDst += 4;
+    }
+}
+
+static inline uint8_t MulDiv255(uint32_t x, uint32_t a)
+{
+    // Exact round(x * a / 255) for 8-bit inputs.
+    uint32_t t = x * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+static void PremultiplyAlphaRGBA8Scalar(uint8_t* pPixels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        uint32_t a = pPixels[3];
+        pPixels[0] = MulDiv255(pPixels[0], a);
+        pPixels[1] = MulDiv255(pPixels[1], a);
+        pPixels[2] = MulDiv255(pPixels[2], a);
+        pPixels += 4;
+    }
+}
+
+static void PremultiplyAlphaRGBAF32Scalar(float* pPixels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        float a    = pPixels[3];
+        pPixels[0] = pPixels[0] * a;
+        pPixels[1] = pPixels[1] * a;
+        pPixels[2] = pPixels[2] * a;
+        pPixels += 4;
+    }
+}
+
+static void Reverse32Scalar(uint32_t* pPixels, size_t pixelCount)
+{
+    std::reverse(pPixels, pPixels + pixelCount);
+}
+
+// -------------------------------------------------------------------------------------------------
+// SSE2
+// -------------------------------------------------------------------------------------------------
+#if defined(PPX_BITMAP_KERNELS_X86)
+
+static void FillRowSSE2(void* pDst, size_t byteCount, const uint8_t* pPattern)
+{
+    const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 0));
+    const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 16));
+    const __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 32));
+    const __m128i p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 48));
+    const __m128i p4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 64));
+    const __m128i p5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPattern + 80));
+
+    uint8_t* pBytes = static_cast<uint8_t*>(pDst);
+    while (byteCount >= kFillPatternSize) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 0), p0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 16), p1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 32), p2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 48), p3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 64), p4);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pBytes + 80), p5);
+        pBytes += kFillPatternSize;
+        byteCount -= kFillPatternSize;
+    }
+    std::memcpy(pBytes, pPattern, byteCount);
+}
+
+static void ConvertU8ToF32SSE2(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128  scale = _mm_set1_ps(kInv255);
+
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128  f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128  f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128  f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128  f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _mm_storeu_ps(pDst + i + 0, _mm_mul_ps(f0, scale));
+        _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(f1, scale));
+        _mm_storeu_ps(pDst + i + 8, _mm_mul_ps(f2, scale));
+        _mm_storeu_ps(pDst + i + 12, _mm_mul_ps(f3, scale));
+    }
+    ConvertU8ToF32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static inline __m128i QuantizeSSE2(__m128 v, __m128 scale)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    v                 = _mm_min_ps(_mm_max_ps(v, zero), one);
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half));
+}
+
+static void ConvertF32ToU8SSE2(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(255.0f);
+
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        __m128i i0 = QuantizeSSE2(_mm_loadu_ps(pSrc + i + 0), scale);
+        __m128i i1 = QuantizeSSE2(_mm_loadu_ps(pSrc + i + 4), scale);
+        __m128i i2 = QuantizeSSE2(_mm_loadu_ps(pSrc + i + 8), scale);
+        __m128i i3 = QuantizeSSE2(_mm_loadu_ps(pSrc + i + 12), scale);
+        __m128i lo = _mm_packs_epi32(i0, i1);
+        __m128i hi = _mm_packs_epi32(i2, i3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(lo, hi));
+    }
+    ConvertF32ToU8Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static void ConvertU16ToF32SSE2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128  scale = _mm_set1_ps(kInv65535);
+
+    size_t i = 0;
+    for (; (i + 8) <= count; i += 8) {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        __m128  f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+        __m128  f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero));
+        _mm_storeu_ps(pDst + i + 0, _mm_mul_ps(f0, scale));
+        _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(f1, scale));
+    }
+    ConvertU16ToF32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static void ConvertF32ToU16SSE2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    // SSE2 has no unsigned 32 -> 16 pack, so bias into signed range and flip the sign bit back.
+    const __m128  scale = _mm_set1_ps(65535.0f);
+    const __m128i bias  = _mm_set1_epi32(32768);
+    const __m128i flip  = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    size_t i = 0;
+    for (; (i + 8) <= count; i += 8) {
+        __m128i i0 = _mm_sub_epi32(QuantizeSSE2(_mm_loadu_ps(pSrc + i + 0), scale), bias);
+        __m128i i1 = _mm_sub_epi32(QuantizeSSE2(_mm_loadu_ps(pSrc + i + 4), scale), bias);
+        __m128i v  = _mm_xor_si128(_mm_packs_epi32(i0, i1), flip);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), v);
+    }
+    ConvertF32ToU16Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static inline __m128i PremultiplyRGBA8x2SSE2(__m128i v, __m128i colorMask, __m128i alphaOne)
+{
+    // v holds two RGBA pixels as 16-bit lanes
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+    a         = _mm_or_si128(_mm_and_si128(a, colorMask), alphaOne);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(v, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static void PremultiplyAlphaRGBA8SSE2(uint8_t* pPixels, size_t pixelCount)
+{
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaOne  = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+    size_t i = 0;
+    for (; (i + 4) <= pixelCount; i += 4) {
+        __m128i* pAddr = reinterpret_cast<__m128i*>(pPixels + 4 * i);
+        __m128i  v     = _mm_loadu_si128(pAddr);
+        __m128i  lo    = PremultiplyRGBA8x2SSE2(_mm_unpacklo_epi8(v, zero), colorMask, alphaOne);
+        __m128i  hi    = PremultiplyRGBA8x2SSE2(_mm_unpackhi_epi8(v, zero), colorMask, alphaOne);
+        _mm_storeu_si128(pAddr, _mm_packus_epi16(lo, hi));
+    }
+    PremultiplyAlphaRGBA8Scalar(pPixels + 4 * i, pixelCount - i);
+}
+
+static void PremultiplyAlphaRGBAF32SSE2(float* pPixels, size_t pixelCount)
+{
+    const __m128 alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    for (size_t i = 0; i < pixelCount; ++i) {
+        float* pAddr = pPixels + 4 * i;
+        __m128 v     = _mm_loadu_ps(pAddr);
+        __m128 m     = _mm_mul_ps(v, _mm_shuffle_ps(v, v, 0xFF));
+        _mm_storeu_ps(pAddr, _mm_or_ps(_mm_and_ps(alphaMask, v), _mm_andnot_ps(alphaMask, m)));
+    }
+}
+
+static void Reverse32SSE2(uint32_t* pPixels, size_t pixelCount)
+{
+    size_t i = 0;
+    size_t j = pixelCount;
+    for (; (j - i) >= 8; i += 4, j -= 4) {
+        __m128i* pFront = reinterpret_cast<__m128i*>(pPixels + i);
+        __m128i* pBack  = reinterpret_cast<__m128i*>(pPixels + j - 4);
+        __m128i  front  = _mm_loadu_si128(pFront);
+        __m128i  back   = _mm_loadu_si128(pBack);
+        _mm_storeu_si128(pFront, _mm_shuffle_epi32(back, 0x1B));
+        _mm_storeu_si128(pBack, _mm_shuffle_epi32(front, 0x1B));
+    }
+    Reverse32Scalar(pPixels + i, j - i);
+}
+
+// -------------------------------------------------------------------------------------------------
+// AVX2
+// -------------------------------------------------------------------------------------------------
+
+PPX_TARGET_AVX2 static void FillRowAVX2(void* pDst, size_t byteCount, const uint8_t* pPattern)
+{
+    const __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPattern + 0));
+    const __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPattern + 32));
+    const __m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPattern + 64));
+
+    uint8_t* pBytes = static_cast<uint8_t*>(pDst);
+    while (byteCount >= kFillPatternSize) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pBytes + 0), p0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pBytes + 32), p1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pBytes + 64), p2);
+        pBytes += kFillPatternSize;
+        byteCount -= kFillPatternSize;
+    }
+    std::memcpy(pBytes, pPattern, byteCount);
+}
+
+PPX_TARGET_AVX2 static void ConvertU8ToF32AVX2(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(kInv255);
+
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        __m256i i0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + i + 0)));
+        __m256i i1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + i + 8)));
+        _mm256_storeu_ps(pDst + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(i0), scale));
+        _mm256_storeu_ps(pDst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(i1), scale));
+    }
+    ConvertU8ToF32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+PPX_TARGET_AVX2 static inline __m256i QuantizeAVX2(__m256 v, __m256 scale)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    v                 = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+    return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+}
+
+PPX_TARGET_AVX2 static void ConvertF32ToU8AVX2(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const __m256  scale = _mm256_set1_ps(255.0f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    size_t i = 0;
+    for (; (i + 32) <= count; i += 32) {
+        __m256i i0 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 0), scale);
+        __m256i i1 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 8), scale);
+        __m256i i2 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 16), scale);
+        __m256i i3 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 24), scale);
+        // Packs operate per 128-bit lane, the permute restores linear order.
+        __m256i v = _mm256_packus_epi16(_mm256_packs_epi32(i0, i1), _mm256_packs_epi32(i2, i3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), _mm256_permutevar8x32_epi32(v, order));
+    }
+    ConvertF32ToU8Scalar(pSrc + i, pDst + i, count - i);
+}
+
+PPX_TARGET_AVX2 static void ConvertU16ToF32AVX2(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(kInv65535);
+
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        __m256i i0 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 0)));
+        __m256i i1 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 8)));
+        _mm256_storeu_ps(pDst + i + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(i0), scale));
+        _mm256_storeu_ps(pDst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(i1), scale));
+    }
+    ConvertU16ToF32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+PPX_TARGET_AVX2 static void ConvertF32ToU16AVX2(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(65535.0f);
+
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        __m256i i0 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 0), scale);
+        __m256i i1 = QuantizeAVX2(_mm256_loadu_ps(pSrc + i + 8), scale);
+        __m256i v  = _mm256_permute4x64_epi64(_mm256_packus_epi32(i0, i1), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), v);
+    }
+    ConvertF32ToU16Scalar(pSrc + i, pDst + i, count - i);
+}
+
+PPX_TARGET_AVX2 static void ExpandRGB8ToRGBA8AVX2(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaV  = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(alpha) << 24));
+
+    // Each step reads 16 bytes but only consumes 12, so keep 6 pixels of
+    // headroom to never read past the end of the source row.
+    size_t i = 0;
+    for (; (i + 6) <= pixelCount; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 3 * i));
+        v         = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alphaV);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4 * i), v);
+    }
+    ExpandRGB8ToRGBA8Scalar(pSrc + 3 * i, pDst + 4 * i, pixelCount - i, alpha);
+}
+
+PPX_TARGET_AVX2 static void PremultiplyAlphaRGBA8AVX2(uint8_t* pPixels, size_t pixelCount)
+{
+    const __m256i zero      = _mm256_setzero_si256();
+    const __m256i colorMask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+    const __m256i alphaOne  = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    const __m256i round     = _mm256_set1_epi16(128);
+
+    size_t i = 0;
+    for (; (i + 8) <= pixelCount; i += 8) {
+        __m256i* pAddr = reinterpret_cast<__m256i*>(pPixels + 4 * i);
+        __m256i  v     = _mm256_loadu_si256(pAddr);
+        __m256i  r[2]  = {_mm256_unpacklo_epi8(v, zero), _mm256_unpackhi_epi8(v, zero)};
+        for (uint32_t k = 0; k < 2; ++k) {
+            __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(r[k], 0xFF), 0xFF);
+            a         = _mm256_or_si256(_mm256_and_si256(a, colorMask), alphaOne);
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(r[k], a), round);
+            r[k]      = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+        }
+        _mm256_storeu_si256(pAddr, _mm256_packus_epi16(r[0], r[1]));
+    }
+    PremultiplyAlphaRGBA8Scalar(pPixels + 4 * i, pixelCount - i);
+}
+
+PPX_TARGET_AVX2 static void PremultiplyAlphaRGBAF32AVX2(float* pPixels, size_t pixelCount)
+{
+    size_t i = 0;
+    for (; (i + 2) <= pixelCount; i += 2) {
+        float* pAddr = pPixels + 4 * i;
+        __m256 v     = _mm256_loadu_ps(pAddr);
+        __m256 m     = _mm256_mul_ps(v, _mm256_permute_ps(v, 0xFF));
+        _mm256_storeu_ps(pAddr, _mm256_blend_ps(m, v, 0x88));
+    }
+    PremultiplyAlphaRGBAF32Scalar(pPixels + 4 * i, pixelCount - i);
+}
+
+PPX_TARGET_AVX2 static void Reverse32AVX2(uint32_t* pPixels, size_t pixelCount)
+{
+    const __m256i order = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    size_t i = 0;
+    size_t j = pixelCount;
+    for (; (j - i) >= 16; i += 8, j -= 8) {
+        __m256i* pFront = reinterpret_cast<__m256i*>(pPixels + i);
+        __m256i* pBack  = reinterpret_cast<__m256i*>(pPixels + j - 8);
+        __m256i  front  = _mm256_loadu_si256(pFront);
+        __m256i  back   = _mm256_loadu_si256(pBack);
+        _mm256_storeu_si256(pFront, _mm256_permutevar8x32_epi32(back, order));
+        _mm256_storeu_si256(pBack, _mm256_permutevar8x32_epi32(front, order));
+    }
+    Reverse32Scalar(pPixels + i, j - i);
+}
+
+#endif // defined(PPX_BITMAP_KERNELS_X86)
+
+// -------------------------------------------------------------------------------------------------
+// NEON
+// -------------------------------------------------------------------------------------------------
+#if defined(PPX_BITMAP_KERNELS_NEON)
+
+static void FillRowNEON(void* pDst, size_t byteCount, const uint8_t* pPattern)
+{
+    const uint8x16_t p0 = vld1q_u8(pPattern + 0);
+    const uint8x16_t p1 = vld1q_u8(pPattern + 16);
+    const uint8x16_t p2 = vld1q_u8(pPattern + 32);
+    const uint8x16_t p3 = vld1q_u8(pPattern + 48);
+    const uint8x16_t p4 = vld1q_u8(pPattern + 64);
+    const uint8x16_t p5 = vld1q_u8(pPattern + 80);
+
+    uint8_t* pBytes = static_cast<uint8_t*>(pDst);
+    while (byteCount >= kFillPatternSize) {
+        vst1q_u8(pBytes + 0, p0);
+        vst1q_u8(pBytes + 16, p1);
+        vst1q_u8(pBytes + 32, p2);
+        vst1q_u8(pBytes + 48, p3);
+        vst1q_u8(pBytes + 64, p4);
+        vst1q_u8(pBytes + 80, p5);
+        pBytes += kFillPatternSize;
+        byteCount -= kFillPatternSize;
+    }
+    std::memcpy(pBytes, pPattern, byteCount);
+}
+
+static void ConvertU8ToF32NEON(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        uint8x16_t v  = vld1q_u8(pSrc + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_f32(pDst + i + 0, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), kInv255));
+        vst1q_f32(pDst + i + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), kInv255));
+        vst1q_f32(pDst + i + 8, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), kInv255));
+        vst1q_f32(pDst + i + 12, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), kInv255));
+    }
+    ConvertU8ToF32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static inline uint32x4_t QuantizeNEON(float32x4_t v, float scale)
+{
+    // Compare-and-select instead of vmax/vmin so that NaN saturates to 0 like the scalar path.
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one  = vdupq_n_f32(1.0f);
+    v                      = vbslq_f32(vcgtq_f32(v, zero), v, zero);
+    v                      = vbslq_f32(vcltq_f32(v, one), v, one);
+    return vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(v, scale), vdupq_n_f32(0.5f)));
+}
+
+static void ConvertF32ToU8NEON(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; (i + 16) <= count; i += 16) {
+        uint16x4_t q0 = vmovn_u32(QuantizeNEON(vld1q_f32(pSrc + i + 0), 255.0f));
+        uint16x4_t q1 = vmovn_u32(QuantizeNEON(vld1q_f32(pSrc + i + 4), 255.0f));
+        uint16x4_t q2 = vmovn_u32(QuantizeNEON(vld1q_f32(pSrc + i + 8), 255.0f));
+        uint16x4_t q3 = vmovn_u32(QuantizeNEON(vld1q_f32(pSrc + i + 12), 255.0f));
+        uint8x8_t  lo = vmovn_u16(vcombine_u16(q0, q1));
+        uint8x8_t  hi = vmovn_u16(vcombine_u16(q2, q3));
+        vst1q_u8(pDst + i, vcombine_u8(lo, hi));
+    }
+    ConvertF32ToU8Scalar(pSrc + i, pDst + i, count - i);
+}
+
+static void PremultiplyAlphaRGBAF32NEON(float* pPixels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        float*      pAddr = pPixels + 4 * i;
+        float32x4_t v     = vld1q_f32(pAddr);
+        float32x4_t m     = vmulq_n_f32(v, vgetq_lane_f32(v, 3));
+        vst1q_f32(pAddr, vsetq_lane_f32(vgetq_lane_f32(v, 3), m, 3));
+    }
+}
+
+#endif // defined(PPX_BITMAP_KERNELS_NEON)
+
+// -------------------------------------------------------------------------------------------------
+// Dispatch
+// -------------------------------------------------------------------------------------------------
+
+struct KernelTable
+{
+    void (*fillRow)(void*, size_t, const uint8_t*);
+    void (*convertU8ToF32)(const uint8_t*, float*, size_t);
+    void (*convertF32ToU8)(const float*, uint8_t*, size_t);
+    void (*convertU16ToF32)(const uint16_t*, float*, size_t);
+    void (*convertF32ToU16)(const float*, uint16_t*, size_t);
+    void (*expandRGB8ToRGBA8)(const uint8_t*, uint8_t*, size_t, uint8_t);
+    void (*premultiplyAlphaRGBA8)(uint8_t*, size_t);
+    void (*premultiplyAlphaRGBAF32)(float*, size_t);
+    void (*reverse32)(uint32_t*, size_t);
+};
+
+// clang-format off
+static const KernelTable kScalarKernels = {
+    FillRowScalar,
+    ConvertU8ToF32Scalar,
+    ConvertF32ToU8Scalar,
+    ConvertU16ToF32Scalar,
+    ConvertF32ToU16Scalar,
+    ExpandRGB8ToRGBA8Scalar,
+    PremultiplyAlphaRGBA8Scalar,
+    PremultiplyAlphaRGBAF32Scalar,
+    Reverse32Scalar,
+};
+
+#if defined(PPX_BITMAP_KERNELS_X86)
+static const KernelTable kSSE2Kernels = {
+    FillRowSSE2,
+    ConvertU8ToF32SSE2,
+    ConvertF32ToU8SSE2,
+    ConvertU16ToF32SSE2,
+    ConvertF32ToU16SSE2,
+    ExpandRGB8ToRGBA8Scalar, // pshufb needs SSSE3
+    PremultiplyAlphaRGBA8SSE2,
+    PremultiplyAlphaRGBAF32SSE2,
+    Reverse32SSE2,
+};
+
+static const KernelTable kAVX2Kernels = {
+    FillRowAVX2,
+    ConvertU8ToF32AVX2,
+    ConvertF32ToU8AVX2,
+    ConvertU16ToF32AVX2,
+    ConvertF32ToU16AVX2,
+    ExpandRGB8ToRGBA8AVX2,
+    PremultiplyAlphaRGBA8AVX2,
+    PremultiplyAlphaRGBAF32AVX2,
+    Reverse32AVX2,
+};
+#endif
+
+#if defined(PPX_BITMAP_KERNELS_NEON)
+static const KernelTable kNEONKernels = {
+    FillRowNEON,
+    ConvertU8ToF32NEON,
+    ConvertF32ToU8NEON,
+    ConvertU16ToF32Scalar,
+    ConvertF32ToU16Scalar,
+    ExpandRGB8ToRGBA8Scalar,
+    PremultiplyAlphaRGBA8Scalar,
+    PremultiplyAlphaRGBAF32NEON,
+    Reverse32Scalar,
+};
+#endif
+// clang-format on
+
+static const KernelTable* GetKernelTable(InstructionSet value)
+{
+    switch (value) {
+        default: break;
+#if defined(PPX_BITMAP_KERNELS_X86)
+        case INSTRUCTION_SET_SSE2: return &kSSE2Kernels;
+        case INSTRUCTION_SET_AVX2: return &kAVX2Kernels;
+#endif
+#if defined(PPX_BITMAP_KERNELS_NEON)
+        case INSTRUCTION_SET_NEON: return &kNEONKernels;
+#endif
+    }
+    return &kScalarKernels;
+}
+
+struct Dispatch
+{
+    InstructionSet     instructionSet = INSTRUCTION_SET_SCALAR;
+    const KernelTable* pKernels       = &kScalarKernels;
+};
+
+static Dispatch& GetDispatch()
+{
+    static Dispatch sDispatch = []() {
+        Dispatch dispatch;
+        dispatch.instructionSet = GetBestInstructionSet();
+        dispatch.pKernels       = GetKernelTable(dispatch.instructionSet);
+        return dispatch;
+    }();
+    return sDispatch;
+}
+
+static const KernelTable& Kernels()
+{
+    return *GetDispatch().pKernels;
+}
+
+InstructionSet GetInstructionSet()
+{
+    return GetDispatch().instructionSet;
+}
+
+bool SetInstructionSet(InstructionSet value)
+{
+    if (!IsSupported(value)) {
+        return false;
+    }
+    Dispatch& dispatch      = GetDispatch();
+    dispatch.instructionSet = value;
+    dispatch.pKernels       = GetKernelTable(value);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Kernels
+// -------------------------------------------------------------------------------------------------
+
+void BuildFillPattern(const void* pPixel, uint32_t pixelSize, uint8_t* pPattern)
+{
+    PPX_ASSERT_MSG((pixelSize > 0) && ((kFillPatternSize % pixelSize) == 0), "pixel size must divide the fill pattern size");
+    for (uint32_t offset = 0; offset < kFillPatternSize; offset += pixelSize) {
+        std::memcpy(pPattern + offset, pPixel, pixelSize);
+    }
+}
+
+void FillRow(void* pDst, size_t byteCount, const uint8_t* pPattern)
+{
+    Kernels().fillRow(pDst, byteCount, pPattern);
+}
+
+void ConvertU8ToF32(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    Kernels().convertU8ToF32(pSrc, pDst, count);
+}
+
+void ConvertF32ToU8(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    Kernels().convertF32ToU8(pSrc, pDst, count);
+}
+
+void ConvertU16ToF32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    Kernels().convertU16ToF32(pSrc, pDst, count);
+}
+
+void ConvertF32ToU16(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    Kernels().convertF32ToU16(pSrc, pDst, count);
+}
+
+void ConvertU32ToF32(const uint32_t* pSrc, float* pDst, size_t count)
+{
+    // Float can't represent all 32-bit values, go through double for the scale.
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<float>(static_cast<double>(pSrc[i]) / 4294967295.0);
+    }
+}
+
+void ConvertF32ToU32(const float* pSrc, uint32_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        pDst[i] = static_cast<uint32_t>(static_cast<double>(Saturate(pSrc[i])) * 4294967295.0 + 0.5);
+    }
+}
+
+void ExpandRGB8ToRGBA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, uint8_t alpha)
+{
+    Kernels().expandRGB8ToRGBA8(pSrc, pDst, pixelCount, alpha);
+}
+
+void SwizzleChannelsF32(const float* pSrc, uint32_t srcChannelCount, float* pDst, uint32_t dstChannelCount, size_t pixelCount)
+{
+    PPX_ASSERT_MSG((srcChannelCount >= 1) && (srcChannelCount <= 4), "invalid source channel count");
+    PPX_ASSERT_MSG((dstChannelCount >= 1) && (dstChannelCount <= 4), "invalid destination channel count");
+
+    const float defaults[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (uint32_t c = 0; c < dstChannelCount; ++c) {
+            pDst[c] = (c < srcChannelCount) ? pSrc[c] : defaults[c];
+        }
+        pSrc += srcChannelCount;
+        pDst += dstChannelCount;
+    }
+}
+
+void PremultiplyAlphaRGBA8(uint8_t* pPixels, size_t pixelCount)
+{
+    Kernels().premultiplyAlphaRGBA8(pPixels, pixelCount);
+}
+
+void PremultiplyAlphaRGBA16(uint16_t* pPixels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        uint64_t a = pPixels[3];
+        for (uint32_t c = 0; c < 3; ++c) {
+            pPixels[c] = static_cast<uint16_t>((pPixels[c] * a + 32767) / 65535);
+        }
+        pPixels += 4;
+    }
+}
+
+void PremultiplyAlphaRGBAF32(float* pPixels, size_t pixelCount)
+{
+    Kernels().premultiplyAlphaRGBAF32(pPixels, pixelCount);
+}
+
+static double SRGBToLinear(double value)
+{
+    return (value <= 0.04045) ? (value / 12.92) : std::pow((value + 0.055) / 1.055, 2.4);
+}
+
+static double LinearToSRGB(double value)
+{
+    return (value <= 0.0031308) ? (value * 12.92) : (1.055 * std::pow(value, 1.0 / 2.4) - 0.055);
+}
+
+// Integer formats go through lookup tables built once on first use.
+template <typename T>
+static std::vector<T> BuildTransferTable(double (*pfnTransfer)(double))
+{
+    const size_t   count = static_cast<size_t>(std::numeric_limits<T>::max()) + 1;
+    const double   scale = static_cast<double>(std::numeric_limits<T>::max());
+    std::vector<T> table(count);
+    for (size_t i = 0; i < count; ++i) {
+        table[i] = static_cast<T>(pfnTransfer(static_cast<double>(i) / scale) * scale + 0.5);
+    }
+    return table;
+}
+
+template <typename T>
+static void ApplyTable(const std::vector<T>& table, T* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (uint32_t c = 0; c < colorChannelCount; ++c) {
+            pPixels[c] = table[pPixels[c]];
+        }
+        pPixels += channelCount;
+    }
+}
+
+void SRGBToLinearU8(uint8_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    static const std::vector<uint8_t> sTable = BuildTransferTable<uint8_t>(SRGBToLinear);
+    ApplyTable(sTable, pPixels, pixelCount, channelCount, colorChannelCount);
+}
+
+void LinearToSRGBU8(uint8_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    static const std::vector<uint8_t> sTable = BuildTransferTable<uint8_t>(LinearToSRGB);
+    ApplyTable(sTable, pPixels, pixelCount, channelCount, colorChannelCount);
+}
+
+void SRGBToLinearU16(uint16_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    static const std::vector<uint16_t> sTable = BuildTransferTable<uint16_t>(SRGBToLinear);
+    ApplyTable(sTable, pPixels, pixelCount, channelCount, colorChannelCount);
+}
+
+void LinearToSRGBU16(uint16_t* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    static const std::vector<uint16_t> sTable = BuildTransferTable<uint16_t>(LinearToSRGB);
+    ApplyTable(sTable, pPixels, pixelCount, channelCount, colorChannelCount);
+}
+
+void SRGBToLinearF32(float* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (uint32_t c = 0; c < colorChannelCount; ++c) {
+            pPixels[c] = static_cast<float>(SRGBToLinear(pPixels[c]));
+        }
+        pPixels += channelCount;
+    }
+}
+
+void LinearToSRGBF32(float* pPixels, size_t pixelCount, uint32_t channelCount, uint32_t colorChannelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i) {
+        for (uint32_t c = 0; c < colorChannelCount; ++c) {
+            pPixels[c] = static_cast<float>(LinearToSRGB(pPixels[c]));
+        }
+        pPixels += channelCount;
+    }
+}
+
+template <uint32_t PixelSize>
+static void ReverseRowT(uint8_t* pPixels, size_t pixelCount)
+{
+    uint8_t* pFront = pPixels;
+    uint8_t* pBack  = pPixels + (pixelCount - 1) * PixelSize;
+    uint8_t  tmp[PixelSize];
+    for (; pFront < pBack; pFront += PixelSize, pBack -= PixelSize) {
+        std::memcpy(tmp, pFront, PixelSize);
+        std::memcpy(pFront, pBack, PixelSize);
+        std::memcpy(pBack, tmp, PixelSize);
+    }
+}
+
+void ReverseRow(void* pPixels, size_t pixelCount, uint32_t pixelSize)
+{
+    if (pixelCount < 2) {
+        return;
+    }
+
+    uint8_t* pBytes = static_cast<uint8_t*>(pPixels);
+    // clang-format off
+    switch (pixelSize) {
+        default: PPX_ASSERT_MSG(false, "unsupported pixel size: " << pixelSize); break;
+        case 1  : ReverseRowT<1>(pBytes, pixelCount); break;
+        case 2  : ReverseRowT<2>(pBytes, pixelCount); break;
+        case 3  : ReverseRowT<3>(pBytes, pixelCount); break;
+        case 4  : Kernels().reverse32(reinterpret_cast<uint32_t*>(pBytes), pixelCount); break;
+        case 6  : ReverseRowT<6>(pBytes, pixelCount); break;
+        case 8  : ReverseRowT<8>(pBytes, pixelCount); break;
+        case 12 : ReverseRowT<12>(pBytes, pixelCount); break;
+        case 16 : ReverseRowT<16>(pBytes, pixelCount); break;
+    }
+    // clang-format on
+}
+
+// Rotation walks the source in square tiles so that both the reads and the
+// transposed writes stay within a handful of cache lines.
+template <uint32_t PixelSize>
+static void Rotate90T(const uint8_t* pSrc, uint32_t srcRowStride, uint8_t* pDst, uint32_t dstRowStride, uint32_t width, uint32_t height, bool clockwise)
+{
+    const uint32_t kTileSize = 32;
+    for (uint32_t ty = 0; ty < height; ty += kTileSize) {
+        const uint32_t yEnd = std::min(ty + kTileSize, height);
+        for (uint32_t tx = 0; tx < width; tx += kTileSize) {
+            const uint32_t xEnd = std::min(tx + kTileSize, width);
+            for (uint32_t y = ty; y < yEnd; ++y) {
+                const uint8_t* pSrcRow = pSrc + static_cast<size_t>(y) * srcRowStride;
+                for (uint32_t x = tx; x < xEnd; ++x) {
+                    // Clockwise: (x, y) -> (height - 1 - y, x), counter-clockwise: (x, y) -> (y, width - 1 - x)
+                    uint32_t dx = clockwise ? (height - 1 - y) : y;
+                    uint32_t dy = clockwise ? x : (width - 1 - x);
+                    std::memcpy(pDst + static_cast<size_t>(dy) * dstRowStride + static_cast<size_t>(dx) * PixelSize, pSrcRow + static_cast<size_t>(x) * PixelSize, PixelSize);
+                }
+            }
+        }
+    }
+}
+
+void Rotate90(const void* pSrc, uint32_t srcRowStride, void* pDst, uint32_t dstRowStride, uint32_t width, uint32_t height, uint32_t pixelSize, bool clockwise)
+{
+    const uint8_t* pSrcBytes = static_cast<const uint8_t*>(pSrc);
+    uint8_t*       pDstBytes = static_cast<uint8_t*>(pDst);
+    // clang-format off
+    switch (pixelSize) {
+        default: PPX_ASSERT_MSG(false, "unsupported pixel size: " << pixelSize); break;
+        case 1  : Rotate90T<1>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 2  : Rotate90T<2>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 3  : Rotate90T<3>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 4  : Rotate90T<4>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 6  : Rotate90T<6>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 8  : Rotate90T<8>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 12 : Rotate90T<12>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+        case 16 : Rotate90T<16>(pSrcBytes, srcRowStride, pDstBytes, dstRowStride, width, height, clockwise); break;
+    }
+    // clang-format on
+}
+
+} // namespace bitmap_kernels
+} // namespace ppx
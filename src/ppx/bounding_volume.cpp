@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "ppx/bounding_volume.h"
+#include "ppx/math_kernels.h"
 
 namespace ppx {
 
@@ -43,14 +44,17 @@ void AABB::Set(const OBB& obb)
 
 void AABB::Transform(const float4x4& matrix, float3 obbVertices[8]) const
 {
-    obbVertices[0] = matrix * float4(mMin.x, mMax.y, mMin.z, 1.0f);
-    obbVertices[1] = matrix * float4(mMin.x, mMin.y, mMin.z, 1.0f);
-    obbVertices[2] = matrix * float4(mMax.x, mMin.y, mMin.z, 1.0f);
-    obbVertices[3] = matrix * float4(mMax.x, mMax.y, mMin.z, 1.0f);
-    obbVertices[4] = matrix * float4(mMin.x, mMax.y, mMax.z, 1.0f);
-    obbVertices[5] = matrix * float4(mMin.x, mMin.y, mMax.z, 1.0f);
-    obbVertices[6] = matrix * float4(mMax.x, mMin.y, mMax.z, 1.0f);
-    obbVertices[7] = matrix * float4(mMax.x, mMax.y, mMax.z, 1.0f);
+    const float3 corners[8] = {
+        float3(mMin.x, mMax.y, mMin.z),
+        float3(mMin.x, mMin.y, mMin.z),
+        float3(mMax.x, mMin.y, mMin.z),
+        float3(mMax.x, mMax.y, mMin.z),
+        float3(mMin.x, mMax.y, mMax.z),
+        float3(mMin.x, mMin.y, mMax.z),
+        float3(mMax.x, mMin.y, mMax.z),
+        float3(mMax.x, mMax.y, mMax.z),
+    };
+    math_kernels::TransformPoints(matrix, corners, obbVertices, 8);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -79,11 +83,11 @@ void OBB::GetPoints(float3 obbVertices[8]) const
     obbVertices[0] = mCenter - u + v - w;
     obbVertices[1] = mCenter - u - v - w;
     obbVertices[2] = mCenter + u - v - w;
-    obbVertices[3] = mCenter + w + v - w;
+    obbVertices[3] = mCenter + u + v - w;
     obbVertices[4] = mCenter - u + v + w;
     obbVertices[5] = mCenter - u - v + w;
     obbVertices[6] = mCenter + u - v + w;
-    obbVertices[7] = mCenter + w + v + w;
+    obbVertices[7] = mCenter + u + v + w;
 }
 
 } // namespace ppx
@@ -0,0 +1,887 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/bvh.h"
+#include "ppx/parallel.h"
+#include "ppx/timer.h"
+#include "ppx/tri_mesh.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_BVH_X86
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_BVH_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+
+static const uint32_t kInvalidIndex = UINT32_MAX;
+
+// Number of bins the SAH split is searched in, per axis
+static const uint32_t kBinCount = 16;
+
+// Ranges deeper than this become leaves, which bounds the traversal stack:
+// each node pops one entry and pushes at most 4
+static const uint32_t kMaxDepth  = 64;
+static const uint32_t kStackSize = 4 * kMaxDepth;
+
+// Cost of visiting a node relative to testing a primitive
+static const float kTraversalCost = 1.0f;
+
+// Smallest subtree that is worth building on its own thread
+static const uint32_t kMinTaskSize = 1024;
+
+// Primitives per ParallelFor() index when computing bounds
+static const uint32_t kBoundsChunkSize = 4096;
+
+namespace {
+
+struct Bounds
+{
+    float3 min = float3(FLT_MAX);
+    float3 max = float3(-FLT_MAX);
+
+    void Grow(const float3& p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void Grow(const Bounds& b)
+    {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+    }
+
+    void Grow(const AABB& b)
+    {
+        min = glm::min(min, b.GetMin());
+        max = glm::max(max, b.GetMax());
+    }
+
+    float GetSurfaceArea() const
+    {
+        if (min.x > max.x) {
+            return 0.0f;
+        }
+        float3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+};
+
+struct Bin
+{
+    Bounds   bounds;
+    uint32_t count = 0;
+};
+
+// Ray data shared by every node test
+struct RayData
+{
+    float3 origin;
+    float3 invDirection;
+    bool   negative[3];
+    float  tMin;
+};
+
+RayData PrepareRay(const Ray& ray)
+{
+    RayData rd      = {};
+    rd.origin       = ray.origin;
+    rd.invDirection = float3(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    rd.negative[0]  = std::signbit(rd.invDirection.x);
+    rd.negative[1]  = std::signbit(rd.invDirection.y);
+    rd.negative[2]  = std::signbit(rd.invDirection.z);
+    rd.tMin         = ray.tMin;
+    return rd;
+}
+
+// Slab test with the near and far planes picked from the ray direction, so
+// the empty bounds of unused children (min > max) never hit. A zero
+// direction component can produce NaN, which the compares below always
+// resolve to the running value.
+inline bool IntersectBox(const float3& boxMin, const float3& boxMax, const RayData& rd, float tMax, float* pEnter)
+{
+    float tEnter = rd.tMin;
+    float tExit  = tMax;
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        float tNear = ((rd.negative[axis] ? boxMax[axis] : boxMin[axis]) - rd.origin[axis]) * rd.invDirection[axis];
+        float tFar  = ((rd.negative[axis] ? boxMin[axis] : boxMax[axis]) - rd.origin[axis]) * rd.invDirection[axis];
+        tEnter      = (tNear > tEnter) ? tNear : tEnter;
+        tExit       = (tFar < tExit) ? tFar : tExit;
+    }
+    *pEnter = tEnter;
+    return tEnter <= tExit;
+}
+
+} // namespace
+
+struct Bvh::BuildNode
+{
+    Bounds   bounds;
+    uint32_t left  = kInvalidIndex;
+    uint32_t right = kInvalidIndex;
+    uint32_t first = 0;
+    uint32_t count = 0;
+
+    bool IsLeaf() const { return count > 0; }
+};
+
+struct Bvh::BuildTask
+{
+    uint32_t nodeIndex = 0;
+    uint32_t first     = 0;
+    uint32_t count     = 0;
+    uint32_t depth     = 0;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Node kernels
+// -------------------------------------------------------------------------------------------------
+// Tests a ray against the 4 children of a node. Returns a mask of the
+// children that are hit and writes where the ray enters each of them.
+template <InstructionSet IS>
+static uint32_t IntersectChildren(const float* pMin, const float* pMax, const RayData& rd, float tMax, float* pEnter)
+{
+    // pMin/pMax point at minX/maxX of a node, Y and Z follow 4 floats apart
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        float3 boxMin = float3(pMin[i], pMin[4 + i], pMin[8 + i]);
+        float3 boxMax = float3(pMax[i], pMax[4 + i], pMax[8 + i]);
+        if (IntersectBox(boxMin, boxMax, rd, tMax, &pEnter[i])) {
+            mask |= (1u << i);
+        }
+    }
+    return mask;
+}
+
+#if defined(PPX_BVH_X86)
+template <>
+uint32_t IntersectChildren<INSTRUCTION_SET_SSE2>(const float* pMin, const float* pMax, const RayData& rd, float tMax, float* pEnter)
+{
+    __m128 tEnter = _mm_set1_ps(rd.tMin);
+    __m128 tExit  = _mm_set1_ps(tMax);
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        const float* pNear = rd.negative[axis] ? pMax : pMin;
+        const float* pFar  = rd.negative[axis] ? pMin : pMax;
+        __m128       o     = _mm_set1_ps(rd.origin[axis]);
+        __m128       inv   = _mm_set1_ps(rd.invDirection[axis]);
+        __m128       tNear = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(pNear + 4 * axis), o), inv);
+        __m128       tFar  = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(pFar + 4 * axis), o), inv);
+        // Returns the second operand if either is NaN
+        tEnter = _mm_max_ps(tNear, tEnter);
+        tExit  = _mm_min_ps(tFar, tExit);
+    }
+    _mm_storeu_ps(pEnter, tEnter);
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tEnter, tExit)));
+}
+#endif
+
+#if defined(PPX_BVH_NEON)
+template <>
+uint32_t IntersectChildren<INSTRUCTION_SET_NEON>(const float* pMin, const float* pMax, const RayData& rd, float tMax, float* pEnter)
+{
+    float32x4_t tEnter = vdupq_n_f32(rd.tMin);
+    float32x4_t tExit  = vdupq_n_f32(tMax);
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        const float* pNear = rd.negative[axis] ? pMax : pMin;
+        const float* pFar  = rd.negative[axis] ? pMin : pMax;
+        float32x4_t  o     = vdupq_n_f32(rd.origin[axis]);
+        float32x4_t  inv   = vdupq_n_f32(rd.invDirection[axis]);
+        float32x4_t  tNear = vmulq_f32(vsubq_f32(vld1q_f32(pNear + 4 * axis), o), inv);
+        float32x4_t  tFar  = vmulq_f32(vsubq_f32(vld1q_f32(pFar + 4 * axis), o), inv);
+        // vmaxq/vminq propagate NaN, select on compares instead like the other variants
+        tEnter = vbslq_f32(vcgtq_f32(tNear, tEnter), tNear, tEnter);
+        tExit  = vbslq_f32(vcltq_f32(tFar, tExit), tFar, tExit);
+    }
+    vst1q_f32(pEnter, tEnter);
+
+    static const uint32_t kBits[4] = {1, 2, 4, 8};
+    uint32x4_t            hit      = vandq_u32(vcleq_f32(tEnter, tExit), vld1q_u32(kBits));
+    return vaddvq_u32(hit);
+}
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// Bvh
+// -------------------------------------------------------------------------------------------------
+// Nodes have 4 children, so SSE2 is the widest traversal on x86
+static InstructionSet GetBestTraversalInstructionSet()
+{
+    const InstructionSet best = GetBestInstructionSet();
+    return (best == INSTRUCTION_SET_AVX2) ? INSTRUCTION_SET_SSE2 : best;
+}
+
+Bvh::Bvh()
+    : mInstructionSet(GetBestTraversalInstructionSet())
+{
+}
+
+bool Bvh::SetInstructionSet(InstructionSet value)
+{
+    if ((value == INSTRUCTION_SET_AVX2) || !IsSupported(value)) {
+        return false;
+    }
+    mInstructionSet = value;
+    return true;
+}
+
+Result Bvh::Build(const TriMesh& mesh)
+{
+    const uint32_t triangleCount = mesh.GetCountTriangles();
+    if (mesh.GetIndexType() == grfx::INDEX_TYPE_UNDEFINED) {
+        return Build(mesh.GetCountPositions(), mesh.GetDataPositions(), triangleCount, nullptr);
+    }
+
+    std::vector<uint32_t> indices(3 * triangleCount);
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+        Result ppxres = mesh.GetTriangle(i, indices[3 * i + 0], indices[3 * i + 1], indices[3 * i + 2]);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    return Build(mesh.GetCountPositions(), mesh.GetDataPositions(), triangleCount, indices.data());
+}
+
+Result Bvh::Build(uint32_t vertexCount, const float3* pPositions, uint32_t triangleCount, const uint32_t* pIndices)
+{
+    if (IsNull(pPositions) && (vertexCount > 0)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (IsNull(pIndices) && (3 * static_cast<uint64_t>(triangleCount) > vertexCount)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+    if (!IsNull(pIndices)) {
+        for (uint64_t i = 0; i < 3 * static_cast<uint64_t>(triangleCount); ++i) {
+            if (pIndices[i] >= vertexCount) {
+                return ppx::ERROR_OUT_OF_RANGE;
+            }
+        }
+    }
+
+    Clear();
+    mPrimitiveType = PRIMITIVE_TYPE_TRIANGLE;
+    mPositions.assign(pPositions, pPositions + vertexCount);
+    mIndices.resize(3 * triangleCount);
+    if (IsNull(pIndices)) {
+        std::iota(mIndices.begin(), mIndices.end(), 0);
+    }
+    else {
+        std::copy(pIndices, pIndices + mIndices.size(), mIndices.begin());
+    }
+    mPrimitiveBounds.resize(triangleCount);
+
+    Timer timer;
+    timer.Start();
+    ComputeTriangleBounds();
+    Result ppxres = BuildTree();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    mStats.buildTimeMs = timer.MillisSinceStart();
+
+    return ppx::SUCCESS;
+}
+
+Result Bvh::Build(uint32_t count, const AABB* pBoxes)
+{
+    if (IsNull(pBoxes) && (count > 0)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    Clear();
+    mPrimitiveType = PRIMITIVE_TYPE_BOX;
+    mPrimitiveBounds.assign(pBoxes, pBoxes + count);
+
+    Timer timer;
+    timer.Start();
+    Result ppxres = BuildTree();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    mStats.buildTimeMs = timer.MillisSinceStart();
+
+    return ppx::SUCCESS;
+}
+
+Result Bvh::Refit(uint32_t vertexCount, const float3* pPositions)
+{
+    if ((mPrimitiveType != PRIMITIVE_TYPE_TRIANGLE) || (vertexCount != CountU32(mPositions))) {
+        return ppx::ERROR_UNEXPECTED_COUNT_VALUE;
+    }
+    if (IsNull(pPositions) && (vertexCount > 0)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    Timer timer;
+    timer.Start();
+    std::copy(pPositions, pPositions + vertexCount, mPositions.begin());
+    ComputeTriangleBounds();
+    UpdateLeafVertices();
+    RefitNodes();
+    mStats.refitTimeMs = timer.MillisSinceStart();
+
+    return ppx::SUCCESS;
+}
+
+Result Bvh::Refit(uint32_t count, const AABB* pBoxes)
+{
+    if ((mPrimitiveType != PRIMITIVE_TYPE_BOX) || (count != CountU32(mPrimitiveBounds))) {
+        return ppx::ERROR_UNEXPECTED_COUNT_VALUE;
+    }
+    if (IsNull(pBoxes) && (count > 0)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    Timer timer;
+    timer.Start();
+    std::copy(pBoxes, pBoxes + count, mPrimitiveBounds.begin());
+    RefitNodes();
+    mStats.refitTimeMs = timer.MillisSinceStart();
+
+    return ppx::SUCCESS;
+}
+
+void Bvh::Clear()
+{
+    mPositions.clear();
+    mIndices.clear();
+    mPrimitiveBounds.clear();
+    mCentroids.clear();
+    mPrimitiveIndices.clear();
+    mLeafVertices.clear();
+    mNodes.clear();
+    mBounds = AABB();
+    mStats  = {};
+}
+
+void Bvh::ComputeTriangleBounds()
+{
+    const uint32_t triangleCount = CountU32(mPrimitiveBounds);
+    const uint32_t chunkCount    = (triangleCount + kBoundsChunkSize - 1) / kBoundsChunkSize;
+    ParallelFor(chunkCount, mThreadCount, [&](uint32_t chunk) {
+        const uint32_t end = std::min(triangleCount, (chunk + 1) * kBoundsChunkSize);
+        for (uint32_t i = chunk * kBoundsChunkSize; i < end; ++i) {
+            AABB& bounds = mPrimitiveBounds[i];
+            bounds.Set(mPositions[mIndices[3 * i + 0]]);
+            bounds.Expand(mPositions[mIndices[3 * i + 1]]);
+            bounds.Expand(mPositions[mIndices[3 * i + 2]]);
+        }
+    });
+}
+
+void Bvh::UpdateLeafVertices()
+{
+    const uint32_t entryCount = CountU32(mPrimitiveIndices);
+    const uint32_t chunkCount = (entryCount + kBoundsChunkSize - 1) / kBoundsChunkSize;
+    ParallelFor(chunkCount, mThreadCount, [&](uint32_t chunk) {
+        const uint32_t end = std::min(entryCount, (chunk + 1) * kBoundsChunkSize);
+        for (uint32_t i = chunk * kBoundsChunkSize; i < end; ++i) {
+            const uint32_t triangle  = mPrimitiveIndices[i];
+            mLeafVertices[3 * i + 0] = mPositions[mIndices[3 * triangle + 0]];
+            mLeafVertices[3 * i + 1] = mPositions[mIndices[3 * triangle + 1]];
+            mLeafVertices[3 * i + 2] = mPositions[mIndices[3 * triangle + 2]];
+        }
+    });
+}
+
+Result Bvh::BuildTree()
+{
+    const uint32_t primitiveCount = CountU32(mPrimitiveBounds);
+    const uint32_t threadCount    = (mThreadCount == 0) ? GetHardwareThreadCount() : mThreadCount;
+
+    mStats.primitiveCount = primitiveCount;
+    mStats.threadCount    = threadCount;
+    if (primitiveCount == 0) {
+        return ppx::SUCCESS;
+    }
+
+    mPrimitiveIndices.resize(primitiveCount);
+    std::iota(mPrimitiveIndices.begin(), mPrimitiveIndices.end(), 0);
+    mCentroids.resize(primitiveCount);
+    for (uint32_t i = 0; i < primitiveCount; ++i) {
+        mCentroids[i] = mPrimitiveBounds[i].GetCenter();
+    }
+
+    // Split the top of the tree on this thread until ranges are small
+    // enough to give every thread a few subtrees, then build those.
+    std::vector<BuildNode> nodes(1);
+    std::vector<BuildTask> tasks;
+    nodes.reserve(2 * primitiveCount);
+    if (threadCount > 1) {
+        const uint32_t taskThreshold = std::max(primitiveCount / (4 * threadCount), kMinTaskSize);
+        BuildRange(nodes, 0, 0, primitiveCount, 0, taskThreshold, &tasks);
+    }
+    else {
+        BuildRange(nodes, 0, 0, primitiveCount, 0, 0, nullptr);
+    }
+
+    if (!tasks.empty()) {
+        // Largest first, so a big subtree doesn't end up alone at the end
+        std::sort(tasks.begin(), tasks.end(), [](const BuildTask& a, const BuildTask& b) { return a.count > b.count; });
+
+        std::vector<std::vector<BuildNode>> subtrees(tasks.size());
+        ParallelFor(CountU32(tasks), threadCount, [&](uint32_t i) {
+            const BuildTask& task = tasks[i];
+            subtrees[i].reserve(2 * task.count);
+            subtrees[i].emplace_back();
+            BuildRange(subtrees[i], 0, task.first, task.count, task.depth, 0, nullptr);
+        });
+
+        // Subtree roots replace their task's placeholder, the other nodes are appended
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            const uint32_t rootIndex = tasks[i].nodeIndex;
+            const uint32_t offset    = CountU32(nodes) - 1;
+            for (size_t j = 0; j < subtrees[i].size(); ++j) {
+                BuildNode node = subtrees[i][j];
+                if (!node.IsLeaf()) {
+                    node.left += offset;
+                    node.right += offset;
+                }
+                if (j == 0) {
+                    nodes[rootIndex] = node;
+                }
+                else {
+                    nodes.push_back(node);
+                }
+            }
+        }
+    }
+
+    mNodes.reserve(nodes.size() / 2 + 1);
+    Collapse(nodes, 0, 0);
+
+    mBounds.Set(nodes[0].bounds.min, nodes[0].bounds.max);
+    mStats.nodeCount = CountU32(mNodes);
+
+    mCentroids.clear();
+    mCentroids.shrink_to_fit();
+
+    if (mPrimitiveType == PRIMITIVE_TYPE_TRIANGLE) {
+        mLeafVertices.resize(3 * primitiveCount);
+        UpdateLeafVertices();
+    }
+
+    return ppx::SUCCESS;
+}
+
+void Bvh::BuildRange(std::vector<BuildNode>& nodes, uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth, uint32_t taskThreshold, std::vector<BuildTask>* pTasks)
+{
+    if (!IsNull(pTasks) && (count <= taskThreshold)) {
+        pTasks->push_back(BuildTask{nodeIndex, first, count, depth});
+        return;
+    }
+
+    Bounds bounds;
+    Bounds centroidBounds;
+    for (uint32_t i = first; i < first + count; ++i) {
+        const uint32_t primitive = mPrimitiveIndices[i];
+        bounds.Grow(mPrimitiveBounds[primitive]);
+        centroidBounds.Grow(mCentroids[primitive]);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    // Find the cheapest split over all axes
+    const float3 extent    = centroidBounds.max - centroidBounds.min;
+    float        bestCost  = FLT_MAX;
+    int          bestAxis  = -1;
+    uint32_t     bestSplit = 0;
+    if ((count > 1) && (depth < kMaxDepth)) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (!(extent[axis] > 0.0f)) {
+                continue;
+            }
+
+            Bin         bins[kBinCount];
+            const float scale = static_cast<float>(kBinCount) / extent[axis];
+            for (uint32_t i = first; i < first + count; ++i) {
+                const uint32_t primitive = mPrimitiveIndices[i];
+                const uint32_t bin       = std::min(static_cast<uint32_t>((mCentroids[primitive][axis] - centroidBounds.min[axis]) * scale), kBinCount - 1);
+                bins[bin].bounds.Grow(mPrimitiveBounds[primitive]);
+                bins[bin].count++;
+            }
+
+            // Sweep from both sides, split i puts bins [0, i] on the left
+            float    rightArea[kBinCount - 1];
+            uint32_t rightCount[kBinCount - 1];
+            Bounds   right;
+            uint32_t rightSum = 0;
+            for (uint32_t i = kBinCount - 1; i > 0; --i) {
+                right.Grow(bins[i].bounds);
+                rightSum += bins[i].count;
+                rightArea[i - 1]  = right.GetSurfaceArea();
+                rightCount[i - 1] = rightSum;
+            }
+
+            Bounds   left;
+            uint32_t leftSum = 0;
+            for (uint32_t i = 0; i < kBinCount - 1; ++i) {
+                left.Grow(bins[i].bounds);
+                leftSum += bins[i].count;
+                if ((leftSum == 0) || (rightCount[i] == 0)) {
+                    continue;
+                }
+                const float cost = static_cast<float>(leftSum) * left.GetSurfaceArea() + static_cast<float>(rightCount[i]) * rightArea[i];
+                if (cost < bestCost) {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+    }
+
+    // Costs above are relative to the node's surface area
+    const float area     = bounds.GetSurfaceArea();
+    const float leafCost = static_cast<float>(count) * area;
+    const bool  makeLeaf = (bestAxis < 0) || ((count <= mMaxLeafSize) && (kTraversalCost * area + bestCost >= leafCost));
+    if (makeLeaf) {
+        nodes[nodeIndex].first = first;
+        nodes[nodeIndex].count = count;
+        return;
+    }
+
+    const float scale  = static_cast<float>(kBinCount) / extent[bestAxis];
+    const float minPos = centroidBounds.min[bestAxis];
+    auto        middle = std::partition(
+        mPrimitiveIndices.begin() + first,
+        mPrimitiveIndices.begin() + first + count,
+        [&](uint32_t primitive) {
+            const uint32_t bin = std::min(static_cast<uint32_t>((mCentroids[primitive][bestAxis] - minPos) * scale), kBinCount - 1);
+            return bin <= bestSplit;
+        });
+    const uint32_t leftCount = static_cast<uint32_t>(middle - (mPrimitiveIndices.begin() + first));
+
+    const uint32_t leftIndex  = CountU32(nodes);
+    const uint32_t rightIndex = leftIndex + 1;
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[nodeIndex].left  = leftIndex;
+    nodes[nodeIndex].right = rightIndex;
+
+    BuildRange(nodes, leftIndex, first, leftCount, depth + 1, taskThreshold, pTasks);
+    BuildRange(nodes, rightIndex, first + leftCount, count - leftCount, depth + 1, taskThreshold, pTasks);
+}
+
+uint32_t Bvh::Collapse(const std::vector<BuildNode>& nodes, uint32_t nodeIndex, uint32_t depth)
+{
+    // Pull grandchildren up until the node has 4 children, opening the
+    // largest inner child first
+    uint32_t slots[4]  = {nodeIndex, kInvalidIndex, kInvalidIndex, kInvalidIndex};
+    uint32_t slotCount = 1;
+    if (!nodes[nodeIndex].IsLeaf()) {
+        slots[0]  = nodes[nodeIndex].left;
+        slots[1]  = nodes[nodeIndex].right;
+        slotCount = 2;
+    }
+    while (slotCount < 4) {
+        int   largest     = -1;
+        float largestArea = -1.0f;
+        for (uint32_t i = 0; i < slotCount; ++i) {
+            const BuildNode& child = nodes[slots[i]];
+            if (!child.IsLeaf() && (child.bounds.GetSurfaceArea() > largestArea)) {
+                largest     = static_cast<int>(i);
+                largestArea = child.bounds.GetSurfaceArea();
+            }
+        }
+        if (largest < 0) {
+            break;
+        }
+        const BuildNode& child = nodes[slots[largest]];
+        slots[largest]         = child.left;
+        slots[slotCount++]     = child.right;
+    }
+
+    const uint32_t wideIndex = CountU32(mNodes);
+    Node           wide      = {};
+    for (uint32_t i = 0; i < 4; ++i) {
+        wide.minX[i] = wide.minY[i] = wide.minZ[i] = FLT_MAX;
+        wide.maxX[i] = wide.maxY[i] = wide.maxZ[i] = -FLT_MAX;
+        wide.child[i]                              = kInvalidIndex;
+        wide.count[i]                              = 0;
+    }
+    mNodes.push_back(wide);
+
+    mStats.maxDepth = std::max(mStats.maxDepth, depth + 1);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        const BuildNode& child = nodes[slots[i]];
+        wide.minX[i]           = child.bounds.min.x;
+        wide.minY[i]           = child.bounds.min.y;
+        wide.minZ[i]           = child.bounds.min.z;
+        wide.maxX[i]           = child.bounds.max.x;
+        wide.maxY[i]           = child.bounds.max.y;
+        wide.maxZ[i]           = child.bounds.max.z;
+        if (child.IsLeaf()) {
+            wide.child[i] = child.first;
+            wide.count[i] = child.count;
+            mStats.leafCount++;
+        }
+        else {
+            wide.child[i] = Collapse(nodes, slots[i], depth + 1);
+        }
+    }
+    mNodes[wideIndex] = wide;
+
+    return wideIndex;
+}
+
+// Unused children have empty bounds and don't change the result
+template <typename NodeT>
+static Bounds GetNodeBounds(const NodeT& node)
+{
+    Bounds bounds;
+    for (uint32_t i = 0; i < 4; ++i) {
+        bounds.min = glm::min(bounds.min, float3(node.minX[i], node.minY[i], node.minZ[i]));
+        bounds.max = glm::max(bounds.max, float3(node.maxX[i], node.maxY[i], node.maxZ[i]));
+    }
+    return bounds;
+}
+
+void Bvh::RefitNodes()
+{
+    // Children always come after their parent
+    for (size_t n = mNodes.size(); n > 0; --n) {
+        Node& node = mNodes[n - 1];
+        for (uint32_t i = 0; i < 4; ++i) {
+            Bounds bounds;
+            if (node.count[i] > 0) {
+                for (uint32_t j = node.child[i]; j < node.child[i] + node.count[i]; ++j) {
+                    bounds.Grow(mPrimitiveBounds[mPrimitiveIndices[j]]);
+                }
+            }
+            else if (node.child[i] != kInvalidIndex) {
+                bounds = GetNodeBounds(mNodes[node.child[i]]);
+            }
+            else {
+                continue;
+            }
+            node.minX[i] = bounds.min.x;
+            node.minY[i] = bounds.min.y;
+            node.minZ[i] = bounds.min.z;
+            node.maxX[i] = bounds.max.x;
+            node.maxY[i] = bounds.max.y;
+            node.maxZ[i] = bounds.max.z;
+        }
+    }
+
+    if (!mNodes.empty()) {
+        const Bounds bounds = GetNodeBounds(mNodes[0]);
+        mBounds.Set(bounds.min, bounds.max);
+    }
+}
+
+bool Bvh::IntersectLeafEntry(uint32_t entry, const Ray& ray, float tMax, RayHit* pHit) const
+{
+    const uint32_t primitiveIndex = mPrimitiveIndices[entry];
+    if (mPrimitiveType == PRIMITIVE_TYPE_BOX) {
+        const AABB& box    = mPrimitiveBounds[primitiveIndex];
+        float       tEnter = 0;
+        if (!IntersectBox(box.GetMin(), box.GetMax(), PrepareRay(ray), tMax, &tEnter)) {
+            return false;
+        }
+        pHit->t              = tEnter;
+        pHit->primitiveIndex = primitiveIndex;
+        pHit->barycentrics   = float2(0);
+        return true;
+    }
+
+    // Moller-Trumbore, both faces
+    const float3& p0   = mLeafVertices[3 * entry + 0];
+    const float3& p1   = mLeafVertices[3 * entry + 1];
+    const float3& p2   = mLeafVertices[3 * entry + 2];
+    const float3  e1   = p1 - p0;
+    const float3  e2   = p2 - p0;
+    const float3  pvec = glm::cross(ray.direction, e2);
+    const float   det  = glm::dot(e1, pvec);
+    if (det == 0.0f) {
+        return false;
+    }
+    const float  invDet = 1.0f / det;
+    const float3 tvec   = ray.origin - p0;
+    const float  u      = glm::dot(tvec, pvec) * invDet;
+    if ((u < 0.0f) || (u > 1.0f)) {
+        return false;
+    }
+    const float3 qvec = glm::cross(tvec, e1);
+    const float  v    = glm::dot(ray.direction, qvec) * invDet;
+    if ((v < 0.0f) || (u + v > 1.0f)) {
+        return false;
+    }
+    const float t = glm::dot(e2, qvec) * invDet;
+    if ((t < ray.tMin) || (t > tMax)) {
+        return false;
+    }
+
+    pHit->t              = t;
+    pHit->primitiveIndex = primitiveIndex;
+    pHit->barycentrics   = float2(u, v);
+    return true;
+}
+
+template <InstructionSet IS, bool ANY_HIT>
+bool Bvh::Traverse(const Ray& ray, RayHit* pHit) const
+{
+    struct StackEntry
+    {
+        uint32_t node;
+        float    tEnter;
+    };
+
+    if (mNodes.empty()) {
+        return false;
+    }
+
+    const RayData rd        = PrepareRay(ray);
+    float         tMax      = ray.tMax;
+    bool          hit       = false;
+    StackEntry    stack[kStackSize];
+    uint32_t      stackSize = 0;
+    stack[stackSize++]      = {0, ray.tMin};
+
+    while (stackSize > 0) {
+        const StackEntry entry = stack[--stackSize];
+        if (entry.tEnter > tMax) {
+            continue;
+        }
+
+        const Node& node = mNodes[entry.node];
+        alignas(16) float tEnter[4];
+        uint32_t          mask = IntersectChildren<IS>(node.minX, node.maxX, rd, tMax, tEnter);
+
+        // Leaves are tested right away, inner children are pushed farthest first
+        uint32_t inner[4];
+        uint32_t innerCount = 0;
+        while (mask != 0) {
+            const uint32_t i = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+            if (node.count[i] == 0) {
+                if (node.child[i] != kInvalidIndex) {
+                    inner[innerCount++] = i;
+                }
+                continue;
+            }
+            if (tEnter[i] > tMax) {
+                continue;
+            }
+            for (uint32_t j = node.child[i]; j < node.child[i] + node.count[i]; ++j) {
+                if (IntersectLeafEntry(j, ray, tMax, pHit)) {
+                    if (ANY_HIT) {
+                        return true;
+                    }
+                    hit  = true;
+                    tMax = pHit->t;
+                }
+            }
+        }
+
+        for (uint32_t i = 1; i < innerCount; ++i) {
+            for (uint32_t j = i; (j > 0) && (tEnter[inner[j - 1]] < tEnter[inner[j]]); --j) {
+                std::swap(inner[j - 1], inner[j]);
+            }
+        }
+        for (uint32_t i = 0; i < innerCount; ++i) {
+            stack[stackSize++] = {node.child[inner[i]], tEnter[inner[i]]};
+        }
+    }
+
+    return hit;
+}
+
+bool Bvh::Intersect(const Ray& ray, RayHit* pHit) const
+{
+    PPX_ASSERT_NULL_ARG(pHit);
+
+    RayHit hit = {};
+    bool   result;
+    switch (mInstructionSet) {
+        default: result = Traverse<INSTRUCTION_SET_SCALAR, false>(ray, &hit); break;
+#if defined(PPX_BVH_X86)
+        case INSTRUCTION_SET_SSE2: result = Traverse<INSTRUCTION_SET_SSE2, false>(ray, &hit); break;
+#endif
+#if defined(PPX_BVH_NEON)
+        case INSTRUCTION_SET_NEON: result = Traverse<INSTRUCTION_SET_NEON, false>(ray, &hit); break;
+#endif
+    }
+    *pHit = hit;
+    return result;
+}
+
+bool Bvh::IntersectAny(const Ray& ray) const
+{
+    RayHit hit = {};
+    switch (mInstructionSet) {
+        default: return Traverse<INSTRUCTION_SET_SCALAR, true>(ray, &hit);
+#if defined(PPX_BVH_X86)
+        case INSTRUCTION_SET_SSE2: return Traverse<INSTRUCTION_SET_SSE2, true>(ray, &hit);
+#endif
+#if defined(PPX_BVH_NEON)
+        case INSTRUCTION_SET_NEON: return Traverse<INSTRUCTION_SET_NEON, true>(ray, &hit);
+#endif
+    }
+}
+
+uint32_t Bvh::Query(const AABB& box, std::vector<uint32_t>* pResults) const
+{
+    PPX_ASSERT_NULL_ARG(pResults);
+
+    if (mNodes.empty()) {
+        return 0;
+    }
+
+    const float3 qMin  = box.GetMin();
+    const float3 qMax  = box.GetMax();
+    const size_t start = pResults->size();
+
+    uint32_t stack[kStackSize];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = mNodes[stack[--stackSize]];
+        for (uint32_t i = 0; i < 4; ++i) {
+            const bool overlaps = (node.minX[i] <= qMax.x) && (node.maxX[i] >= qMin.x) &&
+                                  (node.minY[i] <= qMax.y) && (node.maxY[i] >= qMin.y) &&
+                                  (node.minZ[i] <= qMax.z) && (node.maxZ[i] >= qMin.z);
+            if (!overlaps) {
+                continue;
+            }
+            if (node.count[i] == 0) {
+                if (node.child[i] != kInvalidIndex) {
+                    stack[stackSize++] = node.child[i];
+                }
+                continue;
+            }
+            for (uint32_t j = node.child[i]; j < node.child[i] + node.count[i]; ++j) {
+                const uint32_t primitive = mPrimitiveIndices[j];
+                const AABB&    bounds    = mPrimitiveBounds[primitive];
+                const float3&  bMin      = bounds.GetMin();
+                const float3&  bMax      = bounds.GetMax();
+                if ((bMin.x <= qMax.x) && (bMax.x >= qMin.x) && (bMin.y <= qMax.y) && (bMax.y >= qMin.y) && (bMin.z <= qMax.z) && (bMax.z >= qMin.z)) {
+                    pResults->push_back(primitive);
+                }
+            }
+        }
+    }
+
+    return static_cast<uint32_t>(pResults->size() - start);
+}
+
+} // namespace ppx
@@ -136,6 +136,36 @@ std::optional<CommandLineParser::ParsingError> CommandLineParser::Parse(int argc
             }
             mOpts.standardOptions.screenshot_path = opt.GetValueOrDefault<std::string>("");
         }
+        else if (opt.GetName() == "memory-stats-file") {
+            if (!opt.HasValue()) {
+                return std::string("Command-line option --memory-stats-file requires a parameter");
+            }
+            mOpts.standardOptions.memory_stats_file = opt.GetValueOrDefault<std::string>("");
+        }
+        else if (opt.GetName() == "frame-pacing") {
+            if (!opt.HasValue()) {
+                return std::string("Command-line option --frame-pacing requires a parameter");
+            }
+            mOpts.standardOptions.frame_pacing = opt.GetValueOrDefault<std::string>("");
+        }
+        else if (opt.GetName() == "frame-stats-file") {
+            if (!opt.HasValue()) {
+                return std::string("Command-line option --frame-stats-file requires a parameter");
+            }
+            mOpts.standardOptions.frame_stats_file = opt.GetValueOrDefault<std::string>("");
+        }
+        else if (opt.GetName() == "gpu-stats-file") {
+            if (!opt.HasValue()) {
+                return std::string("Command-line option --gpu-stats-file requires a parameter");
+            }
+            mOpts.standardOptions.gpu_stats_file = opt.GetValueOrDefault<std::string>("");
+        }
+        else if (opt.GetName() == "pipeline-cache-file") {
+            if (!opt.HasValue()) {
+                return std::string("Command-line option --pipeline-cache-file requires a parameter");
+            }
+            mOpts.standardOptions.pipeline_cache_file = opt.GetValueOrDefault<std::string>("");
+        }
         else {
             // Non-standard option.
             mOpts.AddExtraOption(opt);
@@ -0,0 +1,442 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/culling.h"
+#include "ppx/camera.h"
+#include "ppx/config.h"
+#include "ppx/parallel.h"
+#include "ppx/timer.h"
+
+#include <bit>
+#include <cfloat>
+#include <cmath>
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_CULLING_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define PPX_TARGET_AVX2
+#   else
+#       define PPX_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_CULLING_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+
+// Volume arrays are padded to a multiple of the widest kernel
+static const uint32_t kGroupSize = 8;
+
+// Padding volumes have a radius that no plane distance can make up for,
+// so kernels can run over whole groups and never report them
+static const float kPaddingRadius = -FLT_MAX;
+
+// -------------------------------------------------------------------------------------------------
+// Frustum
+// -------------------------------------------------------------------------------------------------
+void Frustum::Set(const float4x4& viewProjection)
+{
+    const float4 row0 = glm::row(viewProjection, 0);
+    const float4 row1 = glm::row(viewProjection, 1);
+    const float4 row2 = glm::row(viewProjection, 2);
+    const float4 row3 = glm::row(viewProjection, 3);
+
+    mPlanes[PLANE_LEFT]   = row3 + row0;
+    mPlanes[PLANE_RIGHT]  = row3 - row0;
+    mPlanes[PLANE_BOTTOM] = row3 + row1;
+    mPlanes[PLANE_TOP]    = row3 - row1;
+    mPlanes[PLANE_NEAR]   = row2; // Zero to one depth: 0 <= z
+    mPlanes[PLANE_FAR]    = row3 - row2;
+
+    for (uint32_t i = 0; i < PLANE_COUNT; ++i) {
+        const float length = glm::length(float3(mPlanes[i]));
+        if (length > 0.0f) {
+            mPlanes[i] /= length;
+        }
+    }
+}
+
+void Frustum::Set(const Camera& camera)
+{
+    Set(camera.GetViewProjectionMatrix());
+}
+
+bool Frustum::Contains(const float3& point) const
+{
+    for (uint32_t i = 0; i < PLANE_COUNT; ++i) {
+        if (glm::dot(float3(mPlanes[i]), point) + mPlanes[i].w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool IntersectsBox(const float4 planes[Frustum::PLANE_COUNT], const float3& center, const float3& extents, float radius)
+{
+    for (uint32_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+        const float3 normal   = float3(planes[i]);
+        const float  distance = glm::dot(normal, center) + planes[i].w;
+        const float  reach    = glm::dot(glm::abs(normal), extents) + radius;
+        if (distance + reach < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Half extents of the world space box bounding an OBB
+static float3 GetWorldExtents(const OBB& obb)
+{
+    const float3 s = obb.GetSize() / 2.0f;
+    return glm::abs(obb.GetU()) * s.x + glm::abs(obb.GetV()) * s.y + glm::abs(obb.GetW()) * s.z;
+}
+
+bool Frustum::Intersects(const AABB& aabb) const
+{
+    return IntersectsBox(mPlanes, aabb.GetCenter(), aabb.GetSize() / 2.0f, 0.0f);
+}
+
+bool Frustum::Intersects(const OBB& obb) const
+{
+    return IntersectsBox(mPlanes, obb.GetPos(), GetWorldExtents(obb), 0.0f);
+}
+
+bool Frustum::IntersectsSphere(const float3& center, float radius) const
+{
+    return IntersectsBox(mPlanes, center, float3(0.0f), radius);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Kernels
+// -------------------------------------------------------------------------------------------------
+
+// Plane components splatted per plane, with abs(normal) precomputed
+struct CullingPlanes
+{
+    float nx[Frustum::PLANE_COUNT];
+    float ny[Frustum::PLANE_COUNT];
+    float nz[Frustum::PLANE_COUNT];
+    float w[Frustum::PLANE_COUNT];
+    float ax[Frustum::PLANE_COUNT];
+    float ay[Frustum::PLANE_COUNT];
+    float az[Frustum::PLANE_COUNT];
+};
+
+struct CullingVolumes
+{
+    const float* pCenterX;
+    const float* pCenterY;
+    const float* pCenterZ;
+    const float* pExtentX;
+    const float* pExtentY;
+    const float* pExtentZ;
+    const float* pRadius;
+};
+
+// Culls volumes [begin, end) and writes the visible indices to pVisible,
+// returns the number written. begin and end are multiples of kGroupSize.
+using CullFn = uint32_t (*)(const CullingVolumes& volumes, const CullingPlanes& planes, uint32_t begin, uint32_t end, uint32_t* pVisible);
+
+static uint32_t CullScalar(const CullingVolumes& volumes, const CullingPlanes& planes, uint32_t begin, uint32_t end, uint32_t* pVisible)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        bool visible = true;
+        for (uint32_t p = 0; (p < Frustum::PLANE_COUNT) && visible; ++p) {
+            float d = planes.nx[p] * volumes.pCenterX[i] + planes.ny[p] * volumes.pCenterY[i] + planes.nz[p] * volumes.pCenterZ[i] + planes.w[p];
+            float r = planes.ax[p] * volumes.pExtentX[i] + planes.ay[p] * volumes.pExtentY[i] + planes.az[p] * volumes.pExtentZ[i] + volumes.pRadius[i];
+            visible = (d + r >= 0.0f);
+        }
+        if (visible) {
+            pVisible[count++] = i;
+        }
+    }
+    return count;
+}
+
+#if defined(PPX_CULLING_X86)
+static uint32_t CullSSE2(const CullingVolumes& volumes, const CullingPlanes& planes, uint32_t begin, uint32_t end, uint32_t* pVisible)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(volumes.pCenterX + i);
+        const __m128 cy = _mm_loadu_ps(volumes.pCenterY + i);
+        const __m128 cz = _mm_loadu_ps(volumes.pCenterZ + i);
+        const __m128 ex = _mm_loadu_ps(volumes.pExtentX + i);
+        const __m128 ey = _mm_loadu_ps(volumes.pExtentY + i);
+        const __m128 ez = _mm_loadu_ps(volumes.pExtentZ + i);
+        const __m128 r  = _mm_loadu_ps(volumes.pRadius + i);
+
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (uint32_t p = 0; p < Frustum::PLANE_COUNT; ++p) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.nx[p]), cx), _mm_mul_ps(_mm_set1_ps(planes.ny[p]), cy)), _mm_mul_ps(_mm_set1_ps(planes.nz[p]), cz)), _mm_set1_ps(planes.w[p]));
+            __m128 e = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.ax[p]), ex), _mm_mul_ps(_mm_set1_ps(planes.ay[p]), ey)), _mm_mul_ps(_mm_set1_ps(planes.az[p]), ez)), r);
+            visible  = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(d, e), _mm_setzero_ps()));
+        }
+
+        for (int mask = _mm_movemask_ps(visible); mask != 0; mask &= (mask - 1)) {
+            pVisible[count++] = i + static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(mask)));
+        }
+    }
+    return count;
+}
+
+PPX_TARGET_AVX2 static uint32_t CullAVX2(const CullingVolumes& volumes, const CullingPlanes& planes, uint32_t begin, uint32_t end, uint32_t* pVisible)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(volumes.pCenterX + i);
+        const __m256 cy = _mm256_loadu_ps(volumes.pCenterY + i);
+        const __m256 cz = _mm256_loadu_ps(volumes.pCenterZ + i);
+        const __m256 ex = _mm256_loadu_ps(volumes.pExtentX + i);
+        const __m256 ey = _mm256_loadu_ps(volumes.pExtentY + i);
+        const __m256 ez = _mm256_loadu_ps(volumes.pExtentZ + i);
+        const __m256 r  = _mm256_loadu_ps(volumes.pRadius + i);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < Frustum::PLANE_COUNT; ++p) {
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.nx[p]), cx), _mm256_mul_ps(_mm256_set1_ps(planes.ny[p]), cy)), _mm256_mul_ps(_mm256_set1_ps(planes.nz[p]), cz)), _mm256_set1_ps(planes.w[p]));
+            __m256 e = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.ax[p]), ex), _mm256_mul_ps(_mm256_set1_ps(planes.ay[p]), ey)), _mm256_mul_ps(_mm256_set1_ps(planes.az[p]), ez)), r);
+            visible  = _mm256_and_ps(visible, _mm256_cmp_ps(_mm256_add_ps(d, e), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        for (int mask = _mm256_movemask_ps(visible); mask != 0; mask &= (mask - 1)) {
+            pVisible[count++] = i + static_cast<uint32_t>(std::countr_zero(static_cast<uint32_t>(mask)));
+        }
+    }
+    return count;
+}
+#endif
+
+#if defined(PPX_CULLING_NEON)
+static uint32_t CullNEON(const CullingVolumes& volumes, const CullingPlanes& planes, uint32_t begin, uint32_t end, uint32_t* pVisible)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 4) {
+        const float32x4_t cx = vld1q_f32(volumes.pCenterX + i);
+        const float32x4_t cy = vld1q_f32(volumes.pCenterY + i);
+        const float32x4_t cz = vld1q_f32(volumes.pCenterZ + i);
+        const float32x4_t ex = vld1q_f32(volumes.pExtentX + i);
+        const float32x4_t ey = vld1q_f32(volumes.pExtentY + i);
+        const float32x4_t ez = vld1q_f32(volumes.pExtentZ + i);
+        const float32x4_t r  = vld1q_f32(volumes.pRadius + i);
+
+        uint32x4_t visible = vdupq_n_u32(0xFFFFFFFF);
+        for (uint32_t p = 0; p < Frustum::PLANE_COUNT; ++p) {
+            float32x4_t d = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(cx, planes.nx[p]), vmulq_n_f32(cy, planes.ny[p])), vmulq_n_f32(cz, planes.nz[p])), vdupq_n_f32(planes.w[p]));
+            float32x4_t e = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(ex, planes.ax[p]), vmulq_n_f32(ey, planes.ay[p])), vmulq_n_f32(ez, planes.az[p])), r);
+            visible       = vandq_u32(visible, vcgeq_f32(vaddq_f32(d, e), vdupq_n_f32(0.0f)));
+        }
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, visible);
+        for (uint32_t j = 0; j < 4; ++j) {
+            if (lanes[j] != 0) {
+                pVisible[count++] = i + j;
+            }
+        }
+    }
+    return count;
+}
+#endif
+
+static CullFn GetCullFn(InstructionSet value)
+{
+    switch (value) {
+        default: break;
+#if defined(PPX_CULLING_X86)
+        case INSTRUCTION_SET_SSE2: return CullSSE2;
+        case INSTRUCTION_SET_AVX2: return CullAVX2;
+#endif
+#if defined(PPX_CULLING_NEON)
+        case INSTRUCTION_SET_NEON: return CullNEON;
+#endif
+    }
+    return CullScalar;
+}
+
+// -------------------------------------------------------------------------------------------------
+// FrustumCuller
+// -------------------------------------------------------------------------------------------------
+FrustumCuller::FrustumCuller()
+    : mInstructionSet(GetBestInstructionSet())
+{
+}
+
+bool FrustumCuller::SetInstructionSet(InstructionSet value)
+{
+    if (!IsSupported(value)) {
+        return false;
+    }
+    mInstructionSet = value;
+    return true;
+}
+
+void FrustumCuller::SetChunkSize(uint32_t chunkSize)
+{
+    mChunkSize = RoundUp(std::max(chunkSize, kGroupSize), kGroupSize);
+}
+
+uint32_t FrustumCuller::Add(const float3& center, const float3& extents, float radius)
+{
+    if (mCount == CountU32(mRadius)) {
+        const size_t size = mRadius.size() + kGroupSize;
+        mCenterX.resize(size, 0.0f);
+        mCenterY.resize(size, 0.0f);
+        mCenterZ.resize(size, 0.0f);
+        mExtentX.resize(size, 0.0f);
+        mExtentY.resize(size, 0.0f);
+        mExtentZ.resize(size, 0.0f);
+        mRadius.resize(size, kPaddingRadius);
+    }
+    const uint32_t index = mCount++;
+    Set(index, center, extents, radius);
+    return index;
+}
+
+void FrustumCuller::Set(uint32_t index, const float3& center, const float3& extents, float radius)
+{
+    PPX_ASSERT_MSG(index < mCount, "volume index out of range");
+    mCenterX[index] = center.x;
+    mCenterY[index] = center.y;
+    mCenterZ[index] = center.z;
+    mExtentX[index] = extents.x;
+    mExtentY[index] = extents.y;
+    mExtentZ[index] = extents.z;
+    mRadius[index]  = radius;
+}
+
+uint32_t FrustumCuller::AddAABB(const AABB& aabb)
+{
+    return Add(aabb.GetCenter(), aabb.GetSize() / 2.0f, 0.0f);
+}
+
+uint32_t FrustumCuller::AddOBB(const OBB& obb)
+{
+    return Add(obb.GetPos(), GetWorldExtents(obb), 0.0f);
+}
+
+uint32_t FrustumCuller::AddSphere(const float3& center, float radius)
+{
+    return Add(center, float3(0.0f), radius);
+}
+
+void FrustumCuller::SetAABB(uint32_t index, const AABB& aabb)
+{
+    Set(index, aabb.GetCenter(), aabb.GetSize() / 2.0f, 0.0f);
+}
+
+void FrustumCuller::SetOBB(uint32_t index, const OBB& obb)
+{
+    Set(index, obb.GetPos(), GetWorldExtents(obb), 0.0f);
+}
+
+void FrustumCuller::SetSphere(uint32_t index, const float3& center, float radius)
+{
+    Set(index, center, float3(0.0f), radius);
+}
+
+void FrustumCuller::Reserve(uint32_t count)
+{
+    const size_t size = RoundUp(count, kGroupSize);
+    mCenterX.reserve(size);
+    mCenterY.reserve(size);
+    mCenterZ.reserve(size);
+    mExtentX.reserve(size);
+    mExtentY.reserve(size);
+    mExtentZ.reserve(size);
+    mRadius.reserve(size);
+}
+
+void FrustumCuller::Clear()
+{
+    mCount = 0;
+    mCenterX.clear();
+    mCenterY.clear();
+    mCenterZ.clear();
+    mExtentX.clear();
+    mExtentY.clear();
+    mExtentZ.clear();
+    mRadius.clear();
+}
+
+uint32_t FrustumCuller::Cull(const Frustum& frustum, std::vector<uint32_t>* pVisible)
+{
+    PPX_ASSERT_NULL_ARG(pVisible);
+
+    Timer timer;
+    timer.Start();
+
+    CullingPlanes planes = {};
+    for (uint32_t p = 0; p < Frustum::PLANE_COUNT; ++p) {
+        const float4& plane = frustum.GetPlane(p);
+        planes.nx[p]        = plane.x;
+        planes.ny[p]        = plane.y;
+        planes.nz[p]        = plane.z;
+        planes.w[p]         = plane.w;
+        planes.ax[p]        = std::fabs(plane.x);
+        planes.ay[p]        = std::fabs(plane.y);
+        planes.az[p]        = std::fabs(plane.z);
+    }
+
+    CullingVolumes volumes = {};
+    volumes.pCenterX       = mCenterX.data();
+    volumes.pCenterY       = mCenterY.data();
+    volumes.pCenterZ       = mCenterZ.data();
+    volumes.pExtentX       = mExtentX.data();
+    volumes.pExtentY       = mExtentY.data();
+    volumes.pExtentZ       = mExtentZ.data();
+    volumes.pRadius        = mRadius.data();
+
+    // Each chunk writes its visible indices at its own offset, they're
+    // compacted in chunk order afterwards so the output doesn't depend on
+    // the number of threads.
+    const CullFn   cull        = GetCullFn(mInstructionSet);
+    const uint32_t paddedCount = CountU32(mRadius);
+    const uint32_t chunkCount  = (paddedCount + mChunkSize - 1) / mChunkSize;
+    const uint32_t threadCount = std::max<uint32_t>(std::min((mThreadCount == 0) ? GetHardwareThreadCount() : mThreadCount, chunkCount), 1);
+    mChunkVisible.resize(paddedCount);
+    mChunkVisibleCounts.resize(chunkCount);
+
+    ParallelFor(chunkCount, threadCount, [&](uint32_t chunk) {
+        const uint32_t begin        = chunk * mChunkSize;
+        const uint32_t end          = std::min(begin + mChunkSize, paddedCount);
+        mChunkVisibleCounts[chunk] = cull(volumes, planes, begin, end, mChunkVisible.data() + begin);
+    });
+
+    pVisible->clear();
+    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const uint32_t* pChunkVisible = mChunkVisible.data() + chunk * mChunkSize;
+        pVisible->insert(pVisible->end(), pChunkVisible, pChunkVisible + mChunkVisibleCounts[chunk]);
+    }
+
+    timer.Stop();
+
+    const uint32_t visibleCount = CountU32(*pVisible);
+    mStats                      = {};
+    mStats.objectCount          = mCount;
+    mStats.frustumCulledCount   = mCount - visibleCount;
+    mStats.visibleCount         = visibleCount;
+    mStats.threadCount          = threadCount;
+    mStats.cpuTimeMs            = timer.MillisSinceStart();
+    mStats.pInstructionSet      = ToString(mInstructionSet);
+
+    return visibleCount;
+}
+
+} // namespace ppx
@@ -190,6 +190,46 @@ void Font::RenderGlyphBitmap(
         static_cast<int>(codepoint));
 }
 
+void Font::RenderGlyphSDF(
+    float          fontSizeInPixels,
+    uint32_t       codepoint,
+    uint32_t       padding,
+    uint32_t       glyphWidth,
+    uint32_t       glyphHeight,
+    uint32_t       rowStride,
+    unsigned char* pOutput) const
+{
+    float scale = stbtt_ScaleForPixelHeight(&mObject->fontInfo, fontSizeInPixels);
+
+    int            width  = 0;
+    int            height = 0;
+    int            xoff   = 0;
+    int            yoff   = 0;
+    unsigned char* pField = stbtt_GetCodepointSDF(
+        &mObject->fontInfo,
+        scale,
+        static_cast<int>(codepoint),
+        static_cast<int>(padding),
+        128,
+        128.0f / static_cast<float>(std::max<uint32_t>(padding, 1)),
+        &width,
+        &height,
+        &xoff,
+        &yoff);
+    // Glyphs without an outline, like space
+    if (IsNull(pField)) {
+        return;
+    }
+
+    const uint32_t copyWidth  = std::min<uint32_t>(static_cast<uint32_t>(width), glyphWidth);
+    const uint32_t copyHeight = std::min<uint32_t>(static_cast<uint32_t>(height), glyphHeight);
+    for (uint32_t y = 0; y < copyHeight; ++y) {
+        std::memcpy(pOutput + y * rowStride, pField + y * width, copyWidth);
+    }
+
+    stbtt_FreeSDF(pField, nullptr);
+}
+
 //void  Font::GetGlyphBitmap(float fontSizeInPixels)
 //{
 //    stbtt_MakeCodepointBitmapSubpixel(
@@ -0,0 +1,266 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/frame_pacer.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_sync.h"
+
+namespace ppx {
+
+bool ParseFramePacingMode(const std::string& name, ppx::FramePacingMode* pMode)
+{
+    for (int i = FRAME_PACING_MODE_UNLOCKED; i <= FRAME_PACING_MODE_LOW_LATENCY; ++i) {
+        ppx::FramePacingMode mode = static_cast<ppx::FramePacingMode>(i);
+        if (name == ToString(mode)) {
+            *pMode = mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ToString(ppx::FramePacingMode mode)
+{
+    switch (mode) {
+        default: break;
+        case FRAME_PACING_MODE_UNLOCKED: return "unlocked";
+        case FRAME_PACING_MODE_VSYNC: return "vsync";
+        case FRAME_PACING_MODE_FIXED_RATE: return "fixed-rate";
+        case FRAME_PACING_MODE_LOW_LATENCY: return "low-latency";
+    }
+    return "<unknown frame pacing mode>";
+}
+
+FramePacer::~FramePacer()
+{
+    Shutdown();
+}
+
+Result FramePacer::Initialize(ppx::FramePacingMode mode, uint32_t frameRate, bool measureGpuCompletion, grfx::Queue* pQueue)
+{
+    mMode     = mode;
+    mPeriodMs = (frameRate > 0) ? (1000.0 / static_cast<double>(frameRate)) : 0;
+    mQueue    = pQueue;
+
+    if (mTimer.Start() != ppx::TIMER_RESULT_SUCCESS) {
+        return ppx::ERROR_FAILED;
+    }
+
+    // Only LOW_LATENCY needs to know when frames complete
+    if (!measureGpuCompletion && (mode != ppx::FRAME_PACING_MODE_LOW_LATENCY)) {
+        return ppx::SUCCESS;
+    }
+    if (IsNull(pQueue) || !pQueue->GetDevice()->TimelineSemaphoreSupported()) {
+        return ppx::SUCCESS;
+    }
+
+    grfx::SemaphoreCreateInfo createInfo = {};
+    createInfo.semaphoreType             = grfx::SEMAPHORE_TYPE_TIMELINE;
+
+    Result ppxres = pQueue->GetDevice()->CreateSemaphore(&createInfo, &mSemaphore);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    mStopping = false;
+    mWatcher  = std::thread(&FramePacer::WatcherMain, this);
+
+    return ppx::SUCCESS;
+}
+
+void FramePacer::Shutdown()
+{
+    if (mWatcher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mFrameSubmitted.notify_one();
+        mWatcher.join();
+    }
+
+    if (mSemaphore) {
+        mQueue->GetDevice()->DestroySemaphore(mSemaphore);
+        mSemaphore.Reset();
+    }
+    mQueue = nullptr;
+}
+
+void FramePacer::WaitForFrameStart()
+{
+    double startMs = mTimer.MillisSinceStart();
+
+    switch (mMode) {
+        default: break;
+        case FRAME_PACING_MODE_FIXED_RATE: WaitForFixedRate(); break;
+        case FRAME_PACING_MODE_LOW_LATENCY: WaitForGpu(); break;
+    }
+
+    mPacingWaitMs = mTimer.MillisSinceStart() - startMs;
+}
+
+void FramePacer::WaitForFixedRate()
+{
+    if (mPeriodMs <= 0) {
+        return;
+    }
+
+    double nowMs = mTimer.MillisSinceStart();
+    if (mNextFrameTimeMs < 0) {
+        mNextFrameTimeMs = nowMs;
+    }
+
+    // Frames are due at fixed intervals so that short frames make up for
+    // long ones, but a frame that's more than a period late starts a new
+    // schedule rather than have the next frames rush to catch up.
+    if ((nowMs - mNextFrameTimeMs) > mPeriodMs) {
+        mNextFrameTimeMs = nowMs;
+    }
+
+    double sleepMs = mNextFrameTimeMs - nowMs - kSpinThresholdMs;
+    if (sleepMs > 0) {
+        Timer::SleepMillis(sleepMs);
+    }
+    while (mTimer.MillisSinceStart() < mNextFrameTimeMs) {
+        std::this_thread::yield();
+    }
+
+    mNextFrameTimeMs += mPeriodMs;
+}
+
+void FramePacer::WaitForGpu()
+{
+    if (!mSemaphore) {
+        if (!IsNull(mQueue)) {
+            mQueue->WaitIdle();
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFrameCompleted.wait(lock, [this]() { return mCompletedValue >= mSubmittedValue; });
+}
+
+void FramePacer::BeginRender()
+{
+    mRenderStartMs = mTimer.MillisSinceStart();
+
+    mCurrentFrame                = {};
+    mCurrentFrame.frameNumber    = mSubmittedValue;
+    mCurrentFrame.pacingWaitTime = mPacingWaitMs;
+
+    if (mSemaphore) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if ((mSubmittedValue > 0) && (mCompletedValue >= mSubmittedValue)) {
+            mCurrentFrame.queueIdleTime = mRenderStartMs - mLastCompletionMs;
+        }
+    }
+}
+
+void FramePacer::EndRender()
+{
+    const double endMs = mTimer.MillisSinceStart();
+
+    mCurrentFrame.cpuFrameTime = endMs - mRenderStartMs;
+
+    // Without the watcher thread, frames count as complete right away
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (!mSemaphore || mStopping) {
+        mCompletedFrames.push_back(mCurrentFrame);
+        mLastCompletedFrame = mCurrentFrame;
+        mSubmittedValue     = mSubmittedValue + 1;
+        mCompletedValue     = mSubmittedValue;
+        return;
+    }
+    lock.unlock();
+
+    // An empty submit signals once all the work submitted before it,
+    // including the frame's present, has completed.
+    grfx::Semaphore* pSemaphore  = mSemaphore;
+    const uint64_t   signalValue = mSubmittedValue + 1;
+
+    grfx::SubmitInfo submitInfo     = {};
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.ppSignalSemaphores   = &pSemaphore;
+    submitInfo.pSignalValues        = &signalValue;
+
+    Result ppxres = mQueue->Submit(&submitInfo);
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("frame pacer failed to submit frame marker: " << ToString(ppxres));
+        return;
+    }
+
+    lock.lock();
+    mInFlightFrames.push_back({mCurrentFrame, endMs});
+    mSubmittedValue = signalValue;
+    lock.unlock();
+
+    mFrameSubmitted.notify_one();
+}
+
+void FramePacer::GetCompletedFrames(std::vector<ppx::FrameTiming>* pTimings)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    pTimings->insert(pTimings->end(), mCompletedFrames.begin(), mCompletedFrames.end());
+    mCompletedFrames.clear();
+}
+
+ppx::FrameTiming FramePacer::GetLastCompletedFrame() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLastCompletedFrame;
+}
+
+void FramePacer::WatcherMain()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mFrameSubmitted.wait(lock, [this]() { return mStopping || (mCompletedValue < mSubmittedValue); });
+        if (mCompletedValue >= mSubmittedValue) {
+            // Stopping with nothing left in flight
+            break;
+        }
+
+        const uint64_t value = mCompletedValue + 1;
+
+        lock.unlock();
+        Result       ppxres       = mSemaphore->Wait(value);
+        const double completionMs = mTimer.MillisSinceStart();
+        lock.lock();
+
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("frame pacer failed to wait for frame " << value << ": " << ToString(ppxres));
+            mStopping = true;
+            mInFlightFrames.clear();
+            break;
+        }
+
+        InFlightFrame frame = mInFlightFrames.front();
+        mInFlightFrames.pop_front();
+        frame.timing.gpuCompletionLatency = completionMs - frame.submitTimeMs;
+
+        mCompletedFrames.push_back(frame.timing);
+        mLastCompletedFrame = frame.timing;
+        mLastCompletionMs   = completionMs;
+        mCompletedValue     = value;
+        mFrameCompleted.notify_all();
+    }
+
+    // Don't leave WaitForGpu() blocked if waiting failed
+    mCompletedValue = mSubmittedValue;
+    mFrameCompleted.notify_all();
+}
+
+} // namespace ppx
@@ -268,6 +268,88 @@ Result CreateImageFromBitmap(
     return ppx::SUCCESS;
 }
 
+Result CreateImageFromTextureAtlas(
+    grfx::Queue*        pQueue,
+    const TextureAtlas* pAtlas,
+    grfx::Image**       ppImage,
+    const ImageOptions& options)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(pAtlas);
+    PPX_ASSERT_NULL_ARG(ppImage);
+
+    if (!pAtlas->IsBuilt() || (pAtlas->GetLayerCount() == 0)) {
+        return ppx::ERROR_FAILED;
+    }
+
+    Result ppxres = ppx::ERROR_FAILED;
+
+    // Scoped destroy
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+    const TextureAtlasCreateInfo& atlasInfo = pAtlas->GetCreateInfo();
+
+    // Cap mip level count
+    uint32_t maxMipLevelCount = Mipmap::CalculateLevelCount(atlasInfo.width, atlasInfo.height);
+    uint32_t mipLevelCount    = std::min<uint32_t>(options.mMipLevelCount, maxMipLevelCount);
+
+    // Create target image
+    grfx::ImagePtr targetImage;
+    {
+        grfx::ImageCreateInfo ci       = {};
+        ci.type                        = grfx::IMAGE_TYPE_2D;
+        ci.width                       = atlasInfo.width;
+        ci.height                      = atlasInfo.height;
+        ci.depth                       = 1;
+        ci.format                      = ToGrfxFormat(atlasInfo.format);
+        ci.sampleCount                 = grfx::SAMPLE_COUNT_1;
+        ci.mipLevelCount               = mipLevelCount;
+        ci.arrayLayerCount             = pAtlas->GetLayerCount();
+        ci.usageFlags.bits.transferDst = true;
+        ci.usageFlags.bits.sampled     = true;
+        ci.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        ci.initialState                = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+        ci.usageFlags.flags |= options.mAdditionalUsage;
+
+        ppxres = pQueue->GetDevice()->CreateImage(&ci, &targetImage);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(targetImage);
+    }
+
+    // Copy mips of each layer to image
+    for (uint32_t arrayLayer = 0; arrayLayer < pAtlas->GetLayerCount(); ++arrayLayer) {
+        Mipmap mipmap = Mipmap(*pAtlas->GetLayer(arrayLayer), mipLevelCount);
+        if (!mipmap.IsOk()) {
+            return ppx::ERROR_FAILED;
+        }
+
+        for (uint32_t mipLevel = 0; mipLevel < mipLevelCount; ++mipLevel) {
+            ppxres = CopyBitmapToImage(
+                pQueue,
+                mipmap.GetMip(mipLevel),
+                targetImage,
+                mipLevel,
+                arrayLayer,
+                grfx::RESOURCE_STATE_SHADER_RESOURCE,
+                grfx::RESOURCE_STATE_SHADER_RESOURCE);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+        }
+    }
+
+    // Change ownership to reference so object doesn't get destroyed
+    targetImage->SetOwnership(grfx::OWNERSHIP_REFERENCE);
+
+    // Assign output
+    *ppImage = targetImage;
+
+    return ppx::SUCCESS;
+}
+
 Result CreateImageFromBitmapGpu(
     grfx::Queue*        pQueue,
     const Bitmap*       pBitmap,
@@ -73,6 +73,8 @@ Result Buffer::CreateApiObjects(const grfx::BufferCreateInfo* pCreateInfo)
     }
     PPX_LOG_OBJECT_CREATION(D3D12Resource(Buffer), mResource.Get());
 
+    mMemorySize = static_cast<uint64_t>(mAllocation->GetSize());
+
     return ppx::SUCCESS;
 }
 
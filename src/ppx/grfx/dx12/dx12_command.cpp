@@ -155,11 +155,16 @@ Result CommandBuffer::Begin()
     mHeapOffsetCBVSRVUAV = 0;
     mHeapOffsetSampler   = 0;
 
+    // Barriers left from a command list that was never closed
+    mPendingBarriers.clear();
+
     return ppx::SUCCESS;
 }
 
 Result CommandBuffer::End()
 {
+    FlushBarriers();
+
     HRESULT hr = mCommandList->Close();
     if (FAILED(hr)) {
         PPX_ASSERT_MSG(false, "ID3D12CommandList::Close failed");
@@ -169,26 +174,29 @@ Result CommandBuffer::End()
     return ppx::SUCCESS;
 }
 
-void CommandBuffer::BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo)
+void CommandBuffer::SetRenderTargets(
+    uint32_t                             renderTargetCount,
+    const grfx::RenderTargetView* const* ppRenderTargetViews,
+    const grfx::DepthStencilView*        pDepthStencilView,
+    uint32_t                             clearValueCount,
+    const grfx::RenderTargetClearValue*  pRTVClearValues,
+    const grfx::DepthStencilClearValue&  DSVClearValue)
 {
-    PPX_ASSERT_NULL_ARG(pBeginInfo->pRenderPass);
-
-    const grfx::RenderPass* pRenderPass = pBeginInfo->pRenderPass;
+    FlushBarriers();
 
     D3D12_CPU_DESCRIPTOR_HANDLE renderTargetDescriptors[PPX_MAX_RENDER_TARGETS] = {};
     D3D12_CPU_DESCRIPTOR_HANDLE depthStencilDesciptor                           = {};
 
     // Get handle to render target descirptors
-    uint32_t renderTargetCount = pRenderPass->GetRenderTargetCount();
     for (uint32_t i = 0; i < renderTargetCount; ++i) {
-        dx12::RenderTargetView* pRTV = ToApi(pRenderPass->GetRenderTargetView(i).Get());
-        renderTargetDescriptors[i]   = pRTV->GetCpuDescriptorHandle();
+        const dx12::RenderTargetView* pRTV = ToApi(ppRenderTargetViews[i]);
+        renderTargetDescriptors[i]         = pRTV->GetCpuDescriptorHandle();
     }
 
     // Get handle for depth stencil descriptor
     bool hasDepthStencil = false;
-    if (pRenderPass->GetDepthStencilView()) {
-        depthStencilDesciptor = ToApi(pRenderPass->GetDepthStencilView())->GetCpuDescriptorHandle();
+    if (!IsNull(pDepthStencilView)) {
+        depthStencilDesciptor = ToApi(pDepthStencilView)->GetCpuDescriptorHandle();
         hasDepthStencil       = true;
     }
 
@@ -200,46 +208,83 @@ void CommandBuffer::BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginI
         hasDepthStencil ? &depthStencilDesciptor : nullptr);
 
     // Clear render targets if load op is clear
-    renderTargetCount = std::min(renderTargetCount, pBeginInfo->RTVClearCount);
+    renderTargetCount = std::min(renderTargetCount, clearValueCount);
     for (uint32_t i = 0; i < renderTargetCount; ++i) {
-        grfx::AttachmentLoadOp loadOp = pRenderPass->GetRenderTargetView(i)->GetLoadOp();
+        grfx::AttachmentLoadOp loadOp = ppRenderTargetViews[i]->GetLoadOp();
         if (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
             const D3D12_CPU_DESCRIPTOR_HANDLE&  handle     = renderTargetDescriptors[i];
-            const grfx::RenderTargetClearValue& clearValue = pBeginInfo->RTVClearValues[i];
+            const grfx::RenderTargetClearValue& clearValue = pRTVClearValues[i];
             mCommandList->ClearRenderTargetView(handle, clearValue.rgba, 0, nullptr);
         }
     }
 
     // Clear depth/stencil if load op is clear
-    // if (hasDepthStencil && (pRenderPass->GetDepthStencilView()->GetDepthLoadOp() == grfx::ATTACHMENT_LOAD_OP_CLEAR)) {
     if (hasDepthStencil) {
         D3D12_CLEAR_FLAGS flags = static_cast<D3D12_CLEAR_FLAGS>(0);
-        if (pRenderPass->GetDepthStencilView()->GetDepthLoadOp() == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
+        if (pDepthStencilView->GetDepthLoadOp() == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
             flags |= D3D12_CLEAR_FLAG_DEPTH;
         }
-        if (pRenderPass->GetDepthStencilView()->GetStencilLoadOp() == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
+        if (pDepthStencilView->GetStencilLoadOp() == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
             flags |= D3D12_CLEAR_FLAG_STENCIL;
         }
 
         if (flags != static_cast<D3D12_CLEAR_FLAGS>(0)) {
-            const grfx::DepthStencilClearValue& clearValue = pBeginInfo->DSVClearValue;
             mCommandList->ClearDepthStencilView(
                 depthStencilDesciptor,
                 flags,
-                static_cast<FLOAT>(clearValue.depth),
-                static_cast<UINT8>(clearValue.stencil),
+                static_cast<FLOAT>(DSVClearValue.depth),
+                static_cast<UINT8>(DSVClearValue.stencil),
                 0,
                 nullptr);
         }
     }
 }
 
+void CommandBuffer::BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginInfo)
+{
+    PPX_ASSERT_NULL_ARG(pBeginInfo->pRenderPass);
+
+    const grfx::RenderPass* pRenderPass = pBeginInfo->pRenderPass;
+
+    const grfx::RenderTargetView* renderTargetViews[PPX_MAX_RENDER_TARGETS] = {};
+
+    uint32_t renderTargetCount = pRenderPass->GetRenderTargetCount();
+    for (uint32_t i = 0; i < renderTargetCount; ++i) {
+        renderTargetViews[i] = pRenderPass->GetRenderTargetView(i).Get();
+    }
+
+    SetRenderTargets(
+        renderTargetCount,
+        renderTargetViews,
+        pRenderPass->GetDepthStencilView().Get(),
+        pBeginInfo->RTVClearCount,
+        pBeginInfo->RTVClearValues,
+        pBeginInfo->DSVClearValue);
+}
+
 void CommandBuffer::EndRenderPassImpl()
 {
     // Nothing to do here for now
 }
 
-void CommandBuffer::TransitionImageLayout(
+void CommandBuffer::BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo)
+{
+    // D3D12 has no render pass objects, the render targets are set directly
+    SetRenderTargets(
+        pRenderingInfo->renderTargetCount,
+        pRenderingInfo->pRenderTargetViews,
+        pRenderingInfo->pDepthStencilView,
+        pRenderingInfo->renderTargetCount,
+        pRenderingInfo->RTVClearValues,
+        pRenderingInfo->DSVClearValue);
+}
+
+void CommandBuffer::EndRenderingImpl()
+{
+    // Nothing to do here for now
+}
+
+void CommandBuffer::TransitionImageLayoutImpl(
     const grfx::Image*  pImage,
     uint32_t            mipLevel,
     uint32_t            mipLevelCount,
@@ -273,7 +318,9 @@ void CommandBuffer::TransitionImageLayout(
 
     grfx::CommandType commandType = GetCommandType();
 
-    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    // D3D12 applies barriers in order within one ResourceBarrier call, so
+    // they're appended as is.
+    size_t barrierCount = mPendingBarriers.size();
     if (allSubresources) {
         D3D12_RESOURCE_BARRIER barrier = {};
         barrier.Type                   = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -283,7 +330,7 @@ void CommandBuffer::TransitionImageLayout(
         barrier.Transition.StateBefore = ToD3D12ResourceStates(beforeState, commandType);
         barrier.Transition.StateAfter  = ToD3D12ResourceStates(afterState, commandType);
 
-        barriers.push_back(barrier);
+        mPendingBarriers.push_back(barrier);
     }
     else {
         //
@@ -306,21 +353,17 @@ void CommandBuffer::TransitionImageLayout(
                 barrier.Transition.StateBefore = ToD3D12ResourceStates(beforeState, commandType);
                 barrier.Transition.StateAfter  = ToD3D12ResourceStates(afterState, commandType);
 
-                barriers.push_back(barrier);
+                mPendingBarriers.push_back(barrier);
             }
         }
     }
 
-    if (barriers.empty()) {
+    if (mPendingBarriers.size() == barrierCount) {
         PPX_ASSERT_MSG(false, "parameters resulted in no barriers - try not to do this!")
     }
-
-    mCommandList->ResourceBarrier(
-        static_cast<UINT>(barriers.size()),
-        DataPtr(barriers));
 }
 
-void CommandBuffer::BufferResourceBarrier(
+void CommandBuffer::BufferResourceBarrierImpl(
     const grfx::Buffer* pBuffer,
     grfx::ResourceState beforeState,
     grfx::ResourceState afterState,
@@ -345,7 +388,20 @@ void CommandBuffer::BufferResourceBarrier(
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
     barrier.Transition.StateBefore = ToD3D12ResourceStates(beforeState, commandType);
     barrier.Transition.StateAfter  = ToD3D12ResourceStates(afterState, commandType);
-    mCommandList->ResourceBarrier(1, &barrier);
+    mPendingBarriers.push_back(barrier);
+}
+
+void CommandBuffer::FlushBarriers()
+{
+    if (mPendingBarriers.empty()) {
+        return;
+    }
+
+    mCommandList->ResourceBarrier(
+        static_cast<UINT>(mPendingBarriers.size()),
+        DataPtr(mPendingBarriers));
+
+    mPendingBarriers.clear();
 }
 
 void CommandBuffer::SetViewports(
@@ -384,8 +440,11 @@ void CommandBuffer::BindDescriptorSets(
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
     const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets,
     size_t&                           rdtCountCBVSRVUAV,
-    size_t&                           rdtCountSampler)
+    size_t&                           rdtCountSampler,
+    size_t&                           rdCount)
 {
     dx12::Device*                  pApiDevice             = ToApi(GetDevice());
     D3D12DevicePtr                 device                 = pApiDevice->GetDxDevice();
@@ -400,9 +459,11 @@ void CommandBuffer::BindDescriptorSets(
         mRootDescriptorTablesSampler.resize(parameterIndexCount);
     }
 
-    // Root descriptor tables
-    rdtCountCBVSRVUAV = 0;
-    rdtCountSampler   = 0;
+    // Root descriptor tables and root descriptors
+    rdtCountCBVSRVUAV           = 0;
+    rdtCountSampler             = 0;
+    rdCount                     = 0;
+    uint32_t dynamicOffsetIndex = 0;
     for (uint32_t setIndex = 0; setIndex < setCount; ++setIndex) {
         PPX_ASSERT_MSG(ppSets[setIndex] != nullptr, "ppSets[" << setIndex << "] is null");
         uint32_t                   set      = setNumbers[setIndex];
@@ -440,10 +501,32 @@ void CommandBuffer::BindDescriptorSets(
             }
         }
 
+        // Root descriptors, these take one dynamic offset each
+        for (const dx12::DescriptorSet::RootDescriptor& rootDescriptor : pApiSet->GetRootDescriptors()) {
+            UINT parameterIndex = pApiPipelineInterface->FindParameterIndex(set, rootDescriptor.binding);
+            PPX_ASSERT_MSG(parameterIndex != UINT32_MAX, "invalid parameter index for set=" << set << ", binding=" << rootDescriptor.binding);
+            PPX_ASSERT_MSG(dynamicOffsetIndex < dynamicOffsetCount, "not enough dynamic offsets for set=" << set << ", binding=" << rootDescriptor.binding);
+
+            if (rdCount >= mRootDescriptors.size()) {
+                mRootDescriptors.resize(rdCount + 1);
+            }
+            RootDescriptor& rd = mRootDescriptors[rdCount];
+            rd.parameterIndex  = parameterIndex;
+            rd.isConstant      = (rootDescriptor.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+            rd.bufferLocation  = rootDescriptor.bufferLocation + static_cast<D3D12_GPU_VIRTUAL_ADDRESS>(pDynamicOffsets[dynamicOffsetIndex]);
+
+            dynamicOffsetIndex += 1;
+            rdCount += 1;
+        }
+
         size_t bindingCount = bindings.size();
         for (size_t bindingIndex = 0; bindingIndex < bindingCount; ++bindingIndex) {
-            auto& binding        = bindings[bindingIndex];
-            UINT  parameterIndex = pApiPipelineInterface->FindParameterIndex(set, binding.binding);
+            auto& binding = bindings[bindingIndex];
+            if ((binding.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) || (binding.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
+                continue;
+            }
+
+            UINT parameterIndex = pApiPipelineInterface->FindParameterIndex(set, binding.binding);
             PPX_ASSERT_MSG(parameterIndex != UINT32_MAX, "invalid parameter index for set=" << set << ", binding=" << binding.binding);
 
             if (binding.type == grfx::DESCRIPTOR_TYPE_SAMPLER) {
@@ -466,20 +549,24 @@ void CommandBuffer::BindDescriptorSets(
             }
         }
     }
+    PPX_ASSERT_MSG(dynamicOffsetIndex == dynamicOffsetCount, "dynamicOffsetCount (" << dynamicOffsetCount << ") does not match the number of dynamic bindings in the sets (" << dynamicOffsetIndex << ")");
 }
 
 void CommandBuffer::BindGraphicsDescriptorSets(
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
-    const grfx::DescriptorSet* const* ppSets)
+    const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets)
 {
     // Set root signature
     mCommandList->SetGraphicsRootSignature(ToApi(pInterface)->GetDxRootSignature().Get());
 
-    // Fill out mRootDescriptorTablesCBVSRVUAV and mRootDescriptorTablesSampler
+    // Fill out mRootDescriptorTablesCBVSRVUAV, mRootDescriptorTablesSampler and mRootDescriptors
     size_t rdtCountCBVSRVUAV = 0;
     size_t rdtCountSampler   = 0;
-    BindDescriptorSets(pInterface, setCount, ppSets, rdtCountCBVSRVUAV, rdtCountSampler);
+    size_t rdCount           = 0;
+    BindDescriptorSets(pInterface, setCount, ppSets, dynamicOffsetCount, pDynamicOffsets, rdtCountCBVSRVUAV, rdtCountSampler, rdCount);
 
     // Set CBVSRVUAV root descriptor tables
     for (uint32_t i = 0; i < rdtCountCBVSRVUAV; ++i) {
@@ -492,6 +579,17 @@ void CommandBuffer::BindGraphicsDescriptorSets(
         const RootDescriptorTable& rdt = mRootDescriptorTablesSampler[i];
         mCommandList->SetGraphicsRootDescriptorTable(rdt.parameterIndex, rdt.baseDescriptor);
     }
+
+    // Set dynamic buffer root descriptors
+    for (uint32_t i = 0; i < rdCount; ++i) {
+        const RootDescriptor& rd = mRootDescriptors[i];
+        if (rd.isConstant) {
+            mCommandList->SetGraphicsRootConstantBufferView(rd.parameterIndex, rd.bufferLocation);
+        }
+        else {
+            mCommandList->SetGraphicsRootUnorderedAccessView(rd.parameterIndex, rd.bufferLocation);
+        }
+    }
 }
 
 void CommandBuffer::BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline)
@@ -503,15 +601,18 @@ void CommandBuffer::BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline
 void CommandBuffer::BindComputeDescriptorSets(
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
-    const grfx::DescriptorSet* const* ppSets)
+    const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets)
 {
     // Set root signature
     mCommandList->SetComputeRootSignature(ToApi(pInterface)->GetDxRootSignature().Get());
 
-    // Fill out mRootDescriptorTablesCBVSRVUAV and mRootDescriptorTablesSampler
+    // Fill out mRootDescriptorTablesCBVSRVUAV, mRootDescriptorTablesSampler and mRootDescriptors
     size_t rdtCountCBVSRVUAV = 0;
     size_t rdtCountSampler   = 0;
-    BindDescriptorSets(pInterface, setCount, ppSets, rdtCountCBVSRVUAV, rdtCountSampler);
+    size_t rdCount           = 0;
+    BindDescriptorSets(pInterface, setCount, ppSets, dynamicOffsetCount, pDynamicOffsets, rdtCountCBVSRVUAV, rdtCountSampler, rdCount);
 
     // Set CBVSRVUAV root descriptor tables
     for (uint32_t i = 0; i < rdtCountCBVSRVUAV; ++i) {
@@ -524,6 +625,17 @@ void CommandBuffer::BindComputeDescriptorSets(
         const RootDescriptorTable& rdt = mRootDescriptorTablesSampler[i];
         mCommandList->SetComputeRootDescriptorTable(rdt.parameterIndex, rdt.baseDescriptor);
     }
+
+    // Set dynamic buffer root descriptors
+    for (uint32_t i = 0; i < rdCount; ++i) {
+        const RootDescriptor& rd = mRootDescriptors[i];
+        if (rd.isConstant) {
+            mCommandList->SetComputeRootConstantBufferView(rd.parameterIndex, rd.bufferLocation);
+        }
+        else {
+            mCommandList->SetComputeRootUnorderedAccessView(rd.parameterIndex, rd.bufferLocation);
+        }
+    }
 }
 
 void CommandBuffer::BindComputePipeline(const grfx::ComputePipeline* pPipeline)
@@ -565,6 +677,7 @@ void CommandBuffer::Draw(
     uint32_t firstVertex,
     uint32_t firstInstance)
 {
+    FlushBarriers();
     mCommandList->DrawInstanced(
         static_cast<UINT>(vertexCount),
         static_cast<UINT>(instanceCount),
@@ -579,6 +692,7 @@ void CommandBuffer::DrawIndexed(
     int32_t  vertexOffset,
     uint32_t firstInstance)
 {
+    FlushBarriers();
     mCommandList->DrawIndexedInstanced(
         static_cast<UINT>(indexCount),
         static_cast<UINT>(instanceCount),
@@ -587,11 +701,31 @@ void CommandBuffer::DrawIndexed(
         static_cast<UINT>(firstInstance));
 }
 
+void CommandBuffer::DrawIndexedIndirect(
+    const grfx::Buffer* pArgBuffer,
+    uint64_t            offset,
+    uint32_t            drawCount,
+    uint32_t            stride)
+{
+    PPX_ASSERT_NULL_ARG(pArgBuffer);
+    PPX_ASSERT_MSG(stride == sizeof(grfx::DrawIndexedIndirectCommand), "D3D12 indirect arguments must be tightly packed");
+
+    FlushBarriers();
+    mCommandList->ExecuteIndirect(
+        ToApi(GetDevice())->GetDrawIndexedIndirectSignature(),
+        static_cast<UINT>(drawCount),
+        ToApi(pArgBuffer)->GetDxResource(),
+        static_cast<UINT64>(offset),
+        nullptr,
+        0);
+}
+
 void CommandBuffer::Dispatch(
     uint32_t groupCountX,
     uint32_t groupCountY,
     uint32_t groupCountZ)
 {
+    FlushBarriers();
     mCommandList->Dispatch(
         static_cast<UINT>(groupCountX),
         static_cast<UINT>(groupCountY),
@@ -603,6 +737,7 @@ void CommandBuffer::CopyBufferToBuffer(
     grfx::Buffer*                       pSrcBuffer,
     grfx::Buffer*                       pDstBuffer)
 {
+    FlushBarriers();
     mCommandList->CopyBufferRegion(
         ToApi(pDstBuffer)->GetDxResource(),
         static_cast<UINT64>(pCopyInfo->dstBuffer.offset),
@@ -626,6 +761,8 @@ void CommandBuffer::CopyBufferToImage(
     grfx::Buffer*                      pSrcBuffer,
     grfx::Image*                       pDstImage)
 {
+    FlushBarriers();
+
     D3D12DevicePtr      device        = ToApi(GetDevice())->GetDxDevice();
     D3D12_RESOURCE_DESC resouceDesc   = ToApi(pDstImage)->GetDxResource()->GetDesc();
     const uint32_t      mipLevelCount = pDstImage->GetMipLevelCount();
@@ -687,6 +824,8 @@ grfx::ImageToBufferOutputPitch CommandBuffer::CopyImageToBuffer(
     grfx::Image*                       pSrcImage,
     grfx::Buffer*                      pDstBuffer)
 {
+    FlushBarriers();
+
     D3D12DevicePtr      device      = ToApi(GetDevice())->GetDxDevice();
     D3D12_RESOURCE_DESC resouceDesc = ToApi(pSrcImage)->GetDxResource()->GetDesc();
 
@@ -769,6 +908,8 @@ void CommandBuffer::CopyImageToImage(
     bool isDestDepthStencil   = grfx::GetFormatDescription(pDstImage->GetFormat())->aspect == grfx::FORMAT_ASPECT_DEPTH_STENCIL;
     PPX_ASSERT_MSG(isSourceDepthStencil == isDestDepthStencil, "both images in an image copy must be depth-stencil if one is depth-stencil");
 
+    FlushBarriers();
+
     // For depth-stencil images, each plane must be copied separately.
     uint32_t numPlanesToCopy = isSourceDepthStencil ? 2 : 1;
 
@@ -814,6 +955,7 @@ void CommandBuffer::BeginQuery(
     PPX_ASSERT_NULL_ARG(pQuery);
     PPX_ASSERT_MSG(queryIndex <= pQuery->GetCount(), "invalid query index");
 
+    FlushBarriers();
     mCommandList->BeginQuery(
         ToApi(pQuery)->GetDxQueryHeap(),
         ToD3D12QueryType(pQuery->GetType()),
@@ -827,6 +969,7 @@ void CommandBuffer::EndQuery(
     PPX_ASSERT_NULL_ARG(pQuery);
     PPX_ASSERT_MSG(queryIndex <= pQuery->GetCount(), "invalid query index");
 
+    FlushBarriers();
     mCommandList->EndQuery(
         ToApi(pQuery)->GetDxQueryHeap(),
         ToD3D12QueryType(pQuery->GetType()),
@@ -849,6 +992,8 @@ void CommandBuffer::WriteTimestamp(
     //          [ EXECUTION ERROR #731: BEGIN_END_QUERY_INVALID_PARAMETERS]
     //
     PPX_ASSERT_MSG(ToApi(pQuery)->GetQueryType() == D3D12_QUERY_TYPE_TIMESTAMP, "invalid query type");
+
+    FlushBarriers();
     mCommandList->EndQuery(
         ToApi(pQuery)->GetDxQueryHeap(),
         D3D12_QUERY_TYPE_TIMESTAMP,
@@ -861,6 +1006,7 @@ void CommandBuffer::ResolveQueryData(
     uint32_t     numQueries)
 {
     PPX_ASSERT_MSG((startIndex + numQueries) <= pQuery->GetCount(), "invalid query index/number");
+    FlushBarriers();
     mCommandList->ResolveQueryData(ToApi(pQuery)->GetDxQueryHeap(), ToApi(pQuery)->GetQueryType(), startIndex, numQueries, ToApi(pQuery)->GetReadBackBuffer(), 0);
 }
 
@@ -21,10 +21,14 @@
 //
 // D3D12 doesn't have the following descriptor types:
 //   DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
-//   DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
-//   DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
 //   DESCRIPTOR_TYPE_INPUT_ATTACHMENT
 //
+// DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC and DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
+// are root CBVs and UAVs instead of heap descriptors. The set only stores
+// the buffer's GPU virtual address, and the dynamic offset passed at bind
+// time is added to it when the root descriptor is set. Root descriptors
+// can't be arrays, so these bindings must have an arrayCount of 1.
+//
 
 namespace ppx {
 namespace grfx {
@@ -38,15 +42,15 @@ const uint32_t END_OF_HEAP_BINDING_ID = UINT32_MAX;
 Result DescriptorPool::CreateApiObjects(const grfx::DescriptorPoolCreateInfo* pCreateInfo)
 {
     bool hasCombinedImageSampler = (pCreateInfo->combinedImageSampler > 0);
-    bool hasUniformBufferDynamic = (pCreateInfo->uniformBufferDynamic > 0);
-    bool hasStorageBufferDynamic = (pCreateInfo->storageBufferDynamic > 0);
     bool hasInputAtachment       = (pCreateInfo->inputAttachment > 0);
-    bool hasUnsupported          = hasCombinedImageSampler || hasUniformBufferDynamic || hasStorageBufferDynamic || hasInputAtachment;
+    bool hasUnsupported          = hasCombinedImageSampler || hasInputAtachment;
     if (hasUnsupported) {
         return ppx::ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE;
     }
 
-    // Get totals for each descriptor type
+    // Get totals for each descriptor type. Dynamic buffers are root
+    // descriptors and don't take up any heap space.
+    //
     mDescriptorCountCBVSRVUAV = pCreateInfo->sampledImage +
                                 pCreateInfo->storageImage +
                                 pCreateInfo->uniformTexelBuffer +
@@ -217,6 +221,14 @@ Result DescriptorSet::CreateApiObjects(const grfx::internal::DescriptorSetCreate
         }
     }
 
+    // Root descriptors for dynamic buffers, in binding order
+    for (const grfx::DescriptorBinding& binding : ToApi(pCreateInfo->pLayout)->GetDynamicBindings()) {
+        RootDescriptor rootDescriptor = {};
+        rootDescriptor.binding        = binding.binding;
+        rootDescriptor.type           = binding.type;
+        mRootDescriptors.push_back(rootDescriptor);
+    }
+
     return ppx::SUCCESS;
 }
 
@@ -228,6 +240,7 @@ void DescriptorSet::DestroyApiObjects()
     mNumDescriptorsSampler   = 0;
 
     mHeapOffsets.clear();
+    mRootDescriptors.clear();
 
     if (mHeapCBVSRVUAV) {
         mHeapCBVSRVUAV.Reset();
@@ -244,10 +257,8 @@ Result DescriptorSet::UpdateDescriptors(uint32_t writeCount, const grfx::WriteDe
     for (uint32_t writeIndex = 0; writeIndex < writeCount; ++writeIndex) {
         const grfx::WriteDescriptor& srcWrite               = pWrites[writeIndex];
         bool                         isCombinedImageSampler = (srcWrite.type == grfx::DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        bool                         isUniformBufferDynamic = (srcWrite.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
-        bool                         isStorageBufferDynamic = (srcWrite.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
         bool                         isInputAtachment       = (srcWrite.type == grfx::DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
-        bool                         isUnsupported          = isCombinedImageSampler || isUniformBufferDynamic || isStorageBufferDynamic || isInputAtachment;
+        bool                         isUnsupported          = isCombinedImageSampler || isInputAtachment;
         if (isUnsupported) {
             return ppx::ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE;
         }
@@ -260,6 +271,19 @@ Result DescriptorSet::UpdateDescriptors(uint32_t writeCount, const grfx::WriteDe
     for (uint32_t writeIndex = 0; writeIndex < writeCount; ++writeIndex) {
         const grfx::WriteDescriptor& srcWrite = pWrites[writeIndex];
 
+        // Dynamic buffers only store the address, the offset passed at bind
+        // time is added to it when the root descriptor is set.
+        //
+        if ((srcWrite.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) || (srcWrite.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
+            auto it = FindIf(mRootDescriptors, [srcWrite](const RootDescriptor& elem) -> bool { return elem.binding == srcWrite.binding; });
+            if (it == std::end(mRootDescriptors)) {
+                PPX_ASSERT_MSG(false, "attempted to update dynamic binding " << srcWrite.binding << " but binding is not in set");
+                return ppx::ERROR_GRFX_BINDING_NOT_IN_SET;
+            }
+            it->bufferLocation = ToApi(srcWrite.pBuffer)->GetDxResource()->GetGPUVirtualAddress() + srcWrite.bufferOffset;
+            continue;
+        }
+
         // Find heap offset
         auto it = FindIf(mHeapOffsets, [srcWrite](const HeapOffset& elem) -> bool { return elem.binding == srcWrite.binding; });
         if (it == std::end(mHeapOffsets)) {
@@ -386,10 +410,8 @@ Result DescriptorSetLayout::CreateApiObjects(const grfx::DescriptorSetLayoutCrea
         const grfx::DescriptorBinding& binding = pCreateInfo->bindings[i];
 
         bool isCombinedImageSampler = (binding.type == grfx::DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        bool isUniformBufferDynamic = (binding.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
-        bool isStorageBufferDynamic = (binding.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
         bool isInputAtachment       = (binding.type == grfx::DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
-        bool isUnsupported          = isCombinedImageSampler || isUniformBufferDynamic || isStorageBufferDynamic || isInputAtachment;
+        bool isUnsupported          = isCombinedImageSampler || isInputAtachment;
         if (isUnsupported) {
             return ppx::ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE;
         }
@@ -399,6 +421,17 @@ Result DescriptorSetLayout::CreateApiObjects(const grfx::DescriptorSetLayoutCrea
     for (size_t i = 0; i < pCreateInfo->bindings.size(); ++i) {
         const grfx::DescriptorBinding& binding = pCreateInfo->bindings[i];
 
+        // Dynamic buffers become root descriptors, which can't be arrays
+        bool isDynamic = (binding.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) || (binding.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+        if (isDynamic) {
+            if (binding.arrayCount != 1) {
+                PPX_ASSERT_MSG(false, "D3D12 dynamic buffer bindings must have an arrayCount of 1 (binding=" << binding.binding << ")");
+                return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+            }
+            mDynamicBindings.push_back(binding);
+            continue;
+        }
+
         mCountCBVSRVUAV += (binding.type == grfx::DESCRIPTOR_TYPE_SAMPLER) ? 0 : binding.arrayCount;
         mCountSampler += (binding.type == grfx::DESCRIPTOR_TYPE_SAMPLER) ? binding.arrayCount : 0;
 
@@ -411,6 +444,12 @@ Result DescriptorSetLayout::CreateApiObjects(const grfx::DescriptorSetLayoutCrea
         pRanges->push_back(info);
     }
 
+    // Dynamic offsets are consumed in binding order
+    std::sort(
+        mDynamicBindings.begin(),
+        mDynamicBindings.end(),
+        [](const grfx::DescriptorBinding& a, const grfx::DescriptorBinding& b) -> bool { return a.binding < b.binding; });
+
     return ppx::SUCCESS;
 }
 
@@ -420,6 +459,7 @@ void DescriptorSetLayout::DestroyApiObjects()
     mCountSampler   = 0;
     mRangesCBVSRVUAV.clear();
     mRangesSampler.clear();
+    mDynamicBindings.clear();
 }
 
 } // namespace dx12
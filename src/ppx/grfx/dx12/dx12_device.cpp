@@ -218,6 +218,24 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
         }
     }
 
+    // Indirect draw command signature
+    {
+        D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+        argumentDesc.Type                         = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+        D3D12_COMMAND_SIGNATURE_DESC desc = {};
+        desc.ByteStride                   = static_cast<UINT>(sizeof(grfx::DrawIndexedIndirectCommand));
+        desc.NumArgumentDescs             = 1;
+        desc.pArgumentDescs               = &argumentDesc;
+        desc.NodeMask                     = 0;
+
+        hr = mDevice->CreateCommandSignature(&desc, nullptr, IID_PPV_ARGS(&mDrawIndexedIndirectSignature));
+        if (FAILED(hr)) {
+            PPX_ASSERT_MSG(false, "ID3D12Device::CreateCommandSignature failed");
+            return ppx::ERROR_API_FAILURE;
+        }
+    }
+
     // Load root signature functions
     LoadRootSignatureFunctions();
 
@@ -266,6 +284,10 @@ void Device::DestroyApiObjects()
     mRTVHandleManager.Destroy();
     mDSVHandleManager.Destroy();
 
+    if (mDrawIndexedIndirectSignature) {
+        mDrawIndexedIndirectSignature.Reset();
+    }
+
     if (mAllocator) {
         mAllocator->Release();
         mAllocator.Reset();
@@ -618,6 +640,53 @@ bool Device::PipelineStatsAvailable() const
     return true;
 }
 
+bool Device::TimelineSemaphoreSupported() const
+{
+    return true;
+}
+
+Result Device::GetPipelineCacheData(std::vector<char>* pData) const
+{
+    return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+}
+
+Result Device::LoadPipelineCacheData(const void* pData, size_t size)
+{
+    return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+}
+
+Result Device::QueryMemoryStats(bool detailed, grfx::MemoryStats* pStats) const
+{
+    // D3D12MA reports the local (video memory) segment group and, on discrete
+    // adapters, the non-local (system memory) one.
+    D3D12MA::Budget localBudget    = {};
+    D3D12MA::Budget nonLocalBudget = {};
+    mAllocator->GetBudget(&localBudget, &nonLocalBudget);
+
+    const bool isUMA = mAllocator->IsUMA();
+    pStats->heaps.resize(isUMA ? 1 : 2);
+    for (size_t i = 0; i < pStats->heaps.size(); ++i) {
+        const D3D12MA::Budget& budget = (i == 0) ? localBudget : nonLocalBudget;
+        grfx::MemoryHeapStats& heap   = pStats->heaps[i];
+        heap.deviceLocal              = (i == 0);
+        heap.usage                    = budget.UsageBytes;
+        heap.budget                   = budget.BudgetBytes;
+        heap.blockBytes               = budget.Stats.BlockBytes;
+        heap.allocationBytes          = budget.Stats.AllocationBytes;
+        heap.blockCount               = budget.Stats.BlockCount;
+        heap.allocationCount          = budget.Stats.AllocationCount;
+    }
+
+    if (detailed) {
+        D3D12MA::TotalStatistics totalStats = {};
+        mAllocator->CalculateStatistics(&totalStats);
+        pStats->unusedRangeCount   = totalStats.Total.UnusedRangeCount;
+        pStats->largestUnusedRange = totalStats.Total.UnusedRangeSizeMax;
+    }
+
+    return ppx::SUCCESS;
+}
+
 bool Device::DynamicRenderingSupported() const
 {
     return mRenderPassTier > D3D12_RENDER_PASS_TIER_0;
@@ -633,6 +702,11 @@ bool Device::FragmentStoresAndAtomicsSupported() const
     return true;
 }
 
+bool Device::SampledImageArrayDynamicIndexingSupported() const
+{
+    return true;
+}
+
 } // namespace dx12
 } // namespace grfx
 } // namespace ppx
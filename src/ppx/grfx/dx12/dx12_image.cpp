@@ -98,6 +98,8 @@ Result Image::CreateApiObjects(const grfx::ImageCreateInfo* pCreateInfo)
             return ppx::ERROR_API_FAILURE;
         }
         PPX_LOG_OBJECT_CREATION(D3D12Resource(Image), mResource.Get());
+
+        mMemorySize = static_cast<uint64_t>(mAllocation->GetSize());
     }
     else {
         CComPtr<ID3D12Resource> resource = static_cast<ID3D12Resource*>(pCreateInfo->pApiObject);
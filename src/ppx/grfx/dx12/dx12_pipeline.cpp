@@ -289,6 +289,30 @@ Result PipelineInterface::CreateApiObjects(const grfx::PipelineInterfaceCreateIn
         for (size_t bindingIndex = 0; bindingIndex < bindings.size(); ++bindingIndex) {
             const grfx::DescriptorBinding& binding = bindings[bindingIndex];
 
+            // Dynamic buffers are root descriptors so the offset can change
+            // per draw without touching the descriptor heap
+            //
+            bool isUniformBufferDynamic = (binding.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+            bool isStorageBufferDynamic = (binding.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+            if (isUniformBufferDynamic || isStorageBufferDynamic) {
+                // Fill out parameter
+                D3D12_ROOT_PARAMETER1 parameter     = {};
+                parameter.ParameterType             = isUniformBufferDynamic ? D3D12_ROOT_PARAMETER_TYPE_CBV : D3D12_ROOT_PARAMETER_TYPE_UAV;
+                parameter.Descriptor.ShaderRegister = static_cast<UINT>(binding.binding);
+                parameter.Descriptor.RegisterSpace  = static_cast<UINT>(set);
+                parameter.Descriptor.Flags          = isUniformBufferDynamic ? D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE : D3D12_ROOT_DESCRIPTOR_FLAG_NONE;
+                parameter.ShaderVisibility          = ToD3D12ShaderVisibliity(binding.shaderVisiblity);
+                // Store parameter
+                parameters.push_back(parameter);
+                // Store parameter index
+                ParameterIndex paramIndex = {};
+                paramIndex.set            = set;
+                paramIndex.binding        = binding.binding;
+                paramIndex.index          = static_cast<UINT>(parameters.size() - 1);
+                mParameterIndices.push_back(paramIndex);
+                continue;
+            }
+
             // Allocate unique range
             std::unique_ptr<D3D12_DESCRIPTOR_RANGE1> range = std::make_unique<D3D12_DESCRIPTOR_RANGE1>();
             if (!range) {
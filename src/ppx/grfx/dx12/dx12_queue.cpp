@@ -83,8 +83,14 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
     }
 
     for (uint32_t i = 0; i < pSubmitInfo->waitSemaphoreCount; ++i) {
-        ID3D12Fence* pDxFence = ToApi(pSubmitInfo->ppWaitSemaphores[i])->GetDxFence();
-        UINT64       value    = ToApi(pSubmitInfo->ppWaitSemaphores[i])->GetWaitForValue();
+        const dx12::Semaphore* pSemaphore = ToApi(pSubmitInfo->ppWaitSemaphores[i]);
+        if (pSemaphore->IsTimeline() && IsNull(pSubmitInfo->pWaitValues)) {
+            PPX_ASSERT_MSG(false, "timeline semaphore wait requires SubmitInfo::pWaitValues");
+            return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+        }
+
+        ID3D12Fence* pDxFence = pSemaphore->GetDxFence();
+        UINT64       value    = pSemaphore->IsTimeline() ? pSubmitInfo->pWaitValues[i] : pSemaphore->GetWaitForValue();
         HRESULT      hr       = mCommandQueue->Wait(pDxFence, value);
         if (FAILED(hr)) {
             PPX_ASSERT_MSG(false, "ID3D12CommandQueue::Wait failed");
@@ -92,13 +98,22 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
         }
     }
 
-    mCommandQueue->ExecuteCommandLists(
-        static_cast<UINT>(pSubmitInfo->commandBufferCount),
-        mListBuffer.data());
+    // Submits with no command lists only wait and signal
+    if (pSubmitInfo->commandBufferCount > 0) {
+        mCommandQueue->ExecuteCommandLists(
+            static_cast<UINT>(pSubmitInfo->commandBufferCount),
+            mListBuffer.data());
+    }
 
     for (uint32_t i = 0; i < pSubmitInfo->signalSemaphoreCount; ++i) {
-        ID3D12Fence* pDxFence = ToApi(pSubmitInfo->ppSignalSemaphores[i])->GetDxFence();
-        UINT64       value    = ToApi(pSubmitInfo->ppSignalSemaphores[i])->GetNextSignalValue();
+        dx12::Semaphore* pSemaphore = ToApi(pSubmitInfo->ppSignalSemaphores[i]);
+        if (pSemaphore->IsTimeline() && IsNull(pSubmitInfo->pSignalValues)) {
+            PPX_ASSERT_MSG(false, "timeline semaphore signal requires SubmitInfo::pSignalValues");
+            return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+        }
+
+        ID3D12Fence* pDxFence = pSemaphore->GetDxFence();
+        UINT64       value    = pSemaphore->IsTimeline() ? pSubmitInfo->pSignalValues[i] : pSemaphore->GetNextSignalValue();
         HRESULT      hr       = mCommandQueue->Signal(pDxFence, value);
         if (FAILED(hr)) {
             PPX_ASSERT_MSG(false, "ID3D12CommandQueue::Signal failed");
@@ -119,6 +134,25 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
     return ppx::SUCCESS;
 }
 
+Result Queue::Submit(uint32_t submitCount, const grfx::SubmitInfo* pSubmitInfos)
+{
+    // D3D12 queues waits, command lists and signals as separate operations,
+    // so a batch is the same as submitting each entry in turn.
+    for (uint32_t i = 0; i < submitCount; ++i) {
+        if (!IsNull(pSubmitInfos[i].pFence) && ((i + 1) < submitCount)) {
+            PPX_ASSERT_MSG(false, "only the last submit info in a batch can have a fence");
+            return ppx::ERROR_FAILED;
+        }
+
+        Result ppxres = Submit(&pSubmitInfos[i]);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
 Result Queue::GetTimestampFrequency(uint64_t* pFrequency) const
 {
     if (IsNull(pFrequency)) {
@@ -256,6 +256,7 @@ Result Swapchain::CreateApiObjects(const grfx::SwapchainCreateInfo* pCreateInfo)
             imageCreateInfo.usageFlags.bits.sampled         = true;
             imageCreateInfo.usageFlags.bits.storage         = true;
             imageCreateInfo.usageFlags.bits.colorAttachment = true;
+            imageCreateInfo.initialState                    = grfx::RESOURCE_STATE_PRESENT;
             imageCreateInfo.pApiObject                      = colorImages[i];
 
             grfx::ImagePtr image;
@@ -34,7 +34,7 @@ Result Fence::CreateApiObjects(const grfx::FenceCreateInfo* pCreateInfo)
     PPX_LOG_OBJECT_CREATION(D3D12Fence(Fence), mFence.Get());
 
     mFenceEventHandle = CreateEventEx(NULL, NULL, false, EVENT_ALL_ACCESS);
-    if (mFenceEventHandle == INVALID_HANDLE_VALUE) {
+    if (mFenceEventHandle == NULL) {
         return ppx::ERROR_API_FAILURE;
     }
 
@@ -85,6 +85,10 @@ Result Semaphore::CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo)
 {
     D3D12_FENCE_FLAGS flags = D3D12_FENCE_FLAG_NONE;
 
+    if (pCreateInfo->semaphoreType == grfx::SEMAPHORE_TYPE_TIMELINE) {
+        mValue = static_cast<UINT64>(pCreateInfo->initialValue);
+    }
+
     HRESULT hr = ToApi(GetDevice())->GetDxDevice()->CreateFence(mValue, flags, IID_PPV_ARGS(&mFence));
     if (FAILED(hr)) {
         PPX_ASSERT_MSG(false, "ID3D12Device::CreateFence(fence) failed");
@@ -92,11 +96,24 @@ Result Semaphore::CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo)
     }
     PPX_LOG_OBJECT_CREATION(D3D12Fence(Semaphore), mFence.Get());
 
+    // Only host waits need an event
+    if (pCreateInfo->semaphoreType == grfx::SEMAPHORE_TYPE_TIMELINE) {
+        mFenceEventHandle = CreateEventEx(NULL, NULL, false, EVENT_ALL_ACCESS);
+        if (mFenceEventHandle == NULL) {
+            return ppx::ERROR_API_FAILURE;
+        }
+    }
+
     return ppx::SUCCESS;
 }
 
 void Semaphore::DestroyApiObjects()
 {
+    if (mFenceEventHandle != nullptr) {
+        CloseHandle(mFenceEventHandle);
+        mFenceEventHandle = nullptr;
+    }
+
     if (mFence) {
         mFence.Reset();
     }
@@ -113,6 +130,46 @@ UINT64 Semaphore::GetWaitForValue() const
     return mValue;
 }
 
+Result Semaphore::TimelineWait(uint64_t value, uint64_t timeout) const
+{
+    if (mFence->GetCompletedValue() >= value) {
+        return ppx::SUCCESS;
+    }
+
+    HRESULT hr = mFence->SetEventOnCompletion(static_cast<UINT64>(value), mFenceEventHandle);
+    if (FAILED(hr)) {
+        PPX_ASSERT_MSG(false, "ID3D12Fence::SetEventOnCompletion failed");
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    DWORD dwMillis = (timeout == UINT64_MAX) ? INFINITE : static_cast<DWORD>(timeout / 1000000ULL);
+    DWORD dwResult = WaitForSingleObjectEx(mFenceEventHandle, dwMillis, false);
+    if (dwResult == WAIT_TIMEOUT) {
+        return ppx::ERROR_WAIT_TIMED_OUT;
+    }
+    if (dwResult != WAIT_OBJECT_0) {
+        return ppx::ERROR_WAIT_FAILED;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Semaphore::TimelineSignal(uint64_t value) const
+{
+    HRESULT hr = mFence->Signal(static_cast<UINT64>(value));
+    if (FAILED(hr)) {
+        PPX_ASSERT_MSG(false, "ID3D12Fence::Signal failed");
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
+uint64_t Semaphore::TimelineCounterValue() const
+{
+    return static_cast<uint64_t>(mFence->GetCompletedValue());
+}
+
 } // namespace dx12
 } // namespace grfx
 } // namespace ppx
@@ -37,6 +37,20 @@ Result Buffer::Create(const grfx::BufferCreateInfo* pCreateInfo)
         return ppxres;
     }
 
+    if (mCreateInfo.memoryCategory == grfx::MEMORY_CATEGORY_UNDEFINED) {
+        if (mCreateInfo.usageFlags.bits.vertexBuffer || mCreateInfo.usageFlags.bits.indexBuffer) {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_MESH;
+        }
+        else if (mCreateInfo.usageFlags.bits.transferSrc && (mCreateInfo.memoryUsage != grfx::MEMORY_USAGE_GPU_ONLY)) {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_STAGING;
+        }
+        else {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_OTHER;
+        }
+    }
+
+    mCurrentState = mCreateInfo.initialState;
+
     return ppx::SUCCESS;
 }
 
@@ -0,0 +1,247 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_buffer_arena.h"
+#include "ppx/grfx/grfx_device.h"
+
+namespace ppx {
+namespace grfx {
+
+// -------------------------------------------------------------------------------------------------
+// BufferRange
+// -------------------------------------------------------------------------------------------------
+Result BufferRange::CopyFromSource(uint64_t dataSize, const void* pData) const
+{
+    if (IsNull(pMappedAddress)) {
+        PPX_ASSERT_MSG(false, "buffer range is not host visible");
+        return ppx::ERROR_FAILED;
+    }
+    if (dataSize > size) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+    std::memcpy(pMappedAddress, pData, static_cast<size_t>(dataSize));
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+// BufferArena
+// -------------------------------------------------------------------------------------------------
+Result BufferArena::Create(const grfx::BufferArenaCreateInfo* pCreateInfo)
+{
+    grfx::BufferArenaCreateInfo createInfo = *pCreateInfo;
+
+    // Descriptor bound ranges need the constant buffer alignment
+    if (createInfo.usageFlags.bits.uniformBuffer || createInfo.usageFlags.bits.storageBuffer) {
+        createInfo.alignment = std::max<uint64_t>(createInfo.alignment, PPX_UNIFORM_BUFFER_ALIGNMENT);
+    }
+    if ((createInfo.alignment == 0) || ((createInfo.alignment & (createInfo.alignment - 1)) != 0)) {
+        PPX_ASSERT_MSG(false, "buffer arena alignment must be a power of two");
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+    if ((createInfo.blockSize == 0) || ((createInfo.blockSize % createInfo.alignment) != 0)) {
+        PPX_ASSERT_MSG(false, "buffer arena block size must be a multiple of the alignment");
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    Result ppxres = grfx::DeviceObject<grfx::BufferArenaCreateInfo>::Create(&createInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result BufferArena::CreateApiObjects(const grfx::BufferArenaCreateInfo* pCreateInfo)
+{
+    // First block up front so creation fails early if the memory isn't there
+    Result ppxres = AddBlock();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    return ppx::SUCCESS;
+}
+
+void BufferArena::DestroyApiObjects()
+{
+    for (Block& block : mBlocks) {
+        if (!block.buffer) {
+            continue;
+        }
+        if (!IsNull(block.pMappedAddress)) {
+            block.buffer->UnmapMemory();
+        }
+        GetDevice()->DestroyBuffer(block.buffer);
+    }
+    mBlocks.clear();
+    mCurrentBlock    = 0;
+    mAllocationCount = 0;
+}
+
+Result BufferArena::AddBlock()
+{
+    if ((mCreateInfo.maxBlockCount > 0) && (CountU32(mBlocks) >= mCreateInfo.maxBlockCount)) {
+        return ppx::ERROR_OUT_OF_MEMORY;
+    }
+
+    grfx::BufferCreateInfo createInfo = {};
+    createInfo.size                   = mCreateInfo.blockSize;
+    createInfo.usageFlags             = mCreateInfo.usageFlags;
+    createInfo.memoryUsage            = mCreateInfo.memoryUsage;
+    createInfo.initialState           = grfx::RESOURCE_STATE_GENERAL;
+    createInfo.ownership              = grfx::OWNERSHIP_RESTRICTED;
+    createInfo.memoryCategory         = mCreateInfo.memoryCategory;
+
+    Block  block  = {};
+    Result ppxres = GetDevice()->CreateBuffer(&createInfo, &block.buffer);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating buffer arena block");
+        return ppxres;
+    }
+
+    // Host visible blocks stay mapped
+    if (mCreateInfo.memoryUsage != grfx::MEMORY_USAGE_GPU_ONLY) {
+        void* pMappedAddress = nullptr;
+        ppxres               = block.buffer->MapMemory(0, &pMappedAddress);
+        if (Failed(ppxres)) {
+            GetDevice()->DestroyBuffer(block.buffer);
+            return ppxres;
+        }
+        block.pMappedAddress = static_cast<char*>(pMappedAddress);
+    }
+
+    if (mCreateInfo.strategy == grfx::BUFFER_ARENA_STRATEGY_TLSF) {
+        ppxres = TLSFAllocator::Create(mCreateInfo.blockSize, mCreateInfo.alignment, &block.tlsf);
+        if (Failed(ppxres)) {
+            if (!IsNull(block.pMappedAddress)) {
+                block.buffer->UnmapMemory();
+            }
+            GetDevice()->DestroyBuffer(block.buffer);
+            return ppxres;
+        }
+    }
+
+    mBlocks.push_back(std::move(block));
+
+    return ppx::SUCCESS;
+}
+
+Result BufferArena::AllocateFromBlock(uint32_t blockIndex, uint64_t size, grfx::BufferRange* pRange)
+{
+    Block&   block  = mBlocks[blockIndex];
+    uint64_t offset = 0;
+    uint32_t handle = UINT32_MAX;
+
+    if (mCreateInfo.strategy == grfx::BUFFER_ARENA_STRATEGY_LINEAR) {
+        if (block.linearOffset + size > mCreateInfo.blockSize) {
+            return ppx::ERROR_OUT_OF_MEMORY;
+        }
+        offset = block.linearOffset;
+        block.linearOffset += size;
+    }
+    else {
+        TLSFAllocator::Allocation allocation = {};
+        Result                    ppxres     = block.tlsf.Allocate(size, &allocation);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        offset = allocation.offset;
+        size   = allocation.size;
+        handle = allocation.handle;
+    }
+
+    pRange->pBuffer        = block.buffer;
+    pRange->offset         = offset;
+    pRange->size           = size;
+    pRange->pMappedAddress = IsNull(block.pMappedAddress) ? nullptr : (block.pMappedAddress + offset);
+    pRange->blockIndex     = blockIndex;
+    pRange->handle         = handle;
+
+    return ppx::SUCCESS;
+}
+
+Result BufferArena::Allocate(uint64_t size, grfx::BufferRange* pRange)
+{
+    PPX_ASSERT_NULL_ARG(pRange);
+    if (IsNull(pRange)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    size = RoundUp(std::max<uint64_t>(size, 1), mCreateInfo.alignment);
+    if (size > mCreateInfo.blockSize) {
+        return ppx::ERROR_OUT_OF_MEMORY;
+    }
+
+    // Linear arenas only move forward, TLSF arenas try every block in order
+    uint32_t firstBlock = (mCreateInfo.strategy == grfx::BUFFER_ARENA_STRATEGY_LINEAR) ? mCurrentBlock : 0;
+    for (uint32_t i = firstBlock; i < CountU32(mBlocks); ++i) {
+        if (!Failed(AllocateFromBlock(i, size, pRange))) {
+            mCurrentBlock = i;
+            mAllocationCount += 1;
+            return ppx::SUCCESS;
+        }
+    }
+
+    Result ppxres = AddBlock();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    const uint32_t blockIndex = CountU32(mBlocks) - 1;
+    ppxres                    = AllocateFromBlock(blockIndex, size, pRange);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    mCurrentBlock = blockIndex;
+    mAllocationCount += 1;
+
+    return ppx::SUCCESS;
+}
+
+void BufferArena::Free(const grfx::BufferRange& range)
+{
+    if (mCreateInfo.strategy != grfx::BUFFER_ARENA_STRATEGY_TLSF) {
+        PPX_ASSERT_MSG(false, "only TLSF buffer arenas can free individual ranges, use Reset()");
+        return;
+    }
+    if (range.blockIndex >= CountU32(mBlocks)) {
+        PPX_ASSERT_MSG(false, "buffer range does not belong to this arena");
+        return;
+    }
+    mBlocks[range.blockIndex].tlsf.Free(range.handle);
+    mAllocationCount -= 1;
+}
+
+void BufferArena::Reset()
+{
+    for (Block& block : mBlocks) {
+        block.linearOffset = 0;
+        if (mCreateInfo.strategy == grfx::BUFFER_ARENA_STRATEGY_TLSF) {
+            TLSFAllocator::Create(mCreateInfo.blockSize, mCreateInfo.alignment, &block.tlsf);
+        }
+    }
+    mCurrentBlock    = 0;
+    mAllocationCount = 0;
+}
+
+uint64_t BufferArena::GetUsedSize() const
+{
+    uint64_t used = 0;
+    for (const Block& block : mBlocks) {
+        used += (mCreateInfo.strategy == grfx::BUFFER_ARENA_STRATEGY_LINEAR) ? block.linearOffset : block.tlsf.GetUsedSize();
+    }
+    return used;
+}
+
+} // namespace grfx
+} // namespace ppx
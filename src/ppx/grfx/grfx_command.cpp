@@ -15,6 +15,7 @@
 #include "ppx/grfx/grfx_command.h"
 #include "ppx/grfx/grfx_buffer.h"
 #include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_device.h"
 #include "ppx/grfx/grfx_draw_pass.h"
 #include "ppx/grfx/grfx_fullscreen_quad.h"
 #include "ppx/grfx/grfx_image.h"
@@ -32,7 +33,7 @@ CommandType CommandPool::GetCommandType() const
 
 void CommandBuffer::BeginRenderPass(const grfx::RenderPassBeginInfo* pBeginInfo)
 {
-    if (!IsNull(mCurrentRenderPass)) {
+    if (!IsNull(mCurrentRenderPass) || mRenderingActive) {
         PPX_ASSERT_MSG(false, "cannot nest render passes");
     }
 
@@ -56,6 +57,34 @@ void CommandBuffer::EndRenderPass()
     mCurrentRenderPass = nullptr;
 }
 
+void CommandBuffer::BeginRendering(const grfx::RenderingInfo* pRenderingInfo)
+{
+    PPX_ASSERT_NULL_ARG(pRenderingInfo);
+
+    if (!IsNull(mCurrentRenderPass) || mRenderingActive) {
+        PPX_ASSERT_MSG(false, "cannot nest render passes");
+    }
+    if (pRenderingInfo->renderTargetCount > PPX_MAX_RENDER_TARGETS) {
+        PPX_ASSERT_MSG(false, "render target count exceeds PPX_MAX_RENDER_TARGETS");
+    }
+    for (uint32_t i = 0; i < pRenderingInfo->renderTargetCount; ++i) {
+        PPX_ASSERT_MSG(!IsNull(pRenderingInfo->pRenderTargetViews[i]), "render target view " << i << " is null");
+    }
+
+    BeginRenderingImpl(pRenderingInfo);
+    mRenderingActive = true;
+}
+
+void CommandBuffer::EndRendering()
+{
+    if (!mRenderingActive) {
+        PPX_ASSERT_MSG(false, "no rendering to end");
+    }
+
+    EndRenderingImpl();
+    mRenderingActive = false;
+}
+
 void CommandBuffer::BeginRenderPass(const grfx::RenderPass* pRenderPass)
 {
     PPX_ASSERT_NULL_ARG(pRenderPass);
@@ -90,6 +119,99 @@ void CommandBuffer::BeginRenderPass(
     BeginRenderPass(&beginInfo);
 }
 
+void CommandBuffer::ValidateTransition(const char* pResourceType, grfx::ResourceState trackedState, grfx::ResourceState beforeState, grfx::ResourceState afterState) const
+{
+    if (!GetDevice()->IsBarrierValidationEnabled()) {
+        return;
+    }
+
+    if (beforeState != trackedState) {
+        PPX_LOG_WARN(pResourceType << " transition from state " << beforeState << " but the tracked state is " << trackedState);
+    }
+    if (beforeState == afterState) {
+        PPX_LOG_WARN("redundant " << pResourceType << " transition to state " << afterState);
+    }
+}
+
+void CommandBuffer::TransitionImageLayout(
+    const grfx::Image*  pImage,
+    uint32_t            mipLevel,
+    uint32_t            mipLevelCount,
+    uint32_t            arrayLayer,
+    uint32_t            arrayLayerCount,
+    grfx::ResourceState beforeState,
+    grfx::ResourceState afterState,
+    const grfx::Queue*  pSrcQueue,
+    const grfx::Queue*  pDstQueue)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    bool allMipLevels   = (mipLevel == 0) && ((mipLevelCount == PPX_REMAINING_MIP_LEVELS) || (mipLevelCount == pImage->GetMipLevelCount()));
+    bool allArrayLayers = (arrayLayer == 0) && ((arrayLayerCount == PPX_REMAINING_ARRAY_LAYERS) || (arrayLayerCount == pImage->GetArrayLayerCount()));
+    bool wholeImage     = allMipLevels && allArrayLayers;
+
+    if (wholeImage && pImage->mCurrentStateKnown) {
+        ValidateTransition("image", pImage->mCurrentState, beforeState, afterState);
+    }
+
+    TransitionImageLayoutImpl(
+        pImage,
+        mipLevel,
+        mipLevelCount,
+        arrayLayer,
+        arrayLayerCount,
+        beforeState,
+        afterState,
+        pSrcQueue,
+        pDstQueue);
+
+    // A partial transition leaves subresources in different states
+    pImage->mCurrentState      = afterState;
+    pImage->mCurrentStateKnown = wholeImage;
+}
+
+void CommandBuffer::BufferResourceBarrier(
+    const grfx::Buffer* pBuffer,
+    grfx::ResourceState beforeState,
+    grfx::ResourceState afterState,
+    const grfx::Queue*  pSrcQueue,
+    const grfx::Queue*  pDstQueue)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    ValidateTransition("buffer", pBuffer->mCurrentState, beforeState, afterState);
+
+    BufferResourceBarrierImpl(
+        pBuffer,
+        beforeState,
+        afterState,
+        pSrcQueue,
+        pDstQueue);
+
+    pBuffer->mCurrentState = afterState;
+}
+
+void CommandBuffer::TransitionImage(const grfx::Image* pImage, grfx::ResourceState afterState)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+    PPX_ASSERT_MSG(pImage->mCurrentStateKnown, "image state is unknown after a partial transition, use TransitionImageLayout");
+
+    if (pImage->mCurrentState == afterState) {
+        return;
+    }
+    TransitionImageLayout(pImage, PPX_ALL_SUBRESOURCES, pImage->mCurrentState, afterState);
+}
+
+void CommandBuffer::TransitionBuffer(const grfx::Buffer* pBuffer, grfx::ResourceState afterState)
+{
+    PPX_ASSERT_NULL_ARG(pBuffer);
+
+    if (pBuffer->mCurrentState == afterState) {
+        return;
+    }
+    BufferResourceBarrier(pBuffer, pBuffer->mCurrentState, afterState);
+}
+
 void CommandBuffer::TransitionImageLayout(
     grfx::RenderPass*   pRenderPass,
     grfx::ResourceState renderTargetBeforeState,
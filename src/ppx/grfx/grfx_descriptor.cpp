@@ -135,6 +135,14 @@ Result DescriptorSetLayout::Create(const grfx::DescriptorSetLayoutCreateInfo* pC
         ranges.push_back(range);
     }
 
+    mDynamicOffsetCount = 0;
+    for (size_t i = 0; i < bindingCount; ++i) {
+        const grfx::DescriptorBinding& binding = pCreateInfo->bindings[i];
+        if ((binding.type == grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) || (binding.type == grfx::DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
+            mDynamicOffsetCount += binding.arrayCount;
+        }
+    }
+
     Result ppxres = grfx::DeviceObject<grfx::DescriptorSetLayoutCreateInfo>::Create(pCreateInfo);
     if (Failed(ppxres)) {
         return ppxres;
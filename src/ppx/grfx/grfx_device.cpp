@@ -16,9 +16,41 @@
 #include "ppx/grfx/grfx_gpu.h"
 #include "ppx/grfx/grfx_instance.h"
 
+#include "xxhash.h"
+
 namespace ppx {
 namespace grfx {
 
+// -------------------------------------------------------------------------------------------------
+// MemoryStats
+// -------------------------------------------------------------------------------------------------
+float MemoryStats::GetFragmentation() const
+{
+    if (blockBytes == 0) {
+        return 0;
+    }
+    return static_cast<float>(static_cast<double>(blockBytes - allocationBytes) / static_cast<double>(blockBytes));
+}
+
+float MemoryStats::GetDeviceLocalUsageRatio() const
+{
+    uint64_t localUsage  = 0;
+    uint64_t localBudget = 0;
+    for (const grfx::MemoryHeapStats& heap : heaps) {
+        if (heap.deviceLocal) {
+            localUsage += heap.usage;
+            localBudget += heap.budget;
+        }
+    }
+    if (localBudget == 0) {
+        return 0;
+    }
+    return static_cast<float>(static_cast<double>(localUsage) / static_cast<double>(localBudget));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Device
+// -------------------------------------------------------------------------------------------------
 Result Device::Create(const grfx::DeviceCreateInfo* pCreateInfo)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo->pGpu);
@@ -26,20 +58,33 @@ Result Device::Create(const grfx::DeviceCreateInfo* pCreateInfo)
     if (Failed(ppxres)) {
         return ppxres;
     }
+    mBarrierValidationEnabled = GetInstance()->IsDebugEnabled();
     PPX_LOG_INFO("Created device: " << pCreateInfo->pGpu->GetDeviceName());
     return ppx::SUCCESS;
 }
 
 void Device::Destroy()
 {
+    // Finish pending pipeline compiles, they add to the pipeline containers
+    mPipelineCompileQueue.reset();
+
+    // Shared pipelines are destroyed with the other graphics pipelines
+    mSharedGraphicsPipelines.clear();
+    mSharedGraphicsPipelineKeys.clear();
+
     // Destroy queues first to clear any pending work
     DestroyAllObjects(mGraphicsQueues);
     DestroyAllObjects(mComputeQueues);
     DestroyAllObjects(mTransferQueues);
 
-    // Destroy helper objects first
+    // Destroy helper objects first, render graphs own draw passes and textures
+    DestroyAllObjects(mRenderGraphs);
+    DestroyAllObjects(mBufferArenas);
+    DestroyAllObjects(mMeshPools);
+    DestroyAllObjects(mOcclusionCullers);
     DestroyAllObjects(mDrawPasses);
     DestroyAllObjects(mFullscreenQuads);
+    DestroyAllObjects(mGpuProfilers);
     DestroyAllObjects(mTextDraws);
     DestroyAllObjects(mTextures);
     DestroyAllObjects(mTextureFonts);
@@ -165,6 +210,58 @@ void Device::DestroyAllObjects(std::vector<ObjPtr<ObjectT>>& container)
     container.clear();
 }
 
+template <typename ObjectT, typename CreateInfoT>
+Result Device::CreatePipelineObject(const CreateInfoT* pCreateInfo, std::vector<ObjPtr<ObjectT>>& container, ObjectT** ppObject)
+{
+    // Allocate object
+    ObjectT* pObject = nullptr;
+    Result   ppxres  = AllocateObject(&pObject);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    // Set parent
+    pObject->SetParent(this);
+    // Create internal objects, pipeline creation is thread safe in both APIs
+    ppxres = pObject->Create(pCreateInfo);
+    if (Failed(ppxres)) {
+        pObject->Destroy();
+        delete pObject;
+        pObject = nullptr;
+        return ppxres;
+    }
+    // Store
+    {
+        std::lock_guard<std::mutex> lock(mPipelineMutex);
+        container.push_back(ObjPtr<ObjectT>(pObject));
+    }
+    // Assign
+    *ppObject = pObject;
+    // Success
+    return ppx::SUCCESS;
+}
+
+ppx::TaskQueue* Device::GetPipelineCompileQueue()
+{
+    std::lock_guard<std::mutex> lock(mPipelineMutex);
+    if (!mPipelineCompileQueue) {
+        // Leave a thread for the application, which is usually recording or
+        // loading assets while pipelines compile
+        uint32_t threadCount  = std::max<uint32_t>(GetHardwareThreadCount(), 2) - 1;
+        mPipelineCompileQueue = std::make_unique<ppx::TaskQueue>(threadCount);
+    }
+    return mPipelineCompileQueue.get();
+}
+
+Result Device::AllocateObject(grfx::BufferArena** ppObject)
+{
+    grfx::BufferArena* pObject = new grfx::BufferArena();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::DrawPass** ppObject)
 {
     grfx::DrawPass* pObject = new grfx::DrawPass();
@@ -185,6 +282,16 @@ Result Device::AllocateObject(grfx::FullscreenQuad** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::GpuProfiler** ppObject)
+{
+    grfx::GpuProfiler* pObject = new grfx::GpuProfiler();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::Mesh** ppObject)
 {
     grfx::Mesh* pObject = new grfx::Mesh();
@@ -195,6 +302,36 @@ Result Device::AllocateObject(grfx::Mesh** ppObject)
     return ppx::SUCCESS;
 }
 
+Result Device::AllocateObject(grfx::MeshPool** ppObject)
+{
+    grfx::MeshPool* pObject = new grfx::MeshPool();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
+Result Device::AllocateObject(grfx::OcclusionCuller** ppObject)
+{
+    grfx::OcclusionCuller* pObject = new grfx::OcclusionCuller();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
+Result Device::AllocateObject(grfx::RenderGraph** ppObject)
+{
+    grfx::RenderGraph* pObject = new grfx::RenderGraph();
+    if (IsNull(pObject)) {
+        return ppx::ERROR_ALLOCATION_FAILED;
+    }
+    *ppObject = pObject;
+    return ppx::SUCCESS;
+}
+
 Result Device::AllocateObject(grfx::TextDraw** ppObject)
 {
     grfx::TextDraw* pObject = new grfx::TextDraw();
@@ -229,7 +366,12 @@ Result Device::CreateBuffer(const grfx::BufferCreateInfo* pCreateInfo, grfx::Buf
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppBuffer);
-    return CreateObject(pCreateInfo, mBuffers, ppBuffer);
+    Result ppxres = CreateObject(pCreateInfo, mBuffers, ppBuffer);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    CheckMemoryBudget();
+    return ppx::SUCCESS;
 }
 
 void Device::DestroyBuffer(const grfx::Buffer* pBuffer)
@@ -238,6 +380,19 @@ void Device::DestroyBuffer(const grfx::Buffer* pBuffer)
     DestroyObject(mBuffers, pBuffer);
 }
 
+Result Device::CreateBufferArena(const grfx::BufferArenaCreateInfo* pCreateInfo, grfx::BufferArena** ppBufferArena)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppBufferArena);
+    return CreateObject(pCreateInfo, mBufferArenas, ppBufferArena);
+}
+
+void Device::DestroyBufferArena(const grfx::BufferArena* pBufferArena)
+{
+    PPX_ASSERT_NULL_ARG(pBufferArena);
+    DestroyObject(mBufferArenas, pBufferArena);
+}
+
 Result Device::CreateCommandPool(const grfx::CommandPoolCreateInfo* pCreateInfo, grfx::CommandPool** ppCommandPool)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -255,15 +410,32 @@ Result Device::CreateComputePipeline(const grfx::ComputePipelineCreateInfo* pCre
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppComputePipeline);
-    return CreateObject(pCreateInfo, mComputePipelines, ppComputePipeline);
+    return CreatePipelineObject(pCreateInfo, mComputePipelines, ppComputePipeline);
 }
 
 void Device::DestroyComputePipeline(const grfx::ComputePipeline* pComputePipeline)
 {
     PPX_ASSERT_NULL_ARG(pComputePipeline);
+    std::lock_guard<std::mutex> lock(mPipelineMutex);
     DestroyObject(mComputePipelines, pComputePipeline);
 }
 
+std::future<grfx::ComputePipelinePtr> Device::CreateComputePipelineAsync(const grfx::ComputePipelineCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    // Copied, the caller's create info may be gone by the time the task runs
+    grfx::ComputePipelineCreateInfo createInfo = *pCreateInfo;
+    return GetPipelineCompileQueue()->Submit([this, createInfo]() {
+        grfx::ComputePipeline* pPipeline = nullptr;
+        Result                 ppxres    = CreatePipelineObject(&createInfo, mComputePipelines, &pPipeline);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("asynchronous compute pipeline creation failed: " << ToString(ppxres));
+        }
+        return grfx::ComputePipelinePtr(pPipeline);
+    });
+}
+
 Result Device::CreateDepthStencilView(const grfx::DepthStencilViewCreateInfo* pCreateInfo, grfx::DepthStencilView** ppDepthStencilView)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -369,7 +541,7 @@ Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo* pC
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppGraphicsPipeline);
-    return CreateObject(pCreateInfo, mGraphicsPipelines, ppGraphicsPipeline);
+    return CreatePipelineObject(pCreateInfo, mGraphicsPipelines, ppGraphicsPipeline);
 }
 
 Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline)
@@ -380,20 +552,159 @@ Result Device::CreateGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* p
     grfx::GraphicsPipelineCreateInfo createInfo = {};
     grfx::internal::FillOutGraphicsPipelineCreateInfo(pCreateInfo, &createInfo);
 
-    return CreateObject(&createInfo, mGraphicsPipelines, ppGraphicsPipeline);
+    return CreatePipelineObject(&createInfo, mGraphicsPipelines, ppGraphicsPipeline);
 }
 
 void Device::DestroyGraphicsPipeline(const grfx::GraphicsPipeline* pGraphicsPipeline)
 {
     PPX_ASSERT_NULL_ARG(pGraphicsPipeline);
+    std::lock_guard<std::mutex> lock(mPipelineMutex);
     DestroyObject(mGraphicsPipelines, pGraphicsPipeline);
 }
 
+std::future<grfx::GraphicsPipelinePtr> Device::CreateGraphicsPipelineAsync(const grfx::GraphicsPipelineCreateInfo* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    grfx::GraphicsPipelineCreateInfo createInfo = *pCreateInfo;
+    return GetPipelineCompileQueue()->Submit([this, createInfo]() {
+        grfx::GraphicsPipeline* pPipeline = nullptr;
+        Result                  ppxres    = CreatePipelineObject(&createInfo, mGraphicsPipelines, &pPipeline);
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("asynchronous graphics pipeline creation failed: " << ToString(ppxres));
+        }
+        return grfx::GraphicsPipelinePtr(pPipeline);
+    });
+}
+
+std::future<grfx::GraphicsPipelinePtr> Device::CreateGraphicsPipelineAsync(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+
+    grfx::GraphicsPipelineCreateInfo createInfo = {};
+    grfx::internal::FillOutGraphicsPipelineCreateInfo(pCreateInfo, &createInfo);
+
+    return CreateGraphicsPipelineAsync(&createInfo);
+}
+
+size_t Device::PipelineKeyHasher::operator()(const std::string& key) const
+{
+    return static_cast<size_t>(XXH64(key.data(), key.size(), 0));
+}
+
+Result Device::AcquireGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppGraphicsPipeline);
+
+    // Vulkan pipelines only need compatible set layouts, D3D12 pipeline
+    // states must be used with the root signature they were created with.
+    std::string key;
+    grfx::internal::GetGraphicsPipelineKey(*pCreateInfo, grfx::IsVk(GetApi()), &key);
+
+    std::lock_guard<std::mutex> lock(mSharedPipelineMutex);
+
+    auto it = mSharedGraphicsPipelines.find(key);
+    if (it != mSharedGraphicsPipelines.end()) {
+        it->second.refCount += 1;
+        mGraphicsPipelineCacheStats.hitCount += 1;
+        *ppGraphicsPipeline = it->second.pipeline;
+        return ppx::SUCCESS;
+    }
+
+    grfx::GraphicsPipeline* pPipeline = nullptr;
+    Result                  ppxres    = CreatePipelineObject(pCreateInfo, mGraphicsPipelines, &pPipeline);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    mSharedGraphicsPipelineKeys[pPipeline] = key;
+    mSharedGraphicsPipelines.emplace(std::move(key), SharedGraphicsPipeline{pPipeline, 1});
+    mGraphicsPipelineCacheStats.missCount += 1;
+
+    *ppGraphicsPipeline = pPipeline;
+    return ppx::SUCCESS;
+}
+
+Result Device::AcquireGraphicsPipeline(const grfx::GraphicsPipelineCreateInfo2* pCreateInfo, grfx::GraphicsPipeline** ppGraphicsPipeline)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppGraphicsPipeline);
+
+    grfx::GraphicsPipelineCreateInfo createInfo = {};
+    grfx::internal::FillOutGraphicsPipelineCreateInfo(pCreateInfo, &createInfo);
+
+    return AcquireGraphicsPipeline(&createInfo, ppGraphicsPipeline);
+}
+
+void Device::ReleaseGraphicsPipeline(const grfx::GraphicsPipeline* pGraphicsPipeline)
+{
+    PPX_ASSERT_NULL_ARG(pGraphicsPipeline);
+
+    std::lock_guard<std::mutex> lock(mSharedPipelineMutex);
+
+    auto keyIt = mSharedGraphicsPipelineKeys.find(pGraphicsPipeline);
+    if (keyIt == mSharedGraphicsPipelineKeys.end()) {
+        PPX_ASSERT_MSG(false, "graphics pipeline was not acquired with AcquireGraphicsPipeline");
+        return;
+    }
+
+    auto it = mSharedGraphicsPipelines.find(keyIt->second);
+    PPX_ASSERT_MSG(it != mSharedGraphicsPipelines.end(), "shared graphics pipeline has no entry");
+    it->second.refCount -= 1;
+    if (it->second.refCount > 0) {
+        return;
+    }
+
+    mSharedGraphicsPipelines.erase(it);
+    mSharedGraphicsPipelineKeys.erase(keyIt);
+    DestroyGraphicsPipeline(pGraphicsPipeline);
+}
+
+grfx::GraphicsPipelineCacheStats Device::GetGraphicsPipelineCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(mSharedPipelineMutex);
+
+    grfx::GraphicsPipelineCacheStats stats = mGraphicsPipelineCacheStats;
+    stats.pipelineCount                    = static_cast<uint32_t>(mSharedGraphicsPipelines.size());
+    return stats;
+}
+
+void Device::WaitForPipelineCompiles()
+{
+    ppx::TaskQueue* pQueue = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mPipelineMutex);
+        pQueue = mPipelineCompileQueue.get();
+    }
+    if (!IsNull(pQueue)) {
+        pQueue->WaitIdle();
+    }
+}
+
+Result Device::CreateGpuProfiler(const grfx::GpuProfilerCreateInfo* pCreateInfo, grfx::GpuProfiler** ppGpuProfiler)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppGpuProfiler);
+    return CreateObject(pCreateInfo, mGpuProfilers, ppGpuProfiler);
+}
+
+void Device::DestroyGpuProfiler(const grfx::GpuProfiler* pGpuProfiler)
+{
+    PPX_ASSERT_NULL_ARG(pGpuProfiler);
+    DestroyObject(mGpuProfilers, pGpuProfiler);
+}
+
 Result Device::CreateImage(const grfx::ImageCreateInfo* pCreateInfo, grfx::Image** ppImage)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppImage);
-    return CreateObject(pCreateInfo, mImages, ppImage);
+    Result ppxres = CreateObject(pCreateInfo, mImages, ppImage);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    CheckMemoryBudget();
+    return ppx::SUCCESS;
 }
 
 void Device::DestroyImage(const grfx::Image* pImage)
@@ -415,6 +726,32 @@ void Device::DestroyMesh(const grfx::Mesh* pMesh)
     DestroyObject(mMeshes, pMesh);
 }
 
+Result Device::CreateMeshPool(const grfx::MeshPoolCreateInfo* pCreateInfo, grfx::MeshPool** ppMeshPool)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppMeshPool);
+    return CreateObject(pCreateInfo, mMeshPools, ppMeshPool);
+}
+
+void Device::DestroyMeshPool(const grfx::MeshPool* pMeshPool)
+{
+    PPX_ASSERT_NULL_ARG(pMeshPool);
+    DestroyObject(mMeshPools, pMeshPool);
+}
+
+Result Device::CreateOcclusionCuller(const grfx::OcclusionCullerCreateInfo* pCreateInfo, grfx::OcclusionCuller** ppOcclusionCuller)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppOcclusionCuller);
+    return CreateObject(pCreateInfo, mOcclusionCullers, ppOcclusionCuller);
+}
+
+void Device::DestroyOcclusionCuller(const grfx::OcclusionCuller* pOcclusionCuller)
+{
+    PPX_ASSERT_NULL_ARG(pOcclusionCuller);
+    DestroyObject(mOcclusionCullers, pOcclusionCuller);
+}
+
 Result Device::CreatePipelineInterface(const grfx::PipelineInterfaceCreateInfo* pCreateInfo, grfx::PipelineInterface** ppPipelineInterface)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -441,6 +778,19 @@ void Device::DestroyQuery(const grfx::Query* pQuery)
     DestroyObject(mQuerys, pQuery);
 }
 
+Result Device::CreateRenderGraph(const grfx::RenderGraphCreateInfo* pCreateInfo, grfx::RenderGraph** ppRenderGraph)
+{
+    PPX_ASSERT_NULL_ARG(pCreateInfo);
+    PPX_ASSERT_NULL_ARG(ppRenderGraph);
+    return CreateObject(pCreateInfo, mRenderGraphs, ppRenderGraph);
+}
+
+void Device::DestroyRenderGraph(const grfx::RenderGraph* pRenderGraph)
+{
+    PPX_ASSERT_NULL_ARG(pRenderGraph);
+    DestroyObject(mRenderGraphs, pRenderGraph);
+}
+
 Result Device::CreateRenderPass(const grfx::RenderPassCreateInfo* pCreateInfo, grfx::RenderPass** ppRenderPass)
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
@@ -520,6 +870,10 @@ Result Device::CreateSemaphore(const grfx::SemaphoreCreateInfo* pCreateInfo, grf
 {
     PPX_ASSERT_NULL_ARG(pCreateInfo);
     PPX_ASSERT_NULL_ARG(ppSemaphore);
+    if ((pCreateInfo->semaphoreType == grfx::SEMAPHORE_TYPE_TIMELINE) && !TimelineSemaphoreSupported()) {
+        PPX_ASSERT_MSG(false, "timeline semaphores are not supported by this device");
+        return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+    }
     return CreateObject(pCreateInfo, mSemaphores, ppSemaphore);
 }
 
@@ -785,5 +1139,66 @@ grfx::QueuePtr Device::GetAnyAvailableQueue() const
     return queue;
 }
 
+Result Device::GetMemoryStats(grfx::MemoryStats* pStats, bool detailed) const
+{
+    PPX_ASSERT_NULL_ARG(pStats);
+    if (IsNull(pStats)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    *pStats       = {};
+    Result ppxres = QueryMemoryStats(detailed, pStats);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    for (const grfx::MemoryHeapStats& heap : pStats->heaps) {
+        pStats->usage += heap.usage;
+        pStats->budget += heap.budget;
+        pStats->blockBytes += heap.blockBytes;
+        pStats->allocationBytes += heap.allocationBytes;
+        pStats->blockCount += heap.blockCount;
+        pStats->allocationCount += heap.allocationCount;
+    }
+
+    // Category totals walk every buffer and image
+    if (detailed) {
+        for (const grfx::BufferPtr& buffer : mBuffers) {
+            pStats->categoryBytes[buffer->GetMemoryCategory()] += buffer->GetMemorySize();
+        }
+        for (const grfx::ImagePtr& image : mImages) {
+            pStats->categoryBytes[image->GetMemoryCategory()] += image->GetMemorySize();
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void Device::SetMemoryBudgetCallback(float usageThreshold, grfx::MemoryBudgetCallback callback)
+{
+    mMemoryBudgetThreshold = usageThreshold;
+    mMemoryBudgetCallback  = callback;
+}
+
+bool Device::CheckMemoryBudget()
+{
+    // Resources created by the callback itself don't check again
+    if (!mMemoryBudgetCallback || mInMemoryBudgetCallback) {
+        return false;
+    }
+
+    grfx::MemoryStats stats  = {};
+    Result            ppxres = GetMemoryStats(&stats, false);
+    if (Failed(ppxres) || (stats.GetDeviceLocalUsageRatio() <= mMemoryBudgetThreshold)) {
+        return false;
+    }
+
+    mInMemoryBudgetCallback = true;
+    mMemoryBudgetCallback(this, stats);
+    mInMemoryBudgetCallback = false;
+
+    return true;
+}
+
 } // namespace grfx
 } // namespace ppx
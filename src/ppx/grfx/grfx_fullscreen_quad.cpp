@@ -57,7 +57,7 @@ Result FullscreenQuad::CreateApiObjects(const grfx::FullscreenQuadCreateInfo* pC
             createInfo.outputState.renderTargetFormats[i] = pCreateInfo->renderTargetFormats[i];
         }
 
-        ppxres = GetDevice()->CreateGraphicsPipeline(&createInfo, &mPipeline);
+        ppxres = GetDevice()->AcquireGraphicsPipeline(&createInfo, &mPipeline);
         if (Failed(ppxres)) {
             PPX_ASSERT_MSG(false, "failed creating graphics pipeline");
             return ppxres;
@@ -70,7 +70,7 @@ Result FullscreenQuad::CreateApiObjects(const grfx::FullscreenQuadCreateInfo* pC
 void FullscreenQuad::DestroyApiObjects()
 {
     if (mPipeline) {
-        GetDevice()->DestroyGraphicsPipeline(mPipeline);
+        GetDevice()->ReleaseGraphicsPipeline(mPipeline);
         mPipeline.Reset();
     }
 
@@ -0,0 +1,263 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_gpu_profiler.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_queue.h"
+
+#include <algorithm>
+
+namespace ppx {
+namespace grfx {
+
+namespace internal {
+
+void ResolveGpuProfilerFrame(
+    const std::vector<grfx::internal::GpuProfilerScopeRecord>& records,
+    const uint64_t*                                            pTimestamps,
+    const grfx::PipelineStatistics*                            pPipelineStatistics,
+    uint64_t                                                   timestampFrequency,
+    grfx::GpuProfilerFrame*                                    pFrame)
+{
+    const double ticksToMs = (timestampFrequency > 0) ? (1000.0 / static_cast<double>(timestampFrequency)) : 0;
+
+    pFrame->gpuTimeMs = 0;
+    pFrame->scopes.resize(records.size());
+
+    uint64_t frameStart = UINT64_MAX;
+    uint64_t frameEnd   = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const grfx::internal::GpuProfilerScopeRecord& record = records[i];
+        const uint64_t                                start  = pTimestamps[2 * i];
+        const uint64_t                                end    = pTimestamps[2 * i + 1];
+
+        // Times are clamped in case the timestamp counter wrapped
+        grfx::GpuProfilerScope& scope = pFrame->scopes[i];
+        scope.name                    = record.name;
+        scope.depth                   = record.depth;
+        scope.parentIndex             = record.parentIndex;
+        scope.gpuTimeMs               = (end > start) ? (static_cast<double>(end - start) * ticksToMs) : 0;
+        scope.hasPipelineStatistics   = !IsNull(pPipelineStatistics) && (record.pipelineStatsIndex != UINT32_MAX);
+        scope.pipelineStatistics      = scope.hasPipelineStatistics ? pPipelineStatistics[record.pipelineStatsIndex] : grfx::PipelineStatistics{};
+
+        if (record.depth == 0) {
+            frameStart = std::min(frameStart, start);
+            frameEnd   = std::max(frameEnd, end);
+        }
+    }
+
+    if (frameEnd > frameStart) {
+        pFrame->gpuTimeMs = static_cast<double>(frameEnd - frameStart) * ticksToMs;
+    }
+}
+
+} // namespace internal
+
+Result GpuProfiler::CreateApiObjects(const grfx::GpuProfilerCreateInfo* pCreateInfo)
+{
+    if (IsNull(pCreateInfo->pQueue)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((pCreateInfo->frameCount == 0) || (pCreateInfo->maxScopeCount == 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    Result ppxres = pCreateInfo->pQueue->GetTimestampFrequency(&mTimestampFrequency);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed getting timestamp frequency");
+        return ppxres;
+    }
+
+    const bool enablePipelineStatistics = pCreateInfo->enablePipelineStatistics && GetDevice()->PipelineStatsAvailable();
+
+    mFrames.resize(pCreateInfo->frameCount);
+    for (Frame& frame : mFrames) {
+        // Start and end timestamps of each scope
+        grfx::QueryCreateInfo createInfo = {};
+        createInfo.type                  = grfx::QUERY_TYPE_TIMESTAMP;
+        createInfo.count                 = 2 * pCreateInfo->maxScopeCount;
+
+        ppxres = GetDevice()->CreateQuery(&createInfo, &frame.timestampQuery);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating GPU profiler timestamp query");
+            return ppxres;
+        }
+
+        if (enablePipelineStatistics) {
+            createInfo.type  = grfx::QUERY_TYPE_PIPELINE_STATISTICS;
+            createInfo.count = pCreateInfo->maxScopeCount;
+
+            ppxres = GetDevice()->CreateQuery(&createInfo, &frame.pipelineStatsQuery);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "failed creating GPU profiler pipeline statistics query");
+                return ppxres;
+            }
+        }
+
+        frame.records.reserve(pCreateInfo->maxScopeCount);
+    }
+
+    mScopeStack.reserve(pCreateInfo->maxScopeCount);
+    mTimestamps.resize(2 * pCreateInfo->maxScopeCount);
+    if (enablePipelineStatistics) {
+        mPipelineStatistics.resize(pCreateInfo->maxScopeCount);
+    }
+
+    return ppx::SUCCESS;
+}
+
+void GpuProfiler::DestroyApiObjects()
+{
+    for (Frame& frame : mFrames) {
+        if (frame.pipelineStatsQuery) {
+            GetDevice()->DestroyQuery(frame.pipelineStatsQuery);
+            frame.pipelineStatsQuery.Reset();
+        }
+
+        if (frame.timestampQuery) {
+            GetDevice()->DestroyQuery(frame.timestampQuery);
+            frame.timestampQuery.Reset();
+        }
+    }
+    mFrames.clear();
+}
+
+void GpuProfiler::BeginFrame()
+{
+    PPX_ASSERT_MSG(mScopeStack.empty(), "GPU profiler frame ended with scopes still pushed");
+    mScopeStack.clear();
+    mPipelineStatsScope = UINT32_MAX;
+
+    mFrameIndex  = static_cast<uint32_t>(mFrameNumber % CountU32(mFrames));
+    Frame& frame = mFrames[mFrameIndex];
+
+    // The pool was last used frameCount frames ago
+    ReadFrame(mFrameIndex);
+
+    frame.timestampQuery->Reset(0, frame.timestampQuery->GetCount());
+    if (frame.pipelineStatsQuery) {
+        frame.pipelineStatsQuery->Reset(0, frame.pipelineStatsQuery->GetCount());
+    }
+    frame.records.clear();
+    frame.pipelineStatsCount = 0;
+    frame.frameNumber        = mFrameNumber;
+    frame.resolved           = false;
+
+    mFrameNumber = mFrameNumber + 1;
+}
+
+void GpuProfiler::PushScope(grfx::CommandBuffer* pCommandBuffer, const std::string& name)
+{
+    PPX_ASSERT_MSG(mFrameNumber > 0, "GpuProfiler::BeginFrame() must be called before pushing scopes");
+    Frame& frame = mFrames[mFrameIndex];
+
+    const uint32_t scopeIndex = CountU32(frame.records);
+    if (scopeIndex >= mCreateInfo.maxScopeCount) {
+        // Keep pushes and pops balanced
+        mScopeStack.push_back(UINT32_MAX);
+        mDroppedScopeCount = mDroppedScopeCount + 1;
+        return;
+    }
+
+    grfx::internal::GpuProfilerScopeRecord record = {};
+    record.name                                   = name;
+    record.depth                                  = CountU32(mScopeStack);
+    record.parentIndex                            = mScopeStack.empty() ? -1 : static_cast<int32_t>(mScopeStack.back());
+
+    pCommandBuffer->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_TOP_OF_PIPE_BIT, 2 * scopeIndex);
+
+    if (frame.pipelineStatsQuery && (mPipelineStatsScope == UINT32_MAX)) {
+        // Statistics queries are numbered separately so the ones resolved
+        // by EndFrame() have all been written.
+        record.pipelineStatsIndex = frame.pipelineStatsCount;
+        frame.pipelineStatsCount  = frame.pipelineStatsCount + 1;
+        mPipelineStatsScope       = scopeIndex;
+
+        pCommandBuffer->BeginQuery(frame.pipelineStatsQuery, record.pipelineStatsIndex);
+    }
+
+    frame.records.push_back(record);
+    mScopeStack.push_back(scopeIndex);
+}
+
+void GpuProfiler::PopScope(grfx::CommandBuffer* pCommandBuffer)
+{
+    PPX_ASSERT_MSG(!mScopeStack.empty(), "GpuProfiler::PopScope() called without a matching PushScope()");
+    Frame& frame = mFrames[mFrameIndex];
+
+    const uint32_t scopeIndex = mScopeStack.back();
+    mScopeStack.pop_back();
+    if (scopeIndex == UINT32_MAX) {
+        return;
+    }
+
+    if (mPipelineStatsScope == scopeIndex) {
+        pCommandBuffer->EndQuery(frame.pipelineStatsQuery, frame.records[scopeIndex].pipelineStatsIndex);
+        mPipelineStatsScope = UINT32_MAX;
+    }
+
+    pCommandBuffer->WriteTimestamp(frame.timestampQuery, grfx::PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 2 * scopeIndex + 1);
+}
+
+void GpuProfiler::EndFrame(grfx::CommandBuffer* pCommandBuffer)
+{
+    PPX_ASSERT_MSG(mScopeStack.empty(), "GpuProfiler::EndFrame() called with scopes still pushed");
+    Frame& frame = mFrames[mFrameIndex];
+
+    // Resolves copy to the start of the readback buffer, so always
+    // resolve from the first query.
+    const uint32_t scopeCount = CountU32(frame.records);
+    if (scopeCount > 0) {
+        pCommandBuffer->ResolveQueryData(frame.timestampQuery, 0, 2 * scopeCount);
+    }
+    if (frame.pipelineStatsCount > 0) {
+        pCommandBuffer->ResolveQueryData(frame.pipelineStatsQuery, 0, frame.pipelineStatsCount);
+    }
+    frame.resolved = true;
+}
+
+void GpuProfiler::ReadFrame(uint32_t frameIndex)
+{
+    const Frame& frame = mFrames[frameIndex];
+    if (!frame.resolved || frame.records.empty()) {
+        return;
+    }
+
+    const uint32_t scopeCount = CountU32(frame.records);
+    Result         ppxres     = frame.timestampQuery->GetData(mTimestamps.data(), 2 * scopeCount * sizeof(uint64_t));
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("failed reading GPU profiler timestamps: " << ToString(ppxres));
+        return;
+    }
+
+    if (frame.pipelineStatsCount > 0) {
+        ppxres = frame.pipelineStatsQuery->GetData(mPipelineStatistics.data(), frame.pipelineStatsCount * sizeof(grfx::PipelineStatistics));
+        if (Failed(ppxres)) {
+            PPX_LOG_ERROR("failed reading GPU profiler pipeline statistics: " << ToString(ppxres));
+            return;
+        }
+    }
+
+    mLastFrame.frameNumber = frame.frameNumber;
+    grfx::internal::ResolveGpuProfilerFrame(
+        frame.records,
+        mTimestamps.data(),
+        (frame.pipelineStatsCount > 0) ? mPipelineStatistics.data() : nullptr,
+        mTimestampFrequency,
+        &mLastFrame);
+}
+
+} // namespace grfx
+} // namespace ppx
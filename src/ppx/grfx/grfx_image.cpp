@@ -103,6 +103,21 @@ Result Image::Create(const grfx::ImageCreateInfo* pCreateInfo)
         return ppxres;
     }
 
+    if (mCreateInfo.memoryCategory == grfx::MEMORY_CATEGORY_UNDEFINED) {
+        if (mCreateInfo.usageFlags.bits.colorAttachment || mCreateInfo.usageFlags.bits.depthStencilAttachment) {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_RENDER_TARGET;
+        }
+        else if (mCreateInfo.usageFlags.bits.sampled) {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_TEXTURE;
+        }
+        else {
+            mCreateInfo.memoryCategory = grfx::MEMORY_CATEGORY_OTHER;
+        }
+    }
+
+    mCurrentState      = mCreateInfo.initialState;
+    mCurrentStateKnown = true;
+
     return ppx::SUCCESS;
 }
 
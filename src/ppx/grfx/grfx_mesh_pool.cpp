@@ -0,0 +1,560 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_mesh_pool.h"
+#include "ppx/grfx/grfx_device.h"
+#include "ppx/grfx/grfx_queue.h"
+#include "ppx/grfx/grfx_scope.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace ppx {
+namespace grfx {
+
+// Records commands with recordFn, submits them to pQueue and waits for them
+static Result SubmitAndWait(grfx::Queue* pQueue, const std::function<void(grfx::CommandBuffer*)>& recordFn)
+{
+    grfx::ScopeDestroyer SCOPED_DESTROYER(pQueue->GetDevice());
+
+    grfx::CommandBufferPtr cmd;
+    Result                 ppxres = pQueue->CreateCommandBuffer(&cmd, 0, 0);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    SCOPED_DESTROYER.AddObject(pQueue, cmd);
+
+    ppxres = cmd->Begin();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    recordFn(cmd);
+    ppxres = cmd->End();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::SubmitInfo submit;
+    submit.commandBufferCount = 1;
+    submit.ppCommandBuffers   = &cmd;
+
+    ppxres = pQueue->Submit(&submit);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return pQueue->WaitIdle();
+}
+
+// -------------------------------------------------------------------------------------------------
+// MeshPoolCreateInfo
+// -------------------------------------------------------------------------------------------------
+MeshPoolCreateInfo::MeshPoolCreateInfo(const ppx::Geometry& geometry, uint32_t maxVertexCount, uint32_t maxIndexCount)
+{
+    grfx::MeshCreateInfo meshCreateInfo = grfx::MeshCreateInfo(geometry);
+
+    this->indexType         = (geometry.GetIndexType() != grfx::INDEX_TYPE_UNDEFINED) ? geometry.GetIndexType() : grfx::INDEX_TYPE_UINT32;
+    this->maxIndexCount     = maxIndexCount;
+    this->maxVertexCount    = maxVertexCount;
+    this->vertexBufferCount = meshCreateInfo.vertexBufferCount;
+    std::memcpy(&this->vertexBuffers, &meshCreateInfo.vertexBuffers, PPX_MAX_VERTEX_BINDINGS * sizeof(grfx::MeshVertexBufferDescription));
+}
+
+// -------------------------------------------------------------------------------------------------
+// MeshPool
+// -------------------------------------------------------------------------------------------------
+Result MeshPool::CreateApiObjects(const grfx::MeshPoolCreateInfo* pCreateInfo)
+{
+    if ((pCreateInfo->maxVertexCount == 0) || (pCreateInfo->vertexBufferCount == 0) || (pCreateInfo->vertexBufferCount > PPX_MAX_VERTEX_BINDINGS)) {
+        return Result::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION;
+    }
+    if ((pCreateInfo->maxIndexCount > 0) && (pCreateInfo->indexType != grfx::INDEX_TYPE_UINT16) && (pCreateInfo->indexType != grfx::INDEX_TYPE_UINT32)) {
+        return Result::ERROR_GRFX_INVALID_INDEX_TYPE;
+    }
+
+    // Calculate vertex strides (if needed) and attribute offsets
+    mVertexBufferDescriptions.assign(pCreateInfo->vertexBuffers, pCreateInfo->vertexBuffers + pCreateInfo->vertexBufferCount);
+    for (auto& vertexBufferDesc : mVertexBufferDescriptions) {
+        if (vertexBufferDesc.attributeCount == 0) {
+            return Result::ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_COUNT;
+        }
+
+        bool calculateVertexStride = (vertexBufferDesc.stride == 0);
+        for (uint32_t attrIdx = 0; attrIdx < vertexBufferDesc.attributeCount; ++attrIdx) {
+            auto& attr = vertexBufferDesc.attributes[attrIdx];
+            if (attr.format == grfx::FORMAT_UNDEFINED) {
+                return Result::ERROR_GRFX_VERTEX_ATTRIBUTE_FORMAT_UNDEFINED;
+            }
+
+            auto* pFormatDesc = grfx::GetFormatDescription(attr.format);
+            if ((pFormatDesc->bytesPerTexel == 0) || ((attr.stride != 0) && (attr.stride < pFormatDesc->bytesPerTexel))) {
+                return Result::ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_STRIDE;
+            }
+            if (attr.stride == 0) {
+                attr.stride = pFormatDesc->bytesPerTexel;
+            }
+
+            attr.offset = vertexBufferDesc.stride;
+            if (calculateVertexStride) {
+                vertexBufferDesc.stride += attr.stride;
+            }
+        }
+    }
+
+    Result ppxres = grfx::MeshPoolAllocator::Create(pCreateInfo->maxVertexCount, pCreateInfo->maxIndexCount, &mAllocator);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    ppxres = CreateBuffers(mIndexBuffer, mVertexBuffers);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Derived vertex bindings, same layout as grfx::Mesh
+    uint32_t location = 0;
+    for (uint32_t bufferIndex = 0; bufferIndex < GetVertexBufferCount(); ++bufferIndex) {
+        const grfx::MeshVertexBufferDescription& bufferDesc = mVertexBufferDescriptions[bufferIndex];
+
+        grfx::VertexBinding binding = grfx::VertexBinding(bufferIndex, bufferDesc.vertexInputRate);
+        binding.SetBinding(bufferIndex);
+
+        for (uint32_t attrIdx = 0; attrIdx < bufferDesc.attributeCount; ++attrIdx) {
+            const grfx::MeshVertexAttribute& srcAttr = bufferDesc.attributes[attrIdx];
+
+            std::string semanticName = PPX_SEMANTIC_NAME_CUSTOM;
+            // clang-format off
+            switch (srcAttr.vertexSemantic) {
+                default: break;
+                case grfx::VERTEX_SEMANTIC_POSITION  : semanticName = PPX_SEMANTIC_NAME_POSITION;  break;
+                case grfx::VERTEX_SEMANTIC_NORMAL    : semanticName = PPX_SEMANTIC_NAME_NORMAL;    break;
+                case grfx::VERTEX_SEMANTIC_COLOR     : semanticName = PPX_SEMANTIC_NAME_COLOR;     break;
+                case grfx::VERTEX_SEMANTIC_TEXCOORD  : semanticName = PPX_SEMANTIC_NAME_TEXCOORD;  break;
+                case grfx::VERTEX_SEMANTIC_TANGENT   : semanticName = PPX_SEMANTIC_NAME_TANGENT;   break;
+                case grfx::VERTEX_SEMANTIC_BITANGENT : semanticName = PPX_SEMANTIC_NAME_BITANGENT; break;
+            }
+            // clang-format on
+
+            grfx::VertexAttribute attr = {};
+            attr.semanticName          = semanticName;
+            attr.location              = location;
+            attr.format                = srcAttr.format;
+            attr.binding               = bufferIndex;
+            attr.offset                = srcAttr.offset;
+            attr.inputRate             = bufferDesc.vertexInputRate;
+            attr.semantic              = srcAttr.vertexSemantic;
+
+            binding.AppendAttribute(attr);
+
+            ++location;
+        }
+
+        binding.SetStride(bufferDesc.stride);
+
+        mDerivedVertexBindings.push_back(binding);
+    }
+
+    return ppx::SUCCESS;
+}
+
+void MeshPool::DestroyApiObjects()
+{
+    DestroyBuffers(mIndexBuffer, mVertexBuffers);
+    mVertexBufferDescriptions.clear();
+    mDerivedVertexBindings.clear();
+    mAllocator = grfx::MeshPoolAllocator();
+}
+
+Result MeshPool::CreateBuffers(grfx::BufferPtr& indexBuffer, std::vector<grfx::BufferPtr>& vertexBuffers)
+{
+    // BufferToBufferCopyInfo only has 32-bit destination offsets
+    const uint64_t maxBufferSize = static_cast<uint64_t>(UINT32_MAX) + 1;
+
+    if (mCreateInfo.maxIndexCount > 0) {
+        grfx::BufferCreateInfo createInfo      = {};
+        createInfo.size                        = static_cast<uint64_t>(mCreateInfo.maxIndexCount) * grfx::IndexTypeSize(mCreateInfo.indexType);
+        createInfo.usageFlags.bits.indexBuffer = true;
+        createInfo.usageFlags.bits.transferSrc = true;
+        createInfo.usageFlags.bits.transferDst = true;
+        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                = grfx::RESOURCE_STATE_INDEX_BUFFER;
+        createInfo.ownership                   = grfx::OWNERSHIP_RESTRICTED;
+
+        if (createInfo.size > maxBufferSize) {
+            return ppx::ERROR_LIMIT_EXCEEDED;
+        }
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &indexBuffer);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "create mesh pool index buffer failed");
+            return ppxres;
+        }
+    }
+
+    vertexBuffers.resize(mVertexBufferDescriptions.size());
+    for (size_t i = 0; i < mVertexBufferDescriptions.size(); ++i) {
+        grfx::BufferCreateInfo createInfo       = {};
+        createInfo.size                         = static_cast<uint64_t>(mCreateInfo.maxVertexCount) * mVertexBufferDescriptions[i].stride;
+        createInfo.usageFlags.bits.vertexBuffer = true;
+        createInfo.usageFlags.bits.transferSrc  = true;
+        createInfo.usageFlags.bits.transferDst  = true;
+        createInfo.memoryUsage                  = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                 = grfx::RESOURCE_STATE_VERTEX_BUFFER;
+        createInfo.ownership                    = grfx::OWNERSHIP_RESTRICTED;
+
+        if (createInfo.size > maxBufferSize) {
+            DestroyBuffers(indexBuffer, vertexBuffers);
+            return ppx::ERROR_LIMIT_EXCEEDED;
+        }
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &vertexBuffers[i]);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "create mesh pool vertex buffer failed");
+            DestroyBuffers(indexBuffer, vertexBuffers);
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void MeshPool::DestroyBuffers(grfx::BufferPtr& indexBuffer, std::vector<grfx::BufferPtr>& vertexBuffers)
+{
+    if (indexBuffer) {
+        GetDevice()->DestroyBuffer(indexBuffer);
+        indexBuffer.Reset();
+    }
+    for (auto& buffer : vertexBuffers) {
+        if (buffer) {
+            GetDevice()->DestroyBuffer(buffer);
+        }
+    }
+    vertexBuffers.clear();
+}
+
+grfx::BufferPtr MeshPool::GetVertexBuffer(uint32_t index) const
+{
+    grfx::BufferPtr buffer;
+    if (index < CountU32(mVertexBuffers)) {
+        buffer = mVertexBuffers[index];
+    }
+    return buffer;
+}
+
+const grfx::MeshVertexBufferDescription* MeshPool::GetVertexBufferDescription(uint32_t index) const
+{
+    const grfx::MeshVertexBufferDescription* pDescription = nullptr;
+    if (index < CountU32(mVertexBufferDescriptions)) {
+        pDescription = &mVertexBufferDescriptions[index];
+    }
+    return pDescription;
+}
+
+Result MeshPool::CheckGeometry(const ppx::Geometry& geometry) const
+{
+    // The geometry must match the pool's streams
+    if (geometry.GetVertexBufferCount() != GetVertexBufferCount()) {
+        return Result::ERROR_GRFX_INVALID_GEOMETRY_CONFIGURATION;
+    }
+    for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+        if (geometry.GetVertexBuffer(i)->GetElementSize() != mVertexBufferDescriptions[i].stride) {
+            return Result::ERROR_GRFX_INVALID_VERTEX_ATTRIBUTE_STRIDE;
+        }
+    }
+    if (HasIndices(geometry) && (geometry.GetIndexType() != mCreateInfo.indexType)) {
+        return Result::ERROR_GRFX_INVALID_INDEX_TYPE;
+    }
+    return ppx::SUCCESS;
+}
+
+bool MeshPool::HasIndices(const ppx::Geometry& geometry)
+{
+    return (geometry.GetIndexType() != grfx::INDEX_TYPE_UNDEFINED) && (geometry.GetIndexCount() > 0);
+}
+
+Result MeshPool::AddMesh(grfx::Queue* pQueue, const ppx::Geometry& geometry, uint32_t* pHandle)
+{
+    const ppx::Geometry* pGeometry = &geometry;
+    return AddMeshes(pQueue, 1, &pGeometry, pHandle);
+}
+
+Result MeshPool::AddMeshes(grfx::Queue* pQueue, uint32_t geometryCount, const ppx::Geometry* const* ppGeometries, uint32_t* pHandles)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+    PPX_ASSERT_NULL_ARG(ppGeometries);
+    PPX_ASSERT_NULL_ARG(pHandles);
+
+    if (geometryCount == 0) {
+        return ppx::SUCCESS;
+    }
+
+    // Check the whole batch first so a bad geometry doesn't leave part of it
+    // in the pool
+    for (uint32_t geoIndex = 0; geoIndex < geometryCount; ++geoIndex) {
+        Result ppxres = CheckGeometry(*ppGeometries[geoIndex]);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    // Handles allocated so far, freed if the batch fails
+    std::vector<uint32_t> handles;
+
+    auto freeHandles = [&]() {
+        for (uint32_t handle : handles) {
+            mAllocator.Free(handle);
+        }
+    };
+
+    // One staging buffer for the whole batch, each mesh's streams followed
+    // by its indices
+    std::vector<std::vector<grfx::BufferToBufferCopyInfo>> vertexCopies(GetVertexBufferCount());
+    std::vector<grfx::BufferToBufferCopyInfo>              indexCopies;
+    uint64_t                                               stagingSize = 0;
+    for (uint32_t geoIndex = 0; geoIndex < geometryCount; ++geoIndex) {
+        const ppx::Geometry& geometry   = *ppGeometries[geoIndex];
+        const bool           hasIndices = HasIndices(geometry);
+
+        uint32_t handle = grfx::MeshPoolAllocator::kInvalidHandle;
+        Result   ppxres = mAllocator.Allocate(geometry.GetVertexCount(), hasIndices ? geometry.GetIndexCount() : 0, &handle);
+        if (Failed(ppxres)) {
+            freeHandles();
+            return ppxres;
+        }
+        handles.push_back(handle);
+        const grfx::MeshPoolRange& range = mAllocator.GetRange(handle);
+
+        for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+            grfx::BufferToBufferCopyInfo copyInfo = {};
+            copyInfo.size                         = geometry.GetVertexBuffer(i)->GetSize();
+            copyInfo.srcBuffer.offset             = stagingSize;
+            copyInfo.dstBuffer.offset             = range.vertexOffset * mVertexBufferDescriptions[i].stride;
+            vertexCopies[i].push_back(copyInfo);
+
+            stagingSize += copyInfo.size;
+        }
+        if (hasIndices) {
+            grfx::BufferToBufferCopyInfo copyInfo = {};
+            copyInfo.size                         = geometry.GetIndexBuffer()->GetSize();
+            copyInfo.srcBuffer.offset             = stagingSize;
+            copyInfo.dstBuffer.offset             = range.firstIndex * grfx::IndexTypeSize(mCreateInfo.indexType);
+            indexCopies.push_back(copyInfo);
+
+            stagingSize += copyInfo.size;
+        }
+    }
+
+    grfx::ScopeDestroyer SCOPED_DESTROYER(GetDevice());
+
+    grfx::BufferPtr stagingBuffer;
+    {
+        grfx::BufferCreateInfo createInfo      = {};
+        createInfo.size                        = stagingSize;
+        createInfo.usageFlags.bits.transferSrc = true;
+        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &stagingBuffer);
+        if (Failed(ppxres)) {
+            freeHandles();
+            return ppxres;
+        }
+        SCOPED_DESTROYER.AddObject(stagingBuffer);
+
+        void* pMappedMemory = nullptr;
+        ppxres              = stagingBuffer->MapMemory(0, &pMappedMemory);
+        if (Failed(ppxres)) {
+            freeHandles();
+            return ppxres;
+        }
+        // Same order as the offsets above
+        char* pMappedAddress = static_cast<char*>(pMappedMemory);
+        for (uint32_t geoIndex = 0; geoIndex < geometryCount; ++geoIndex) {
+            const ppx::Geometry& geometry = *ppGeometries[geoIndex];
+            for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+                const Geometry::Buffer* pGeoBuffer = geometry.GetVertexBuffer(i);
+                std::memcpy(pMappedAddress, pGeoBuffer->GetData(), pGeoBuffer->GetSize());
+                pMappedAddress += pGeoBuffer->GetSize();
+            }
+            if (HasIndices(geometry)) {
+                const Geometry::Buffer* pGeoBuffer = geometry.GetIndexBuffer();
+                std::memcpy(pMappedAddress, pGeoBuffer->GetData(), pGeoBuffer->GetSize());
+                pMappedAddress += pGeoBuffer->GetSize();
+            }
+        }
+        stagingBuffer->UnmapMemory();
+    }
+
+    // One barrier pair per buffer for the whole batch
+    Result ppxres = SubmitAndWait(pQueue, [&](grfx::CommandBuffer* pCmd) {
+        for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+            pCmd->BufferResourceBarrier(mVertexBuffers[i], grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
+            for (const grfx::BufferToBufferCopyInfo& copyInfo : vertexCopies[i]) {
+                if (copyInfo.size > 0) {
+                    pCmd->CopyBufferToBuffer(&copyInfo, stagingBuffer, mVertexBuffers[i]);
+                }
+            }
+            pCmd->BufferResourceBarrier(mVertexBuffers[i], grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_VERTEX_BUFFER);
+        }
+        if (!indexCopies.empty()) {
+            pCmd->BufferResourceBarrier(mIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
+            for (const grfx::BufferToBufferCopyInfo& copyInfo : indexCopies) {
+                pCmd->CopyBufferToBuffer(&copyInfo, stagingBuffer, mIndexBuffer);
+            }
+            pCmd->BufferResourceBarrier(mIndexBuffer, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_INDEX_BUFFER);
+        }
+    });
+    if (Failed(ppxres)) {
+        freeHandles();
+        return ppxres;
+    }
+
+    std::copy(handles.begin(), handles.end(), pHandles);
+
+    return ppx::SUCCESS;
+}
+
+Result MeshPool::RemoveMesh(uint32_t handle)
+{
+    if (!mAllocator.IsValid(handle)) {
+        PPX_ASSERT_MSG(false, "invalid mesh pool handle: " << handle);
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+    mAllocator.Free(handle);
+
+    return ppx::SUCCESS;
+}
+
+Result MeshPool::Defragment(grfx::Queue* pQueue)
+{
+    PPX_ASSERT_NULL_ARG(pQueue);
+
+    // The old buffers are destroyed below, so nothing submitted earlier can
+    // still be reading them
+    Result ppxres = GetDevice()->WaitIdle();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Keep the current layout in case the copy fails
+    const grfx::MeshPoolAllocator previousAllocator = mAllocator;
+
+    std::vector<grfx::MeshPoolCopy> vertexCopies;
+    std::vector<grfx::MeshPoolCopy> indexCopies;
+    mAllocator.Defragment(&vertexCopies, &indexCopies);
+
+    auto isInPlace = [](const grfx::MeshPoolCopy& copy) -> bool { return copy.srcOffset == copy.dstOffset; };
+    if (std::all_of(vertexCopies.begin(), vertexCopies.end(), isInPlace) && std::all_of(indexCopies.begin(), indexCopies.end(), isInPlace)) {
+        return ppx::SUCCESS;
+    }
+
+    // Copies within a buffer may overlap, so the meshes are packed into new
+    // buffers instead
+    grfx::BufferPtr              indexBuffer;
+    std::vector<grfx::BufferPtr> vertexBuffers;
+
+    ppxres = CreateBuffers(indexBuffer, vertexBuffers);
+    if (Failed(ppxres)) {
+        mAllocator = previousAllocator;
+        return ppxres;
+    }
+
+    ppxres = SubmitAndWait(pQueue, [&](grfx::CommandBuffer* pCmd) {
+        for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+            const uint32_t stride = mVertexBufferDescriptions[i].stride;
+
+            pCmd->BufferResourceBarrier(mVertexBuffers[i], grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_COPY_SRC);
+            pCmd->BufferResourceBarrier(vertexBuffers[i], grfx::RESOURCE_STATE_VERTEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
+            for (const grfx::MeshPoolCopy& copy : vertexCopies) {
+                grfx::BufferToBufferCopyInfo copyInfo = {};
+                copyInfo.size                         = static_cast<uint64_t>(copy.count) * stride;
+                copyInfo.srcBuffer.offset             = static_cast<uint64_t>(copy.srcOffset) * stride;
+                copyInfo.dstBuffer.offset             = copy.dstOffset * stride;
+                pCmd->CopyBufferToBuffer(&copyInfo, mVertexBuffers[i], vertexBuffers[i]);
+            }
+            pCmd->BufferResourceBarrier(vertexBuffers[i], grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_VERTEX_BUFFER);
+        }
+        if (!indexCopies.empty()) {
+            const uint32_t indexSize = grfx::IndexTypeSize(mCreateInfo.indexType);
+
+            pCmd->BufferResourceBarrier(mIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_COPY_SRC);
+            pCmd->BufferResourceBarrier(indexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_COPY_DST);
+            for (const grfx::MeshPoolCopy& copy : indexCopies) {
+                grfx::BufferToBufferCopyInfo copyInfo = {};
+                copyInfo.size                         = static_cast<uint64_t>(copy.count) * indexSize;
+                copyInfo.srcBuffer.offset             = static_cast<uint64_t>(copy.srcOffset) * indexSize;
+                copyInfo.dstBuffer.offset             = copy.dstOffset * indexSize;
+                pCmd->CopyBufferToBuffer(&copyInfo, mIndexBuffer, indexBuffer);
+            }
+            pCmd->BufferResourceBarrier(indexBuffer, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_INDEX_BUFFER);
+        }
+    });
+    if (Failed(ppxres)) {
+        DestroyBuffers(indexBuffer, vertexBuffers);
+        mAllocator = previousAllocator;
+        return ppxres;
+    }
+
+    DestroyBuffers(mIndexBuffer, mVertexBuffers);
+    mIndexBuffer   = indexBuffer;
+    mVertexBuffers = vertexBuffers;
+
+    return ppx::SUCCESS;
+}
+
+grfx::DrawIndexedIndirectCommand MeshPool::GetDrawIndexedIndirectCommand(uint32_t handle, uint32_t instanceCount, uint32_t firstInstance) const
+{
+    const grfx::MeshPoolRange& range = GetRange(handle);
+    PPX_ASSERT_MSG(range.indexCount > 0, "indirect draws need indexed meshes");
+
+    grfx::DrawIndexedIndirectCommand command = {};
+    command.indexCount                       = range.indexCount;
+    command.instanceCount                    = instanceCount;
+    command.firstIndex                       = range.firstIndex;
+    command.vertexOffset                     = static_cast<int32_t>(range.vertexOffset);
+    command.firstInstance                    = firstInstance;
+    return command;
+}
+
+void MeshPool::BindBuffers(grfx::CommandBuffer* pCommandBuffer) const
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+
+    if (mIndexBuffer) {
+        pCommandBuffer->BindIndexBuffer(mIndexBuffer, mCreateInfo.indexType);
+    }
+
+    std::vector<const grfx::Buffer*> buffers;
+    std::vector<uint32_t>            strides;
+    for (uint32_t i = 0; i < GetVertexBufferCount(); ++i) {
+        buffers.push_back(mVertexBuffers[i]);
+        strides.push_back(mVertexBufferDescriptions[i].stride);
+    }
+    pCommandBuffer->BindVertexBuffers(GetVertexBufferCount(), DataPtr(buffers), DataPtr(strides));
+}
+
+void MeshPool::Draw(grfx::CommandBuffer* pCommandBuffer, uint32_t handle, uint32_t instanceCount, uint32_t firstInstance) const
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+
+    const grfx::MeshPoolRange& range = GetRange(handle);
+    if (range.indexCount > 0) {
+        pCommandBuffer->DrawIndexed(range.indexCount, instanceCount, range.firstIndex, static_cast<int32_t>(range.vertexOffset), firstInstance);
+    }
+    else {
+        pCommandBuffer->Draw(range.vertexCount, instanceCount, range.vertexOffset, firstInstance);
+    }
+}
+
+} // namespace grfx
+} // namespace ppx
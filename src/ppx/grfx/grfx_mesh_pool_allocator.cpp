@@ -0,0 +1,224 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_mesh_pool_allocator.h"
+
+#include <algorithm>
+
+namespace ppx {
+namespace grfx {
+
+static float CalculateFragmentation(const TLSFAllocator& allocator)
+{
+    uint64_t freeSize = allocator.GetSize() - allocator.GetUsedSize();
+    if (freeSize == 0) {
+        return 0;
+    }
+    uint64_t largestFreeRange = allocator.GetLargestFreeRange();
+    return 1.0f - static_cast<float>(static_cast<double>(largestFreeRange) / static_cast<double>(freeSize));
+}
+
+Result MeshPoolAllocator::Create(uint32_t maxVertexCount, uint32_t maxIndexCount, MeshPoolAllocator* pAllocator)
+{
+    PPX_ASSERT_NULL_ARG(pAllocator);
+    if (IsNull(pAllocator)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (maxVertexCount == 0) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    *pAllocator = MeshPoolAllocator();
+
+    Result ppxres = TLSFAllocator::Create(maxVertexCount, 1, &pAllocator->mVertexAllocator);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    if (maxIndexCount > 0) {
+        ppxres = TLSFAllocator::Create(maxIndexCount, 1, &pAllocator->mIndexAllocator);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+    pAllocator->mMaxIndexCount = maxIndexCount;
+
+    return ppx::SUCCESS;
+}
+
+Result MeshPoolAllocator::Allocate(uint32_t vertexCount, uint32_t indexCount, uint32_t* pHandle)
+{
+    PPX_ASSERT_NULL_ARG(pHandle);
+    if (IsNull(pHandle)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((vertexCount == 0) || (indexCount > mMaxIndexCount)) {
+        return ppx::ERROR_OUT_OF_MEMORY;
+    }
+
+    Slot slot              = {};
+    slot.used              = true;
+    slot.range.vertexCount = vertexCount;
+    slot.range.indexCount  = indexCount;
+
+    TLSFAllocator::Allocation vertexAllocation = {};
+    Result                    ppxres           = mVertexAllocator.Allocate(vertexCount, &vertexAllocation);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    slot.range.vertexOffset = static_cast<uint32_t>(vertexAllocation.offset);
+    slot.vertexHandle       = vertexAllocation.handle;
+
+    if (indexCount > 0) {
+        TLSFAllocator::Allocation indexAllocation = {};
+        ppxres                                    = mIndexAllocator.Allocate(indexCount, &indexAllocation);
+        if (Failed(ppxres)) {
+            mVertexAllocator.Free(slot.vertexHandle);
+            return ppxres;
+        }
+        slot.range.firstIndex = static_cast<uint32_t>(indexAllocation.offset);
+        slot.indexHandle      = indexAllocation.handle;
+    }
+
+    uint32_t handle = kInvalidHandle;
+    if (!mFreeSlots.empty()) {
+        handle = mFreeSlots.back();
+        mFreeSlots.pop_back();
+        mSlots[handle] = slot;
+    }
+    else {
+        mSlots.push_back(slot);
+        handle = CountU32(mSlots) - 1;
+    }
+    mMeshCount += 1;
+
+    *pHandle = handle;
+
+    return ppx::SUCCESS;
+}
+
+void MeshPoolAllocator::Free(uint32_t handle)
+{
+    if (!IsValid(handle)) {
+        PPX_ASSERT_MSG(false, "invalid mesh pool handle: " << handle);
+        return;
+    }
+
+    Slot& slot = mSlots[handle];
+    mVertexAllocator.Free(slot.vertexHandle);
+    if (slot.indexHandle != TLSFAllocator::kInvalidHandle) {
+        mIndexAllocator.Free(slot.indexHandle);
+    }
+    slot = Slot();
+
+    mFreeSlots.push_back(handle);
+    mMeshCount -= 1;
+}
+
+bool MeshPoolAllocator::IsValid(uint32_t handle) const
+{
+    return (handle < CountU32(mSlots)) && mSlots[handle].used;
+}
+
+uint32_t MeshPoolAllocator::GetUsedIndexCount() const
+{
+    return (mMaxIndexCount > 0) ? static_cast<uint32_t>(mIndexAllocator.GetUsedSize()) : 0;
+}
+
+float MeshPoolAllocator::GetFragmentation() const
+{
+    float fragmentation = CalculateFragmentation(mVertexAllocator);
+    if (mMaxIndexCount > 0) {
+        fragmentation = std::max(fragmentation, CalculateFragmentation(mIndexAllocator));
+    }
+    return fragmentation;
+}
+
+void MeshPoolAllocator::Repack(bool indices, std::vector<grfx::MeshPoolCopy>* pCopies)
+{
+    TLSFAllocator& allocator = indices ? mIndexAllocator : mVertexAllocator;
+
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < CountU32(mSlots); ++i) {
+        const Slot& slot = mSlots[i];
+        if (slot.used && (!indices || (slot.range.indexCount > 0))) {
+            order.push_back(i);
+        }
+    }
+    std::sort(
+        order.begin(),
+        order.end(),
+        [this, indices](uint32_t a, uint32_t b) -> bool {
+            const grfx::MeshPoolRange& ra = mSlots[a].range;
+            const grfx::MeshPoolRange& rb = mSlots[b].range;
+            return indices ? (ra.firstIndex < rb.firstIndex) : (ra.vertexOffset < rb.vertexOffset);
+        });
+
+    // A fresh allocator hands out ranges from the start, so allocating in
+    // offset order packs them without reordering
+    TLSFAllocator packed;
+    Result        ppxres = TLSFAllocator::Create(allocator.GetSize(), 1, &packed);
+    PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "failed to recreate mesh pool allocator");
+
+    for (uint32_t index : order) {
+        Slot&     slot   = mSlots[index];
+        uint32_t& offset = indices ? slot.range.firstIndex : slot.range.vertexOffset;
+        uint32_t  count  = indices ? slot.range.indexCount : slot.range.vertexCount;
+
+        TLSFAllocator::Allocation allocation = {};
+        ppxres                               = packed.Allocate(count, &allocation);
+        PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "mesh pool ranges no longer fit after repacking");
+
+        uint32_t            dstOffset = static_cast<uint32_t>(allocation.offset);
+        grfx::MeshPoolCopy* pLast     = pCopies->empty() ? nullptr : &pCopies->back();
+        bool                adjacent  = !IsNull(pLast) && (pLast->srcOffset + pLast->count == offset) && (pLast->dstOffset + pLast->count == dstOffset);
+        if (adjacent) {
+            pLast->count += count;
+        }
+        else {
+            grfx::MeshPoolCopy copy = {};
+            copy.srcOffset          = offset;
+            copy.dstOffset          = dstOffset;
+            copy.count              = count;
+            pCopies->push_back(copy);
+        }
+
+        offset = dstOffset;
+        if (indices) {
+            slot.indexHandle = allocation.handle;
+        }
+        else {
+            slot.vertexHandle = allocation.handle;
+        }
+    }
+
+    allocator = std::move(packed);
+}
+
+void MeshPoolAllocator::Defragment(std::vector<grfx::MeshPoolCopy>* pVertexCopies, std::vector<grfx::MeshPoolCopy>* pIndexCopies)
+{
+    PPX_ASSERT_NULL_ARG(pVertexCopies);
+    PPX_ASSERT_NULL_ARG(pIndexCopies);
+
+    pVertexCopies->clear();
+    pIndexCopies->clear();
+
+    Repack(false, pVertexCopies);
+    if (mMaxIndexCount > 0) {
+        Repack(true, pIndexCopies);
+    }
+}
+
+} // namespace grfx
+} // namespace ppx
@@ -0,0 +1,519 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_occlusion_culler.h"
+#include "ppx/grfx/grfx_device.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace ppx {
+namespace grfx {
+
+// Must match HiZBuild.hlsl and HiZOcclusionTest.hlsl
+constexpr uint32_t kBuildGroupSize = 8;
+constexpr uint32_t kTestGroupSize  = 64;
+
+// Min and max corners as float4s
+constexpr uint32_t kBoundsStride = 8 * sizeof(float);
+
+struct OcclusionTestParams
+{
+    float4x4 viewProjection;
+    float2   hizSize;
+    uint32_t mipLevelCount;
+    uint32_t objectCount;
+};
+
+Result OcclusionCuller::CreateApiObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo)
+{
+    if ((pCreateInfo->width == 0) || (pCreateInfo->height == 0) || (pCreateInfo->maxObjectCount == 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+    if (IsNull(pCreateInfo->buildCS.pModule) || IsNull(pCreateInfo->testCS.pModule)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+
+    // HiZ pyramid, level 0 has the size of the depth buffer
+    {
+        const uint32_t mipLevelCount = static_cast<uint32_t>(std::bit_width(std::max(pCreateInfo->width, pCreateInfo->height)));
+
+        grfx::ImageCreateInfo createInfo   = {};
+        createInfo.type                    = grfx::IMAGE_TYPE_2D;
+        createInfo.width                   = pCreateInfo->width;
+        createInfo.height                  = pCreateInfo->height;
+        createInfo.depth                   = 1;
+        createInfo.format                  = grfx::FORMAT_R32_FLOAT;
+        createInfo.mipLevelCount           = mipLevelCount;
+        createInfo.usageFlags.bits.sampled = true;
+        createInfo.usageFlags.bits.storage = true;
+        createInfo.initialState            = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+        Result ppxres = GetDevice()->CreateImage(&createInfo, &mHiZImage);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating HiZ image");
+            return ppxres;
+        }
+
+        for (uint32_t level = 0; level < mipLevelCount; ++level) {
+            grfx::StorageImageViewCreateInfo storageCreateInfo = grfx::StorageImageViewCreateInfo::GuessFromImage(mHiZImage);
+            storageCreateInfo.mipLevel                         = level;
+            storageCreateInfo.mipLevelCount                    = 1;
+
+            grfx::StorageImageViewPtr storageView;
+            ppxres = GetDevice()->CreateStorageImageView(&storageCreateInfo, &storageView);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            mHiZStorageViews.push_back(storageView);
+
+            grfx::SampledImageViewCreateInfo sampledCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(mHiZImage);
+            sampledCreateInfo.mipLevel                         = level;
+            sampledCreateInfo.mipLevelCount                    = 1;
+
+            grfx::SampledImageViewPtr sampledView;
+            ppxres = GetDevice()->CreateSampledImageView(&sampledCreateInfo, &sampledView);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            mHiZSampledViews.push_back(sampledView);
+        }
+
+        grfx::SampledImageViewCreateInfo sampledCreateInfo = grfx::SampledImageViewCreateInfo::GuessFromImage(mHiZImage);
+        ppxres                                             = GetDevice()->CreateSampledImageView(&sampledCreateInfo, &mHiZView);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    // One build set per level and one test set
+    {
+        const uint32_t levelCount = GetMipLevelCount();
+
+        grfx::DescriptorPoolCreateInfo createInfo = {};
+        createInfo.sampledImage                   = levelCount + 1;
+        createInfo.storageImage                   = levelCount;
+        createInfo.uniformBuffer                  = 1;
+        createInfo.structuredBuffer               = 2;
+
+        Result ppxres = GetDevice()->CreateDescriptorPool(&createInfo, &mDescriptorPool);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    Result ppxres = CreateBuildObjects(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    ppxres = CreateTestObjects(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result OcclusionCuller::CreateBuildObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo)
+{
+    grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(0, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE));
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(1, grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE));
+
+    Result ppxres = GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mBuildSetLayout);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Level 0 reads the depth buffer, its source is written by RecordBuildHiZ()
+    for (uint32_t level = 0; level < GetMipLevelCount(); ++level) {
+        grfx::DescriptorSetPtr set;
+        ppxres = GetDevice()->AllocateDescriptorSet(mDescriptorPool, mBuildSetLayout, &set);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        mBuildSets.push_back(set);
+
+        grfx::WriteDescriptor writes[2] = {};
+        writes[0].binding               = 0;
+        writes[0].type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        writes[0].pImageView            = (level > 0) ? mHiZSampledViews[level - 1].Get() : nullptr;
+        writes[1].binding               = 1;
+        writes[1].type                  = grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageView            = mHiZStorageViews[level];
+
+        ppxres = (level > 0) ? set->UpdateDescriptors(2, writes) : set->UpdateDescriptors(1, &writes[1]);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    grfx::PipelineInterfaceCreateInfo piCreateInfo = {};
+    piCreateInfo.setCount                          = 1;
+    piCreateInfo.sets[0].set                       = 0;
+    piCreateInfo.sets[0].pLayout                   = mBuildSetLayout;
+
+    ppxres = GetDevice()->CreatePipelineInterface(&piCreateInfo, &mBuildPipelineInterface);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::ComputePipelineCreateInfo cpCreateInfo = {};
+    cpCreateInfo.CS                              = pCreateInfo->buildCS;
+    cpCreateInfo.pPipelineInterface              = mBuildPipelineInterface;
+
+    ppxres = GetDevice()->CreateComputePipeline(&cpCreateInfo, &mBuildPipeline);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating HiZ build pipeline");
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result OcclusionCuller::CreateTestObjects(const grfx::OcclusionCullerCreateInfo* pCreateInfo)
+{
+    // Bounds, written by SetBounds()
+    {
+        grfx::BufferCreateInfo createInfo             = {};
+        createInfo.size                               = std::max<uint64_t>(pCreateInfo->maxObjectCount * kBoundsStride, PPX_MINIMUM_STRUCTURED_BUFFER_SIZE);
+        createInfo.structuredElementStride            = kBoundsStride;
+        createInfo.usageFlags.bits.roStructuredBuffer = true;
+        createInfo.memoryUsage                        = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mBoundsBuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        void* pMappedAddress = nullptr;
+        ppxres               = mBoundsBuffer->MapMemory(0, &pMappedAddress);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        mBounds = static_cast<float*>(pMappedAddress);
+    }
+
+    // Parameters, written by RecordOcclusionTest()
+    {
+        grfx::BufferCreateInfo createInfo        = {};
+        createInfo.size                          = std::max<uint64_t>(sizeof(OcclusionTestParams), PPX_MINIMUM_UNIFORM_BUFFER_SIZE);
+        createInfo.usageFlags.bits.uniformBuffer = true;
+        createInfo.memoryUsage                   = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mParamsBuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        ppxres = mParamsBuffer->MapMemory(0, &mParams);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    // Results, written by the test and copied to a buffer the CPU can read
+    {
+        grfx::BufferCreateInfo createInfo             = {};
+        createInfo.size                               = std::max<uint64_t>(pCreateInfo->maxObjectCount * sizeof(uint32_t), PPX_MINIMUM_STRUCTURED_BUFFER_SIZE);
+        createInfo.structuredElementStride            = sizeof(uint32_t);
+        createInfo.usageFlags.bits.rwStructuredBuffer = true;
+        createInfo.usageFlags.bits.transferSrc        = true;
+        createInfo.memoryUsage                        = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                       = grfx::RESOURCE_STATE_UNORDERED_ACCESS;
+
+        Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mVisibilityBuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        createInfo.structuredElementStride     = 0;
+        createInfo.usageFlags                  = 0;
+        createInfo.usageFlags.bits.transferDst = true;
+        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_TO_CPU;
+        createInfo.initialState                = grfx::RESOURCE_STATE_COPY_DST;
+
+        ppxres = GetDevice()->CreateBuffer(&createInfo, &mReadbackBuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        void* pMappedAddress = nullptr;
+        ppxres               = mReadbackBuffer->MapMemory(0, &pMappedAddress);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        mVisibility = static_cast<const uint32_t*>(pMappedAddress);
+    }
+
+    grfx::DescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(0, grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER));
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(1, grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER));
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(2, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE));
+    layoutCreateInfo.bindings.push_back(grfx::DescriptorBinding(3, grfx::DESCRIPTOR_TYPE_RW_STRUCTURED_BUFFER));
+
+    Result ppxres = GetDevice()->CreateDescriptorSetLayout(&layoutCreateInfo, &mTestSetLayout);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    ppxres = GetDevice()->AllocateDescriptorSet(mDescriptorPool, mTestSetLayout, &mTestSet);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::WriteDescriptor writes[4]  = {};
+    writes[0].binding                = 0;
+    writes[0].type                   = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[0].bufferRange            = PPX_WHOLE_SIZE;
+    writes[0].pBuffer                = mParamsBuffer;
+    writes[1].binding                = 1;
+    writes[1].type                   = grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER;
+    writes[1].bufferRange            = PPX_WHOLE_SIZE;
+    writes[1].structuredElementCount = pCreateInfo->maxObjectCount;
+    writes[1].pBuffer                = mBoundsBuffer;
+    writes[2].binding                = 2;
+    writes[2].type                   = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    writes[2].pImageView             = mHiZView;
+    writes[3].binding                = 3;
+    writes[3].type                   = grfx::DESCRIPTOR_TYPE_RW_STRUCTURED_BUFFER;
+    writes[3].bufferRange            = PPX_WHOLE_SIZE;
+    writes[3].structuredElementCount = pCreateInfo->maxObjectCount;
+    writes[3].pBuffer                = mVisibilityBuffer;
+
+    ppxres = mTestSet->UpdateDescriptors(4, writes);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::PipelineInterfaceCreateInfo piCreateInfo = {};
+    piCreateInfo.setCount                          = 1;
+    piCreateInfo.sets[0].set                       = 0;
+    piCreateInfo.sets[0].pLayout                   = mTestSetLayout;
+
+    ppxres = GetDevice()->CreatePipelineInterface(&piCreateInfo, &mTestPipelineInterface);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::ComputePipelineCreateInfo cpCreateInfo = {};
+    cpCreateInfo.CS                              = pCreateInfo->testCS;
+    cpCreateInfo.pPipelineInterface              = mTestPipelineInterface;
+
+    ppxres = GetDevice()->CreateComputePipeline(&cpCreateInfo, &mTestPipeline);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating HiZ occlusion test pipeline");
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+void OcclusionCuller::DestroyApiObjects()
+{
+    if (mTestPipeline) {
+        GetDevice()->DestroyComputePipeline(mTestPipeline);
+        mTestPipeline.Reset();
+    }
+
+    if (mTestPipelineInterface) {
+        GetDevice()->DestroyPipelineInterface(mTestPipelineInterface);
+        mTestPipelineInterface.Reset();
+    }
+
+    if (mTestSet) {
+        GetDevice()->FreeDescriptorSet(mTestSet);
+        mTestSet.Reset();
+    }
+
+    if (mTestSetLayout) {
+        GetDevice()->DestroyDescriptorSetLayout(mTestSetLayout);
+        mTestSetLayout.Reset();
+    }
+
+    if (mReadbackBuffer) {
+        mReadbackBuffer->UnmapMemory();
+        GetDevice()->DestroyBuffer(mReadbackBuffer);
+        mReadbackBuffer.Reset();
+    }
+    mVisibility = nullptr;
+
+    if (mVisibilityBuffer) {
+        GetDevice()->DestroyBuffer(mVisibilityBuffer);
+        mVisibilityBuffer.Reset();
+    }
+
+    if (mParamsBuffer) {
+        mParamsBuffer->UnmapMemory();
+        GetDevice()->DestroyBuffer(mParamsBuffer);
+        mParamsBuffer.Reset();
+    }
+    mParams = nullptr;
+
+    if (mBoundsBuffer) {
+        mBoundsBuffer->UnmapMemory();
+        GetDevice()->DestroyBuffer(mBoundsBuffer);
+        mBoundsBuffer.Reset();
+    }
+    mBounds = nullptr;
+
+    if (mBuildPipeline) {
+        GetDevice()->DestroyComputePipeline(mBuildPipeline);
+        mBuildPipeline.Reset();
+    }
+
+    if (mBuildPipelineInterface) {
+        GetDevice()->DestroyPipelineInterface(mBuildPipelineInterface);
+        mBuildPipelineInterface.Reset();
+    }
+
+    for (grfx::DescriptorSetPtr& set : mBuildSets) {
+        GetDevice()->FreeDescriptorSet(set);
+    }
+    mBuildSets.clear();
+
+    if (mBuildSetLayout) {
+        GetDevice()->DestroyDescriptorSetLayout(mBuildSetLayout);
+        mBuildSetLayout.Reset();
+    }
+
+    if (mDescriptorPool) {
+        GetDevice()->DestroyDescriptorPool(mDescriptorPool);
+        mDescriptorPool.Reset();
+    }
+
+    if (mHiZView) {
+        GetDevice()->DestroySampledImageView(mHiZView);
+        mHiZView.Reset();
+    }
+
+    for (grfx::SampledImageViewPtr& view : mHiZSampledViews) {
+        GetDevice()->DestroySampledImageView(view);
+    }
+    mHiZSampledViews.clear();
+
+    for (grfx::StorageImageViewPtr& view : mHiZStorageViews) {
+        GetDevice()->DestroyStorageImageView(view);
+    }
+    mHiZStorageViews.clear();
+
+    if (mHiZImage) {
+        GetDevice()->DestroyImage(mHiZImage);
+        mHiZImage.Reset();
+    }
+
+    mDepthView   = nullptr;
+    mBoundsCount = 0;
+    mTestedCount = 0;
+}
+
+Result OcclusionCuller::SetBounds(uint32_t count, const ppx::AABB* pBounds)
+{
+    if ((count > 0) && IsNull(pBounds)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (count > mCreateInfo.maxObjectCount) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const float3& minPos = pBounds[i].GetMin();
+        const float3& maxPos = pBounds[i].GetMax();
+        float*        pDst   = mBounds + i * 8;
+        pDst[0]              = minPos.x;
+        pDst[1]              = minPos.y;
+        pDst[2]              = minPos.z;
+        pDst[3]              = 1.0f;
+        pDst[4]              = maxPos.x;
+        pDst[5]              = maxPos.y;
+        pDst[6]              = maxPos.z;
+        pDst[7]              = 1.0f;
+    }
+    mBoundsCount = count;
+
+    return ppx::SUCCESS;
+}
+
+void OcclusionCuller::RecordBuildHiZ(grfx::CommandBuffer* pCommandBuffer, const grfx::SampledImageView* pDepthView)
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+    PPX_ASSERT_NULL_ARG(pDepthView);
+
+    // The depth view usually stays the same, only update level 0 when it changes
+    if (pDepthView != mDepthView) {
+        grfx::WriteDescriptor write = {};
+        write.binding               = 0;
+        write.type                  = grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        write.pImageView            = pDepthView;
+        PPX_CHECKED_CALL(mBuildSets[0]->UpdateDescriptors(1, &write));
+        mDepthView = pDepthView;
+    }
+
+    pCommandBuffer->BindComputePipeline(mBuildPipeline);
+
+    // Each level is written as a storage image then read by the next one
+    uint32_t width  = mCreateInfo.width;
+    uint32_t height = mCreateInfo.height;
+    for (uint32_t level = 0; level < GetMipLevelCount(); ++level) {
+        pCommandBuffer->TransitionImageLayout(mHiZImage, level, 1, 0, 1, grfx::RESOURCE_STATE_SHADER_RESOURCE, grfx::RESOURCE_STATE_UNORDERED_ACCESS);
+        pCommandBuffer->BindComputeDescriptorSets(mBuildPipelineInterface, 1, &mBuildSets[level]);
+        pCommandBuffer->Dispatch((width + kBuildGroupSize - 1) / kBuildGroupSize, (height + kBuildGroupSize - 1) / kBuildGroupSize, 1);
+        pCommandBuffer->TransitionImageLayout(mHiZImage, level, 1, 0, 1, grfx::RESOURCE_STATE_UNORDERED_ACCESS, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+
+        width  = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+}
+
+void OcclusionCuller::RecordOcclusionTest(grfx::CommandBuffer* pCommandBuffer, const float4x4& viewProjection)
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+
+    OcclusionTestParams params = {};
+    params.viewProjection      = viewProjection;
+    params.hizSize             = float2(static_cast<float>(mCreateInfo.width), static_cast<float>(mCreateInfo.height));
+    params.mipLevelCount       = GetMipLevelCount();
+    params.objectCount         = mBoundsCount;
+    std::memcpy(mParams, &params, sizeof(params));
+
+    mTestedCount = mBoundsCount;
+    if (mBoundsCount == 0) {
+        return;
+    }
+
+    pCommandBuffer->BindComputeDescriptorSets(mTestPipelineInterface, 1, &mTestSet);
+    pCommandBuffer->BindComputePipeline(mTestPipeline);
+    pCommandBuffer->Dispatch((mBoundsCount + kTestGroupSize - 1) / kTestGroupSize, 1, 1);
+
+    grfx::BufferToBufferCopyInfo copyInfo = {};
+    copyInfo.size                         = mBoundsCount * sizeof(uint32_t);
+
+    pCommandBuffer->BufferResourceBarrier(mVisibilityBuffer, grfx::RESOURCE_STATE_UNORDERED_ACCESS, grfx::RESOURCE_STATE_COPY_SRC);
+    pCommandBuffer->CopyBufferToBuffer(&copyInfo, mVisibilityBuffer, mReadbackBuffer);
+    pCommandBuffer->BufferResourceBarrier(mVisibilityBuffer, grfx::RESOURCE_STATE_COPY_SRC, grfx::RESOURCE_STATE_UNORDERED_ACCESS);
+}
+
+uint32_t OcclusionCuller::GetOccludedCount() const
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < mTestedCount; ++i) {
+        count += (mVisibility[i] == 0) ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace grfx
+} // namespace ppx
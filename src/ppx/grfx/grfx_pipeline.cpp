@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "ppx/grfx/grfx_pipeline.h"
+#include "ppx/grfx/grfx_descriptor.h"
+#include "ppx/grfx/grfx_shader.h"
+
+#include <type_traits>
 
 namespace ppx {
 namespace grfx {
@@ -183,12 +187,189 @@ void FillOutGraphicsPipelineCreateInfo(
         }
 
         pDstCreateInfo->outputState.depthStencilFormat = pSrcCreateInfo->outputState.depthStencilFormat;
+        pDstCreateInfo->outputState.dynamicRendering   = pSrcCreateInfo->outputState.dynamicRendering;
     }
 
     // Pipeline internface
     pDstCreateInfo->pPipelineInterface = pSrcCreateInfo->pPipelineInterface;
 }
 
+// Appends values field by field, so padding and unused array entries never
+// end up in the key.
+class PipelineKeyWriter
+{
+public:
+    PipelineKeyWriter(std::string* pKey)
+        : mKey(pKey) {}
+
+    template <typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "only scalars can be written");
+        mKey->append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void Write(const std::string& value)
+    {
+        Write(static_cast<uint32_t>(value.size()));
+        mKey->append(value);
+    }
+
+    void Write(const grfx::ShaderStageInfo& stage)
+    {
+        // Modules with the same code compile to the same pipeline
+        Write(IsNull(stage.pModule) ? uint64_t(0) : stage.pModule->GetCodeHash());
+        Write(stage.entryPoint);
+    }
+
+    void Write(const grfx::StencilOpState& state)
+    {
+        Write(state.failOp);
+        Write(state.passOp);
+        Write(state.depthFailOp);
+        Write(state.compareOp);
+        Write(state.compareMask);
+        Write(state.writeMask);
+        Write(state.reference);
+    }
+
+private:
+    std::string* mKey = nullptr;
+};
+
+void GetGraphicsPipelineKey(
+    const grfx::GraphicsPipelineCreateInfo& createInfo,
+    bool                                    compareInterfaceLayouts,
+    std::string*                            pKey)
+{
+    PPX_ASSERT_NULL_ARG(pKey);
+
+    pKey->clear();
+    PipelineKeyWriter writer(pKey);
+
+    // Shaders
+    writer.Write(createInfo.VS);
+    writer.Write(createInfo.HS);
+    writer.Write(createInfo.DS);
+    writer.Write(createInfo.GS);
+    writer.Write(createInfo.PS);
+
+    // Vertex input
+    writer.Write(createInfo.vertexInputState.bindingCount);
+    for (uint32_t i = 0; i < createInfo.vertexInputState.bindingCount; ++i) {
+        const grfx::VertexBinding& binding = createInfo.vertexInputState.bindings[i];
+        writer.Write(binding.GetBinding());
+        writer.Write(binding.GetStride());
+        writer.Write(binding.GetInputRate());
+        writer.Write(binding.GetAttributeCount());
+        for (uint32_t j = 0; j < binding.GetAttributeCount(); ++j) {
+            const grfx::VertexAttribute* pAttribute = nullptr;
+            binding.GetAttribute(j, &pAttribute);
+            // D3D12 matches attributes by semantic name
+            writer.Write(pAttribute->semanticName);
+            writer.Write(pAttribute->location);
+            writer.Write(pAttribute->format);
+            writer.Write(pAttribute->binding);
+            writer.Write(pAttribute->offset);
+            writer.Write(pAttribute->inputRate);
+        }
+    }
+
+    // Input assembly and tessellation
+    writer.Write(createInfo.inputAssemblyState.topology);
+    writer.Write(createInfo.inputAssemblyState.primitiveRestartEnable);
+    if (!IsNull(createInfo.HS.pModule)) {
+        writer.Write(createInfo.tessellationState.patchControlPoints);
+        writer.Write(createInfo.tessellationState.domainOrigin);
+    }
+
+    // Raster
+    const grfx::RasterState& raster = createInfo.rasterState;
+    writer.Write(raster.depthClampEnable);
+    writer.Write(raster.rasterizeDiscardEnable);
+    writer.Write(raster.polygonMode);
+    writer.Write(raster.cullMode);
+    writer.Write(raster.frontFace);
+    writer.Write(raster.depthBiasEnable);
+    if (raster.depthBiasEnable) {
+        writer.Write(raster.depthBiasConstantFactor);
+        writer.Write(raster.depthBiasClamp);
+        writer.Write(raster.depthBiasSlopeFactor);
+    }
+    writer.Write(raster.depthClipEnable);
+    writer.Write(raster.rasterizationSamples);
+    writer.Write(createInfo.multisampleState.alphaToCoverageEnable);
+
+    // Depth stencil
+    const grfx::DepthStencilState& depthStencil = createInfo.depthStencilState;
+    writer.Write(depthStencil.depthTestEnable);
+    if (depthStencil.depthTestEnable) {
+        writer.Write(depthStencil.depthWriteEnable);
+        writer.Write(depthStencil.depthCompareOp);
+    }
+    writer.Write(depthStencil.depthBoundsTestEnable);
+    if (depthStencil.depthBoundsTestEnable) {
+        writer.Write(depthStencil.minDepthBounds);
+        writer.Write(depthStencil.maxDepthBounds);
+    }
+    writer.Write(depthStencil.stencilTestEnable);
+    if (depthStencil.stencilTestEnable) {
+        writer.Write(depthStencil.front);
+        writer.Write(depthStencil.back);
+    }
+
+    // Color blend
+    const grfx::ColorBlendState& colorBlend = createInfo.colorBlendState;
+    writer.Write(colorBlend.logicOpEnable);
+    if (colorBlend.logicOpEnable) {
+        writer.Write(colorBlend.logicOp);
+    }
+    writer.Write(colorBlend.blendAttachmentCount);
+    for (uint32_t i = 0; i < colorBlend.blendAttachmentCount; ++i) {
+        const grfx::BlendAttachmentState& attachment = colorBlend.blendAttachments[i];
+        writer.Write(attachment.blendEnable);
+        if (attachment.blendEnable) {
+            writer.Write(attachment.srcColorBlendFactor);
+            writer.Write(attachment.dstColorBlendFactor);
+            writer.Write(attachment.colorBlendOp);
+            writer.Write(attachment.srcAlphaBlendFactor);
+            writer.Write(attachment.dstAlphaBlendFactor);
+            writer.Write(attachment.alphaBlendOp);
+        }
+        writer.Write(attachment.colorWriteMask.flags);
+    }
+    for (uint32_t i = 0; i < 4; ++i) {
+        writer.Write(colorBlend.blendConstants[i]);
+    }
+
+    // Output
+    writer.Write(createInfo.outputState.renderTargetCount);
+    for (uint32_t i = 0; i < createInfo.outputState.renderTargetCount; ++i) {
+        writer.Write(createInfo.outputState.renderTargetFormats[i]);
+    }
+    writer.Write(createInfo.outputState.depthStencilFormat);
+    writer.Write(createInfo.outputState.dynamicRendering);
+
+    // Pipeline interface
+    const grfx::PipelineInterface* pInterface = createInfo.pPipelineInterface;
+    if (IsNull(pInterface) || !compareInterfaceLayouts) {
+        writer.Write(reinterpret_cast<uintptr_t>(pInterface));
+        return;
+    }
+    writer.Write(CountU32(pInterface->GetSetNumbers()));
+    for (uint32_t set : pInterface->GetSetNumbers()) {
+        const std::vector<grfx::DescriptorBinding>& bindings = pInterface->GetSetLayout(set)->GetBindings();
+        writer.Write(set);
+        writer.Write(CountU32(bindings));
+        for (const grfx::DescriptorBinding& binding : bindings) {
+            writer.Write(binding.binding);
+            writer.Write(binding.type);
+            writer.Write(binding.arrayCount);
+            writer.Write(binding.shaderVisiblity);
+        }
+    }
+}
+
 } // namespace internal
 
 // -------------------------------------------------------------------------------------------------
@@ -339,5 +520,15 @@ Result PipelineInterface::Create(const grfx::PipelineInterfaceCreateInfo* pCreat
     return ppx::SUCCESS;
 }
 
+const grfx::DescriptorSetLayout* PipelineInterface::GetSetLayout(uint32_t set) const
+{
+    for (uint32_t i = 0; i < mCreateInfo.setCount; ++i) {
+        if (mCreateInfo.sets[i].set == set) {
+            return mCreateInfo.sets[i].pLayout;
+        }
+    }
+    return nullptr;
+}
+
 } // namespace grfx
 } // namespace ppx
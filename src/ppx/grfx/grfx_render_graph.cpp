@@ -0,0 +1,382 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_render_graph.h"
+#include "ppx/grfx/grfx_command.h"
+#include "ppx/grfx/grfx_device.h"
+
+namespace ppx {
+namespace grfx {
+
+Result RenderGraph::CreateApiObjects(const grfx::RenderGraphCreateInfo* pCreateInfo)
+{
+    // Nothing to create until Compile()
+    return ppx::SUCCESS;
+}
+
+void RenderGraph::DestroyApiObjects()
+{
+    DestroyTransientObjects();
+}
+
+void RenderGraph::DestroyTransientObjects()
+{
+    for (Pass& pass : mPasses) {
+        for (CachedDrawPass& cached : pass.drawPasses) {
+            GetDevice()->DestroyDrawPass(cached.drawPass);
+        }
+        pass.drawPasses.clear();
+    }
+
+    for (grfx::TexturePtr& texture : mTextures) {
+        GetDevice()->DestroyTexture(texture);
+    }
+    mTextures.clear();
+
+    mCompiled = false;
+}
+
+uint32_t RenderGraph::CreateImage(const grfx::RenderGraphImageInfo& info)
+{
+    mImportedImages.push_back(nullptr);
+    mCompiled = false;
+    return mPlan.AddImage(info);
+}
+
+uint32_t RenderGraph::ImportImage(grfx::Image* pImage, grfx::ResourceState initialState, grfx::ResourceState finalState)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+
+    grfx::RenderGraphImageInfo info = {};
+    info.width                      = pImage->GetWidth();
+    info.height                     = pImage->GetHeight();
+    info.format                     = pImage->GetFormat();
+    info.sampleCount                = pImage->GetSampleCount();
+
+    mImportedImages.push_back(pImage);
+    mCompiled = false;
+    return mPlan.ImportImage(info, initialState, finalState);
+}
+
+Result RenderGraph::SetImportedImage(uint32_t image, grfx::Image* pImage)
+{
+    PPX_ASSERT_NULL_ARG(pImage);
+    if (IsNull(pImage)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((image >= CountU32(mImportedImages)) || IsNull(mImportedImages[image])) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    const grfx::Image* pCurrent = mImportedImages[image];
+    if ((pImage->GetWidth() != pCurrent->GetWidth()) ||
+        (pImage->GetHeight() != pCurrent->GetHeight()) ||
+        (pImage->GetFormat() != pCurrent->GetFormat()) ||
+        (pImage->GetSampleCount() != pCurrent->GetSampleCount())) {
+        PPX_ASSERT_MSG(false, "imported image replacement must match the original image");
+        return ppx::ERROR_FAILED;
+    }
+
+    mImportedImages[image] = pImage;
+
+    return ppx::SUCCESS;
+}
+
+uint32_t RenderGraph::AddPass(const std::string& name, grfx::RenderGraphExecuteFn executeFn, bool hasSideEffects)
+{
+    Pass pass      = {};
+    pass.name      = name;
+    pass.executeFn = executeFn;
+    mPasses.push_back(pass);
+
+    mCompiled = false;
+    return mPlan.AddPass(hasSideEffects);
+}
+
+Result RenderGraph::AddRenderTarget(uint32_t pass, uint32_t image, const grfx::RenderTargetClearValue* pClearValue)
+{
+    if (pass >= CountU32(mPasses)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    Pass& target = mPasses[pass];
+    if (target.renderTargetCount >= PPX_MAX_RENDER_TARGETS) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    Result ppxres = mPlan.AddAccess(pass, image, grfx::RENDER_GRAPH_ACCESS_RENDER_TARGET);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    target.renderTargets[target.renderTargetCount] = image;
+    if (!IsNull(pClearValue)) {
+        target.renderTargetClearValues[target.renderTargetCount] = *pClearValue;
+        target.clearFlags.flags |= grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_RENDER_TARGETS;
+    }
+    target.renderTargetCount += 1;
+
+    mCompiled = false;
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::SetDepthStencil(uint32_t pass, uint32_t image, bool write, const grfx::DepthStencilClearValue* pClearValue)
+{
+    if (pass >= CountU32(mPasses)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    Pass& target = mPasses[pass];
+    if (target.depthStencil != kInvalidIndex) {
+        return ppx::ERROR_DUPLICATE_ELEMENT;
+    }
+    if (!write && !IsNull(pClearValue)) {
+        PPX_ASSERT_MSG(false, "read-only depth stencil attachments can't be cleared");
+        return ppx::ERROR_FAILED;
+    }
+
+    grfx::RenderGraphAccess access = write ? grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE : grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ;
+    Result                  ppxres = mPlan.AddAccess(pass, image, access);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    target.depthStencil      = image;
+    target.depthStencilWrite = write;
+    if (!IsNull(pClearValue)) {
+        target.depthStencilClearValue = *pClearValue;
+        target.clearFlags.flags |= grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_DEPTH | grfx::DRAW_PASS_CLEAR_FLAG_CLEAR_STENCIL;
+    }
+
+    mCompiled = false;
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::AddAccess(uint32_t pass, uint32_t image, grfx::RenderGraphAccess access)
+{
+    if ((access == grfx::RENDER_GRAPH_ACCESS_RENDER_TARGET) ||
+        (access == grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE) ||
+        (access == grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ)) {
+        PPX_ASSERT_MSG(false, "use AddRenderTarget() or SetDepthStencil() for attachments");
+        return ppx::ERROR_FAILED;
+    }
+
+    Result ppxres = mPlan.AddAccess(pass, image, access);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    mCompiled = false;
+    return ppx::SUCCESS;
+}
+
+void RenderGraph::Clear()
+{
+    DestroyTransientObjects();
+    mPlan.Clear();
+    mPasses.clear();
+    mImportedImages.clear();
+}
+
+Result RenderGraph::Compile()
+{
+    DestroyTransientObjects();
+
+    Result ppxres = mPlan.Compile(mCreateInfo.enableAliasing);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    for (uint32_t i = 0; i < mPlan.GetPhysicalImageCount(); ++i) {
+        const grfx::RenderGraphImageInfo& info = mPlan.GetPhysicalImageInfo(i);
+        const uint32_t                    mask = mPlan.GetPhysicalImageAccessMask(i);
+
+        grfx::TextureCreateInfo createInfo                    = {};
+        createInfo.imageType                                  = grfx::IMAGE_TYPE_2D;
+        createInfo.width                                      = info.width;
+        createInfo.height                                     = info.height;
+        createInfo.depth                                      = 1;
+        createInfo.imageFormat                                = info.format;
+        createInfo.sampleCount                                = info.sampleCount;
+        createInfo.usageFlags                                 = 0;
+        createInfo.usageFlags.bits.colorAttachment            = (mask & (1u << grfx::RENDER_GRAPH_ACCESS_RENDER_TARGET)) != 0;
+        createInfo.usageFlags.bits.depthStencilAttachment     = (mask & ((1u << grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE) | (1u << grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ))) != 0;
+        createInfo.usageFlags.bits.sampled                    = (mask & (1u << grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE)) != 0;
+        createInfo.usageFlags.bits.storage                    = (mask & (1u << grfx::RENDER_GRAPH_ACCESS_STORAGE)) != 0;
+        createInfo.usageFlags.bits.transferSrc                = (mask & (1u << grfx::RENDER_GRAPH_ACCESS_COPY_SRC)) != 0;
+        createInfo.usageFlags.bits.transferDst                = (mask & (1u << grfx::RENDER_GRAPH_ACCESS_COPY_DST)) != 0;
+        createInfo.memoryUsage                                = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                               = mPlan.GetPhysicalImageInitialState(i);
+        createInfo.ownership                                  = grfx::OWNERSHIP_RESTRICTED;
+
+        grfx::TexturePtr texture;
+        ppxres = GetDevice()->CreateTexture(&createInfo, &texture);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating render graph texture");
+            DestroyTransientObjects();
+            return ppxres;
+        }
+        mTextures.push_back(texture);
+    }
+
+    mCompiled = true;
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::GetDrawPass(Pass& pass, grfx::DrawPass** ppDrawPass)
+{
+    // Imported images may change between frames, so draw passes are cached
+    // per set of attachment images.
+    CachedDrawPass key = {};
+    for (uint32_t i = 0; i < pass.renderTargetCount; ++i) {
+        key.pAttachments[i] = GetImage(pass.renderTargets[i]);
+    }
+    if (pass.depthStencil != kInvalidIndex) {
+        key.pAttachments[PPX_MAX_RENDER_TARGETS] = GetImage(pass.depthStencil);
+    }
+
+    auto it = FindIf(
+        pass.drawPasses,
+        [&key](const CachedDrawPass& elem) -> bool {
+            return std::equal(std::begin(key.pAttachments), std::end(key.pAttachments), std::begin(elem.pAttachments));
+        });
+    if (it != std::end(pass.drawPasses)) {
+        *ppDrawPass = it->drawPass;
+        return ppx::SUCCESS;
+    }
+
+    const grfx::Image* pFirst = (pass.renderTargetCount > 0) ? key.pAttachments[0] : key.pAttachments[PPX_MAX_RENDER_TARGETS];
+
+    grfx::DrawPassCreateInfo2 createInfo = {};
+    createInfo.width                     = pFirst->GetWidth();
+    createInfo.height                    = pFirst->GetHeight();
+    createInfo.renderTargetCount         = pass.renderTargetCount;
+    createInfo.pDepthStencilImage        = key.pAttachments[PPX_MAX_RENDER_TARGETS];
+    createInfo.depthStencilState         = pass.depthStencilWrite ? grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE : grfx::RESOURCE_STATE_DEPTH_STENCIL_READ;
+    createInfo.depthStencilClearValue    = pass.depthStencilClearValue;
+    for (uint32_t i = 0; i < pass.renderTargetCount; ++i) {
+        createInfo.pRenderTargetImages[i]     = key.pAttachments[i];
+        createInfo.renderTargetClearValues[i] = pass.renderTargetClearValues[i];
+    }
+
+    Result ppxres = GetDevice()->CreateDrawPass(&createInfo, &key.drawPass);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating draw pass for render graph pass: " << pass.name);
+        return ppxres;
+    }
+    pass.drawPasses.push_back(key);
+
+    *ppDrawPass = key.drawPass;
+    return ppx::SUCCESS;
+}
+
+Result RenderGraph::Execute(grfx::CommandBuffer* pCommandBuffer)
+{
+    PPX_ASSERT_NULL_ARG(pCommandBuffer);
+    if (!mCompiled) {
+        PPX_ASSERT_MSG(false, "render graph must be compiled before it's executed");
+        return ppx::ERROR_FAILED;
+    }
+
+    for (uint32_t passIndex : mPlan.GetExecutionOrder()) {
+        for (const grfx::RenderGraphPlan::Barrier& barrier : mPlan.GetPassBarriers(passIndex)) {
+            pCommandBuffer->TransitionImageLayout(GetImage(barrier.image), PPX_ALL_SUBRESOURCES, barrier.beforeState, barrier.afterState);
+        }
+
+        Pass&                        pass           = mPasses[passIndex];
+        const bool                   hasAttachments = (pass.renderTargetCount > 0) || (pass.depthStencil != kInvalidIndex);
+        grfx::RenderGraphPassContext context        = {};
+        context.pCommandBuffer                      = pCommandBuffer;
+        context.pGraph                              = this;
+
+        if (hasAttachments) {
+            Result ppxres = GetDrawPass(pass, &context.pDrawPass);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
+            pCommandBuffer->BeginRenderPass(context.pDrawPass, pass.clearFlags);
+        }
+
+        if (pass.executeFn) {
+            pass.executeFn(context);
+        }
+
+        if (hasAttachments) {
+            pCommandBuffer->EndRenderPass();
+        }
+    }
+
+    for (const grfx::RenderGraphPlan::Barrier& barrier : mPlan.GetFinalBarriers()) {
+        pCommandBuffer->TransitionImageLayout(GetImage(barrier.image), PPX_ALL_SUBRESOURCES, barrier.beforeState, barrier.afterState);
+    }
+
+    return ppx::SUCCESS;
+}
+
+uint32_t RenderGraph::GetCulledPassCount() const
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < mPlan.GetPassCount(); ++i) {
+        count += mPlan.IsPassCulled(i) ? 1 : 0;
+    }
+    return count;
+}
+
+grfx::Image* RenderGraph::GetImage(uint32_t image) const
+{
+    if (image >= CountU32(mImportedImages)) {
+        return nullptr;
+    }
+    if (!IsNull(mImportedImages[image])) {
+        return mImportedImages[image];
+    }
+    grfx::Texture* pTexture = GetTexture(image);
+    return IsNull(pTexture) ? nullptr : pTexture->GetImage().Get();
+}
+
+grfx::Texture* RenderGraph::GetTexture(uint32_t image) const
+{
+    if ((image >= mPlan.GetImageCount()) || mPlan.IsImageImported(image)) {
+        return nullptr;
+    }
+    uint32_t physicalIndex = mPlan.GetPhysicalImageIndex(image);
+    if (physicalIndex >= CountU32(mTextures)) {
+        return nullptr;
+    }
+    return mTextures[physicalIndex];
+}
+
+uint64_t RenderGraph::GetTransientMemorySize() const
+{
+    uint64_t size = 0;
+    for (const grfx::TexturePtr& texture : mTextures) {
+        size += texture->GetImage()->GetMemorySize();
+    }
+    return size;
+}
+
+uint64_t RenderGraph::GetUnaliasedMemorySize() const
+{
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < mPlan.GetImageCount(); ++i) {
+        const grfx::Texture* pTexture = GetTexture(i);
+        if (!IsNull(pTexture)) {
+            size += pTexture->GetImage()->GetMemorySize();
+        }
+    }
+    return size;
+}
+
+} // namespace grfx
+} // namespace ppx
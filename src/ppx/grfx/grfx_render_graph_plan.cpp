@@ -0,0 +1,302 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_render_graph_plan.h"
+
+namespace ppx {
+namespace grfx {
+
+grfx::ResourceState RenderGraphPlan::ToResourceState(grfx::RenderGraphAccess access)
+{
+    // clang-format off
+    switch (access) {
+        default: break;
+        case grfx::RENDER_GRAPH_ACCESS_RENDER_TARGET       : return grfx::RESOURCE_STATE_RENDER_TARGET;
+        case grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE : return grfx::RESOURCE_STATE_DEPTH_STENCIL_WRITE;
+        case grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ  : return grfx::RESOURCE_STATE_DEPTH_STENCIL_READ;
+        case grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE     : return grfx::RESOURCE_STATE_SHADER_RESOURCE;
+        case grfx::RENDER_GRAPH_ACCESS_STORAGE             : return grfx::RESOURCE_STATE_GENERAL;
+        case grfx::RENDER_GRAPH_ACCESS_COPY_SRC            : return grfx::RESOURCE_STATE_COPY_SRC;
+        case grfx::RENDER_GRAPH_ACCESS_COPY_DST            : return grfx::RESOURCE_STATE_COPY_DST;
+    }
+    // clang-format on
+    return grfx::RESOURCE_STATE_UNDEFINED;
+}
+
+bool RenderGraphPlan::IsRead(grfx::RenderGraphAccess access)
+{
+    return (access == grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_SHADER_RESOURCE) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_STORAGE) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_COPY_SRC);
+}
+
+bool RenderGraphPlan::IsWrite(grfx::RenderGraphAccess access)
+{
+    return (access == grfx::RENDER_GRAPH_ACCESS_RENDER_TARGET) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_STORAGE) ||
+           (access == grfx::RENDER_GRAPH_ACCESS_COPY_DST);
+}
+
+uint32_t RenderGraphPlan::AddImage(const grfx::RenderGraphImageInfo& info)
+{
+    Image image = {};
+    image.info  = info;
+    mImages.push_back(image);
+    return CountU32(mImages) - 1;
+}
+
+uint32_t RenderGraphPlan::ImportImage(const grfx::RenderGraphImageInfo& info, grfx::ResourceState initialState, grfx::ResourceState finalState)
+{
+    Image image        = {};
+    image.info         = info;
+    image.imported     = true;
+    image.initialState = initialState;
+    image.finalState   = finalState;
+    mImages.push_back(image);
+    return CountU32(mImages) - 1;
+}
+
+uint32_t RenderGraphPlan::AddPass(bool hasSideEffects)
+{
+    Pass pass           = {};
+    pass.hasSideEffects = hasSideEffects;
+    mPasses.push_back(pass);
+    return CountU32(mPasses) - 1;
+}
+
+Result RenderGraphPlan::AddAccess(uint32_t pass, uint32_t image, grfx::RenderGraphAccess access)
+{
+    if ((pass >= CountU32(mPasses)) || (image >= CountU32(mImages)) || (access >= grfx::RENDER_GRAPH_ACCESS_COUNT)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    std::vector<Access>& accesses = mPasses[pass].accesses;
+    auto                 it       = FindIf(accesses, [image](const Access& elem) -> bool { return elem.image == image; });
+    if (it != std::end(accesses)) {
+        return ppx::ERROR_DUPLICATE_ELEMENT;
+    }
+
+    Access entry = {};
+    entry.image  = image;
+    entry.access = access;
+    accesses.push_back(entry);
+
+    return ppx::SUCCESS;
+}
+
+void RenderGraphPlan::Clear()
+{
+    mPasses.clear();
+    mImages.clear();
+    mPhysicalImages.clear();
+    mExecutionOrder.clear();
+    mFinalBarriers.clear();
+}
+
+void RenderGraphPlan::CullPasses()
+{
+    // Walk backwards from the outputs: a pass is live if something after it
+    // needs one of the images it writes. Writes don't end an image's need,
+    // passes may load what an earlier pass wrote.
+    //
+    std::vector<bool> needed(mImages.size(), false);
+    for (size_t i = 0; i < mImages.size(); ++i) {
+        needed[i] = mImages[i].imported;
+    }
+
+    for (size_t i = mPasses.size(); i > 0; --i) {
+        Pass& pass = mPasses[i - 1];
+
+        bool live = pass.hasSideEffects;
+        for (const Access& access : pass.accesses) {
+            live = live || (IsWrite(access.access) && needed[access.image]);
+        }
+
+        pass.culled = !live;
+        if (!live) {
+            continue;
+        }
+
+        for (const Access& access : pass.accesses) {
+            if (IsRead(access.access)) {
+                needed[access.image] = true;
+            }
+        }
+    }
+
+    mExecutionOrder.clear();
+    for (uint32_t i = 0; i < CountU32(mPasses); ++i) {
+        if (!mPasses[i].culled) {
+            mExecutionOrder.push_back(i);
+        }
+    }
+}
+
+Result RenderGraphPlan::ComputeLifetimes()
+{
+    for (Image& image : mImages) {
+        image.firstUse      = kInvalidIndex;
+        image.lastUse       = kInvalidIndex;
+        image.physicalIndex = kInvalidIndex;
+    }
+
+    std::vector<bool> written(mImages.size(), false);
+    for (uint32_t order = 0; order < CountU32(mExecutionOrder); ++order) {
+        const Pass& pass = mPasses[mExecutionOrder[order]];
+        for (const Access& access : pass.accesses) {
+            Image& image = mImages[access.image];
+
+            // Transient contents are undefined until written, storage access
+            // counts as a write since it's typically used to initialize
+            bool readOnly = IsRead(access.access) && !IsWrite(access.access);
+            if (!image.imported && readOnly && !written[access.image]) {
+                return ppx::ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE;
+            }
+            written[access.image] = written[access.image] || IsWrite(access.access);
+
+            if (image.firstUse == kInvalidIndex) {
+                image.firstUse = order;
+            }
+            image.lastUse = order;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void RenderGraphPlan::AssignPhysicalImages(bool enableAliasing)
+{
+    mPhysicalImages.clear();
+
+    // Transient images in the order they become live
+    std::vector<uint32_t> transients;
+    for (uint32_t i = 0; i < CountU32(mImages); ++i) {
+        if (!mImages[i].imported && (mImages[i].firstUse != kInvalidIndex)) {
+            transients.push_back(i);
+        }
+    }
+    std::stable_sort(
+        transients.begin(),
+        transients.end(),
+        [this](uint32_t a, uint32_t b) -> bool { return mImages[a].firstUse < mImages[b].firstUse; });
+
+    // Reuse the first compatible physical image that's free again, this is
+    // the classic interval graph coloring so it's optimal per info.
+    //
+    for (uint32_t index : transients) {
+        Image& image = mImages[index];
+
+        uint32_t physicalIndex = kInvalidIndex;
+        if (enableAliasing) {
+            for (uint32_t i = 0; i < CountU32(mPhysicalImages); ++i) {
+                const PhysicalImage& physical = mPhysicalImages[i];
+                if ((physical.info == image.info) && (physical.lastUse < image.firstUse)) {
+                    physicalIndex = i;
+                    break;
+                }
+            }
+        }
+        if (physicalIndex == kInvalidIndex) {
+            PhysicalImage physical = {};
+            physical.info          = image.info;
+            mPhysicalImages.push_back(physical);
+            physicalIndex = CountU32(mPhysicalImages) - 1;
+        }
+
+        mPhysicalImages[physicalIndex].lastUse = image.lastUse;
+        image.physicalIndex                    = physicalIndex;
+    }
+}
+
+void RenderGraphPlan::ComputeBarriers()
+{
+    for (Pass& pass : mPasses) {
+        pass.barriers.clear();
+    }
+    mFinalBarriers.clear();
+
+    // Physical images rest in the state of their last access in the frame
+    for (uint32_t passIndex : mExecutionOrder) {
+        for (const Access& access : mPasses[passIndex].accesses) {
+            const Image& image = mImages[access.image];
+            if (image.physicalIndex == kInvalidIndex) {
+                continue;
+            }
+            PhysicalImage& physical = mPhysicalImages[image.physicalIndex];
+            physical.initialState   = ToResourceState(access.access);
+            physical.accessMask |= (1u << access.access);
+        }
+    }
+
+    // Current state of every physical and imported image
+    std::vector<grfx::ResourceState> physicalStates(mPhysicalImages.size());
+    for (size_t i = 0; i < mPhysicalImages.size(); ++i) {
+        physicalStates[i] = mPhysicalImages[i].initialState;
+    }
+    std::vector<grfx::ResourceState> importedStates(mImages.size(), grfx::RESOURCE_STATE_UNDEFINED);
+    for (size_t i = 0; i < mImages.size(); ++i) {
+        importedStates[i] = mImages[i].initialState;
+    }
+
+    for (uint32_t passIndex : mExecutionOrder) {
+        Pass& pass = mPasses[passIndex];
+        for (const Access& access : pass.accesses) {
+            const Image&         image = mImages[access.image];
+            grfx::ResourceState& state = image.imported ? importedStates[access.image] : physicalStates[image.physicalIndex];
+
+            grfx::ResourceState requiredState = ToResourceState(access.access);
+            if (state != requiredState) {
+                Barrier barrier     = {};
+                barrier.image       = access.image;
+                barrier.beforeState = state;
+                barrier.afterState  = requiredState;
+                pass.barriers.push_back(barrier);
+
+                state = requiredState;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < CountU32(mImages); ++i) {
+        const Image& image = mImages[i];
+        if (!image.imported || (image.finalState == grfx::RESOURCE_STATE_UNDEFINED) || (importedStates[i] == image.finalState)) {
+            continue;
+        }
+        Barrier barrier     = {};
+        barrier.image       = i;
+        barrier.beforeState = importedStates[i];
+        barrier.afterState  = image.finalState;
+        mFinalBarriers.push_back(barrier);
+    }
+}
+
+Result RenderGraphPlan::Compile(bool enableAliasing)
+{
+    CullPasses();
+
+    Result ppxres = ComputeLifetimes();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    AssignPhysicalImages(enableAliasing);
+    ComputeBarriers();
+
+    return ppx::SUCCESS;
+}
+
+} // namespace grfx
+} // namespace ppx
@@ -13,9 +13,97 @@
 // limitations under the License.
 
 #include "ppx/grfx/grfx_shader.h"
+#include "ppx/grfx/grfx_device.h"
+
+#include "xxhash.h"
 
 namespace ppx {
 namespace grfx {
 
+// -------------------------------------------------------------------------------------------------
+// ShaderModule
+// -------------------------------------------------------------------------------------------------
+Result ShaderModule::Create(const grfx::ShaderModuleCreateInfo* pCreateInfo)
+{
+    mCodeHash = XXH64(pCreateInfo->pCode, pCreateInfo->size, 0);
+
+    // DXIL can't be reflected, leave the reflection empty so applications
+    // can fall back to hand written layouts.
+    mReflection.reset();
+    if (pCreateInfo->reflect && IsSpirv(pCreateInfo->pCode, pCreateInfo->size)) {
+        Result ppxres = GetCachedShaderReflection(pCreateInfo->pCode, pCreateInfo->size, &mReflection);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    Result ppxres = grfx::DeviceObject<grfx::ShaderModuleCreateInfo>::Create(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Result CreateReflectedPipelineInterface(grfx::Device* pDevice, uint32_t moduleCount, const grfx::ShaderModule* const* ppModules, std::vector<grfx::DescriptorSetLayoutPtr>* pSetLayouts, grfx::PipelineInterface** ppPipelineInterface)
+{
+    PPX_ASSERT_NULL_ARG(pDevice);
+    PPX_ASSERT_NULL_ARG(ppModules);
+    PPX_ASSERT_NULL_ARG(pSetLayouts);
+    PPX_ASSERT_NULL_ARG(ppPipelineInterface);
+
+    std::vector<const grfx::ShaderReflection*> reflections(moduleCount);
+    for (uint32_t i = 0; i < moduleCount; ++i) {
+        reflections[i] = ppModules[i]->GetReflection();
+        if (IsNull(reflections[i])) {
+            PPX_ASSERT_MSG(false, "shader module " << i << " was not reflected, create it from SPIR-V with reflect = true");
+            return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+        }
+    }
+
+    grfx::ShaderInterfaceLayout layout = {};
+    Result                      ppxres = BuildShaderInterfaceLayout(moduleCount, reflections.data(), &layout);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    if (layout.pushConstantSize > 0) {
+        PPX_ASSERT_MSG(false, "push constants are not supported by pipeline interfaces");
+        return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+    }
+    if (layout.setNumbers.size() > PPX_MAX_BOUND_DESCRIPTOR_SETS) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    std::vector<grfx::DescriptorSetLayoutPtr> setLayouts;
+    grfx::PipelineInterfaceCreateInfo         createInfo = {};
+    for (size_t i = 0; i < layout.setNumbers.size(); ++i) {
+        grfx::DescriptorSetLayoutPtr setLayout;
+        ppxres = pDevice->CreateDescriptorSetLayout(&layout.setLayouts[i], &setLayout);
+        if (Failed(ppxres)) {
+            break;
+        }
+        setLayouts.push_back(setLayout);
+
+        createInfo.sets[i].set     = layout.setNumbers[i];
+        createInfo.sets[i].pLayout = setLayout;
+        createInfo.setCount        = CountU32(setLayouts);
+    }
+
+    if (!Failed(ppxres)) {
+        ppxres = pDevice->CreatePipelineInterface(&createInfo, ppPipelineInterface);
+    }
+    if (Failed(ppxres)) {
+        for (grfx::DescriptorSetLayoutPtr& setLayout : setLayouts) {
+            pDevice->DestroyDescriptorSetLayout(setLayout);
+        }
+        return ppxres;
+    }
+
+    *pSetLayouts = std::move(setLayouts);
+    return ppx::SUCCESS;
+}
+
 } // namespace grfx
 } // namespace ppx
@@ -0,0 +1,654 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/grfx/grfx_shader_reflection.h"
+
+#include "xxhash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace ppx {
+namespace grfx {
+
+// -------------------------------------------------------------------------------------------------
+// SPIR-V binary format, see the "Binary Form" section of the SPIR-V
+// specification. Only the enumerants the reflection needs are listed.
+// -------------------------------------------------------------------------------------------------
+namespace spv {
+
+const uint32_t kMagicNumber = 0x07230203;
+const uint32_t kHeaderSize  = 5; // Words
+
+enum Op
+{
+    OpName                      = 5,
+    OpEntryPoint                = 15,
+    OpExecutionMode             = 16,
+    OpTypeInt                   = 21,
+    OpTypeFloat                 = 22,
+    OpTypeVector                = 23,
+    OpTypeMatrix                = 24,
+    OpTypeImage                 = 25,
+    OpTypeSampler               = 26,
+    OpTypeSampledImage          = 27,
+    OpTypeArray                 = 28,
+    OpTypeRuntimeArray          = 29,
+    OpTypeStruct                = 30,
+    OpTypePointer               = 32,
+    OpConstant                  = 43,
+    OpVariable                  = 59,
+    OpDecorate                  = 71,
+    OpMemberDecorate            = 72,
+    OpExecutionModeId           = 331,
+    OpDecorateString            = 5632,
+    OpTypeAccelerationStructure = 5341,
+};
+
+enum ExecutionModel
+{
+    ExecutionModelVertex                 = 0,
+    ExecutionModelTessellationControl    = 1,
+    ExecutionModelTessellationEvaluation = 2,
+    ExecutionModelGeometry               = 3,
+    ExecutionModelFragment               = 4,
+    ExecutionModelGLCompute              = 5,
+};
+
+enum ExecutionMode
+{
+    ExecutionModeLocalSize   = 17,
+    ExecutionModeLocalSizeId = 38,
+};
+
+enum StorageClass
+{
+    StorageClassUniformConstant = 0,
+    StorageClassInput           = 1,
+    StorageClassUniform         = 2,
+    StorageClassPushConstant    = 9,
+    StorageClassStorageBuffer   = 12,
+};
+
+enum Decoration
+{
+    DecorationBufferBlock   = 3,
+    DecorationArrayStride   = 6,
+    DecorationMatrixStride  = 7,
+    DecorationBuiltIn       = 11,
+    DecorationNonWritable   = 24,
+    DecorationLocation      = 30,
+    DecorationBinding       = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset        = 35,
+    DecorationUserSemantic  = 5635,
+};
+
+enum Dim
+{
+    DimBuffer      = 5,
+    DimSubpassData = 6,
+};
+
+} // namespace spv
+
+namespace {
+
+const uint32_t kNone = UINT32_MAX;
+
+struct SpirvMember
+{
+    uint32_t offset       = 0;
+    uint32_t matrixStride = 0;
+    bool     nonWritable  = false;
+};
+
+// Everything the module declares about one id.
+struct SpirvId
+{
+    uint32_t                 opcode      = 0;
+    std::vector<uint32_t>    operands    = {}; // All but the result id
+    std::string              name        = "";
+    std::string              semantic    = "";
+    uint32_t                 set         = kNone;
+    uint32_t                 binding     = kNone;
+    uint32_t                 location    = kNone;
+    uint32_t                 arrayStride = 0;
+    bool                     builtIn     = false;
+    bool                     bufferBlock = false;
+    std::vector<SpirvMember> members     = {};
+};
+
+// Literal strings are nul terminated and padded to a whole number of words.
+std::string ReadString(const uint32_t* pWords, uint32_t wordCount)
+{
+    const char* pChars = reinterpret_cast<const char*>(pWords);
+    return std::string(pChars, strnlen(pChars, 4 * wordCount));
+}
+
+class SpirvParser
+{
+public:
+    Result Parse(const uint32_t* pWords, size_t wordCount, grfx::ShaderReflection* pReflection);
+
+private:
+    Result   ParseInstructions(const uint32_t* pWords, size_t wordCount);
+    Result   GetDescriptorType(uint32_t typeId, uint32_t storageClass, grfx::DescriptorType* pType, uint32_t* pArrayCount) const;
+    uint32_t GetTypeSize(uint32_t typeId, uint32_t matrixStride) const;
+    uint32_t GetConstantValue(uint32_t id) const;
+
+    const SpirvId& GetId(uint32_t id) const
+    {
+        static const SpirvId sEmpty;
+        return (id < mIds.size()) ? mIds[id] : sEmpty;
+    }
+
+private:
+    std::vector<SpirvId>  mIds;
+    uint32_t              mEntryPointId       = kNone;
+    uint32_t              mExecutionModel     = kNone;
+    std::string           mEntryPointName     = "";
+    uint32_t              mWorkgroupSize[3]   = {0, 0, 0};
+    uint32_t              mWorkgroupSizeId[3] = {kNone, kNone, kNone};
+    std::vector<uint32_t> mVariables;
+};
+
+Result SpirvParser::ParseInstructions(const uint32_t* pWords, size_t wordCount)
+{
+    size_t offset = spv::kHeaderSize;
+    while (offset < wordCount) {
+        const uint32_t* pInstruction     = pWords + offset;
+        const uint32_t  instructionWords = pInstruction[0] >> 16;
+        const uint32_t  opcode           = pInstruction[0] & 0xFFFF;
+        if ((instructionWords == 0) || (offset + instructionWords > wordCount)) {
+            PPX_LOG_ERROR("truncated SPIR-V instruction at word " << offset);
+            return ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE;
+        }
+        const uint32_t* pOperands    = pInstruction + 1;
+        const uint32_t  operandCount = instructionWords - 1;
+        offset += instructionWords;
+
+        // Ids are below the bound of the header, but don't trust it
+        auto getId = [this](uint32_t id) -> SpirvId* {
+            return (id < mIds.size()) ? &mIds[id] : nullptr;
+        };
+
+        switch (opcode) {
+            default: break;
+
+            case spv::OpName: {
+                if (SpirvId* pId = (operandCount >= 2) ? getId(pOperands[0]) : nullptr) {
+                    pId->name = ReadString(pOperands + 1, operandCount - 1);
+                }
+            } break;
+
+            case spv::OpEntryPoint: {
+                // The first entry point is the one pipelines use
+                if ((operandCount >= 3) && (mEntryPointId == kNone)) {
+                    mExecutionModel = pOperands[0];
+                    mEntryPointId   = pOperands[1];
+                    mEntryPointName = ReadString(pOperands + 2, operandCount - 2);
+                }
+            } break;
+
+            case spv::OpExecutionMode:
+            case spv::OpExecutionModeId: {
+                if ((operandCount >= 5) && (pOperands[0] == mEntryPointId)) {
+                    if ((pOperands[1] == spv::ExecutionModeLocalSize) && (opcode == spv::OpExecutionMode)) {
+                        std::copy(pOperands + 2, pOperands + 5, mWorkgroupSize);
+                    }
+                    else if (pOperands[1] == spv::ExecutionModeLocalSizeId) {
+                        std::copy(pOperands + 2, pOperands + 5, mWorkgroupSizeId);
+                    }
+                }
+            } break;
+
+            case spv::OpDecorate: {
+                SpirvId* pId = (operandCount >= 2) ? getId(pOperands[0]) : nullptr;
+                if (pId == nullptr) {
+                    break;
+                }
+                const uint32_t value = (operandCount >= 3) ? pOperands[2] : 0;
+                switch (pOperands[1]) {
+                    default: break;
+                    case spv::DecorationBufferBlock: pId->bufferBlock = true; break;
+                    case spv::DecorationArrayStride: pId->arrayStride = value; break;
+                    case spv::DecorationBuiltIn: pId->builtIn = true; break;
+                    case spv::DecorationLocation: pId->location = value; break;
+                    case spv::DecorationBinding: pId->binding = value; break;
+                    case spv::DecorationDescriptorSet: pId->set = value; break;
+                }
+            } break;
+
+            case spv::OpDecorateString: {
+                SpirvId* pId = (operandCount >= 3) ? getId(pOperands[0]) : nullptr;
+                if ((pId != nullptr) && (pOperands[1] == spv::DecorationUserSemantic)) {
+                    pId->semantic = ReadString(pOperands + 2, operandCount - 2);
+                }
+            } break;
+
+            case spv::OpMemberDecorate: {
+                SpirvId* pId = (operandCount >= 3) ? getId(pOperands[0]) : nullptr;
+                if (pId == nullptr) {
+                    break;
+                }
+                const uint32_t member = pOperands[1];
+                if (member >= pId->members.size()) {
+                    pId->members.resize(member + 1);
+                }
+                const uint32_t value = (operandCount >= 4) ? pOperands[3] : 0;
+                switch (pOperands[2]) {
+                    default: break;
+                    case spv::DecorationOffset: pId->members[member].offset = value; break;
+                    case spv::DecorationMatrixStride: pId->members[member].matrixStride = value; break;
+                    case spv::DecorationNonWritable: pId->members[member].nonWritable = true; break;
+                }
+            } break;
+
+            // Types: result id first
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+            case spv::OpTypeVector:
+            case spv::OpTypeMatrix:
+            case spv::OpTypeImage:
+            case spv::OpTypeSampler:
+            case spv::OpTypeSampledImage:
+            case spv::OpTypeArray:
+            case spv::OpTypeRuntimeArray:
+            case spv::OpTypeStruct:
+            case spv::OpTypePointer:
+            case spv::OpTypeAccelerationStructure: {
+                if (SpirvId* pId = (operandCount >= 1) ? getId(pOperands[0]) : nullptr) {
+                    pId->opcode = opcode;
+                    pId->operands.assign(pOperands + 1, pOperands + operandCount);
+                }
+            } break;
+
+            // Constants and variables: result type, then result id
+            case spv::OpConstant:
+            case spv::OpVariable: {
+                if (SpirvId* pId = (operandCount >= 2) ? getId(pOperands[1]) : nullptr) {
+                    pId->opcode = opcode;
+                    pId->operands.assign(pOperands, pOperands + operandCount);
+                    pId->operands.erase(pId->operands.begin() + 1);
+                    if (opcode == spv::OpVariable) {
+                        mVariables.push_back(pOperands[1]);
+                    }
+                }
+            } break;
+        }
+    }
+    return ppx::SUCCESS;
+}
+
+uint32_t SpirvParser::GetConstantValue(uint32_t id) const
+{
+    const SpirvId& constant = GetId(id);
+    if ((constant.opcode != spv::OpConstant) || (constant.operands.size() < 2)) {
+        return 0;
+    }
+    // Operands: result type, value (low word first)
+    return constant.operands[1];
+}
+
+uint32_t SpirvParser::GetTypeSize(uint32_t typeId, uint32_t matrixStride) const
+{
+    const SpirvId& type = GetId(typeId);
+    switch (type.opcode) {
+        default: break;
+
+        case spv::OpTypeInt:
+        case spv::OpTypeFloat: {
+            return type.operands[0] / 8;
+        }
+
+        case spv::OpTypeVector: {
+            return type.operands[1] * GetTypeSize(type.operands[0], 0);
+        }
+
+        case spv::OpTypeMatrix: {
+            // Column major, matrixStride bytes per column
+            const uint32_t columnSize = (matrixStride > 0) ? matrixStride : GetTypeSize(type.operands[0], 0);
+            return type.operands[1] * columnSize;
+        }
+
+        case spv::OpTypeArray: {
+            const uint32_t stride = (type.arrayStride > 0) ? type.arrayStride : GetTypeSize(type.operands[0], matrixStride);
+            return GetConstantValue(type.operands[1]) * stride;
+        }
+
+        case spv::OpTypeStruct: {
+            uint32_t size = 0;
+            for (size_t i = 0; i < type.operands.size(); ++i) {
+                const SpirvMember member = (i < type.members.size()) ? type.members[i] : SpirvMember();
+                size                     = std::max(size, member.offset + GetTypeSize(type.operands[i], member.matrixStride));
+            }
+            return size;
+        }
+    }
+    return 0;
+}
+
+Result SpirvParser::GetDescriptorType(uint32_t typeId, uint32_t storageClass, grfx::DescriptorType* pType, uint32_t* pArrayCount) const
+{
+    *pArrayCount = 1;
+
+    // Arrays of resources
+    const SpirvId* pElementType = &GetId(typeId);
+    while (pElementType->opcode == spv::OpTypeArray) {
+        *pArrayCount *= GetConstantValue(pElementType->operands[1]);
+        pElementType = &GetId(pElementType->operands[0]);
+    }
+    const SpirvId& type = *pElementType;
+
+    switch (type.opcode) {
+        default: break;
+
+        case spv::OpTypeSampler: {
+            *pType = grfx::DESCRIPTOR_TYPE_SAMPLER;
+            return ppx::SUCCESS;
+        }
+
+        case spv::OpTypeSampledImage: {
+            *pType = grfx::DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            return ppx::SUCCESS;
+        }
+
+        case spv::OpTypeImage: {
+            // Operands: sampled type, dim, depth, arrayed, MS, sampled, format
+            const uint32_t dim     = type.operands[1];
+            const bool     storage = (type.operands[5] == 2);
+            if (dim == spv::DimSubpassData) {
+                *pType = grfx::DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            }
+            else if (dim == spv::DimBuffer) {
+                *pType = storage ? grfx::DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : grfx::DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            }
+            else {
+                *pType = storage ? grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE : grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            return ppx::SUCCESS;
+        }
+
+        case spv::OpTypeStruct: {
+            // Uniform + Block is a constant buffer, Uniform + BufferBlock
+            // (SPIR-V 1.0 - 1.3) or StorageBuffer is a storage buffer
+            const bool storageBuffer = (storageClass == spv::StorageClassStorageBuffer) || type.bufferBlock;
+            if (!storageBuffer) {
+                *pType = grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                return ppx::SUCCESS;
+            }
+            // DXC names the types of byte address buffers after the HLSL type
+            if ((type.name.rfind("type.ByteAddressBuffer", 0) == 0) || (type.name.rfind("type.RWByteAddressBuffer", 0) == 0)) {
+                *pType = grfx::DESCRIPTOR_TYPE_RAW_STORAGE_BUFFER;
+                return ppx::SUCCESS;
+            }
+            const bool readOnly = !type.members.empty() && std::all_of(type.members.begin(), type.members.end(), [](const SpirvMember& member) { return member.nonWritable; });
+            *pType              = readOnly ? grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER : grfx::DESCRIPTOR_TYPE_RW_STRUCTURED_BUFFER;
+            return ppx::SUCCESS;
+        }
+    }
+    return ppx::ERROR_GRFX_UNKNOWN_DESCRIPTOR_TYPE;
+}
+
+grfx::ShaderStageBits ToShaderStage(uint32_t executionModel)
+{
+    // clang-format off
+    switch (executionModel) {
+        default: break;
+        case spv::ExecutionModelVertex                 : return grfx::SHADER_STAGE_VS;
+        case spv::ExecutionModelTessellationControl    : return grfx::SHADER_STAGE_HS;
+        case spv::ExecutionModelTessellationEvaluation : return grfx::SHADER_STAGE_DS;
+        case spv::ExecutionModelGeometry               : return grfx::SHADER_STAGE_GS;
+        case spv::ExecutionModelFragment               : return grfx::SHADER_STAGE_PS;
+        case spv::ExecutionModelGLCompute              : return grfx::SHADER_STAGE_CS;
+    }
+    // clang-format on
+    return grfx::SHADER_STAGE_UNDEFINED;
+}
+
+grfx::Format ToVertexFormat(uint32_t componentOpcode, uint32_t componentWidth, bool componentSigned, uint32_t componentCount)
+{
+    if ((componentWidth != 32) || (componentCount < 1) || (componentCount > 4)) {
+        return grfx::FORMAT_UNDEFINED;
+    }
+
+    // clang-format off
+    const grfx::Format kFloatFormats[] = {grfx::FORMAT_R32_FLOAT, grfx::FORMAT_R32G32_FLOAT, grfx::FORMAT_R32G32B32_FLOAT, grfx::FORMAT_R32G32B32A32_FLOAT};
+    const grfx::Format kSintFormats[]  = {grfx::FORMAT_R32_SINT,  grfx::FORMAT_R32G32_SINT,  grfx::FORMAT_R32G32B32_SINT,  grfx::FORMAT_R32G32B32A32_SINT};
+    const grfx::Format kUintFormats[]  = {grfx::FORMAT_R32_UINT,  grfx::FORMAT_R32G32_UINT,  grfx::FORMAT_R32G32B32_UINT,  grfx::FORMAT_R32G32B32A32_UINT};
+    // clang-format on
+
+    if (componentOpcode == spv::OpTypeFloat) {
+        return kFloatFormats[componentCount - 1];
+    }
+    return componentSigned ? kSintFormats[componentCount - 1] : kUintFormats[componentCount - 1];
+}
+
+Result SpirvParser::Parse(const uint32_t* pWords, size_t wordCount, grfx::ShaderReflection* pReflection)
+{
+    const uint32_t bound = pWords[3];
+    mIds.resize(std::min<size_t>(bound, wordCount));
+
+    Result ppxres = ParseInstructions(pWords, wordCount);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    *pReflection            = {};
+    pReflection->stage      = ToShaderStage(mExecutionModel);
+    pReflection->entryPoint = mEntryPointName;
+
+    if (pReflection->stage == grfx::SHADER_STAGE_CS) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            pReflection->workgroupSize[i] = (mWorkgroupSizeId[i] != kNone) ? GetConstantValue(mWorkgroupSizeId[i]) : mWorkgroupSize[i];
+        }
+    }
+
+    for (uint32_t variableId : mVariables) {
+        const SpirvId& variable = GetId(variableId);
+        const SpirvId& pointer  = GetId(variable.operands[0]);
+        if ((pointer.opcode != spv::OpTypePointer) || (pointer.operands.size() < 2)) {
+            continue;
+        }
+        const uint32_t storageClass = variable.operands[1];
+        const uint32_t typeId       = pointer.operands[1];
+
+        switch (storageClass) {
+            default: break;
+
+            case spv::StorageClassUniformConstant:
+            case spv::StorageClassUniform:
+            case spv::StorageClassStorageBuffer: {
+                if (variable.binding == kNone) {
+                    break;
+                }
+                grfx::ReflectedBinding binding = {};
+                binding.name                   = variable.name;
+                binding.set                    = (variable.set != kNone) ? variable.set : 0;
+                binding.binding                = variable.binding;
+                binding.stage                  = pReflection->stage;
+
+                ppxres = GetDescriptorType(typeId, storageClass, &binding.type, &binding.arrayCount);
+                if (Failed(ppxres)) {
+                    PPX_LOG_ERROR("unsupported resource type for variable '" << variable.name << "' at set " << binding.set << " binding " << binding.binding);
+                    return ppxres;
+                }
+                pReflection->bindings.push_back(binding);
+            } break;
+
+            case spv::StorageClassPushConstant: {
+                pReflection->pushConstantSize = std::max(pReflection->pushConstantSize, GetTypeSize(typeId, 0));
+            } break;
+
+            case spv::StorageClassInput: {
+                if ((pReflection->stage != grfx::SHADER_STAGE_VS) || variable.builtIn || (variable.location == kNone)) {
+                    break;
+                }
+                const SpirvId* pType          = &GetId(typeId);
+                uint32_t       componentCount = 1;
+                if (pType->opcode == spv::OpTypeVector) {
+                    componentCount = pType->operands[1];
+                    pType          = &GetId(pType->operands[0]);
+                }
+                if ((pType->opcode != spv::OpTypeInt) && (pType->opcode != spv::OpTypeFloat)) {
+                    break;
+                }
+                const bool componentSigned = (pType->opcode == spv::OpTypeInt) && (pType->operands[1] != 0);
+
+                grfx::VertexAttribute attribute = {};
+                attribute.semanticName          = variable.semantic;
+                attribute.location              = variable.location;
+                attribute.format                = ToVertexFormat(pType->opcode, pType->operands[0], componentSigned, componentCount);
+                // DXC names stage inputs in.var.<SEMANTIC>
+                if (attribute.semanticName.empty() && (variable.name.rfind("in.var.", 0) == 0)) {
+                    attribute.semanticName = variable.name.substr(7);
+                }
+                pReflection->vertexInputs.push_back(attribute);
+            } break;
+        }
+    }
+
+    std::sort(
+        pReflection->bindings.begin(),
+        pReflection->bindings.end(),
+        [](const grfx::ReflectedBinding& a, const grfx::ReflectedBinding& b) {
+            return (a.set != b.set) ? (a.set < b.set) : (a.binding < b.binding);
+        });
+    std::sort(
+        pReflection->vertexInputs.begin(),
+        pReflection->vertexInputs.end(),
+        [](const grfx::VertexAttribute& a, const grfx::VertexAttribute& b) {
+            return a.location < b.location;
+        });
+
+    return ppx::SUCCESS;
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------------------------------
+
+bool IsSpirv(const void* pCode, size_t size)
+{
+    if ((pCode == nullptr) || (size < 4 * spv::kHeaderSize) || ((size % 4) != 0)) {
+        return false;
+    }
+    uint32_t magic = 0;
+    std::memcpy(&magic, pCode, sizeof(magic));
+    return magic == spv::kMagicNumber;
+}
+
+Result ReflectSpirv(const void* pCode, size_t size, grfx::ShaderReflection* pReflection)
+{
+    PPX_ASSERT_NULL_ARG(pReflection);
+    if (!IsSpirv(pCode, size)) {
+        return ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE;
+    }
+
+    // Shader code comes from char buffers, copy it for aligned access
+    std::vector<uint32_t> words(size / 4);
+    std::memcpy(words.data(), pCode, size);
+
+    SpirvParser parser;
+    return parser.Parse(words.data(), words.size(), pReflection);
+}
+
+Result GetCachedShaderReflection(const void* pCode, size_t size, std::shared_ptr<const grfx::ShaderReflection>* pReflection)
+{
+    PPX_ASSERT_NULL_ARG(pReflection);
+    if (!IsSpirv(pCode, size)) {
+        return ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE;
+    }
+
+    static std::mutex                                                                 sMutex;
+    static std::unordered_map<uint64_t, std::shared_ptr<const grfx::ShaderReflection>> sCache;
+
+    const uint64_t hash = XXH64(pCode, size, 0);
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto                        it = sCache.find(hash);
+        if (it != sCache.end()) {
+            *pReflection = it->second;
+            return ppx::SUCCESS;
+        }
+    }
+
+    // Parse outside of the lock, two threads reflecting the same new module
+    // both parse it and the first one is kept.
+    auto   reflection = std::make_shared<grfx::ShaderReflection>();
+    Result ppxres     = ReflectSpirv(pCode, size, reflection.get());
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    *pReflection = sCache.emplace(hash, std::move(reflection)).first->second;
+    return ppx::SUCCESS;
+}
+
+Result BuildShaderInterfaceLayout(uint32_t reflectionCount, const grfx::ShaderReflection* const* ppReflections, grfx::ShaderInterfaceLayout* pLayout)
+{
+    PPX_ASSERT_NULL_ARG(pLayout);
+    *pLayout = {};
+
+    std::vector<grfx::ReflectedBinding> bindings;
+    for (uint32_t i = 0; i < reflectionCount; ++i) {
+        const grfx::ShaderReflection* pReflection = ppReflections[i];
+        if (IsNull(pReflection)) {
+            return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+        }
+        bindings.insert(bindings.end(), pReflection->bindings.begin(), pReflection->bindings.end());
+        pLayout->pushConstantSize = std::max(pLayout->pushConstantSize, pReflection->pushConstantSize);
+    }
+
+    std::stable_sort(
+        bindings.begin(),
+        bindings.end(),
+        [](const grfx::ReflectedBinding& a, const grfx::ReflectedBinding& b) {
+            return (a.set != b.set) ? (a.set < b.set) : (a.binding < b.binding);
+        });
+
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        const grfx::ReflectedBinding& binding = bindings[i];
+        const grfx::ShaderStageBits   stage   = (binding.stage != grfx::SHADER_STAGE_UNDEFINED) ? binding.stage : grfx::SHADER_STAGE_ALL;
+
+        // Same resource in another stage
+        if ((i > 0) && (bindings[i - 1].set == binding.set) && (bindings[i - 1].binding == binding.binding)) {
+            const grfx::ReflectedBinding& previous = bindings[i - 1];
+            if ((previous.type != binding.type) || (previous.arrayCount != binding.arrayCount)) {
+                PPX_LOG_ERROR("stages disagree on the type of set " << binding.set << " binding " << binding.binding << " ('" << previous.name << "' and '" << binding.name << "')");
+                return ppx::ERROR_GRFX_INVALID_DESCRIPTOR_TYPE;
+            }
+            grfx::DescriptorBinding& merged = pLayout->setLayouts.back().bindings.back();
+            if (merged.shaderVisiblity != stage) {
+                merged.shaderVisiblity = grfx::SHADER_STAGE_ALL;
+            }
+            continue;
+        }
+
+        if (pLayout->setNumbers.empty() || (pLayout->setNumbers.back() != binding.set)) {
+            pLayout->setNumbers.push_back(binding.set);
+            pLayout->setLayouts.emplace_back();
+        }
+        pLayout->setLayouts.back().bindings.push_back(grfx::DescriptorBinding(binding.binding, binding.type, binding.arrayCount, stage));
+    }
+
+    return ppx::SUCCESS;
+}
+
+} // namespace grfx
+} // namespace ppx
@@ -16,6 +16,7 @@
 #include "ppx/grfx/grfx_device.h"
 #include "ppx/grfx/grfx_render_pass.h"
 #include "ppx/grfx/grfx_instance.h"
+#include "ppx/grfx/grfx_queue.h"
 
 namespace ppx {
 namespace grfx {
@@ -89,66 +90,20 @@ Result Swapchain::Create(const grfx::SwapchainCreateInfo* pCreateInfo)
         }
     }
 
-    // Create render passes with grfx::ATTACHMENT_LOAD_OP_CLEAR for render target.
-    for (size_t i = 0; i < mCreateInfo.imageCount; ++i) {
-        grfx::RenderPassCreateInfo3 rpCreateInfo = {};
-        rpCreateInfo.width                       = pCreateInfo->width;
-        rpCreateInfo.height                      = pCreateInfo->height;
-        rpCreateInfo.renderTargetCount           = 1;
-        rpCreateInfo.pRenderTargetImages[0]      = mColorImages[i];
-        rpCreateInfo.pDepthStencilImage          = mDepthImages.empty() ? nullptr : mDepthImages[i];
-        rpCreateInfo.renderTargetClearValues[0]  = {{0.0f, 0.0f, 0.0f, 0.0f}};
-        rpCreateInfo.depthStencilClearValue      = {1.0f, 0xFF};
-        rpCreateInfo.renderTargetLoadOps[0]      = grfx::ATTACHMENT_LOAD_OP_CLEAR;
-        rpCreateInfo.depthLoadOp                 = grfx::ATTACHMENT_LOAD_OP_CLEAR;
-        rpCreateInfo.ownership                   = grfx::OWNERSHIP_RESTRICTED;
-
-        grfx::RenderPassPtr renderPass;
-        ppxres = GetDevice()->CreateRenderPass(&rpCreateInfo, &renderPass);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "grfx::Swapchain::CreateRenderPass(CLEAR) failed");
-            return ppxres;
-        }
-
-        mClearRenderPasses.push_back(renderPass);
-    }
-
-    // Create render passes with grfx::ATTACHMENT_LOAD_OP_LOAD for render target.
-    for (size_t i = 0; i < mCreateInfo.imageCount; ++i) {
-        grfx::RenderPassCreateInfo3 rpCreateInfo = {};
-        rpCreateInfo.width                       = pCreateInfo->width;
-        rpCreateInfo.height                      = pCreateInfo->height;
-        rpCreateInfo.renderTargetCount           = 1;
-        rpCreateInfo.pRenderTargetImages[0]      = mColorImages[i];
-        rpCreateInfo.pDepthStencilImage          = mDepthImages.empty() ? nullptr : mDepthImages[i];
-        rpCreateInfo.renderTargetClearValues[0]  = {{0.0f, 0.0f, 0.0f, 0.0f}};
-        rpCreateInfo.depthStencilClearValue      = {1.0f, 0xFF};
-        rpCreateInfo.renderTargetLoadOps[0]      = grfx::ATTACHMENT_LOAD_OP_LOAD;
-        rpCreateInfo.depthLoadOp                 = grfx::ATTACHMENT_LOAD_OP_CLEAR;
-        rpCreateInfo.ownership                   = grfx::OWNERSHIP_RESTRICTED;
-
-        grfx::RenderPassPtr renderPass;
-        ppxres = GetDevice()->CreateRenderPass(&rpCreateInfo, &renderPass);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "grfx::Swapchain::CreateRenderPass(LOAD) failed");
-            return ppxres;
-        }
-
-        mLoadRenderPasses.push_back(renderPass);
-    }
+    // Views for CommandBuffer::BeginRendering() and render passes are only
+    // created when they're first asked for, so applications don't create
+    // objects for a path they don't use each time the swapchain is
+    // recreated.
+    mClearRenderTargetViews.resize(mCreateInfo.imageCount);
+    mLoadRenderTargetViews.resize(mCreateInfo.imageCount);
+    mDepthStencilViews.resize(mDepthImages.size());
+    mClearRenderPasses.resize(mCreateInfo.imageCount);
+    mLoadRenderPasses.resize(mCreateInfo.imageCount);
 
     if (IsHeadless()) {
         // Set currentImageIndex to (imageCount - 1) so that the first
         // AcquireNextImage call acquires the first image at index 0.
         currentImageIndex = mCreateInfo.imageCount - 1;
-
-        // Create command buffers to signal and wait semaphores at
-        // AcquireNextImage and Present calls.
-        for (uint32_t i = 0; i < mCreateInfo.imageCount; ++i) {
-            grfx::CommandBufferPtr commandBuffer = nullptr;
-            mCreateInfo.pQueue->CreateCommandBuffer(&commandBuffer, 0, 0);
-            mHeadlessCommandBuffers.push_back(commandBuffer);
-        }
     }
 
     PPX_LOG_INFO("Swapchain created");
@@ -176,6 +131,27 @@ void Swapchain::Destroy()
     }
     mLoadRenderPasses.clear();
 
+    for (auto& elem : mClearRenderTargetViews) {
+        if (elem) {
+            GetDevice()->DestroyRenderTargetView(elem);
+        }
+    }
+    mClearRenderTargetViews.clear();
+
+    for (auto& elem : mLoadRenderTargetViews) {
+        if (elem) {
+            GetDevice()->DestroyRenderTargetView(elem);
+        }
+    }
+    mLoadRenderTargetViews.clear();
+
+    for (auto& elem : mDepthStencilViews) {
+        if (elem) {
+            GetDevice()->DestroyDepthStencilView(elem);
+        }
+    }
+    mDepthStencilViews.clear();
+
     for (auto& elem : mDepthImages) {
         if (elem) {
             GetDevice()->DestroyImage(elem);
@@ -199,12 +175,7 @@ void Swapchain::Destroy()
     }
 #endif
 
-    for (auto& elem : mHeadlessCommandBuffers) {
-        if (elem) {
-            mCreateInfo.pQueue->DestroyCommandBuffer(elem);
-        }
-    }
-    mHeadlessCommandBuffers.clear();
+    DestroyHeadlessReadbackObjects();
 
     grfx::DeviceObject<grfx::SwapchainCreateInfo>::Destroy();
 }
@@ -241,12 +212,76 @@ Result Swapchain::GetRenderPass(uint32_t imageIndex, grfx::AttachmentLoadOp load
     if (!IsIndexInRange(imageIndex, mClearRenderPasses)) {
         return ppx::ERROR_OUT_OF_RANGE;
     }
-    if (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) {
-        *ppRenderPass = mClearRenderPasses[imageIndex];
+
+    grfx::RenderPassPtr& renderPass = (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) ? mClearRenderPasses[imageIndex] : mLoadRenderPasses[imageIndex];
+    if (!renderPass) {
+        grfx::RenderPassCreateInfo3 rpCreateInfo = {};
+        rpCreateInfo.width                       = mCreateInfo.width;
+        rpCreateInfo.height                      = mCreateInfo.height;
+        rpCreateInfo.renderTargetCount           = 1;
+        rpCreateInfo.pRenderTargetImages[0]      = mColorImages[imageIndex];
+        rpCreateInfo.pDepthStencilImage          = mDepthImages.empty() ? nullptr : mDepthImages[imageIndex];
+        rpCreateInfo.renderTargetClearValues[0]  = {{0.0f, 0.0f, 0.0f, 0.0f}};
+        rpCreateInfo.depthStencilClearValue      = {1.0f, 0xFF};
+        rpCreateInfo.renderTargetLoadOps[0]      = (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) ? grfx::ATTACHMENT_LOAD_OP_CLEAR : grfx::ATTACHMENT_LOAD_OP_LOAD;
+        rpCreateInfo.depthLoadOp                 = grfx::ATTACHMENT_LOAD_OP_CLEAR;
+        rpCreateInfo.ownership                   = grfx::OWNERSHIP_RESTRICTED;
+
+        Result ppxres = GetDevice()->CreateRenderPass(&rpCreateInfo, &renderPass);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "grfx::Swapchain::CreateRenderPass failed");
+            return ppxres;
+        }
+    }
+
+    *ppRenderPass = renderPass;
+    return ppx::SUCCESS;
+}
+
+Result Swapchain::GetRenderTargetView(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp, grfx::RenderTargetView** ppView) const
+{
+    if (!IsIndexInRange(imageIndex, mClearRenderTargetViews)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    grfx::RenderTargetViewPtr& view = (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) ? mClearRenderTargetViews[imageIndex] : mLoadRenderTargetViews[imageIndex];
+    if (!view) {
+        grfx::RenderTargetViewCreateInfo rtvCreateInfo = grfx::RenderTargetViewCreateInfo::GuessFromImage(mColorImages[imageIndex]);
+        rtvCreateInfo.loadOp                           = (loadOp == grfx::ATTACHMENT_LOAD_OP_CLEAR) ? grfx::ATTACHMENT_LOAD_OP_CLEAR : grfx::ATTACHMENT_LOAD_OP_LOAD;
+        rtvCreateInfo.ownership                        = grfx::OWNERSHIP_RESTRICTED;
+
+        Result ppxres = GetDevice()->CreateRenderTargetView(&rtvCreateInfo, &view);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "grfx::Swapchain::CreateRenderTargetView failed");
+            return ppxres;
+        }
+    }
+
+    *ppView = view;
+    return ppx::SUCCESS;
+}
+
+Result Swapchain::GetDepthStencilView(uint32_t imageIndex, grfx::DepthStencilView** ppView) const
+{
+    if (!IsIndexInRange(imageIndex, mDepthStencilViews)) {
+        return ppx::ERROR_OUT_OF_RANGE;
     }
-    else {
-        *ppRenderPass = mLoadRenderPasses[imageIndex];
+
+    grfx::DepthStencilViewPtr& view = mDepthStencilViews[imageIndex];
+    if (!view) {
+        grfx::DepthStencilViewCreateInfo dsvCreateInfo = grfx::DepthStencilViewCreateInfo::GuessFromImage(mDepthImages[imageIndex]);
+        dsvCreateInfo.depthLoadOp                      = grfx::ATTACHMENT_LOAD_OP_CLEAR;
+        dsvCreateInfo.stencilLoadOp                    = grfx::ATTACHMENT_LOAD_OP_CLEAR;
+        dsvCreateInfo.ownership                        = grfx::OWNERSHIP_RESTRICTED;
+
+        Result ppxres = GetDevice()->CreateDepthStencilView(&dsvCreateInfo, &view);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "grfx::Swapchain::CreateDepthStencilView failed");
+            return ppxres;
+        }
     }
+
+    *ppView = view;
     return ppx::SUCCESS;
 }
 
@@ -271,6 +306,20 @@ grfx::RenderPassPtr Swapchain::GetRenderPass(uint32_t imageIndex, grfx::Attachme
     return object;
 }
 
+grfx::RenderTargetViewPtr Swapchain::GetRenderTargetView(uint32_t imageIndex, grfx::AttachmentLoadOp loadOp) const
+{
+    grfx::RenderTargetViewPtr object;
+    GetRenderTargetView(imageIndex, loadOp, &object);
+    return object;
+}
+
+grfx::DepthStencilViewPtr Swapchain::GetDepthStencilView(uint32_t imageIndex) const
+{
+    grfx::DepthStencilViewPtr object;
+    GetDepthStencilView(imageIndex, &object);
+    return object;
+}
+
 Result Swapchain::AcquireNextImage(
     uint64_t         timeout,    // Nanoseconds
     grfx::Semaphore* pSemaphore, // Wait sempahore
@@ -328,38 +377,240 @@ Result Swapchain::AcquireNextImageHeadless(uint64_t timeout, grfx::Semaphore* pS
     *pImageIndex      = (currentImageIndex + 1u) % CountU32(mColorImages);
     currentImageIndex = *pImageIndex;
 
-    grfx::CommandBufferPtr commandBuffer = mHeadlessCommandBuffers[currentImageIndex];
-
-    commandBuffer->Begin();
-    commandBuffer->End();
+    if (IsNull(pSemaphore) && IsNull(pFence)) {
+        return ppx::SUCCESS;
+    }
 
+    // The image is available right away, signal without any commands
     grfx::SubmitInfo sInfo     = {};
-    sInfo.ppCommandBuffers     = &commandBuffer;
-    sInfo.commandBufferCount   = 1;
     sInfo.pFence               = pFence;
     sInfo.ppSignalSemaphores   = &pSemaphore;
-    sInfo.signalSemaphoreCount = 1;
-    mCreateInfo.pQueue->Submit(&sInfo);
+    sInfo.signalSemaphoreCount = IsNull(pSemaphore) ? 0 : 1;
 
-    return ppx::SUCCESS;
+    return mCreateInfo.pQueue->Submit(&sInfo);
 }
 
 Result Swapchain::PresentHeadless(uint32_t imageIndex, uint32_t waitSemaphoreCount, const grfx::Semaphore* const* ppWaitSemaphores)
 {
-    grfx::CommandBufferPtr commandBuffer = mHeadlessCommandBuffers[currentImageIndex];
-
-    commandBuffer->Begin();
-    commandBuffer->End();
+    ++mHeadlessPresentCount;
 
+    // The wait semaphores still need to be waited on, otherwise they would
+    // stay signaled.
     grfx::SubmitInfo sInfo   = {};
-    sInfo.ppCommandBuffers   = &commandBuffer;
-    sInfo.commandBufferCount = 1;
     sInfo.ppWaitSemaphores   = ppWaitSemaphores;
     sInfo.waitSemaphoreCount = waitSemaphoreCount;
-    mCreateInfo.pQueue->Submit(&sInfo);
+
+    if (!mHeadlessReadbackCallback) {
+        if (waitSemaphoreCount == 0) {
+            return ppx::SUCCESS;
+        }
+        return mCreateInfo.pQueue->Submit(&sInfo);
+    }
+
+    if (!IsIndexInRange(imageIndex, mHeadlessReadbackSlots)) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+
+    DeliverHeadlessReadbacks();
+
+    // The buffer of this image is still being copied to. This only happens
+    // if more frames are in flight than there are images.
+    HeadlessReadbackSlot& slot = mHeadlessReadbackSlots[imageIndex];
+    if (slot.presentId != 0) {
+        Result ppxres = mHeadlessReadbackSemaphore->Wait(slot.presentId);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        DeliverHeadlessReadbacks();
+    }
+
+    grfx::Image*         pImage         = mColorImages[imageIndex];
+    grfx::CommandBuffer* pCommandBuffer = slot.commandBuffer;
+
+    Result ppxres = pCommandBuffer->Begin();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    pCommandBuffer->TransitionImageLayout(pImage, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_PRESENT, grfx::RESOURCE_STATE_COPY_SRC);
+
+    grfx::ImageToBufferCopyInfo copyInfo = {};
+    copyInfo.extent                      = {pImage->GetWidth(), pImage->GetHeight(), 0};
+
+    grfx::ImageToBufferOutputPitch outPitch = pCommandBuffer->CopyImageToBuffer(&copyInfo, pImage, slot.buffer);
+
+    pCommandBuffer->TransitionImageLayout(pImage, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_COPY_SRC, grfx::RESOURCE_STATE_PRESENT);
+
+    ppxres = pCommandBuffer->End();
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    grfx::Semaphore* pSignalSemaphore = mHeadlessReadbackSemaphore;
+    const uint64_t   signalValue      = mHeadlessPresentCount;
+
+    sInfo.commandBufferCount   = 1;
+    sInfo.ppCommandBuffers     = &pCommandBuffer;
+    sInfo.signalSemaphoreCount = 1;
+    sInfo.ppSignalSemaphores   = &pSignalSemaphore;
+    sInfo.pSignalValues        = &signalValue;
+
+    ppxres = mCreateInfo.pQueue->Submit(&sInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    slot.presentId = signalValue;
+    slot.rowPitch  = outPitch.rowPitch;
 
     return ppx::SUCCESS;
 }
 
+Result Swapchain::SetHeadlessReadbackCallback(grfx::HeadlessReadbackCallback callback)
+{
+    if (!IsHeadless()) {
+        return ppx::ERROR_FAILED;
+    }
+
+    if (!callback) {
+        DestroyHeadlessReadbackObjects();
+        mHeadlessReadbackCallback = nullptr;
+        return ppx::SUCCESS;
+    }
+
+    if (!GetDevice()->TimelineSemaphoreSupported()) {
+        return ppx::ERROR_REQUIRED_FEATURE_UNAVAILABLE;
+    }
+
+    if (mHeadlessReadbackSlots.empty()) {
+        Result ppxres = CreateHeadlessReadbackObjects();
+        if (Failed(ppxres)) {
+            DestroyHeadlessReadbackObjects();
+            return ppxres;
+        }
+    }
+
+    mHeadlessReadbackCallback = callback;
+
+    return ppx::SUCCESS;
+}
+
+Result Swapchain::CreateHeadlessReadbackObjects()
+{
+    grfx::SemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.semaphoreType             = grfx::SEMAPHORE_TYPE_TIMELINE;
+    semaphoreCreateInfo.initialValue              = mHeadlessPresentCount;
+
+    Result ppxres = GetDevice()->CreateSemaphore(&semaphoreCreateInfo, &mHeadlessReadbackSemaphore);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    // Rows are padded to 256 bytes on D3D12
+    const grfx::FormatDesc* pFormatDesc = grfx::GetFormatDescription(mCreateInfo.colorFormat);
+    const uint32_t          rowPitch    = RoundUp<uint32_t>(pFormatDesc->bytesPerTexel * mCreateInfo.width, 256);
+
+    mHeadlessReadbackSlots.resize(mCreateInfo.imageCount);
+    for (auto& slot : mHeadlessReadbackSlots) {
+        grfx::BufferCreateInfo bufferCreateInfo      = {};
+        bufferCreateInfo.size                        = static_cast<uint64_t>(rowPitch) * mCreateInfo.height;
+        bufferCreateInfo.initialState                = grfx::RESOURCE_STATE_COPY_DST;
+        bufferCreateInfo.usageFlags.bits.transferDst = 1;
+        bufferCreateInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_TO_CPU;
+        bufferCreateInfo.ownership                   = grfx::OWNERSHIP_RESTRICTED;
+
+        ppxres = GetDevice()->CreateBuffer(&bufferCreateInfo, &slot.buffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+
+        ppxres = mCreateInfo.pQueue->CreateCommandBuffer(&slot.commandBuffer, 0, 0);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+    }
+
+    return ppx::SUCCESS;
+}
+
+void Swapchain::DestroyHeadlessReadbackObjects()
+{
+    if (!mHeadlessReadbackSemaphore) {
+        return;
+    }
+
+    // Copies in flight still write to the buffers
+    mHeadlessReadbackSemaphore->Wait(mHeadlessPresentCount);
+
+    for (auto& slot : mHeadlessReadbackSlots) {
+        if (slot.commandBuffer) {
+            mCreateInfo.pQueue->DestroyCommandBuffer(slot.commandBuffer);
+        }
+        if (slot.buffer) {
+            GetDevice()->DestroyBuffer(slot.buffer);
+        }
+    }
+    mHeadlessReadbackSlots.clear();
+
+    GetDevice()->DestroySemaphore(mHeadlessReadbackSemaphore);
+    mHeadlessReadbackSemaphore.Reset();
+}
+
+void Swapchain::DeliverHeadlessReadbacks()
+{
+    const uint64_t completedId = mHeadlessReadbackSemaphore->GetCounterValue();
+
+    // Latest frame wins, older completed copies are dropped
+    uint32_t newestIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < CountU32(mHeadlessReadbackSlots); ++i) {
+        HeadlessReadbackSlot& slot = mHeadlessReadbackSlots[i];
+        if ((slot.presentId == 0) || (slot.presentId > completedId)) {
+            continue;
+        }
+
+        if (newestIndex == UINT32_MAX) {
+            newestIndex = i;
+            continue;
+        }
+
+        HeadlessReadbackSlot& newest = mHeadlessReadbackSlots[newestIndex];
+        if (slot.presentId > newest.presentId) {
+            newest.presentId = 0;
+            newestIndex      = i;
+        }
+        else {
+            slot.presentId = 0;
+        }
+        ++mHeadlessDroppedReadbackCount;
+    }
+
+    if (newestIndex == UINT32_MAX) {
+        return;
+    }
+
+    HeadlessReadbackSlot& slot      = mHeadlessReadbackSlots[newestIndex];
+    const uint64_t        presentId = slot.presentId;
+    slot.presentId                  = 0;
+
+    void*  pData  = nullptr;
+    Result ppxres = slot.buffer->MapMemory(0, &pData);
+    if (Failed(ppxres)) {
+        PPX_LOG_ERROR("failed to map headless readback buffer: " << ToString(ppxres));
+        return;
+    }
+
+    grfx::HeadlessReadback readback = {};
+    readback.imageIndex             = newestIndex;
+    readback.presentId              = presentId;
+    readback.format                 = mCreateInfo.colorFormat;
+    readback.width                  = mCreateInfo.width;
+    readback.height                 = mCreateInfo.height;
+    readback.rowPitch               = slot.rowPitch;
+    readback.pData                  = pData;
+    mHeadlessReadbackCallback(readback);
+
+    slot.buffer->UnmapMemory();
+}
+
 } // namespace grfx
 } // namespace ppx
@@ -32,5 +32,33 @@ Result Fence::WaitAndReset(uint64_t timeout)
     return ppx::SUCCESS;
 }
 
+// -------------------------------------------------------------------------------------------------
+
+Result Semaphore::Wait(uint64_t value, uint64_t timeout) const
+{
+    if (!IsTimeline()) {
+        PPX_ASSERT_MSG(false, "host wait requires a timeline semaphore");
+        return ppx::ERROR_FAILED;
+    }
+    return TimelineWait(value, timeout);
+}
+
+Result Semaphore::Signal(uint64_t value) const
+{
+    if (!IsTimeline()) {
+        PPX_ASSERT_MSG(false, "host signal requires a timeline semaphore");
+        return ppx::ERROR_FAILED;
+    }
+    return TimelineSignal(value);
+}
+
+uint64_t Semaphore::GetCounterValue() const
+{
+    if (!IsTimeline()) {
+        return 0;
+    }
+    return TimelineCounterValue();
+}
+
 } // namespace grfx
 } // namespace ppx
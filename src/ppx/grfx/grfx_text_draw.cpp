@@ -16,6 +16,7 @@
 #include "ppx/grfx/grfx_device.h"
 #include "ppx/bitmap.h"
 #include "ppx/graphics_util.h"
+#include "ppx/parallel.h"
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
@@ -25,6 +26,10 @@
 namespace ppx {
 namespace grfx {
 
+// Glyphs are rasterized at a half pixel offset
+constexpr float kSubpixelShiftX = 0.5f;
+constexpr float kSubpixelShiftY = 0.5f;
+
 // -------------------------------------------------------------------------------------------------
 // TextureFont
 // -------------------------------------------------------------------------------------------------
@@ -52,33 +57,36 @@ Result TextureFont::CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateI
     // Font metrics
     pCreateInfo->font.GetFontMetrics(pCreateInfo->size, &mFontMetrics);
 
-    // Subpixel shift
-    float subpixelShiftX = 0.5f;
-    float subpixelShiftY = 0.5f;
-
-    // Get glyph metrics and max bounds
-    utf8::iterator<std::string::iterator> it(characters.begin(), characters.begin(), characters.end());
-    utf8::iterator<std::string::iterator> it_end(characters.end(), characters.begin(), characters.end());
-    bool                                  hasSpace = false;
-    while (it != it_end) {
-        const uint32_t codepoint = utf8::next(it, it_end);
-        GlyphMetrics   metrics   = {};
-        pCreateInfo->font.GetGlyphMetrics(pCreateInfo->size, codepoint, subpixelShiftX, subpixelShiftY, &metrics);
-        mGlyphMetrics.emplace_back(grfx::TextureFontGlyphMetrics{codepoint, metrics});
-
-        if (!hasSpace) {
-            hasSpace = (codepoint == 32);
+    // Unique codepoints, space is always included since it's the fallback glyph
+    std::vector<uint32_t> codepoints;
+    {
+        utf8::iterator<std::string::iterator> it(characters.begin(), characters.begin(), characters.end());
+        utf8::iterator<std::string::iterator> it_end(characters.end(), characters.begin(), characters.end());
+        while (it != it_end) {
+            const uint32_t codepoint = utf8::next(it, it_end);
+            if (mGlyphLookup.emplace(codepoint, CountU32(codepoints)).second) {
+                codepoints.push_back(codepoint);
+            }
+        }
+        if (mGlyphLookup.emplace(32, CountU32(codepoints)).second) {
+            codepoints.push_back(32);
         }
     }
-    if (!hasSpace) {
-        const uint32_t codepoint = 32;
-        GlyphMetrics   metrics   = {};
-        pCreateInfo->font.GetGlyphMetrics(pCreateInfo->size, codepoint, subpixelShiftX, subpixelShiftY, &metrics);
+
+    if (pCreateInfo->enableGlyphCache) {
+        mGlyphLookup.clear();
+        return CreateGlyphCache(codepoints);
+    }
+
+    // Get glyph metrics and max bounds
+    for (uint32_t codepoint : codepoints) {
+        GlyphMetrics metrics = {};
+        GetAtlasGlyphMetrics(codepoint, &metrics);
         mGlyphMetrics.emplace_back(grfx::TextureFontGlyphMetrics{codepoint, metrics});
     }
 
     // Figure out a squarish somewhat texture size
-    const size_t  nc           = characters.size();
+    const size_t  nc           = mGlyphMetrics.size();
     const int32_t sqrtnc       = static_cast<int32_t>(sqrtf(static_cast<float>(nc)) + 0.5f) + 1;
     int32_t       bitmapWidth  = 0;
     int32_t       bitmapHeight = 0;
@@ -100,25 +108,23 @@ Result TextureFont::CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateI
     // Storage bitmap
     Bitmap bitmap = Bitmap::Create(bitmapWidth, bitmapHeight, Bitmap::Format::FORMAT_R_UINT8);
 
-    // Render glyph bitmaps
-    const float    invBitmapWidth  = 1.0f / static_cast<float>(bitmapWidth);
-    const float    invBitmapHeight = 1.0f / static_cast<float>(bitmapHeight);
-    const uint32_t rowStride       = bitmap.GetRowStride();
-    const uint32_t pixelStride     = bitmap.GetPixelStride();
-    uint32_t       y               = 0;
-    glyphIndex                     = 0;
+    // Place glyphs
+    std::vector<uint32_t> glyphOffsets(nc);
+    const float           invBitmapWidth  = 1.0f / static_cast<float>(bitmapWidth);
+    const float           invBitmapHeight = 1.0f / static_cast<float>(bitmapHeight);
+    const uint32_t        rowStride       = bitmap.GetRowStride();
+    const uint32_t        pixelStride     = bitmap.GetPixelStride();
+    uint32_t              y               = 0;
+    glyphIndex                            = 0;
     for (int32_t i = 0; (i < sqrtnc) && (glyphIndex < nc); ++i) {
         uint32_t x      = 0;
         uint32_t height = 0;
         for (int32_t j = 0; (j < sqrtnc) && (glyphIndex < nc); ++j, ++glyphIndex) {
-            uint32_t            codepoint = mGlyphMetrics[glyphIndex].codepoint;
-            const GlyphMetrics& metrics   = mGlyphMetrics[glyphIndex].glyphMetrics;
-            uint32_t            w         = static_cast<uint32_t>(metrics.box.x1 - metrics.box.x0) + 1;
-            uint32_t            h         = static_cast<uint32_t>(metrics.box.y1 - metrics.box.y0) + 1;
+            const GlyphMetrics& metrics = mGlyphMetrics[glyphIndex].glyphMetrics;
+            uint32_t            w       = static_cast<uint32_t>(metrics.box.x1 - metrics.box.x0) + 1;
+            uint32_t            h       = static_cast<uint32_t>(metrics.box.y1 - metrics.box.y0) + 1;
 
-            uint32_t offset  = (y * rowStride) + (x * pixelStride);
-            char*    pOutput = bitmap.GetData() + offset;
-            pCreateInfo->font.RenderGlyphBitmap(pCreateInfo->size, codepoint, subpixelShiftX, subpixelShiftY, w, h, rowStride, reinterpret_cast<unsigned char*>(pOutput));
+            glyphOffsets[glyphIndex] = (y * rowStride) + (x * pixelStride);
 
             mGlyphMetrics[glyphIndex].size.x = static_cast<float>(w);
             mGlyphMetrics[glyphIndex].size.y = static_cast<float>(h);
@@ -134,6 +140,13 @@ Result TextureFont::CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateI
         y += height;
     }
 
+    // Render glyphs, they don't overlap so each one can go to a different thread
+    ParallelFor(CountU32(mGlyphMetrics), pCreateInfo->rasterThreadCount, [&](uint32_t i) {
+        const grfx::TextureFontGlyphMetrics& glyph   = mGlyphMetrics[i];
+        char*                                pOutput = bitmap.GetData() + glyphOffsets[i];
+        RenderAtlasGlyph(glyph.codepoint, static_cast<uint32_t>(glyph.size.x), static_cast<uint32_t>(glyph.size.y), rowStride, pOutput);
+    });
+
     ppx::Result ppxres = grfx_util::CreateTextureFromBitmap(GetDevice()->GetGraphicsQueue(), &bitmap, &mTexture);
     if (Failed(ppxres)) {
         return ppxres;
@@ -145,26 +158,338 @@ Result TextureFont::CreateApiObjects(const grfx::TextureFontCreateInfo* pCreateI
     return ppx::SUCCESS;
 }
 
+Result TextureFont::CreateGlyphCache(const std::vector<uint32_t>& codepoints)
+{
+    const uint32_t width  = mCreateInfo.glyphCacheWidth;
+    const uint32_t height = mCreateInfo.glyphCacheHeight;
+
+    if (mCreateInfo.glyphCacheFramesInFlight == 0) {
+        PPX_ASSERT_MSG(false, "glyph cache frames in flight must be at least 1");
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    std::vector<GlyphMetrics> metrics(codepoints.size());
+    for (size_t i = 0; i < codepoints.size(); ++i) {
+        GetAtlasGlyphMetrics(codepoints[i], &metrics[i]);
+    }
+
+    // Every glyph gets a cell as large as a line, or the largest resident
+    // glyph, plus a 1 pixel gap so filtering doesn't pick up neighbours.
+    const uint32_t padding    = mCreateInfo.signedDistanceField ? 2 * mCreateInfo.sdfPadding : 0;
+    const uint32_t lineHeight = static_cast<uint32_t>(std::ceil(mFontMetrics.ascent - mFontMetrics.descent)) + padding + 1;
+    uint32_t       maxWidth   = lineHeight;
+    uint32_t       maxHeight  = lineHeight;
+    for (const GlyphMetrics& glyphMetrics : metrics) {
+        maxWidth  = std::max<uint32_t>(maxWidth, static_cast<uint32_t>(glyphMetrics.box.x1 - glyphMetrics.box.x0) + 1);
+        maxHeight = std::max<uint32_t>(maxHeight, static_cast<uint32_t>(glyphMetrics.box.y1 - glyphMetrics.box.y0) + 1);
+    }
+    mGlyphCacheCellWidth   = maxWidth + 1;
+    mGlyphCacheCellHeight  = maxHeight + 1;
+    mGlyphCacheColumnCount = width / mGlyphCacheCellWidth;
+
+    const uint32_t rowCount  = height / mGlyphCacheCellHeight;
+    const uint32_t slotCount = mGlyphCacheColumnCount * rowCount;
+    if (slotCount < CountU32(codepoints)) {
+        PPX_ASSERT_MSG(false, "glyph cache is too small for the font's characters");
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    // CPU copy of the atlas. Rows are padded so every band of cells starts at an
+    // offset that D3D12 accepts as a copy source.
+    {
+        mGlyphCacheRowPitch = RoundUp<uint32_t>(width, PPX_D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+        grfx::BufferCreateInfo createInfo      = {};
+        createInfo.size                        = static_cast<uint64_t>(mGlyphCacheRowPitch) * height;
+        createInfo.usageFlags.bits.transferSrc = true;
+        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+        createInfo.initialState                = grfx::RESOURCE_STATE_COPY_SRC;
+
+        ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mGlyphCacheBuffer);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating glyph cache buffer");
+            return ppxres;
+        }
+
+        void* pMappedAddress = nullptr;
+        ppxres               = mGlyphCacheBuffer->MapMemory(0, &pMappedAddress);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        mGlyphCacheData = static_cast<char*>(pMappedAddress);
+        std::memset(mGlyphCacheData, 0, static_cast<size_t>(createInfo.size));
+    }
+
+    // Texture
+    {
+        grfx::TextureCreateInfo createInfo     = {};
+        createInfo.imageType                   = grfx::IMAGE_TYPE_2D;
+        createInfo.width                       = width;
+        createInfo.height                      = height;
+        createInfo.depth                       = 1;
+        createInfo.imageFormat                 = grfx::FORMAT_R8_UNORM;
+        createInfo.usageFlags.bits.transferDst = true;
+        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+        createInfo.initialState                = grfx::RESOURCE_STATE_SHADER_RESOURCE;
+
+        ppx::Result ppxres = GetDevice()->CreateTexture(&createInfo, &mTexture);
+        if (Failed(ppxres)) {
+            PPX_ASSERT_MSG(false, "failed creating glyph cache texture");
+            return ppxres;
+        }
+    }
+
+    mGlyphMetrics.resize(slotCount);
+    mGlyphCacheSlots.resize(slotCount);
+    mGlyphCacheFreeSlots.reserve(slotCount);
+    for (uint32_t i = slotCount; i > 0; --i) {
+        mGlyphCacheFreeSlots.push_back(i - 1);
+    }
+    // First upload fills the whole texture
+    mGlyphCacheDirtyRows.assign(rowCount, true);
+
+    for (size_t i = 0; i < codepoints.size(); ++i) {
+        const uint32_t slot = mGlyphCacheFreeSlots.back();
+        mGlyphCacheFreeSlots.pop_back();
+
+        RasterizeGlyph(slot, codepoints[i], metrics[i]);
+        mGlyphCacheSlots[slot].pinned = true;
+        mGlyphLookup[codepoints[i]]   = slot;
+    }
+
+    return UploadGlyphs(GetDevice()->GetGraphicsQueue());
+}
+
+void TextureFont::GetAtlasGlyphMetrics(uint32_t codepoint, GlyphMetrics* pMetrics) const
+{
+    if (!mCreateInfo.signedDistanceField) {
+        mCreateInfo.font.GetGlyphMetrics(mCreateInfo.size, codepoint, kSubpixelShiftX, kSubpixelShiftY, pMetrics);
+        return;
+    }
+
+    // Distance fields aren't shifted and extend past the glyph box by the padding
+    mCreateInfo.font.GetGlyphMetrics(mCreateInfo.size, codepoint, 0.0f, 0.0f, pMetrics);
+    const int32_t padding = static_cast<int32_t>(mCreateInfo.sdfPadding);
+    pMetrics->box.x0 -= padding;
+    pMetrics->box.y0 -= padding;
+    pMetrics->box.x1 += padding;
+    pMetrics->box.y1 += padding;
+}
+
+void TextureFont::RenderAtlasGlyph(uint32_t codepoint, uint32_t width, uint32_t height, uint32_t rowStride, char* pOutput) const
+{
+    unsigned char* pPixels = reinterpret_cast<unsigned char*>(pOutput);
+    if (mCreateInfo.signedDistanceField) {
+        mCreateInfo.font.RenderGlyphSDF(mCreateInfo.size, codepoint, mCreateInfo.sdfPadding, width, height, rowStride, pPixels);
+    }
+    else {
+        mCreateInfo.font.RenderGlyphBitmap(mCreateInfo.size, codepoint, kSubpixelShiftX, kSubpixelShiftY, width, height, rowStride, pPixels);
+    }
+}
+
+bool TextureFont::GlyphFitsCacheCell(const GlyphMetrics& metrics) const
+{
+    const uint32_t w = static_cast<uint32_t>(metrics.box.x1 - metrics.box.x0) + 1;
+    const uint32_t h = static_cast<uint32_t>(metrics.box.y1 - metrics.box.y0) + 1;
+    return (w < mGlyphCacheCellWidth) && (h < mGlyphCacheCellHeight);
+}
+
+void TextureFont::RasterizeGlyph(uint32_t slot, uint32_t codepoint, const GlyphMetrics& metrics)
+{
+    PPX_ASSERT_MSG(GlyphFitsCacheCell(metrics), "glyph doesn't fit in a glyph cache cell");
+
+    const uint32_t row = slot / mGlyphCacheColumnCount;
+    const uint32_t x   = (slot % mGlyphCacheColumnCount) * mGlyphCacheCellWidth;
+    const uint32_t y   = row * mGlyphCacheCellHeight;
+    const uint32_t w   = static_cast<uint32_t>(metrics.box.x1 - metrics.box.x0) + 1;
+    const uint32_t h   = static_cast<uint32_t>(metrics.box.y1 - metrics.box.y0) + 1;
+
+    // Clear the cell so nothing of an evicted glyph is left next to the new one
+    char* pCell = mGlyphCacheData + (static_cast<size_t>(y) * mGlyphCacheRowPitch) + x;
+    for (uint32_t i = 0; i < mGlyphCacheCellHeight - 1; ++i) {
+        std::memset(pCell + (static_cast<size_t>(i) * mGlyphCacheRowPitch), 0, mGlyphCacheCellWidth - 1);
+    }
+    RenderAtlasGlyph(codepoint, w, h, mGlyphCacheRowPitch, pCell);
+
+    const float invWidth  = 1.0f / static_cast<float>(mCreateInfo.glyphCacheWidth);
+    const float invHeight = 1.0f / static_cast<float>(mCreateInfo.glyphCacheHeight);
+
+    grfx::TextureFontGlyphMetrics& glyph = mGlyphMetrics[slot];
+    glyph.codepoint                      = codepoint;
+    glyph.glyphMetrics                   = metrics;
+    glyph.size                           = float2(static_cast<float>(w), static_cast<float>(h));
+    glyph.uvRect.u0                      = x * invWidth;
+    glyph.uvRect.v0                      = y * invHeight;
+    glyph.uvRect.u1                      = (x + w - 1) * invWidth;
+    glyph.uvRect.v1                      = (y + h - 1) * invHeight;
+
+    mGlyphCacheDirtyRows[row] = true;
+}
+
+void TextureFont::GetPendingGlyphCopies(std::vector<grfx::BufferToImageCopyInfo>* pCopyInfos)
+{
+    // Runs of dirty cell rows are copied as full width bands
+    const uint32_t rowCount = static_cast<uint32_t>(mGlyphCacheDirtyRows.size());
+    uint32_t       row      = 0;
+    while (row < rowCount) {
+        if (!mGlyphCacheDirtyRows[row]) {
+            ++row;
+            continue;
+        }
+
+        const uint32_t firstRow = row;
+        for (; (row < rowCount) && mGlyphCacheDirtyRows[row]; ++row) {
+            mGlyphCacheDirtyRows[row] = false;
+        }
+
+        const uint32_t y      = firstRow * mGlyphCacheCellHeight;
+        const uint32_t height = (row - firstRow) * mGlyphCacheCellHeight;
+
+        grfx::BufferToImageCopyInfo copyInfo = {};
+        copyInfo.srcBuffer.imageWidth        = mGlyphCacheRowPitch; // One byte per texel
+        copyInfo.srcBuffer.imageHeight       = height;
+        copyInfo.srcBuffer.imageRowStride    = mGlyphCacheRowPitch;
+        copyInfo.srcBuffer.footprintOffset   = static_cast<uint64_t>(y) * mGlyphCacheRowPitch;
+        copyInfo.srcBuffer.footprintWidth    = mCreateInfo.glyphCacheWidth;
+        copyInfo.srcBuffer.footprintHeight   = height;
+        copyInfo.srcBuffer.footprintDepth    = 1;
+        copyInfo.dstImage.mipLevel           = 0;
+        copyInfo.dstImage.arrayLayer         = 0;
+        copyInfo.dstImage.arrayLayerCount    = 1;
+        copyInfo.dstImage.x                  = 0;
+        copyInfo.dstImage.y                  = y;
+        copyInfo.dstImage.z                  = 0;
+        copyInfo.dstImage.width              = mCreateInfo.glyphCacheWidth;
+        copyInfo.dstImage.height             = height;
+        copyInfo.dstImage.depth              = 1;
+        pCopyInfos->push_back(copyInfo);
+    }
+}
+
+ppx::Result TextureFont::UploadGlyphs(grfx::Queue* pQueue)
+{
+    if (!mCreateInfo.enableGlyphCache) {
+        return ppx::SUCCESS;
+    }
+
+    std::vector<grfx::BufferToImageCopyInfo> copyInfos;
+    GetPendingGlyphCopies(&copyInfos);
+    if (copyInfos.empty()) {
+        return ppx::SUCCESS;
+    }
+
+    return pQueue->CopyBufferToImage(
+        copyInfos,
+        mGlyphCacheBuffer,
+        mTexture->GetImage(),
+        0,
+        1,
+        0,
+        1,
+        grfx::RESOURCE_STATE_SHADER_RESOURCE,
+        grfx::RESOURCE_STATE_SHADER_RESOURCE);
+}
+
+void TextureFont::UploadGlyphs(grfx::CommandBuffer* pCommandBuffer)
+{
+    if (!mCreateInfo.enableGlyphCache) {
+        return;
+    }
+
+    std::vector<grfx::BufferToImageCopyInfo> copyInfos;
+    GetPendingGlyphCopies(&copyInfos);
+    if (copyInfos.empty()) {
+        return;
+    }
+
+    grfx::ImagePtr image = mTexture->GetImage();
+    pCommandBuffer->TransitionImageLayout(image, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_SHADER_RESOURCE, grfx::RESOURCE_STATE_COPY_DST);
+    pCommandBuffer->CopyBufferToImage(copyInfos, mGlyphCacheBuffer, image);
+    pCommandBuffer->TransitionImageLayout(image, PPX_ALL_SUBRESOURCES, grfx::RESOURCE_STATE_COPY_DST, grfx::RESOURCE_STATE_SHADER_RESOURCE);
+}
+
 void TextureFont::DestroyApiObjects()
 {
     if (mTexture) {
         GetDevice()->DestroyTexture(mTexture);
         mTexture.Reset();
     }
+
+    if (mGlyphCacheBuffer) {
+        if (!IsNull(mGlyphCacheData)) {
+            mGlyphCacheBuffer->UnmapMemory();
+            mGlyphCacheData = nullptr;
+        }
+        GetDevice()->DestroyBuffer(mGlyphCacheBuffer);
+        mGlyphCacheBuffer.Reset();
+    }
 }
 
 const grfx::TextureFontGlyphMetrics* TextureFont::GetGlyphMetrics(uint32_t codepoint) const
 {
-    const grfx::TextureFontGlyphMetrics* ptr = nullptr;
-    auto                                 it  = FindIf(
-        mGlyphMetrics,
-        [codepoint](const grfx::TextureFontGlyphMetrics& elem) -> bool {
-            bool match = (elem.codepoint == codepoint);
-            return match; });
-    if (it != std::end(mGlyphMetrics)) {
-        ptr = &(*it);
-    }
-    return ptr;
+    auto it = mGlyphLookup.find(codepoint);
+    if (it == mGlyphLookup.end()) {
+        return nullptr;
+    }
+    return &mGlyphMetrics[it->second];
+}
+
+const grfx::TextureFontGlyphMetrics* TextureFont::AcquireGlyph(uint32_t codepoint)
+{
+    if (!mCreateInfo.enableGlyphCache) {
+        return GetGlyphMetrics(codepoint);
+    }
+
+    auto it = mGlyphLookup.find(codepoint);
+    if (it != mGlyphLookup.end()) {
+        GlyphCacheSlot& slot = mGlyphCacheSlots[it->second];
+        slot.lastUsedFrame   = mGlyphCacheFrame;
+        if (!slot.pinned) {
+            mGlyphCacheLru.splice(mGlyphCacheLru.begin(), mGlyphCacheLru, slot.lruIt);
+        }
+        return &mGlyphMetrics[it->second];
+    }
+
+    if (mGlyphCacheOversized.count(codepoint) > 0) {
+        return nullptr;
+    }
+
+    ++mGlyphCacheMissCount;
+
+    GlyphMetrics metrics = {};
+    GetAtlasGlyphMetrics(codepoint, &metrics);
+    if (!GlyphFitsCacheCell(metrics)) {
+        PPX_LOG_ERROR("glyph for codepoint " << codepoint << " is larger than the glyph cache cells and won't be drawn");
+        mGlyphCacheOversized.insert(codepoint);
+        return nullptr;
+    }
+
+    uint32_t slotIndex = UINT32_MAX;
+    if (!mGlyphCacheFreeSlots.empty()) {
+        slotIndex = mGlyphCacheFreeSlots.back();
+        mGlyphCacheFreeSlots.pop_back();
+    }
+    else {
+        // Rasterizing overwrites the cell in the upload buffer, so the frames
+        // that may still copy or sample the old glyph must have completed.
+        // The LRU list is ordered by last use, so only the back needs checking.
+        if (mGlyphCacheLru.empty() || (mGlyphCacheSlots[mGlyphCacheLru.back()].lastUsedFrame + mCreateInfo.glyphCacheFramesInFlight > mGlyphCacheFrame)) {
+            return nullptr;
+        }
+        slotIndex = mGlyphCacheLru.back();
+        mGlyphCacheLru.pop_back();
+        mGlyphLookup.erase(mGlyphMetrics[slotIndex].codepoint);
+        ++mGlyphCacheEvictionCount;
+    }
+
+    RasterizeGlyph(slotIndex, codepoint, metrics);
+
+    GlyphCacheSlot& slot    = mGlyphCacheSlots[slotIndex];
+    slot.lastUsedFrame      = mGlyphCacheFrame;
+    slot.lruIt              = mGlyphCacheLru.insert(mGlyphCacheLru.begin(), slotIndex);
+    mGlyphLookup[codepoint] = slotIndex;
+
+    return &mGlyphMetrics[slotIndex];
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -189,70 +514,90 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
         return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
     }
 
-    // Index buffer
-    {
-        uint64_t size = pCreateInfo->maxTextLength * kGlyphIndicesSize;
-
-        grfx::BufferCreateInfo createInfo      = {};
-        createInfo.size                        = size;
-        createInfo.usageFlags.bits.transferSrc = true;
-        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        createInfo.initialState                = grfx::RESOURCE_STATE_COPY_SRC;
-
-        ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mCpuIndexBuffer);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "failed creating CPU index buffer");
-            return ppxres;
+    if (pCreateInfo->streaming) {
+        if (pCreateInfo->streamingFrameCount == 0) {
+            PPX_ASSERT_MSG(false, "streaming text draw needs at least one frame");
+            return ppx::ERROR_INVALID_CREATE_ARGUMENT;
         }
 
-        createInfo.usageFlags.bits.transferSrc = false;
-        createInfo.usageFlags.bits.transferDst = true;
-        createInfo.usageFlags.bits.indexBuffer = true;
-        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
-        createInfo.initialState                = grfx::RESOURCE_STATE_INDEX_BUFFER;
-
-        ppxres = GetDevice()->CreateBuffer(&createInfo, &mGpuIndexBuffer);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "failed creating GPU index buffer");
-            return ppxres;
+        mStreamingFrames.resize(pCreateInfo->streamingFrameCount);
+        for (StreamingFrame& frame : mStreamingFrames) {
+            ppx::Result ppxres = CreateStreamingBuffers(std::max<uint32_t>(pCreateInfo->maxTextLength, 1), &frame);
+            if (Failed(ppxres)) {
+                return ppxres;
+            }
         }
 
-        mIndexBufferView.pBuffer   = mGpuIndexBuffer;
+        // Buffers are bound in Draw()
         mIndexBufferView.indexType = grfx::INDEX_TYPE_UINT32;
-        mIndexBufferView.offset    = 0;
+        mVertexBufferView.stride   = sizeof(Vertex);
     }
-
-    // Vertex buffer
-    {
-        uint64_t size = pCreateInfo->maxTextLength * kGlyphVerticesSize;
-
-        grfx::BufferCreateInfo createInfo      = {};
-        createInfo.size                        = size;
-        createInfo.usageFlags.bits.transferSrc = true;
-        createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
-        createInfo.initialState                = grfx::RESOURCE_STATE_COPY_SRC;
-
-        ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mCpuVertexBuffer);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "failed creating CPU vertex buffer");
-            return ppxres;
+    else {
+        // Index buffer
+        {
+            uint64_t size = pCreateInfo->maxTextLength * kGlyphIndicesSize;
+
+            grfx::BufferCreateInfo createInfo      = {};
+            createInfo.size                        = size;
+            createInfo.usageFlags.bits.transferSrc = true;
+            createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+            createInfo.initialState                = grfx::RESOURCE_STATE_COPY_SRC;
+
+            ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mCpuIndexBuffer);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "failed creating CPU index buffer");
+                return ppxres;
+            }
+
+            createInfo.usageFlags.bits.transferSrc = false;
+            createInfo.usageFlags.bits.transferDst = true;
+            createInfo.usageFlags.bits.indexBuffer = true;
+            createInfo.memoryUsage                 = grfx::MEMORY_USAGE_GPU_ONLY;
+            createInfo.initialState                = grfx::RESOURCE_STATE_INDEX_BUFFER;
+
+            ppxres = GetDevice()->CreateBuffer(&createInfo, &mGpuIndexBuffer);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "failed creating GPU index buffer");
+                return ppxres;
+            }
+
+            mIndexBufferView.pBuffer   = mGpuIndexBuffer;
+            mIndexBufferView.indexType = grfx::INDEX_TYPE_UINT32;
+            mIndexBufferView.offset    = 0;
         }
 
-        createInfo.usageFlags.bits.transferSrc  = false;
-        createInfo.usageFlags.bits.transferDst  = true;
-        createInfo.usageFlags.bits.vertexBuffer = true;
-        createInfo.memoryUsage                  = grfx::MEMORY_USAGE_GPU_ONLY;
-        createInfo.initialState                 = grfx::RESOURCE_STATE_VERTEX_BUFFER;
-
-        ppxres = GetDevice()->CreateBuffer(&createInfo, &mGpuVertexBuffer);
-        if (Failed(ppxres)) {
-            PPX_ASSERT_MSG(false, "failed creating GPU vertex buffer");
-            return ppxres;
+        // Vertex buffer
+        {
+            uint64_t size = pCreateInfo->maxTextLength * kGlyphVerticesSize;
+
+            grfx::BufferCreateInfo createInfo      = {};
+            createInfo.size                        = size;
+            createInfo.usageFlags.bits.transferSrc = true;
+            createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+            createInfo.initialState                = grfx::RESOURCE_STATE_COPY_SRC;
+
+            ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &mCpuVertexBuffer);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "failed creating CPU vertex buffer");
+                return ppxres;
+            }
+
+            createInfo.usageFlags.bits.transferSrc  = false;
+            createInfo.usageFlags.bits.transferDst  = true;
+            createInfo.usageFlags.bits.vertexBuffer = true;
+            createInfo.memoryUsage                  = grfx::MEMORY_USAGE_GPU_ONLY;
+            createInfo.initialState                 = grfx::RESOURCE_STATE_VERTEX_BUFFER;
+
+            ppxres = GetDevice()->CreateBuffer(&createInfo, &mGpuVertexBuffer);
+            if (Failed(ppxres)) {
+                PPX_ASSERT_MSG(false, "failed creating GPU vertex buffer");
+                return ppxres;
+            }
+
+            mVertexBufferView.pBuffer = mGpuVertexBuffer;
+            mVertexBufferView.stride  = sizeof(Vertex);
+            mVertexBufferView.offset  = 0;
         }
-
-        mVertexBufferView.pBuffer = mGpuVertexBuffer;
-        mVertexBufferView.stride  = sizeof(Vertex);
-        mVertexBufferView.offset  = 0;
     }
 
     if (!sSampler) {
@@ -391,7 +736,7 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
         createInfo.outputState.depthStencilFormat     = pCreateInfo->depthStencilFormat;
         createInfo.pPipelineInterface                 = mPipelineInterface;
 
-        ppx::Result ppxres = GetDevice()->CreateGraphicsPipeline(&createInfo, &mPipeline);
+        ppx::Result ppxres = GetDevice()->AcquireGraphicsPipeline(&createInfo, &mPipeline);
         if (Failed(ppxres)) {
             PPX_ASSERT_MSG(false, "failed creating pipeline");
             return ppxres;
@@ -403,6 +748,11 @@ Result TextDraw::CreateApiObjects(const grfx::TextDrawCreateInfo* pCreateInfo)
 
 void TextDraw::DestroyApiObjects()
 {
+    for (StreamingFrame& frame : mStreamingFrames) {
+        DestroyStreamingBuffers(&frame);
+    }
+    mStreamingFrames.clear();
+
     if (mCpuIndexBuffer) {
         GetDevice()->DestroyBuffer(mCpuIndexBuffer);
         mCpuIndexBuffer.Reset();
@@ -434,7 +784,7 @@ void TextDraw::DestroyApiObjects()
     }
 
     if (mPipeline) {
-        GetDevice()->DestroyGraphicsPipeline(mPipeline);
+        GetDevice()->ReleaseGraphicsPipeline(mPipeline);
         mPipeline.Reset();
     }
 
@@ -459,9 +809,94 @@ void TextDraw::DestroyApiObjects()
     }
 }
 
+Result TextDraw::CreateStreamingBuffers(uint32_t capacity, StreamingFrame* pFrame)
+{
+    grfx::BufferCreateInfo createInfo      = {};
+    createInfo.size                        = capacity * kGlyphIndicesSize;
+    createInfo.usageFlags.bits.indexBuffer = true;
+    createInfo.memoryUsage                 = grfx::MEMORY_USAGE_CPU_TO_GPU;
+
+    ppx::Result ppxres = GetDevice()->CreateBuffer(&createInfo, &pFrame->indexBuffer);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating streaming index buffer");
+        return ppxres;
+    }
+
+    createInfo.size                         = capacity * kGlyphVerticesSize;
+    createInfo.usageFlags.bits.indexBuffer  = false;
+    createInfo.usageFlags.bits.vertexBuffer = true;
+
+    ppxres = GetDevice()->CreateBuffer(&createInfo, &pFrame->vertexBuffer);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed creating streaming vertex buffer");
+        return ppxres;
+    }
+
+    // Both buffers stay mapped for their whole lifetime
+    void* pMappedAddress = nullptr;
+    ppxres               = pFrame->indexBuffer->MapMemory(0, &pMappedAddress);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    pFrame->pIndices = static_cast<uint32_t*>(pMappedAddress);
+
+    ppxres = pFrame->vertexBuffer->MapMemory(0, &pMappedAddress);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    pFrame->pVertices = pMappedAddress;
+    pFrame->capacity  = capacity;
+
+    return ppx::SUCCESS;
+}
+
+void TextDraw::DestroyStreamingBuffers(StreamingFrame* pFrame)
+{
+    if (pFrame->indexBuffer) {
+        if (!IsNull(pFrame->pIndices)) {
+            pFrame->indexBuffer->UnmapMemory();
+        }
+        GetDevice()->DestroyBuffer(pFrame->indexBuffer);
+    }
+
+    if (pFrame->vertexBuffer) {
+        if (!IsNull(pFrame->pVertices)) {
+            pFrame->vertexBuffer->UnmapMemory();
+        }
+        GetDevice()->DestroyBuffer(pFrame->vertexBuffer);
+    }
+
+    *pFrame = StreamingFrame();
+}
+
+Result TextDraw::GrowStreamingBuffers(uint32_t minCapacity)
+{
+    // The current frame's buffers aren't in use by the GPU (see Clear()), so
+    // they can be replaced right away.
+    StreamingFrame& frame    = mStreamingFrames[mStreamingFrameIndex];
+    StreamingFrame  newFrame = {};
+    ppx::Result     ppxres   = CreateStreamingBuffers(std::max<uint32_t>(2 * frame.capacity, minCapacity), &newFrame);
+    if (Failed(ppxres)) {
+        DestroyStreamingBuffers(&newFrame);
+        return ppxres;
+    }
+
+    std::memcpy(newFrame.pIndices, frame.pIndices, mTextLength * kGlyphIndicesSize);
+    std::memcpy(newFrame.pVertices, frame.pVertices, mTextLength * kGlyphVerticesSize);
+
+    DestroyStreamingBuffers(&frame);
+    frame = newFrame;
+
+    return ppx::SUCCESS;
+}
+
 void TextDraw::Clear()
 {
     mTextLength = 0;
+
+    if (mCreateInfo.streaming) {
+        mStreamingFrameIndex = (mStreamingFrameIndex + 1) % CountU32(mStreamingFrames);
+    }
 }
 
 void TextDraw::AddString(
@@ -472,24 +907,50 @@ void TextDraw::AddString(
     const float3&      color,
     float              opacity)
 {
-    if (mTextLength >= mCreateInfo.maxTextLength) {
+    AddString(position, string, mCreateInfo.pFont->GetSize(), tabSpacing, lineSpacing, color, opacity);
+}
+
+void TextDraw::AddString(
+    const float2&      position,
+    const std::string& string,
+    float              fontSize,
+    float              tabSpacing,
+    float              lineSpacing,
+    const float3&      color,
+    float              opacity)
+{
+    const bool streaming = mCreateInfo.streaming;
+    if (!streaming && (mTextLength >= mCreateInfo.maxTextLength)) {
         return;
     }
 
-    // Map index buffer
-    void*       mappedAddress = nullptr;
-    ppx::Result ppxres        = mCpuIndexBuffer->MapMemory(0, &mappedAddress);
-    if (Failed(ppxres)) {
-        return;
+    uint8_t* pIndicesBaseAddr  = nullptr;
+    uint8_t* pVerticesBaseAddr = nullptr;
+    uint32_t capacity          = 0;
+    if (streaming) {
+        const StreamingFrame& frame = mStreamingFrames[mStreamingFrameIndex];
+        pIndicesBaseAddr            = reinterpret_cast<uint8_t*>(frame.pIndices);
+        pVerticesBaseAddr           = static_cast<uint8_t*>(frame.pVertices);
+        capacity                    = frame.capacity;
     }
-    uint8_t* pIndicesBaseAddr = static_cast<uint8_t*>(mappedAddress);
+    else {
+        // Map index buffer
+        void*       mappedAddress = nullptr;
+        ppx::Result ppxres        = mCpuIndexBuffer->MapMemory(0, &mappedAddress);
+        if (Failed(ppxres)) {
+            return;
+        }
+        pIndicesBaseAddr = static_cast<uint8_t*>(mappedAddress);
 
-    // Map vertex buffer
-    ppxres = mCpuVertexBuffer->MapMemory(0, &mappedAddress);
-    if (Failed(ppxres)) {
-        return;
+        // Map vertex buffer
+        ppxres = mCpuVertexBuffer->MapMemory(0, &mappedAddress);
+        if (Failed(ppxres)) {
+            mCpuIndexBuffer->UnmapMemory();
+            return;
+        }
+        pVerticesBaseAddr = static_cast<uint8_t*>(mappedAddress);
+        capacity          = mCreateInfo.maxTextLength;
     }
-    uint8_t* pVerticesBaseAddr = static_cast<uint8_t*>(mappedAddress);
 
     // Convert to 8 bit color
     uint32_t r    = std::min<uint32_t>(static_cast<uint32_t>(color.r * 255.0f), 255);
@@ -501,9 +962,10 @@ void TextDraw::AddString(
     utf8::iterator<std::string::const_iterator> it(string.begin(), string.begin(), string.end());
     utf8::iterator<std::string::const_iterator> it_end(string.end(), string.begin(), string.end());
     float2                                      baseline = position;
-    float                                       ascent   = mCreateInfo.pFont->GetAscent();
-    float                                       descent  = mCreateInfo.pFont->GetDescent();
-    float                                       lineGap  = mCreateInfo.pFont->GetLineGap();
+    float                                       scale    = fontSize / mCreateInfo.pFont->GetSize();
+    float                                       ascent   = scale * mCreateInfo.pFont->GetAscent();
+    float                                       descent  = scale * mCreateInfo.pFont->GetDescent();
+    float                                       lineGap  = scale * mCreateInfo.pFont->GetLineGap();
     lineSpacing                                          = lineSpacing * (ascent - descent + lineGap);
 
     while (it != it_end) {
@@ -515,35 +977,42 @@ void TextDraw::AddString(
         }
         else if (codepoint == '\t') {
             const grfx::TextureFontGlyphMetrics* pMetrics = mCreateInfo.pFont->GetGlyphMetrics(32);
-            baseline.x += tabSpacing * pMetrics->glyphMetrics.advance;
+            baseline.x += tabSpacing * scale * pMetrics->glyphMetrics.advance;
             continue;
         }
 
-        const grfx::TextureFontGlyphMetrics* pMetrics = mCreateInfo.pFont->GetGlyphMetrics(codepoint);
+        // Rasterizes the glyph if the font has a glyph cache and it isn't resident
+        const grfx::TextureFontGlyphMetrics* pMetrics = mCreateInfo.pFont->AcquireGlyph(codepoint);
         if (IsNull(pMetrics)) {
             pMetrics = mCreateInfo.pFont->GetGlyphMetrics(32);
         }
 
-        size_t indexBufferOffset    = mTextLength * kGlyphIndicesSize;
-        size_t vertexBufferOffset   = mTextLength * kGlyphVerticesSize;
-        bool   exceededIndexBuffer  = (indexBufferOffset >= mCpuIndexBuffer->GetSize());
-        bool   exceededVertexBuffer = (vertexBufferOffset >= mCpuVertexBuffer->GetSize());
-        if (exceededIndexBuffer || exceededVertexBuffer) {
-            break;
+        if (mTextLength >= capacity) {
+            if (!streaming || Failed(GrowStreamingBuffers(mTextLength + 1))) {
+                break;
+            }
+            const StreamingFrame& frame = mStreamingFrames[mStreamingFrameIndex];
+            pIndicesBaseAddr            = reinterpret_cast<uint8_t*>(frame.pIndices);
+            pVerticesBaseAddr           = static_cast<uint8_t*>(frame.pVertices);
+            capacity                    = frame.capacity;
         }
 
+        size_t indexBufferOffset  = mTextLength * kGlyphIndicesSize;
+        size_t vertexBufferOffset = mTextLength * kGlyphVerticesSize;
+
         uint32_t* pIndices  = reinterpret_cast<uint32_t*>(pIndicesBaseAddr + indexBufferOffset);
         Vertex*   pVertices = reinterpret_cast<Vertex*>(pVerticesBaseAddr + vertexBufferOffset);
 
-        float2 P   = baseline + float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0);
-        float2 P0  = P;
-        float2 P1  = P + float2(0, pMetrics->size.y);
-        float2 P2  = P + pMetrics->size;
-        float2 P3  = P + float2(pMetrics->size.x, 0);
-        float2 uv0 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v0);
-        float2 uv1 = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v1);
-        float2 uv2 = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v1);
-        float2 uv3 = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v0);
+        float2 P    = baseline + scale * float2(pMetrics->glyphMetrics.box.x0, pMetrics->glyphMetrics.box.y0);
+        float2 size = scale * pMetrics->size;
+        float2 P0   = P;
+        float2 P1   = P + float2(0, size.y);
+        float2 P2   = P + size;
+        float2 P3   = P + float2(size.x, 0);
+        float2 uv0  = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v0);
+        float2 uv1  = float2(pMetrics->uvRect.u0, pMetrics->uvRect.v1);
+        float2 uv2  = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v1);
+        float2 uv3  = float2(pMetrics->uvRect.u1, pMetrics->uvRect.v0);
 
         pVertices[0] = Vertex{P0, uv0, rgba};
         pVertices[1] = Vertex{P1, uv1, rgba};
@@ -559,11 +1028,13 @@ void TextDraw::AddString(
         pIndices[5]          = vertexCount + 3;
 
         mTextLength += 1;
-        baseline.x += pMetrics->glyphMetrics.advance;
+        baseline.x += scale * pMetrics->glyphMetrics.advance;
     }
 
-    mCpuIndexBuffer->UnmapMemory();
-    mCpuVertexBuffer->UnmapMemory();
+    if (!streaming) {
+        mCpuIndexBuffer->UnmapMemory();
+        mCpuVertexBuffer->UnmapMemory();
+    }
 }
 
 void TextDraw::AddString(
@@ -577,12 +1048,17 @@ void TextDraw::AddString(
 
 ppx::Result TextDraw::UploadToGpu(grfx::Queue* pQueue)
 {
+    ppx::Result ppxres = mCreateInfo.pFont->UploadGlyphs(pQueue);
+    if (Failed(ppxres) || mCreateInfo.streaming) {
+        return ppxres;
+    }
+
     grfx::BufferToBufferCopyInfo copyInfo = {};
     copyInfo.size                         = mCpuIndexBuffer->GetSize();
     copyInfo.srcBuffer.offset             = 0;
     copyInfo.dstBuffer.offset             = 0;
 
-    ppx::Result ppxres = pQueue->CopyBufferToBuffer(&copyInfo, mCpuIndexBuffer, mGpuIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_INDEX_BUFFER);
+    ppxres = pQueue->CopyBufferToBuffer(&copyInfo, mCpuIndexBuffer, mGpuIndexBuffer, grfx::RESOURCE_STATE_INDEX_BUFFER, grfx::RESOURCE_STATE_INDEX_BUFFER);
     if (Failed(ppxres)) {
         return ppxres;
     }
@@ -598,6 +1074,11 @@ ppx::Result TextDraw::UploadToGpu(grfx::Queue* pQueue)
 
 void TextDraw::UploadToGpu(grfx::CommandBuffer* pCommandBuffer)
 {
+    mCreateInfo.pFont->UploadGlyphs(pCommandBuffer);
+    if (mCreateInfo.streaming) {
+        return;
+    }
+
     grfx::BufferToBufferCopyInfo copyInfo = {};
     copyInfo.size                         = mTextLength * kGlyphIndicesSize;
     copyInfo.srcBuffer.offset             = 0;
@@ -637,6 +1118,12 @@ void TextDraw::PrepareDraw(const float4x4& MVP, grfx::CommandBuffer* pCommandBuf
 
 void TextDraw::Draw(grfx::CommandBuffer* pCommandBuffer)
 {
+    if (mCreateInfo.streaming) {
+        const StreamingFrame& frame = mStreamingFrames[mStreamingFrameIndex];
+        mIndexBufferView.pBuffer    = frame.indexBuffer;
+        mVertexBufferView.pBuffer   = frame.vertexBuffer;
+    }
+
     pCommandBuffer->BindIndexBuffer(&mIndexBufferView);
     pCommandBuffer->BindVertexBuffers(1, &mVertexBufferView);
     pCommandBuffer->BindGraphicsDescriptorSets(mPipelineInterface, 1, &mDescriptorSet);
@@ -51,6 +51,21 @@ const char* ToString(grfx::DescriptorType value)
     return "<unknown descriptor type>";
 }
 
+const char* ToString(grfx::MemoryCategory value)
+{
+    // clang-format off
+    switch (value) {
+        default: break;
+        case grfx::MEMORY_CATEGORY_OTHER         : return "OTHER"; break;
+        case grfx::MEMORY_CATEGORY_TEXTURE       : return "TEXTURE"; break;
+        case grfx::MEMORY_CATEGORY_MESH          : return "MESH"; break;
+        case grfx::MEMORY_CATEGORY_STAGING       : return "STAGING"; break;
+        case grfx::MEMORY_CATEGORY_RENDER_TARGET : return "RENDER_TARGET"; break;
+    }
+    // clang-format on
+    return "<unknown memory category>";
+}
+
 const char* ToString(grfx::VertexSemantic value)
 {
     // clang-format off
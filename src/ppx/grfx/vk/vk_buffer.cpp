@@ -78,6 +78,8 @@ Result Buffer::CreateApiObjects(const grfx::BufferCreateInfo* pCreateInfo)
             PPX_ASSERT_MSG(false, "vmaAllocateMemoryForBuffer failed: " << ToString(vkres));
             return ppx::ERROR_API_FAILURE;
         }
+
+        mMemorySize = mAllocationInfo.size;
     }
 
     // Bind memory
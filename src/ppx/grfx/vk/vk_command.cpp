@@ -67,6 +67,10 @@ Result CommandBuffer::Begin()
 {
     VkCommandBufferBeginInfo vkbi = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
 
+    // Barriers left from a command buffer that was never ended
+    mPendingImageBarriers.clear();
+    mPendingBufferBarriers.clear();
+
     VkResult vkres = vk::BeginCommandBuffer(mCommandBuffer, &vkbi);
     if (vkres != VK_SUCCESS) {
         PPX_ASSERT_MSG(false, "vkBeginCommandBuffer failed: " << ToString(vkres));
@@ -78,6 +82,8 @@ Result CommandBuffer::Begin()
 
 Result CommandBuffer::End()
 {
+    FlushBarriers();
+
     VkResult vkres = vk::EndCommandBuffer(mCommandBuffer);
     if (vkres != VK_SUCCESS) {
         PPX_ASSERT_MSG(false, "vkEndCommandBuffer failed: " << ToString(vkres));
@@ -114,6 +120,7 @@ void CommandBuffer::BeginRenderPassImpl(const grfx::RenderPassBeginInfo* pBeginI
     vkbi.clearValueCount       = clearValueCount;
     vkbi.pClearValues          = clearValues;
 
+    FlushBarriers();
     vk::CmdBeginRenderPass(mCommandBuffer, &vkbi, VK_SUBPASS_CONTENTS_INLINE);
 }
 
@@ -122,7 +129,121 @@ void CommandBuffer::EndRenderPassImpl()
     vk::CmdEndRenderPass(mCommandBuffer);
 }
 
-void CommandBuffer::TransitionImageLayout(
+void CommandBuffer::BeginRenderingImpl(const grfx::RenderingInfo* pRenderingInfo)
+{
+    vk::Device* pDevice = ToApi(GetDevice());
+
+    VkRect2D rect = {};
+    rect.offset   = {pRenderingInfo->renderArea.x, pRenderingInfo->renderArea.y};
+    rect.extent   = {pRenderingInfo->renderArea.width, pRenderingInfo->renderArea.height};
+
+    FlushBarriers();
+
+#if defined(VK_KHR_dynamic_rendering)
+    if (pDevice->DynamicRenderingSupported()) {
+        VkRenderingAttachmentInfoKHR colorAttachments[PPX_MAX_RENDER_TARGETS] = {};
+        for (uint32_t i = 0; i < pRenderingInfo->renderTargetCount; ++i) {
+            const grfx::RenderTargetView* pRTV = pRenderingInfo->pRenderTargetViews[i];
+
+            VkRenderingAttachmentInfoKHR& attachment = colorAttachments[i];
+            attachment.sType                         = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            attachment.imageView                     = ToApi(pRTV)->GetVkImageView();
+            attachment.imageLayout                   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            attachment.resolveMode                   = VK_RESOLVE_MODE_NONE;
+            attachment.loadOp                        = ToVkAttachmentLoadOp(pRTV->GetLoadOp());
+            attachment.storeOp                       = ToVkAttachmentStoreOp(pRTV->GetStoreOp());
+            attachment.clearValue.color              = ToVkClearColorValue(pRenderingInfo->RTVClearValues[i]);
+        }
+
+        VkRenderingAttachmentInfoKHR depthAttachment    = {VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR};
+        VkRenderingAttachmentInfoKHR stencilAttachment  = {VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR};
+        VkImageAspectFlags           depthStencilAspect = 0;
+
+        const grfx::DepthStencilView* pDSV = pRenderingInfo->pDepthStencilView;
+        if (!IsNull(pDSV)) {
+            VkPipelineStageFlags stageMask   = 0;
+            VkAccessFlags        accessMask  = 0;
+            VkImageLayout        imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            Result               ppxres      = ToVkBarrierDst(pRenderingInfo->depthStencilState, GetCommandType(), pDevice->GetDeviceFeatures(), stageMask, accessMask, imageLayout);
+            PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "failed to determine layout for depth stencil state");
+
+            depthStencilAspect = DetermineAspectMask(ToVkFormat(pDSV->GetFormat()));
+
+            depthAttachment.imageView               = ToApi(pDSV)->GetVkImageView();
+            depthAttachment.imageLayout             = imageLayout;
+            depthAttachment.resolveMode             = VK_RESOLVE_MODE_NONE;
+            depthAttachment.loadOp                  = ToVkAttachmentLoadOp(pDSV->GetDepthLoadOp());
+            depthAttachment.storeOp                 = ToVkAttachmentStoreOp(pDSV->GetDepthStoreOp());
+            depthAttachment.clearValue.depthStencil = ToVkClearDepthStencilValue(pRenderingInfo->DSVClearValue);
+
+            stencilAttachment         = depthAttachment;
+            stencilAttachment.loadOp  = ToVkAttachmentLoadOp(pDSV->GetStencilLoadOp());
+            stencilAttachment.storeOp = ToVkAttachmentStoreOp(pDSV->GetStencilStoreOp());
+        }
+
+        VkRenderingInfoKHR vkri   = {VK_STRUCTURE_TYPE_RENDERING_INFO_KHR};
+        vkri.renderArea           = rect;
+        vkri.layerCount           = 1;
+        vkri.colorAttachmentCount = pRenderingInfo->renderTargetCount;
+        vkri.pColorAttachments    = colorAttachments;
+        vkri.pDepthAttachment     = (depthStencilAspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? &depthAttachment : nullptr;
+        vkri.pStencilAttachment   = (depthStencilAspect & VK_IMAGE_ASPECT_STENCIL_BIT) ? &stencilAttachment : nullptr;
+
+        pDevice->CmdBeginRendering(mCommandBuffer, &vkri);
+        mDynamicRenderingActive = true;
+        return;
+    }
+#endif
+
+    // No dynamic rendering, use a render pass and framebuffer from the
+    // device's cache instead
+    VkRenderPass  renderPass  = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    Result        ppxres      = pDevice->GetCachedRenderPass(pRenderingInfo, &renderPass, &framebuffer);
+    if (Failed(ppxres)) {
+        PPX_ASSERT_MSG(false, "failed to get render pass for BeginRendering: " << ToString(ppxres));
+        return;
+    }
+
+    uint32_t     clearValueCount                         = 0;
+    VkClearValue clearValues[PPX_MAX_RENDER_TARGETS + 1] = {};
+
+    for (uint32_t i = 0; i < pRenderingInfo->renderTargetCount; ++i) {
+        clearValues[i].color = ToVkClearColorValue(pRenderingInfo->RTVClearValues[i]);
+        ++clearValueCount;
+    }
+
+    if (!IsNull(pRenderingInfo->pDepthStencilView)) {
+        uint32_t i                  = clearValueCount;
+        clearValues[i].depthStencil = ToVkClearDepthStencilValue(pRenderingInfo->DSVClearValue);
+        ++clearValueCount;
+    }
+
+    VkRenderPassBeginInfo vkbi = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    vkbi.renderPass            = renderPass;
+    vkbi.framebuffer           = framebuffer;
+    vkbi.renderArea            = rect;
+    vkbi.clearValueCount       = clearValueCount;
+    vkbi.pClearValues          = clearValues;
+
+    vk::CmdBeginRenderPass(mCommandBuffer, &vkbi, VK_SUBPASS_CONTENTS_INLINE);
+    mDynamicRenderingActive = false;
+}
+
+void CommandBuffer::EndRenderingImpl()
+{
+#if defined(VK_KHR_dynamic_rendering)
+    if (mDynamicRenderingActive) {
+        ToApi(GetDevice())->CmdEndRendering(mCommandBuffer);
+        mDynamicRenderingActive = false;
+        return;
+    }
+#endif
+
+    vk::CmdEndRenderPass(mCommandBuffer);
+}
+
+void CommandBuffer::TransitionImageLayoutImpl(
     const grfx::Image*  pImage,
     uint32_t            mipLevel,
     uint32_t            mipLevelCount,
@@ -168,13 +289,12 @@ void CommandBuffer::TransitionImageLayout(
 
     const vk::Image* pApiImage = ToApi(pImage);
 
-    VkPipelineStageFlags srcStageMask    = InvalidValue<VkPipelineStageFlags>();
-    VkPipelineStageFlags dstStageMask    = InvalidValue<VkPipelineStageFlags>();
-    VkAccessFlags        srcAccessMask   = InvalidValue<VkAccessFlags>();
-    VkAccessFlags        dstAccessMask   = InvalidValue<VkAccessFlags>();
-    VkImageLayout        oldLayout       = InvalidValue<VkImageLayout>();
-    VkImageLayout        newLayout       = InvalidValue<VkImageLayout>();
-    VkDependencyFlags    dependencyFlags = 0;
+    VkPipelineStageFlags srcStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkPipelineStageFlags dstStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkAccessFlags        srcAccessMask = InvalidValue<VkAccessFlags>();
+    VkAccessFlags        dstAccessMask = InvalidValue<VkAccessFlags>();
+    VkImageLayout        oldLayout     = InvalidValue<VkImageLayout>();
+    VkImageLayout        newLayout     = InvalidValue<VkImageLayout>();
 
     vk::Device* pDevice = ToApi(GetDevice());
 
@@ -198,34 +318,26 @@ void CommandBuffer::TransitionImageLayout(
         newLayout);
     PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get dst barrier data");
 
-    VkImageMemoryBarrier barrier            = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
-    barrier.srcAccessMask                   = srcAccessMask;
-    barrier.dstAccessMask                   = dstAccessMask;
-    barrier.oldLayout                       = oldLayout;
-    barrier.newLayout                       = newLayout;
-    barrier.srcQueueFamilyIndex             = srcQueueFamilyIndex;
-    barrier.dstQueueFamilyIndex             = dstQueueFamilyIndex;
-    barrier.image                           = pApiImage->GetVkImage();
-    barrier.subresourceRange.aspectMask     = pApiImage->GetVkImageAspectFlags();
-    barrier.subresourceRange.baseMipLevel   = mipLevel;
-    barrier.subresourceRange.levelCount     = mipLevelCount;
-    barrier.subresourceRange.baseArrayLayer = arrayLayer;
-    barrier.subresourceRange.layerCount     = arrayLayerCount;
+    PendingImageBarrier pending                     = {};
+    pending.srcStageMask                            = srcStageMask;
+    pending.dstStageMask                            = dstStageMask;
+    pending.barrier.srcAccessMask                   = srcAccessMask;
+    pending.barrier.dstAccessMask                   = dstAccessMask;
+    pending.barrier.oldLayout                       = oldLayout;
+    pending.barrier.newLayout                       = newLayout;
+    pending.barrier.srcQueueFamilyIndex             = srcQueueFamilyIndex;
+    pending.barrier.dstQueueFamilyIndex             = dstQueueFamilyIndex;
+    pending.barrier.image                           = pApiImage->GetVkImage();
+    pending.barrier.subresourceRange.aspectMask     = pApiImage->GetVkImageAspectFlags();
+    pending.barrier.subresourceRange.baseMipLevel   = mipLevel;
+    pending.barrier.subresourceRange.levelCount     = mipLevelCount;
+    pending.barrier.subresourceRange.baseArrayLayer = arrayLayer;
+    pending.barrier.subresourceRange.layerCount     = arrayLayerCount;
+
+    AddImageBarrier(pending);
+}
 
-    vk::CmdPipelineBarrier(
-        mCommandBuffer,  // commandBuffer
-        srcStageMask,    // srcStageMask
-        dstStageMask,    // dstStageMask
-        dependencyFlags, // dependencyFlags
-        0,               // memoryBarrierCount
-        nullptr,         // pMemoryBarriers
-        0,               // bufferMemoryBarrierCount
-        nullptr,         // pBufferMemoryBarriers
-        1,               // imageMemoryBarrierCount
-        &barrier);       // pImageMemoryBarriers);
-}
-
-void CommandBuffer::BufferResourceBarrier(
+void CommandBuffer::BufferResourceBarrierImpl(
     const grfx::Buffer* pBuffer,
     grfx::ResourceState beforeState,
     grfx::ResourceState afterState,
@@ -257,13 +369,12 @@ void CommandBuffer::BufferResourceBarrier(
         return;
     }
 
-    VkPipelineStageFlags srcStageMask    = InvalidValue<VkPipelineStageFlags>();
-    VkPipelineStageFlags dstStageMask    = InvalidValue<VkPipelineStageFlags>();
-    VkAccessFlags        srcAccessMask   = InvalidValue<VkAccessFlags>();
-    VkAccessFlags        dstAccessMask   = InvalidValue<VkAccessFlags>();
-    VkImageLayout        oldLayout       = InvalidValue<VkImageLayout>();
-    VkImageLayout        newLayout       = InvalidValue<VkImageLayout>();
-    VkDependencyFlags    dependencyFlags = 0;
+    VkPipelineStageFlags srcStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkPipelineStageFlags dstStageMask  = InvalidValue<VkPipelineStageFlags>();
+    VkAccessFlags        srcAccessMask = InvalidValue<VkAccessFlags>();
+    VkAccessFlags        dstAccessMask = InvalidValue<VkAccessFlags>();
+    VkImageLayout        oldLayout     = InvalidValue<VkImageLayout>();
+    VkImageLayout        newLayout     = InvalidValue<VkImageLayout>();
 
     vk::Device* pDevice = ToApi(GetDevice());
 
@@ -287,26 +398,169 @@ void CommandBuffer::BufferResourceBarrier(
         newLayout);
     PPX_ASSERT_MSG(ppxres == ppx::SUCCESS, "couldn't get dst barrier data");
 
-    VkBufferMemoryBarrier barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
-    barrier.srcAccessMask         = srcAccessMask;
-    barrier.dstAccessMask         = dstAccessMask;
-    barrier.srcQueueFamilyIndex   = srcQueueFamilyIndex;
-    barrier.dstQueueFamilyIndex   = dstQueueFamilyIndex;
-    barrier.buffer                = ToApi(pBuffer)->GetVkBuffer();
-    barrier.offset                = static_cast<VkDeviceSize>(0);
-    barrier.size                  = static_cast<VkDeviceSize>(pBuffer->GetSize());
-
-    vkCmdPipelineBarrier(
-        mCommandBuffer,  // commandBuffer
-        srcStageMask,    // srcStageMask
-        dstStageMask,    // dstStageMask
-        dependencyFlags, // dependencyFlags
-        0,               // memoryBarrierCount
-        nullptr,         // pMemoryBarriers
-        1,               // bufferMemoryBarrierCount
-        &barrier,        // pBufferMemoryBarriers
-        0,               // imageMemoryBarrierCount
-        nullptr);        // pImageMemoryBarriers);
+    PendingBufferBarrier pending        = {};
+    pending.srcStageMask                = srcStageMask;
+    pending.dstStageMask                = dstStageMask;
+    pending.barrier.srcAccessMask       = srcAccessMask;
+    pending.barrier.dstAccessMask       = dstAccessMask;
+    pending.barrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
+    pending.barrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
+    pending.barrier.buffer              = ToApi(pBuffer)->GetVkBuffer();
+    pending.barrier.offset              = static_cast<VkDeviceSize>(0);
+    pending.barrier.size                = static_cast<VkDeviceSize>(pBuffer->GetSize());
+
+    AddBufferBarrier(pending);
+}
+
+void CommandBuffer::AddImageBarrier(const PendingImageBarrier& pending)
+{
+    const VkImageMemoryBarrier& barrier = pending.barrier;
+
+    auto it = FindIf(
+        mPendingImageBarriers,
+        [&barrier](const PendingImageBarrier& elem) -> bool { return elem.barrier.image == barrier.image; });
+    if (it != std::end(mPendingImageBarriers)) {
+        VkImageMemoryBarrier& prev = it->barrier;
+
+        bool sameRange = (prev.subresourceRange.baseMipLevel == barrier.subresourceRange.baseMipLevel) &&
+                         (prev.subresourceRange.levelCount == barrier.subresourceRange.levelCount) &&
+                         (prev.subresourceRange.baseArrayLayer == barrier.subresourceRange.baseArrayLayer) &&
+                         (prev.subresourceRange.layerCount == barrier.subresourceRange.layerCount);
+        bool noTransfer = (prev.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED) &&
+                          (barrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED);
+
+        // Nothing is recorded between the two transitions so they collapse
+        // into one from the first's source to the second's destination. It's
+        // kept even if the layout ends up unchanged since it still orders the
+        // work before and after.
+        if (sameRange && noTransfer) {
+            if ((prev.oldLayout == barrier.newLayout) && GetDevice()->IsBarrierValidationEnabled()) {
+                PPX_LOG_WARN("image transition is undone before any command uses it");
+            }
+            it->dstStageMask   = pending.dstStageMask;
+            prev.dstAccessMask = barrier.dstAccessMask;
+            prev.newLayout     = barrier.newLayout;
+            return;
+        }
+
+        // Overlapping barriers in one call have no defined order
+        FlushBarriers();
+    }
+
+    mPendingImageBarriers.push_back(pending);
+}
+
+void CommandBuffer::AddBufferBarrier(const PendingBufferBarrier& pending)
+{
+    const VkBufferMemoryBarrier& barrier = pending.barrier;
+
+    auto it = FindIf(
+        mPendingBufferBarriers,
+        [&barrier](const PendingBufferBarrier& elem) -> bool { return elem.barrier.buffer == barrier.buffer; });
+    if (it != std::end(mPendingBufferBarriers)) {
+        VkBufferMemoryBarrier& prev = it->barrier;
+
+        bool noTransfer = (prev.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED) &&
+                          (barrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED);
+        if (noTransfer) {
+            it->dstStageMask   = pending.dstStageMask;
+            prev.dstAccessMask = barrier.dstAccessMask;
+            return;
+        }
+
+        FlushBarriers();
+    }
+
+    mPendingBufferBarriers.push_back(pending);
+}
+
+void CommandBuffer::FlushBarriers()
+{
+    if (mPendingImageBarriers.empty() && mPendingBufferBarriers.empty()) {
+        return;
+    }
+
+#if defined(VK_KHR_synchronization2)
+    vk::Device* pDevice = ToApi(GetDevice());
+    if (pDevice->HasSynchronization2()) {
+        // The synchronization2 flags keep the values of the original bits
+        mImageBarriers2.clear();
+        for (const PendingImageBarrier& pending : mPendingImageBarriers) {
+            VkImageMemoryBarrier2KHR barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR};
+            barrier.srcStageMask             = static_cast<VkPipelineStageFlags2KHR>(pending.srcStageMask);
+            barrier.srcAccessMask            = static_cast<VkAccessFlags2KHR>(pending.barrier.srcAccessMask);
+            barrier.dstStageMask             = static_cast<VkPipelineStageFlags2KHR>(pending.dstStageMask);
+            barrier.dstAccessMask            = static_cast<VkAccessFlags2KHR>(pending.barrier.dstAccessMask);
+            barrier.oldLayout                = pending.barrier.oldLayout;
+            barrier.newLayout                = pending.barrier.newLayout;
+            barrier.srcQueueFamilyIndex      = pending.barrier.srcQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex      = pending.barrier.dstQueueFamilyIndex;
+            barrier.image                    = pending.barrier.image;
+            barrier.subresourceRange         = pending.barrier.subresourceRange;
+            mImageBarriers2.push_back(barrier);
+        }
+
+        mBufferBarriers2.clear();
+        for (const PendingBufferBarrier& pending : mPendingBufferBarriers) {
+            VkBufferMemoryBarrier2KHR barrier = {VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR};
+            barrier.srcStageMask              = static_cast<VkPipelineStageFlags2KHR>(pending.srcStageMask);
+            barrier.srcAccessMask             = static_cast<VkAccessFlags2KHR>(pending.barrier.srcAccessMask);
+            barrier.dstStageMask              = static_cast<VkPipelineStageFlags2KHR>(pending.dstStageMask);
+            barrier.dstAccessMask             = static_cast<VkAccessFlags2KHR>(pending.barrier.dstAccessMask);
+            barrier.srcQueueFamilyIndex       = pending.barrier.srcQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex       = pending.barrier.dstQueueFamilyIndex;
+            barrier.buffer                    = pending.barrier.buffer;
+            barrier.offset                    = pending.barrier.offset;
+            barrier.size                      = pending.barrier.size;
+            mBufferBarriers2.push_back(barrier);
+        }
+
+        VkDependencyInfoKHR dependencyInfo      = {VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR};
+        dependencyInfo.bufferMemoryBarrierCount = CountU32(mBufferBarriers2);
+        dependencyInfo.pBufferMemoryBarriers    = DataPtr(mBufferBarriers2);
+        dependencyInfo.imageMemoryBarrierCount  = CountU32(mImageBarriers2);
+        dependencyInfo.pImageMemoryBarriers     = DataPtr(mImageBarriers2);
+
+        pDevice->CmdPipelineBarrier2(mCommandBuffer, &dependencyInfo);
+
+        mPendingImageBarriers.clear();
+        mPendingBufferBarriers.clear();
+        return;
+    }
+#endif
+
+    // Without synchronization2 all barriers share one set of stage masks
+    VkPipelineStageFlags srcStageMask = 0;
+    VkPipelineStageFlags dstStageMask = 0;
+
+    mImageBarriers.clear();
+    for (const PendingImageBarrier& pending : mPendingImageBarriers) {
+        srcStageMask |= pending.srcStageMask;
+        dstStageMask |= pending.dstStageMask;
+        mImageBarriers.push_back(pending.barrier);
+    }
+
+    mBufferBarriers.clear();
+    for (const PendingBufferBarrier& pending : mPendingBufferBarriers) {
+        srcStageMask |= pending.srcStageMask;
+        dstStageMask |= pending.dstStageMask;
+        mBufferBarriers.push_back(pending.barrier);
+    }
+
+    vk::CmdPipelineBarrier(
+        mCommandBuffer,            // commandBuffer
+        srcStageMask,              // srcStageMask
+        dstStageMask,              // dstStageMask
+        0,                         // dependencyFlags
+        0,                         // memoryBarrierCount
+        nullptr,                   // pMemoryBarriers
+        CountU32(mBufferBarriers), // bufferMemoryBarrierCount
+        DataPtr(mBufferBarriers),  // pBufferMemoryBarriers
+        CountU32(mImageBarriers),  // imageMemoryBarrierCount
+        DataPtr(mImageBarriers));  // pImageMemoryBarriers
+
+    mPendingImageBarriers.clear();
+    mPendingBufferBarriers.clear();
 }
 
 void CommandBuffer::SetViewports(uint32_t viewportCount, const grfx::Viewport* pViewports)
@@ -343,7 +597,9 @@ void CommandBuffer::BindDescriptorSets(
     VkPipelineBindPoint               bindPoint,
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
-    const grfx::DescriptorSet* const* ppSets)
+    const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets)
 {
     PPX_ASSERT_NULL_ARG(pInterface);
 
@@ -367,9 +623,12 @@ void CommandBuffer::BindDescriptorSets(
     if (setCount > 0) {
         // Get Vulkan handles
         VkDescriptorSet vkSets[PPX_MAX_BOUND_DESCRIPTOR_SETS] = {VK_NULL_HANDLE};
+        uint32_t        expectedDynamicOffsetCount            = 0;
         for (uint32_t i = 0; i < setCount; ++i) {
             vkSets[i] = ToApi(ppSets[i])->GetVkDescriptorSet();
+            expectedDynamicOffsetCount += ppSets[i]->GetLayout()->GetDynamicOffsetCount();
         }
+        PPX_ASSERT_MSG(dynamicOffsetCount == expectedDynamicOffsetCount, "dynamicOffsetCount (" << dynamicOffsetCount << ") does not match the number of dynamic bindings in the sets (" << expectedDynamicOffsetCount << ")");
 
         // If we have consecutive set numbers we can bind just once...
         if (pInterface->HasConsecutiveSetNumbers()) {
@@ -382,23 +641,27 @@ void CommandBuffer::BindDescriptorSets(
                 firstSet,                                 // firstSet
                 setCount,                                 // descriptorSetCount
                 vkSets,                                   // pDescriptorSets
-                0,                                        // dynamicOffsetCount
-                nullptr);                                 // pDynamicOffsets
+                dynamicOffsetCount,                       // dynamicOffsetCount
+                pDynamicOffsets);                         // pDynamicOffsets
         }
         // ...otherwise we get to bind a bunch of times
         else {
+            uint32_t dynamicOffsetIndex = 0;
             for (uint32_t i = 0; i < setCount; ++i) {
-                uint32_t firstSet = setNumbers[i];
+                uint32_t firstSet       = setNumbers[i];
+                uint32_t setOffsetCount = ppSets[i]->GetLayout()->GetDynamicOffsetCount();
 
                 vk::CmdBindDescriptorSets(
-                    mCommandBuffer,                           // commandBuffer
-                    bindPoint,                                // pipelineBindPoint
-                    ToApi(pInterface)->GetVkPipelineLayout(), // layout
-                    firstSet,                                 // firstSet
-                    1,                                        // descriptorSetCount
-                    &vkSets[i],                               // pDescriptorSets
-                    0,                                        // dynamicOffsetCount
-                    nullptr);                                 // pDynamicOffsets
+                    mCommandBuffer,                                                            // commandBuffer
+                    bindPoint,                                                                 // pipelineBindPoint
+                    ToApi(pInterface)->GetVkPipelineLayout(),                                  // layout
+                    firstSet,                                                                  // firstSet
+                    1,                                                                         // descriptorSetCount
+                    &vkSets[i],                                                                // pDescriptorSets
+                    setOffsetCount,                                                            // dynamicOffsetCount
+                    (setOffsetCount > 0) ? (pDynamicOffsets + dynamicOffsetIndex) : nullptr); // pDynamicOffsets
+
+                dynamicOffsetIndex += setOffsetCount;
             }
         }
     }
@@ -418,9 +681,11 @@ void CommandBuffer::BindDescriptorSets(
 void CommandBuffer::BindGraphicsDescriptorSets(
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
-    const grfx::DescriptorSet* const* ppSets)
+    const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets)
 {
-    BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pInterface, setCount, ppSets);
+    BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pInterface, setCount, ppSets, dynamicOffsetCount, pDynamicOffsets);
 }
 
 void CommandBuffer::BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline)
@@ -436,9 +701,11 @@ void CommandBuffer::BindGraphicsPipeline(const grfx::GraphicsPipeline* pPipeline
 void CommandBuffer::BindComputeDescriptorSets(
     const grfx::PipelineInterface*    pInterface,
     uint32_t                          setCount,
-    const grfx::DescriptorSet* const* ppSets)
+    const grfx::DescriptorSet* const* ppSets,
+    uint32_t                          dynamicOffsetCount,
+    const uint32_t*                   pDynamicOffsets)
 {
-    BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, pInterface, setCount, ppSets);
+    BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, pInterface, setCount, ppSets, dynamicOffsetCount, pDynamicOffsets);
 }
 
 void CommandBuffer::BindComputePipeline(const grfx::ComputePipeline* pPipeline)
@@ -490,6 +757,7 @@ void CommandBuffer::Draw(
     uint32_t firstVertex,
     uint32_t firstInstance)
 {
+    FlushBarriers();
     vkCmdDraw(mCommandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
@@ -500,14 +768,39 @@ void CommandBuffer::DrawIndexed(
     int32_t  vertexOffset,
     uint32_t firstInstance)
 {
+    FlushBarriers();
     vk::CmdDrawIndexed(mCommandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
+void CommandBuffer::DrawIndexedIndirect(
+    const grfx::Buffer* pArgBuffer,
+    uint64_t            offset,
+    uint32_t            drawCount,
+    uint32_t            stride)
+{
+    PPX_ASSERT_NULL_ARG(pArgBuffer);
+
+    FlushBarriers();
+
+    VkBuffer buffer = ToApi(pArgBuffer)->GetVkBuffer();
+
+    // Without multiDrawIndirect the draw count can only be 0 or 1
+    if (ToApi(GetDevice())->GetDeviceFeatures().multiDrawIndirect == VK_TRUE) {
+        vkCmdDrawIndexedIndirect(mCommandBuffer, buffer, static_cast<VkDeviceSize>(offset), drawCount, stride);
+        return;
+    }
+    for (uint32_t i = 0; i < drawCount; ++i) {
+        VkDeviceSize drawOffset = static_cast<VkDeviceSize>(offset + static_cast<uint64_t>(i) * stride);
+        vkCmdDrawIndexedIndirect(mCommandBuffer, buffer, drawOffset, 1, stride);
+    }
+}
+
 void CommandBuffer::Dispatch(
     uint32_t groupCountX,
     uint32_t groupCountY,
     uint32_t groupCountZ)
 {
+    FlushBarriers();
     vk::CmdDispatch(mCommandBuffer, groupCountX, groupCountY, groupCountZ);
 }
 
@@ -521,6 +814,7 @@ void CommandBuffer::CopyBufferToBuffer(
     region.dstOffset    = static_cast<VkDeviceSize>(pCopyInfo->dstBuffer.offset);
     region.size         = static_cast<VkDeviceSize>(pCopyInfo->size);
 
+    FlushBarriers();
     vkCmdCopyBuffer(
         mCommandBuffer,
         ToApi(pSrcBuffer)->GetVkBuffer(),
@@ -555,6 +849,7 @@ void CommandBuffer::CopyBufferToImage(
         regions[i].imageExtent.depth               = pCopyInfos[i].dstImage.depth;
     }
 
+    FlushBarriers();
     vkCmdCopyBufferToImage(
         mCommandBuffer,
         ToApi(pSrcBuffer)->GetVkBuffer(),
@@ -622,6 +917,7 @@ grfx::ImageToBufferOutputPitch CommandBuffer::CopyImageToBuffer(
         regions.push_back(region);
     }
 
+    FlushBarriers();
     vkCmdCopyImageToBuffer(
         mCommandBuffer,
         ToApi(pSrcImage)->GetVkImage(),
@@ -676,6 +972,7 @@ void CommandBuffer::CopyImageToImage(
         region.extent.height = pCopyInfo->extent.z;
     }
 
+    FlushBarriers();
     vkCmdCopyImage(
         mCommandBuffer,
         ToApi(pSrcImage)->GetVkImage(),
@@ -698,6 +995,7 @@ void CommandBuffer::BeginQuery(
         flags = VK_QUERY_CONTROL_PRECISE_BIT;
     }
 
+    FlushBarriers();
     vkCmdBeginQuery(
         mCommandBuffer,
         ToApi(pQuery)->GetVkQueryPool(),
@@ -712,6 +1010,7 @@ void CommandBuffer::EndQuery(
     PPX_ASSERT_NULL_ARG(pQuery);
     PPX_ASSERT_MSG(queryIndex <= pQuery->GetCount(), "invalid query index");
 
+    FlushBarriers();
     vkCmdEndQuery(
         mCommandBuffer,
         ToApi(pQuery)->GetVkQueryPool(),
@@ -724,6 +1023,8 @@ void CommandBuffer::WriteTimestamp(
     uint32_t            queryIndex)
 {
     PPX_ASSERT_MSG(queryIndex <= pQuery->GetCount(), "invalid query index");
+
+    FlushBarriers();
     vkCmdWriteTimestamp(
         mCommandBuffer,
         ToVkPipelineStage(pipelineStage),
@@ -738,6 +1039,7 @@ void CommandBuffer::ResolveQueryData(
 {
     PPX_ASSERT_MSG((startIndex + numQueries) <= pQuery->GetCount(), "invalid query index/number");
     const VkQueryResultFlags flags = VK_QUERY_RESULT_WAIT_BIT | VK_QUERY_RESULT_64_BIT;
+    FlushBarriers();
     vkCmdCopyQueryPoolResults(mCommandBuffer, ToApi(pQuery)->GetVkQueryPool(), startIndex, numQueries, ToApi(pQuery)->GetReadBackBuffer(), 0, ToApi(pQuery)->GetQueryTypeSize(), flags);
 }
 
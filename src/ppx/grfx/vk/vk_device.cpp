@@ -27,6 +27,8 @@
 #include "ppx/grfx/vk/vk_swapchain.h"
 #include "ppx/grfx/vk/vk_sync.h"
 
+#include "ppx/grfx/vk/vk_profiler_fn_wrapper.h"
+
 #define VMA_IMPLEMENTATION
 #include "vk_mem_alloc.h"
 #include <unordered_set>
@@ -35,6 +37,16 @@ namespace ppx {
 namespace grfx {
 namespace vk {
 
+namespace {
+
+template <typename T>
+void AppendToKey(std::string& key, const T& value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
 Result Device::ConfigureQueueInfo(const grfx::DeviceCreateInfo* pCreateInfo, std::vector<float>& queuePriorities, std::vector<VkDeviceQueueCreateInfo>& queueCreateInfos)
 {
     VkPhysicalDevicePtr gpu = ToApi(pCreateInfo->pGpu)->GetVkGpu();
@@ -148,8 +160,13 @@ Result Device::ConfigureExtensions(const grfx::DeviceCreateInfo* pCreateInfo)
         // Timeline semaphore - if present
         if (ElementExists(std::string(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME), mFoundExtensions)) {
             mExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            mHasTimelineSemaphore = true;
         }
     }
+    else {
+        // Timeline semaphore is core in Vulkan 1.2
+        mHasTimelineSemaphore = true;
+    }
 
 #if defined(PPX_VK_EXTENDED_DYNAMIC_STATE)
     if (ElementExists(std::string(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME), mFoundExtensions)) {
@@ -162,6 +179,12 @@ Result Device::ConfigureExtensions(const grfx::DeviceCreateInfo* pCreateInfo)
         mExtensions.push_back(VK_EXT_DEPTH_RANGE_UNRESTRICTED_EXTENSION_NAME);
     }
 
+    // Memory budget - if present
+    if (ElementExists(std::string(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME), mFoundExtensions)) {
+        mExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        mHasMemoryBudget = true;
+    }
+
     // Dynamic rendering - if present. It also requires
     // VK_KHR_depth_stencil_resolve and VK_KHR_create_renderpass2.
 #if defined(VK_KHR_dynamic_rendering)
@@ -175,6 +198,15 @@ Result Device::ConfigureExtensions(const grfx::DeviceCreateInfo* pCreateInfo)
     }
 #endif
 
+    // Synchronization2 - if present, barriers fall back to
+    // vkCmdPipelineBarrier without it.
+#if defined(VK_KHR_synchronization2)
+    if (ElementExists(std::string(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME), mFoundExtensions)) {
+        mExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        mHasSynchronization2 = true;
+    }
+#endif
+
     // Add additional extensions and uniquify
     AppendElements(pCreateInfo->vulkanExtensions, mExtensions);
     Unique(mExtensions);
@@ -206,6 +238,9 @@ Result Device::ConfigureFeatures(const grfx::DeviceCreateInfo* pCreateInfo, VkPh
     features.shaderStorageImageWriteWithoutFormat = foundFeatures.shaderStorageImageWriteWithoutFormat;
     features.shaderStorageImageMultisample        = foundFeatures.shaderStorageImageMultisample;
     features.samplerAnisotropy                    = foundFeatures.samplerAnisotropy;
+    features.multiDrawIndirect                    = foundFeatures.multiDrawIndirect;
+    // Material tables index texture arrays with per-draw constants.
+    features.shaderSampledImageArrayDynamicIndexing = foundFeatures.shaderSampledImageArrayDynamicIndexing;
 
     // Select between default or custom features.
     if (!IsNull(pCreateInfo->pVulkanDeviceFeatures)) {
@@ -309,6 +344,30 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
     }
 #endif
 
+    // VkPhysicalDeviceTimelineSemaphoreFeatures
+#ifndef VK_API_VERSION_1_2
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR};
+#else
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
+#endif
+
+    if (mHasTimelineSemaphore) {
+        timelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+        timelineSemaphoreFeatures.pNext             = queryResetFeatures.pNext;
+        queryResetFeatures.pNext                    = &timelineSemaphoreFeatures;
+    }
+
+    // VkPhysicalDeviceSynchronization2Features
+#if defined(VK_KHR_synchronization2)
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR};
+
+    if (mHasSynchronization2) {
+        synchronization2Features.synchronization2 = VK_TRUE;
+        synchronization2Features.pNext            = queryResetFeatures.pNext;
+        queryResetFeatures.pNext                  = &synchronization2Features;
+    }
+#endif
+
     // Get C strings
     std::vector<const char*> extensions = GetCStrings(mExtensions);
 
@@ -382,18 +441,47 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
     //
     // If this is a Vulkan 1.1 device:
     //   - Load vkResetQueryPoolEXT
-    //   - Enable timeline semaphore if extension was loaded
+    //   - Load the KHR timeline semaphore host functions if extension was loaded
     //
     if (GetInstance()->GetApi() == grfx::API_VK_1_1) {
         mFnResetQueryPoolEXT = (PFN_vkResetQueryPoolEXT)vkGetDeviceProcAddr(mDevice, "vkResetQueryPoolEXT");
         PPX_ASSERT_MSG(mFnResetQueryPoolEXT != nullptr, "failed to load vkResetQueryPoolEXT");
 
-        mHasTimelineSemaphore = ElementExists(std::string(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME), mExtensions);
+        if (mHasTimelineSemaphore) {
+            mFnWaitSemaphores           = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(mDevice, "vkWaitSemaphoresKHR");
+            mFnSignalSemaphore          = (PFN_vkSignalSemaphoreKHR)vkGetDeviceProcAddr(mDevice, "vkSignalSemaphoreKHR");
+            mFnGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(mDevice, "vkGetSemaphoreCounterValueKHR");
+        }
     }
     else {
-        mHasTimelineSemaphore = true;
+        mFnWaitSemaphores           = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(mDevice, "vkWaitSemaphores");
+        mFnSignalSemaphore          = (PFN_vkSignalSemaphoreKHR)vkGetDeviceProcAddr(mDevice, "vkSignalSemaphore");
+        mFnGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(mDevice, "vkGetSemaphoreCounterValue");
+    }
+    if (mHasTimelineSemaphore) {
+        PPX_ASSERT_MSG((mFnWaitSemaphores != nullptr) && (mFnSignalSemaphore != nullptr) && (mFnGetSemaphoreCounterValue != nullptr), "failed to load timeline semaphore functions");
     }
     PPX_LOG_INFO("Vulkan timeline semaphore is present: " << mHasTimelineSemaphore);
+    PPX_LOG_INFO("Vulkan memory budget is present: " << mHasMemoryBudget);
+
+#if defined(VK_KHR_synchronization2)
+    if (mHasSynchronization2) {
+        mFnCmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(mDevice, "vkCmdPipelineBarrier2KHR");
+        PPX_ASSERT_MSG(mFnCmdPipelineBarrier2 != nullptr, "failed to load vkCmdPipelineBarrier2KHR");
+        mFnQueueSubmit2 = (PFN_vkQueueSubmit2KHR)vkGetDeviceProcAddr(mDevice, "vkQueueSubmit2KHR");
+        PPX_ASSERT_MSG(mFnQueueSubmit2 != nullptr, "failed to load vkQueueSubmit2KHR");
+    }
+#endif
+    PPX_LOG_INFO("Vulkan synchronization2 is present: " << mHasSynchronization2);
+
+#if defined(VK_KHR_dynamic_rendering)
+    if (mHasDynamicRendering) {
+        mFnCmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(mDevice, "vkCmdBeginRenderingKHR");
+        mFnCmdEndRendering   = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(mDevice, "vkCmdEndRenderingKHR");
+        PPX_ASSERT_MSG((mFnCmdBeginRendering != nullptr) && (mFnCmdEndRendering != nullptr), "failed to load dynamic rendering functions");
+    }
+#endif
+    PPX_LOG_INFO("Vulkan dynamic rendering is present: " << mHasDynamicRendering);
 
 #if defined(PPX_VK_EXTENDED_DYNAMIC_STATE)
     mExtendedDynamicStateAvailable = ElementExists(std::string(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME), mFoundExtensions));
@@ -408,6 +496,12 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
         vmaCreateInfo.physicalDevice         = ToApi(pCreateInfo->pGpu)->GetVkGpu();
         vmaCreateInfo.device                 = mDevice;
         vmaCreateInfo.instance               = ToApi(GetInstance())->GetVkInstance();
+        vmaCreateInfo.vulkanApiVersion       = VK_API_VERSION_1_1;
+
+        // Heap budgets from the driver instead of VMA's own estimate
+        if (mHasMemoryBudget) {
+            vmaCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        }
 
         vkres = vmaCreateAllocator(&vmaCreateInfo, &mVmaAllocator);
         if (vkres != VK_SUCCESS) {
@@ -416,6 +510,21 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
         }
     }
 
+    // Pipeline cache, starts empty. Applications can fill it with
+    // LoadPipelineCacheData() from a previous run.
+    {
+        VkPipelineCacheCreateInfo vkci = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+        vkci.flags                     = 0;
+        vkci.initialDataSize           = 0;
+        vkci.pInitialData              = nullptr;
+
+        vkres = vkCreatePipelineCache(mDevice, &vkci, nullptr, &mPipelineCache);
+        if (vkres != VK_SUCCESS) {
+            PPX_ASSERT_MSG(false, "vkCreatePipelineCache failed: " << ToString(vkres));
+            return ppx::ERROR_API_FAILURE;
+        }
+    }
+
     // Create queues
     ppxres = CreateQueues(pCreateInfo);
     if (Failed(ppxres)) {
@@ -427,6 +536,26 @@ Result Device::CreateApiObjects(const grfx::DeviceCreateInfo* pCreateInfo)
 
 void Device::DestroyApiObjects()
 {
+    for (auto& elem : mFramebufferCache) {
+        vkDestroyFramebuffer(mDevice, elem.second.framebuffer, nullptr);
+    }
+    mFramebufferCache.clear();
+
+    for (auto& elem : mEvictedFramebuffers) {
+        vkDestroyFramebuffer(mDevice, elem.framebuffer, nullptr);
+    }
+    mEvictedFramebuffers.clear();
+
+    for (auto& elem : mRenderPassCache) {
+        vkDestroyRenderPass(mDevice, elem.second, nullptr);
+    }
+    mRenderPassCache.clear();
+
+    if (mPipelineCache) {
+        vkDestroyPipelineCache(mDevice, mPipelineCache, nullptr);
+        mPipelineCache.Reset();
+    }
+
     if (mVmaAllocator) {
         vmaDestroyAllocator(mVmaAllocator);
         mVmaAllocator.Reset();
@@ -669,6 +798,14 @@ Result Device::WaitIdle()
     if (vkres != VK_SUCCESS) {
         return ppx::ERROR_API_FAILURE;
     }
+
+    // Nothing can use the evicted framebuffers anymore
+    std::lock_guard<std::mutex> lock(mRenderPassCacheMutex);
+    for (auto& elem : mEvictedFramebuffers) {
+        vkDestroyFramebuffer(mDevice, elem.framebuffer, nullptr);
+    }
+    mEvictedFramebuffers.clear();
+
     return ppx::SUCCESS;
 }
 
@@ -682,6 +819,87 @@ bool Device::DynamicRenderingSupported() const
     return mHasDynamicRendering;
 }
 
+bool Device::TimelineSemaphoreSupported() const
+{
+    return mHasTimelineSemaphore;
+}
+
+Result Device::GetPipelineCacheData(std::vector<char>* pData) const
+{
+    PPX_ASSERT_NULL_ARG(pData);
+
+    size_t   size  = 0;
+    VkResult vkres = vkGetPipelineCacheData(mDevice, mPipelineCache, &size, nullptr);
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkGetPipelineCacheData failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    // Pipelines compiled between the two calls can make the data larger, in
+    // which case only what fits is written and VK_INCOMPLETE is returned.
+    // The truncated data is still a valid cache.
+    pData->resize(size);
+    vkres = vkGetPipelineCacheData(mDevice, mPipelineCache, &size, DataPtr(*pData));
+    if ((vkres != VK_SUCCESS) && (vkres != VK_INCOMPLETE)) {
+        PPX_ASSERT_MSG(false, "vkGetPipelineCacheData failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+    pData->resize(size);
+
+    return ppx::SUCCESS;
+}
+
+Result Device::LoadPipelineCacheData(const void* pData, size_t size)
+{
+    PPX_ASSERT_NULL_ARG(pData);
+
+    // Drivers are supposed to ignore data from another driver, but some
+    // crash on it, so the header is checked first.
+    VkPipelineCacheHeaderVersionOne header = {};
+    if (size < sizeof(header)) {
+        PPX_LOG_WARN("pipeline cache data is too small, ignored");
+        return ppx::ERROR_BAD_DATA_SOURCE;
+    }
+    memcpy(&header, pData, sizeof(header));
+
+    VkPhysicalDeviceProperties properties = {};
+    vkGetPhysicalDeviceProperties(ToApi(GetGpu())->GetVkGpu(), &properties);
+
+    bool compatible = (header.headerSize >= sizeof(header)) &&
+                      (header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+                      (header.vendorID == properties.vendorID) &&
+                      (header.deviceID == properties.deviceID) &&
+                      (memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+    if (!compatible) {
+        PPX_LOG_WARN("pipeline cache data is from another driver or GPU, ignored");
+        return ppx::ERROR_BAD_DATA_SOURCE;
+    }
+
+    // vkMergePipelineCaches needs exclusive access to the destination cache
+    WaitForPipelineCompiles();
+
+    VkPipelineCacheCreateInfo vkci = {VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    vkci.flags                     = 0;
+    vkci.initialDataSize           = size;
+    vkci.pInitialData              = pData;
+
+    VkPipelineCache loadedCache = VK_NULL_HANDLE;
+    VkResult        vkres       = vkCreatePipelineCache(mDevice, &vkci, nullptr, &loadedCache);
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkCreatePipelineCache failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    vkres = vkMergePipelineCaches(mDevice, mPipelineCache, 1, &loadedCache);
+    vkDestroyPipelineCache(mDevice, loadedCache, nullptr);
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkMergePipelineCaches failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
 bool Device::IndependentBlendingSupported() const
 {
     return mDeviceFeatures.independentBlend == VK_TRUE;
@@ -692,6 +910,11 @@ bool Device::FragmentStoresAndAtomicsSupported() const
     return mDeviceFeatures.fragmentStoresAndAtomics == VK_TRUE;
 }
 
+bool Device::SampledImageArrayDynamicIndexingSupported() const
+{
+    return mDeviceFeatures.shaderSampledImageArrayDynamicIndexing == VK_TRUE;
+}
+
 void Device::ResetQueryPoolEXT(
     VkQueryPool queryPool,
     uint32_t    firstQuery,
@@ -700,6 +923,221 @@ void Device::ResetQueryPoolEXT(
     mFnResetQueryPoolEXT(mDevice, queryPool, firstQuery, queryCount);
 }
 
+VkResult Device::WaitSemaphores(
+    const VkSemaphoreWaitInfoKHR* pWaitInfo,
+    uint64_t                      timeout) const
+{
+    return mFnWaitSemaphores(mDevice, pWaitInfo, timeout);
+}
+
+VkResult Device::SignalSemaphore(const VkSemaphoreSignalInfoKHR* pSignalInfo) const
+{
+    return mFnSignalSemaphore(mDevice, pSignalInfo);
+}
+
+#if defined(VK_KHR_synchronization2)
+void Device::CmdPipelineBarrier2(
+    VkCommandBuffer            commandBuffer,
+    const VkDependencyInfoKHR* pDependencyInfo) const
+{
+    vk::CmdPipelineBarrier2(mFnCmdPipelineBarrier2, commandBuffer, pDependencyInfo);
+}
+
+VkResult Device::QueueSubmit2(
+    VkQueue                 queue,
+    uint32_t                submitCount,
+    const VkSubmitInfo2KHR* pSubmits,
+    VkFence                 fence) const
+{
+    return vk::QueueSubmit2(mFnQueueSubmit2, queue, submitCount, pSubmits, fence);
+}
+#endif
+
+#if defined(VK_KHR_dynamic_rendering)
+void Device::CmdBeginRendering(
+    VkCommandBuffer           commandBuffer,
+    const VkRenderingInfoKHR* pRenderingInfo) const
+{
+    mFnCmdBeginRendering(commandBuffer, pRenderingInfo);
+}
+
+void Device::CmdEndRendering(VkCommandBuffer commandBuffer) const
+{
+    mFnCmdEndRendering(commandBuffer);
+}
+#endif
+
+Result Device::GetCachedRenderPass(
+    const grfx::RenderingInfo* pRenderingInfo,
+    VkRenderPass*              pRenderPass,
+    VkFramebuffer*             pFramebuffer)
+{
+    PPX_ASSERT_NULL_ARG(pRenderingInfo);
+    PPX_ASSERT_NULL_ARG(pRenderPass);
+    PPX_ASSERT_NULL_ARG(pFramebuffer);
+
+    const uint32_t                       renderTargetCount   = pRenderingInfo->renderTargetCount;
+    const grfx::RenderTargetView* const* ppRenderTargetViews = pRenderingInfo->pRenderTargetViews;
+    const grfx::DepthStencilView*        pDepthStencilView   = pRenderingInfo->pDepthStencilView;
+
+    // Render pass key, everything that goes into the attachment descriptions
+    std::string renderPassKey;
+    AppendToKey(renderPassKey, renderTargetCount);
+    for (uint32_t i = 0; i < renderTargetCount; ++i) {
+        AppendToKey(renderPassKey, ppRenderTargetViews[i]->GetFormat());
+        AppendToKey(renderPassKey, ppRenderTargetViews[i]->GetSampleCount());
+        AppendToKey(renderPassKey, ppRenderTargetViews[i]->GetLoadOp());
+        AppendToKey(renderPassKey, ppRenderTargetViews[i]->GetStoreOp());
+    }
+    if (!IsNull(pDepthStencilView)) {
+        AppendToKey(renderPassKey, pDepthStencilView->GetFormat());
+        AppendToKey(renderPassKey, pDepthStencilView->GetDepthLoadOp());
+        AppendToKey(renderPassKey, pDepthStencilView->GetDepthStoreOp());
+        AppendToKey(renderPassKey, pDepthStencilView->GetStencilLoadOp());
+        AppendToKey(renderPassKey, pDepthStencilView->GetStencilStoreOp());
+        AppendToKey(renderPassKey, pRenderingInfo->depthStencilState);
+    }
+
+    // The framebuffer covers the render area
+    uint32_t width  = static_cast<uint32_t>(pRenderingInfo->renderArea.x) + pRenderingInfo->renderArea.width;
+    uint32_t height = static_cast<uint32_t>(pRenderingInfo->renderArea.y) + pRenderingInfo->renderArea.height;
+
+    std::vector<VkImageView> imageViews;
+    for (uint32_t i = 0; i < renderTargetCount; ++i) {
+        imageViews.push_back(ToApi(ppRenderTargetViews[i])->GetVkImageView());
+    }
+    if (!IsNull(pDepthStencilView)) {
+        imageViews.push_back(ToApi(pDepthStencilView)->GetVkImageView());
+    }
+
+    std::lock_guard<std::mutex> lock(mRenderPassCacheMutex);
+
+    VkRenderPass renderPass   = VK_NULL_HANDLE;
+    auto         itRenderPass = mRenderPassCache.find(renderPassKey);
+    if (itRenderPass != mRenderPassCache.end()) {
+        renderPass = itRenderPass->second;
+    }
+    else {
+        Result ppxres = vk::CreateRenderPassForViews(
+            mDevice,
+            renderTargetCount,
+            ppRenderTargetViews,
+            pDepthStencilView,
+            pRenderingInfo->depthStencilState,
+            &renderPass);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        mRenderPassCache[renderPassKey] = renderPass;
+    }
+
+    // Framebuffer key, the render pass and the views it's created with
+    std::string framebufferKey;
+    AppendToKey(framebufferKey, renderPass);
+    AppendToKey(framebufferKey, width);
+    AppendToKey(framebufferKey, height);
+    for (VkImageView imageView : imageViews) {
+        AppendToKey(framebufferKey, imageView);
+    }
+
+    auto itFramebuffer = mFramebufferCache.find(framebufferKey);
+    if (itFramebuffer == mFramebufferCache.end()) {
+        CachedFramebuffer cached = {};
+        Result            ppxres = vk::CreateFramebufferForViews(
+            mDevice,
+            renderPass,
+            width,
+            height,
+            renderTargetCount,
+            ppRenderTargetViews,
+            pDepthStencilView,
+            &cached.framebuffer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        cached.imageViews = std::move(imageViews);
+        itFramebuffer     = mFramebufferCache.emplace(framebufferKey, std::move(cached)).first;
+    }
+
+    *pRenderPass  = renderPass;
+    *pFramebuffer = itFramebuffer->second.framebuffer;
+
+    return ppx::SUCCESS;
+}
+
+void Device::EvictCachedFramebuffers(VkImageView imageView)
+{
+    std::lock_guard<std::mutex> lock(mRenderPassCacheMutex);
+
+    for (auto it = mFramebufferCache.begin(); it != mFramebufferCache.end();) {
+        if (ElementExists(imageView, it->second.imageViews)) {
+            mEvictedFramebuffers.push_back({it->second.framebuffer, mPresentCount});
+            it = mFramebufferCache.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void Device::RetireFramebuffers(uint32_t frameLatency)
+{
+    std::lock_guard<std::mutex> lock(mRenderPassCacheMutex);
+
+    mPresentCount = mPresentCount + 1;
+
+    // Appended in eviction order, so the oldest ones are at the front
+    size_t retiredCount = 0;
+    for (auto& elem : mEvictedFramebuffers) {
+        if ((mPresentCount - elem.presentCount) < frameLatency) {
+            break;
+        }
+        vkDestroyFramebuffer(mDevice, elem.framebuffer, nullptr);
+        ++retiredCount;
+    }
+    mEvictedFramebuffers.erase(mEvictedFramebuffers.begin(), mEvictedFramebuffers.begin() + retiredCount);
+}
+
+Result Device::QueryMemoryStats(bool detailed, grfx::MemoryStats* pStats) const
+{
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties = nullptr;
+    vmaGetMemoryProperties(mVmaAllocator, &pMemoryProperties);
+
+    // VMA estimates the budget from the heap size if VK_EXT_memory_budget
+    // isn't enabled.
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+    vmaGetHeapBudgets(mVmaAllocator, budgets.data());
+
+    pStats->heaps.resize(pMemoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < pMemoryProperties->memoryHeapCount; ++i) {
+        const VmaBudget&       budget = budgets[i];
+        grfx::MemoryHeapStats& heap   = pStats->heaps[i];
+        heap.deviceLocal              = (pMemoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        heap.usage                    = budget.usage;
+        heap.budget                   = budget.budget;
+        heap.blockBytes               = budget.statistics.blockBytes;
+        heap.allocationBytes          = budget.statistics.allocationBytes;
+        heap.blockCount               = budget.statistics.blockCount;
+        heap.allocationCount          = budget.statistics.allocationCount;
+    }
+
+    if (detailed) {
+        VmaTotalStatistics totalStats = {};
+        vmaCalculateStatistics(mVmaAllocator, &totalStats);
+        pStats->unusedRangeCount   = totalStats.total.unusedRangeCount;
+        pStats->largestUnusedRange = totalStats.total.unusedRangeSizeMax;
+    }
+
+    return ppx::SUCCESS;
+}
+
+VkResult Device::GetSemaphoreCounterValue(
+    VkSemaphore semaphore,
+    uint64_t*   pValue) const
+{
+    return mFnGetSemaphoreCounterValue(mDevice, semaphore, pValue);
+}
+
 } // namespace vk
 } // namespace grfx
 } // namespace ppx
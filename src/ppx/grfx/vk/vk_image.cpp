@@ -106,6 +106,8 @@ Result Image::CreateApiObjects(const grfx::ImageCreateInfo* pCreateInfo)
                 PPX_ASSERT_MSG(false, "vmaAllocateMemoryForImage failed: " << ToString(vkres));
                 return ppx::ERROR_API_FAILURE;
             }
+
+            mMemorySize = mAllocationInfo.size;
         }
 
         // Bind memory
@@ -301,6 +303,9 @@ Result DepthStencilView::CreateApiObjects(const grfx::DepthStencilViewCreateInfo
 void DepthStencilView::DestroyApiObjects()
 {
     if (mImageView) {
+        // Framebuffers cached for CommandBuffer::BeginRendering()
+        ToApi(GetDevice())->EvictCachedFramebuffers(mImageView);
+
         vkDestroyImageView(
             ToApi(GetDevice())->GetVkDevice(),
             mImageView,
@@ -349,6 +354,9 @@ Result RenderTargetView::CreateApiObjects(const grfx::RenderTargetViewCreateInfo
 void RenderTargetView::DestroyApiObjects()
 {
     if (mImageView) {
+        // Framebuffers cached for CommandBuffer::BeginRendering()
+        ToApi(GetDevice())->EvictCachedFramebuffers(mImageView);
+
         vkDestroyImageView(
             ToApi(GetDevice())->GetVkDevice(),
             mImageView,
@@ -43,7 +43,7 @@ Result ComputePipeline::CreateApiObjects(const grfx::ComputePipelineCreateInfo*
 
     VkResult vkres = vkCreateComputePipelines(
         ToApi(GetDevice())->GetVkDevice(),
-        VK_NULL_HANDLE,
+        ToApi(GetDevice())->GetVkPipelineCache(),
         1,
         &vkci,
         nullptr,
@@ -478,10 +478,37 @@ Result GraphicsPipeline::CreateApiObjects(const grfx::GraphicsPipelineCreateInfo
         return ppxres;
     }
 
+    // Pipelines for dynamic rendering describe their attachments with
+    // VkPipelineRenderingCreateInfo instead of a render pass. Without
+    // dynamic rendering, CommandBuffer::BeginRendering() uses render
+    // passes compatible with the temporary render pass below.
+    //
+    bool useDynamicRendering = pCreateInfo->outputState.dynamicRendering && GetDevice()->DynamicRenderingSupported();
+#if defined(VK_KHR_dynamic_rendering)
+    std::vector<VkFormat>            colorAttachmentFormats;
+    VkPipelineRenderingCreateInfoKHR renderingCreateInfo = {VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR};
+    if (useDynamicRendering) {
+        for (uint32_t i = 0; i < pCreateInfo->outputState.renderTargetCount; ++i) {
+            colorAttachmentFormats.push_back(ToVkFormat(pCreateInfo->outputState.renderTargetFormats[i]));
+        }
+
+        VkFormat           depthStencilFormat = ToVkFormat(pCreateInfo->outputState.depthStencilFormat);
+        VkImageAspectFlags depthStencilAspect = (depthStencilFormat != VK_FORMAT_UNDEFINED) ? DetermineAspectMask(depthStencilFormat) : 0;
+
+        renderingCreateInfo.colorAttachmentCount    = CountU32(colorAttachmentFormats);
+        renderingCreateInfo.pColorAttachmentFormats = DataPtr(colorAttachmentFormats);
+        renderingCreateInfo.depthAttachmentFormat   = (depthStencilAspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? depthStencilFormat : VK_FORMAT_UNDEFINED;
+        renderingCreateInfo.stencilAttachmentFormat = (depthStencilAspect & VK_IMAGE_ASPECT_STENCIL_BIT) ? depthStencilFormat : VK_FORMAT_UNDEFINED;
+        vkci.pNext                                  = &renderingCreateInfo;
+    }
+#else
+    useDynamicRendering = false;
+#endif
+
     // Create temporary render pass
     //
     VkRenderPassPtr renderPass = VK_NULL_HANDLE;
-    {
+    if (!useDynamicRendering) {
         std::vector<VkFormat> renderTargetFormats;
         for (uint32_t i = 0; i < pCreateInfo->outputState.renderTargetCount; ++i) {
             renderTargetFormats.push_back(ToVkFormat(pCreateInfo->outputState.renderTargetFormats[i]));
@@ -523,7 +550,7 @@ Result GraphicsPipeline::CreateApiObjects(const grfx::GraphicsPipelineCreateInfo
 
     VkResult vkres = vkCreateGraphicsPipelines(
         ToApi(GetDevice())->GetVkDevice(),
-        VK_NULL_HANDLE,
+        ToApi(GetDevice())->GetVkPipelineCache(),
         1,
         &vkci,
         nullptr,
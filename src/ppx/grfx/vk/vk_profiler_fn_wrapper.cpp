@@ -31,9 +31,11 @@ static ProfilerEventToken s_vkFreeDescriptorSets     = 0;
 static ProfilerEventToken s_vkUpdateDescriptorSets   = 0;
 static ProfilerEventToken s_vkQueuePresent           = 0;
 static ProfilerEventToken s_vkQueueSubmit            = 0;
+static ProfilerEventToken s_vkQueueSubmit2KHR        = 0;
 static ProfilerEventToken s_vkBeginCommandBuffer     = 0;
 static ProfilerEventToken s_vkEndCommandBuffer       = 0;
 static ProfilerEventToken s_vkCmdPipelineBarrier     = 0;
+static ProfilerEventToken s_vkCmdPipelineBarrier2KHR = 0;
 static ProfilerEventToken s_vkCmdBeginRenderPass     = 0;
 static ProfilerEventToken s_vkCmdEndRenderPass       = 0;
 static ProfilerEventToken s_vkCmdBindDescriptorSets  = 0;
@@ -60,9 +62,11 @@ void RegisterProfilerFunctions()
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkUpdateDescriptorSets)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkQueuePresent)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkQueueSubmit)));
+    PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkQueueSubmit2KHR)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkBeginCommandBuffer)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkEndCommandBuffer)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkCmdPipelineBarrier)));
+    PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkCmdPipelineBarrier2KHR)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkCmdBeginRenderPass)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkCmdEndRenderPass)));
     PPX_CHECKED_CALL(Profiler::RegisterGrfxApiFnEvent(REGISTER_EVENT_PARAMS(vkCmdBindDescriptorSets)));
@@ -195,6 +199,19 @@ VkResult QueueSubmit(
     return vkQueueSubmit(queue, submitCount, pSubmits, fence);
 }
 
+#if defined(VK_KHR_synchronization2)
+VkResult QueueSubmit2(
+    PFN_vkQueueSubmit2KHR   pfnQueueSubmit2,
+    VkQueue                 queue,
+    uint32_t                submitCount,
+    const VkSubmitInfo2KHR* pSubmits,
+    VkFence                 fence)
+{
+    ProfilerScopedEventSample eventSample(s_vkQueueSubmit2KHR);
+    return pfnQueueSubmit2(queue, submitCount, pSubmits, fence);
+}
+#endif
+
 VkResult BeginCommandBuffer(
     VkCommandBuffer                 commandBuffer,
     const VkCommandBufferBeginInfo* pBeginInfo)
@@ -226,6 +243,17 @@ void CmdPipelineBarrier(
     vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
 }
 
+#if defined(VK_KHR_synchronization2)
+void CmdPipelineBarrier2(
+    PFN_vkCmdPipelineBarrier2KHR pfnCmdPipelineBarrier2,
+    VkCommandBuffer              commandBuffer,
+    const VkDependencyInfoKHR*   pDependencyInfo)
+{
+    ProfilerScopedEventSample eventSample(s_vkCmdPipelineBarrier2KHR);
+    pfnCmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+}
+#endif
+
 void CmdBeginRenderPass(
     VkCommandBuffer              commandBuffer,
     const VkRenderPassBeginInfo* pRenderPassBegin,
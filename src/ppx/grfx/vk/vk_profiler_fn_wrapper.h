@@ -94,6 +94,16 @@ VkResult QueueSubmit(
     const VkSubmitInfo* pSubmits,
     VkFence             fence);
 
+#if defined(VK_KHR_synchronization2)
+// Extension function, the caller passes the loaded entry point
+VkResult QueueSubmit2(
+    PFN_vkQueueSubmit2KHR   pfnQueueSubmit2,
+    VkQueue                 queue,
+    uint32_t                submitCount,
+    const VkSubmitInfo2KHR* pSubmits,
+    VkFence                 fence);
+#endif
+
 VkResult BeginCommandBuffer(
     VkCommandBuffer                 commandBuffer,
     const VkCommandBufferBeginInfo* pBeginInfo);
@@ -113,6 +123,14 @@ void CmdPipelineBarrier(
     uint32_t                     imageMemoryBarrierCount,
     const VkImageMemoryBarrier*  pImageMemoryBarriers);
 
+#if defined(VK_KHR_synchronization2)
+// Extension function, the caller passes the loaded entry point
+void CmdPipelineBarrier2(
+    PFN_vkCmdPipelineBarrier2KHR pfnCmdPipelineBarrier2,
+    VkCommandBuffer              commandBuffer,
+    const VkDependencyInfoKHR*   pDependencyInfo);
+#endif
+
 void CmdBeginRenderPass(
     VkCommandBuffer              commandBuffer,
     const VkRenderPassBeginInfo* pRenderPassBegin,
@@ -277,6 +295,18 @@ inline VkResult QueueSubmit(
     return vkQueueSubmit(queue, submitCount, pSubmits, fence);
 }
 
+#if defined(VK_KHR_synchronization2)
+inline VkResult QueueSubmit2(
+    PFN_vkQueueSubmit2KHR   pfnQueueSubmit2,
+    VkQueue                 queue,
+    uint32_t                submitCount,
+    const VkSubmitInfo2KHR* pSubmits,
+    VkFence                 fence)
+{
+    return pfnQueueSubmit2(queue, submitCount, pSubmits, fence);
+}
+#endif
+
 inline VkResult BeginCommandBuffer(
     VkCommandBuffer                 commandBuffer,
     const VkCommandBufferBeginInfo* pBeginInfo)
@@ -305,6 +335,16 @@ inline void CmdPipelineBarrier(
     vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
 }
 
+#if defined(VK_KHR_synchronization2)
+inline void CmdPipelineBarrier2(
+    PFN_vkCmdPipelineBarrier2KHR pfnCmdPipelineBarrier2,
+    VkCommandBuffer              commandBuffer,
+    const VkDependencyInfoKHR*   pDependencyInfo)
+{
+    pfnCmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+}
+#endif
+
 inline void CmdBeginRenderPass(
     VkCommandBuffer              commandBuffer,
     const VkRenderPassBeginInfo* pRenderPassBegin,
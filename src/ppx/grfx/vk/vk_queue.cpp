@@ -79,45 +79,203 @@ Result Queue::WaitIdle()
 
 Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
 {
-    // Command buffers
-    std::vector<VkCommandBuffer> commandBuffers;
-    for (uint32_t i = 0; i < pSubmitInfo->commandBufferCount; ++i) {
-        commandBuffers.push_back(ToApi(pSubmitInfo->ppCommandBuffers[i])->GetVkCommandBuffer());
-    }
+    return Submit(1, pSubmitInfo);
+}
 
-    // Wait semaphores
-    std::vector<VkSemaphore>          waitSemaphores;
-    std::vector<VkPipelineStageFlags> waitDstStageMasks;
-    for (uint32_t i = 0; i < pSubmitInfo->waitSemaphoreCount; ++i) {
-        waitSemaphores.push_back(ToApi(pSubmitInfo->ppWaitSemaphores[i])->GetVkSemaphore());
-        waitDstStageMasks.push_back(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+Result Queue::Submit(uint32_t submitCount, const grfx::SubmitInfo* pSubmitInfos)
+{
+    if (submitCount == 0) {
+        return ppx::SUCCESS;
     }
 
-    // Signal semaphores
-    std::vector<VkSemaphore> signalSemaphores;
-    for (uint32_t i = 0; i < pSubmitInfo->signalSemaphoreCount; ++i) {
-        signalSemaphores.push_back(ToApi(pSubmitInfo->ppSignalSemaphores[i])->GetVkSemaphore());
+    // Size the scratch arrays up front so the pointers stored in the
+    // VkSubmitInfos stay valid while they're being filled
+    uint32_t commandBufferCount   = 0;
+    uint32_t waitSemaphoreCount   = 0;
+    uint32_t signalSemaphoreCount = 0;
+    for (uint32_t i = 0; i < submitCount; ++i) {
+        if (!IsNull(pSubmitInfos[i].pFence) && ((i + 1) < submitCount)) {
+            PPX_ASSERT_MSG(false, "only the last submit info in a batch can have a fence");
+            return ppx::ERROR_FAILED;
+        }
+        // Both submit paths would otherwise wait on or signal value 0
+        if (IsNull(pSubmitInfos[i].pWaitValues)) {
+            for (uint32_t j = 0; j < pSubmitInfos[i].waitSemaphoreCount; ++j) {
+                if (pSubmitInfos[i].ppWaitSemaphores[j]->IsTimeline()) {
+                    PPX_ASSERT_MSG(false, "timeline semaphore wait requires SubmitInfo::pWaitValues");
+                    return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+                }
+            }
+        }
+        if (IsNull(pSubmitInfos[i].pSignalValues)) {
+            for (uint32_t j = 0; j < pSubmitInfos[i].signalSemaphoreCount; ++j) {
+                if (pSubmitInfos[i].ppSignalSemaphores[j]->IsTimeline()) {
+                    PPX_ASSERT_MSG(false, "timeline semaphore signal requires SubmitInfo::pSignalValues");
+                    return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+                }
+            }
+        }
+        commandBufferCount += pSubmitInfos[i].commandBufferCount;
+        waitSemaphoreCount += pSubmitInfos[i].waitSemaphoreCount;
+        signalSemaphoreCount += pSubmitInfos[i].signalSemaphoreCount;
     }
 
-    VkSubmitInfo vksi         = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    vksi.waitSemaphoreCount   = CountU32(waitSemaphores);
-    vksi.pWaitSemaphores      = DataPtr(waitSemaphores);
-    vksi.pWaitDstStageMask    = DataPtr(waitDstStageMasks);
-    vksi.commandBufferCount   = CountU32(commandBuffers);
-    vksi.pCommandBuffers      = DataPtr(commandBuffers);
-    vksi.signalSemaphoreCount = CountU32(signalSemaphores);
-    vksi.pSignalSemaphores    = DataPtr(signalSemaphores);
+#if defined(VK_KHR_synchronization2)
+    if (ToApi(GetDevice())->HasSynchronization2()) {
+        return Submit2(submitCount, pSubmitInfos, commandBufferCount, waitSemaphoreCount, signalSemaphoreCount);
+    }
+#endif
+
+    mSubmitInfos.resize(submitCount);
+    mTimelineInfos.resize(submitCount);
+    mCommandBuffers.resize(commandBufferCount);
+    mWaitSemaphores.resize(waitSemaphoreCount);
+    mWaitDstStageMasks.resize(waitSemaphoreCount);
+    mSignalSemaphores.resize(signalSemaphoreCount);
+
+    VkCommandBuffer*      pCommandBuffers    = DataPtr(mCommandBuffers);
+    VkSemaphore*          pWaitSemaphores    = DataPtr(mWaitSemaphores);
+    VkPipelineStageFlags* pWaitDstStageMasks = DataPtr(mWaitDstStageMasks);
+    VkSemaphore*          pSignalSemaphores  = DataPtr(mSignalSemaphores);
+
+    for (uint32_t i = 0; i < submitCount; ++i) {
+        const grfx::SubmitInfo& submitInfo = pSubmitInfos[i];
+
+        // Command buffers
+        for (uint32_t j = 0; j < submitInfo.commandBufferCount; ++j) {
+            pCommandBuffers[j] = ToApi(submitInfo.ppCommandBuffers[j])->GetVkCommandBuffer();
+        }
+
+        // Wait semaphores
+        for (uint32_t j = 0; j < submitInfo.waitSemaphoreCount; ++j) {
+            const grfx::Semaphore* pSemaphore = submitInfo.ppWaitSemaphores[j];
+            pWaitSemaphores[j]                = ToApi(pSemaphore)->GetVkSemaphore();
+            // Timeline waits order work between queues, so all commands must wait
+            pWaitDstStageMasks[j] = pSemaphore->IsTimeline() ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        }
+
+        // Signal semaphores
+        for (uint32_t j = 0; j < submitInfo.signalSemaphoreCount; ++j) {
+            pSignalSemaphores[j] = ToApi(submitInfo.ppSignalSemaphores[j])->GetVkSemaphore();
+        }
+
+        // Timeline values - binary semaphores ignore theirs
+        VkTimelineSemaphoreSubmitInfoKHR& timelineInfo = mTimelineInfos[i];
+        timelineInfo                                   = {VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR};
+        timelineInfo.waitSemaphoreValueCount           = IsNull(submitInfo.pWaitValues) ? 0 : submitInfo.waitSemaphoreCount;
+        timelineInfo.pWaitSemaphoreValues              = submitInfo.pWaitValues;
+        timelineInfo.signalSemaphoreValueCount         = IsNull(submitInfo.pSignalValues) ? 0 : submitInfo.signalSemaphoreCount;
+        timelineInfo.pSignalSemaphoreValues            = submitInfo.pSignalValues;
+
+        const bool hasTimelineValues = (timelineInfo.waitSemaphoreValueCount > 0) || (timelineInfo.signalSemaphoreValueCount > 0);
+
+        VkSubmitInfo& vksi        = mSubmitInfos[i];
+        vksi                      = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        vksi.pNext                = hasTimelineValues ? &timelineInfo : nullptr;
+        vksi.waitSemaphoreCount   = submitInfo.waitSemaphoreCount;
+        vksi.pWaitSemaphores      = pWaitSemaphores;
+        vksi.pWaitDstStageMask    = pWaitDstStageMasks;
+        vksi.commandBufferCount   = submitInfo.commandBufferCount;
+        vksi.pCommandBuffers      = pCommandBuffers;
+        vksi.signalSemaphoreCount = submitInfo.signalSemaphoreCount;
+        vksi.pSignalSemaphores    = pSignalSemaphores;
+
+        pCommandBuffers += submitInfo.commandBufferCount;
+        pWaitSemaphores += submitInfo.waitSemaphoreCount;
+        pWaitDstStageMasks += submitInfo.waitSemaphoreCount;
+        pSignalSemaphores += submitInfo.signalSemaphoreCount;
+    }
 
     // Fence
     VkFence fence = VK_NULL_HANDLE;
-    if (!IsNull(pSubmitInfo->pFence)) {
-        fence = ToApi(pSubmitInfo->pFence)->GetVkFence();
+    if (!IsNull(pSubmitInfos[submitCount - 1].pFence)) {
+        fence = ToApi(pSubmitInfos[submitCount - 1].pFence)->GetVkFence();
     }
 
     VkResult vkres = vk::QueueSubmit(
         mQueue,
-        1,
-        &vksi,
+        submitCount,
+        DataPtr(mSubmitInfos),
+        fence);
+    if (vkres != VK_SUCCESS) {
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
+#if defined(VK_KHR_synchronization2)
+Result Queue::Submit2(
+    uint32_t                submitCount,
+    const grfx::SubmitInfo* pSubmitInfos,
+    uint32_t                commandBufferCount,
+    uint32_t                waitSemaphoreCount,
+    uint32_t                signalSemaphoreCount)
+{
+    mSubmitInfos2.resize(submitCount);
+    mCommandBufferInfos.resize(commandBufferCount);
+    mWaitSemaphoreInfos.resize(waitSemaphoreCount);
+    mSignalSemaphoreInfos.resize(signalSemaphoreCount);
+
+    VkCommandBufferSubmitInfoKHR* pCommandBufferInfos   = DataPtr(mCommandBufferInfos);
+    VkSemaphoreSubmitInfoKHR*     pWaitSemaphoreInfos   = DataPtr(mWaitSemaphoreInfos);
+    VkSemaphoreSubmitInfoKHR*     pSignalSemaphoreInfos = DataPtr(mSignalSemaphoreInfos);
+
+    for (uint32_t i = 0; i < submitCount; ++i) {
+        const grfx::SubmitInfo& submitInfo = pSubmitInfos[i];
+
+        // Command buffers
+        for (uint32_t j = 0; j < submitInfo.commandBufferCount; ++j) {
+            VkCommandBufferSubmitInfoKHR& info = pCommandBufferInfos[j];
+            info                               = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR};
+            info.commandBuffer                 = ToApi(submitInfo.ppCommandBuffers[j])->GetVkCommandBuffer();
+        }
+
+        // Wait semaphores - timeline values go in each semaphore's info
+        // instead of a chained VkTimelineSemaphoreSubmitInfo.
+        for (uint32_t j = 0; j < submitInfo.waitSemaphoreCount; ++j) {
+            const grfx::Semaphore*    pSemaphore = submitInfo.ppWaitSemaphores[j];
+            VkSemaphoreSubmitInfoKHR& info       = pWaitSemaphoreInfos[j];
+            info                                 = {VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+            info.semaphore                       = ToApi(pSemaphore)->GetVkSemaphore();
+            info.value                           = IsNull(submitInfo.pWaitValues) ? 0 : submitInfo.pWaitValues[j];
+            // Same stages as the vkQueueSubmit path
+            info.stageMask = pSemaphore->IsTimeline() ? VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR : VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT_KHR;
+        }
+
+        // Signal semaphores
+        for (uint32_t j = 0; j < submitInfo.signalSemaphoreCount; ++j) {
+            VkSemaphoreSubmitInfoKHR& info = pSignalSemaphoreInfos[j];
+            info                           = {VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR};
+            info.semaphore                 = ToApi(submitInfo.ppSignalSemaphores[j])->GetVkSemaphore();
+            info.value                     = IsNull(submitInfo.pSignalValues) ? 0 : submitInfo.pSignalValues[j];
+            info.stageMask                 = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT_KHR;
+        }
+
+        VkSubmitInfo2KHR& vksi        = mSubmitInfos2[i];
+        vksi                          = {VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR};
+        vksi.waitSemaphoreInfoCount   = submitInfo.waitSemaphoreCount;
+        vksi.pWaitSemaphoreInfos      = pWaitSemaphoreInfos;
+        vksi.commandBufferInfoCount   = submitInfo.commandBufferCount;
+        vksi.pCommandBufferInfos      = pCommandBufferInfos;
+        vksi.signalSemaphoreInfoCount = submitInfo.signalSemaphoreCount;
+        vksi.pSignalSemaphoreInfos    = pSignalSemaphoreInfos;
+
+        pCommandBufferInfos += submitInfo.commandBufferCount;
+        pWaitSemaphoreInfos += submitInfo.waitSemaphoreCount;
+        pSignalSemaphoreInfos += submitInfo.signalSemaphoreCount;
+    }
+
+    // Fence
+    VkFence fence = VK_NULL_HANDLE;
+    if (!IsNull(pSubmitInfos[submitCount - 1].pFence)) {
+        fence = ToApi(pSubmitInfos[submitCount - 1].pFence)->GetVkFence();
+    }
+
+    VkResult vkres = ToApi(GetDevice())->QueueSubmit2(
+        mQueue,
+        submitCount,
+        DataPtr(mSubmitInfos2),
         fence);
     if (vkres != VK_SUCCESS) {
         return ppx::ERROR_API_FAILURE;
@@ -125,6 +283,7 @@ Result Queue::Submit(const grfx::SubmitInfo* pSubmitInfo)
 
     return ppx::SUCCESS;
 }
+#endif
 
 Result Queue::GetTimestampFrequency(uint64_t* pFrequency) const
 {
@@ -25,8 +25,83 @@ namespace vk {
 
 Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo* pCreateInfo)
 {
-    bool          hasDepthSencil     = mDepthStencilView ? true : false;
-    size_t        rtvCount           = CountU32(mRenderTargetViews);
+    std::vector<const grfx::RenderTargetView*> renderTargetViews;
+    for (const grfx::RenderTargetViewPtr& rtv : mRenderTargetViews) {
+        renderTargetViews.push_back(rtv.Get());
+    }
+
+    return vk::CreateRenderPassForViews(
+        ToApi(GetDevice())->GetVkDevice(),
+        CountU32(renderTargetViews),
+        DataPtr(renderTargetViews),
+        mDepthStencilView.Get(),
+        pCreateInfo->depthStencilState,
+        &mRenderPass);
+}
+
+Result RenderPass::CreateFramebuffer(const grfx::internal::RenderPassCreateInfo* pCreateInfo)
+{
+    std::vector<const grfx::RenderTargetView*> renderTargetViews;
+    for (const grfx::RenderTargetViewPtr& rtv : mRenderTargetViews) {
+        renderTargetViews.push_back(rtv.Get());
+    }
+
+    return vk::CreateFramebufferForViews(
+        ToApi(GetDevice())->GetVkDevice(),
+        mRenderPass,
+        pCreateInfo->width,
+        pCreateInfo->height,
+        CountU32(renderTargetViews),
+        DataPtr(renderTargetViews),
+        mDepthStencilView.Get(),
+        &mFramebuffer);
+}
+
+Result RenderPass::CreateApiObjects(const grfx::internal::RenderPassCreateInfo* pCreateInfo)
+{
+    Result ppxres = CreateRenderPass(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    ppxres = CreateFramebuffer(pCreateInfo);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    return ppx::SUCCESS;
+}
+
+void RenderPass::DestroyApiObjects()
+{
+    if (mFramebuffer) {
+        vkDestroyFramebuffer(
+            ToApi(GetDevice())->GetVkDevice(),
+            mFramebuffer,
+            nullptr);
+        mFramebuffer.Reset();
+    }
+
+    if (mRenderPass) {
+        vkDestroyRenderPass(
+            ToApi(GetDevice())->GetVkDevice(),
+            mRenderPass,
+            nullptr);
+        mRenderPass.Reset();
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+Result CreateRenderPassForViews(
+    VkDevice                             device,
+    uint32_t                             renderTargetCount,
+    const grfx::RenderTargetView* const* ppRenderTargetViews,
+    const grfx::DepthStencilView*        pDepthStencilView,
+    grfx::ResourceState                  depthStencilState,
+    VkRenderPass*                        pRenderPass)
+{
+    bool          hasDepthSencil     = !IsNull(pDepthStencilView);
     VkImageLayout depthStencillayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     // Determine layout for depth/stencil
@@ -38,7 +113,7 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
         VkPipelineStageFlags     stageMask  = 0;
         VkAccessFlags            accessMask = 0;
 
-        Result ppxres = ToVkBarrierDst(pCreateInfo->depthStencilState, grfx::CommandType::COMMAND_TYPE_GRAPHICS, features, stageMask, accessMask, depthStencillayout);
+        Result ppxres = ToVkBarrierDst(depthStencilState, grfx::CommandType::COMMAND_TYPE_GRAPHICS, features, stageMask, accessMask, depthStencillayout);
         if (Failed(ppxres)) {
             PPX_ASSERT_MSG(false, "failed to determine layout for depth stencil state");
             return ppxres;
@@ -48,15 +123,15 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
     // Attachment descriptions
     std::vector<VkAttachmentDescription> attachmentDesc;
     {
-        for (uint32_t i = 0; i < rtvCount; ++i) {
-            grfx::RenderTargetViewPtr rtv = mRenderTargetViews[i];
+        for (uint32_t i = 0; i < renderTargetCount; ++i) {
+            const grfx::RenderTargetView* pRTV = ppRenderTargetViews[i];
 
             VkAttachmentDescription desc = {};
             desc.flags                   = 0;
-            desc.format                  = ToVkFormat(rtv->GetFormat());
-            desc.samples                 = ToVkSampleCount(rtv->GetSampleCount());
-            desc.loadOp                  = ToVkAttachmentLoadOp(rtv->GetLoadOp());
-            desc.storeOp                 = ToVkAttachmentStoreOp(rtv->GetStoreOp());
+            desc.format                  = ToVkFormat(pRTV->GetFormat());
+            desc.samples                 = ToVkSampleCount(pRTV->GetSampleCount());
+            desc.loadOp                  = ToVkAttachmentLoadOp(pRTV->GetLoadOp());
+            desc.storeOp                 = ToVkAttachmentStoreOp(pRTV->GetStoreOp());
             desc.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             desc.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
             desc.initialLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -66,16 +141,14 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
         }
 
         if (hasDepthSencil) {
-            grfx::DepthStencilViewPtr dsv = mDepthStencilView;
-
             VkAttachmentDescription desc = {};
             desc.flags                   = 0;
-            desc.format                  = ToVkFormat(dsv->GetFormat());
+            desc.format                  = ToVkFormat(pDepthStencilView->GetFormat());
             desc.samples                 = VK_SAMPLE_COUNT_1_BIT;
-            desc.loadOp                  = ToVkAttachmentLoadOp(dsv->GetDepthLoadOp());
-            desc.storeOp                 = ToVkAttachmentStoreOp(dsv->GetDepthStoreOp());
-            desc.stencilLoadOp           = ToVkAttachmentLoadOp(dsv->GetStencilLoadOp());
-            desc.stencilStoreOp          = ToVkAttachmentStoreOp(dsv->GetStencilStoreOp());
+            desc.loadOp                  = ToVkAttachmentLoadOp(pDepthStencilView->GetDepthLoadOp());
+            desc.storeOp                 = ToVkAttachmentStoreOp(pDepthStencilView->GetDepthStoreOp());
+            desc.stencilLoadOp           = ToVkAttachmentLoadOp(pDepthStencilView->GetStencilLoadOp());
+            desc.stencilStoreOp          = ToVkAttachmentStoreOp(pDepthStencilView->GetStencilStoreOp());
             desc.initialLayout           = depthStencillayout;
             desc.finalLayout             = depthStencillayout;
 
@@ -85,7 +158,7 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
 
     std::vector<VkAttachmentReference> colorRefs;
     {
-        for (uint32_t i = 0; i < rtvCount; ++i) {
+        for (uint32_t i = 0; i < renderTargetCount; ++i) {
             VkAttachmentReference ref = {};
             ref.attachment            = i;
             ref.layout                = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -130,10 +203,10 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
     vkci.pDependencies          = &subpassDependencies;
 
     VkResult vkres = vk::CreateRenderPass(
-        ToApi(GetDevice())->GetVkDevice(),
+        device,
         &vkci,
         nullptr,
-        &mRenderPass);
+        pRenderPass);
     if (vkres != VK_SUCCESS) {
         PPX_ASSERT_MSG(false, "vkCreateRenderPass failed: " << ToString(vkres));
         return ppx::ERROR_API_FAILURE;
@@ -142,36 +215,39 @@ Result RenderPass::CreateRenderPass(const grfx::internal::RenderPassCreateInfo*
     return ppx::SUCCESS;
 }
 
-Result RenderPass::CreateFramebuffer(const grfx::internal::RenderPassCreateInfo* pCreateInfo)
+Result CreateFramebufferForViews(
+    VkDevice                             device,
+    VkRenderPass                         renderPass,
+    uint32_t                             width,
+    uint32_t                             height,
+    uint32_t                             renderTargetCount,
+    const grfx::RenderTargetView* const* ppRenderTargetViews,
+    const grfx::DepthStencilView*        pDepthStencilView,
+    VkFramebuffer*                       pFramebuffer)
 {
-    bool   hasDepthSencil = mDepthStencilView ? true : false;
-    size_t rtvCount       = CountU32(mRenderTargetViews);
-
     std::vector<VkImageView> attachments;
-    for (uint32_t i = 0; i < rtvCount; ++i) {
-        grfx::RenderTargetViewPtr rtv = mRenderTargetViews[i];
-        attachments.push_back(ToApi(rtv.Get())->GetVkImageView());
+    for (uint32_t i = 0; i < renderTargetCount; ++i) {
+        attachments.push_back(ToApi(ppRenderTargetViews[i])->GetVkImageView());
     }
 
-    if (hasDepthSencil) {
-        grfx::DepthStencilViewPtr dsv = mDepthStencilView;
-        attachments.push_back(ToApi(dsv.Get())->GetVkImageView());
+    if (!IsNull(pDepthStencilView)) {
+        attachments.push_back(ToApi(pDepthStencilView)->GetVkImageView());
     }
 
     VkFramebufferCreateInfo vkci = {VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
     vkci.flags                   = 0;
-    vkci.renderPass              = mRenderPass;
+    vkci.renderPass              = renderPass;
     vkci.attachmentCount         = CountU32(attachments);
     vkci.pAttachments            = DataPtr(attachments);
-    vkci.width                   = pCreateInfo->width;
-    vkci.height                  = pCreateInfo->height;
+    vkci.width                   = width;
+    vkci.height                  = height;
     vkci.layers                  = 1;
 
     VkResult vkres = vkCreateFramebuffer(
-        ToApi(GetDevice())->GetVkDevice(),
+        device,
         &vkci,
         nullptr,
-        &mFramebuffer);
+        pFramebuffer);
     if (vkres != VK_SUCCESS) {
         PPX_ASSERT_MSG(false, "vkCreateFramebuffer failed: " << ToString(vkres));
         return ppx::ERROR_API_FAILURE;
@@ -180,42 +256,6 @@ Result RenderPass::CreateFramebuffer(const grfx::internal::RenderPassCreateInfo*
     return ppx::SUCCESS;
 }
 
-Result RenderPass::CreateApiObjects(const grfx::internal::RenderPassCreateInfo* pCreateInfo)
-{
-    Result ppxres = CreateRenderPass(pCreateInfo);
-    if (Failed(ppxres)) {
-        return ppxres;
-    }
-
-    ppxres = CreateFramebuffer(pCreateInfo);
-    if (Failed(ppxres)) {
-        return ppxres;
-    }
-
-    return ppx::SUCCESS;
-}
-
-void RenderPass::DestroyApiObjects()
-{
-    if (mFramebuffer) {
-        vkDestroyFramebuffer(
-            ToApi(GetDevice())->GetVkDevice(),
-            mFramebuffer,
-            nullptr);
-        mFramebuffer.Reset();
-    }
-
-    if (mRenderPass) {
-        vkDestroyRenderPass(
-            ToApi(GetDevice())->GetVkDevice(),
-            mRenderPass,
-            nullptr);
-        mRenderPass.Reset();
-    }
-}
-
-// -------------------------------------------------------------------------------------------------
-
 VkResult CreateTransientRenderPass(
     VkDevice              device,
     uint32_t              renderTargetCount,
@@ -467,6 +467,15 @@ Result Swapchain::CreateApiObjects(const grfx::SwapchainCreateInfo* pCreateInfo)
             imageCreateInfo.usageFlags.bits.colorAttachment = true;
             imageCreateInfo.pApiObject                      = (void*)(colorImages[i]);
 
+            // Matches the transition above, so barriers can start from the
+            // tracked state
+            imageCreateInfo.initialState = grfx::RESOURCE_STATE_PRESENT;
+#if defined(PPX_BUILD_XR)
+            if (isXREnabled) {
+                imageCreateInfo.initialState = grfx::RESOURCE_STATE_RENDER_TARGET;
+            }
+#endif
+
             grfx::ImagePtr image;
             Result         ppxres = GetDevice()->CreateImage(&imageCreateInfo, &image);
             if (Failed(ppxres)) {
@@ -573,6 +582,10 @@ Result Swapchain::PresentInternal(
         return ppx::ERROR_API_FAILURE;
     }
 
+    // Frames in flight are limited by the image count, plus one for the
+    // frame that was recording when a framebuffer was evicted.
+    ToApi(GetDevice())->RetireFramebuffers(GetImageCount() + 1);
+
     return ppx::SUCCESS;
 }
 
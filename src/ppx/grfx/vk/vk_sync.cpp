@@ -86,7 +86,12 @@ Result Fence::Reset()
 // -------------------------------------------------------------------------------------------------
 Result Semaphore::CreateApiObjects(const grfx::SemaphoreCreateInfo* pCreateInfo)
 {
+    VkSemaphoreTypeCreateInfoKHR typeci = {VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR};
+    typeci.semaphoreType                = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    typeci.initialValue                 = pCreateInfo->initialValue;
+
     VkSemaphoreCreateInfo vkci = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    vkci.pNext                 = (pCreateInfo->semaphoreType == grfx::SEMAPHORE_TYPE_TIMELINE) ? &typeci : nullptr;
     vkci.flags                 = 0;
 
     VkResult vkres = vkCreateSemaphore(
@@ -114,6 +119,49 @@ void Semaphore::DestroyApiObjects()
     }
 }
 
+Result Semaphore::TimelineWait(uint64_t value, uint64_t timeout) const
+{
+    VkSemaphore semaphore = mSemaphore;
+
+    VkSemaphoreWaitInfoKHR waitInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR};
+    waitInfo.semaphoreCount         = 1;
+    waitInfo.pSemaphores            = &semaphore;
+    waitInfo.pValues                = &value;
+
+    VkResult vkres = ToApi(GetDevice())->WaitSemaphores(&waitInfo, timeout);
+    if (vkres == VK_TIMEOUT) {
+        return ppx::ERROR_WAIT_TIMED_OUT;
+    }
+    if (vkres != VK_SUCCESS) {
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
+Result Semaphore::TimelineSignal(uint64_t value) const
+{
+    VkSemaphoreSignalInfoKHR signalInfo = {VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR};
+    signalInfo.semaphore                = mSemaphore;
+    signalInfo.value                    = value;
+
+    VkResult vkres = ToApi(GetDevice())->SignalSemaphore(&signalInfo);
+    if (vkres != VK_SUCCESS) {
+        PPX_ASSERT_MSG(false, "vkSignalSemaphore failed: " << ToString(vkres));
+        return ppx::ERROR_API_FAILURE;
+    }
+
+    return ppx::SUCCESS;
+}
+
+uint64_t Semaphore::TimelineCounterValue() const
+{
+    uint64_t value = 0;
+    VkResult vkres = ToApi(GetDevice())->GetSemaphoreCounterValue(mSemaphore, &value);
+    PPX_ASSERT_MSG(vkres == VK_SUCCESS, "vkGetSemaphoreCounterValue failed: " << ToString(vkres));
+    return value;
+}
+
 } // namespace vk
 } // namespace grfx
 } // namespace ppx
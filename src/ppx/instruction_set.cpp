@@ -0,0 +1,73 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/instruction_set.h"
+#include "ppx/config.h"
+#include "ppx/platform.h"
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_INSTRUCTION_SET_X86
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_INSTRUCTION_SET_NEON
+#endif
+// clang-format on
+
+namespace ppx {
+
+const char* ToString(InstructionSet value)
+{
+    // clang-format off
+    switch (value) {
+        default: break;
+        case INSTRUCTION_SET_SCALAR : return "scalar";
+        case INSTRUCTION_SET_SSE2   : return "sse2";
+        case INSTRUCTION_SET_AVX2   : return "avx2";
+        case INSTRUCTION_SET_NEON   : return "neon";
+    }
+    // clang-format on
+    return "<unknown instruction set>";
+}
+
+bool IsSupported(InstructionSet value)
+{
+    switch (value) {
+        default: break;
+        case INSTRUCTION_SET_SCALAR: return true;
+#if defined(PPX_INSTRUCTION_SET_X86) && !defined(PPX_ANDROID)
+        case INSTRUCTION_SET_SSE2: return Platform::GetCpuInfo().GetFeatures().sse2;
+        case INSTRUCTION_SET_AVX2: return Platform::GetCpuInfo().GetFeatures().avx2;
+#endif
+#if defined(PPX_INSTRUCTION_SET_NEON)
+        case INSTRUCTION_SET_NEON: return true;
+#endif
+    }
+    return false;
+}
+
+InstructionSet GetBestInstructionSet()
+{
+    if (IsSupported(INSTRUCTION_SET_AVX2)) {
+        return INSTRUCTION_SET_AVX2;
+    }
+    if (IsSupported(INSTRUCTION_SET_SSE2)) {
+        return INSTRUCTION_SET_SSE2;
+    }
+    if (IsSupported(INSTRUCTION_SET_NEON)) {
+        return INSTRUCTION_SET_NEON;
+    }
+    return INSTRUCTION_SET_SCALAR;
+}
+
+} // namespace ppx
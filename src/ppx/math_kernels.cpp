@@ -0,0 +1,849 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/math_kernels.h"
+#include "ppx/config.h"
+
+#include <cmath>
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_MATH_KERNELS_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define PPX_TARGET_AVX2
+#   else
+#       define PPX_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_MATH_KERNELS_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+namespace math_kernels {
+
+// Kernels read and write float3, float4x4 and AABB as packed floats.
+static_assert(sizeof(float3) == 3 * sizeof(float), "unexpected float3 layout");
+static_assert(sizeof(float4x4) == 16 * sizeof(float), "unexpected float4x4 layout");
+static_assert(sizeof(AABB) == 6 * sizeof(float), "unexpected AABB layout");
+
+static inline const float* Data(const float3* p)
+{
+    return &p->x;
+}
+
+static inline float* Data(float3* p)
+{
+    return &p->x;
+}
+
+static inline const float* Data(const float4x4* p)
+{
+    return &(*p)[0][0];
+}
+
+static inline float* Data(float4x4* p)
+{
+    return &(*p)[0][0];
+}
+
+// Min followed by max.
+static inline const float* Data(const AABB* p)
+{
+    return &p->GetMin().x;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scalar
+// -------------------------------------------------------------------------------------------------
+
+static void TransformPointsScalar(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count)
+{
+    const float* m = Data(&matrix);
+    for (size_t i = 0; i < count; ++i) {
+        const float x = pSrc[i].x;
+        const float y = pSrc[i].y;
+        const float z = pSrc[i].z;
+        pDst[i]       = float3(
+            m[0] * x + m[4] * y + m[8] * z + m[12],
+            m[1] * x + m[5] * y + m[9] * z + m[13],
+            m[2] * x + m[6] * y + m[10] * z + m[14]);
+    }
+}
+
+// pA is advanced by aStride matrices per element, 0 to use the same matrix for all.
+static void MultiplyMatricesScalar(const float4x4* pA, size_t aStride, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float4x4 a = pA[i * aStride];
+        const float4x4 b = pB[i];
+        for (int c = 0; c < 4; ++c) {
+            for (int r = 0; r < 4; ++r) {
+                pDst[i][c][r] = a[0][r] * b[c][0] + a[1][r] * b[c][1] + a[2][r] * b[c][2] + a[3][r] * b[c][3];
+            }
+        }
+    }
+}
+
+static void ComposeTRSScalar(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float3& t  = pTranslations[i];
+        const quat&   q  = pRotations[i];
+        const float3& s  = pScales[i];
+        const float   xx = q.x * q.x;
+        const float   yy = q.y * q.y;
+        const float   zz = q.z * q.z;
+        const float   xy = q.x * q.y;
+        const float   xz = q.x * q.z;
+        const float   yz = q.y * q.z;
+        const float   wx = q.w * q.x;
+        const float   wy = q.w * q.y;
+        const float   wz = q.w * q.z;
+
+        float4x4& m = pDst[i];
+        m[0]        = float4((1.0f - 2.0f * (yy + zz)) * s.x, (2.0f * (xy + wz)) * s.x, (2.0f * (xz - wy)) * s.x, 0.0f);
+        m[1]        = float4((2.0f * (xy - wz)) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, (2.0f * (yz + wx)) * s.y, 0.0f);
+        m[2]        = float4((2.0f * (xz + wy)) * s.z, (2.0f * (yz - wx)) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+        m[3]        = float4(t.x, t.y, t.z, 1.0f);
+    }
+}
+
+// Transforms the center and the extents of each box, the extents by the
+// absolute value of the upper 3x3 of the matrix.
+static void TransformAABBsScalar(const float4x4* pMatrices, size_t matrixStride, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float* m      = Data(&pMatrices[i * matrixStride]);
+        const float3 center = (pSrc[i].GetMin() + pSrc[i].GetMax()) * 0.5f;
+        const float3 extent = (pSrc[i].GetMax() - pSrc[i].GetMin()) * 0.5f;
+
+        float3 newCenter;
+        float3 newExtent;
+        for (int r = 0; r < 3; ++r) {
+            newCenter[r] = m[r] * center.x + m[4 + r] * center.y + m[8 + r] * center.z + m[12 + r];
+            newExtent[r] = std::fabs(m[r]) * extent.x + std::fabs(m[4 + r]) * extent.y + std::fabs(m[8 + r]) * extent.z;
+        }
+        pDst[i].Set(newCenter - newExtent, newCenter + newExtent);
+    }
+}
+
+#if defined(PPX_MATH_KERNELS_X86)
+
+// -------------------------------------------------------------------------------------------------
+// SSE2
+// -------------------------------------------------------------------------------------------------
+
+// 4 packed float3 (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) to x, y and z vectors.
+static inline void Deinterleave3(__m128 a, __m128 b, __m128 c, __m128* pX, __m128* pY, __m128* pZ)
+{
+    const __m128 bc  = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    const __m128 ab  = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    const __m128 bc2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    const __m128 ab2 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    *pX              = _mm_shuffle_ps(a, bc, _MM_SHUFFLE(2, 0, 3, 0));
+    *pY              = _mm_shuffle_ps(ab, bc2, _MM_SHUFFLE(2, 0, 2, 0));
+    *pZ              = _mm_shuffle_ps(ab2, c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+// Inverse of Deinterleave3().
+static inline void Interleave3(__m128 x, __m128 y, __m128 z, __m128* pA, __m128* pB, __m128* pC)
+{
+    const __m128 xy0 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 zx1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128 yz1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 xy2 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+    const __m128 zx3 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+    const __m128 yz3 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+    *pA              = _mm_shuffle_ps(xy0, zx1, _MM_SHUFFLE(2, 0, 2, 0));
+    *pB              = _mm_shuffle_ps(yz1, xy2, _MM_SHUFFLE(2, 0, 2, 0));
+    *pC              = _mm_shuffle_ps(zx3, yz3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline __m128 Splat(__m128 v, int lane)
+{
+    switch (lane) {
+        default: break;
+        case 1: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        case 2: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+        case 3: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+static void TransformPointsSSE2(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count)
+{
+    const float* m   = Data(&matrix);
+    const __m128 m00 = _mm_set1_ps(m[0]);
+    const __m128 m01 = _mm_set1_ps(m[1]);
+    const __m128 m02 = _mm_set1_ps(m[2]);
+    const __m128 m10 = _mm_set1_ps(m[4]);
+    const __m128 m11 = _mm_set1_ps(m[5]);
+    const __m128 m12 = _mm_set1_ps(m[6]);
+    const __m128 m20 = _mm_set1_ps(m[8]);
+    const __m128 m21 = _mm_set1_ps(m[9]);
+    const __m128 m22 = _mm_set1_ps(m[10]);
+    const __m128 m30 = _mm_set1_ps(m[12]);
+    const __m128 m31 = _mm_set1_ps(m[13]);
+    const __m128 m32 = _mm_set1_ps(m[14]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* pIn = Data(pSrc + i);
+        __m128       x, y, z;
+        Deinterleave3(_mm_loadu_ps(pIn), _mm_loadu_ps(pIn + 4), _mm_loadu_ps(pIn + 8), &x, &y, &z);
+
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)), _mm_mul_ps(m20, z)), m30);
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m21, z)), m31);
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)), _mm_mul_ps(m22, z)), m32);
+
+        __m128 a, b, c;
+        Interleave3(rx, ry, rz, &a, &b, &c);
+        float* pOut = Data(pDst + i);
+        _mm_storeu_ps(pOut, a);
+        _mm_storeu_ps(pOut + 4, b);
+        _mm_storeu_ps(pOut + 8, c);
+    }
+    TransformPointsScalar(matrix, pSrc + i, pDst + i, count - i);
+}
+
+static void MultiplyMatricesSSE2(const float4x4* pA, size_t aStride, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float* a  = Data(&pA[i * aStride]);
+        const float* b  = Data(&pB[i]);
+        const __m128 a0 = _mm_loadu_ps(a + 0);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        const __m128 a2 = _mm_loadu_ps(a + 8);
+        const __m128 a3 = _mm_loadu_ps(a + 12);
+        const __m128 b0 = _mm_loadu_ps(b + 0);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        const __m128 b2 = _mm_loadu_ps(b + 8);
+        const __m128 b3 = _mm_loadu_ps(b + 12);
+
+        const __m128 columns[4] = {b0, b1, b2, b3};
+        float*       pOut       = Data(&pDst[i]);
+        for (int c = 0; c < 4; ++c) {
+            __m128 r = _mm_mul_ps(a0, Splat(columns[c], 0));
+            r        = _mm_add_ps(r, _mm_mul_ps(a1, Splat(columns[c], 1)));
+            r        = _mm_add_ps(r, _mm_mul_ps(a2, Splat(columns[c], 2)));
+            r        = _mm_add_ps(r, _mm_mul_ps(a3, Splat(columns[c], 3)));
+            _mm_storeu_ps(pOut + 4 * c, r);
+        }
+    }
+}
+
+static void ComposeTRSSSE2(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 two  = _mm_set1_ps(2.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* pT = Data(pTranslations + i);
+        const float* pS = Data(pScales + i);
+        const quat*  pR = pRotations + i;
+        __m128       tx, ty, tz, sx, sy, sz;
+        Deinterleave3(_mm_loadu_ps(pT), _mm_loadu_ps(pT + 4), _mm_loadu_ps(pT + 8), &tx, &ty, &tz);
+        Deinterleave3(_mm_loadu_ps(pS), _mm_loadu_ps(pS + 4), _mm_loadu_ps(pS + 8), &sx, &sy, &sz);
+        const __m128 qx = _mm_set_ps(pR[3].x, pR[2].x, pR[1].x, pR[0].x);
+        const __m128 qy = _mm_set_ps(pR[3].y, pR[2].y, pR[1].y, pR[0].y);
+        const __m128 qz = _mm_set_ps(pR[3].z, pR[2].z, pR[1].z, pR[0].z);
+        const __m128 qw = _mm_set_ps(pR[3].w, pR[2].w, pR[1].w, pR[0].w);
+
+        const __m128 xx = _mm_mul_ps(qx, qx);
+        const __m128 yy = _mm_mul_ps(qy, qy);
+        const __m128 zz = _mm_mul_ps(qz, qz);
+        const __m128 xy = _mm_mul_ps(qx, qy);
+        const __m128 xz = _mm_mul_ps(qx, qz);
+        const __m128 yz = _mm_mul_ps(qy, qz);
+        const __m128 wx = _mm_mul_ps(qw, qx);
+        const __m128 wy = _mm_mul_ps(qw, qy);
+        const __m128 wz = _mm_mul_ps(qw, qz);
+
+        // columns[c][r] is row r of column c for the 4 instances
+        __m128 columns[4][4] = {
+            {
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx),
+                zero,
+            },
+            {
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy),
+                zero,
+            },
+            {
+                _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz),
+                _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz),
+                zero,
+            },
+            {tx, ty, tz, one},
+        };
+
+        // After the transpose columns[c][j] is column c of instance j
+        for (int c = 0; c < 4; ++c) {
+            _MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+        }
+        for (int j = 0; j < 4; ++j) {
+            float* pOut = Data(&pDst[i + j]);
+            for (int c = 0; c < 4; ++c) {
+                _mm_storeu_ps(pOut + 4 * c, columns[c][j]);
+            }
+        }
+    }
+    ComposeTRSScalar(pTranslations + i, pRotations + i, pScales + i, pDst + i, count - i);
+}
+
+static void TransformAABBsSSE2(const float4x4* pMatrices, size_t matrixStride, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    const __m128 half    = _mm_set1_ps(0.5f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    for (size_t i = 0; i < count; ++i) {
+        const float* m  = Data(&pMatrices[i * matrixStride]);
+        const __m128 c0 = _mm_loadu_ps(m + 0);
+        const __m128 c1 = _mm_loadu_ps(m + 4);
+        const __m128 c2 = _mm_loadu_ps(m + 8);
+        const __m128 c3 = _mm_loadu_ps(m + 12);
+
+        // Loads stay inside the box: min.xyz max.x, then min.z max.xyz
+        const float* pBox   = Data(&pSrc[i]);
+        const __m128 minPos = _mm_loadu_ps(pBox);
+        const __m128 maxPos = _mm_shuffle_ps(_mm_loadu_ps(pBox + 2), _mm_loadu_ps(pBox + 2), _MM_SHUFFLE(3, 3, 2, 1));
+        const __m128 center = _mm_mul_ps(_mm_add_ps(minPos, maxPos), half);
+        const __m128 extent = _mm_mul_ps(_mm_sub_ps(maxPos, minPos), half);
+
+        __m128 newCenter = _mm_mul_ps(c0, Splat(center, 0));
+        newCenter        = _mm_add_ps(newCenter, _mm_mul_ps(c1, Splat(center, 1)));
+        newCenter        = _mm_add_ps(newCenter, _mm_mul_ps(c2, Splat(center, 2)));
+        newCenter        = _mm_add_ps(newCenter, c3);
+        __m128 newExtent = _mm_mul_ps(_mm_and_ps(c0, absMask), Splat(extent, 0));
+        newExtent        = _mm_add_ps(newExtent, _mm_mul_ps(_mm_and_ps(c1, absMask), Splat(extent, 1)));
+        newExtent        = _mm_add_ps(newExtent, _mm_mul_ps(_mm_and_ps(c2, absMask), Splat(extent, 2)));
+
+        float bounds[8];
+        _mm_storeu_ps(bounds, _mm_sub_ps(newCenter, newExtent));
+        _mm_storeu_ps(bounds + 4, _mm_add_ps(newCenter, newExtent));
+        pDst[i].Set(float3(bounds[0], bounds[1], bounds[2]), float3(bounds[4], bounds[5], bounds[6]));
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// AVX2
+// -------------------------------------------------------------------------------------------------
+
+// Twice the SSE2 pattern: the low 128 bits work on the first 4 elements and
+// the high 128 bits on the next 4, since shuffles don't cross the halves.
+
+PPX_TARGET_AVX2 static inline __m256 Load2x128(const float* pLow, const float* pHigh)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(pLow)), _mm_loadu_ps(pHigh), 1);
+}
+
+PPX_TARGET_AVX2 static inline void Store2x128(float* pLow, float* pHigh, __m256 v)
+{
+    _mm_storeu_ps(pLow, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(pHigh, _mm256_extractf128_ps(v, 1));
+}
+
+PPX_TARGET_AVX2 static inline void Deinterleave3(__m256 a, __m256 b, __m256 c, __m256* pX, __m256* pY, __m256* pZ)
+{
+    const __m256 bc  = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    const __m256 ab  = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    const __m256 bc2 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    const __m256 ab2 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+    *pX              = _mm256_shuffle_ps(a, bc, _MM_SHUFFLE(2, 0, 3, 0));
+    *pY              = _mm256_shuffle_ps(ab, bc2, _MM_SHUFFLE(2, 0, 2, 0));
+    *pZ              = _mm256_shuffle_ps(ab2, c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+
+PPX_TARGET_AVX2 static inline void Interleave3(__m256 x, __m256 y, __m256 z, __m256* pA, __m256* pB, __m256* pC)
+{
+    const __m256 xy0 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m256 zx1 = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m256 yz1 = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m256 xy2 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2));
+    const __m256 zx3 = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2));
+    const __m256 yz3 = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3));
+    *pA              = _mm256_shuffle_ps(xy0, zx1, _MM_SHUFFLE(2, 0, 2, 0));
+    *pB              = _mm256_shuffle_ps(yz1, xy2, _MM_SHUFFLE(2, 0, 2, 0));
+    *pC              = _mm256_shuffle_ps(zx3, yz3, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+// Loads 8 packed float3 and splits them into x, y and z.
+PPX_TARGET_AVX2 static inline void LoadDeinterleave3(const float* p, __m256* pX, __m256* pY, __m256* pZ)
+{
+    Deinterleave3(Load2x128(p, p + 12), Load2x128(p + 4, p + 16), Load2x128(p + 8, p + 20), pX, pY, pZ);
+}
+
+// _MM_TRANSPOSE4_PS on each half.
+PPX_TARGET_AVX2 static inline void Transpose4x2(__m256* pRows)
+{
+    const __m256 t0 = _mm256_unpacklo_ps(pRows[0], pRows[1]);
+    const __m256 t1 = _mm256_unpacklo_ps(pRows[2], pRows[3]);
+    const __m256 t2 = _mm256_unpackhi_ps(pRows[0], pRows[1]);
+    const __m256 t3 = _mm256_unpackhi_ps(pRows[2], pRows[3]);
+    pRows[0]        = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    pRows[1]        = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    pRows[2]        = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    pRows[3]        = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+PPX_TARGET_AVX2 static void TransformPointsAVX2(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count)
+{
+    const float* m   = Data(&matrix);
+    const __m256 m00 = _mm256_set1_ps(m[0]);
+    const __m256 m01 = _mm256_set1_ps(m[1]);
+    const __m256 m02 = _mm256_set1_ps(m[2]);
+    const __m256 m10 = _mm256_set1_ps(m[4]);
+    const __m256 m11 = _mm256_set1_ps(m[5]);
+    const __m256 m12 = _mm256_set1_ps(m[6]);
+    const __m256 m20 = _mm256_set1_ps(m[8]);
+    const __m256 m21 = _mm256_set1_ps(m[9]);
+    const __m256 m22 = _mm256_set1_ps(m[10]);
+    const __m256 m30 = _mm256_set1_ps(m[12]);
+    const __m256 m31 = _mm256_set1_ps(m[13]);
+    const __m256 m32 = _mm256_set1_ps(m[14]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        LoadDeinterleave3(Data(pSrc + i), &x, &y, &z);
+
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m10, y)), _mm256_mul_ps(m20, z)), m30);
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x), _mm256_mul_ps(m11, y)), _mm256_mul_ps(m21, z)), m31);
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x), _mm256_mul_ps(m12, y)), _mm256_mul_ps(m22, z)), m32);
+
+        __m256 a, b, c;
+        Interleave3(rx, ry, rz, &a, &b, &c);
+        float* pOut = Data(pDst + i);
+        Store2x128(pOut, pOut + 12, a);
+        Store2x128(pOut + 4, pOut + 16, b);
+        Store2x128(pOut + 8, pOut + 20, c);
+    }
+    TransformPointsSSE2(matrix, pSrc + i, pDst + i, count - i);
+}
+
+// Two result columns per iteration, each half of a register holds one.
+PPX_TARGET_AVX2 static void MultiplyMatricesAVX2(const float4x4* pA, size_t aStride, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float* a   = Data(&pA[i * aStride]);
+        const float* b   = Data(&pB[i]);
+        const __m256 a0  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+        const __m256 a1  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+        const __m256 a2  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+        const __m256 a3  = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+        const __m256 b01 = _mm256_loadu_ps(b + 0);
+        const __m256 b23 = _mm256_loadu_ps(b + 8);
+
+        const __m256 columns[2] = {b01, b23};
+        float*       pOut       = Data(&pDst[i]);
+        for (int c = 0; c < 2; ++c) {
+            __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(columns[c], _MM_SHUFFLE(0, 0, 0, 0)));
+            r        = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(columns[c], _MM_SHUFFLE(1, 1, 1, 1))));
+            r        = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(columns[c], _MM_SHUFFLE(2, 2, 2, 2))));
+            r        = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(columns[c], _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm256_storeu_ps(pOut + 8 * c, r);
+        }
+    }
+}
+
+PPX_TARGET_AVX2 static void ComposeTRSAVX2(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 two  = _mm256_set1_ps(2.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const quat* pR = pRotations + i;
+        __m256      tx, ty, tz, sx, sy, sz;
+        LoadDeinterleave3(Data(pTranslations + i), &tx, &ty, &tz);
+        LoadDeinterleave3(Data(pScales + i), &sx, &sy, &sz);
+        const __m256 qx = _mm256_set_ps(pR[7].x, pR[6].x, pR[5].x, pR[4].x, pR[3].x, pR[2].x, pR[1].x, pR[0].x);
+        const __m256 qy = _mm256_set_ps(pR[7].y, pR[6].y, pR[5].y, pR[4].y, pR[3].y, pR[2].y, pR[1].y, pR[0].y);
+        const __m256 qz = _mm256_set_ps(pR[7].z, pR[6].z, pR[5].z, pR[4].z, pR[3].z, pR[2].z, pR[1].z, pR[0].z);
+        const __m256 qw = _mm256_set_ps(pR[7].w, pR[6].w, pR[5].w, pR[4].w, pR[3].w, pR[2].w, pR[1].w, pR[0].w);
+
+        const __m256 xx = _mm256_mul_ps(qx, qx);
+        const __m256 yy = _mm256_mul_ps(qy, qy);
+        const __m256 zz = _mm256_mul_ps(qz, qz);
+        const __m256 xy = _mm256_mul_ps(qx, qy);
+        const __m256 xz = _mm256_mul_ps(qx, qz);
+        const __m256 yz = _mm256_mul_ps(qy, qz);
+        const __m256 wx = _mm256_mul_ps(qw, qx);
+        const __m256 wy = _mm256_mul_ps(qw, qy);
+        const __m256 wz = _mm256_mul_ps(qw, qz);
+
+        __m256 columns[4][4] = {
+            {
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+                zero,
+            },
+            {
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+                zero,
+            },
+            {
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+                zero,
+            },
+            {tx, ty, tz, one},
+        };
+
+        // After the transpose columns[c][j] is column c of instance j and j + 4
+        for (int c = 0; c < 4; ++c) {
+            Transpose4x2(columns[c]);
+        }
+        for (int j = 0; j < 4; ++j) {
+            float* pLow  = Data(&pDst[i + j]);
+            float* pHigh = Data(&pDst[i + j + 4]);
+            for (int c = 0; c < 4; ++c) {
+                Store2x128(pLow + 4 * c, pHigh + 4 * c, columns[c][j]);
+            }
+        }
+    }
+    ComposeTRSSSE2(pTranslations + i, pRotations + i, pScales + i, pDst + i, count - i);
+}
+
+// Two boxes per iteration, one per half.
+PPX_TARGET_AVX2 static void TransformAABBsAVX2(const float4x4* pMatrices, size_t matrixStride, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    const __m256 half    = _mm256_set1_ps(0.5f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const float* m0 = Data(&pMatrices[i * matrixStride]);
+        const float* m1 = Data(&pMatrices[(i + 1) * matrixStride]);
+        const __m256 c0 = Load2x128(m0 + 0, m1 + 0);
+        const __m256 c1 = Load2x128(m0 + 4, m1 + 4);
+        const __m256 c2 = Load2x128(m0 + 8, m1 + 8);
+        const __m256 c3 = Load2x128(m0 + 12, m1 + 12);
+
+        const float* pBox0  = Data(&pSrc[i]);
+        const float* pBox1  = Data(&pSrc[i + 1]);
+        const __m256 minPos = Load2x128(pBox0, pBox1);
+        const __m256 maxPos = _mm256_permute_ps(Load2x128(pBox0 + 2, pBox1 + 2), _MM_SHUFFLE(3, 3, 2, 1));
+        const __m256 center = _mm256_mul_ps(_mm256_add_ps(minPos, maxPos), half);
+        const __m256 extent = _mm256_mul_ps(_mm256_sub_ps(maxPos, minPos), half);
+
+        __m256 newCenter = _mm256_mul_ps(c0, _mm256_permute_ps(center, _MM_SHUFFLE(0, 0, 0, 0)));
+        newCenter        = _mm256_add_ps(newCenter, _mm256_mul_ps(c1, _mm256_permute_ps(center, _MM_SHUFFLE(1, 1, 1, 1))));
+        newCenter        = _mm256_add_ps(newCenter, _mm256_mul_ps(c2, _mm256_permute_ps(center, _MM_SHUFFLE(2, 2, 2, 2))));
+        newCenter        = _mm256_add_ps(newCenter, c3);
+        __m256 newExtent = _mm256_mul_ps(_mm256_and_ps(c0, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(0, 0, 0, 0)));
+        newExtent        = _mm256_add_ps(newExtent, _mm256_mul_ps(_mm256_and_ps(c1, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(1, 1, 1, 1))));
+        newExtent        = _mm256_add_ps(newExtent, _mm256_mul_ps(_mm256_and_ps(c2, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(2, 2, 2, 2))));
+
+        float bounds[16];
+        Store2x128(bounds, bounds + 8, _mm256_sub_ps(newCenter, newExtent));
+        Store2x128(bounds + 4, bounds + 12, _mm256_add_ps(newCenter, newExtent));
+        pDst[i].Set(float3(bounds[0], bounds[1], bounds[2]), float3(bounds[4], bounds[5], bounds[6]));
+        pDst[i + 1].Set(float3(bounds[8], bounds[9], bounds[10]), float3(bounds[12], bounds[13], bounds[14]));
+    }
+    TransformAABBsSSE2(pMatrices + i * matrixStride, matrixStride, pSrc + i, pDst + i, count - i);
+}
+
+#endif // defined(PPX_MATH_KERNELS_X86)
+
+#if defined(PPX_MATH_KERNELS_NEON)
+
+// -------------------------------------------------------------------------------------------------
+// NEON
+// -------------------------------------------------------------------------------------------------
+
+static void TransformPointsNEON(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count)
+{
+    const float* m = Data(&matrix);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4x3_t p = vld3q_f32(Data(pSrc + i));
+        float32x4x3_t       r;
+        for (int k = 0; k < 3; ++k) {
+            float32x4_t v = vmulq_n_f32(p.val[0], m[k]);
+            v             = vaddq_f32(v, vmulq_n_f32(p.val[1], m[4 + k]));
+            v             = vaddq_f32(v, vmulq_n_f32(p.val[2], m[8 + k]));
+            r.val[k]      = vaddq_f32(v, vdupq_n_f32(m[12 + k]));
+        }
+        vst3q_f32(Data(pDst + i), r);
+    }
+    TransformPointsScalar(matrix, pSrc + i, pDst + i, count - i);
+}
+
+static void MultiplyMatricesNEON(const float4x4* pA, size_t aStride, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float*      a  = Data(&pA[i * aStride]);
+        const float4x4    b  = pB[i];
+        const float32x4_t a0 = vld1q_f32(a + 0);
+        const float32x4_t a1 = vld1q_f32(a + 4);
+        const float32x4_t a2 = vld1q_f32(a + 8);
+        const float32x4_t a3 = vld1q_f32(a + 12);
+
+        float* pOut = Data(&pDst[i]);
+        for (int c = 0; c < 4; ++c) {
+            float32x4_t r = vmulq_n_f32(a0, b[c][0]);
+            r             = vaddq_f32(r, vmulq_n_f32(a1, b[c][1]));
+            r             = vaddq_f32(r, vmulq_n_f32(a2, b[c][2]));
+            r             = vaddq_f32(r, vmulq_n_f32(a3, b[c][3]));
+            vst1q_f32(pOut + 4 * c, r);
+        }
+    }
+}
+
+static void ComposeTRSNEON(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one  = vdupq_n_f32(1.0f);
+    const float32x4_t two  = vdupq_n_f32(2.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4x3_t t     = vld3q_f32(Data(pTranslations + i));
+        const float32x4x3_t s     = vld3q_f32(Data(pScales + i));
+        const quat*         pR    = pRotations + i;
+        const float         rx[4] = {pR[0].x, pR[1].x, pR[2].x, pR[3].x};
+        const float         ry[4] = {pR[0].y, pR[1].y, pR[2].y, pR[3].y};
+        const float         rz[4] = {pR[0].z, pR[1].z, pR[2].z, pR[3].z};
+        const float         rw[4] = {pR[0].w, pR[1].w, pR[2].w, pR[3].w};
+        const float32x4_t   qx    = vld1q_f32(rx);
+        const float32x4_t   qy    = vld1q_f32(ry);
+        const float32x4_t   qz    = vld1q_f32(rz);
+        const float32x4_t   qw    = vld1q_f32(rw);
+
+        const float32x4_t xx = vmulq_f32(qx, qx);
+        const float32x4_t yy = vmulq_f32(qy, qy);
+        const float32x4_t zz = vmulq_f32(qz, qz);
+        const float32x4_t xy = vmulq_f32(qx, qy);
+        const float32x4_t xz = vmulq_f32(qx, qz);
+        const float32x4_t yz = vmulq_f32(qy, qz);
+        const float32x4_t wx = vmulq_f32(qw, qx);
+        const float32x4_t wy = vmulq_f32(qw, qy);
+        const float32x4_t wz = vmulq_f32(qw, qz);
+
+        // vst4q interleaves the rows of a column, which gives that column
+        // for the 4 instances one after the other
+        float32x4x4_t columns[4];
+        columns[0].val[0] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(yy, zz))), s.val[0]);
+        columns[0].val[1] = vmulq_f32(vmulq_f32(two, vaddq_f32(xy, wz)), s.val[0]);
+        columns[0].val[2] = vmulq_f32(vmulq_f32(two, vsubq_f32(xz, wy)), s.val[0]);
+        columns[0].val[3] = zero;
+        columns[1].val[0] = vmulq_f32(vmulq_f32(two, vsubq_f32(xy, wz)), s.val[1]);
+        columns[1].val[1] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, zz))), s.val[1]);
+        columns[1].val[2] = vmulq_f32(vmulq_f32(two, vaddq_f32(yz, wx)), s.val[1]);
+        columns[1].val[3] = zero;
+        columns[2].val[0] = vmulq_f32(vmulq_f32(two, vaddq_f32(xz, wy)), s.val[2]);
+        columns[2].val[1] = vmulq_f32(vmulq_f32(two, vsubq_f32(yz, wx)), s.val[2]);
+        columns[2].val[2] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, yy))), s.val[2]);
+        columns[2].val[3] = zero;
+        columns[3].val[0] = t.val[0];
+        columns[3].val[1] = t.val[1];
+        columns[3].val[2] = t.val[2];
+        columns[3].val[3] = one;
+
+        float interleaved[16];
+        for (int c = 0; c < 4; ++c) {
+            vst4q_f32(interleaved, columns[c]);
+            for (int j = 0; j < 4; ++j) {
+                vst1q_f32(Data(&pDst[i + j]) + 4 * c, vld1q_f32(interleaved + 4 * j));
+            }
+        }
+    }
+    ComposeTRSScalar(pTranslations + i, pRotations + i, pScales + i, pDst + i, count - i);
+}
+
+static void TransformAABBsNEON(const float4x4* pMatrices, size_t matrixStride, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float*      m  = Data(&pMatrices[i * matrixStride]);
+        const float32x4_t c0 = vld1q_f32(m + 0);
+        const float32x4_t c1 = vld1q_f32(m + 4);
+        const float32x4_t c2 = vld1q_f32(m + 8);
+        const float32x4_t c3 = vld1q_f32(m + 12);
+
+        // Loads stay inside the box: min.xyz max.x, then min.z max.xyz
+        const float*      pBox   = Data(&pSrc[i]);
+        const float32x4_t minPos = vld1q_f32(pBox);
+        const float32x4_t maxPos = vextq_f32(vld1q_f32(pBox + 2), vld1q_f32(pBox + 2), 1);
+        const float32x4_t center = vmulq_n_f32(vaddq_f32(minPos, maxPos), 0.5f);
+        const float32x4_t extent = vmulq_n_f32(vsubq_f32(maxPos, minPos), 0.5f);
+
+        float32x4_t newCenter = vmulq_n_f32(c0, vgetq_lane_f32(center, 0));
+        newCenter             = vaddq_f32(newCenter, vmulq_n_f32(c1, vgetq_lane_f32(center, 1)));
+        newCenter             = vaddq_f32(newCenter, vmulq_n_f32(c2, vgetq_lane_f32(center, 2)));
+        newCenter             = vaddq_f32(newCenter, c3);
+        float32x4_t newExtent = vmulq_n_f32(vabsq_f32(c0), vgetq_lane_f32(extent, 0));
+        newExtent             = vaddq_f32(newExtent, vmulq_n_f32(vabsq_f32(c1), vgetq_lane_f32(extent, 1)));
+        newExtent             = vaddq_f32(newExtent, vmulq_n_f32(vabsq_f32(c2), vgetq_lane_f32(extent, 2)));
+
+        float bounds[8];
+        vst1q_f32(bounds, vsubq_f32(newCenter, newExtent));
+        vst1q_f32(bounds + 4, vaddq_f32(newCenter, newExtent));
+        pDst[i].Set(float3(bounds[0], bounds[1], bounds[2]), float3(bounds[4], bounds[5], bounds[6]));
+    }
+}
+
+#endif // defined(PPX_MATH_KERNELS_NEON)
+
+// -------------------------------------------------------------------------------------------------
+// Dispatch
+// -------------------------------------------------------------------------------------------------
+
+struct KernelTable
+{
+    void (*transformPoints)(const float4x4&, const float3*, float3*, size_t);
+    void (*multiplyMatrices)(const float4x4*, size_t, const float4x4*, float4x4*, size_t);
+    void (*composeTRS)(const float3*, const quat*, const float3*, float4x4*, size_t);
+    void (*transformAABBs)(const float4x4*, size_t, const AABB*, AABB*, size_t);
+};
+
+// clang-format off
+static const KernelTable kScalarKernels = {
+    TransformPointsScalar,
+    MultiplyMatricesScalar,
+    ComposeTRSScalar,
+    TransformAABBsScalar,
+};
+
+#if defined(PPX_MATH_KERNELS_X86)
+static const KernelTable kSSE2Kernels = {
+    TransformPointsSSE2,
+    MultiplyMatricesSSE2,
+    ComposeTRSSSE2,
+    TransformAABBsSSE2,
+};
+
+static const KernelTable kAVX2Kernels = {
+    TransformPointsAVX2,
+    MultiplyMatricesAVX2,
+    ComposeTRSAVX2,
+    TransformAABBsAVX2,
+};
+#endif
+
+#if defined(PPX_MATH_KERNELS_NEON)
+static const KernelTable kNEONKernels = {
+    TransformPointsNEON,
+    MultiplyMatricesNEON,
+    ComposeTRSNEON,
+    TransformAABBsNEON,
+};
+#endif
+// clang-format on
+
+static const KernelTable* GetKernelTable(InstructionSet value)
+{
+    switch (value) {
+        default: break;
+#if defined(PPX_MATH_KERNELS_X86)
+        case INSTRUCTION_SET_SSE2: return &kSSE2Kernels;
+        case INSTRUCTION_SET_AVX2: return &kAVX2Kernels;
+#endif
+#if defined(PPX_MATH_KERNELS_NEON)
+        case INSTRUCTION_SET_NEON: return &kNEONKernels;
+#endif
+    }
+    return &kScalarKernels;
+}
+
+struct Dispatch
+{
+    InstructionSet     instructionSet = INSTRUCTION_SET_SCALAR;
+    const KernelTable* pKernels       = &kScalarKernels;
+};
+
+static Dispatch& GetDispatch()
+{
+    static Dispatch sDispatch = []() {
+        Dispatch dispatch;
+        dispatch.instructionSet = GetBestInstructionSet();
+        dispatch.pKernels       = GetKernelTable(dispatch.instructionSet);
+        return dispatch;
+    }();
+    return sDispatch;
+}
+
+static const KernelTable& Kernels()
+{
+    return *GetDispatch().pKernels;
+}
+
+InstructionSet GetInstructionSet()
+{
+    return GetDispatch().instructionSet;
+}
+
+bool SetInstructionSet(InstructionSet value)
+{
+    if (!IsSupported(value)) {
+        return false;
+    }
+    Dispatch& dispatch      = GetDispatch();
+    dispatch.instructionSet = value;
+    dispatch.pKernels       = GetKernelTable(value);
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Kernels
+// -------------------------------------------------------------------------------------------------
+
+void TransformPoints(const float4x4& matrix, const float3* pSrc, float3* pDst, size_t count)
+{
+    Kernels().transformPoints(matrix, pSrc, pDst, count);
+}
+
+void MultiplyMatrices(const float4x4& a, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    Kernels().multiplyMatrices(&a, 0, pB, pDst, count);
+}
+
+void MultiplyMatrices(const float4x4* pA, const float4x4* pB, float4x4* pDst, size_t count)
+{
+    Kernels().multiplyMatrices(pA, 1, pB, pDst, count);
+}
+
+void ComposeTRS(const float3* pTranslations, const quat* pRotations, const float3* pScales, float4x4* pDst, size_t count)
+{
+    Kernels().composeTRS(pTranslations, pRotations, pScales, pDst, count);
+}
+
+void TransformAABBs(const float4x4& matrix, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    Kernels().transformAABBs(&matrix, 0, pSrc, pDst, count);
+}
+
+void TransformAABBs(const float4x4* pMatrices, const AABB* pSrc, AABB* pDst, size_t count)
+{
+    Kernels().transformAABBs(pMatrices, 1, pSrc, pDst, count);
+}
+
+} // namespace math_kernels
+} // namespace ppx
@@ -0,0 +1,82 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/parallel.h"
+
+namespace ppx {
+
+TaskQueue::TaskQueue(uint32_t threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = GetHardwareThreadCount();
+    }
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        mThreads.emplace_back(&TaskQueue::WorkerMain, this);
+    }
+}
+
+TaskQueue::~TaskQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mTaskAvailable.notify_all();
+    for (std::thread& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void TaskQueue::Push(std::function<void()>&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push_back(std::move(task));
+    }
+    mTaskAvailable.notify_one();
+}
+
+void TaskQueue::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdle.wait(lock, [this]() { return mTasks.empty() && (mRunningCount == 0); });
+}
+
+void TaskQueue::WorkerMain()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mTaskAvailable.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+        // Queued tasks still run when stopping, their futures would
+        // otherwise never be ready
+        if (mTasks.empty()) {
+            return;
+        }
+
+        std::function<void()> task = std::move(mTasks.front());
+        mTasks.pop_front();
+        ++mRunningCount;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --mRunningCount;
+        if (mTasks.empty() && (mRunningCount == 0)) {
+            mIdle.notify_all();
+        }
+    }
+}
+
+} // namespace ppx
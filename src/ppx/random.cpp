@@ -0,0 +1,494 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/random.h"
+#include "ppx/config.h"
+
+#include <algorithm>
+
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define PPX_RANDOM_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define PPX_TARGET_AVX2
+#   else
+#       define PPX_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#   define PPX_RANDOM_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+
+// Philox4x32 constants, from "Parallel random numbers: as easy as 1, 2, 3"
+// (Salmon et al. 2011).
+static const uint32_t kPhiloxM0     = 0xD2511F53;
+static const uint32_t kPhiloxM1     = 0xCD9E8D57;
+static const uint32_t kPhiloxW0     = 0x9E3779B9;
+static const uint32_t kPhiloxW1     = 0xBB67AE85;
+static const uint32_t kPhiloxRounds = 10;
+
+// 24 random bits to [0, 1)
+static const float kFloatScale = 1.0f / 16777216.0f;
+
+// Values converted to floats per FillUInt32() call, a multiple of the range period
+static const uint32_t kFloatChunkSize = 768;
+
+static inline uint32_t Lo32(uint64_t value)
+{
+    return static_cast<uint32_t>(value);
+}
+
+static inline uint32_t Hi32(uint64_t value)
+{
+    return static_cast<uint32_t>(value >> 32);
+}
+
+// -------------------------------------------------------------------------------------------------
+// Scalar
+// -------------------------------------------------------------------------------------------------
+
+// Counter is (block, stream), key is the seed.
+static void GenerateBlocksScalar(uint64_t seed, uint64_t stream, uint64_t firstBlock, size_t blockCount, uint32_t* pValues)
+{
+    for (size_t i = 0; i < blockCount; ++i) {
+        const uint64_t block = firstBlock + i;
+        uint32_t       c0    = Lo32(block);
+        uint32_t       c1    = Hi32(block);
+        uint32_t       c2    = Lo32(stream);
+        uint32_t       c3    = Hi32(stream);
+        uint32_t       k0    = Lo32(seed);
+        uint32_t       k1    = Hi32(seed);
+        for (uint32_t round = 0; round < kPhiloxRounds; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(kPhiloxM0) * c0;
+            const uint64_t p1 = static_cast<uint64_t>(kPhiloxM1) * c2;
+            c0                = Hi32(p1) ^ c1 ^ k0;
+            c1                = Lo32(p1);
+            c2                = Hi32(p0) ^ c3 ^ k1;
+            c3                = Lo32(p0);
+            k0 += kPhiloxW0;
+            k1 += kPhiloxW1;
+        }
+        pValues[4 * i + 0] = c0;
+        pValues[4 * i + 1] = c1;
+        pValues[4 * i + 2] = c2;
+        pValues[4 * i + 3] = c3;
+    }
+}
+
+static void ConvertFloatsScalar(const uint32_t* pSrc, float* pDst, size_t count, const float* pOffsets, const float* pScales)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const float u = static_cast<float>(pSrc[i] >> 8) * kFloatScale;
+        pDst[i]       = pOffsets[i % 24] + pScales[i % 24] * u;
+    }
+}
+
+#if defined(PPX_RANDOM_X86)
+
+// -------------------------------------------------------------------------------------------------
+// SSE2
+// -------------------------------------------------------------------------------------------------
+
+// One round on 2 blocks, one per 64-bit lane. Only the low 32 bits of each
+// lane are meaningful: _mm_mul_epu32 ignores the high ones, so the products
+// don't need to be repacked between rounds.
+static inline void PhiloxRound(__m128i* c, __m128i k0, __m128i k1)
+{
+    const __m128i p0 = _mm_mul_epu32(c[0], _mm_set1_epi32(static_cast<int>(kPhiloxM0)));
+    const __m128i p1 = _mm_mul_epu32(c[2], _mm_set1_epi32(static_cast<int>(kPhiloxM1)));
+    c[0]             = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi64(p1, 32), c[1]), k0);
+    c[1]             = p1;
+    c[2]             = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi64(p0, 32), c[3]), k1);
+    c[3]             = p0;
+}
+
+static inline void InitializeBlocks(uint64_t stream, uint64_t firstBlock, __m128i* c)
+{
+    c[0] = _mm_set_epi64x(static_cast<int64_t>(firstBlock + 1), static_cast<int64_t>(firstBlock));
+    c[1] = _mm_srli_epi64(c[0], 32);
+    c[2] = _mm_set1_epi32(static_cast<int>(Lo32(stream)));
+    c[3] = _mm_set1_epi32(static_cast<int>(Hi32(stream)));
+}
+
+static inline void StoreBlocks(const __m128i* c, uint32_t* pValues)
+{
+    // Words 0 and 1, then words 2 and 3, of both blocks
+    const __m128i c01 = _mm_unpacklo_epi32(_mm_shuffle_epi32(c[0], _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(c[1], _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m128i c23 = _mm_unpacklo_epi32(_mm_shuffle_epi32(c[2], _MM_SHUFFLE(3, 1, 2, 0)), _mm_shuffle_epi32(c[3], _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pValues) + 0, _mm_unpacklo_epi64(c01, c23));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pValues) + 1, _mm_unpackhi_epi64(c01, c23));
+}
+
+// 4 blocks at a time, as 2 independent sets of 2 to hide multiply latency.
+static void GenerateBlocksSSE2(uint64_t seed, uint64_t stream, uint64_t firstBlock, size_t blockCount, uint32_t* pValues)
+{
+    size_t i = 0;
+    for (; i + 4 <= blockCount; i += 4) {
+        __m128i a[4];
+        __m128i b[4];
+        InitializeBlocks(stream, firstBlock + i, a);
+        InitializeBlocks(stream, firstBlock + i + 2, b);
+        __m128i k0 = _mm_set1_epi32(static_cast<int>(Lo32(seed)));
+        __m128i k1 = _mm_set1_epi32(static_cast<int>(Hi32(seed)));
+        for (uint32_t round = 0; round < kPhiloxRounds; ++round) {
+            PhiloxRound(a, k0, k1);
+            PhiloxRound(b, k0, k1);
+            k0 = _mm_add_epi32(k0, _mm_set1_epi32(static_cast<int>(kPhiloxW0)));
+            k1 = _mm_add_epi32(k1, _mm_set1_epi32(static_cast<int>(kPhiloxW1)));
+        }
+        StoreBlocks(a, pValues + 4 * i);
+        StoreBlocks(b, pValues + 4 * i + 8);
+    }
+    GenerateBlocksScalar(seed, stream, firstBlock + i, blockCount - i, pValues + 4 * i);
+}
+
+static void ConvertFloatsSSE2(const uint32_t* pSrc, float* pDst, size_t count, const float* pOffsets, const float* pScales)
+{
+    const __m128 scale = _mm_set1_ps(kFloatScale);
+
+    size_t i = 0;
+    for (; i + 24 <= count; i += 24) {
+        for (size_t j = 0; j < 24; j += 4) {
+            const __m128i bits = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + j)), 8);
+            const __m128  u    = _mm_mul_ps(_mm_cvtepi32_ps(bits), scale);
+            _mm_storeu_ps(pDst + i + j, _mm_add_ps(_mm_loadu_ps(pOffsets + j), _mm_mul_ps(_mm_loadu_ps(pScales + j), u)));
+        }
+    }
+    ConvertFloatsScalar(pSrc + i, pDst + i, count - i, pOffsets, pScales);
+}
+
+// -------------------------------------------------------------------------------------------------
+// AVX2
+// -------------------------------------------------------------------------------------------------
+
+PPX_TARGET_AVX2 static inline void PhiloxRound(__m256i* c, __m256i k0, __m256i k1)
+{
+    const __m256i p0 = _mm256_mul_epu32(c[0], _mm256_set1_epi32(static_cast<int>(kPhiloxM0)));
+    const __m256i p1 = _mm256_mul_epu32(c[2], _mm256_set1_epi32(static_cast<int>(kPhiloxM1)));
+    c[0]             = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c[1]), k0);
+    c[1]             = p1;
+    c[2]             = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c[3]), k1);
+    c[3]             = p0;
+}
+
+PPX_TARGET_AVX2 static inline void InitializeBlocks(uint64_t stream, uint64_t firstBlock, __m256i* c)
+{
+    c[0] = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<int64_t>(firstBlock)), _mm256_set_epi64x(3, 2, 1, 0));
+    c[1] = _mm256_srli_epi64(c[0], 32);
+    c[2] = _mm256_set1_epi32(static_cast<int>(Lo32(stream)));
+    c[3] = _mm256_set1_epi32(static_cast<int>(Hi32(stream)));
+}
+
+PPX_TARGET_AVX2 static inline void StoreBlocks(const __m256i* c, uint32_t* pValues)
+{
+    // Same as SSE2 within each half, which hold blocks 0, 1 and 2, 3
+    const __m256i c01 = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(c[0], _MM_SHUFFLE(3, 1, 2, 0)), _mm256_shuffle_epi32(c[1], _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m256i c23 = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(c[2], _MM_SHUFFLE(3, 1, 2, 0)), _mm256_shuffle_epi32(c[3], _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m256i r02 = _mm256_unpacklo_epi64(c01, c23);
+    const __m256i r13 = _mm256_unpackhi_epi64(c01, c23);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pValues) + 0, _mm256_permute2x128_si256(r02, r13, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pValues) + 1, _mm256_permute2x128_si256(r02, r13, 0x31));
+}
+
+// 8 blocks at a time, as 2 independent sets of 4.
+PPX_TARGET_AVX2 static void GenerateBlocksAVX2(uint64_t seed, uint64_t stream, uint64_t firstBlock, size_t blockCount, uint32_t* pValues)
+{
+    size_t i = 0;
+    for (; i + 8 <= blockCount; i += 8) {
+        __m256i a[4];
+        __m256i b[4];
+        InitializeBlocks(stream, firstBlock + i, a);
+        InitializeBlocks(stream, firstBlock + i + 4, b);
+        __m256i k0 = _mm256_set1_epi32(static_cast<int>(Lo32(seed)));
+        __m256i k1 = _mm256_set1_epi32(static_cast<int>(Hi32(seed)));
+        for (uint32_t round = 0; round < kPhiloxRounds; ++round) {
+            PhiloxRound(a, k0, k1);
+            PhiloxRound(b, k0, k1);
+            k0 = _mm256_add_epi32(k0, _mm256_set1_epi32(static_cast<int>(kPhiloxW0)));
+            k1 = _mm256_add_epi32(k1, _mm256_set1_epi32(static_cast<int>(kPhiloxW1)));
+        }
+        StoreBlocks(a, pValues + 4 * i);
+        StoreBlocks(b, pValues + 4 * i + 16);
+    }
+    GenerateBlocksSSE2(seed, stream, firstBlock + i, blockCount - i, pValues + 4 * i);
+}
+
+PPX_TARGET_AVX2 static void ConvertFloatsAVX2(const uint32_t* pSrc, float* pDst, size_t count, const float* pOffsets, const float* pScales)
+{
+    const __m256 scale = _mm256_set1_ps(kFloatScale);
+
+    size_t i = 0;
+    for (; i + 24 <= count; i += 24) {
+        for (size_t j = 0; j < 24; j += 8) {
+            const __m256i bits = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i + j)), 8);
+            const __m256  u    = _mm256_mul_ps(_mm256_cvtepi32_ps(bits), scale);
+            _mm256_storeu_ps(pDst + i + j, _mm256_add_ps(_mm256_loadu_ps(pOffsets + j), _mm256_mul_ps(_mm256_loadu_ps(pScales + j), u)));
+        }
+    }
+    ConvertFloatsScalar(pSrc + i, pDst + i, count - i, pOffsets, pScales);
+}
+
+#endif // defined(PPX_RANDOM_X86)
+
+#if defined(PPX_RANDOM_NEON)
+
+// -------------------------------------------------------------------------------------------------
+// NEON
+// -------------------------------------------------------------------------------------------------
+
+static inline void MulHiLo(uint32x4_t a, uint32_t m, uint32x4_t* pHi, uint32x4_t* pLo)
+{
+    const uint64x2_t p01 = vmull_n_u32(vget_low_u32(a), m);
+    const uint64x2_t p23 = vmull_n_u32(vget_high_u32(a), m);
+    *pLo                 = vcombine_u32(vmovn_u64(p01), vmovn_u64(p23));
+    *pHi                 = vcombine_u32(vshrn_n_u64(p01, 32), vshrn_n_u64(p23, 32));
+}
+
+static void GenerateBlocksNEON(uint64_t seed, uint64_t stream, uint64_t firstBlock, size_t blockCount, uint32_t* pValues)
+{
+    size_t i = 0;
+    for (; i + 4 <= blockCount; i += 4) {
+        const uint64_t b     = firstBlock + i;
+        const uint32_t lo[4] = {Lo32(b), Lo32(b + 1), Lo32(b + 2), Lo32(b + 3)};
+        const uint32_t hi[4] = {Hi32(b), Hi32(b + 1), Hi32(b + 2), Hi32(b + 3)};
+        uint32x4x4_t   c;
+        c.val[0]    = vld1q_u32(lo);
+        c.val[1]    = vld1q_u32(hi);
+        c.val[2]    = vdupq_n_u32(Lo32(stream));
+        c.val[3]    = vdupq_n_u32(Hi32(stream));
+        uint32_t k0 = Lo32(seed);
+        uint32_t k1 = Hi32(seed);
+        for (uint32_t round = 0; round < kPhiloxRounds; ++round) {
+            uint32x4_t hi0, lo0, hi1, lo1;
+            MulHiLo(c.val[0], kPhiloxM0, &hi0, &lo0);
+            MulHiLo(c.val[2], kPhiloxM1, &hi1, &lo1);
+            c.val[0] = veorq_u32(veorq_u32(hi1, c.val[1]), vdupq_n_u32(k0));
+            c.val[1] = lo1;
+            c.val[2] = veorq_u32(veorq_u32(hi0, c.val[3]), vdupq_n_u32(k1));
+            c.val[3] = lo0;
+            k0 += kPhiloxW0;
+            k1 += kPhiloxW1;
+        }
+        // Interleaving the 4 words gives the blocks one after the other
+        vst4q_u32(pValues + 4 * i, c);
+    }
+    GenerateBlocksScalar(seed, stream, firstBlock + i, blockCount - i, pValues + 4 * i);
+}
+
+static void ConvertFloatsNEON(const uint32_t* pSrc, float* pDst, size_t count, const float* pOffsets, const float* pScales)
+{
+    size_t i = 0;
+    for (; i + 24 <= count; i += 24) {
+        for (size_t j = 0; j < 24; j += 4) {
+            const float32x4_t u = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(vld1q_u32(pSrc + i + j), 8)), kFloatScale);
+            vst1q_f32(pDst + i + j, vaddq_f32(vld1q_f32(pOffsets + j), vmulq_f32(vld1q_f32(pScales + j), u)));
+        }
+    }
+    ConvertFloatsScalar(pSrc + i, pDst + i, count - i, pOffsets, pScales);
+}
+
+#endif // defined(PPX_RANDOM_NEON)
+
+// -------------------------------------------------------------------------------------------------
+// RandomStream
+// -------------------------------------------------------------------------------------------------
+RandomStream::RandomStream(uint64_t seed, uint64_t stream)
+{
+    Seed(seed, stream);
+}
+
+void RandomStream::Seed(uint64_t seed, uint64_t stream)
+{
+    mSeed        = seed;
+    mStream      = stream;
+    mPosition    = 0;
+    mBufferBlock = UINT64_MAX;
+}
+
+RandomStream RandomStream::Split(uint64_t stream) const
+{
+    RandomStream result(mSeed, stream);
+    result.mInstructionSet = mInstructionSet;
+    return result;
+}
+
+void RandomStream::Discard(uint64_t count)
+{
+    mPosition += count;
+}
+
+bool RandomStream::SetInstructionSet(InstructionSet value)
+{
+    if (!IsSupported(value)) {
+        return false;
+    }
+    mInstructionSet = value;
+    return true;
+}
+
+void RandomStream::GenerateBlocks(uint64_t firstBlock, size_t blockCount, uint32_t* pValues) const
+{
+    switch (mInstructionSet) {
+        default: break;
+#if defined(PPX_RANDOM_X86)
+        case INSTRUCTION_SET_SSE2: GenerateBlocksSSE2(mSeed, mStream, firstBlock, blockCount, pValues); return;
+        case INSTRUCTION_SET_AVX2: GenerateBlocksAVX2(mSeed, mStream, firstBlock, blockCount, pValues); return;
+#endif
+#if defined(PPX_RANDOM_NEON)
+        case INSTRUCTION_SET_NEON: GenerateBlocksNEON(mSeed, mStream, firstBlock, blockCount, pValues); return;
+#endif
+    }
+    GenerateBlocksScalar(mSeed, mStream, firstBlock, blockCount, pValues);
+}
+
+uint32_t RandomStream::UInt32()
+{
+    const uint64_t block = mPosition / 4;
+    if (block != mBufferBlock) {
+        GenerateBlocksScalar(mSeed, mStream, block, 1, mBuffer);
+        mBufferBlock = block;
+    }
+    return mBuffer[mPosition++ % 4];
+}
+
+float RandomStream::Float()
+{
+    return static_cast<float>(UInt32() >> 8) * kFloatScale;
+}
+
+float RandomStream::Float(float a, float b)
+{
+    return a + (b - a) * Float();
+}
+
+float2 RandomStream::Float2()
+{
+    const float x = Float();
+    const float y = Float();
+    return float2(x, y);
+}
+
+float3 RandomStream::Float3()
+{
+    const float x = Float();
+    const float y = Float();
+    const float z = Float();
+    return float3(x, y, z);
+}
+
+float4 RandomStream::Float4()
+{
+    const float x = Float();
+    const float y = Float();
+    const float z = Float();
+    const float w = Float();
+    return float4(x, y, z, w);
+}
+
+void RandomStream::FillUInt32(uint32_t* pValues, size_t count)
+{
+    // Finish the current block one value at a time, then whole blocks
+    while ((count > 0) && ((mPosition % 4) != 0)) {
+        *pValues++ = UInt32();
+        --count;
+    }
+
+    const size_t blockCount = count / 4;
+    GenerateBlocks(mPosition / 4, blockCount, pValues);
+    mPosition += 4 * blockCount;
+    pValues += 4 * blockCount;
+    count -= 4 * blockCount;
+
+    while (count > 0) {
+        *pValues++ = UInt32();
+        --count;
+    }
+}
+
+void RandomStream::FillFloats(float* pValues, size_t count, uint32_t componentCount, const float* pA, const float* pB)
+{
+    float offsets[kRangePeriod];
+    float scales[kRangePeriod];
+    for (uint32_t i = 0; i < kRangePeriod; ++i) {
+        offsets[i] = pA[i % componentCount];
+        scales[i]  = pB[i % componentCount] - pA[i % componentCount];
+    }
+
+    uint32_t bits[kFloatChunkSize];
+    while (count > 0) {
+        const size_t chunkSize = std::min<size_t>(count, kFloatChunkSize);
+        FillUInt32(bits, chunkSize);
+        switch (mInstructionSet) {
+            default: ConvertFloatsScalar(bits, pValues, chunkSize, offsets, scales); break;
+#if defined(PPX_RANDOM_X86)
+            case INSTRUCTION_SET_SSE2: ConvertFloatsSSE2(bits, pValues, chunkSize, offsets, scales); break;
+            case INSTRUCTION_SET_AVX2: ConvertFloatsAVX2(bits, pValues, chunkSize, offsets, scales); break;
+#endif
+#if defined(PPX_RANDOM_NEON)
+            case INSTRUCTION_SET_NEON: ConvertFloatsNEON(bits, pValues, chunkSize, offsets, scales); break;
+#endif
+        }
+        pValues += chunkSize;
+        count -= chunkSize;
+    }
+}
+
+void RandomStream::FillFloat(float* pValues, size_t count)
+{
+    FillFloat(pValues, count, 0.0f, 1.0f);
+}
+
+void RandomStream::FillFloat(float* pValues, size_t count, float a, float b)
+{
+    FillFloats(pValues, count, 1, &a, &b);
+}
+
+void RandomStream::FillFloat2(float2* pValues, size_t count)
+{
+    FillFloat2(pValues, count, float2(0.0f), float2(1.0f));
+}
+
+void RandomStream::FillFloat2(float2* pValues, size_t count, const float2& a, const float2& b)
+{
+    static_assert(sizeof(float2) == 2 * sizeof(float), "unexpected float2 layout");
+    FillFloats(&pValues->x, 2 * count, 2, &a.x, &b.x);
+}
+
+void RandomStream::FillFloat3(float3* pValues, size_t count)
+{
+    FillFloat3(pValues, count, float3(0.0f), float3(1.0f));
+}
+
+void RandomStream::FillFloat3(float3* pValues, size_t count, const float3& a, const float3& b)
+{
+    static_assert(sizeof(float3) == 3 * sizeof(float), "unexpected float3 layout");
+    FillFloats(&pValues->x, 3 * count, 3, &a.x, &b.x);
+}
+
+void RandomStream::FillFloat4(float4* pValues, size_t count)
+{
+    FillFloat4(pValues, count, float4(0.0f), float4(1.0f));
+}
+
+void RandomStream::FillFloat4(float4* pValues, size_t count, const float4& a, const float4& b)
+{
+    static_assert(sizeof(float4) == 4 * sizeof(float), "unexpected float4 layout");
+    FillFloats(&pValues->x, 4 * count, 4, &a.x, &b.x);
+}
+
+} // namespace ppx
@@ -0,0 +1,292 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/texture_atlas.h"
+
+#include <numeric>
+
+namespace ppx {
+
+namespace {
+
+// One run of constant height along the top edge of the packed area. Units are cells.
+struct SkylineSegment
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+};
+
+using Skyline = std::vector<SkylineSegment>;
+
+// Bottom-left rule: pick the position that keeps the top of the rect lowest,
+// leftmost on ties. Returns false if the rect doesn't fit anywhere.
+bool FindPosition(const Skyline& skyline, uint32_t layerWidth, uint32_t layerHeight, uint32_t width, uint32_t height, size_t* pSegment, uint32_t* pY)
+{
+    bool     found   = false;
+    uint32_t bestTop = UINT32_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const uint32_t x = skyline[i].x;
+        if (x + width > layerWidth) {
+            break;
+        }
+
+        // The rect rests on the highest segment it spans
+        uint32_t y         = 0;
+        uint32_t remaining = width;
+        for (size_t j = i; (j < skyline.size()) && (remaining > 0); ++j) {
+            y         = std::max(y, skyline[j].y);
+            remaining = (skyline[j].width >= remaining) ? 0 : (remaining - skyline[j].width);
+        }
+
+        if ((y + height <= layerHeight) && (y + height < bestTop)) {
+            found     = true;
+            bestTop   = y + height;
+            *pSegment = i;
+            *pY       = y;
+        }
+    }
+    return found;
+}
+
+void InsertRect(Skyline& skyline, size_t segment, uint32_t y, uint32_t width, uint32_t height)
+{
+    const uint32_t x     = skyline[segment].x;
+    const uint32_t right = x + width;
+    skyline.insert(skyline.begin() + segment, SkylineSegment{x, y + height, width});
+
+    // Trim or remove the segments now covered by the rect
+    size_t next = segment + 1;
+    while (next < skyline.size()) {
+        SkylineSegment& s = skyline[next];
+        if (s.x >= right) {
+            break;
+        }
+        if (s.x + s.width <= right) {
+            skyline.erase(skyline.begin() + next);
+            continue;
+        }
+        s.width -= right - s.x;
+        s.x     = right;
+        break;
+    }
+
+    // Merge neighbours of equal height
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+} // namespace
+
+Result TextureAtlas::Create(const TextureAtlasCreateInfo& createInfo, TextureAtlas* pAtlas)
+{
+    PPX_ASSERT_NULL_ARG(pAtlas);
+    if (IsNull(pAtlas)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((createInfo.width == 0) || (createInfo.height == 0) || (createInfo.maxLayerCount == 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+    if (createInfo.format == Bitmap::FORMAT_UNDEFINED) {
+        return ppx::ERROR_IMAGE_INVALID_FORMAT;
+    }
+    if ((createInfo.alignment == 0) || ((createInfo.width % createInfo.alignment) != 0) || ((createInfo.height % createInfo.alignment) != 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    *pAtlas             = TextureAtlas();
+    pAtlas->mCreateInfo = createInfo;
+
+    return ppx::SUCCESS;
+}
+
+uint32_t TextureAtlas::CalculateMipPadding(uint32_t mipLevelCount)
+{
+    return (mipLevelCount > 0) ? (1u << (mipLevelCount - 1)) : 0;
+}
+
+Result TextureAtlas::AddBitmap(const Bitmap* pBitmap, uint32_t* pIndex)
+{
+    PPX_ASSERT_NULL_ARG(pBitmap);
+    if (IsNull(pBitmap)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if (mBuilt) {
+        PPX_ASSERT_MSG(false, "bitmaps cannot be added to an atlas after Build()");
+        return ppx::ERROR_FAILED;
+    }
+    if ((pBitmap->GetWidth() == 0) || (pBitmap->GetHeight() == 0)) {
+        return ppx::ERROR_BITMAP_BAD_COPY_SOURCE;
+    }
+
+    const uint32_t paddedWidth  = pBitmap->GetWidth() + 2 * mCreateInfo.padding;
+    const uint32_t paddedHeight = pBitmap->GetHeight() + 2 * mCreateInfo.padding;
+    if ((paddedWidth > mCreateInfo.width) || (paddedHeight > mCreateInfo.height)) {
+        return ppx::ERROR_LIMIT_EXCEEDED;
+    }
+
+    Bitmap copy;
+    Result ppxres = Bitmap::Create(pBitmap->GetWidth(), pBitmap->GetHeight(), mCreateInfo.format, &copy);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+    ppxres = pBitmap->ConvertTo(&copy);
+    if (Failed(ppxres)) {
+        return ppxres;
+    }
+
+    if (!IsNull(pIndex)) {
+        *pIndex = CountU32(mSources);
+    }
+    mSources.push_back(std::move(copy));
+
+    return ppx::SUCCESS;
+}
+
+Result TextureAtlas::Build()
+{
+    if (mBuilt) {
+        return ppx::SUCCESS;
+    }
+
+    const uint32_t alignment   = mCreateInfo.alignment;
+    const uint32_t padding     = mCreateInfo.padding;
+    const uint32_t layerWidth  = mCreateInfo.width / alignment;
+    const uint32_t layerHeight = mCreateInfo.height / alignment;
+
+    // Tallest first gives the skyline the fewest holes
+    std::vector<uint32_t> order(mSources.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        if (mSources[a].GetHeight() != mSources[b].GetHeight()) {
+            return mSources[a].GetHeight() > mSources[b].GetHeight();
+        }
+        return mSources[a].GetWidth() > mSources[b].GetWidth();
+    });
+
+    std::vector<Entry>   entries(mSources.size());
+    std::vector<Skyline> skylines;
+    for (uint32_t index : order) {
+        const Bitmap&  src        = mSources[index];
+        const uint32_t cellWidth  = (src.GetWidth() + 2 * padding + alignment - 1) / alignment;
+        const uint32_t cellHeight = (src.GetHeight() + 2 * padding + alignment - 1) / alignment;
+
+        size_t   segment = 0;
+        uint32_t cellY   = 0;
+        uint32_t layer   = 0;
+        for (; layer < CountU32(skylines); ++layer) {
+            if (FindPosition(skylines[layer], layerWidth, layerHeight, cellWidth, cellHeight, &segment, &cellY)) {
+                break;
+            }
+        }
+        if (layer == CountU32(skylines)) {
+            if (layer == mCreateInfo.maxLayerCount) {
+                return ppx::ERROR_LIMIT_EXCEEDED;
+            }
+            skylines.push_back(Skyline{SkylineSegment{0, 0, layerWidth}});
+            if (!FindPosition(skylines[layer], layerWidth, layerHeight, cellWidth, cellHeight, &segment, &cellY)) {
+                return ppx::ERROR_LIMIT_EXCEEDED;
+            }
+        }
+
+        Entry& entry = entries[index];
+        entry.layer  = layer;
+        entry.x      = skylines[layer][segment].x * alignment + padding;
+        entry.y      = cellY * alignment + padding;
+        entry.width  = src.GetWidth();
+        entry.height = src.GetHeight();
+
+        InsertRect(skylines[layer], segment, cellY, cellWidth, cellHeight);
+    }
+
+    // Unused texels stay zero
+    mLayers.resize(skylines.size());
+    for (Bitmap& layer : mLayers) {
+        Result ppxres = Bitmap::Create(mCreateInfo.width, mCreateInfo.height, mCreateInfo.format, &layer);
+        if (Failed(ppxres)) {
+            return ppxres;
+        }
+        std::memset(layer.GetData(), 0, layer.GetFootprintSize());
+    }
+
+    const float invWidth  = 1.0f / static_cast<float>(mCreateInfo.width);
+    const float invHeight = 1.0f / static_cast<float>(mCreateInfo.height);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        Entry& entry      = entries[i];
+        entry.uvTransform = float4(
+            static_cast<float>(entry.width) * invWidth,
+            static_cast<float>(entry.height) * invHeight,
+            static_cast<float>(entry.x) * invWidth,
+            static_cast<float>(entry.y) * invHeight);
+        CopyEntry(mSources[i], entry);
+    }
+
+    mEntries = std::move(entries);
+    mBuilt   = true;
+
+    // Sources are no longer needed
+    mSources.clear();
+    mSources.shrink_to_fit();
+
+    return ppx::SUCCESS;
+}
+
+void TextureAtlas::CopyEntry(const Bitmap& src, const Entry& entry)
+{
+    Bitmap&        dst         = mLayers[entry.layer];
+    const uint32_t padding     = mCreateInfo.padding;
+    const uint32_t pixelStride = dst.GetPixelStride();
+    const size_t   rowSize     = static_cast<size_t>(entry.width) * pixelStride;
+
+    // Rows above and below the entry repeat its first and last row, and every
+    // row repeats its first and last pixel to the left and right.
+    const uint32_t firstRow = entry.y - padding;
+    const uint32_t lastRow  = entry.y + entry.height + padding;
+    for (uint32_t y = firstRow; y < lastRow; ++y) {
+        const uint32_t srcY   = std::min(std::max(y, entry.y), entry.y + entry.height - 1) - entry.y;
+        const char*    pSrc   = src.GetPixelAddress(0, srcY);
+        char*          pDst   = dst.GetPixelAddress(entry.x, y);
+        const char*    pLast  = pSrc + rowSize - pixelStride;
+        char*          pRight = pDst + rowSize;
+
+        std::memcpy(pDst, pSrc, rowSize);
+        for (uint32_t i = 1; i <= padding; ++i) {
+            std::memcpy(pDst - i * pixelStride, pSrc, pixelStride);
+            std::memcpy(pRight + (i - 1) * pixelStride, pLast, pixelStride);
+        }
+    }
+}
+
+float TextureAtlas::GetOccupancy() const
+{
+    if (mLayers.empty()) {
+        return 0;
+    }
+
+    uint64_t used = 0;
+    for (const Entry& entry : mEntries) {
+        used += static_cast<uint64_t>(entry.width) * entry.height;
+    }
+    const uint64_t total = static_cast<uint64_t>(mCreateInfo.width) * mCreateInfo.height * mLayers.size();
+    return static_cast<float>(static_cast<double>(used) / static_cast<double>(total));
+}
+
+} // namespace ppx
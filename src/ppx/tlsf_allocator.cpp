@@ -0,0 +1,268 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/tlsf_allocator.h"
+
+#include <bit>
+
+namespace ppx {
+
+Result TLSFAllocator::Create(uint64_t size, uint64_t granularity, TLSFAllocator* pAllocator)
+{
+    PPX_ASSERT_NULL_ARG(pAllocator);
+    if (IsNull(pAllocator)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((granularity == 0) || !std::has_single_bit(granularity) || (size < granularity) || ((size % granularity) != 0)) {
+        return ppx::ERROR_INVALID_CREATE_ARGUMENT;
+    }
+
+    *pAllocator              = TLSFAllocator();
+    pAllocator->mSize        = size;
+    pAllocator->mGranularity = granularity;
+    for (uint32_t fl = 0; fl < kFLCount; ++fl) {
+        std::fill_n(pAllocator->mFreeHeads[fl], kSLCount, kInvalidHandle);
+    }
+
+    // The whole range starts as one free node
+    uint32_t handle                   = pAllocator->NewNode();
+    pAllocator->mNodes[handle].offset = 0;
+    pAllocator->mNodes[handle].size   = size;
+    pAllocator->InsertFree(handle);
+
+    return ppx::SUCCESS;
+}
+
+void TLSFAllocator::Mapping(uint64_t size, uint32_t* pFL, uint32_t* pSL)
+{
+    if (size < kSLCount) {
+        *pFL = 0;
+        *pSL = static_cast<uint32_t>(size);
+        return;
+    }
+    const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+    *pFL                = log2 - kSLLog2 + 1;
+    *pSL                = static_cast<uint32_t>(size >> (log2 - kSLLog2)) - kSLCount;
+}
+
+uint32_t TLSFAllocator::NewNode()
+{
+    if (!mUnusedNodes.empty()) {
+        uint32_t handle = mUnusedNodes.back();
+        mUnusedNodes.pop_back();
+        mNodes[handle] = Node();
+        return handle;
+    }
+    mNodes.emplace_back();
+    return CountU32(mNodes) - 1;
+}
+
+void TLSFAllocator::ReleaseNode(uint32_t handle)
+{
+    mNodes[handle].size = 0;
+    mUnusedNodes.push_back(handle);
+}
+
+void TLSFAllocator::InsertFree(uint32_t handle)
+{
+    Node& node = mNodes[handle];
+
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    Mapping(node.size, &fl, &sl);
+
+    node.free     = true;
+    node.prevFree = kInvalidHandle;
+    node.nextFree = mFreeHeads[fl][sl];
+    if (node.nextFree != kInvalidHandle) {
+        mNodes[node.nextFree].prevFree = handle;
+    }
+    mFreeHeads[fl][sl] = handle;
+
+    mFLBitmap |= (1ull << fl);
+    mSLBitmaps[fl] |= (1u << sl);
+}
+
+void TLSFAllocator::RemoveFree(uint32_t handle)
+{
+    Node& node = mNodes[handle];
+
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    Mapping(node.size, &fl, &sl);
+
+    if (node.prevFree != kInvalidHandle) {
+        mNodes[node.prevFree].nextFree = node.nextFree;
+    }
+    else {
+        mFreeHeads[fl][sl] = node.nextFree;
+    }
+    if (node.nextFree != kInvalidHandle) {
+        mNodes[node.nextFree].prevFree = node.prevFree;
+    }
+
+    // Clear the bin bits if it's now empty
+    if (mFreeHeads[fl][sl] == kInvalidHandle) {
+        mSLBitmaps[fl] &= ~(1u << sl);
+        if (mSLBitmaps[fl] == 0) {
+            mFLBitmap &= ~(1ull << fl);
+        }
+    }
+
+    node.free     = false;
+    node.prevFree = kInvalidHandle;
+    node.nextFree = kInvalidHandle;
+}
+
+uint32_t TLSFAllocator::FindFree(uint64_t size) const
+{
+    // Round up to the next class so that any node in the bin is large enough
+    uint64_t roundedSize = size;
+    if (size >= kSLCount) {
+        const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+        roundedSize += (1ull << (log2 - kSLLog2)) - 1;
+    }
+
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    Mapping(roundedSize, &fl, &sl);
+    if (fl < kFLCount) {
+        uint32_t       slBitmap = mSLBitmaps[fl] & (~0u << sl);
+        const uint64_t flBitmap = (fl + 1 < 64) ? (mFLBitmap & (~0ull << (fl + 1))) : 0;
+        if ((slBitmap != 0) || (flBitmap != 0)) {
+            if (slBitmap == 0) {
+                fl       = static_cast<uint32_t>(std::countr_zero(flBitmap));
+                slBitmap = mSLBitmaps[fl];
+            }
+            sl = static_cast<uint32_t>(std::countr_zero(slBitmap));
+            return mFreeHeads[fl][sl];
+        }
+    }
+
+    // Rounding up skips the bin of the requested size itself, which may
+    // still hold a large enough node, e.g. the exact remainder of the range
+    Mapping(size, &fl, &sl);
+    if (fl >= kFLCount) {
+        return kInvalidHandle;
+    }
+    for (uint32_t handle = mFreeHeads[fl][sl]; handle != kInvalidHandle; handle = mNodes[handle].nextFree) {
+        if (mNodes[handle].size >= size) {
+            return handle;
+        }
+    }
+
+    return kInvalidHandle;
+}
+
+Result TLSFAllocator::Allocate(uint64_t size, Allocation* pAllocation)
+{
+    PPX_ASSERT_NULL_ARG(pAllocation);
+    if (IsNull(pAllocation)) {
+        return ppx::ERROR_UNEXPECTED_NULL_ARGUMENT;
+    }
+    if ((size == 0) || (size > mSize)) {
+        return ppx::ERROR_OUT_OF_MEMORY;
+    }
+
+    size = RoundUp(size, mGranularity);
+
+    uint32_t handle = FindFree(size);
+    if (handle == kInvalidHandle) {
+        return ppx::ERROR_OUT_OF_MEMORY;
+    }
+    RemoveFree(handle);
+
+    // Return the remainder to the free lists
+    if (mNodes[handle].size > size) {
+        uint32_t remainder = NewNode();
+        Node&    node      = mNodes[handle];
+        Node&    rest      = mNodes[remainder];
+        rest.offset        = node.offset + size;
+        rest.size          = node.size - size;
+        rest.prevPhys      = handle;
+        rest.nextPhys      = node.nextPhys;
+        if (rest.nextPhys != kInvalidHandle) {
+            mNodes[rest.nextPhys].prevPhys = remainder;
+        }
+        node.size     = size;
+        node.nextPhys = remainder;
+        InsertFree(remainder);
+    }
+
+    mUsedSize += size;
+    mAllocationCount += 1;
+
+    pAllocation->offset = mNodes[handle].offset;
+    pAllocation->size   = size;
+    pAllocation->handle = handle;
+
+    return ppx::SUCCESS;
+}
+
+void TLSFAllocator::Free(uint32_t handle)
+{
+    if ((handle >= CountU32(mNodes)) || mNodes[handle].free || (mNodes[handle].size == 0)) {
+        PPX_ASSERT_MSG(false, "invalid TLSF allocation handle: " << handle);
+        return;
+    }
+
+    mUsedSize -= mNodes[handle].size;
+    mAllocationCount -= 1;
+
+    // Merge with the previous range
+    uint32_t prev = mNodes[handle].prevPhys;
+    if ((prev != kInvalidHandle) && mNodes[prev].free) {
+        RemoveFree(prev);
+        mNodes[prev].size += mNodes[handle].size;
+        mNodes[prev].nextPhys = mNodes[handle].nextPhys;
+        if (mNodes[prev].nextPhys != kInvalidHandle) {
+            mNodes[mNodes[prev].nextPhys].prevPhys = prev;
+        }
+        ReleaseNode(handle);
+        handle = prev;
+    }
+
+    // Merge with the next range
+    uint32_t next = mNodes[handle].nextPhys;
+    if ((next != kInvalidHandle) && mNodes[next].free) {
+        RemoveFree(next);
+        mNodes[handle].size += mNodes[next].size;
+        mNodes[handle].nextPhys = mNodes[next].nextPhys;
+        if (mNodes[handle].nextPhys != kInvalidHandle) {
+            mNodes[mNodes[handle].nextPhys].prevPhys = handle;
+        }
+        ReleaseNode(next);
+    }
+
+    InsertFree(handle);
+}
+
+uint64_t TLSFAllocator::GetLargestFreeRange() const
+{
+    if (mFLBitmap == 0) {
+        return 0;
+    }
+
+    // Nodes in the highest non-empty bin are larger than all others but not
+    // sorted within the bin
+    const uint32_t fl      = 63 - static_cast<uint32_t>(std::countl_zero(mFLBitmap));
+    const uint32_t sl      = 31 - static_cast<uint32_t>(std::countl_zero(mSLBitmaps[fl]));
+    uint64_t       largest = 0;
+    for (uint32_t handle = mFreeHeads[fl][sl]; handle != kInvalidHandle; handle = mNodes[handle].nextFree) {
+        largest = std::max(largest, mNodes[handle].size);
+    }
+    return largest;
+}
+
+} // namespace ppx
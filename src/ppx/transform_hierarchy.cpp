@@ -0,0 +1,569 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ppx/transform_hierarchy.h"
+#include "ppx/parallel.h"
+#include "ppx/timer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+// SSE2 and NEON are part of the x86-64 and AArch64 baselines, no runtime check is needed
+// clang-format off
+#if defined(__x86_64__) || defined(_M_X64)
+#   define PPX_TRANSFORM_HIERARCHY_SSE2
+#   include <emmintrin.h>
+#elif defined(__aarch64__)
+#   define PPX_TRANSFORM_HIERARCHY_NEON
+#   include <arm_neon.h>
+#endif
+// clang-format on
+
+namespace ppx {
+
+// Levels smaller than this are updated on the calling thread
+static const uint32_t kMinParallelLevelSize = 8192;
+
+// Slots per ParallelFor() index, a multiple of 4
+static const uint32_t kChunkSize = 2048;
+
+// -------------------------------------------------------------------------------------------------
+// Kernels
+// -------------------------------------------------------------------------------------------------
+// Same math as glm::translate(t) * glm::mat4_cast(r) * glm::scale(s).
+static void ComposeTRS(
+    float     tx,
+    float     ty,
+    float     tz,
+    float     rx,
+    float     ry,
+    float     rz,
+    float     rw,
+    float     sx,
+    float     sy,
+    float     sz,
+    float4x4* pMatrix)
+{
+    const float xx = rx * rx;
+    const float yy = ry * ry;
+    const float zz = rz * rz;
+    const float xy = rx * ry;
+    const float xz = rx * rz;
+    const float yz = ry * rz;
+    const float wx = rw * rx;
+    const float wy = rw * ry;
+    const float wz = rw * rz;
+
+    float4x4& m = *pMatrix;
+    m[0]        = float4((1.0f - 2.0f * (yy + zz)) * sx, 2.0f * (xy + wz) * sx, 2.0f * (xz - wy) * sx, 0.0f);
+    m[1]        = float4(2.0f * (xy - wz) * sy, (1.0f - 2.0f * (xx + zz)) * sy, 2.0f * (yz + wx) * sy, 0.0f);
+    m[2]        = float4(2.0f * (xz + wy) * sz, 2.0f * (yz - wx) * sz, (1.0f - 2.0f * (xx + yy)) * sz, 0.0f);
+    m[3]        = float4(tx, ty, tz, 1.0f);
+}
+
+#if defined(PPX_TRANSFORM_HIERARCHY_SSE2)
+// Composes 4 matrices from structure of arrays TRS, one node per lane.
+static void ComposeTRS4(const float* pTx, const float* pTy, const float* pTz, const float* pRx, const float* pRy, const float* pRz, const float* pRw, const float* pSx, const float* pSy, const float* pSz, float4x4* pMatrices)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 rx  = _mm_loadu_ps(pRx);
+    const __m128 ry  = _mm_loadu_ps(pRy);
+    const __m128 rz  = _mm_loadu_ps(pRz);
+    const __m128 rw  = _mm_loadu_ps(pRw);
+    const __m128 sx  = _mm_loadu_ps(pSx);
+    const __m128 sy  = _mm_loadu_ps(pSy);
+    const __m128 sz  = _mm_loadu_ps(pSz);
+    const __m128 xx  = _mm_mul_ps(rx, rx);
+    const __m128 yy  = _mm_mul_ps(ry, ry);
+    const __m128 zz  = _mm_mul_ps(rz, rz);
+    const __m128 xy  = _mm_mul_ps(rx, ry);
+    const __m128 xz  = _mm_mul_ps(rx, rz);
+    const __m128 yz  = _mm_mul_ps(ry, rz);
+    const __m128 wx  = _mm_mul_ps(rw, rx);
+    const __m128 wy  = _mm_mul_ps(rw, ry);
+    const __m128 wz  = _mm_mul_ps(rw, rz);
+
+    // Rows of the transposed matrices: c<column><component>
+    __m128 c0x = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    __m128 c0y = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    __m128 c0z = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    __m128 c0w = _mm_setzero_ps();
+    __m128 c1x = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    __m128 c1y = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    __m128 c1z = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    __m128 c1w = _mm_setzero_ps();
+    __m128 c2x = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    __m128 c2y = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    __m128 c2z = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+    __m128 c2w = _mm_setzero_ps();
+    __m128 c3x = _mm_loadu_ps(pTx);
+    __m128 c3y = _mm_loadu_ps(pTy);
+    __m128 c3z = _mm_loadu_ps(pTz);
+    __m128 c3w = one;
+    _MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+    _MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+    _MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+    _MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+
+    // After the transposes, c<column>x holds that column of the first node, etc.
+    const __m128 columns[4][4] = {
+        {c0x, c1x, c2x, c3x},
+        {c0y, c1y, c2y, c3y},
+        {c0z, c1z, c2z, c3z},
+        {c0w, c1w, c2w, c3w},
+    };
+    for (uint32_t i = 0; i < 4; ++i) {
+        float* pDst = &pMatrices[i][0][0];
+        _mm_storeu_ps(pDst + 0, columns[i][0]);
+        _mm_storeu_ps(pDst + 4, columns[i][1]);
+        _mm_storeu_ps(pDst + 8, columns[i][2]);
+        _mm_storeu_ps(pDst + 12, columns[i][3]);
+    }
+}
+
+static void Multiply(const float4x4& a, const float4x4& b, float4x4* pResult)
+{
+    const float* pA = &a[0][0];
+    const float* pB = &b[0][0];
+    const __m128 a0 = _mm_loadu_ps(pA + 0);
+    const __m128 a1 = _mm_loadu_ps(pA + 4);
+    const __m128 a2 = _mm_loadu_ps(pA + 8);
+    const __m128 a3 = _mm_loadu_ps(pA + 12);
+
+    float* pDst = &(*pResult)[0][0];
+    for (uint32_t i = 0; i < 4; ++i) {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pB[4 * i + 0]));
+        r        = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pB[4 * i + 1])));
+        r        = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pB[4 * i + 2])));
+        r        = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pB[4 * i + 3])));
+        _mm_storeu_ps(pDst + 4 * i, r);
+    }
+}
+#elif defined(PPX_TRANSFORM_HIERARCHY_NEON)
+static void ComposeTRS4(const float* pTx, const float* pTy, const float* pTz, const float* pRx, const float* pRy, const float* pRz, const float* pRw, const float* pSx, const float* pSy, const float* pSz, float4x4* pMatrices)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t two = vdupq_n_f32(2.0f);
+    const float32x4_t rx  = vld1q_f32(pRx);
+    const float32x4_t ry  = vld1q_f32(pRy);
+    const float32x4_t rz  = vld1q_f32(pRz);
+    const float32x4_t rw  = vld1q_f32(pRw);
+    const float32x4_t sx  = vld1q_f32(pSx);
+    const float32x4_t sy  = vld1q_f32(pSy);
+    const float32x4_t sz  = vld1q_f32(pSz);
+    const float32x4_t xx  = vmulq_f32(rx, rx);
+    const float32x4_t yy  = vmulq_f32(ry, ry);
+    const float32x4_t zz  = vmulq_f32(rz, rz);
+    const float32x4_t xy  = vmulq_f32(rx, ry);
+    const float32x4_t xz  = vmulq_f32(rx, rz);
+    const float32x4_t yz  = vmulq_f32(ry, rz);
+    const float32x4_t wx  = vmulq_f32(rw, rx);
+    const float32x4_t wy  = vmulq_f32(rw, ry);
+    const float32x4_t wz  = vmulq_f32(rw, rz);
+
+    // vst4q interleaves the 4 component vectors, which writes one column
+    // per node with a stride of 64 bytes between nodes: store each column
+    // to a temporary and copy it out.
+    float32x4x4_t columns[4];
+    columns[0].val[0] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(yy, zz))), sx);
+    columns[0].val[1] = vmulq_f32(vmulq_f32(two, vaddq_f32(xy, wz)), sx);
+    columns[0].val[2] = vmulq_f32(vmulq_f32(two, vsubq_f32(xz, wy)), sx);
+    columns[0].val[3] = vdupq_n_f32(0.0f);
+    columns[1].val[0] = vmulq_f32(vmulq_f32(two, vsubq_f32(xy, wz)), sy);
+    columns[1].val[1] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, zz))), sy);
+    columns[1].val[2] = vmulq_f32(vmulq_f32(two, vaddq_f32(yz, wx)), sy);
+    columns[1].val[3] = vdupq_n_f32(0.0f);
+    columns[2].val[0] = vmulq_f32(vmulq_f32(two, vaddq_f32(xz, wy)), sz);
+    columns[2].val[1] = vmulq_f32(vmulq_f32(two, vsubq_f32(yz, wx)), sz);
+    columns[2].val[2] = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(xx, yy))), sz);
+    columns[2].val[3] = vdupq_n_f32(0.0f);
+    columns[3].val[0] = vld1q_f32(pTx);
+    columns[3].val[1] = vld1q_f32(pTy);
+    columns[3].val[2] = vld1q_f32(pTz);
+    columns[3].val[3] = one;
+
+    float interleaved[16];
+    for (uint32_t c = 0; c < 4; ++c) {
+        vst4q_f32(interleaved, columns[c]);
+        for (uint32_t i = 0; i < 4; ++i) {
+            vst1q_f32(&pMatrices[i][c][0], vld1q_f32(interleaved + 4 * i));
+        }
+    }
+}
+
+static void Multiply(const float4x4& a, const float4x4& b, float4x4* pResult)
+{
+    const float*      pA = &a[0][0];
+    const float*      pB = &b[0][0];
+    const float32x4_t a0 = vld1q_f32(pA + 0);
+    const float32x4_t a1 = vld1q_f32(pA + 4);
+    const float32x4_t a2 = vld1q_f32(pA + 8);
+    const float32x4_t a3 = vld1q_f32(pA + 12);
+
+    float* pDst = &(*pResult)[0][0];
+    for (uint32_t i = 0; i < 4; ++i) {
+        float32x4_t r = vmulq_n_f32(a0, pB[4 * i + 0]);
+        r             = vmlaq_n_f32(r, a1, pB[4 * i + 1]);
+        r             = vmlaq_n_f32(r, a2, pB[4 * i + 2]);
+        r             = vmlaq_n_f32(r, a3, pB[4 * i + 3]);
+        vst1q_f32(pDst + 4 * i, r);
+    }
+}
+#else
+static void Multiply(const float4x4& a, const float4x4& b, float4x4* pResult)
+{
+    *pResult = a * b;
+}
+#endif
+
+// -------------------------------------------------------------------------------------------------
+// TransformHierarchy
+// -------------------------------------------------------------------------------------------------
+uint32_t TransformHierarchy::AddNode(uint32_t parent)
+{
+    if ((parent != kInvalidNode) && (parent >= GetNodeCount())) {
+        return kInvalidNode;
+    }
+
+    const uint32_t node = GetNodeCount();
+    mParents.push_back(parent);
+    mSlots.push_back(node);
+    mNodes.push_back(node);
+    mParentSlots.push_back(kInvalidNode);
+    mTranslationX.push_back(0.0f);
+    mTranslationY.push_back(0.0f);
+    mTranslationZ.push_back(0.0f);
+    mRotationX.push_back(0.0f);
+    mRotationY.push_back(0.0f);
+    mRotationZ.push_back(0.0f);
+    mRotationW.push_back(1.0f);
+    mScaleX.push_back(1.0f);
+    mScaleY.push_back(1.0f);
+    mScaleZ.push_back(1.0f);
+    mDirty.push_back(1);
+    mLocalMatrices.push_back(float4x4(1.0f));
+    mWorldMatrices.push_back(float4x4(1.0f));
+    mOrderDirty = true;
+
+    return node;
+}
+
+Result TransformHierarchy::SetParent(uint32_t node, uint32_t parent)
+{
+    if ((node >= GetNodeCount()) || ((parent != kInvalidNode) && (parent >= GetNodeCount()))) {
+        return ppx::ERROR_OUT_OF_RANGE;
+    }
+    for (uint32_t ancestor = parent; ancestor != kInvalidNode; ancestor = mParents[ancestor]) {
+        if (ancestor == node) {
+            return ppx::ERROR_FAILED;
+        }
+    }
+
+    mParents[node]       = parent;
+    mDirty[mSlots[node]] = 1;
+    mOrderDirty          = true;
+    return ppx::SUCCESS;
+}
+
+void TransformHierarchy::Reserve(uint32_t count)
+{
+    mParents.reserve(count);
+    mSlots.reserve(count);
+    mNodes.reserve(count);
+    mParentSlots.reserve(count);
+    mTranslationX.reserve(count);
+    mTranslationY.reserve(count);
+    mTranslationZ.reserve(count);
+    mRotationX.reserve(count);
+    mRotationY.reserve(count);
+    mRotationZ.reserve(count);
+    mRotationW.reserve(count);
+    mScaleX.reserve(count);
+    mScaleY.reserve(count);
+    mScaleZ.reserve(count);
+    mDirty.reserve(count);
+    mLocalMatrices.reserve(count);
+    mWorldMatrices.reserve(count);
+}
+
+void TransformHierarchy::Clear()
+{
+    mParents.clear();
+    mSlots.clear();
+    mNodes.clear();
+    mParentSlots.clear();
+    mLevelOffsets.clear();
+    mTranslationX.clear();
+    mTranslationY.clear();
+    mTranslationZ.clear();
+    mRotationX.clear();
+    mRotationY.clear();
+    mRotationZ.clear();
+    mRotationW.clear();
+    mScaleX.clear();
+    mScaleY.clear();
+    mScaleZ.clear();
+    mDirty.clear();
+    mLocalMatrices.clear();
+    mWorldMatrices.clear();
+    mOrderDirty = false;
+    mStats      = {};
+}
+
+void TransformHierarchy::SetTranslation(uint32_t node, const float3& translation)
+{
+    const uint32_t slot = mSlots[node];
+    mTranslationX[slot] = translation.x;
+    mTranslationY[slot] = translation.y;
+    mTranslationZ[slot] = translation.z;
+    mDirty[slot]        = 1;
+}
+
+void TransformHierarchy::SetRotation(uint32_t node, const quat& rotation)
+{
+    const uint32_t slot = mSlots[node];
+    mRotationX[slot]    = rotation.x;
+    mRotationY[slot]    = rotation.y;
+    mRotationZ[slot]    = rotation.z;
+    mRotationW[slot]    = rotation.w;
+    mDirty[slot]        = 1;
+}
+
+void TransformHierarchy::SetScale(uint32_t node, const float3& scale)
+{
+    const uint32_t slot = mSlots[node];
+    mScaleX[slot]       = scale.x;
+    mScaleY[slot]       = scale.y;
+    mScaleZ[slot]       = scale.z;
+    mDirty[slot]        = 1;
+}
+
+void TransformHierarchy::SetTRS(uint32_t node, const float3& translation, const quat& rotation, const float3& scale)
+{
+    SetTranslation(node, translation);
+    SetRotation(node, rotation);
+    SetScale(node, scale);
+}
+
+float3 TransformHierarchy::GetTranslation(uint32_t node) const
+{
+    const uint32_t slot = mSlots[node];
+    return float3(mTranslationX[slot], mTranslationY[slot], mTranslationZ[slot]);
+}
+
+quat TransformHierarchy::GetRotation(uint32_t node) const
+{
+    const uint32_t slot = mSlots[node];
+    return quat(mRotationW[slot], mRotationX[slot], mRotationY[slot], mRotationZ[slot]);
+}
+
+float3 TransformHierarchy::GetScale(uint32_t node) const
+{
+    const uint32_t slot = mSlots[node];
+    return float3(mScaleX[slot], mScaleY[slot], mScaleZ[slot]);
+}
+
+void TransformHierarchy::SortByLevel()
+{
+    const uint32_t nodeCount = GetNodeCount();
+
+    // Children of each node, in id order
+    std::vector<uint32_t> childOffsets(nodeCount + 1, 0);
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        if (mParents[node] != kInvalidNode) {
+            childOffsets[mParents[node] + 1]++;
+        }
+    }
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        childOffsets[node + 1] += childOffsets[node];
+    }
+    std::vector<uint32_t> children(childOffsets[nodeCount]);
+    std::vector<uint32_t> childCounts(nodeCount, 0);
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        const uint32_t parent = mParents[node];
+        if (parent != kInvalidNode) {
+            children[childOffsets[parent] + childCounts[parent]++] = node;
+        }
+    }
+
+    // Breadth first order: levels are contiguous and siblings are next to each other
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        if (mParents[node] == kInvalidNode) {
+            order.push_back(node);
+        }
+    }
+    mLevelOffsets.clear();
+    uint32_t levelBegin = 0;
+    while (levelBegin < order.size()) {
+        const uint32_t levelEnd = CountU32(order);
+        mLevelOffsets.push_back(levelBegin);
+        for (uint32_t i = levelBegin; i < levelEnd; ++i) {
+            const uint32_t node = order[i];
+            order.insert(order.end(), children.begin() + childOffsets[node], children.begin() + childOffsets[node + 1]);
+        }
+        levelBegin = levelEnd;
+    }
+    mLevelOffsets.push_back(nodeCount);
+    PPX_ASSERT_MSG(order.size() == nodeCount, "transform hierarchy has a cycle");
+
+    // Move per slot data to the new order
+    auto permute = [&order, this](auto& values) {
+        std::remove_reference_t<decltype(values)> sorted(values.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sorted[i] = values[mSlots[order[i]]];
+        }
+        values.swap(sorted);
+    };
+    permute(mTranslationX);
+    permute(mTranslationY);
+    permute(mTranslationZ);
+    permute(mRotationX);
+    permute(mRotationY);
+    permute(mRotationZ);
+    permute(mRotationW);
+    permute(mScaleX);
+    permute(mScaleY);
+    permute(mScaleZ);
+    permute(mDirty);
+    permute(mLocalMatrices);
+    permute(mWorldMatrices);
+
+    mNodes.swap(order);
+    for (uint32_t slot = 0; slot < nodeCount; ++slot) {
+        mSlots[mNodes[slot]] = slot;
+    }
+    for (uint32_t slot = 0; slot < nodeCount; ++slot) {
+        const uint32_t parent = mParents[mNodes[slot]];
+        mParentSlots[slot]    = (parent == kInvalidNode) ? kInvalidNode : mSlots[parent];
+    }
+
+    mOrderDirty = false;
+}
+
+void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+{
+    // A node is dirty if it or its parent is, parents were already updated
+    for (uint32_t slot = begin; slot < end; ++slot) {
+        const uint32_t parent = mParentSlots[slot];
+        if (parent != kInvalidNode) {
+            mDirty[slot] |= mDirty[parent];
+        }
+    }
+
+    uint32_t slot = begin;
+#if defined(PPX_TRANSFORM_HIERARCHY_SSE2) || defined(PPX_TRANSFORM_HIERARCHY_NEON)
+    for (; slot + 4 <= end; slot += 4) {
+        uint32_t dirty;
+        std::memcpy(&dirty, &mDirty[slot], sizeof(dirty));
+        if (dirty == 0) {
+            continue;
+        }
+        // Clean nodes in the group get the matrix they already had
+        ComposeTRS4(
+            &mTranslationX[slot],
+            &mTranslationY[slot],
+            &mTranslationZ[slot],
+            &mRotationX[slot],
+            &mRotationY[slot],
+            &mRotationZ[slot],
+            &mRotationW[slot],
+            &mScaleX[slot],
+            &mScaleY[slot],
+            &mScaleZ[slot],
+            &mLocalMatrices[slot]);
+        for (uint32_t i = slot; i < slot + 4; ++i) {
+            const uint32_t parent = mParentSlots[i];
+            if (parent == kInvalidNode) {
+                mWorldMatrices[i] = mLocalMatrices[i];
+            }
+            else {
+                Multiply(mWorldMatrices[parent], mLocalMatrices[i], &mWorldMatrices[i]);
+            }
+        }
+    }
+#endif
+    for (; slot < end; ++slot) {
+        if (mDirty[slot] == 0) {
+            continue;
+        }
+        ComposeTRS(
+            mTranslationX[slot],
+            mTranslationY[slot],
+            mTranslationZ[slot],
+            mRotationX[slot],
+            mRotationY[slot],
+            mRotationZ[slot],
+            mRotationW[slot],
+            mScaleX[slot],
+            mScaleY[slot],
+            mScaleZ[slot],
+            &mLocalMatrices[slot]);
+        const uint32_t parent = mParentSlots[slot];
+        if (parent == kInvalidNode) {
+            mWorldMatrices[slot] = mLocalMatrices[slot];
+        }
+        else {
+            Multiply(mWorldMatrices[parent], mLocalMatrices[slot], &mWorldMatrices[slot]);
+        }
+    }
+}
+
+void TransformHierarchy::Update()
+{
+    Timer timer;
+    timer.Start();
+
+    if (mOrderDirty) {
+        SortByLevel();
+    }
+
+    // Nothing was added since construction or Clear()
+    if (mLevelOffsets.empty()) {
+        mStats = {};
+        return;
+    }
+
+    const uint32_t threadCount = (mThreadCount == 0) ? GetHardwareThreadCount() : mThreadCount;
+    const uint32_t levelCount  = CountU32(mLevelOffsets) - 1;
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        const uint32_t begin = mLevelOffsets[level];
+        const uint32_t end   = mLevelOffsets[level + 1];
+        if ((threadCount == 1) || ((end - begin) < kMinParallelLevelSize)) {
+            UpdateRange(begin, end);
+            continue;
+        }
+        const uint32_t chunkCount = (end - begin + kChunkSize - 1) / kChunkSize;
+        ParallelFor(chunkCount, threadCount, [&](uint32_t chunk) {
+            UpdateRange(begin + chunk * kChunkSize, std::min(end, begin + (chunk + 1) * kChunkSize));
+        });
+    }
+
+    uint32_t updatedCount = 0;
+    for (uint8_t dirty : mDirty) {
+        updatedCount += dirty;
+    }
+    std::fill(mDirty.begin(), mDirty.end(), static_cast<uint8_t>(0));
+
+    mStats.nodeCount    = GetNodeCount();
+    mStats.levelCount   = levelCount;
+    mStats.updatedCount = updatedCount;
+    mStats.threadCount  = threadCount;
+    mStats.cpuTimeMs    = timer.MillisSinceStart();
+}
+
+} // namespace ppx
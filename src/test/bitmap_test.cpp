@@ -0,0 +1,237 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/bitmap.h"
+#include "ppx/bitmap_kernels.h"
+
+using namespace ppx;
+
+namespace {
+
+const InstructionSet kInstructionSets[] = {
+    INSTRUCTION_SET_SCALAR,
+    INSTRUCTION_SET_SSE2,
+    INSTRUCTION_SET_AVX2,
+    INSTRUCTION_SET_NEON,
+};
+
+// Restores the default kernel dispatch when a test ends.
+class BitmapTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        bitmap_kernels::SetInstructionSet(GetBestInstructionSet());
+    }
+};
+
+Bitmap CreateGradientRGBA8(uint32_t width, uint32_t height)
+{
+    Bitmap bitmap = Bitmap::Create(width, height, Bitmap::FORMAT_RGBA_UINT8);
+    for (Bitmap::PixelIterator it = bitmap.GetPixelIterator(); !it.Done(); it.Next()) {
+        uint8_t* pPixel = it.GetPixelAddress<uint8_t>();
+        pPixel[0]       = static_cast<uint8_t>(it.GetX() * 7);
+        pPixel[1]       = static_cast<uint8_t>(it.GetY() * 13);
+        pPixel[2]       = static_cast<uint8_t>(it.GetX() + it.GetY());
+        pPixel[3]       = static_cast<uint8_t>(it.GetX() * it.GetY());
+    }
+    return bitmap;
+}
+
+bool BitmapsEqual(const Bitmap& a, const Bitmap& b)
+{
+    if ((a.GetWidth() != b.GetWidth()) || (a.GetHeight() != b.GetHeight()) || (a.GetFormat() != b.GetFormat())) {
+        return false;
+    }
+    const size_t rowSize = a.GetWidth() * a.GetPixelStride();
+    for (uint32_t y = 0; y < a.GetHeight(); ++y) {
+        if (std::memcmp(a.GetPixelAddress(0, y), b.GetPixelAddress(0, y), rowSize) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_F(BitmapTest, PixelIteratorVisitsEveryPixelInOrder)
+{
+    Bitmap   bitmap = Bitmap::Create(5, 3, Bitmap::FORMAT_RGB_UINT8);
+    uint32_t count  = 0;
+    for (Bitmap::PixelIterator it = bitmap.GetPixelIterator(); !it.Done(); it.Next(), ++count) {
+        EXPECT_EQ(it.GetX(), count % 5);
+        EXPECT_EQ(it.GetY(), count / 5);
+        EXPECT_EQ(it.GetPixelAddress<char>(), bitmap.GetPixelAddress(it.GetX(), it.GetY()));
+    }
+    EXPECT_EQ(count, 15u);
+}
+
+TEST_F(BitmapTest, FillAllInstructionSets)
+{
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!bitmap_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+
+        Bitmap rgb8 = Bitmap::Create(37, 5, Bitmap::FORMAT_RGB_UINT8);
+        rgb8.Fill<uint8_t>(1, 2, 3, 4);
+        for (Bitmap::PixelIterator it = rgb8.GetPixelIterator(); !it.Done(); it.Next()) {
+            const uint8_t* pPixel = it.GetPixelAddress<uint8_t>();
+            ASSERT_EQ(pPixel[0], 1);
+            ASSERT_EQ(pPixel[1], 2);
+            ASSERT_EQ(pPixel[2], 3);
+        }
+
+        Bitmap rgbaf = Bitmap::Create(33, 3, Bitmap::FORMAT_RGBA_FLOAT);
+        rgbaf.Fill<float>(0.25f, 0.5f, 0.75f, 1.0f);
+        for (Bitmap::PixelIterator it = rgbaf.GetPixelIterator(); !it.Done(); it.Next()) {
+            const float* pPixel = it.GetPixelAddress<float>();
+            ASSERT_EQ(pPixel[0], 0.25f);
+            ASSERT_EQ(pPixel[1], 0.5f);
+            ASSERT_EQ(pPixel[2], 0.75f);
+            ASSERT_EQ(pPixel[3], 1.0f);
+        }
+    }
+}
+
+TEST_F(BitmapTest, ConvertRoundTripIsLossless)
+{
+    Bitmap source = CreateGradientRGBA8(67, 9);
+
+    const Bitmap::Format intermediates[] = {Bitmap::FORMAT_RGBA_FLOAT, Bitmap::FORMAT_RGBA_UINT16, Bitmap::FORMAT_RGBA_UINT32};
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!bitmap_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        for (Bitmap::Format format : intermediates) {
+            Bitmap intermediate = Bitmap::Create(source.GetWidth(), source.GetHeight(), format);
+            Bitmap result       = Bitmap::Create(source.GetWidth(), source.GetHeight(), source.GetFormat());
+            ASSERT_EQ(source.ConvertTo(&intermediate), ppx::SUCCESS);
+            ASSERT_EQ(intermediate.ConvertTo(&result), ppx::SUCCESS);
+            EXPECT_TRUE(BitmapsEqual(source, result)) << ToString(instructionSet) << " format " << format;
+        }
+    }
+}
+
+TEST_F(BitmapTest, ConvertChannelCount)
+{
+    Bitmap rgb = Bitmap::Create(19, 2, Bitmap::FORMAT_RGB_UINT8);
+    rgb.Fill<uint8_t>(10, 20, 30, 0);
+
+    Bitmap rgba = Bitmap::Create(19, 2, Bitmap::FORMAT_RGBA_UINT8);
+    ASSERT_EQ(rgb.ConvertTo(&rgba), ppx::SUCCESS);
+    const uint8_t* pPixel = rgba.GetPixel8u(18, 1);
+    EXPECT_EQ(pPixel[0], 10);
+    EXPECT_EQ(pPixel[1], 20);
+    EXPECT_EQ(pPixel[2], 30);
+    EXPECT_EQ(pPixel[3], 255);
+
+    Bitmap rf = Bitmap::Create(19, 2, Bitmap::FORMAT_R_FLOAT);
+    ASSERT_EQ(rgba.ConvertTo(&rf), ppx::SUCCESS);
+    EXPECT_FLOAT_EQ(*rf.GetPixel32f(3, 0), 10.0f / 255.0f);
+}
+
+TEST_F(BitmapTest, KernelsMatchScalar)
+{
+    std::vector<float> src(1027);
+    for (size_t i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<float>(i % 300) / 256.0f - 0.1f;
+    }
+
+    bitmap_kernels::SetInstructionSet(INSTRUCTION_SET_SCALAR);
+    std::vector<uint8_t>  expected8(src.size());
+    std::vector<uint16_t> expected16(src.size());
+    bitmap_kernels::ConvertF32ToU8(src.data(), expected8.data(), src.size());
+    bitmap_kernels::ConvertF32ToU16(src.data(), expected16.data(), src.size());
+    std::vector<uint8_t> expectedPremultiplied = expected8;
+    bitmap_kernels::PremultiplyAlphaRGBA8(expectedPremultiplied.data(), expectedPremultiplied.size() / 4);
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!bitmap_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        std::vector<uint8_t>  actual8(src.size());
+        std::vector<uint16_t> actual16(src.size());
+        bitmap_kernels::ConvertF32ToU8(src.data(), actual8.data(), src.size());
+        bitmap_kernels::ConvertF32ToU16(src.data(), actual16.data(), src.size());
+        EXPECT_EQ(actual8, expected8) << ToString(instructionSet);
+        EXPECT_EQ(actual16, expected16) << ToString(instructionSet);
+
+        bitmap_kernels::PremultiplyAlphaRGBA8(actual8.data(), actual8.size() / 4);
+        EXPECT_EQ(actual8, expectedPremultiplied) << ToString(instructionSet);
+    }
+}
+
+TEST_F(BitmapTest, PremultiplyAlpha)
+{
+    Bitmap bitmap = Bitmap::Create(11, 1, Bitmap::FORMAT_RGBA_UINT8);
+    bitmap.Fill<uint8_t>(255, 128, 0, 128);
+    ASSERT_EQ(bitmap.PremultiplyAlpha(), ppx::SUCCESS);
+    const uint8_t* pPixel = bitmap.GetPixel8u(10, 0);
+    EXPECT_EQ(pPixel[0], 128);
+    EXPECT_EQ(pPixel[1], 64);
+    EXPECT_EQ(pPixel[2], 0);
+    EXPECT_EQ(pPixel[3], 128);
+
+    Bitmap rgb = Bitmap::Create(4, 4, Bitmap::FORMAT_RGB_UINT8);
+    EXPECT_EQ(rgb.PremultiplyAlpha(), ppx::ERROR_IMAGE_INVALID_FORMAT);
+}
+
+TEST_F(BitmapTest, SRGBRoundTrip)
+{
+    Bitmap bitmap = Bitmap::Create(2, 1, Bitmap::FORMAT_RGBA_FLOAT);
+    bitmap.Fill<float>(0.0f, 0.5f, 1.0f, 0.5f);
+    ASSERT_EQ(bitmap.ConvertSRGBToLinear(), ppx::SUCCESS);
+    EXPECT_NEAR(bitmap.GetPixel32f(0, 0)[1], 0.214f, 0.001f);
+    EXPECT_EQ(bitmap.GetPixel32f(0, 0)[3], 0.5f);
+    ASSERT_EQ(bitmap.ConvertLinearToSRGB(), ppx::SUCCESS);
+    EXPECT_NEAR(bitmap.GetPixel32f(1, 0)[1], 0.5f, 1e-5f);
+}
+
+TEST_F(BitmapTest, FlipAndRotate)
+{
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!bitmap_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+
+        Bitmap source = CreateGradientRGBA8(21, 13);
+
+        // Four clockwise rotations are the identity
+        Bitmap a = source;
+        for (uint32_t i = 0; i < 4; ++i) {
+            Bitmap b = Bitmap::Create(a.GetHeight(), a.GetWidth(), a.GetFormat());
+            ASSERT_EQ(a.Rotate90(true, &b), ppx::SUCCESS);
+            a = b;
+        }
+        EXPECT_TRUE(BitmapsEqual(source, a));
+
+        // Two 90 degree rotations equal one 180 degree rotation
+        Bitmap cw  = Bitmap::Create(source.GetHeight(), source.GetWidth(), source.GetFormat());
+        Bitmap cw2 = Bitmap::Create(source.GetWidth(), source.GetHeight(), source.GetFormat());
+        ASSERT_EQ(source.Rotate90(true, &cw), ppx::SUCCESS);
+        ASSERT_EQ(cw.Rotate90(true, &cw2), ppx::SUCCESS);
+        Bitmap r180 = source;
+        ASSERT_EQ(r180.Rotate180(), ppx::SUCCESS);
+        EXPECT_TRUE(BitmapsEqual(cw2, r180));
+
+        Bitmap flipped = source;
+        ASSERT_EQ(flipped.FlipHorizontal(), ppx::SUCCESS);
+        EXPECT_EQ(std::memcmp(flipped.GetPixelAddress(0, 4), source.GetPixelAddress(20, 4), 4), 0);
+        ASSERT_EQ(flipped.FlipVertical(), ppx::SUCCESS);
+        EXPECT_EQ(std::memcmp(flipped.GetPixelAddress(0, 0), source.GetPixelAddress(20, 12), 4), 0);
+    }
+}
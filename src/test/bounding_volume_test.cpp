@@ -0,0 +1,79 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/bounding_volume.h"
+
+using namespace ppx;
+
+namespace {
+
+// Signs of the U, V and W half extents for each corner returned by
+// OBB::GetPoints(), same order as AABB::Transform().
+const float3 kCornerSigns[8] = {
+    float3(-1, +1, -1),
+    float3(-1, -1, -1),
+    float3(+1, -1, -1),
+    float3(+1, +1, -1),
+    float3(-1, +1, +1),
+    float3(-1, -1, +1),
+    float3(+1, -1, +1),
+    float3(+1, +1, +1),
+};
+
+} // namespace
+
+TEST(BoundingVolumeTest, RotatedOBBCorners)
+{
+    // Rotated 45 degrees around Y
+    const float3 center = float3(1, 2, 3);
+    const float3 size   = float3(2, 4, 6);
+    const OBB    obb(center, size, float3(1, 0, 1), float3(0, 1, 0), float3(-1, 0, 1));
+
+    float3 corners[8];
+    obb.GetPoints(corners);
+
+    const float3 u = 0.5f * size.x * glm::normalize(float3(1, 0, 1));
+    const float3 v = 0.5f * size.y * float3(0, 1, 0);
+    const float3 w = 0.5f * size.z * glm::normalize(float3(-1, 0, 1));
+    for (uint32_t i = 0; i < 8; ++i) {
+        const float3 expected = center + kCornerSigns[i].x * u + kCornerSigns[i].y * v + kCornerSigns[i].z * w;
+        EXPECT_NEAR(corners[i].x, expected.x, 1e-5f) << "corner " << i;
+        EXPECT_NEAR(corners[i].y, expected.y, 1e-5f) << "corner " << i;
+        EXPECT_NEAR(corners[i].z, expected.z, 1e-5f) << "corner " << i;
+    }
+
+    // Every corner is distinct
+    for (uint32_t i = 0; i < 8; ++i) {
+        for (uint32_t j = i + 1; j < 8; ++j) {
+            EXPECT_GT(glm::length(corners[i] - corners[j]), 1.0f) << "corners " << i << " and " << j;
+        }
+    }
+}
+
+TEST(BoundingVolumeTest, AABBOfRotatedOBB)
+{
+    const OBB  obb(float3(1, 2, 3), float3(2, 4, 6), float3(1, 0, 1), float3(0, 1, 0), float3(-1, 0, 1));
+    const AABB aabb(obb);
+
+    // Half extent on X and Z is (1 + 3) / sqrt(2)
+    const float halfXZ = 4.0f / std::sqrt(2.0f);
+    EXPECT_NEAR(aabb.GetMin().x, 1 - halfXZ, 1e-5f);
+    EXPECT_NEAR(aabb.GetMax().x, 1 + halfXZ, 1e-5f);
+    EXPECT_NEAR(aabb.GetMin().y, 0, 1e-5f);
+    EXPECT_NEAR(aabb.GetMax().y, 4, 1e-5f);
+    EXPECT_NEAR(aabb.GetMin().z, 3 - halfXZ, 1e-5f);
+    EXPECT_NEAR(aabb.GetMax().z, 3 + halfXZ, 1e-5f);
+}
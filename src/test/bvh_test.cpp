@@ -0,0 +1,248 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/bvh.h"
+
+using namespace ppx;
+
+namespace {
+
+class Random
+{
+public:
+    float Next(float range)
+    {
+        mSeed = mSeed * 1664525 + 1013904223;
+        return (static_cast<float>(mSeed >> 8) / static_cast<float>(1 << 24) - 0.5f) * range;
+    }
+
+    float3 Next3(float range) { return float3(Next(range), Next(range), Next(range)); }
+
+private:
+    uint32_t mSeed = 0x9E3779B9;
+};
+
+// Small triangles scattered in a 100 unit cube, as a plain triangle list.
+std::vector<float3> CreateTriangleSoup(uint32_t triangleCount)
+{
+    Random              random;
+    std::vector<float3> positions;
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+        float3 center = random.Next3(100.0f);
+        positions.push_back(center + random.Next3(4.0f));
+        positions.push_back(center + random.Next3(4.0f));
+        positions.push_back(center + random.Next3(4.0f));
+    }
+    return positions;
+}
+
+std::vector<Ray> CreateRays(uint32_t count)
+{
+    Random           random;
+    std::vector<Ray> rays;
+    for (uint32_t i = 0; i < count; ++i) {
+        float3 origin = random.Next3(150.0f);
+        float3 target = random.Next3(50.0f);
+        rays.push_back(Ray(origin, target - origin));
+    }
+    // Axis aligned, with zero direction components
+    rays.push_back(Ray(float3(0, 0, -80), float3(0, 0, 1)));
+    rays.push_back(Ray(float3(-80, 1, 2), float3(1, 0, 0)));
+    return rays;
+}
+
+// Reference closest hit over every triangle.
+RayHit IntersectBruteForce(const std::vector<float3>& positions, const Ray& ray)
+{
+    RayHit hit;
+    for (uint32_t i = 0; i < positions.size() / 3; ++i) {
+        const float3 e1   = positions[3 * i + 1] - positions[3 * i];
+        const float3 e2   = positions[3 * i + 2] - positions[3 * i];
+        const float3 pvec = glm::cross(ray.direction, e2);
+        const float  det  = glm::dot(e1, pvec);
+        if (det == 0.0f) {
+            continue;
+        }
+        const float3 tvec = ray.origin - positions[3 * i];
+        const float  u    = glm::dot(tvec, pvec) / det;
+        const float3 qvec = glm::cross(tvec, e1);
+        const float  v    = glm::dot(ray.direction, qvec) / det;
+        const float  t    = glm::dot(e2, qvec) / det;
+        if ((u >= 0) && (v >= 0) && (u + v <= 1) && (t >= ray.tMin) && (t <= ray.tMax) && (t < hit.t)) {
+            hit.t              = t;
+            hit.primitiveIndex = i;
+        }
+    }
+    return hit;
+}
+
+} // namespace
+
+TEST(BvhTest, TrianglesMatchBruteForce)
+{
+    std::vector<float3> positions = CreateTriangleSoup(2000);
+    Bvh                 bvh;
+    ASSERT_EQ(bvh.Build(CountU32(positions), positions.data(), 2000, nullptr), SUCCESS);
+    EXPECT_EQ(bvh.GetPrimitiveCount(), 2000u);
+    EXPECT_GT(bvh.GetStats().nodeCount, 1u);
+
+    uint32_t hitCount = 0;
+    for (const Ray& ray : CreateRays(500)) {
+        RayHit expected = IntersectBruteForce(positions, ray);
+        RayHit hit;
+        EXPECT_EQ(bvh.Intersect(ray, &hit), expected.IsHit());
+        EXPECT_EQ(bvh.IntersectAny(ray), expected.IsHit());
+        if (expected.IsHit()) {
+            EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex);
+            EXPECT_NEAR(hit.t, expected.t, 1e-4f * expected.t);
+            ++hitCount;
+        }
+    }
+    EXPECT_GT(hitCount, 50u);
+}
+
+TEST(BvhTest, IndexedTriangles)
+{
+    // Quad in the z = -5 plane, made of two triangles sharing an edge
+    const float3   positions[] = {{-1, -1, -5}, {1, -1, -5}, {1, 1, -5}, {-1, 1, -5}};
+    const uint32_t indices[]   = {0, 1, 2, 0, 2, 3};
+    Bvh            bvh;
+    ASSERT_EQ(bvh.Build(4, positions, 2, indices), SUCCESS);
+
+    RayHit hit;
+    ASSERT_TRUE(bvh.Intersect(Ray(float3(-0.5f, 0.5f, 0), float3(0, 0, -1)), &hit));
+    EXPECT_EQ(hit.primitiveIndex, 1u);
+    EXPECT_FLOAT_EQ(hit.t, 5.0f);
+    EXPECT_FALSE(bvh.Intersect(Ray(float3(-0.5f, 0.5f, 0), float3(0, 0, -1), 0, 4.0f), &hit));
+    EXPECT_FALSE(hit.IsHit());
+    EXPECT_FALSE(bvh.Intersect(Ray(float3(2, 0, 0), float3(0, 0, -1)), &hit));
+
+    const uint32_t badIndices[] = {0, 1, 4};
+    EXPECT_EQ(bvh.Build(4, positions, 1, badIndices), ERROR_OUT_OF_RANGE);
+}
+
+TEST(BvhTest, InstructionSetsMatchScalar)
+{
+    std::vector<float3> positions = CreateTriangleSoup(5000);
+    std::vector<Ray>    rays      = CreateRays(1000);
+    Bvh                 bvh;
+    ASSERT_EQ(bvh.Build(CountU32(positions), positions.data(), 5000, nullptr), SUCCESS);
+
+    ASSERT_TRUE(bvh.SetInstructionSet(INSTRUCTION_SET_SCALAR));
+    std::vector<RayHit> expected(rays.size());
+    for (size_t i = 0; i < rays.size(); ++i) {
+        bvh.Intersect(rays[i], &expected[i]);
+    }
+
+    for (InstructionSet instructionSet : {INSTRUCTION_SET_SSE2, INSTRUCTION_SET_NEON}) {
+        if (!bvh.SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        for (size_t i = 0; i < rays.size(); ++i) {
+            RayHit hit;
+            bvh.Intersect(rays[i], &hit);
+            EXPECT_EQ(hit.primitiveIndex, expected[i].primitiveIndex) << ToString(instructionSet);
+            EXPECT_EQ(hit.t, expected[i].t) << ToString(instructionSet);
+        }
+    }
+}
+
+TEST(BvhTest, MultithreadedBuildMatchesSingleThreaded)
+{
+    std::vector<float3> positions = CreateTriangleSoup(20000);
+    Bvh                 single;
+    Bvh                 multi;
+    multi.SetThreadCount(4);
+    ASSERT_EQ(single.Build(CountU32(positions), positions.data(), 20000, nullptr), SUCCESS);
+    ASSERT_EQ(multi.Build(CountU32(positions), positions.data(), 20000, nullptr), SUCCESS);
+    EXPECT_EQ(multi.GetStats().threadCount, 4u);
+    EXPECT_EQ(multi.GetStats().nodeCount, single.GetStats().nodeCount);
+
+    for (const Ray& ray : CreateRays(500)) {
+        RayHit expected;
+        RayHit hit;
+        single.Intersect(ray, &expected);
+        multi.Intersect(ray, &hit);
+        EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex);
+    }
+}
+
+TEST(BvhTest, BoxesIntersectAndQuery)
+{
+    // Unit boxes along +X at x = 0, 2, 4, ...
+    std::vector<AABB> boxes;
+    for (uint32_t i = 0; i < 100; ++i) {
+        float3 center = float3(2.0f * static_cast<float>(i), 0, 0);
+        boxes.push_back(AABB(center - float3(0.5f), center + float3(0.5f)));
+    }
+    Bvh bvh;
+    ASSERT_EQ(bvh.Build(CountU32(boxes), boxes.data()), SUCCESS);
+    EXPECT_EQ(bvh.GetBounds().GetMin(), float3(-0.5f));
+    EXPECT_EQ(bvh.GetBounds().GetMax(), float3(198.5f, 0.5f, 0.5f));
+
+    RayHit hit;
+    ASSERT_TRUE(bvh.Intersect(Ray(float3(9, 0, 0), float3(1, 0, 0)), &hit));
+    EXPECT_EQ(hit.primitiveIndex, 5u);
+    EXPECT_FLOAT_EQ(hit.t, 0.5f);
+    ASSERT_TRUE(bvh.Intersect(Ray(float3(4, 0, 10), float3(0, 0, -1)), &hit));
+    EXPECT_EQ(hit.primitiveIndex, 2u);
+    EXPECT_FLOAT_EQ(hit.t, 9.5f);
+    EXPECT_FALSE(bvh.IntersectAny(Ray(float3(5, 0, 10), float3(0, 0, -1))));
+
+    std::vector<uint32_t> results;
+    EXPECT_EQ(bvh.Query(AABB(float3(3, -1, -1), float3(8.5f, 1, 1)), &results), 3u);
+    std::sort(results.begin(), results.end());
+    EXPECT_EQ(results, std::vector<uint32_t>({2, 3, 4}));
+}
+
+TEST(BvhTest, RefitFollowsMovedPrimitives)
+{
+    std::vector<float3> positions = CreateTriangleSoup(3000);
+    Bvh                 bvh;
+    ASSERT_EQ(bvh.Build(CountU32(positions), positions.data(), 3000, nullptr), SUCCESS);
+
+    for (float3& position : positions) {
+        position = position + float3(500, 0, 0);
+    }
+    ASSERT_EQ(bvh.Refit(CountU32(positions), positions.data()), SUCCESS);
+    EXPECT_GT(bvh.GetBounds().GetMin().x, 400.0f);
+
+    for (Ray ray : CreateRays(200)) {
+        ray.origin = ray.origin + float3(500, 0, 0);
+        RayHit expected = IntersectBruteForce(positions, ray);
+        RayHit hit;
+        bvh.Intersect(ray, &hit);
+        EXPECT_EQ(hit.primitiveIndex, expected.primitiveIndex);
+    }
+
+    EXPECT_EQ(bvh.Refit(10, positions.data()), ERROR_UNEXPECTED_COUNT_VALUE);
+    AABB box;
+    EXPECT_EQ(bvh.Refit(1, &box), ERROR_UNEXPECTED_COUNT_VALUE);
+}
+
+TEST(BvhTest, EmptyBvh)
+{
+    Bvh bvh;
+    EXPECT_TRUE(bvh.IsEmpty());
+    ASSERT_EQ(bvh.Build(0, static_cast<const AABB*>(nullptr)), SUCCESS);
+    EXPECT_TRUE(bvh.IsEmpty());
+
+    RayHit hit;
+    EXPECT_FALSE(bvh.Intersect(Ray(), &hit));
+    EXPECT_FALSE(bvh.IntersectAny(Ray()));
+    std::vector<uint32_t> results;
+    EXPECT_EQ(bvh.Query(AABB(float3(-1), float3(1)), &results), 0u);
+}
@@ -61,6 +61,63 @@ TEST(CommandLineParserTest, StandardOptionsSuccessfullyParsed)
     EXPECT_EQ(parser.GetOptions().GetNumExtraOptions(), 0);
 }
 
+TEST(CommandLineParserTest, MemoryStatsFileSuccessfullyParsed)
+{
+    CommandLineParser parser;
+    const char*       args[] = {"/path/to/executable", "--headless", "--memory-stats-file", "/path/to/memory.csv"};
+    EXPECT_FALSE(parser.Parse(4, args));
+
+    StandardOptions wantOptions;
+    wantOptions.headless          = true;
+    wantOptions.memory_stats_file = "/path/to/memory.csv";
+
+    EXPECT_EQ(parser.GetOptions().GetStandardOptions(), wantOptions);
+    EXPECT_EQ(parser.GetOptions().GetNumExtraOptions(), 0);
+}
+
+TEST(CommandLineParserTest, PipelineCacheFileSuccessfullyParsed)
+{
+    CommandLineParser parser;
+    const char*       args[] = {"/path/to/executable", "--pipeline-cache-file", "/path/to/pipelines.bin"};
+    EXPECT_FALSE(parser.Parse(3, args));
+
+    StandardOptions wantOptions;
+    wantOptions.pipeline_cache_file = "/path/to/pipelines.bin";
+
+    EXPECT_EQ(parser.GetOptions().GetStandardOptions(), wantOptions);
+    EXPECT_EQ(parser.GetOptions().GetNumExtraOptions(), 0);
+}
+
+TEST(CommandLineParserTest, FramePacingSuccessfullyParsed)
+{
+    CommandLineParser parser;
+    const char*       args[] = {"/path/to/executable", "--frame-pacing", "low-latency", "--frame-stats-file", "/path/to/frames.csv"};
+    EXPECT_FALSE(parser.Parse(5, args));
+
+    StandardOptions wantOptions;
+    wantOptions.frame_pacing     = "low-latency";
+    wantOptions.frame_stats_file = "/path/to/frames.csv";
+
+    EXPECT_EQ(parser.GetOptions().GetStandardOptions(), wantOptions);
+    EXPECT_EQ(parser.GetOptions().GetNumExtraOptions(), 0);
+}
+
+TEST(CommandLineParserTest, GpuStatsFileSuccessfullyParsed)
+{
+    CommandLineParser parser;
+    const char*       args[] = {"/path/to/executable", "--gpu-stats-file", "/path/to/gpu.csv"};
+    EXPECT_FALSE(parser.Parse(3, args));
+
+    StandardOptions wantOptions;
+    wantOptions.gpu_stats_file = "/path/to/gpu.csv";
+
+    EXPECT_EQ(parser.GetOptions().GetStandardOptions(), wantOptions);
+    EXPECT_EQ(parser.GetOptions().GetNumExtraOptions(), 0);
+
+    const char* missingArgs[] = {"/path/to/executable", "--gpu-stats-file"};
+    EXPECT_TRUE(parser.Parse(2, missingArgs));
+}
+
 TEST(CommandLineParserTest, ExtraOptionsSuccessfullyParsed)
 {
     CommandLineParser parser;
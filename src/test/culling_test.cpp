@@ -0,0 +1,185 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/culling.h"
+
+using namespace ppx;
+
+namespace {
+
+// Camera at the origin looking down -Z, near 1, far 100, 90 degree fov.
+Frustum CreateTestFrustum()
+{
+    float4x4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 100.0f);
+    float4x4 view       = glm::lookAt(float3(0, 0, 0), float3(0, 0, -1), float3(0, 1, 0));
+    return Frustum(projection * view);
+}
+
+// Fills the culler with boxes and spheres scattered around the frustum.
+void AddRandomVolumes(uint32_t count, FrustumCuller* pCuller)
+{
+    uint32_t seed   = 0x9E3779B9;
+    auto     random = [&seed](float range) {
+        seed = seed * 1664525 + 1013904223;
+        return (static_cast<float>(seed >> 8) / static_cast<float>(1 << 24) - 0.5f) * range;
+    };
+    for (uint32_t i = 0; i < count; ++i) {
+        float3 center = float3(random(300.0f), random(300.0f), random(300.0f));
+        if (i % 2 == 0) {
+            float3 size = float3(random(4.0f) + 2.0f, random(4.0f) + 2.0f, random(4.0f) + 2.0f);
+            pCuller->AddAABB(AABB(center - size / 2.0f, center + size / 2.0f));
+        }
+        else {
+            pCuller->AddSphere(center, random(4.0f) + 2.0f);
+        }
+    }
+}
+
+} // namespace
+
+TEST(CullingTest, FrustumPlanesFromPerspective)
+{
+    Frustum frustum = CreateTestFrustum();
+
+    EXPECT_TRUE(frustum.Contains(float3(0, 0, -50)));
+    EXPECT_TRUE(frustum.Contains(float3(9, -9, -10)));
+    EXPECT_FALSE(frustum.Contains(float3(0, 0, -0.5f)));
+    EXPECT_FALSE(frustum.Contains(float3(0, 0, -101)));
+    EXPECT_FALSE(frustum.Contains(float3(11, 0, -10)));
+    EXPECT_FALSE(frustum.Contains(float3(0, 0, 10)));
+
+    // Planes are normalized so the near plane is at distance 1 from the camera
+    const float4& plane = frustum.GetPlane(Frustum::PLANE_NEAR);
+    EXPECT_NEAR(plane.z, -1.0f, 1e-5f);
+    EXPECT_NEAR(plane.w, -1.0f, 1e-4f);
+}
+
+TEST(CullingTest, FrustumIntersectsVolumes)
+{
+    Frustum frustum = CreateTestFrustum();
+
+    // Straddles the left plane
+    EXPECT_TRUE(frustum.Intersects(AABB(float3(-12, -1, -11), float3(-9, 1, -9))));
+    EXPECT_FALSE(frustum.Intersects(AABB(float3(-14, -1, -11), float3(-12, 1, -9))));
+    // Behind the camera
+    EXPECT_FALSE(frustum.Intersects(AABB(float3(-1, -1, 1), float3(1, 1, 3))));
+
+    EXPECT_TRUE(frustum.IntersectsSphere(float3(0, 0, 1), 2.5f));
+    EXPECT_FALSE(frustum.IntersectsSphere(float3(0, 0, 1), 1.5f));
+
+    // A thin box rotated 45 degrees around Y. Its world bounds reach past the
+    // far plane even though its center doesn't
+    OBB obb(float3(0, 0, -99), float3(4, 1, 0.1f), float3(1, 0, 1), float3(0, 1, 0), float3(-1, 0, 1));
+    EXPECT_TRUE(frustum.Intersects(obb));
+    EXPECT_FALSE(frustum.Intersects(OBB(float3(0, 0, -104), float3(4, 1, 0.1f), float3(1, 0, 1), float3(0, 1, 0), float3(-1, 0, 1))));
+}
+
+TEST(CullingTest, ObbPointsMatchAabbCorners)
+{
+    AABB aabb(float3(-1, -2, -3), float3(4, 5, 6));
+    OBB  obb(aabb);
+
+    float3 expected[8];
+    float3 points[8];
+    aabb.Transform(float4x4(1.0f), expected);
+    obb.GetPoints(points);
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(points[i], expected[i]) << "corner " << i;
+    }
+}
+
+TEST(CullingTest, CullerMatchesFrustum)
+{
+    Frustum       frustum = CreateTestFrustum();
+    FrustumCuller culler;
+    culler.SetInstructionSet(INSTRUCTION_SET_SCALAR);
+
+    AABB inside(float3(-1, -1, -6), float3(1, 1, -4));
+    AABB outside(float3(-1, -1, 4), float3(1, 1, 6));
+    EXPECT_EQ(culler.AddAABB(inside), 0u);
+    EXPECT_EQ(culler.AddAABB(outside), 1u);
+    EXPECT_EQ(culler.AddSphere(float3(0, 0, 1), 2.5f), 2u);
+    EXPECT_EQ(culler.AddSphere(float3(0, 0, 1), 1.5f), 3u);
+
+    std::vector<uint32_t> visible;
+    EXPECT_EQ(culler.Cull(frustum, &visible), 2u);
+    EXPECT_EQ(visible, std::vector<uint32_t>({0, 2}));
+
+    culler.SetAABB(1, inside);
+    culler.SetSphere(2, float3(0, 0, 10), 1.0f);
+    culler.Cull(frustum, &visible);
+    EXPECT_EQ(visible, std::vector<uint32_t>({0, 1}));
+
+    const CullingStats& stats = culler.GetStats();
+    EXPECT_EQ(stats.objectCount, 4u);
+    EXPECT_EQ(stats.visibleCount, 2u);
+    EXPECT_EQ(stats.frustumCulledCount, 2u);
+}
+
+TEST(CullingTest, InstructionSetsMatchScalar)
+{
+    Frustum       frustum = CreateTestFrustum();
+    FrustumCuller culler;
+    AddRandomVolumes(10001, &culler);
+
+    std::vector<uint32_t> expected;
+    ASSERT_TRUE(culler.SetInstructionSet(INSTRUCTION_SET_SCALAR));
+    culler.Cull(frustum, &expected);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_LT(expected.size(), 10001u);
+
+    for (InstructionSet instructionSet : {INSTRUCTION_SET_SSE2, INSTRUCTION_SET_AVX2, INSTRUCTION_SET_NEON}) {
+        if (!culler.SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        std::vector<uint32_t> visible;
+        culler.Cull(frustum, &visible);
+        EXPECT_EQ(visible, expected) << ToString(instructionSet);
+    }
+}
+
+TEST(CullingTest, MultithreadedCullIsOrdered)
+{
+    Frustum       frustum = CreateTestFrustum();
+    FrustumCuller culler;
+    AddRandomVolumes(50000, &culler);
+
+    std::vector<uint32_t> expected;
+    culler.Cull(frustum, &expected);
+
+    culler.SetChunkSize(1000);
+    EXPECT_EQ(culler.GetChunkSize(), 1000u);
+    culler.SetThreadCount(4);
+
+    std::vector<uint32_t> visible;
+    culler.Cull(frustum, &visible);
+    EXPECT_EQ(visible, expected);
+    EXPECT_EQ(culler.GetStats().visibleCount, static_cast<uint32_t>(expected.size()));
+    EXPECT_GE(culler.GetStats().threadCount, 1u);
+}
+
+TEST(CullingTest, EmptyCuller)
+{
+    FrustumCuller         culler;
+    std::vector<uint32_t> visible = {1, 2, 3};
+    EXPECT_EQ(culler.Cull(CreateTestFrustum(), &visible), 0u);
+    EXPECT_TRUE(visible.empty());
+
+    culler.AddSphere(float3(0, 0, -5), 1.0f);
+    culler.Clear();
+    EXPECT_EQ(culler.GetCount(), 0u);
+    EXPECT_EQ(culler.Cull(CreateTestFrustum(), &visible), 0u);
+}
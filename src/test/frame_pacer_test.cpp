@@ -0,0 +1,83 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/frame_pacer.h"
+
+using namespace ppx;
+
+namespace {
+
+void RunFrames(FramePacer& pacer, uint32_t frameCount)
+{
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        pacer.WaitForFrameStart();
+        pacer.BeginRender();
+        pacer.EndRender();
+    }
+}
+
+} // namespace
+
+TEST(FramePacerTest, ParseModeRoundTrips)
+{
+    for (FramePacingMode mode : {FRAME_PACING_MODE_UNLOCKED, FRAME_PACING_MODE_VSYNC, FRAME_PACING_MODE_FIXED_RATE, FRAME_PACING_MODE_LOW_LATENCY}) {
+        FramePacingMode parsed = FRAME_PACING_MODE_UNLOCKED;
+        EXPECT_TRUE(ParseFramePacingMode(ToString(mode), &parsed));
+        EXPECT_EQ(parsed, mode);
+    }
+
+    FramePacingMode parsed = FRAME_PACING_MODE_VSYNC;
+    EXPECT_FALSE(ParseFramePacingMode("fast", &parsed));
+    EXPECT_EQ(parsed, FRAME_PACING_MODE_VSYNC);
+}
+
+TEST(FramePacerTest, FramesWithoutQueueCompleteImmediately)
+{
+    ASSERT_EQ(Timer::InitializeStaticData(), TIMER_RESULT_SUCCESS);
+
+    FramePacer pacer;
+    ASSERT_EQ(pacer.Initialize(FRAME_PACING_MODE_UNLOCKED, 0, true, nullptr), ppx::SUCCESS);
+    RunFrames(pacer, 5);
+
+    std::vector<FrameTiming> timings;
+    pacer.GetCompletedFrames(&timings);
+    ASSERT_EQ(timings.size(), 5u);
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(timings[i].frameNumber, i);
+        EXPECT_EQ(timings[i].gpuCompletionLatency, 0);
+    }
+    EXPECT_EQ(pacer.GetLastCompletedFrame().frameNumber, 4u);
+
+    timings.clear();
+    pacer.GetCompletedFrames(&timings);
+    EXPECT_TRUE(timings.empty());
+}
+
+TEST(FramePacerTest, FixedRateSpacesFrames)
+{
+    ASSERT_EQ(Timer::InitializeStaticData(), TIMER_RESULT_SUCCESS);
+
+    // 10 frames at 200 Hz: the first starts right away, the others at 5 ms
+    // intervals. Only the lower bound is checked, the upper one depends on
+    // the machine's load.
+    FramePacer pacer;
+    ASSERT_EQ(pacer.Initialize(FRAME_PACING_MODE_FIXED_RATE, 200, false, nullptr), ppx::SUCCESS);
+
+    Timer timer;
+    ASSERT_EQ(timer.Start(), TIMER_RESULT_SUCCESS);
+    RunFrames(pacer, 10);
+    EXPECT_GE(timer.MillisSinceStart(), 9 * 5.0 - 0.5);
+}
@@ -0,0 +1,101 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_gpu_profiler.h"
+
+using namespace ppx;
+
+namespace {
+
+grfx::internal::GpuProfilerScopeRecord MakeRecord(const std::string& name, uint32_t depth, int32_t parentIndex, uint32_t pipelineStatsIndex = UINT32_MAX)
+{
+    grfx::internal::GpuProfilerScopeRecord record = {};
+    record.name                                   = name;
+    record.depth                                  = depth;
+    record.parentIndex                            = parentIndex;
+    record.pipelineStatsIndex                     = pipelineStatsIndex;
+    return record;
+}
+
+} // namespace
+
+TEST(GpuProfilerTest, ResolvesNestedScopes)
+{
+    // Shadow { } Main { Opaque { } Transparent { } }
+    std::vector<grfx::internal::GpuProfilerScopeRecord> records = {
+        MakeRecord("Shadow", 0, -1),
+        MakeRecord("Main", 0, -1),
+        MakeRecord("Opaque", 1, 1),
+        MakeRecord("Transparent", 1, 1),
+    };
+    // 1 tick per microsecond
+    const uint64_t timestamps[] = {1000, 3000, 3000, 9000, 3500, 7000, 7000, 8500};
+
+    grfx::GpuProfilerFrame frame = {};
+    grfx::internal::ResolveGpuProfilerFrame(records, timestamps, nullptr, 1000000, &frame);
+
+    ASSERT_EQ(frame.scopes.size(), 4u);
+    EXPECT_DOUBLE_EQ(frame.gpuTimeMs, 8.0);
+    EXPECT_DOUBLE_EQ(frame.scopes[0].gpuTimeMs, 2.0);
+    EXPECT_DOUBLE_EQ(frame.scopes[1].gpuTimeMs, 6.0);
+    EXPECT_DOUBLE_EQ(frame.scopes[2].gpuTimeMs, 3.5);
+    EXPECT_DOUBLE_EQ(frame.scopes[3].gpuTimeMs, 1.5);
+
+    EXPECT_EQ(frame.scopes[2].name, "Opaque");
+    EXPECT_EQ(frame.scopes[2].depth, 1u);
+    EXPECT_EQ(frame.scopes[2].parentIndex, 1);
+    EXPECT_EQ(frame.scopes[0].parentIndex, -1);
+    EXPECT_FALSE(frame.scopes[0].hasPipelineStatistics);
+}
+
+TEST(GpuProfilerTest, PipelineStatisticsFollowScopes)
+{
+    std::vector<grfx::internal::GpuProfilerScopeRecord> records = {
+        MakeRecord("Main", 0, -1, 0),
+        MakeRecord("Opaque", 1, 0),
+        MakeRecord("Post", 0, -1, 1),
+    };
+    const uint64_t timestamps[] = {0, 10, 2, 8, 10, 12};
+
+    grfx::PipelineStatistics statistics[2] = {};
+    statistics[0].VSInvocations            = 300;
+    statistics[1].PSInvocations            = 1920 * 1080;
+
+    grfx::GpuProfilerFrame frame = {};
+    grfx::internal::ResolveGpuProfilerFrame(records, timestamps, statistics, 1000, &frame);
+
+    ASSERT_EQ(frame.scopes.size(), 3u);
+    EXPECT_TRUE(frame.scopes[0].hasPipelineStatistics);
+    EXPECT_EQ(frame.scopes[0].pipelineStatistics.VSInvocations, 300u);
+    EXPECT_FALSE(frame.scopes[1].hasPipelineStatistics);
+    EXPECT_TRUE(frame.scopes[2].hasPipelineStatistics);
+    EXPECT_EQ(frame.scopes[2].pipelineStatistics.PSInvocations, 1920u * 1080u);
+}
+
+TEST(GpuProfilerTest, BackwardsTimestampsClampToZero)
+{
+    std::vector<grfx::internal::GpuProfilerScopeRecord> records = {
+        MakeRecord("Wrapped", 0, -1),
+    };
+    const uint64_t timestamps[] = {UINT64_MAX - 5, 10};
+
+    grfx::GpuProfilerFrame frame = {};
+    grfx::internal::ResolveGpuProfilerFrame(records, timestamps, nullptr, 1000, &frame);
+
+    ASSERT_EQ(frame.scopes.size(), 1u);
+    EXPECT_EQ(frame.scopes[0].gpuTimeMs, 0.0);
+    EXPECT_EQ(frame.gpuTimeMs, 0.0);
+}
@@ -0,0 +1,203 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/math_kernels.h"
+
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+const InstructionSet kInstructionSets[] = {
+    INSTRUCTION_SET_SCALAR,
+    INSTRUCTION_SET_SSE2,
+    INSTRUCTION_SET_AVX2,
+    INSTRUCTION_SET_NEON,
+};
+
+// Not a multiple of 4 or 8, so the SIMD variants also run their tail.
+const size_t kCount = 37;
+
+// Restores the default kernel dispatch when a test ends.
+class MathKernelsTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        math_kernels::SetInstructionSet(GetBestInstructionSet());
+    }
+
+    float Next(float range)
+    {
+        mSeed = mSeed * 1664525 + 1013904223;
+        return (static_cast<float>(mSeed >> 8) / static_cast<float>(1 << 24) - 0.5f) * range;
+    }
+
+    float3 Next3(float range) { return float3(Next(range), Next(range), Next(range)); }
+
+    quat NextRotation() { return glm::angleAxis(Next(6.0f), glm::normalize(Next3(2.0f) + float3(0, 0, 1.5f))); }
+
+    float4x4 NextMatrix()
+    {
+        return glm::translate(Next3(20.0f)) * glm::mat4_cast(NextRotation()) * glm::scale(Next3(2.0f) + float3(1.5f));
+    }
+
+private:
+    uint32_t mSeed = 0x9E3779B9;
+};
+
+void ExpectNear(const float3& actual, const float3& expected)
+{
+    EXPECT_NEAR(actual.x, expected.x, 1e-4f);
+    EXPECT_NEAR(actual.y, expected.y, 1e-4f);
+    EXPECT_NEAR(actual.z, expected.z, 1e-4f);
+}
+
+void ExpectNear(const float4x4& actual, const float4x4& expected)
+{
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            EXPECT_NEAR(actual[c][r], expected[c][r], 1e-3f) << "column " << c << " row " << r;
+        }
+    }
+}
+
+} // namespace
+
+TEST_F(MathKernelsTest, TransformPoints)
+{
+    const float4x4      matrix = NextMatrix();
+    std::vector<float3> points(kCount);
+    for (float3& point : points) {
+        point = Next3(10.0f);
+    }
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!math_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        std::vector<float3> results(kCount);
+        math_kernels::TransformPoints(matrix, points.data(), results.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ExpectNear(results[i], float3(matrix * float4(points[i], 1.0f)));
+        }
+
+        std::vector<float3> inPlace = points;
+        math_kernels::TransformPoints(matrix, inPlace.data(), inPlace.data(), kCount);
+        EXPECT_EQ(inPlace, results);
+    }
+}
+
+TEST_F(MathKernelsTest, MultiplyMatrices)
+{
+    const float4x4        viewProjection = glm::perspective(1.0f, 1.5f, 0.1f, 100.0f) * NextMatrix();
+    std::vector<float4x4> a(kCount);
+    std::vector<float4x4> b(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        a[i] = NextMatrix();
+        b[i] = NextMatrix();
+    }
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!math_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        std::vector<float4x4> results(kCount);
+        math_kernels::MultiplyMatrices(a.data(), b.data(), results.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ExpectNear(results[i], a[i] * b[i]);
+        }
+
+        std::vector<float4x4> inPlace = b;
+        math_kernels::MultiplyMatrices(viewProjection, inPlace.data(), inPlace.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ExpectNear(inPlace[i], viewProjection * b[i]);
+        }
+    }
+}
+
+TEST_F(MathKernelsTest, ComposeTRS)
+{
+    std::vector<float3> translations(kCount);
+    std::vector<quat>   rotations(kCount);
+    std::vector<float3> scales(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        translations[i] = Next3(20.0f);
+        rotations[i]    = NextRotation();
+        scales[i]       = Next3(2.0f);
+    }
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!math_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        std::vector<float4x4> results(kCount);
+        math_kernels::ComposeTRS(translations.data(), rotations.data(), scales.data(), results.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ExpectNear(results[i], glm::translate(translations[i]) * glm::mat4_cast(rotations[i]) * glm::scale(scales[i]));
+        }
+    }
+}
+
+TEST_F(MathKernelsTest, TransformAABBs)
+{
+    std::vector<float4x4> matrices(kCount);
+    std::vector<AABB>     boxes(kCount);
+    for (size_t i = 0; i < kCount; ++i) {
+        matrices[i] = NextMatrix();
+        boxes[i]    = AABB(Next3(10.0f), Next3(10.0f));
+    }
+
+    // Bounds of the 8 transformed corners
+    auto expectBounds = [](const AABB& actual, const float4x4& matrix, const AABB& box) {
+        AABB expected(float3(matrix * float4(box.GetMin(), 1.0f)));
+        for (int i = 0; i < 8; ++i) {
+            const float3 corner = float3(
+                (i & 1) ? box.GetMax().x : box.GetMin().x,
+                (i & 2) ? box.GetMax().y : box.GetMin().y,
+                (i & 4) ? box.GetMax().z : box.GetMin().z);
+            expected.Expand(float3(matrix * float4(corner, 1.0f)));
+        }
+        ExpectNear(actual.GetMin(), expected.GetMin());
+        ExpectNear(actual.GetMax(), expected.GetMax());
+    };
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        if (!math_kernels::SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        std::vector<AABB> results(kCount);
+        math_kernels::TransformAABBs(matrices.data(), boxes.data(), results.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            expectBounds(results[i], matrices[i], boxes[i]);
+        }
+
+        std::vector<AABB> inPlace = boxes;
+        math_kernels::TransformAABBs(matrices[0], inPlace.data(), inPlace.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            expectBounds(inPlace[i], matrices[0], boxes[i]);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_mesh_pool_allocator.h"
+
+using namespace ppx;
+using namespace ppx::grfx;
+
+TEST(MeshPoolAllocatorTest, CreateRejectsEmptyVertexRange)
+{
+    MeshPoolAllocator allocator;
+    EXPECT_EQ(MeshPoolAllocator::Create(0, 16, &allocator), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(MeshPoolAllocator::Create(16, 0, &allocator), SUCCESS);
+}
+
+TEST(MeshPoolAllocatorTest, AllocatesDisjointRanges)
+{
+    MeshPoolAllocator allocator;
+    ASSERT_EQ(MeshPoolAllocator::Create(100, 300, &allocator), SUCCESS);
+
+    uint32_t a = MeshPoolAllocator::kInvalidHandle;
+    uint32_t b = MeshPoolAllocator::kInvalidHandle;
+    ASSERT_EQ(allocator.Allocate(40, 120, &a), SUCCESS);
+    ASSERT_EQ(allocator.Allocate(60, 180, &b), SUCCESS);
+
+    const MeshPoolRange& ra = allocator.GetRange(a);
+    const MeshPoolRange& rb = allocator.GetRange(b);
+    EXPECT_TRUE((ra.vertexOffset + ra.vertexCount <= rb.vertexOffset) || (rb.vertexOffset + rb.vertexCount <= ra.vertexOffset));
+    EXPECT_TRUE((ra.firstIndex + ra.indexCount <= rb.firstIndex) || (rb.firstIndex + rb.indexCount <= ra.firstIndex));
+    EXPECT_EQ(allocator.GetUsedVertexCount(), 100u);
+    EXPECT_EQ(allocator.GetUsedIndexCount(), 300u);
+    EXPECT_EQ(allocator.GetMeshCount(), 2u);
+
+    uint32_t c = MeshPoolAllocator::kInvalidHandle;
+    EXPECT_EQ(allocator.Allocate(1, 0, &c), ERROR_OUT_OF_MEMORY);
+}
+
+TEST(MeshPoolAllocatorTest, FailedIndexAllocationReleasesVertices)
+{
+    MeshPoolAllocator allocator;
+    ASSERT_EQ(MeshPoolAllocator::Create(100, 10, &allocator), SUCCESS);
+
+    uint32_t a = MeshPoolAllocator::kInvalidHandle;
+    ASSERT_EQ(allocator.Allocate(10, 8, &a), SUCCESS);
+
+    uint32_t b = MeshPoolAllocator::kInvalidHandle;
+    EXPECT_EQ(allocator.Allocate(10, 8, &b), ERROR_OUT_OF_MEMORY);
+    EXPECT_EQ(allocator.GetUsedVertexCount(), 10u);
+    EXPECT_EQ(allocator.GetMeshCount(), 1u);
+}
+
+TEST(MeshPoolAllocatorTest, FreeReusesHandles)
+{
+    MeshPoolAllocator allocator;
+    ASSERT_EQ(MeshPoolAllocator::Create(100, 0, &allocator), SUCCESS);
+
+    uint32_t a = MeshPoolAllocator::kInvalidHandle;
+    ASSERT_EQ(allocator.Allocate(10, 0, &a), SUCCESS);
+    allocator.Free(a);
+    EXPECT_FALSE(allocator.IsValid(a));
+    EXPECT_EQ(allocator.GetUsedVertexCount(), 0u);
+
+    uint32_t b = MeshPoolAllocator::kInvalidHandle;
+    ASSERT_EQ(allocator.Allocate(20, 0, &b), SUCCESS);
+    EXPECT_EQ(b, a);
+    EXPECT_TRUE(allocator.IsValid(b));
+}
+
+TEST(MeshPoolAllocatorTest, DefragmentPacksRangesAndKeepsHandles)
+{
+    MeshPoolAllocator allocator;
+    ASSERT_EQ(MeshPoolAllocator::Create(100, 100, &allocator), SUCCESS);
+
+    uint32_t handles[4] = {};
+    for (uint32_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(allocator.Allocate(25, 25, &handles[i]), SUCCESS);
+    }
+
+    // Free the first and third mesh, the free space is split in two
+    MeshPoolRange kept1 = allocator.GetRange(handles[1]);
+    MeshPoolRange kept3 = allocator.GetRange(handles[3]);
+    allocator.Free(handles[0]);
+    allocator.Free(handles[2]);
+    EXPECT_GT(allocator.GetFragmentation(), 0.0f);
+
+    uint32_t big = MeshPoolAllocator::kInvalidHandle;
+    EXPECT_EQ(allocator.Allocate(50, 0, &big), ERROR_OUT_OF_MEMORY);
+
+    std::vector<MeshPoolCopy> vertexCopies;
+    std::vector<MeshPoolCopy> indexCopies;
+    allocator.Defragment(&vertexCopies, &indexCopies);
+    EXPECT_EQ(allocator.GetFragmentation(), 0.0f);
+
+    // Ranges keep their order and sizes, and the copies move their data
+    const MeshPoolRange& range1 = allocator.GetRange(handles[1]);
+    const MeshPoolRange& range3 = allocator.GetRange(handles[3]);
+    EXPECT_EQ(range1.vertexOffset, 0u);
+    EXPECT_EQ(range3.vertexOffset, 25u);
+    EXPECT_EQ(range1.firstIndex, 0u);
+    EXPECT_EQ(range3.firstIndex, 25u);
+    EXPECT_EQ(range3.vertexCount, kept3.vertexCount);
+
+    ASSERT_EQ(vertexCopies.size(), 2u);
+    EXPECT_EQ(vertexCopies[0].srcOffset, kept1.vertexOffset);
+    EXPECT_EQ(vertexCopies[0].dstOffset, 0u);
+    EXPECT_EQ(vertexCopies[0].count, 25u);
+    EXPECT_EQ(vertexCopies[1].srcOffset, kept3.vertexOffset);
+    EXPECT_EQ(vertexCopies[1].dstOffset, 25u);
+    EXPECT_EQ(indexCopies.size(), 2u);
+
+    EXPECT_EQ(allocator.Allocate(50, 50, &big), SUCCESS);
+}
+
+TEST(MeshPoolAllocatorTest, DefragmentMergesAdjacentCopies)
+{
+    MeshPoolAllocator allocator;
+    ASSERT_EQ(MeshPoolAllocator::Create(100, 100, &allocator), SUCCESS);
+
+    uint32_t a = MeshPoolAllocator::kInvalidHandle;
+    uint32_t b = MeshPoolAllocator::kInvalidHandle;
+    uint32_t c = MeshPoolAllocator::kInvalidHandle;
+    ASSERT_EQ(allocator.Allocate(10, 0, &a), SUCCESS);
+    ASSERT_EQ(allocator.Allocate(20, 30, &b), SUCCESS);
+    ASSERT_EQ(allocator.Allocate(30, 0, &c), SUCCESS);
+    allocator.Free(a);
+
+    std::vector<MeshPoolCopy> vertexCopies;
+    std::vector<MeshPoolCopy> indexCopies;
+    allocator.Defragment(&vertexCopies, &indexCopies);
+
+    ASSERT_EQ(vertexCopies.size(), 1u);
+    EXPECT_EQ(vertexCopies[0].dstOffset, 0u);
+    EXPECT_EQ(vertexCopies[0].count, 50u);
+
+    // Meshes without indices don't take part in index packing
+    ASSERT_EQ(indexCopies.size(), 1u);
+    EXPECT_EQ(indexCopies[0].count, 30u);
+    EXPECT_EQ(allocator.GetRange(c).indexCount, 0u);
+}
@@ -0,0 +1,82 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/parallel.h"
+
+#include <stdexcept>
+
+using namespace ppx;
+
+TEST(ParallelTest, ParallelForVisitsEveryIndexOnce)
+{
+    std::vector<std::atomic<uint32_t>> visits(1000);
+    ParallelFor(static_cast<uint32_t>(visits.size()), 4, [&](uint32_t i) { ++visits[i]; });
+    for (const std::atomic<uint32_t>& count : visits) {
+        EXPECT_EQ(count.load(), 1u);
+    }
+}
+
+TEST(ParallelTest, TaskQueueReturnsResults)
+{
+    TaskQueue queue(3);
+    EXPECT_EQ(queue.GetThreadCount(), 3u);
+
+    std::vector<std::future<uint32_t>> futures;
+    for (uint32_t i = 0; i < 100; ++i) {
+        futures.push_back(queue.Submit([i]() { return i * i; }));
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(futures[i].get(), i * i);
+    }
+}
+
+TEST(ParallelTest, TaskQueueStoresExceptions)
+{
+    TaskQueue         queue(1);
+    std::future<void> future = queue.Submit([]() { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+
+    // The worker survives the exception
+    EXPECT_EQ(queue.Submit([]() { return 7; }).get(), 7);
+}
+
+TEST(ParallelTest, TaskQueueWaitIdle)
+{
+    TaskQueue             queue(2);
+    std::atomic<uint32_t> done(0);
+    for (uint32_t i = 0; i < 50; ++i) {
+        queue.Submit([&done]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            ++done;
+        });
+    }
+    queue.WaitIdle();
+    EXPECT_EQ(done.load(), 50u);
+}
+
+TEST(ParallelTest, TaskQueueRunsQueuedTasksOnDestruction)
+{
+    std::atomic<uint32_t> done(0);
+    std::future<void>     last;
+    {
+        TaskQueue queue(1);
+        for (uint32_t i = 0; i < 20; ++i) {
+            last = queue.Submit([&done]() { ++done; });
+        }
+    }
+    EXPECT_EQ(done.load(), 20u);
+    EXPECT_NO_THROW(last.get());
+}
@@ -0,0 +1,129 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_pipeline.h"
+
+using namespace ppx;
+
+namespace {
+
+grfx::GraphicsPipelineCreateInfo2 MakeCreateInfo()
+{
+    grfx::GraphicsPipelineCreateInfo2 createInfo  = {};
+    createInfo.vertexInputState.bindingCount      = 1;
+    createInfo.vertexInputState.bindings[0]       = grfx::VertexBinding(0, grfx::VERTEX_INPUT_RATE_VERTEX);
+    createInfo.topology                           = grfx::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    createInfo.cullMode                           = grfx::CULL_MODE_BACK;
+    createInfo.depthReadEnable                    = true;
+    createInfo.depthWriteEnable                   = true;
+    createInfo.outputState.renderTargetCount      = 1;
+    createInfo.outputState.renderTargetFormats[0] = grfx::FORMAT_B8G8R8A8_UNORM;
+    createInfo.outputState.depthStencilFormat     = grfx::FORMAT_D32_FLOAT;
+    createInfo.vertexInputState.bindings[0] += grfx::VertexAttribute{"POSITION", 0, grfx::FORMAT_R32G32B32_FLOAT, 0, PPX_APPEND_OFFSET_ALIGNED, grfx::VERTEX_INPUT_RATE_VERTEX};
+    return createInfo;
+}
+
+std::string GetKey(const grfx::GraphicsPipelineCreateInfo2& createInfo2)
+{
+    grfx::GraphicsPipelineCreateInfo createInfo = {};
+    grfx::internal::FillOutGraphicsPipelineCreateInfo(&createInfo2, &createInfo);
+
+    std::string key;
+    grfx::internal::GetGraphicsPipelineKey(createInfo, true, &key);
+    return key;
+}
+
+} // namespace
+
+TEST(PipelineKeyTest, SameDescriptionSameKey)
+{
+    EXPECT_EQ(GetKey(MakeCreateInfo()), GetKey(MakeCreateInfo()));
+}
+
+TEST(PipelineKeyTest, StateChangesKey)
+{
+    const std::string key = GetKey(MakeCreateInfo());
+
+    grfx::GraphicsPipelineCreateInfo2 createInfo = MakeCreateInfo();
+    createInfo.cullMode                          = grfx::CULL_MODE_NONE;
+    EXPECT_NE(key, GetKey(createInfo));
+
+    createInfo                                    = MakeCreateInfo();
+    createInfo.outputState.renderTargetFormats[0] = grfx::FORMAT_R16G16B16A16_FLOAT;
+    EXPECT_NE(key, GetKey(createInfo));
+
+    createInfo               = MakeCreateInfo();
+    createInfo.blendModes[0] = grfx::BLEND_MODE_ALPHA;
+    EXPECT_NE(key, GetKey(createInfo));
+
+    createInfo = MakeCreateInfo();
+    createInfo.vertexInputState.bindings[0].SetStride(32);
+    EXPECT_NE(key, GetKey(createInfo));
+
+    createInfo                              = MakeCreateInfo();
+    createInfo.outputState.dynamicRendering = true;
+    EXPECT_NE(key, GetKey(createInfo));
+}
+
+TEST(PipelineKeyTest, IgnoredStateDoesNotChangeKey)
+{
+    grfx::GraphicsPipelineCreateInfo2 createInfo2 = MakeCreateInfo();
+    grfx::GraphicsPipelineCreateInfo  base        = {};
+    grfx::internal::FillOutGraphicsPipelineCreateInfo(&createInfo2, &base);
+
+    std::string baseKey;
+    grfx::internal::GetGraphicsPipelineKey(base, true, &baseKey);
+
+    // Blend factors of attachments without blending
+    grfx::GraphicsPipelineCreateInfo createInfo                        = base;
+    createInfo.colorBlendState.blendAttachments[0].blendEnable         = false;
+    createInfo.colorBlendState.blendAttachments[0].colorBlendOp        = grfx::BLEND_OP_MAX;
+    createInfo.colorBlendState.blendAttachments[0].srcAlphaBlendFactor = grfx::BLEND_FACTOR_ONE;
+
+    std::string key;
+    grfx::internal::GetGraphicsPipelineKey(createInfo, true, &key);
+    EXPECT_EQ(baseKey, key);
+
+    // Depth bias factors with depth bias disabled
+    createInfo                                     = base;
+    createInfo.rasterState.depthBiasEnable         = false;
+    createInfo.rasterState.depthBiasSlopeFactor    = 2.0f;
+    createInfo.rasterState.depthBiasConstantFactor = 1.0f;
+    grfx::internal::GetGraphicsPipelineKey(createInfo, true, &key);
+    EXPECT_EQ(baseKey, key);
+
+    // Stencil state with the stencil test disabled
+    createInfo                                     = base;
+    createInfo.depthStencilState.stencilTestEnable = false;
+    createInfo.depthStencilState.front.passOp      = grfx::STENCIL_OP_REPLACE;
+    grfx::internal::GetGraphicsPipelineKey(createInfo, true, &key);
+    EXPECT_EQ(baseKey, key);
+
+    // Formats past the render target count
+    createInfo                                    = base;
+    createInfo.outputState.renderTargetFormats[3] = grfx::FORMAT_R8_UNORM;
+    grfx::internal::GetGraphicsPipelineKey(createInfo, true, &key);
+    EXPECT_EQ(baseKey, key);
+}
+
+TEST(PipelineKeyTest, EntryPointChangesKey)
+{
+    grfx::GraphicsPipelineCreateInfo2 createInfo = MakeCreateInfo();
+    const std::string                 key        = GetKey(createInfo);
+
+    createInfo.PS.entryPoint = "psmain2";
+    EXPECT_NE(key, GetKey(createInfo));
+}
@@ -0,0 +1,158 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/random.h"
+
+#include <vector>
+
+using namespace ppx;
+
+namespace {
+
+const InstructionSet kInstructionSets[] = {
+    INSTRUCTION_SET_SCALAR,
+    INSTRUCTION_SET_SSE2,
+    INSTRUCTION_SET_AVX2,
+    INSTRUCTION_SET_NEON,
+};
+
+// Not a multiple of the block size or of the SIMD widths.
+const size_t kCount = 1000;
+
+const uint64_t kSeed = 0x0123456789ABCDEF;
+
+} // namespace
+
+TEST(RandomTest, SeedIsUsed)
+{
+    Random a(1, 7);
+    Random b(2, 7);
+    Random c(1, 7);
+
+    const uint32_t value = a.UInt32();
+    EXPECT_NE(value, b.UInt32());
+    EXPECT_EQ(value, c.UInt32());
+}
+
+TEST(RandomStreamTest, KnownAnswer)
+{
+    // Philox4x32-10 with a zero counter and key, from the Random123 test vectors
+    RandomStream stream(0, 0);
+    EXPECT_EQ(stream.UInt32(), 0x6627E8D5u);
+    EXPECT_EQ(stream.UInt32(), 0xE169C58Du);
+    EXPECT_EQ(stream.UInt32(), 0xBC57AC4Cu);
+    EXPECT_EQ(stream.UInt32(), 0x9B00DBD8u);
+    EXPECT_EQ(stream.GetPosition(), 4u);
+}
+
+TEST(RandomStreamTest, FillMatchesSequentialCalls)
+{
+    std::vector<uint32_t> expectedUInt32(kCount + 3);
+    std::vector<float>    expectedFloat(3 * kCount + 3);
+    {
+        RandomStream stream(kSeed, 5);
+        for (uint32_t& value : expectedUInt32) {
+            value = stream.UInt32();
+        }
+        stream.Seed(kSeed, 5);
+        for (float& value : expectedFloat) {
+            value = stream.Float();
+        }
+    }
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        RandomStream stream(kSeed, 5);
+        if (!stream.SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        // Start in the middle of a block so the fill has a head and a tail
+        std::vector<uint32_t> values(kCount);
+        EXPECT_EQ(stream.UInt32(), expectedUInt32[0]);
+        EXPECT_EQ(stream.UInt32(), expectedUInt32[1]);
+        EXPECT_EQ(stream.UInt32(), expectedUInt32[2]);
+        stream.FillUInt32(values.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ASSERT_EQ(values[i], expectedUInt32[i + 3]) << "index " << i;
+        }
+
+        stream.Seed(kSeed, 5);
+        EXPECT_EQ(stream.Float(), expectedFloat[0]);
+        EXPECT_EQ(stream.Float(), expectedFloat[1]);
+        EXPECT_EQ(stream.Float(), expectedFloat[2]);
+        std::vector<float3> points(kCount);
+        stream.FillFloat3(points.data(), kCount);
+        for (size_t i = 0; i < kCount; ++i) {
+            ASSERT_EQ(points[i].x, expectedFloat[3 * i + 3]) << "index " << i;
+            ASSERT_EQ(points[i].y, expectedFloat[3 * i + 4]) << "index " << i;
+            ASSERT_EQ(points[i].z, expectedFloat[3 * i + 5]) << "index " << i;
+        }
+    }
+}
+
+TEST(RandomStreamTest, FillRanges)
+{
+    const float4 a(-200.0f, 50.0f, -200.0f, 0.5f);
+    const float4 b(200.0f, 450.0f, 200.0f, 1.0f);
+
+    for (InstructionSet instructionSet : kInstructionSets) {
+        RandomStream stream(kSeed);
+        if (!stream.SetInstructionSet(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(ToString(instructionSet));
+
+        std::vector<float4> values(kCount);
+        stream.FillFloat4(values.data(), kCount, a, b);
+
+        RandomStream reference(kSeed);
+        for (size_t i = 0; i < kCount; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                const float expected = reference.Float(a[j], b[j]);
+                ASSERT_NEAR(values[i][j], expected, 1e-4f) << "index " << i;
+                ASSERT_GE(values[i][j], a[j]);
+                ASSERT_LE(values[i][j], b[j]);
+            }
+        }
+    }
+}
+
+TEST(RandomStreamTest, SplitAndDiscard)
+{
+    RandomStream stream(kSeed);
+    RandomStream other = stream.Split(1);
+    EXPECT_EQ(other.GetSeed(), kSeed);
+    EXPECT_EQ(other.GetStream(), 1u);
+
+    std::vector<uint32_t> values(kCount);
+    std::vector<uint32_t> otherValues(kCount);
+    stream.FillUInt32(values.data(), kCount);
+    other.FillUInt32(otherValues.data(), kCount);
+    EXPECT_NE(values, otherValues);
+
+    // Splitting again, from any position, restarts the same stream
+    std::vector<uint32_t> again(kCount);
+    stream.Split(1).FillUInt32(again.data(), kCount);
+    EXPECT_EQ(again, otherValues);
+
+    RandomStream skipped(kSeed);
+    skipped.Discard(kCount - 5);
+    EXPECT_EQ(skipped.GetPosition(), kCount - 5);
+    for (size_t i = kCount - 5; i < kCount; ++i) {
+        EXPECT_EQ(skipped.UInt32(), values[i]);
+    }
+}
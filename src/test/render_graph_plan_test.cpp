@@ -0,0 +1,250 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_render_graph_plan.h"
+
+using namespace ppx;
+using namespace ppx::grfx;
+
+namespace {
+
+const RenderGraphImageInfo kColorInfo = {1280, 720, FORMAT_R8G8B8A8_UNORM, SAMPLE_COUNT_1};
+const RenderGraphImageInfo kDepthInfo = {1280, 720, FORMAT_D32_FLOAT, SAMPLE_COUNT_1};
+const RenderGraphImageInfo kHalfInfo  = {640, 360, FORMAT_R8G8B8A8_UNORM, SAMPLE_COUNT_1};
+
+} // namespace
+
+TEST(RenderGraphPlanTest, AddAccessRejectsInvalidArguments)
+{
+    RenderGraphPlan plan;
+    uint32_t        image = plan.AddImage(kColorInfo);
+    uint32_t        pass  = plan.AddPass();
+
+    EXPECT_EQ(plan.AddAccess(pass + 1, image, RENDER_GRAPH_ACCESS_RENDER_TARGET), ERROR_OUT_OF_RANGE);
+    EXPECT_EQ(plan.AddAccess(pass, image + 1, RENDER_GRAPH_ACCESS_RENDER_TARGET), ERROR_OUT_OF_RANGE);
+    EXPECT_EQ(plan.AddAccess(pass, image, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    EXPECT_EQ(plan.AddAccess(pass, image, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), ERROR_DUPLICATE_ELEMENT);
+}
+
+TEST(RenderGraphPlanTest, CullsPassesWithUnusedOutputs)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        unused     = plan.AddImage(kColorInfo);
+    uint32_t        scene      = plan.AddImage(kColorInfo);
+
+    uint32_t debugPass = plan.AddPass();
+    uint32_t scenePass = plan.AddPass();
+    uint32_t blitPass  = plan.AddPass();
+    uint32_t queryPass = plan.AddPass(true);
+    ASSERT_EQ(plan.AddAccess(debugPass, unused, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(scenePass, scene, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(blitPass, scene, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(blitPass, backbuffer, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+    EXPECT_TRUE(plan.IsPassCulled(debugPass));
+    EXPECT_FALSE(plan.IsPassCulled(scenePass));
+    EXPECT_FALSE(plan.IsPassCulled(blitPass));
+    EXPECT_FALSE(plan.IsPassCulled(queryPass));
+    EXPECT_EQ(plan.GetExecutionOrder(), (std::vector<uint32_t>{scenePass, blitPass, queryPass}));
+
+    // Images only culled passes touch get no memory
+    EXPECT_EQ(plan.GetPhysicalImageIndex(unused), RenderGraphPlan::kInvalidIndex);
+    EXPECT_EQ(plan.GetPhysicalImageIndex(backbuffer), RenderGraphPlan::kInvalidIndex);
+    EXPECT_EQ(plan.GetPhysicalImageCount(), 1u);
+}
+
+TEST(RenderGraphPlanTest, CullingFollowsReadChains)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        a          = plan.AddImage(kColorInfo);
+    uint32_t        b          = plan.AddImage(kColorInfo);
+    uint32_t        c          = plan.AddImage(kColorInfo);
+
+    uint32_t p0 = plan.AddPass();
+    uint32_t p1 = plan.AddPass();
+    uint32_t p2 = plan.AddPass();
+    uint32_t p3 = plan.AddPass();
+    ASSERT_EQ(plan.AddAccess(p0, a, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, a, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, b, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, b, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, c, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, b, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, backbuffer, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+
+    // Nothing reads c so p2 goes, p0 and p1 feed the backbuffer through b
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+    EXPECT_EQ(plan.GetExecutionOrder(), (std::vector<uint32_t>{p0, p1, p3}));
+}
+
+TEST(RenderGraphPlanTest, AliasesDisjointLifetimes)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        a          = plan.AddImage(kColorInfo);
+    uint32_t        b          = plan.AddImage(kColorInfo);
+    uint32_t        c          = plan.AddImage(kColorInfo);
+    uint32_t        half       = plan.AddImage(kHalfInfo);
+
+    // a -> b -> c -> backbuffer, a and c never overlap, the half size image
+    // overlaps nothing but can't share with full size images.
+    uint32_t p0 = plan.AddPass();
+    uint32_t p1 = plan.AddPass();
+    uint32_t p2 = plan.AddPass();
+    uint32_t p3 = plan.AddPass();
+    ASSERT_EQ(plan.AddAccess(p0, a, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, a, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, b, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, b, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, c, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, c, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, half, RENDER_GRAPH_ACCESS_STORAGE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, backbuffer, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+    EXPECT_EQ(plan.GetPhysicalImageCount(), 3u);
+    EXPECT_EQ(plan.GetPhysicalImageIndex(a), plan.GetPhysicalImageIndex(c));
+    EXPECT_NE(plan.GetPhysicalImageIndex(a), plan.GetPhysicalImageIndex(b));
+    EXPECT_NE(plan.GetPhysicalImageIndex(half), plan.GetPhysicalImageIndex(a));
+    EXPECT_NE(plan.GetPhysicalImageIndex(half), plan.GetPhysicalImageIndex(b));
+    EXPECT_EQ(plan.GetPhysicalImageInfo(plan.GetPhysicalImageIndex(half)), kHalfInfo);
+
+    uint32_t sharedMask = plan.GetPhysicalImageAccessMask(plan.GetPhysicalImageIndex(a));
+    EXPECT_EQ(sharedMask, (1u << RENDER_GRAPH_ACCESS_RENDER_TARGET) | (1u << RENDER_GRAPH_ACCESS_SHADER_RESOURCE));
+
+    ASSERT_EQ(plan.Compile(false), SUCCESS);
+    EXPECT_EQ(plan.GetPhysicalImageCount(), 4u);
+    EXPECT_NE(plan.GetPhysicalImageIndex(a), plan.GetPhysicalImageIndex(c));
+}
+
+TEST(RenderGraphPlanTest, ReadBeforeWriteFails)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        history    = plan.ImportImage(kColorInfo, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNDEFINED);
+    uint32_t        scene      = plan.AddImage(kColorInfo);
+
+    // Imported images have defined contents, transient ones don't
+    uint32_t pass = plan.AddPass();
+    ASSERT_EQ(plan.AddAccess(pass, history, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(pass, backbuffer, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+
+    ASSERT_EQ(plan.AddAccess(pass, scene, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    EXPECT_EQ(plan.Compile(), ERROR_GRFX_RENDER_GRAPH_READ_BEFORE_WRITE);
+}
+
+TEST(RenderGraphPlanTest, EmitsTransitionsBetweenPasses)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        scene      = plan.AddImage(kColorInfo);
+    uint32_t        depth      = plan.AddImage(kDepthInfo);
+
+    uint32_t scenePass = plan.AddPass();
+    uint32_t blitPass  = plan.AddPass();
+    ASSERT_EQ(plan.AddAccess(scenePass, scene, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(scenePass, depth, RENDER_GRAPH_ACCESS_DEPTH_STENCIL_WRITE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(blitPass, scene, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(blitPass, depth, RENDER_GRAPH_ACCESS_DEPTH_STENCIL_READ), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(blitPass, backbuffer, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+
+    // Physical images rest in their last state, so the first pass moves them
+    // back to where it needs them.
+    uint32_t scenePhysical = plan.GetPhysicalImageIndex(scene);
+    uint32_t depthPhysical = plan.GetPhysicalImageIndex(depth);
+    EXPECT_EQ(plan.GetPhysicalImageInitialState(scenePhysical), RESOURCE_STATE_SHADER_RESOURCE);
+    EXPECT_EQ(plan.GetPhysicalImageInitialState(depthPhysical), RESOURCE_STATE_DEPTH_STENCIL_READ);
+
+    const std::vector<RenderGraphPlan::Barrier>& sceneBarriers = plan.GetPassBarriers(scenePass);
+    ASSERT_EQ(sceneBarriers.size(), 2u);
+    EXPECT_EQ(sceneBarriers[0].image, scene);
+    EXPECT_EQ(sceneBarriers[0].beforeState, RESOURCE_STATE_SHADER_RESOURCE);
+    EXPECT_EQ(sceneBarriers[0].afterState, RESOURCE_STATE_RENDER_TARGET);
+    EXPECT_EQ(sceneBarriers[1].image, depth);
+    EXPECT_EQ(sceneBarriers[1].beforeState, RESOURCE_STATE_DEPTH_STENCIL_READ);
+    EXPECT_EQ(sceneBarriers[1].afterState, RESOURCE_STATE_DEPTH_STENCIL_WRITE);
+
+    const std::vector<RenderGraphPlan::Barrier>& blitBarriers = plan.GetPassBarriers(blitPass);
+    ASSERT_EQ(blitBarriers.size(), 3u);
+    EXPECT_EQ(blitBarriers[0].afterState, RESOURCE_STATE_SHADER_RESOURCE);
+    EXPECT_EQ(blitBarriers[1].afterState, RESOURCE_STATE_DEPTH_STENCIL_READ);
+    EXPECT_EQ(blitBarriers[2].image, backbuffer);
+    EXPECT_EQ(blitBarriers[2].beforeState, RESOURCE_STATE_PRESENT);
+    EXPECT_EQ(blitBarriers[2].afterState, RESOURCE_STATE_RENDER_TARGET);
+
+    const std::vector<RenderGraphPlan::Barrier>& finalBarriers = plan.GetFinalBarriers();
+    ASSERT_EQ(finalBarriers.size(), 1u);
+    EXPECT_EQ(finalBarriers[0].image, backbuffer);
+    EXPECT_EQ(finalBarriers[0].beforeState, RESOURCE_STATE_RENDER_TARGET);
+    EXPECT_EQ(finalBarriers[0].afterState, RESOURCE_STATE_PRESENT);
+}
+
+TEST(RenderGraphPlanTest, AliasedImagesShareStateTracking)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_PRESENT, RESOURCE_STATE_PRESENT);
+    uint32_t        a          = plan.AddImage(kColorInfo);
+    uint32_t        b          = plan.AddImage(kColorInfo);
+    uint32_t        c          = plan.AddImage(kColorInfo);
+
+    uint32_t p0 = plan.AddPass();
+    uint32_t p1 = plan.AddPass();
+    uint32_t p2 = plan.AddPass();
+    uint32_t p3 = plan.AddPass();
+    ASSERT_EQ(plan.AddAccess(p0, a, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, a, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p1, b, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, b, RENDER_GRAPH_ACCESS_SHADER_RESOURCE), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p2, c, RENDER_GRAPH_ACCESS_RENDER_TARGET), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, c, RENDER_GRAPH_ACCESS_COPY_SRC), SUCCESS);
+    ASSERT_EQ(plan.AddAccess(p3, backbuffer, RENDER_GRAPH_ACCESS_COPY_DST), SUCCESS);
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+    ASSERT_NE(plan.GetPhysicalImageIndex(c), RenderGraphPlan::kInvalidIndex);
+    ASSERT_EQ(plan.GetPhysicalImageIndex(a), plan.GetPhysicalImageIndex(c));
+
+    // c picks up where a left off in p1
+    const std::vector<RenderGraphPlan::Barrier>& barriers = plan.GetPassBarriers(p2);
+    auto                                         it       = std::find_if(barriers.begin(), barriers.end(), [c](const auto& elem) { return elem.image == c; });
+    ASSERT_NE(it, barriers.end());
+    EXPECT_EQ(it->beforeState, RESOURCE_STATE_SHADER_RESOURCE);
+    EXPECT_EQ(it->afterState, RESOURCE_STATE_RENDER_TARGET);
+
+    // The shared image rests in c's last state, a's first barrier starts there
+    const std::vector<RenderGraphPlan::Barrier>& firstBarriers = plan.GetPassBarriers(p0);
+    ASSERT_EQ(firstBarriers.size(), 1u);
+    EXPECT_EQ(firstBarriers[0].beforeState, RESOURCE_STATE_COPY_SRC);
+    EXPECT_EQ(firstBarriers[0].afterState, RESOURCE_STATE_RENDER_TARGET);
+}
+
+TEST(RenderGraphPlanTest, FinalBarriersForUntouchedImports)
+{
+    RenderGraphPlan plan;
+    uint32_t        backbuffer = plan.ImportImage(kColorInfo, RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PRESENT);
+    uint32_t        history    = plan.ImportImage(kColorInfo, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNDEFINED);
+
+    ASSERT_EQ(plan.Compile(), SUCCESS);
+    EXPECT_TRUE(plan.GetExecutionOrder().empty());
+
+    const std::vector<RenderGraphPlan::Barrier>& finalBarriers = plan.GetFinalBarriers();
+    ASSERT_EQ(finalBarriers.size(), 1u);
+    EXPECT_EQ(finalBarriers[0].image, backbuffer);
+    EXPECT_NE(finalBarriers[0].image, history);
+}
@@ -0,0 +1,426 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/grfx/grfx_shader_reflection.h"
+
+#include <cstring>
+#include <initializer_list>
+
+using namespace ppx;
+
+namespace {
+
+// Enough of a SPIR-V assembler to write the modules DXC produces for small
+// HLSL shaders. Ids are allocated by the caller.
+class SpirvBuilder
+{
+public:
+    SpirvBuilder() { mWords = {0x07230203, 0x00010300, 0, 100, 0}; }
+
+    void Op(uint32_t opcode, std::initializer_list<uint32_t> operands)
+    {
+        mWords.push_back((static_cast<uint32_t>(operands.size() + 1) << 16) | opcode);
+        mWords.insert(mWords.end(), operands);
+    }
+
+    // Operands followed by a literal string.
+    void Op(uint32_t opcode, std::initializer_list<uint32_t> operands, const std::string& string)
+    {
+        std::vector<uint32_t> words(operands);
+        std::vector<uint32_t> stringWords(string.size() / 4 + 1, 0);
+        memcpy(stringWords.data(), string.data(), string.size());
+        words.insert(words.end(), stringWords.begin(), stringWords.end());
+
+        mWords.push_back((static_cast<uint32_t>(words.size() + 1) << 16) | opcode);
+        mWords.insert(mWords.end(), words.begin(), words.end());
+    }
+
+    Result Reflect(grfx::ShaderReflection* pReflection) const
+    {
+        return grfx::ReflectSpirv(mWords.data(), mWords.size() * sizeof(uint32_t), pReflection);
+    }
+
+    const std::vector<uint32_t>& GetWords() const { return mWords; }
+
+private:
+    std::vector<uint32_t> mWords;
+};
+
+// Opcodes
+const uint32_t OpName             = 5;
+const uint32_t OpEntryPoint       = 15;
+const uint32_t OpExecutionMode    = 16;
+const uint32_t OpTypeInt          = 21;
+const uint32_t OpTypeFloat        = 22;
+const uint32_t OpTypeVector       = 23;
+const uint32_t OpTypeMatrix       = 24;
+const uint32_t OpTypeImage        = 25;
+const uint32_t OpTypeSampler      = 26;
+const uint32_t OpTypeArray        = 28;
+const uint32_t OpTypeRuntimeArray = 29;
+const uint32_t OpTypeStruct       = 30;
+const uint32_t OpTypePointer      = 32;
+const uint32_t OpConstant         = 43;
+const uint32_t OpVariable         = 59;
+const uint32_t OpDecorate         = 71;
+const uint32_t OpMemberDecorate   = 72;
+const uint32_t OpDecorateString   = 5632;
+
+// Operands
+const uint32_t kVertex           = 0;
+const uint32_t kFragment         = 4;
+const uint32_t kGLCompute        = 5;
+const uint32_t kLocalSize        = 17;
+const uint32_t kUniformConstant  = 0;
+const uint32_t kInput            = 1;
+const uint32_t kUniform          = 2;
+const uint32_t kPushConstant     = 9;
+const uint32_t kBlock            = 2;
+const uint32_t kBufferBlock      = 3;
+const uint32_t kMatrixStride     = 7;
+const uint32_t kBuiltIn          = 11;
+const uint32_t kNonWritable      = 24;
+const uint32_t kLocation         = 30;
+const uint32_t kBinding          = 33;
+const uint32_t kDescriptorSet    = 34;
+const uint32_t kOffset           = 35;
+const uint32_t kUserSemantic     = 5635;
+const uint32_t kDim2D            = 1;
+const uint32_t kDimBuffer        = 5;
+const uint32_t kVertexIndex      = 42;
+const uint32_t kImageFormatRgba8 = 4;
+
+// Scalar and vector types shared by the modules below
+enum TypeId : uint32_t
+{
+    kFloat = 1,
+    kUint  = 2,
+    kInt   = 3,
+    kFloat2,
+    kFloat3,
+    kFloat4,
+    kUint4,
+    kFirstFreeId,
+};
+
+void AddBaseTypes(SpirvBuilder* pBuilder)
+{
+    pBuilder->Op(OpTypeFloat, {kFloat, 32});
+    pBuilder->Op(OpTypeInt, {kUint, 32, 0});
+    pBuilder->Op(OpTypeInt, {kInt, 32, 1});
+    pBuilder->Op(OpTypeVector, {kFloat2, kFloat, 2});
+    pBuilder->Op(OpTypeVector, {kFloat3, kFloat, 3});
+    pBuilder->Op(OpTypeVector, {kFloat4, kFloat, 4});
+    pBuilder->Op(OpTypeVector, {kUint4, kUint, 4});
+}
+
+// cbuffer at (set, binding), Texture2D and SamplerState at the next two
+// bindings if withTexture is set.
+void AddMaterialResources(SpirvBuilder* pBuilder, uint32_t set, uint32_t binding, bool withTexture, uint32_t* pNextId)
+{
+    const uint32_t cbStruct   = (*pNextId)++;
+    const uint32_t cbPointer  = (*pNextId)++;
+    const uint32_t cbVariable = (*pNextId)++;
+    pBuilder->Op(OpName, {cbVariable}, "Material");
+    pBuilder->Op(OpDecorate, {cbStruct, kBlock});
+    pBuilder->Op(OpMemberDecorate, {cbStruct, 0, kOffset, 0});
+    pBuilder->Op(OpDecorate, {cbVariable, kDescriptorSet, set});
+    pBuilder->Op(OpDecorate, {cbVariable, kBinding, binding});
+    pBuilder->Op(OpTypeStruct, {cbStruct, kFloat4});
+    pBuilder->Op(OpTypePointer, {cbPointer, kUniform, cbStruct});
+    pBuilder->Op(OpVariable, {cbPointer, cbVariable, kUniform});
+
+    if (withTexture) {
+        const uint32_t image           = (*pNextId)++;
+        const uint32_t imagePointer    = (*pNextId)++;
+        const uint32_t texture         = (*pNextId)++;
+        const uint32_t sampler         = (*pNextId)++;
+        const uint32_t samplerPointer  = (*pNextId)++;
+        const uint32_t samplerVariable = (*pNextId)++;
+        pBuilder->Op(OpDecorate, {texture, kDescriptorSet, set});
+        pBuilder->Op(OpDecorate, {texture, kBinding, binding + 1});
+        pBuilder->Op(OpDecorate, {samplerVariable, kDescriptorSet, set});
+        pBuilder->Op(OpDecorate, {samplerVariable, kBinding, binding + 2});
+        pBuilder->Op(OpTypeImage, {image, kFloat, kDim2D, 2, 0, 0, 1, 0});
+        pBuilder->Op(OpTypePointer, {imagePointer, kUniformConstant, image});
+        pBuilder->Op(OpVariable, {imagePointer, texture, kUniformConstant});
+        pBuilder->Op(OpTypeSampler, {sampler});
+        pBuilder->Op(OpTypePointer, {samplerPointer, kUniformConstant, sampler});
+        pBuilder->Op(OpVariable, {samplerPointer, samplerVariable, kUniformConstant});
+    }
+}
+
+SpirvBuilder BuildVertexShader()
+{
+    SpirvBuilder builder;
+    uint32_t     nextId = kFirstFreeId;
+
+    const uint32_t main = nextId++;
+    builder.Op(OpEntryPoint, {kVertex, main}, "vsmain");
+    AddBaseTypes(&builder);
+
+    // POSITION, TEXCOORD, a uint4 input with a UserSemantic decoration and
+    // SV_VertexID, which is not a vertex input
+    const uint32_t inputTypes[] = {kFloat3, kFloat2, kUint4, kUint};
+    const char*    names[]      = {"in.var.POSITION", "in.var.TEXCOORD", "in.var.BLENDINDICES", "gl_VertexIndex"};
+    for (uint32_t i = 0; i < 4; ++i) {
+        const uint32_t pointer  = nextId++;
+        const uint32_t variable = nextId++;
+        builder.Op(OpName, {variable}, names[i]);
+        if (i == 3) {
+            builder.Op(OpDecorate, {variable, kBuiltIn, kVertexIndex});
+        }
+        else {
+            // Declared out of location order
+            builder.Op(OpDecorate, {variable, kLocation, 2 - i});
+        }
+        if (i == 2) {
+            builder.Op(OpDecorateString, {variable, kUserSemantic}, "BONES");
+        }
+        builder.Op(OpTypePointer, {pointer, kInput, inputTypes[i]});
+        builder.Op(OpVariable, {pointer, variable, kInput});
+    }
+
+    AddMaterialResources(&builder, 0, 0, false, &nextId);
+    return builder;
+}
+
+SpirvBuilder BuildPixelShader(uint32_t materialSet)
+{
+    SpirvBuilder builder;
+    uint32_t     nextId = kFirstFreeId;
+
+    const uint32_t main = nextId++;
+    builder.Op(OpEntryPoint, {kFragment, main}, "psmain");
+    AddBaseTypes(&builder);
+    AddMaterialResources(&builder, materialSet, 0, true, &nextId);
+    return builder;
+}
+
+} // namespace
+
+TEST(ShaderReflectionTest, RejectsNonSpirv)
+{
+    const char             dxil[32] = "DXBC";
+    grfx::ShaderReflection reflection;
+    EXPECT_FALSE(grfx::IsSpirv(dxil, sizeof(dxil)));
+    EXPECT_EQ(grfx::ReflectSpirv(dxil, sizeof(dxil), &reflection), ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE);
+
+    // Instruction running past the end of the module
+    SpirvBuilder builder;
+    builder.Op(OpName, {1}, "x");
+    std::vector<uint32_t> words = builder.GetWords();
+    words.pop_back();
+    EXPECT_EQ(grfx::ReflectSpirv(words.data(), words.size() * sizeof(uint32_t), &reflection), ppx::ERROR_GRFX_INVALID_SHADER_BYTE_CODE);
+}
+
+TEST(ShaderReflectionTest, ComputeShader)
+{
+    SpirvBuilder builder;
+    uint32_t     nextId = kFirstFreeId;
+
+    const uint32_t main = nextId++;
+    builder.Op(OpEntryPoint, {kGLCompute, main}, "csmain");
+    builder.Op(OpExecutionMode, {main, kLocalSize, 8, 4, 1});
+
+    const uint32_t storageImage        = nextId++;
+    const uint32_t storageImagePointer = nextId++;
+    const uint32_t output              = nextId++;
+    const uint32_t texelBuffer         = nextId++;
+    const uint32_t texelBufferPointer  = nextId++;
+    const uint32_t input               = nextId++;
+    const uint32_t sampler             = nextId++;
+    const uint32_t four                = nextId++;
+    const uint32_t samplerArray        = nextId++;
+    const uint32_t samplerPointer      = nextId++;
+    const uint32_t samplers            = nextId++;
+    const uint32_t runtimeArray        = nextId++;
+    const uint32_t structured          = nextId++;
+    const uint32_t structuredPointer   = nextId++;
+    const uint32_t particles           = nextId++;
+    const uint32_t raw                 = nextId++;
+    const uint32_t rawPointer          = nextId++;
+    const uint32_t counters            = nextId++;
+    const uint32_t float4x4            = nextId++;
+    const uint32_t pushStruct          = nextId++;
+    const uint32_t pushPointer         = nextId++;
+    const uint32_t pushVariable        = nextId++;
+
+    builder.Op(OpName, {output}, "Output");
+    builder.Op(OpName, {particles}, "Particles");
+    builder.Op(OpName, {structured}, "type.StructuredBuffer.float");
+    builder.Op(OpName, {raw}, "type.RWByteAddressBuffer");
+    builder.Op(OpDecorate, {output, kDescriptorSet, 0});
+    builder.Op(OpDecorate, {output, kBinding, 0});
+    builder.Op(OpDecorate, {samplers, kDescriptorSet, 0});
+    builder.Op(OpDecorate, {samplers, kBinding, 1});
+    builder.Op(OpDecorate, {input, kDescriptorSet, 0});
+    builder.Op(OpDecorate, {input, kBinding, 5});
+    builder.Op(OpDecorate, {counters, kDescriptorSet, 1});
+    builder.Op(OpDecorate, {counters, kBinding, 3});
+    builder.Op(OpDecorate, {particles, kDescriptorSet, 1});
+    builder.Op(OpDecorate, {particles, kBinding, 2});
+    builder.Op(OpDecorate, {structured, kBufferBlock});
+    builder.Op(OpMemberDecorate, {structured, 0, kOffset, 0});
+    builder.Op(OpMemberDecorate, {structured, 0, kNonWritable});
+    builder.Op(OpDecorate, {raw, kBufferBlock});
+    builder.Op(OpMemberDecorate, {raw, 0, kOffset, 0});
+    builder.Op(OpDecorate, {pushStruct, kBlock});
+    builder.Op(OpMemberDecorate, {pushStruct, 0, kOffset, 0});
+    builder.Op(OpMemberDecorate, {pushStruct, 0, kMatrixStride, 16});
+    builder.Op(OpMemberDecorate, {pushStruct, 1, kOffset, 64});
+
+    AddBaseTypes(&builder);
+    builder.Op(OpTypeImage, {storageImage, kFloat, kDim2D, 0, 0, 0, 2, kImageFormatRgba8});
+    builder.Op(OpTypePointer, {storageImagePointer, kUniformConstant, storageImage});
+    builder.Op(OpVariable, {storageImagePointer, output, kUniformConstant});
+    builder.Op(OpTypeImage, {texelBuffer, kFloat, kDimBuffer, 2, 0, 0, 1, 0});
+    builder.Op(OpTypePointer, {texelBufferPointer, kUniformConstant, texelBuffer});
+    builder.Op(OpVariable, {texelBufferPointer, input, kUniformConstant});
+    builder.Op(OpTypeSampler, {sampler});
+    builder.Op(OpConstant, {kUint, four, 4});
+    builder.Op(OpTypeArray, {samplerArray, sampler, four});
+    builder.Op(OpTypePointer, {samplerPointer, kUniformConstant, samplerArray});
+    builder.Op(OpVariable, {samplerPointer, samplers, kUniformConstant});
+    builder.Op(OpTypeRuntimeArray, {runtimeArray, kUint});
+    builder.Op(OpTypeStruct, {structured, runtimeArray});
+    builder.Op(OpTypePointer, {structuredPointer, kUniform, structured});
+    builder.Op(OpVariable, {structuredPointer, particles, kUniform});
+    builder.Op(OpTypeStruct, {raw, runtimeArray});
+    builder.Op(OpTypePointer, {rawPointer, kUniform, raw});
+    builder.Op(OpVariable, {rawPointer, counters, kUniform});
+    builder.Op(OpTypeMatrix, {float4x4, kFloat4, 4});
+    builder.Op(OpTypeStruct, {pushStruct, float4x4, kFloat});
+    builder.Op(OpTypePointer, {pushPointer, kPushConstant, pushStruct});
+    builder.Op(OpVariable, {pushPointer, pushVariable, kPushConstant});
+
+    grfx::ShaderReflection reflection;
+    ASSERT_EQ(builder.Reflect(&reflection), ppx::SUCCESS);
+    EXPECT_EQ(reflection.stage, grfx::SHADER_STAGE_CS);
+    EXPECT_EQ(reflection.entryPoint, "csmain");
+    EXPECT_EQ(reflection.workgroupSize[0], 8u);
+    EXPECT_EQ(reflection.workgroupSize[1], 4u);
+    EXPECT_EQ(reflection.workgroupSize[2], 1u);
+    EXPECT_EQ(reflection.pushConstantSize, 68u);
+    EXPECT_TRUE(reflection.vertexInputs.empty());
+
+    struct Expected
+    {
+        uint32_t             set;
+        uint32_t             binding;
+        grfx::DescriptorType type;
+        uint32_t             arrayCount;
+    };
+    const Expected expected[] = {
+        {0, 0, grfx::DESCRIPTOR_TYPE_STORAGE_IMAGE, 1},
+        {0, 1, grfx::DESCRIPTOR_TYPE_SAMPLER, 4},
+        {0, 5, grfx::DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1},
+        {1, 2, grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER, 1},
+        {1, 3, grfx::DESCRIPTOR_TYPE_RAW_STORAGE_BUFFER, 1},
+    };
+    ASSERT_EQ(reflection.bindings.size(), 5u);
+    for (size_t i = 0; i < reflection.bindings.size(); ++i) {
+        SCOPED_TRACE(i);
+        EXPECT_EQ(reflection.bindings[i].set, expected[i].set);
+        EXPECT_EQ(reflection.bindings[i].binding, expected[i].binding);
+        EXPECT_EQ(reflection.bindings[i].type, expected[i].type);
+        EXPECT_EQ(reflection.bindings[i].arrayCount, expected[i].arrayCount);
+        EXPECT_EQ(reflection.bindings[i].stage, grfx::SHADER_STAGE_CS);
+    }
+    EXPECT_EQ(reflection.bindings[0].name, "Output");
+    EXPECT_EQ(reflection.bindings[3].name, "Particles");
+}
+
+TEST(ShaderReflectionTest, VertexInputs)
+{
+    grfx::ShaderReflection reflection;
+    ASSERT_EQ(BuildVertexShader().Reflect(&reflection), ppx::SUCCESS);
+    EXPECT_EQ(reflection.stage, grfx::SHADER_STAGE_VS);
+    EXPECT_EQ(reflection.entryPoint, "vsmain");
+
+    ASSERT_EQ(reflection.vertexInputs.size(), 3u);
+    EXPECT_EQ(reflection.vertexInputs[0].location, 0u);
+    EXPECT_EQ(reflection.vertexInputs[0].semanticName, "BONES");
+    EXPECT_EQ(reflection.vertexInputs[0].format, grfx::FORMAT_R32G32B32A32_UINT);
+    EXPECT_EQ(reflection.vertexInputs[1].location, 1u);
+    EXPECT_EQ(reflection.vertexInputs[1].semanticName, "TEXCOORD");
+    EXPECT_EQ(reflection.vertexInputs[1].format, grfx::FORMAT_R32G32_FLOAT);
+    EXPECT_EQ(reflection.vertexInputs[2].location, 2u);
+    EXPECT_EQ(reflection.vertexInputs[2].semanticName, "POSITION");
+    EXPECT_EQ(reflection.vertexInputs[2].format, grfx::FORMAT_R32G32B32_FLOAT);
+
+    ASSERT_EQ(reflection.bindings.size(), 1u);
+    EXPECT_EQ(reflection.bindings[0].type, grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+}
+
+TEST(ShaderReflectionTest, BuildInterfaceLayout)
+{
+    grfx::ShaderReflection vs;
+    grfx::ShaderReflection ps;
+    ASSERT_EQ(BuildVertexShader().Reflect(&vs), ppx::SUCCESS);
+    ASSERT_EQ(BuildPixelShader(0).Reflect(&ps), ppx::SUCCESS);
+
+    // The constant buffer is shared, the texture and sampler are pixel
+    // shader only
+    const grfx::ShaderReflection* stages[] = {&vs, &ps};
+    grfx::ShaderInterfaceLayout   layout;
+    ASSERT_EQ(grfx::BuildShaderInterfaceLayout(2, stages, &layout), ppx::SUCCESS);
+    ASSERT_EQ(layout.setNumbers, std::vector<uint32_t>{0});
+    ASSERT_EQ(layout.setLayouts.size(), 1u);
+
+    const std::vector<grfx::DescriptorBinding>& bindings = layout.setLayouts[0].bindings;
+    ASSERT_EQ(bindings.size(), 3u);
+    EXPECT_EQ(bindings[0].binding, 0u);
+    EXPECT_EQ(bindings[0].type, grfx::DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+    EXPECT_EQ(bindings[0].shaderVisiblity, grfx::SHADER_STAGE_ALL);
+    EXPECT_EQ(bindings[1].binding, 1u);
+    EXPECT_EQ(bindings[1].type, grfx::DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+    EXPECT_EQ(bindings[1].shaderVisiblity, grfx::SHADER_STAGE_PS);
+    EXPECT_EQ(bindings[2].binding, 2u);
+    EXPECT_EQ(bindings[2].type, grfx::DESCRIPTOR_TYPE_SAMPLER);
+    EXPECT_EQ(bindings[2].shaderVisiblity, grfx::SHADER_STAGE_PS);
+
+    // Same resources in set 2 for the pixel shader
+    ASSERT_EQ(BuildPixelShader(2).Reflect(&ps), ppx::SUCCESS);
+    ASSERT_EQ(grfx::BuildShaderInterfaceLayout(2, stages, &layout), ppx::SUCCESS);
+    ASSERT_EQ(layout.setNumbers, (std::vector<uint32_t>{0, 2}));
+    EXPECT_EQ(layout.setLayouts[0].bindings.size(), 1u);
+    EXPECT_EQ(layout.setLayouts[0].bindings[0].shaderVisiblity, grfx::SHADER_STAGE_VS);
+    EXPECT_EQ(layout.setLayouts[1].bindings.size(), 3u);
+
+    // Stages disagreeing on a binding
+    ps.bindings[0].set  = 0;
+    ps.bindings[0].type = grfx::DESCRIPTOR_TYPE_RO_STRUCTURED_BUFFER;
+    EXPECT_EQ(grfx::BuildShaderInterfaceLayout(2, stages, &layout), ppx::ERROR_GRFX_INVALID_DESCRIPTOR_TYPE);
+}
+
+TEST(ShaderReflectionTest, Cache)
+{
+    const SpirvBuilder builder = BuildPixelShader(0);
+
+    std::shared_ptr<const grfx::ShaderReflection> first;
+    std::shared_ptr<const grfx::ShaderReflection> second;
+    ASSERT_EQ(grfx::GetCachedShaderReflection(builder.GetWords().data(), builder.GetWords().size() * sizeof(uint32_t), &first), ppx::SUCCESS);
+    ASSERT_EQ(grfx::GetCachedShaderReflection(builder.GetWords().data(), builder.GetWords().size() * sizeof(uint32_t), &second), ppx::SUCCESS);
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(first->bindings.size(), 3u);
+
+    std::shared_ptr<const grfx::ShaderReflection> other;
+    const SpirvBuilder                            otherBuilder = BuildPixelShader(1);
+    ASSERT_EQ(grfx::GetCachedShaderReflection(otherBuilder.GetWords().data(), otherBuilder.GetWords().size() * sizeof(uint32_t), &other), ppx::SUCCESS);
+    EXPECT_NE(other.get(), first.get());
+    EXPECT_EQ(other->bindings[0].set, 1u);
+}
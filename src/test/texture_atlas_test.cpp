@@ -0,0 +1,206 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/texture_atlas.h"
+
+using namespace ppx;
+
+namespace {
+
+TextureAtlasCreateInfo MakeCreateInfo(uint32_t size, uint32_t padding, uint32_t alignment, uint32_t maxLayerCount)
+{
+    TextureAtlasCreateInfo createInfo = {};
+    createInfo.width                  = size;
+    createInfo.height                 = size;
+    createInfo.format                 = Bitmap::FORMAT_R_UINT8;
+    createInfo.padding                = padding;
+    createInfo.alignment              = alignment;
+    createInfo.maxLayerCount          = maxLayerCount;
+    return createInfo;
+}
+
+Bitmap CreateSolid(uint32_t width, uint32_t height, uint8_t value)
+{
+    Bitmap bitmap = Bitmap::Create(width, height, Bitmap::FORMAT_R_UINT8);
+    bitmap.Fill<uint8_t>(value, 0, 0, 0);
+    return bitmap;
+}
+
+// Adds bitmaps of pseudo-random sizes, each filled with (index % 255 + 1).
+void AddRandomBitmaps(TextureAtlas* pAtlas, uint32_t count, uint32_t maxSize)
+{
+    uint32_t seed = 0x9E3779B9;
+    for (uint32_t i = 0; i < count; ++i) {
+        seed            = seed * 1664525 + 1013904223;
+        uint32_t width  = 1 + (seed >> 8) % maxSize;
+        uint32_t height = 1 + (seed >> 20) % maxSize;
+
+        Bitmap   bitmap = CreateSolid(width, height, static_cast<uint8_t>(i % 255 + 1));
+        uint32_t index  = UINT32_MAX;
+        ASSERT_EQ(pAtlas->AddBitmap(&bitmap, &index), SUCCESS);
+        EXPECT_EQ(index, i);
+    }
+}
+
+// Checks that every entry and its gutter hold the entry's value and that no two
+// entries overlap.
+void ExpectEntriesDisjoint(const TextureAtlas& atlas)
+{
+    const TextureAtlasCreateInfo& createInfo = atlas.GetCreateInfo();
+    const uint32_t                padding    = createInfo.padding;
+    for (uint32_t layer = 0; layer < atlas.GetLayerCount(); ++layer) {
+        std::vector<uint32_t> owner(createInfo.width * createInfo.height, UINT32_MAX);
+        for (uint32_t i = 0; i < atlas.GetEntryCount(); ++i) {
+            const TextureAtlas::Entry& entry = atlas.GetEntry(i);
+            if (entry.layer != layer) {
+                continue;
+            }
+            EXPECT_EQ((entry.x - padding) % createInfo.alignment, 0u);
+            EXPECT_EQ((entry.y - padding) % createInfo.alignment, 0u);
+            ASSERT_LE(entry.x + entry.width + padding, createInfo.width);
+            ASSERT_LE(entry.y + entry.height + padding, createInfo.height);
+
+            for (uint32_t y = entry.y - padding; y < entry.y + entry.height + padding; ++y) {
+                for (uint32_t x = entry.x - padding; x < entry.x + entry.width + padding; ++x) {
+                    ASSERT_EQ(owner[y * createInfo.width + x], UINT32_MAX) << "entries " << i << " and " << owner[y * createInfo.width + x] << " overlap";
+                    owner[y * createInfo.width + x] = i;
+                    EXPECT_EQ(atlas.GetLayer(layer)->GetPixel8u(x, y)[0], i % 255 + 1);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(TextureAtlasTest, CreateRejectsMisalignedSize)
+{
+    TextureAtlas atlas;
+    EXPECT_EQ(TextureAtlas::Create(MakeCreateInfo(100, 1, 8, 1), &atlas), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(TextureAtlas::Create(MakeCreateInfo(128, 1, 0, 1), &atlas), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(TextureAtlas::Create(MakeCreateInfo(128, 1, 8, 1), &atlas), SUCCESS);
+}
+
+TEST(TextureAtlasTest, AddBitmapRejectsOversizedBitmap)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(64, 1, 1, 1), &atlas), SUCCESS);
+    Bitmap tooWide = CreateSolid(63, 8, 1);
+    Bitmap fits    = CreateSolid(62, 8, 1);
+    EXPECT_EQ(atlas.AddBitmap(&tooWide, nullptr), ERROR_LIMIT_EXCEEDED);
+    EXPECT_EQ(atlas.AddBitmap(&fits, nullptr), SUCCESS);
+}
+
+TEST(TextureAtlasTest, AddBitmapRejectsEmptyBitmap)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(64, 1, 1, 1), &atlas), SUCCESS);
+    Bitmap empty;
+    EXPECT_EQ(atlas.AddBitmap(&empty, nullptr), ERROR_BITMAP_BAD_COPY_SOURCE);
+    EXPECT_EQ(atlas.Build(), SUCCESS);
+    EXPECT_EQ(atlas.GetEntryCount(), 0u);
+}
+
+TEST(TextureAtlasTest, UVTransformMapsToEntry)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(64, 2, 1, 1), &atlas), SUCCESS);
+    Bitmap   bitmap = CreateSolid(16, 8, 7);
+    uint32_t index  = UINT32_MAX;
+    ASSERT_EQ(atlas.AddBitmap(&bitmap, &index), SUCCESS);
+    ASSERT_EQ(atlas.Build(), SUCCESS);
+
+    const TextureAtlas::Entry& entry = atlas.GetEntry(index);
+    EXPECT_EQ(entry.layer, 0u);
+    EXPECT_EQ(entry.x, 2u);
+    EXPECT_EQ(entry.y, 2u);
+    EXPECT_FLOAT_EQ(entry.uvTransform.x, 16.0f / 64.0f);
+    EXPECT_FLOAT_EQ(entry.uvTransform.y, 8.0f / 64.0f);
+    EXPECT_FLOAT_EQ(entry.uvTransform.z, 2.0f / 64.0f);
+    EXPECT_FLOAT_EQ(entry.uvTransform.w, 2.0f / 64.0f);
+}
+
+TEST(TextureAtlasTest, GutterReplicatesEdges)
+{
+    Bitmap bitmap = Bitmap::Create(2, 2, Bitmap::FORMAT_R_UINT8);
+    bitmap.GetPixel8u(0, 0)[0] = 1;
+    bitmap.GetPixel8u(1, 0)[0] = 2;
+    bitmap.GetPixel8u(0, 1)[0] = 3;
+    bitmap.GetPixel8u(1, 1)[0] = 4;
+
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(16, 2, 1, 1), &atlas), SUCCESS);
+    ASSERT_EQ(atlas.AddBitmap(&bitmap, nullptr), SUCCESS);
+    ASSERT_EQ(atlas.Build(), SUCCESS);
+
+    const Bitmap* pLayer = atlas.GetLayer(0);
+    // Corners of the 6x6 padded cell repeat the corners of the bitmap
+    EXPECT_EQ(pLayer->GetPixel8u(0, 0)[0], 1);
+    EXPECT_EQ(pLayer->GetPixel8u(5, 0)[0], 2);
+    EXPECT_EQ(pLayer->GetPixel8u(0, 5)[0], 3);
+    EXPECT_EQ(pLayer->GetPixel8u(5, 5)[0], 4);
+    // Outside the cell stays clear
+    EXPECT_EQ(pLayer->GetPixel8u(6, 0)[0], 0);
+    EXPECT_EQ(pLayer->GetPixel8u(0, 6)[0], 0);
+}
+
+TEST(TextureAtlasTest, PacksWithoutOverlap)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(256, 1, 1, 8), &atlas), SUCCESS);
+    AddRandomBitmaps(&atlas, 300, 40);
+    ASSERT_EQ(atlas.Build(), SUCCESS);
+    EXPECT_EQ(atlas.GetEntryCount(), 300u);
+    EXPECT_GT(atlas.GetOccupancy(), 0.5f);
+    ExpectEntriesDisjoint(atlas);
+}
+
+TEST(TextureAtlasTest, PacksWithMipAlignment)
+{
+    const uint32_t mipPadding = TextureAtlas::CalculateMipPadding(3);
+    EXPECT_EQ(mipPadding, 4u);
+
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(256, mipPadding, mipPadding, 8), &atlas), SUCCESS);
+    AddRandomBitmaps(&atlas, 200, 40);
+    ASSERT_EQ(atlas.Build(), SUCCESS);
+    ExpectEntriesDisjoint(atlas);
+}
+
+TEST(TextureAtlasTest, BuildFailsWhenLayersRunOut)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(32, 0, 1, 2), &atlas), SUCCESS);
+    Bitmap bitmap = CreateSolid(32, 32, 1);
+    for (uint32_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(atlas.AddBitmap(&bitmap, nullptr), SUCCESS);
+    }
+    EXPECT_EQ(atlas.Build(), ERROR_LIMIT_EXCEEDED);
+}
+
+TEST(TextureAtlasTest, FullLayerStartsNewLayer)
+{
+    TextureAtlas atlas;
+    ASSERT_EQ(TextureAtlas::Create(MakeCreateInfo(32, 0, 1, 2), &atlas), SUCCESS);
+    Bitmap big  = CreateSolid(32, 32, 1);
+    Bitmap tiny = CreateSolid(16, 16, 2);
+    ASSERT_EQ(atlas.AddBitmap(&big, nullptr), SUCCESS);
+    ASSERT_EQ(atlas.AddBitmap(&tiny, nullptr), SUCCESS);
+    ASSERT_EQ(atlas.Build(), SUCCESS);
+    EXPECT_EQ(atlas.GetLayerCount(), 2u);
+    EXPECT_EQ(atlas.GetEntry(0).layer, 0u);
+    EXPECT_EQ(atlas.GetEntry(1).layer, 1u);
+}
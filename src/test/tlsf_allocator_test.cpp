@@ -0,0 +1,167 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/tlsf_allocator.h"
+
+using namespace ppx;
+
+namespace {
+
+// Checks that no two allocations overlap and that all are inside the range.
+void ExpectDisjoint(const std::vector<TLSFAllocator::Allocation>& allocations, uint64_t size)
+{
+    std::vector<TLSFAllocator::Allocation> sorted = allocations;
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        EXPECT_LE(sorted[i].offset + sorted[i].size, size);
+        if (i > 0) {
+            EXPECT_LE(sorted[i - 1].offset + sorted[i - 1].size, sorted[i].offset);
+        }
+    }
+}
+
+} // namespace
+
+TEST(TLSFAllocatorTest, CreateRejectsInvalidGranularity)
+{
+    TLSFAllocator allocator;
+    EXPECT_EQ(TLSFAllocator::Create(1024, 0, &allocator), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(TLSFAllocator::Create(1024, 24, &allocator), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(TLSFAllocator::Create(1000, 256, &allocator), ERROR_INVALID_CREATE_ARGUMENT);
+    EXPECT_EQ(TLSFAllocator::Create(1024, 256, &allocator), SUCCESS);
+}
+
+TEST(TLSFAllocatorTest, AllocationsAreAligned)
+{
+    TLSFAllocator allocator;
+    ASSERT_EQ(TLSFAllocator::Create(64 * 1024, 256, &allocator), SUCCESS);
+
+    std::vector<TLSFAllocator::Allocation> allocations;
+    for (uint64_t size : {1, 100, 256, 257, 1000, 4096}) {
+        TLSFAllocator::Allocation allocation = {};
+        ASSERT_EQ(allocator.Allocate(size, &allocation), SUCCESS);
+        EXPECT_EQ(allocation.offset % 256, 0u);
+        EXPECT_EQ(allocation.size % 256, 0u);
+        EXPECT_GE(allocation.size, size);
+        allocations.push_back(allocation);
+    }
+    ExpectDisjoint(allocations, allocator.GetSize());
+    EXPECT_EQ(allocator.GetAllocationCount(), 6u);
+}
+
+TEST(TLSFAllocatorTest, FullRangeAllocation)
+{
+    TLSFAllocator allocator;
+    ASSERT_EQ(TLSFAllocator::Create(4096, 16, &allocator), SUCCESS);
+
+    TLSFAllocator::Allocation all = {};
+    ASSERT_EQ(allocator.Allocate(4096, &all), SUCCESS);
+    EXPECT_EQ(all.offset, 0u);
+
+    TLSFAllocator::Allocation extra = {};
+    EXPECT_EQ(allocator.Allocate(16, &extra), ERROR_OUT_OF_MEMORY);
+
+    allocator.Free(all.handle);
+    EXPECT_TRUE(allocator.IsEmpty());
+    EXPECT_EQ(allocator.GetLargestFreeRange(), 4096u);
+}
+
+TEST(TLSFAllocatorTest, UnalignedFullRangeAllocation)
+{
+    TLSFAllocator allocator;
+    ASSERT_EQ(TLSFAllocator::Create(103, 1, &allocator), SUCCESS);
+
+    // 103 rounds up to the bin starting at 104, past the only free range
+    TLSFAllocator::Allocation all = {};
+    ASSERT_EQ(allocator.Allocate(103, &all), SUCCESS);
+    EXPECT_EQ(all.offset, 0u);
+    EXPECT_EQ(all.size, 103u);
+}
+
+TEST(TLSFAllocatorTest, ExactRemainderAllocation)
+{
+    TLSFAllocator allocator;
+    ASSERT_EQ(TLSFAllocator::Create(103, 1, &allocator), SUCCESS);
+
+    // The 63 byte remainder is in the bin of 62 and 63, and 63 rounds up to
+    // the next first level class, so it's only found by the fallback
+    TLSFAllocator::Allocation first = {};
+    ASSERT_EQ(allocator.Allocate(40, &first), SUCCESS);
+    TLSFAllocator::Allocation rest = {};
+    ASSERT_EQ(allocator.Allocate(63, &rest), SUCCESS);
+    EXPECT_EQ(rest.offset, 40u);
+    EXPECT_EQ(allocator.GetUsedSize(), 103u);
+}
+
+TEST(TLSFAllocatorTest, FreeMergesNeighbours)
+{
+    TLSFAllocator allocator;
+    ASSERT_EQ(TLSFAllocator::Create(1024, 16, &allocator), SUCCESS);
+
+    TLSFAllocator::Allocation a = {};
+    TLSFAllocator::Allocation b = {};
+    TLSFAllocator::Allocation c = {};
+    ASSERT_EQ(allocator.Allocate(256, &a), SUCCESS);
+    ASSERT_EQ(allocator.Allocate(256, &b), SUCCESS);
+    ASSERT_EQ(allocator.Allocate(512, &c), SUCCESS);
+    EXPECT_EQ(allocator.GetLargestFreeRange(), 0u);
+
+    // Freeing a and c leaves two holes, freeing b joins all three
+    allocator.Free(a.handle);
+    allocator.Free(c.handle);
+    EXPECT_EQ(allocator.GetLargestFreeRange(), 512u);
+    allocator.Free(b.handle);
+    EXPECT_EQ(allocator.GetLargestFreeRange(), 1024u);
+    EXPECT_EQ(allocator.GetUsedSize(), 0u);
+}
+
+TEST(TLSFAllocatorTest, RandomAllocateFree)
+{
+    const uint64_t kSize = 1024 * 1024;
+    TLSFAllocator  allocator;
+    ASSERT_EQ(TLSFAllocator::Create(kSize, 64, &allocator), SUCCESS);
+
+    std::vector<TLSFAllocator::Allocation> live;
+    uint32_t                               seed = 0x9E3779B9;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        if (((seed >> 28) < 10) || live.empty()) {
+            TLSFAllocator::Allocation allocation = {};
+            uint64_t                  size       = 1 + (seed >> 8) % 8192;
+            if (allocator.Allocate(size, &allocation) == SUCCESS) {
+                live.push_back(allocation);
+            }
+        }
+        else {
+            size_t index = (seed >> 4) % live.size();
+            allocator.Free(live[index].handle);
+            live.erase(live.begin() + index);
+        }
+    }
+    ExpectDisjoint(live, kSize);
+
+    uint64_t used = 0;
+    for (const auto& allocation : live) {
+        used += allocation.size;
+    }
+    EXPECT_EQ(allocator.GetUsedSize(), used);
+
+    for (const auto& allocation : live) {
+        allocator.Free(allocation.handle);
+    }
+    EXPECT_TRUE(allocator.IsEmpty());
+    EXPECT_EQ(allocator.GetLargestFreeRange(), kSize);
+}
@@ -0,0 +1,184 @@
+// Copyright 2022 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gtest/gtest.h"
+
+#include "ppx/transform_hierarchy.h"
+
+using namespace ppx;
+
+namespace {
+
+float4x4 ComposeReference(const float3& translation, const quat& rotation, const float3& scale)
+{
+    return glm::translate(translation) * glm::mat4_cast(rotation) * glm::scale(scale);
+}
+
+void ExpectMatrixNear(const float4x4& actual, const float4x4& expected)
+{
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            EXPECT_NEAR(actual[c][r], expected[c][r], 1e-4f) << "column " << c << " row " << r;
+        }
+    }
+}
+
+// Nodes with a few children each, added in id order so parents come first,
+// and a different TRS per node.
+void CreateTree(uint32_t nodeCount, uint32_t branching, TransformHierarchy* pHierarchy)
+{
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        const uint32_t parent = (i == 0) ? TransformHierarchy::kInvalidNode : (i - 1) / branching;
+        const uint32_t node   = pHierarchy->AddNode(parent);
+        const float    f      = static_cast<float>(i);
+        pHierarchy->SetTRS(
+            node,
+            float3(0.1f * f, 1.0f, -0.05f * f),
+            glm::angleAxis(0.01f * f, glm::normalize(float3(1.0f, f, 2.0f))),
+            float3(1.0f + 0.001f * f, 1.0f, 0.999f));
+    }
+}
+
+} // namespace
+
+TEST(TransformHierarchyTest, MatchesReference)
+{
+    // Roots and children added out of order, with 7 nodes so the SIMD path
+    // and the scalar tail are both used
+    TransformHierarchy hierarchy;
+    const uint32_t     root    = hierarchy.AddNode();
+    const uint32_t     other   = hierarchy.AddNode();
+    const uint32_t     child   = hierarchy.AddNode(root);
+    const uint32_t     leaf    = hierarchy.AddNode(child);
+    const uint32_t     sibling = hierarchy.AddNode(root);
+    const uint32_t     nested  = hierarchy.AddNode(other);
+    const uint32_t     deep    = hierarchy.AddNode(leaf);
+
+    const quat rotation = glm::angleAxis(0.5f, glm::normalize(float3(1, 2, 3)));
+    hierarchy.SetTRS(root, float3(1, 2, 3), rotation, float3(2, 2, 2));
+    hierarchy.SetTRS(child, float3(0, 1, 0), glm::angleAxis(1.0f, float3(0, 1, 0)), float3(1, 0.5f, 1));
+    hierarchy.SetTranslation(leaf, float3(-3, 0, 0));
+    hierarchy.SetScale(sibling, float3(4, 4, 4));
+    hierarchy.SetRotation(nested, rotation);
+    hierarchy.SetTranslation(deep, float3(0, 0, 5));
+    hierarchy.Update();
+
+    const float4x4 rootWorld  = ComposeReference(float3(1, 2, 3), rotation, float3(2, 2, 2));
+    const float4x4 childWorld = rootWorld * ComposeReference(float3(0, 1, 0), glm::angleAxis(1.0f, float3(0, 1, 0)), float3(1, 0.5f, 1));
+    const float4x4 leafWorld  = childWorld * glm::translate(float3(-3, 0, 0));
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(root), rootWorld);
+    ExpectMatrixNear(hierarchy.GetLocalMatrix(root), rootWorld);
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(child), childWorld);
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(leaf), leafWorld);
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(sibling), rootWorld * glm::scale(float3(4, 4, 4)));
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(nested), glm::mat4_cast(rotation));
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(deep), leafWorld * glm::translate(float3(0, 0, 5)));
+
+    EXPECT_EQ(hierarchy.GetTranslation(leaf), float3(-3, 0, 0));
+    EXPECT_EQ(hierarchy.GetParent(deep), leaf);
+    EXPECT_EQ(hierarchy.GetStats().nodeCount, 7u);
+    EXPECT_EQ(hierarchy.GetStats().levelCount, 4u);
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 7u);
+}
+
+TEST(TransformHierarchyTest, OnlyDirtySubtreesAreUpdated)
+{
+    TransformHierarchy hierarchy;
+    CreateTree(100, 3, &hierarchy);
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 100u);
+
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 0u);
+
+    // Node 1 has children 4, 5, 6, which have children 13 to 21, and so on
+    const float4x4 before = hierarchy.GetWorldMatrix(13);
+    hierarchy.SetTranslation(1, float3(10, 0, 0));
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 1u + 3u + 9u + 27u);
+    EXPECT_NE(hierarchy.GetWorldMatrix(13), before);
+    ExpectMatrixNear(hierarchy.GetWorldMatrix(13), hierarchy.GetWorldMatrix(1) * hierarchy.GetLocalMatrix(4) * hierarchy.GetLocalMatrix(13));
+}
+
+TEST(TransformHierarchyTest, SetParent)
+{
+    TransformHierarchy hierarchy;
+    const uint32_t     a = hierarchy.AddNode();
+    const uint32_t     b = hierarchy.AddNode(a);
+    const uint32_t     c = hierarchy.AddNode(b);
+    const uint32_t     d = hierarchy.AddNode();
+    hierarchy.SetTranslation(a, float3(1, 0, 0));
+    hierarchy.SetTranslation(b, float3(0, 1, 0));
+    hierarchy.SetTranslation(c, float3(0, 0, 1));
+    hierarchy.SetTranslation(d, float3(5, 0, 0));
+    hierarchy.Update();
+    EXPECT_EQ(float3(hierarchy.GetWorldMatrix(c)[3]), float3(1, 1, 1));
+
+    // Cycles and missing nodes are rejected
+    EXPECT_EQ(hierarchy.SetParent(a, c), ERROR_FAILED);
+    EXPECT_EQ(hierarchy.SetParent(a, a), ERROR_FAILED);
+    EXPECT_EQ(hierarchy.SetParent(a, 10), ERROR_OUT_OF_RANGE);
+    EXPECT_EQ(hierarchy.AddNode(10), TransformHierarchy::kInvalidNode);
+
+    // Moving b moves its subtree
+    ASSERT_EQ(hierarchy.SetParent(b, d), SUCCESS);
+    hierarchy.Update();
+    EXPECT_EQ(float3(hierarchy.GetWorldMatrix(c)[3]), float3(5, 1, 1));
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 2u);
+
+    ASSERT_EQ(hierarchy.SetParent(b, TransformHierarchy::kInvalidNode), SUCCESS);
+    hierarchy.Update();
+    EXPECT_EQ(float3(hierarchy.GetWorldMatrix(c)[3]), float3(0, 1, 1));
+    EXPECT_EQ(hierarchy.GetParent(b), TransformHierarchy::kInvalidNode);
+}
+
+TEST(TransformHierarchyTest, EmptyUpdate)
+{
+    TransformHierarchy hierarchy;
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetStats().nodeCount, 0u);
+    EXPECT_EQ(hierarchy.GetStats().levelCount, 0u);
+
+    CreateTree(10, 2, &hierarchy);
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 10u);
+
+    hierarchy.Clear();
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetNodeCount(), 0u);
+    EXPECT_EQ(hierarchy.GetStats().nodeCount, 0u);
+    EXPECT_EQ(hierarchy.GetStats().updatedCount, 0u);
+
+    // Still usable after Clear()
+    const uint32_t node = hierarchy.AddNode();
+    hierarchy.SetTranslation(node, float3(1, 2, 3));
+    hierarchy.Update();
+    EXPECT_EQ(float3(hierarchy.GetWorldMatrix(node)[3]), float3(1, 2, 3));
+}
+
+TEST(TransformHierarchyTest, MultithreadedUpdateMatchesSingleThreaded)
+{
+    TransformHierarchy single;
+    TransformHierarchy multi;
+    multi.SetThreadCount(4);
+    CreateTree(50000, 8, &single);
+    CreateTree(50000, 8, &multi);
+    single.Update();
+    multi.Update();
+    EXPECT_EQ(multi.GetStats().threadCount, 4u);
+
+    for (uint32_t node = 0; node < 50000; node += 97) {
+        EXPECT_EQ(multi.GetWorldMatrix(node), single.GetWorldMatrix(node));
+    }
+}